@@ -275,4 +275,19 @@
  */
 #define ID_MM_TTY_FLOW_CONTROL "ID_MM_TTY_FLOW_CONTROL"
 
+/**
+ * ID_MM_TTY_PIPELINE:
+ *
+ * This is a port-specific tag applied to AT TTYs that are able to receive
+ * new commands before having replied to the previous ones.
+ *
+ * When this tag is given, independent commands queued at the same time may
+ * be sent to the port in a single write, and the replies are expected in
+ * the same order. Commands switching to data mode, waiting for additional
+ * input after a prompt or resetting the device are never sent this way.
+ *
+ * Since: 1.16
+ */
+#define ID_MM_TTY_PIPELINE "ID_MM_TTY_PIPELINE"
+
 #endif /* MM_TAGS_H */
@@ -1686,74 +1686,150 @@ mm_utils_hex2byte (const gchar *hex)
     return (a << 4) | b;
 }
 
+/* End from hostap */
+
+/* Value of each hex digit, or HEX_INVALID. Invalid digits are flagged in a bit
+ * of their own, so that a whole block of digits can be decoded without
+ * branching and validated at once by OR-ing all the values. */
+#define HEX_INVALID 0x10
+
+static const guint8 hex_values[256] = {
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+    0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+};
+
+static const gchar hex_digits[] = "0123456789ABCDEF";
+
+/* Bytes decoded between validity checks */
+#define HEX_BLOCK_SIZE 16
+
+gboolean
+mm_utils_hexstr2bin_buf (const gchar *hex,
+                         gssize       hex_len,
+                         guint8      *out,
+                         gsize        out_size,
+                         gsize       *out_len)
+{
+    const guint8 *in;
+    gsize         len;
+    gsize         i;
+
+    g_return_val_if_fail (hex != NULL, FALSE);
+
+    len = (hex_len < 0) ? strlen (hex) : (gsize) hex_len;
+
+    /* Length must be a multiple of 2 */
+    if (len % 2)
+        return FALSE;
+    len /= 2;
+    g_return_val_if_fail (len <= out_size, FALSE);
+
+    in = (const guint8 *) hex;
+    for (i = 0; i < len; ) {
+        gsize  block_end;
+        guint8 invalid = 0;
+
+        block_end = MIN (i + HEX_BLOCK_SIZE, len);
+        for (; i < block_end; i++, in += 2) {
+            guint8 a, b;
+
+            a = hex_values[in[0]];
+            b = hex_values[in[1]];
+            invalid |= a | b;
+            out[i] = (a << 4) | (b & 0x0f);
+        }
+        if (invalid & HEX_INVALID)
+            return FALSE;
+    }
+
+    if (out_len)
+        *out_len = len;
+    return TRUE;
+}
+
 gchar *
 mm_utils_hexstr2bin (const gchar *hex, gsize *out_len)
 {
-    const gchar *ipos = hex;
-    gchar *buf = NULL;
-    gsize i;
-    gint a;
-    gchar *opos;
-    gsize len;
+    gchar *buf;
+    gsize  len;
 
     len = strlen (hex);
 
     /* Length must be a multiple of 2 */
     g_return_val_if_fail ((len % 2) == 0, NULL);
 
-    opos = buf = g_malloc0 ((len / 2) + 1);
-    for (i = 0; i < len; i += 2) {
-        a = mm_utils_hex2byte (ipos);
-        if (a < 0) {
-            g_free (buf);
-            return NULL;
-        }
-        *opos++ = a;
-        ipos += 2;
+    buf = g_malloc ((len / 2) + 1);
+    if (!mm_utils_hexstr2bin_buf (hex, len, (guint8 *) buf, len / 2, out_len)) {
+        g_free (buf);
+        return NULL;
     }
-    *out_len = len / 2;
+    buf[len / 2] = '\0';
     return buf;
 }
 
-/* End from hostap */
-
 gboolean
 mm_utils_ishexstr (const gchar *hex)
 {
-    gsize len;
-    gsize i;
+    const guint8 *in;
+    guint8        invalid = 0;
+    gsize         len;
+    gsize         i;
 
     /* Length not multiple of 2? */
     len = strlen (hex);
     if (len % 2 != 0)
         return FALSE;
 
+    in = (const guint8 *) hex;
+    for (i = 0; i < len; i++)
+        invalid |= hex_values[in[i]];
+
+    return !(invalid & HEX_INVALID);
+}
+
+gboolean
+mm_utils_bin2hexstr_buf (const guint8 *bin,
+                         gsize         len,
+                         gchar        *out,
+                         gsize         out_size)
+{
+    gsize i;
+
+    g_return_val_if_fail (bin != NULL || len == 0, FALSE);
+    g_return_val_if_fail (out_size > (len * 2), FALSE);
+
     for (i = 0; i < len; i++) {
-        /* Non-hex char? */
-        if (hex[i] >= '0' && hex[i] <= '9')
-            continue;
-        if (hex[i] >= 'a' && hex[i] <= 'f')
-            continue;
-        if (hex[i] >= 'A' && hex[i] <= 'F')
-            continue;
-        return FALSE;
+        out[2 * i]       = hex_digits[bin[i] >> 4];
+        out[(2 * i) + 1] = hex_digits[bin[i] & 0x0f];
     }
-
+    out[2 * len] = '\0';
     return TRUE;
 }
 
 gchar *
 mm_utils_bin2hexstr (const guint8 *bin, gsize len)
 {
-    GString *ret;
-    gsize i;
+    gchar *ret;
 
     g_return_val_if_fail (bin != NULL, NULL);
 
-    ret = g_string_sized_new (len * 2 + 1);
-    for (i = 0; i < len; i++)
-        g_string_append_printf (ret, "%.2X", bin[i]);
-    return g_string_free (ret, FALSE);
+    ret = g_malloc ((len * 2) + 1);
+    mm_utils_bin2hexstr_buf (bin, len, ret, (len * 2) + 1);
+    return ret;
 }
 
 gboolean
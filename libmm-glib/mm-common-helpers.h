@@ -185,6 +185,20 @@ gchar    *mm_utils_hexstr2bin (const gchar *hex, gsize *out_len);
 gchar    *mm_utils_bin2hexstr (const guint8 *bin, gsize len);
 gboolean  mm_utils_ishexstr   (const gchar *hex);
 
+/* Same as the above, but writing into a caller-provided buffer. hex_len may be
+ * -1 if the string is NUL-terminated; on failure the contents of out are
+ * undefined. The output of bin2hexstr is NUL-terminated, so out_size must be
+ * at least (len * 2) + 1. */
+gboolean  mm_utils_hexstr2bin_buf (const gchar  *hex,
+                                   gssize        hex_len,
+                                   guint8       *out,
+                                   gsize         out_size,
+                                   gsize        *out_len);
+gboolean  mm_utils_bin2hexstr_buf (const guint8 *bin,
+                                   gsize         len,
+                                   gchar        *out,
+                                   gsize         out_size);
+
 gboolean  mm_utils_check_for_single_value (guint32 value);
 
 #endif /* MM_COMMON_HELPERS_H */
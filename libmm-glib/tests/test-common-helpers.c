@@ -13,6 +13,8 @@
  * Copyright (C) 2012 Google, Inc.
  */
 
+#include <string.h>
+
 #include <glib-object.h>
 
 #include <libmm-glib.h>
@@ -501,6 +503,198 @@ field_parser_double (void)
     g_free (str);
 }
 
+/********************* HEX CODEC TESTS *********************/
+
+/* Byte by byte implementations the codecs are checked against */
+
+static gchar *
+reference_hexstr2bin (const gchar *hex,
+                      gsize        len,
+                      gsize       *out_len)
+{
+    gchar *buf;
+    gsize  i;
+
+    buf = g_malloc0 ((len / 2) + 1);
+    for (i = 0; i < len; i += 2) {
+        gint a;
+
+        a = mm_utils_hex2byte (&hex[i]);
+        if (a < 0) {
+            g_free (buf);
+            return NULL;
+        }
+        buf[i / 2] = a;
+    }
+    *out_len = len / 2;
+    return buf;
+}
+
+static gchar *
+reference_bin2hexstr (const guint8 *bin,
+                      gsize         len)
+{
+    GString *ret;
+    gsize    i;
+
+    ret = g_string_sized_new (len * 2 + 1);
+    for (i = 0; i < len; i++)
+        g_string_append_printf (ret, "%.2X", bin[i]);
+    return g_string_free (ret, FALSE);
+}
+
+static void
+hex_test_basic (void)
+{
+    static const guint8  bin[] = { 0x00, 0x01, 0x7F, 0x80, 0xAB, 0xFF };
+    g_autofree gchar    *hex = NULL;
+    g_autofree gchar    *decoded = NULL;
+    guint8               out[16];
+    gchar                out_hex[13];
+    gsize                len = 0;
+
+    hex = mm_utils_bin2hexstr (bin, sizeof (bin));
+    g_assert_cmpstr (hex, ==, "00017F80ABFF");
+    decoded = mm_utils_hexstr2bin ("00017f80AbfF", &len);
+    g_assert (decoded);
+    g_assert_cmpuint (len, ==, sizeof (bin));
+    g_assert_cmpint (memcmp (decoded, bin, len), ==, 0);
+    g_assert (mm_utils_ishexstr ("00017f80AbfF"));
+
+    /* Caller-provided buffers */
+    g_assert (mm_utils_bin2hexstr_buf (bin, sizeof (bin), out_hex, sizeof (out_hex)));
+    g_assert_cmpstr (out_hex, ==, "00017F80ABFF");
+    g_assert (mm_utils_hexstr2bin_buf ("00017F80ABFFxx", 12, out, sizeof (out), &len));
+    g_assert_cmpuint (len, ==, sizeof (bin));
+    g_assert_cmpint (memcmp (out, bin, len), ==, 0);
+    g_assert (mm_utils_hexstr2bin_buf ("", -1, out, 0, &len));
+    g_assert_cmpuint (len, ==, 0);
+
+    /* Errors */
+    g_assert (!mm_utils_hexstr2bin_buf ("ABC", -1, out, sizeof (out), NULL));
+    g_assert (!mm_utils_hexstr2bin_buf ("0G", -1, out, sizeof (out), NULL));
+    g_assert (!mm_utils_hexstr2bin_buf ("00112233445566778899AABBCCDDEEF ", -1, out, sizeof (out), NULL));
+    g_assert (!mm_utils_ishexstr ("0G"));
+    g_assert (!mm_utils_ishexstr ("ABC"));
+    g_assert (mm_utils_hexstr2bin ("G0", &len) == NULL);
+}
+
+#define HEX_FUZZ_N_RUNS   10000
+#define HEX_FUZZ_MAX_SIZE 300
+
+static void
+hex_test_fuzz (void)
+{
+    static const gchar  hex_chars[] = "0123456789abcdefABCDEF";
+    guint8              bin[HEX_FUZZ_MAX_SIZE];
+    gchar               hex[(HEX_FUZZ_MAX_SIZE * 2) + 1];
+    guint8              out[HEX_FUZZ_MAX_SIZE];
+    gchar               out_hex[(HEX_FUZZ_MAX_SIZE * 2) + 1];
+    guint               run;
+    gsize               i;
+
+    for (run = 0; run < HEX_FUZZ_N_RUNS; run++) {
+        g_autofree gchar *expected = NULL;
+        g_autofree gchar *decoded = NULL;
+        gsize             len;
+        gsize             out_len = 0;
+        gsize             expected_len = 0;
+        gboolean          valid;
+
+        /* Binary to hex */
+        len = g_test_rand_int_range (0, HEX_FUZZ_MAX_SIZE + 1);
+        for (i = 0; i < len; i++)
+            bin[i] = g_test_rand_int_range (0, 256);
+        expected = reference_bin2hexstr (bin, len);
+        g_assert (mm_utils_bin2hexstr_buf (bin, len, out_hex, sizeof (out_hex)));
+        g_assert_cmpstr (out_hex, ==, expected);
+        g_clear_pointer (&expected, g_free);
+
+        /* Hex to binary, mostly valid strings, with an occasional bad
+         * char of any kind in any position */
+        len = g_test_rand_int_range (0, HEX_FUZZ_MAX_SIZE + 1) * 2;
+        for (i = 0; i < len; i++)
+            hex[i] = hex_chars[g_test_rand_int_range (0, sizeof (hex_chars) - 1)];
+        if (g_test_rand_bit () && len > 0)
+            hex[g_test_rand_int_range (0, len)] = g_test_rand_int_range (1, 256);
+        hex[len] = '\0';
+
+        expected = reference_hexstr2bin (hex, len, &expected_len);
+        valid = mm_utils_hexstr2bin_buf (hex, -1, out, sizeof (out), &out_len);
+        g_assert (valid == (expected != NULL));
+        g_assert (mm_utils_ishexstr (hex) == valid);
+        decoded = mm_utils_hexstr2bin (hex, &out_len);
+        g_assert ((decoded != NULL) == valid);
+        if (valid) {
+            g_assert_cmpuint (out_len, ==, expected_len);
+            g_assert_cmpint (memcmp (out, expected, out_len), ==, 0);
+            g_assert_cmpint (memcmp (decoded, expected, out_len + 1), ==, 0);
+        }
+
+        /* Odd lengths are never valid */
+        if (len > 0)
+            g_assert (!mm_utils_hexstr2bin_buf (hex, len - 1, out, sizeof (out), NULL));
+    }
+}
+
+#define HEX_BENCHMARK_N_ITERATIONS 100000
+#define HEX_BENCHMARK_SIZE         176 /* max 3GPP SMS PDU, SMSC included */
+
+static void
+hex_test_benchmark (void)
+{
+    guint8            bin[HEX_BENCHMARK_SIZE];
+    g_autofree gchar *hex = NULL;
+    GTimer           *timer;
+    gdouble           elapsed;
+    gdouble           reference_elapsed;
+    guint             i;
+
+    if (!g_test_perf ())
+        return;
+
+    for (i = 0; i < sizeof (bin); i++)
+        bin[i] = g_test_rand_int_range (0, 256);
+    hex = mm_utils_bin2hexstr (bin, sizeof (bin));
+
+    timer = g_timer_new ();
+
+    for (i = 0; i < HEX_BENCHMARK_N_ITERATIONS; i++) {
+        gsize len;
+
+        g_free (mm_utils_hexstr2bin (hex, &len));
+    }
+    elapsed = g_timer_elapsed (timer, NULL);
+    g_timer_start (timer);
+    for (i = 0; i < HEX_BENCHMARK_N_ITERATIONS; i++) {
+        gsize len;
+
+        g_free (reference_hexstr2bin (hex, strlen (hex), &len));
+    }
+    reference_elapsed = g_timer_elapsed (timer, NULL);
+    g_test_message ("hex to binary, %u bytes: %.3f us, reference %.3f us", (guint) sizeof (bin),
+                    (elapsed * G_USEC_PER_SEC) / HEX_BENCHMARK_N_ITERATIONS,
+                    (reference_elapsed * G_USEC_PER_SEC) / HEX_BENCHMARK_N_ITERATIONS);
+    g_test_minimized_result (elapsed / HEX_BENCHMARK_N_ITERATIONS, "hex to binary: %.3f us",
+                             (elapsed * G_USEC_PER_SEC) / HEX_BENCHMARK_N_ITERATIONS);
+
+    g_timer_start (timer);
+    for (i = 0; i < HEX_BENCHMARK_N_ITERATIONS; i++)
+        g_free (mm_utils_bin2hexstr (bin, sizeof (bin)));
+    elapsed = g_timer_elapsed (timer, NULL);
+    g_timer_start (timer);
+    for (i = 0; i < HEX_BENCHMARK_N_ITERATIONS; i++)
+        g_free (reference_bin2hexstr (bin, sizeof (bin)));
+    reference_elapsed = g_timer_elapsed (timer, NULL);
+    g_test_message ("binary to hex, %u bytes: %.3f us, reference %.3f us", (guint) sizeof (bin),
+                    (elapsed * G_USEC_PER_SEC) / HEX_BENCHMARK_N_ITERATIONS,
+                    (reference_elapsed * G_USEC_PER_SEC) / HEX_BENCHMARK_N_ITERATIONS);
+    g_test_minimized_result (elapsed / HEX_BENCHMARK_N_ITERATIONS, "binary to hex: %.3f us",
+                             (elapsed * G_USEC_PER_SEC) / HEX_BENCHMARK_N_ITERATIONS);
+
+    g_timer_destroy (timer);
+}
+
 /**************************************************************/
 
 int main (int argc, char **argv)
@@ -539,5 +733,9 @@ int main (int argc, char **argv)
     g_test_add_func ("/MM/Common/FieldParsers/Uint", field_parser_uint);
     g_test_add_func ("/MM/Common/FieldParsers/Double", field_parser_double);
 
+    g_test_add_func ("/MM/Common/Hex/basic", hex_test_basic);
+    g_test_add_func ("/MM/Common/Hex/fuzz", hex_test_fuzz);
+    g_test_add_func ("/MM/Common/Hex/benchmark", hex_test_benchmark);
+
     return g_test_run ();
 }
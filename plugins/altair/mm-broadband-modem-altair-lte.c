@@ -40,6 +40,7 @@
 #include "mm-modem-helpers-altair-lte.h"
 #include "mm-serial-parsers.h"
 #include "mm-bearer-list.h"
+#include "mm-regex-registry.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 static void iface_modem_3gpp_init (MMIfaceModem3gpp *iface);
@@ -1167,6 +1168,9 @@ mm_broadband_modem_altair_lte_new (const gchar *device,
                          MM_IFACE_MODEM_3GPP_CS_NETWORK_SUPPORTED, FALSE,
                          MM_IFACE_MODEM_3GPP_PS_NETWORK_SUPPORTED, FALSE,
                          MM_IFACE_MODEM_3GPP_EPS_NETWORK_SUPPORTED, TRUE,
+                         /* Supported bands are probed with AT commands, and
+                          * no state is kept while doing so */
+                         MM_IFACE_MODEM_SUPPORTED_BANDS_CACHEABLE, TRUE,
                          NULL);
 }
 
@@ -1185,14 +1189,14 @@ mm_broadband_modem_altair_lte_init (MMBroadbandModemAltairLte *self)
                                               MM_TYPE_BROADBAND_MODEM_ALTAIR_LTE,
                                               MMBroadbandModemAltairLtePrivate);
 
-    self->priv->sim_refresh_regex = g_regex_new ("\\r\\n\\%NOTIFYEV:\\s*\"?SIMREFRESH\"?,?(\\d*)\\r+\\n",
-                                                 G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->sim_refresh_regex = mm_regex_get ("\\r\\n\\%NOTIFYEV:\\s*\"?SIMREFRESH\"?,?(\\d*)\\r+\\n",
+                                                  G_REGEX_RAW | G_REGEX_OPTIMIZE);
     self->priv->sim_refresh_detach_in_progress = FALSE;
     self->priv->sim_refresh_timer_id = 0;
-    self->priv->statcm_regex = g_regex_new ("\\r\\n\\%STATCM:\\s*(\\d*),?(\\d*)\\r+\\n",
-                                            G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->pcoinfo_regex = g_regex_new ("\\r\\n\\%PCOINFO:\\s*(\\d*),([^,\\s]*),([^,\\s]*)\\r+\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->statcm_regex = mm_regex_get ("\\r\\n\\%STATCM:\\s*(\\d*),?(\\d*)\\r+\\n",
+                                             G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->pcoinfo_regex = mm_regex_get ("\\r\\n\\%PCOINFO:\\s*(\\d*),([^,\\s]*),([^,\\s]*)\\r+\\n",
+                                              G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 static void
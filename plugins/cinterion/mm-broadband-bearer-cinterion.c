@@ -274,7 +274,7 @@ handle_cancel_dial (GTask *task)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE,
                                    NULL,
@@ -331,7 +331,7 @@ dial_3gpp_context_step (GTask *task)
             mm_base_modem_at_command_full (ctx->modem,
                                            ctx->primary,
                                            command,
-                                           10,
+                                           10000,
                                            FALSE,
                                            FALSE,
                                            NULL,
@@ -356,7 +356,7 @@ dial_3gpp_context_step (GTask *task)
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        command,
-                                       MM_BASE_BEARER_DEFAULT_CONNECTION_TIMEOUT,
+                                       MM_BASE_BEARER_DEFAULT_CONNECTION_TIMEOUT * 1000,
                                        FALSE,
                                        FALSE,
                                        NULL,
@@ -553,7 +553,7 @@ disconnect_3gpp_context_step (GTask *task)
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        command,
-                                       MM_BASE_BEARER_DEFAULT_DISCONNECTION_TIMEOUT,
+                                       MM_BASE_BEARER_DEFAULT_DISCONNECTION_TIMEOUT * 1000,
                                        FALSE,
                                        FALSE,
                                        NULL,
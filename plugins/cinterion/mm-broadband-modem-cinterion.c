@@ -708,8 +708,7 @@ modem_power_off (MMIfaceModem        *self,
 
     ctx = g_slice_new0 (PowerOffContext);
     ctx->port = mm_base_modem_get_port_primary (MM_BASE_MODEM (self));
-    ctx->shutdown_regex = g_regex_new ("\\r\\n\\^SHUTDOWN\\r\\n",
-                                       G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    ctx->shutdown_regex = mm_cinterion_get_shutdown_regex ();
     ctx->timeout_id = g_timeout_add_seconds (MAX_POWER_OFF_WAIT_TIME_SECS,
                                              (GSourceFunc)power_off_timeout_cb,
                                              task);
@@ -740,7 +739,7 @@ modem_power_off (MMIfaceModem        *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    ctx->port,
                                    "^SMSO",
-                                   5,
+                                   5000,
                                    FALSE, /* allow_cached */
                                    FALSE, /* is_raw */
                                    NULL, /* cancellable */
@@ -2875,12 +2874,9 @@ mm_broadband_modem_cinterion_init (MMBroadbandModemCinterion *self)
     self->priv->smoni_support          = FEATURE_SUPPORT_UNKNOWN;
     self->priv->sind_simstatus_support = FEATURE_SUPPORT_UNKNOWN;
 
-    self->priv->ciev_regex = g_regex_new ("\\r\\n\\+CIEV:\\s*([a-z]+),(\\d+)\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->sysstart_regex = g_regex_new ("\\r\\n\\^SYSSTART.*\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->scks_regex = g_regex_new ("\\^SCKS:\\s*([0-3])\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->ciev_regex = mm_cinterion_get_ciev_regex ();
+    self->priv->sysstart_regex = mm_cinterion_get_sysstart_regex ();
+    self->priv->scks_regex = mm_cinterion_get_scks_regex ();
 }
 
 static void
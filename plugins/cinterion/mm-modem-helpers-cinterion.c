@@ -30,6 +30,7 @@
 #include "mm-modem-helpers-cinterion.h"
 #include "mm-modem-helpers.h"
 #include "mm-port-serial-at.h"
+#include "mm-regex-registry.h"
 
 /* Setup relationship between the 3G band bitmask in the modem and the bitmask
  * in ModemManager. */
@@ -257,11 +258,11 @@ mm_cinterion_parse_scfg_test (const gchar                 *response,
         return FALSE;
     }
 
-    r1 = g_regex_new ("\\^SCFG:\\s*\"Radio/Band\",\\((?:\")?([0-9]*)(?:\")?-(?:\")?([0-9]*)(?:\")?.*\\)",
-                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW, 0, NULL);
+    r1 = mm_regex_get ("\\^SCFG:\\s*\"Radio/Band\",\\((?:\")?([0-9]*)(?:\")?-(?:\")?([0-9]*)(?:\")?.*\\)",
+                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW);
     g_assert (r1 != NULL);
 
-    g_regex_match_full (r1, response, strlen (response), 0, 0, &match_info1, &inner_error);
+    mm_regex_match_full (r1, response, strlen (response), 0, 0, &match_info1, &inner_error);
     if (inner_error)
         goto finish;
     if (g_match_info_matches (match_info1)) {
@@ -292,10 +293,10 @@ mm_cinterion_parse_scfg_test (const gchar                 *response,
         goto finish;
     }
 
-    r2 = g_regex_new ("\\^SCFG:\\s*\"Radio/Band/([234]G)\",\\(\"?([0-9A-Fa-fx]*)\"?-\"?([0-9A-Fa-fx]*)\"?\\)(,*\\(\"?([0-9A-Fa-fx]*)\"?-\"?([0-9A-Fa-fx]*)\"?\\))?",
-                     0, 0, NULL);
+    r2 = mm_regex_get ("\\^SCFG:\\s*\"Radio/Band/([234]G)\",\\(\"?([0-9A-Fa-fx]*)\"?-\"?([0-9A-Fa-fx]*)\"?\\)(,*\\(\"?([0-9A-Fa-fx]*)\"?-\"?([0-9A-Fa-fx]*)\"?\\))?",
+                     0);
     g_assert (r2 != NULL);
-    g_regex_match_full (r2, response, strlen (response), 0, 0, &match_info2, &inner_error);
+    mm_regex_match_full (r2, response, strlen (response), 0, 0, &match_info2, &inner_error);
     if (inner_error)
         goto finish;
     while (g_match_info_matches (match_info2)) {
@@ -405,9 +406,9 @@ mm_cinterion_parse_scfg_response (const gchar                  *response,
     }
 
     if (format == MM_CINTERION_RADIO_BAND_FORMAT_SINGLE) {
-        r = g_regex_new ("\\^SCFG:\\s*\"Radio/Band\",\\s*\"?([0-9a-fA-F]*)\"?", 0, 0, NULL);
+        r = mm_regex_get ("\\^SCFG:\\s*\"Radio/Band\",\\s*\"?([0-9a-fA-F]*)\"?", 0);
         g_assert (r != NULL);
-        g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+        mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
         if (inner_error)
             goto finish;
         if (g_match_info_matches (match_info)) {
@@ -435,10 +436,10 @@ mm_cinterion_parse_scfg_response (const gchar                  *response,
             }
         }
     } else if (format == MM_CINTERION_RADIO_BAND_FORMAT_MULTIPLE) {
-        r = g_regex_new ("\\^SCFG:\\s*\"Radio/Band/([234]G)\",\"?([0-9A-Fa-fx]*)\"?,?\"?([0-9A-Fa-fx]*)?\"?",
-                         0, 0, NULL);
+        r = mm_regex_get ("\\^SCFG:\\s*\"Radio/Band/([234]G)\",\"?([0-9A-Fa-fx]*)\"?,?\"?([0-9A-Fa-fx]*)?\"?",
+                          0);
         g_assert (r != NULL);
-        g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+        mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
         if (inner_error)
             goto finish;
         while (g_match_info_matches (match_info)) {
@@ -521,12 +522,11 @@ mm_cinterion_parse_cnmi_test (const gchar *response,
         return FALSE;
     }
 
-    r = g_regex_new ("\\+CNMI:\\s*\\((.*)\\),\\((.*)\\),\\((.*)\\),\\((.*)\\),\\((.*)\\)",
-                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
-                     0, NULL);
+    r = mm_regex_get ("\\+CNMI:\\s*\\((.*)\\),\\((.*)\\),\\((.*)\\),\\((.*)\\),\\((.*)\\)",
+                      G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW);
     g_assert (r != NULL);
 
-    g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
     if (!inner_error && g_match_info_matches (match_info)) {
         if (supported_mode) {
             gchar *str;
@@ -725,10 +725,10 @@ mm_cinterion_parse_sind_response (const gchar *response,
         return FALSE;
     }
 
-    r = g_regex_new ("\\^SIND:\\s*(.*),(\\d+),(\\d+)(\\r\\n)?", 0, 0, NULL);
+    r = mm_regex_get ("\\^SIND:\\s*(.*),(\\d+),(\\d+)(\\r\\n)?", 0);
     g_assert (r != NULL);
 
-    if (g_regex_match (r, response, 0, &match_info)) {
+    if (mm_regex_match (r, response, 0, &match_info)) {
         if (description) {
             *description = mm_get_string_unquoted_from_match_info (match_info, 1);
             if (*description == NULL)
@@ -807,12 +807,12 @@ mm_cinterion_parse_swwan_response (const gchar  *response,
         return MM_BEARER_CONNECTION_STATUS_UNKNOWN;
     }
 
-    r = g_regex_new ("\\^SWWAN:\\s*(\\d+),\\s*(\\d+)(?:,\\s*(\\d+))?(?:\\r\\n)?",
-                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW, 0, NULL);
+    r = mm_regex_get ("\\^SWWAN:\\s*(\\d+),\\s*(\\d+)(?:,\\s*(\\d+))?(?:\\r\\n)?",
+                      G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW);
     g_assert (r != NULL);
 
     status = MM_BEARER_CONNECTION_STATUS_UNKNOWN;
-    g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
     while (!inner_error && g_match_info_matches (match_info)) {
         guint read_state;
         guint read_cid;
@@ -867,10 +867,10 @@ mm_cinterion_parse_sgauth_response (const gchar          *response,
     g_autoptr(GRegex)     r = NULL;
     g_autoptr(GMatchInfo) match_info = NULL;
 
-    r = g_regex_new ("\\^SGAUTH:\\s*(\\d+),(\\d+),?\"?([a-zA-Z0-9_-]+)?\"?", 0, 0, NULL);
+    r = mm_regex_get ("\\^SGAUTH:\\s*(\\d+),(\\d+),?\"?([a-zA-Z0-9_-]+)?\"?", 0);
     g_assert (r != NULL);
 
-    g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, NULL);
+    mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, NULL);
     while (g_match_info_matches (match_info)) {
         guint sgauth_cid = 0;
 
@@ -939,14 +939,13 @@ mm_cinterion_parse_smong_response (const gchar              *response,
      * 0776  1  -      -   214   03  2    00      01
      * OK
      */
-    regex = g_regex_new (".*GPRS Monitor(?:\r\n)*"
-                         "BCCH\\s*G.*\\r\\n"
-                         "\\s*(\\d+)\\s*(\\d+)\\s*",
-                         G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
-                         0, NULL);
+    regex = mm_regex_get (".*GPRS Monitor(?:\r\n)*"
+                          "BCCH\\s*G.*\\r\\n"
+                          "\\s*(\\d+)\\s*(\\d+)\\s*",
+                          G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW);
     g_assert (regex);
 
-    if (g_regex_match_full (regex, response, strlen (response), 0, 0, &match_info, &inner_error)) {
+    if (mm_regex_match_full (regex, response, strlen (response), 0, 0, &match_info, &inner_error)) {
         guint value = 0;
 
         if (!mm_get_uint_from_match_info (match_info, 2, &value))
@@ -1002,6 +1001,37 @@ mm_cinterion_get_access_technology_from_sind_psinfo (guint    val,
     }
 }
 
+/*****************************************************************************/
+/* Unsolicited message regexes */
+
+GRegex *
+mm_cinterion_get_ciev_regex (void)
+{
+    return mm_regex_get ("\\r\\n\\+CIEV:\\s*([a-z]+),(\\d+)\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
+}
+
+GRegex *
+mm_cinterion_get_sysstart_regex (void)
+{
+    return mm_regex_get ("\\r\\n\\^SYSSTART.*\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
+}
+
+GRegex *
+mm_cinterion_get_scks_regex (void)
+{
+    return mm_regex_get ("\\^SCKS:\\s*([0-3])\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
+}
+
+GRegex *
+mm_cinterion_get_shutdown_regex (void)
+{
+    return mm_regex_get ("\\r\\n\\^SHUTDOWN\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
+}
+
 /*****************************************************************************/
 /* ^SLCC psinfo helper */
 
@@ -1012,8 +1042,8 @@ mm_cinterion_get_slcc_regex (void)
      * with an empty line preceded by prefix "^SLCC: ", in order to indicate the end
      * of the list.
      */
-    return g_regex_new ("\\r\\n(\\^SLCC: .*\\r\\n)*\\^SLCC: \\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    return mm_regex_get ("\\r\\n(\\^SLCC: .*\\r\\n)*\\^SLCC: \\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 static void
@@ -1060,16 +1090,14 @@ mm_cinterion_parse_slcc_list (const gchar *str,
      *  ^SLCC :
      */
 
-    r = g_regex_new ("\\^SLCC:\\s*(\\d+),\\s*(\\d+),\\s*(\\d+),\\s*(\\d+),\\s*(\\d+),\\s*(\\d+)" /* mandatory fields */
-                     "(?:,\\s*([^,]*),\\s*(\\d+)"                                                /* number and type */
-                     "(?:,\\s*([^,]*)"                                                           /* alpha */
-                     ")?)?$",
-                     G_REGEX_RAW | G_REGEX_MULTILINE | G_REGEX_NEWLINE_CRLF,
-                     G_REGEX_MATCH_NEWLINE_CRLF,
-                     NULL);
+    r = mm_regex_get ("\\^SLCC:\\s*(\\d+),\\s*(\\d+),\\s*(\\d+),\\s*(\\d+),\\s*(\\d+),\\s*(\\d+)" /* mandatory fields */
+                      "(?:,\\s*([^,]*),\\s*(\\d+)"                                                /* number and type */
+                      "(?:,\\s*([^,]*)"                                                           /* alpha */
+                      ")?)?$",
+                      G_REGEX_RAW | G_REGEX_MULTILINE | G_REGEX_NEWLINE_CRLF);
     g_assert (r != NULL);
 
-    g_regex_match_full (r, str, strlen (str), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, str, strlen (str), 0, G_REGEX_MATCH_NEWLINE_CRLF, &match_info, &inner_error);
     if (inner_error)
         goto out;
 
@@ -1144,8 +1172,8 @@ mm_cinterion_get_ctzu_regex (void)
      *  +CTZU: "19/07/09,10:19:15",+08,1
      */
 
-    return g_regex_new ("\\r\\n\\+CTZU:\\s*\"(\\d+)\\/(\\d+)\\/(\\d+),(\\d+):(\\d+):(\\d+)\",([\\-\\+\\d]+)(?:,(\\d+))?(?:\\r\\n)?",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    return mm_regex_get ("\\r\\n\\+CTZU:\\s*\"(\\d+)\\/(\\d+)\\/(\\d+),(\\d+):(\\d+):(\\d+)\",([\\-\\+\\d]+)(?:,(\\d+))?(?:\\r\\n)?",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 gboolean
@@ -1291,9 +1319,9 @@ mm_cinterion_parse_smoni_query_response (const gchar           *response,
         success = TRUE;
         goto out;
     }
-    pre = g_regex_new ("\\^SMONI:\\s*([234])", 0, 0, NULL);
+    pre = mm_regex_get ("\\^SMONI:\\s*([234])", 0);
     g_assert (pre != NULL);
-    g_regex_match_full (pre, response, strlen (response), 0, 0, &match_info_pre, &inner_error);
+    mm_regex_match_full (pre, response, strlen (response), 0, 0, &match_info_pre, &inner_error);
     if (!inner_error && g_match_info_matches (match_info_pre)) {
         if (!mm_get_uint_from_match_info (match_info_pre, 1, &tech)) {
             inner_error = g_error_new (MM_CORE_ERROR, MM_CORE_ERROR_FAILED, "Couldn't read tech");
@@ -1302,9 +1330,9 @@ mm_cinterion_parse_smoni_query_response (const gchar           *response,
         #define FLOAT "([-+]?[0-9]+\\.?[0-9]*)"
         switch (tech) {
         case MM_CINTERION_RADIO_GEN_2G:
-            r = g_regex_new ("\\^SMONI:\\s*2G,(\\d+),"FLOAT, 0, 0, NULL);
+            r = mm_regex_get ("\\^SMONI:\\s*2G,(\\d+),"FLOAT, 0);
             g_assert (r != NULL);
-            g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+            mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
             if (!inner_error && g_match_info_matches (match_info)) {
                 /* skip ARFCN */
                 if (!mm_get_double_from_match_info (match_info, 2, &rssi)) {
@@ -1314,9 +1342,9 @@ mm_cinterion_parse_smoni_query_response (const gchar           *response,
             }
             break;
         case MM_CINTERION_RADIO_GEN_3G:
-            r = g_regex_new ("\\^SMONI:\\s*3G,(\\d+),(\\d+),"FLOAT","FLOAT, 0, 0, NULL);
+            r = mm_regex_get ("\\^SMONI:\\s*3G,(\\d+),(\\d+),"FLOAT","FLOAT, 0);
             g_assert (r != NULL);
-            g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+            mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
             if (!inner_error && g_match_info_matches (match_info)) {
                 /* skip UARFCN */
                 /* skip PSC (Primary scrambling code) */
@@ -1331,9 +1359,9 @@ mm_cinterion_parse_smoni_query_response (const gchar           *response,
             }
             break;
         case MM_CINTERION_RADIO_GEN_4G:
-            r = g_regex_new ("\\^SMONI:\\s*4G,(\\d+),(\\d+),(\\d+),(\\d+),(\\w+),(\\d+),(\\d+),(\\w+),(\\w+),(\\d+),([^,]*),"FLOAT","FLOAT, 0, 0, NULL);
+            r = mm_regex_get ("\\^SMONI:\\s*4G,(\\d+),(\\d+),(\\d+),(\\d+),(\\w+),(\\d+),(\\d+),(\\w+),(\\w+),(\\d+),([^,]*),"FLOAT","FLOAT, 0);
             g_assert (r != NULL);
-            g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+            mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
             if (!inner_error && g_match_info_matches (match_info)) {
                 /* skip EARFCN */
                 /* skip Band */
@@ -1470,10 +1498,10 @@ mm_cinterion_provcfg_response_to_cid (const gchar             *response,
     g_autofree GError     *inner_error = NULL;
     g_autofree gchar      *mno = NULL;
 
-    r = g_regex_new ("\\^SCFG:\\s*\"MEopMode/Prov/Cfg\",\\s*\"([0-9a-zA-Z]*)\"", 0, 0, NULL);
+    r = mm_regex_get ("\\^SCFG:\\s*\"MEopMode/Prov/Cfg\",\\s*\"([0-9a-zA-Z]*)\"", 0);
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, error))
+    if (!mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, error))
         return FALSE;
 
     mno = mm_get_string_unquoted_from_match_info (match_info, 1);
@@ -133,6 +133,14 @@ gboolean mm_cinterion_parse_smong_response (const gchar              *response,
 MMModemAccessTechnology mm_cinterion_get_access_technology_from_sind_psinfo (guint    val,
                                                                              gpointer log_object);
 
+/*****************************************************************************/
+/* Unsolicited message regexes */
+
+GRegex *mm_cinterion_get_ciev_regex     (void);
+GRegex *mm_cinterion_get_sysstart_regex (void);
+GRegex *mm_cinterion_get_scks_regex     (void);
+GRegex *mm_cinterion_get_shutdown_regex (void);
+
 /*****************************************************************************/
 /* ^SLCC URC helpers */
 
@@ -98,7 +98,7 @@ cinterion_custom_init (MMPortProbe         *probe,
     mm_port_serial_at_command (
         port,
         "AT^SQPORT?",
-        3,
+        3000,
         FALSE, /* raw */
         FALSE, /* allow cached */
         cancellable,
@@ -905,7 +905,7 @@ run_voice_enable_disable_unsolicited_events (GTask *task)
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        port,
                                        ctx->slcc_command,
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE,
                                        NULL,
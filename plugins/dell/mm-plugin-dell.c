@@ -286,7 +286,7 @@ custom_init_step (GTask *task)
         ctx->gmi_retries--;
         mm_port_serial_at_command (ctx->port,
                                    "AT+GMI",
-                                   3,
+                                   3000,
                                    FALSE, /* raw */
                                    FALSE, /* allow_cached */
                                    g_task_get_cancellable (task),
@@ -299,7 +299,7 @@ custom_init_step (GTask *task)
         ctx->cgmi_retries--;
         mm_port_serial_at_command (ctx->port,
                                    "AT+CGMI",
-                                   3,
+                                   3000,
                                    FALSE, /* raw */
                                    FALSE, /* allow_cached */
                                    g_task_get_cancellable (task),
@@ -313,7 +313,7 @@ custom_init_step (GTask *task)
         /* Note: in Ericsson devices, ATI3 seems to reply the vendor string */
         mm_port_serial_at_command (ctx->port,
                                    "ATI1I2I3",
-                                   3,
+                                   3000,
                                    FALSE, /* raw */
                                    FALSE, /* allow_cached */
                                    g_task_get_cancellable (task),
@@ -327,7 +327,7 @@ connect_3gpp_context_step (GTask *task)
             mm_base_modem_at_command_full (ctx->modem,
                                            ctx->primary,
                                            "^NDISDUP=1,0",
-                                           MM_BASE_BEARER_DEFAULT_DISCONNECTION_TIMEOUT,
+                                           MM_BASE_BEARER_DEFAULT_DISCONNECTION_TIMEOUT * 1000,
                                            FALSE,
                                            FALSE,
                                            NULL,
@@ -406,7 +406,7 @@ connect_3gpp_context_step (GTask *task)
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        command,
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE,
                                        NULL,
@@ -449,7 +449,7 @@ connect_3gpp_context_step (GTask *task)
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        "^NDISSTATQRY?",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE,
                                        NULL,
@@ -461,7 +461,7 @@ connect_3gpp_context_step (GTask *task)
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        "^DHCP?",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE,
                                        NULL,
@@ -691,7 +691,7 @@ disconnect_3gpp_context_step (GTask *task)
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        "^NDISDUP=1,0",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE,
                                        NULL,
@@ -729,7 +729,7 @@ disconnect_3gpp_context_step (GTask *task)
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        "^NDISSTATQRY?",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE,
                                        NULL,
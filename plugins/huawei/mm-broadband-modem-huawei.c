@@ -49,6 +49,7 @@
 #include "mm-broadband-bearer.h"
 #include "mm-bearer-list.h"
 #include "mm-sim-huawei.h"
+#include "mm-regex-registry.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 static void iface_modem_3gpp_init (MMIfaceModem3gpp *iface);
@@ -644,11 +645,11 @@ load_unlock_retries_finish (MMIfaceModem *self,
     if (!result)
         return NULL;
 
-    r = g_regex_new ("\\^CPIN:\\s*([^,]+),[^,]*,(\\d+),(\\d+),(\\d+),(\\d+)",
-                     G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_get ("\\^CPIN:\\s*([^,]+),[^,]*,(\\d+),(\\d+),(\\d+),(\\d+)",
+                      G_REGEX_UNGREEDY);
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, result, strlen (result), 0, 0, &match_info, &match_error)) {
+    if (!mm_regex_match_full (r, result, strlen (result), 0, 0, &match_info, &match_error)) {
         if (match_error)
             g_propagate_error (error, match_error);
         else
@@ -2100,7 +2101,7 @@ modem_3gpp_disable_unsolicited_events (MMIfaceModem3gpp *self,
         MM_BASE_MODEM (self),
         mm_base_modem_peek_port_primary (MM_BASE_MODEM (self)),
         "^CURC=0",
-        5,
+        5000,
         FALSE, /* allow_cached */
         FALSE, /* raw */
         NULL, /* cancellable */
@@ -4408,7 +4409,7 @@ setup_ports (MMBroadbandModem *self)
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        mm_base_modem_peek_port_primary (MM_BASE_MODEM (self)),
                                        "^WPEND",
-                                       3, FALSE, FALSE, NULL, NULL, NULL);
+                                       3000, FALSE, FALSE, NULL, NULL, NULL);
         /* Add handler for the NMEA traces */
         mm_port_serial_gps_add_trace_handler (gps_data_port,
                                               (MMPortSerialGpsTraceFn)gps_trace_received,
@@ -4442,74 +4443,39 @@ mm_broadband_modem_huawei_init (MMBroadbandModemHuawei *self)
                                               MM_TYPE_BROADBAND_MODEM_HUAWEI,
                                               MMBroadbandModemHuaweiPrivate);
     /* Prepare regular expressions to setup */
-    self->priv->rssi_regex = g_regex_new ("\\r\\n\\^RSSI:\\s*(\\d+)\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->rssilvl_regex = g_regex_new ("\\r\\n\\^RSSILVL:\\s*(\\d+)\\r+\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->hrssilvl_regex = g_regex_new ("\\r\\n\\^HRSSILVL:\\s*(\\d+)\\r+\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-
-    /* 3GPP: <cr><lf>^MODE:5<cr><lf>
-     * CDMA: <cr><lf>^MODE: 2<cr><cr><lf>
-     */
-    self->priv->mode_regex = g_regex_new ("\\r\\n\\^MODE:\\s*(\\d*),?(\\d*)\\r+\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->dsflowrpt_regex = g_regex_new ("\\r\\n\\^DSFLOWRPT:(.+)\\r\\n",
-                                               G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ndisstat_regex = g_regex_new ("\\r\\n(\\^NDISSTAT:.+)\\r+\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-
-    self->priv->orig_regex = g_regex_new ("\\r\\n\\^ORIG:\\s*(\\d+),\\s*(\\d+)\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->conf_regex = g_regex_new ("\\r\\n\\^CONF:\\s*(\\d+)\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->conn_regex = g_regex_new ("\\r\\n\\^CONN:\\s*(\\d+),\\s*(\\d+)\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->cend_regex = g_regex_new ("\\r\\n\\^CEND:\\s*(\\d+),\\s*(\\d+),\\s*(\\d+)(?:,\\s*(\\d*))?\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ddtmf_regex = g_regex_new ("\\r\\n\\^DDTMF:\\s*([0-9A-D\\*\\#])\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-
-    self->priv->boot_regex = g_regex_new ("\\r\\n\\^BOOT:.+\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->connect_regex = g_regex_new ("\\r\\n\\^CONNECT .+\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->csnr_regex = g_regex_new ("\\r\\n\\^CSNR:.+\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->cusatp_regex = g_regex_new ("\\r\\n\\+CUSATP:.+\\r\\n",
-                                            G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->cusatend_regex = g_regex_new ("\\r\\n\\+CUSATEND\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->dsdormant_regex = g_regex_new ("\\r\\n\\^DSDORMANT:.+\\r\\n",
-                                               G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->simst_regex = g_regex_new ("\\r\\n\\^SIMST:.+\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->srvst_regex = g_regex_new ("\\r\\n\\^SRVST:.+\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->stin_regex = g_regex_new ("\\r\\n\\^STIN:.+\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->hcsq_regex = g_regex_new ("\\r\\n(\\^HCSQ:.+)\\r+\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->pdpdeact_regex = g_regex_new ("\\r\\n\\^PDPDEACT:.+\\r+\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ndisend_regex = g_regex_new ("\\r\\n\\^NDISEND:.+\\r+\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->rfswitch_regex = g_regex_new ("\\r\\n\\^RFSWITCH:.+\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->position_regex = g_regex_new ("\\r\\n\\^POSITION:.+\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->posend_regex = g_regex_new ("\\r\\n\\^POSEND:.+\\r\\n",
-                                            G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ecclist_regex = g_regex_new ("\\r\\n\\^ECCLIST:.+\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ltersrp_regex = g_regex_new ("\\r\\n\\^LTERSRP:.+\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->cschannelinfo_regex = g_regex_new ("\\r\\n\\^CSCHANNELINFO:.+\\r\\n",
-                                                    G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ccallstate_regex = g_regex_new ("\\r\\n\\^CCALLSTATE:.+\\r\\n",
-                                                G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->eons_regex = g_regex_new ("\\r\\n\\^EONS:.+\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->rssi_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_RSSI);
+    self->priv->rssilvl_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_RSSILVL);
+    self->priv->hrssilvl_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_HRSSILVL);
+    self->priv->mode_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_MODE);
+    self->priv->dsflowrpt_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_DSFLOWRPT);
+    self->priv->ndisstat_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_NDISSTAT);
+
+    self->priv->orig_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_ORIG);
+    self->priv->conf_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_CONF);
+    self->priv->conn_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_CONN);
+    self->priv->cend_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_CEND);
+    self->priv->ddtmf_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_DDTMF);
+
+    self->priv->boot_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_BOOT);
+    self->priv->connect_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_CONNECT);
+    self->priv->csnr_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_CSNR);
+    self->priv->cusatp_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_CUSATP);
+    self->priv->cusatend_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_CUSATEND);
+    self->priv->dsdormant_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_DSDORMANT);
+    self->priv->simst_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_SIMST);
+    self->priv->srvst_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_SRVST);
+    self->priv->stin_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_STIN);
+    self->priv->hcsq_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_HCSQ);
+    self->priv->pdpdeact_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_PDPDEACT);
+    self->priv->ndisend_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_NDISEND);
+    self->priv->rfswitch_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_RFSWITCH);
+    self->priv->position_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_POSITION);
+    self->priv->posend_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_POSEND);
+    self->priv->ecclist_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_ECCLIST);
+    self->priv->ltersrp_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_LTERSRP);
+    self->priv->cschannelinfo_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_CSCHANNELINFO);
+    self->priv->ccallstate_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_CCALLSTATE);
+    self->priv->eons_regex = mm_huawei_get_urc_regex (MM_HUAWEI_URC_EONS);
 
     self->priv->ndisdup_support = FEATURE_SUPPORT_UNKNOWN;
     self->priv->rfswitch_support = FEATURE_SUPPORT_UNKNOWN;
@@ -26,6 +26,7 @@
 #include "mm-modem-helpers.h"
 #include "mm-modem-helpers-huawei.h"
 #include "mm-huawei-enums-types.h"
+#include "mm-regex-registry.h"
 
 /*****************************************************************************/
 /* ^NDISSTAT /  ^NDISSTATQRY response parser */
@@ -70,13 +71,12 @@ mm_huawei_parse_ndisstatqry_response (const gchar *response,
 
     /* If multiple fields available, try first parsing method */
     if (strchr (response, ',')) {
-        r = g_regex_new ("\\^NDISSTAT(?:QRY)?(?:Qry)?:\\s*(\\d),([^,]*),([^,]*),([^,\\r\\n]*)(?:\\r\\n)?"
-                         "(?:\\^NDISSTAT:|\\^NDISSTATQRY:)?\\s*,?(\\d)?,?([^,]*)?,?([^,]*)?,?([^,\\r\\n]*)?(?:\\r\\n)?",
-                         G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
-                         0, NULL);
+        r = mm_regex_get ("\\^NDISSTAT(?:QRY)?(?:Qry)?:\\s*(\\d),([^,]*),([^,]*),([^,\\r\\n]*)(?:\\r\\n)?"
+                          "(?:\\^NDISSTAT:|\\^NDISSTATQRY:)?\\s*,?(\\d)?,?([^,]*)?,?([^,]*)?,?([^,\\r\\n]*)?(?:\\r\\n)?",
+                          G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW);
         g_assert (r != NULL);
 
-        g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+        mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
         if (!inner_error && g_match_info_matches (match_info)) {
             guint ip_type_field = 4;
 
@@ -113,12 +113,11 @@ mm_huawei_parse_ndisstatqry_response (const gchar *response,
     }
     /* No separate IPv4/IPv6 info given just connected/not connected */
     else {
-        r = g_regex_new ("\\^NDISSTAT(?:QRY)?(?:Qry)?:\\s*(\\d)(?:\\r\\n)?",
-                         G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
-                         0, NULL);
+        r = mm_regex_get ("\\^NDISSTAT(?:QRY)?(?:Qry)?:\\s*(\\d)(?:\\r\\n)?",
+                          G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW);
         g_assert (r != NULL);
 
-        g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+        mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
         if (!inner_error && g_match_info_matches (match_info)) {
             guint connected;
 
@@ -233,10 +232,10 @@ mm_huawei_parse_dhcp_response (const char *reply,
      * actually 10.10.1.1.
      */
 
-    r = g_regex_new ("\\^DHCP:\\s*(?:0[xX])?([0-9a-fA-F]+),(?:0[xX])?([0-9a-fA-F]+),(?:0[xX])?([0-9a-fA-F]+),(?:0[xX])?([0-9a-fA-F]+),(?:0[xX])?([0-9a-fA-F]+),(?:0[xX])?([0-9a-fA-F]+),.*$", 0, 0, NULL);
+    r = mm_regex_get ("\\^DHCP:\\s*(?:0[xX])?([0-9a-fA-F]+),(?:0[xX])?([0-9a-fA-F]+),(?:0[xX])?([0-9a-fA-F]+),(?:0[xX])?([0-9a-fA-F]+),(?:0[xX])?([0-9a-fA-F]+),(?:0[xX])?([0-9a-fA-F]+),.*$", 0);
     g_assert (r != NULL);
 
-    matched = g_regex_match_full (r, reply, -1, 0, 0, &match_info, &match_error);
+    matched = mm_regex_match_full (r, reply, -1, 0, 0, &match_info, &match_error);
     if (!matched) {
         if (match_error) {
             g_propagate_error (error, match_error);
@@ -298,10 +297,10 @@ mm_huawei_parse_sysinfo_response (const char *reply,
      */
 
     /* Can't just use \d here since sometimes you get "^SYSINFO:2,1,0,3,1,,3" */
-    r = g_regex_new ("\\^SYSINFO:\\s*(\\d+),(\\d+),(\\d+),(\\d+),(\\d+),?(\\d+)?,?(\\d+)?$", 0, 0, NULL);
+    r = mm_regex_get ("\\^SYSINFO:\\s*(\\d+),(\\d+),(\\d+),(\\d+),(\\d+),?(\\d+)?,?(\\d+)?$", 0);
     g_assert (r != NULL);
 
-    matched = g_regex_match_full (r, reply, -1, 0, 0, &match_info, &match_error);
+    matched = mm_regex_match_full (r, reply, -1, 0, 0, &match_info, &match_error);
     if (!matched) {
         if (match_error) {
             g_propagate_error (error, match_error);
@@ -365,10 +364,10 @@ mm_huawei_parse_sysinfoex_response (const char *reply,
 
     /* ^SYSINFOEX:2,3,0,1,,3,"WCDMA",41,"HSPA+" */
 
-    r = g_regex_new ("\\^SYSINFOEX:\\s*(\\d+),(\\d+),(\\d+),(\\d+),?(\\d*),(\\d+),\"?([^\"]*)\"?,(\\d+),\"?([^\"]*)\"?$", 0, 0, NULL);
+    r = mm_regex_get ("\\^SYSINFOEX:\\s*(\\d+),(\\d+),(\\d+),(\\d+),?(\\d*),(\\d+),\"?([^\"]*)\"?,(\\d+),\"?([^\"]*)\"?$", 0);
     g_assert (r != NULL);
 
-    matched = g_regex_match_full (r, reply, -1, 0, 0, &match_info, &match_error);
+    matched = mm_regex_match_full (r, reply, -1, 0, 0, &match_info, &match_error);
     if (!matched) {
         if (match_error) {
             g_propagate_error (error, match_error);
@@ -1206,10 +1205,10 @@ gboolean mm_huawei_parse_nwtime_response (const gchar *response,
 
     g_assert (iso8601p || tzp); /* at least one */
 
-    r = g_regex_new ("\\^NWTIME:\\s*(\\d+)/(\\d+)/(\\d+),(\\d+):(\\d+):(\\d*)([\\-\\+\\d]+),(\\d+)$", 0, 0, NULL);
+    r = mm_regex_get ("\\^NWTIME:\\s*(\\d+)/(\\d+)/(\\d+),(\\d+):(\\d+):(\\d*)([\\-\\+\\d]+),(\\d+)$", 0);
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
+    if (!mm_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
         if (match_error) {
             g_propagate_error (error, match_error);
             g_prefix_error (error, "Could not parse ^NWTIME results: ");
@@ -1292,10 +1291,10 @@ gboolean mm_huawei_parse_time_response (const gchar *response,
     }
 
     /* Already in ISO-8601 format, but verify just to be sure */
-    r = g_regex_new ("\\^TIME:\\s*(\\d+)/(\\d+)/(\\d+)\\s*(\\d+):(\\d+):(\\d*)$", 0, 0, NULL);
+    r = mm_regex_get ("\\^TIME:\\s*(\\d+)/(\\d+)/(\\d+)\\s*(\\d+):(\\d+):(\\d*)$", 0);
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
+    if (!mm_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
         if (match_error) {
             g_propagate_error (error, match_error);
             g_prefix_error (error, "Could not parse ^TIME results: ");
@@ -1356,10 +1355,10 @@ mm_huawei_parse_hcsq_response (const gchar *response,
     gboolean ret = FALSE;
     char *s;
 
-    r = g_regex_new ("\\^HCSQ:\\s*\"?([a-zA-Z]*)\"?,(\\d+),?(\\d+)?,?(\\d+)?,?(\\d+)?,?(\\d+)?$", 0, 0, NULL);
+    r = mm_regex_get ("\\^HCSQ:\\s*\"?([a-zA-Z]*)\"?,(\\d+),?(\\d+)?,?(\\d+)?,?(\\d+)?,?(\\d+)?$", 0);
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
+    if (!mm_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
         if (match_error) {
             g_propagate_error (error, match_error);
             g_prefix_error (error, "Could not parse ^HCSQ results: ");
@@ -1423,10 +1422,10 @@ mm_huawei_parse_cvoice_response (const gchar  *response,
     gboolean ret = FALSE;
 
     /* ^CVOICE: <0=supported,1=unsupported>,<hz>,<bits>,<unknown> */
-    r = g_regex_new ("\\^CVOICE:\\s*(\\d)\\s*,\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,\\s*(\\d+)$", 0, 0, NULL);
+    r = mm_regex_get ("\\^CVOICE:\\s*(\\d)\\s*,\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,\\s*(\\d+)$", 0);
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
+    if (!mm_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
         if (match_error) {
             g_propagate_error (error, match_error);
             g_prefix_error (error, "Could not parse ^CVOICE results: ");
@@ -1565,3 +1564,50 @@ mm_huawei_parse_getportmode_response (const gchar  *response,
 
     return g_steal_pointer (&modes);
 }
+
+/*****************************************************************************/
+/* Unsolicited message regexes */
+
+static const gchar *urc_patterns[] = {
+    [MM_HUAWEI_URC_RSSI] = "\\r\\n\\^RSSI:\\s*(\\d+)\\r\\n",
+    [MM_HUAWEI_URC_RSSILVL] = "\\r\\n\\^RSSILVL:\\s*(\\d+)\\r+\\n",
+    [MM_HUAWEI_URC_HRSSILVL] = "\\r\\n\\^HRSSILVL:\\s*(\\d+)\\r+\\n",
+    /* 3GPP: <cr><lf>^MODE:5<cr><lf>
+     * CDMA: <cr><lf>^MODE: 2<cr><cr><lf>
+     */
+    [MM_HUAWEI_URC_MODE] = "\\r\\n\\^MODE:\\s*(\\d*),?(\\d*)\\r+\\n",
+    [MM_HUAWEI_URC_DSFLOWRPT] = "\\r\\n\\^DSFLOWRPT:(.+)\\r\\n",
+    [MM_HUAWEI_URC_NDISSTAT] = "\\r\\n(\\^NDISSTAT:.+)\\r+\\n",
+    [MM_HUAWEI_URC_ORIG] = "\\r\\n\\^ORIG:\\s*(\\d+),\\s*(\\d+)\\r\\n",
+    [MM_HUAWEI_URC_CONF] = "\\r\\n\\^CONF:\\s*(\\d+)\\r\\n",
+    [MM_HUAWEI_URC_CONN] = "\\r\\n\\^CONN:\\s*(\\d+),\\s*(\\d+)\\r\\n",
+    [MM_HUAWEI_URC_CEND] = "\\r\\n\\^CEND:\\s*(\\d+),\\s*(\\d+),\\s*(\\d+)(?:,\\s*(\\d*))?\\r\\n",
+    [MM_HUAWEI_URC_DDTMF] = "\\r\\n\\^DDTMF:\\s*([0-9A-D\\*\\#])\\r\\n",
+    [MM_HUAWEI_URC_BOOT] = "\\r\\n\\^BOOT:.+\\r\\n",
+    [MM_HUAWEI_URC_CONNECT] = "\\r\\n\\^CONNECT .+\\r\\n",
+    [MM_HUAWEI_URC_CSNR] = "\\r\\n\\^CSNR:.+\\r\\n",
+    [MM_HUAWEI_URC_CUSATP] = "\\r\\n\\+CUSATP:.+\\r\\n",
+    [MM_HUAWEI_URC_CUSATEND] = "\\r\\n\\+CUSATEND\\r\\n",
+    [MM_HUAWEI_URC_DSDORMANT] = "\\r\\n\\^DSDORMANT:.+\\r\\n",
+    [MM_HUAWEI_URC_SIMST] = "\\r\\n\\^SIMST:.+\\r\\n",
+    [MM_HUAWEI_URC_SRVST] = "\\r\\n\\^SRVST:.+\\r\\n",
+    [MM_HUAWEI_URC_STIN] = "\\r\\n\\^STIN:.+\\r\\n",
+    [MM_HUAWEI_URC_HCSQ] = "\\r\\n(\\^HCSQ:.+)\\r+\\n",
+    [MM_HUAWEI_URC_PDPDEACT] = "\\r\\n\\^PDPDEACT:.+\\r+\\n",
+    [MM_HUAWEI_URC_NDISEND] = "\\r\\n\\^NDISEND:.+\\r+\\n",
+    [MM_HUAWEI_URC_RFSWITCH] = "\\r\\n\\^RFSWITCH:.+\\r\\n",
+    [MM_HUAWEI_URC_POSITION] = "\\r\\n\\^POSITION:.+\\r\\n",
+    [MM_HUAWEI_URC_POSEND] = "\\r\\n\\^POSEND:.+\\r\\n",
+    [MM_HUAWEI_URC_ECCLIST] = "\\r\\n\\^ECCLIST:.+\\r\\n",
+    [MM_HUAWEI_URC_LTERSRP] = "\\r\\n\\^LTERSRP:.+\\r\\n",
+    [MM_HUAWEI_URC_CSCHANNELINFO] = "\\r\\n\\^CSCHANNELINFO:.+\\r\\n",
+    [MM_HUAWEI_URC_CCALLSTATE] = "\\r\\n\\^CCALLSTATE:.+\\r\\n",
+    [MM_HUAWEI_URC_EONS] = "\\r\\n\\^EONS:.+\\r\\n",
+};
+
+GRegex *
+mm_huawei_get_urc_regex (MMHuaweiUrc urc)
+{
+    g_assert (urc < G_N_ELEMENTS (urc_patterns));
+    return mm_regex_get_dynamic (urc_patterns[urc], G_REGEX_RAW | G_REGEX_OPTIMIZE);
+}
@@ -190,4 +190,44 @@ GArray *mm_huawei_parse_getportmode_response (const gchar  *response,
                                               gpointer      log_object,
                                               GError      **error);
 
+/*****************************************************************************/
+/* Unsolicited message regexes */
+
+typedef enum { /*< underscore_name=mm_huawei_urc >*/
+    MM_HUAWEI_URC_RSSI,
+    MM_HUAWEI_URC_RSSILVL,
+    MM_HUAWEI_URC_HRSSILVL,
+    MM_HUAWEI_URC_MODE,
+    MM_HUAWEI_URC_DSFLOWRPT,
+    MM_HUAWEI_URC_NDISSTAT,
+    MM_HUAWEI_URC_ORIG,
+    MM_HUAWEI_URC_CONF,
+    MM_HUAWEI_URC_CONN,
+    MM_HUAWEI_URC_CEND,
+    MM_HUAWEI_URC_DDTMF,
+    MM_HUAWEI_URC_BOOT,
+    MM_HUAWEI_URC_CONNECT,
+    MM_HUAWEI_URC_CSNR,
+    MM_HUAWEI_URC_CUSATP,
+    MM_HUAWEI_URC_CUSATEND,
+    MM_HUAWEI_URC_DSDORMANT,
+    MM_HUAWEI_URC_SIMST,
+    MM_HUAWEI_URC_SRVST,
+    MM_HUAWEI_URC_STIN,
+    MM_HUAWEI_URC_HCSQ,
+    MM_HUAWEI_URC_PDPDEACT,
+    MM_HUAWEI_URC_NDISEND,
+    MM_HUAWEI_URC_RFSWITCH,
+    MM_HUAWEI_URC_POSITION,
+    MM_HUAWEI_URC_POSEND,
+    MM_HUAWEI_URC_ECCLIST,
+    MM_HUAWEI_URC_LTERSRP,
+    MM_HUAWEI_URC_CSCHANNELINFO,
+    MM_HUAWEI_URC_CCALLSTATE,
+    MM_HUAWEI_URC_EONS,
+    MM_HUAWEI_URC_LAST = MM_HUAWEI_URC_EONS /*< skip >*/
+} MMHuaweiUrc;
+
+GRegex *mm_huawei_get_urc_regex (MMHuaweiUrc urc);
+
 #endif  /* MM_MODEM_HELPERS_HUAWEI_H */
@@ -247,7 +247,7 @@ huawei_custom_init_step (GTask *task)
         mm_port_serial_at_command (
             ctx->port,
             "AT^CURC=0",
-            3,
+            3000,
             FALSE, /* raw */
             FALSE, /* allow_cached */
             g_task_get_cancellable (task),
@@ -269,7 +269,7 @@ huawei_custom_init_step (GTask *task)
         mm_port_serial_at_command (
             ctx->port,
             "AT^GETPORTMODE",
-            3,
+            3000,
             FALSE, /* raw */
             FALSE, /* allow_cached */
             g_task_get_cancellable (task),
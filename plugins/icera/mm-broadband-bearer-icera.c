@@ -183,7 +183,7 @@ get_ip_config_3gpp (MMBroadbandBearer *_self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (modem),
                                        primary,
                                        command,
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -364,7 +364,7 @@ disconnect_3gpp (MMBroadbandBearer *bearer,
         MM_BASE_MODEM (modem),
         primary,
         command,
-        MM_BASE_BEARER_DEFAULT_DISCONNECTION_TIMEOUT,
+        MM_BASE_BEARER_DEFAULT_DISCONNECTION_TIMEOUT * 1000,
         FALSE,
         FALSE, /* raw */
         NULL, /* cancellable */
@@ -437,7 +437,7 @@ connect_reset (GTask *task)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   MM_BASE_BEARER_DEFAULT_DISCONNECTION_TIMEOUT,
+                                   MM_BASE_BEARER_DEFAULT_DISCONNECTION_TIMEOUT * 1000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -567,7 +567,7 @@ process_pending_connect_attempt (MMBroadbandBearerIcera   *self,
             ctx->modem,
             ctx->primary,
             "%IER?",
-            60,
+            60000,
             FALSE,
             FALSE, /* raw */
             NULL, /* cancellable */
@@ -698,7 +698,7 @@ authenticate_ready (MMBaseModem  *modem,
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   MM_BASE_BEARER_DEFAULT_CONNECTION_TIMEOUT,
+                                   MM_BASE_BEARER_DEFAULT_CONNECTION_TIMEOUT * 1000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -770,7 +770,7 @@ authenticate (GTask *task)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   60,
+                                   60000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -812,7 +812,7 @@ connect_deactivate (GTask *task)
         ctx->modem,
         ctx->primary,
         command,
-        MM_BASE_BEARER_DEFAULT_DISCONNECTION_TIMEOUT,
+        MM_BASE_BEARER_DEFAULT_DISCONNECTION_TIMEOUT * 1000,
         FALSE,
         FALSE, /* raw */
         NULL, /* cancellable */
@@ -35,6 +35,7 @@
 #include "mm-bearer-list.h"
 #include "mm-broadband-bearer-icera.h"
 #include "mm-broadband-modem-icera.h"
+#include "mm-regex-registry.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 static void iface_modem_3gpp_init (MMIfaceModem3gpp *iface);
@@ -133,11 +134,11 @@ load_supported_modes_finish (MMIfaceModem *self,
      * %IPSYS: (0-3,5),(0-3)
      */
 
-    r = g_regex_new ("\\%IPSYS:\\s*\\((.*)\\)\\s*,\\((.*)\\)",
-                     G_REGEX_RAW, 0, NULL);
+    r = mm_regex_get ("\\%IPSYS:\\s*\\((.*)\\)\\s*,\\((.*)\\)",
+                      G_REGEX_RAW);
     g_assert (r != NULL);
 
-    g_regex_match (r, response, 0, &match_info);
+    mm_regex_match (r, response, 0, &match_info);
     if (g_match_info_matches (match_info)) {
         gchar *aux;
 
@@ -1123,12 +1124,11 @@ parse_bands (const gchar *response, guint32 *out_len)
      *   ...
      * with 1 and 0 indicating whether the particular band is enabled or not.
      */
-    r = g_regex_new ("^\"(\\w+)\": (\\d)",
-                     G_REGEX_MULTILINE, G_REGEX_MATCH_NEWLINE_ANY,
-                     NULL);
+    r = mm_regex_get ("^\"(\\w+)\": (\\d)",
+                      G_REGEX_MULTILINE);
     g_assert (r != NULL);
 
-    g_regex_match (r, response, 0, &info);
+    mm_regex_match (r, response, G_REGEX_MATCH_NEWLINE_ANY, &info);
     while (g_match_info_matches (info)) {
         gchar *name, *enabled;
         Band *b;
@@ -1762,6 +1762,9 @@ mm_broadband_modem_icera_new (const gchar *device,
                          MM_BASE_MODEM_PLUGIN, plugin,
                          MM_BASE_MODEM_VENDOR_ID, vendor_id,
                          MM_BASE_MODEM_PRODUCT_ID, product_id,
+                         /* Supported bands are probed with AT commands, and
+                          * no state is kept while doing so */
+                         MM_IFACE_MODEM_SUPPORTED_BANDS_CACHEABLE, TRUE,
                          NULL);
 }
 
@@ -1809,12 +1812,12 @@ mm_broadband_modem_icera_init (MMBroadbandModemIcera *self)
                                               MM_TYPE_BROADBAND_MODEM_ICERA,
                                               MMBroadbandModemIceraPrivate);
 
-    self->priv->nwstate_regex = g_regex_new ("%NWSTATE:\\s*(-?\\d+),(\\d+),([^,]*),([^,]*),(\\d+)",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->pacsp_regex = g_regex_new ("\\r\\n\\+PACSP(\\d)\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ipdpact_regex = g_regex_new ("\\r\\n%IPDPACT:\\s*(\\d+),\\s*(\\d+),\\s*(\\d+)\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->nwstate_regex = mm_regex_get ("%NWSTATE:\\s*(-?\\d+),(\\d+),([^,]*),([^,]*),(\\d+)",
+                                              G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->pacsp_regex = mm_regex_get ("\\r\\n\\+PACSP(\\d)\\r\\n",
+                                            G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->ipdpact_regex = mm_regex_get ("\\r\\n%IPDPACT:\\s*(\\d+),\\s*(\\d+),\\s*(\\d+)\\r\\n",
+                                              G_REGEX_RAW | G_REGEX_OPTIMIZE);
 
     self->priv->default_ip_method = MM_BEARER_IP_METHOD_STATIC;
     self->priv->last_act = MM_MODEM_ACCESS_TECHNOLOGY_UNKNOWN;
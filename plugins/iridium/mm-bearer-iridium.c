@@ -109,7 +109,7 @@ dial_ready (MMBaseModem *modem,
             modem,
             ctx->primary,
             "+CEER",
-            3,
+            3000,
             FALSE,
             FALSE, /* raw */
             NULL, /* cancellable */
@@ -165,7 +165,7 @@ service_type_ready (MMBaseModem *modem,
         modem,
         ctx->primary,
         "ATDT008816000025",
-        MM_BASE_BEARER_DEFAULT_CONNECTION_TIMEOUT,
+        MM_BASE_BEARER_DEFAULT_CONNECTION_TIMEOUT * 1000,
         FALSE,
         FALSE, /* raw */
         NULL, /* cancellable */
@@ -204,7 +204,7 @@ connect (MMBaseBearer *self,
         modem,
         ctx->primary,
         "+CBST=71,0,1",
-        3,
+        3000,
         FALSE,
         FALSE, /* raw */
         NULL, /* cancellable */
@@ -128,7 +128,7 @@ longcheer_custom_init_step (GTask *task)
     mm_port_serial_at_command (
         ctx->port,
         "AT+GMR",
-        3,
+        3000,
         FALSE, /* raw */
         FALSE, /* allow_cached */
         cancellable,
@@ -247,7 +247,7 @@ connect_poll_cb (MMBroadbandBearerMbm *self)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    "AT*ENAP?",
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    g_task_get_cancellable (task),
@@ -318,7 +318,7 @@ activate (GTask *task)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   10,
+                                   10000,
                                    FALSE,
                                    FALSE, /* raw */
                                    g_task_get_cancellable (task),
@@ -378,7 +378,7 @@ authenticate (GTask *task)
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        command,
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        g_task_get_cancellable (task),
@@ -556,7 +556,7 @@ get_ip_config_3gpp (MMBroadbandBearer *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (modem),
                                    primary,
                                    "*E2IPCFG?",
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -697,7 +697,7 @@ disconnect_poll_cb (MMBroadbandBearerMbm *self)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    "AT*ENAP?",
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -775,7 +775,7 @@ disconnect_3gpp (MMBroadbandBearer   *_self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (modem),
                                    primary,
                                    "*ENAP=0",
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -43,6 +43,7 @@
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-3gpp.h"
 #include "mm-iface-modem-location.h"
+#include "mm-regex-registry.h"
 
 /* sets the interval in seconds on how often the card emits the NMEA sentences */
 #define MBM_GPS_NMEA_INTERVAL   "5"
@@ -1192,7 +1193,7 @@ disable_location_gathering (MMIfaceModemLocation *_self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (_self),
                                        mm_base_modem_peek_port_primary (MM_BASE_MODEM (_self)),
                                        "AT*E2GPSCTL=0",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -1260,7 +1261,7 @@ gps_enabled_ready (MMBaseModem *self,
             g_byte_array_append (buf, (const guint8 *) command, strlen (command));
             mm_port_serial_command (MM_PORT_SERIAL (gps_port),
                                     buf,
-                                    3,
+                                    3000,
                                     FALSE, /* never cached */
                                     FALSE, /* always queued last */
                                     NULL,
@@ -1311,7 +1312,7 @@ parent_enable_location_gathering_ready (MMIfaceModemLocation *_self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        mm_base_modem_peek_port_primary (MM_BASE_MODEM (self)),
                                        "AT*E2GPSCTL=1," MBM_GPS_NMEA_INTERVAL ",0",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -1433,7 +1434,7 @@ setup_ports (MMBroadbandModem *_self)
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        mm_base_modem_peek_port_primary (MM_BASE_MODEM (self)),
                                        "AT*E2GPSCTL=0",
-                                       3, FALSE, FALSE, NULL, NULL, NULL);
+                                       3000, FALSE, FALSE, NULL, NULL, NULL);
         /* Add handler for the NMEA traces */
         mm_port_serial_gps_add_trace_handler (gps_data_port,
                                               (MMPortSerialGpsTraceFn)gps_trace_received,
@@ -1468,22 +1469,22 @@ mm_broadband_modem_mbm_init (MMBroadbandModemMbm *self)
                                               MMBroadbandModemMbmPrivate);
 
     /* Prepare regular expressions to setup */
-    self->priv->e2nap_regex = g_regex_new ("\\r\\n\\*E2NAP: (\\d)\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->e2nap_ext_regex = g_regex_new ("\\r\\n\\*E2NAP: (\\d),.*\\r\\n",
-                                               G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->emrdy_regex = g_regex_new ("\\r\\n\\*EMRDY: \\d\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->pacsp_regex = g_regex_new ("\\r\\n\\+PACSP(\\d)\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->estksmenu_regex = g_regex_new ("\\R\\*ESTKSMENU:.*\\R",
-                                               G_REGEX_RAW | G_REGEX_OPTIMIZE | G_REGEX_MULTILINE | G_REGEX_NEWLINE_CRLF, G_REGEX_MATCH_NEWLINE_CRLF, NULL);
-    self->priv->estksms_regex = g_regex_new ("\\r\\n\\*ESTKSMS:.*\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->emwi_regex = g_regex_new ("\\r\\n\\*EMWI: (\\d),(\\d).*\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->erinfo_regex = g_regex_new ("\\r\\n\\*ERINFO:\\s*(\\d),(\\d),(\\d).*\\r\\n",
-                                            G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->e2nap_regex = mm_regex_get ("\\r\\n\\*E2NAP: (\\d)\\r\\n",
+                                            G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->e2nap_ext_regex = mm_regex_get ("\\r\\n\\*E2NAP: (\\d),.*\\r\\n",
+                                                G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->emrdy_regex = mm_regex_get ("\\r\\n\\*EMRDY: \\d\\r\\n",
+                                            G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->pacsp_regex = mm_regex_get ("\\r\\n\\+PACSP(\\d)\\r\\n",
+                                            G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->estksmenu_regex = mm_regex_get ("\\R\\*ESTKSMENU:.*\\R",
+                                                G_REGEX_RAW | G_REGEX_OPTIMIZE | G_REGEX_MULTILINE | G_REGEX_NEWLINE_CRLF);
+    self->priv->estksms_regex = mm_regex_get ("\\r\\n\\*ESTKSMS:.*\\r\\n",
+                                              G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->emwi_regex = mm_regex_get ("\\r\\n\\*EMWI: (\\d),(\\d).*\\r\\n",
+                                           G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->erinfo_regex = mm_regex_get ("\\r\\n\\*ERINFO:\\s*(\\d),(\\d),(\\d).*\\r\\n",
+                                             G_REGEX_RAW | G_REGEX_OPTIMIZE);
 
     self->priv->mbm_mode = MBM_NETWORK_MODE_ANY;
 }
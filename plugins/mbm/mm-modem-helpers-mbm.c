@@ -28,6 +28,7 @@
 #include "mm-log.h"
 #include "mm-modem-helpers.h"
 #include "mm-modem-helpers-mbm.h"
+#include "mm-regex-registry.h"
 
 /*****************************************************************************/
 /* *E2IPCFG response parser */
@@ -95,10 +96,10 @@ mm_mbm_parse_e2ipcfg_response (const gchar *response,
      * *E2IPCFG: (1,"fe80:0000:0000:0000:0000:0000:e537:1801")(3,"2001:4600:0004:0fff:0000:0000:0000:0054")(3,"2001:4600:0004:1fff:0000:0000:0000:0054")
      * *E2IPCFG: (1,"fe80:0000:0000:0000:0000:0027:b7fe:9401")(3,"fd00:976a:0000:0000:0000:0000:0000:0009")
      */
-    r = g_regex_new ("\\((\\d),\"([0-9a-fA-F.:]+)\"\\)", 0, 0, NULL);
+    r = mm_regex_get ("\\((\\d),\"([0-9a-fA-F.:]+)\"\\)", 0);
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
+    if (!mm_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
         if (match_error) {
             g_propagate_error (error, match_error);
             g_prefix_error (error, "Could not parse " E2IPCFG_TAG " results: ");
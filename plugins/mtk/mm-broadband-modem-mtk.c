@@ -31,6 +31,7 @@
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-3gpp.h"
 #include "mm-broadband-modem-mtk.h"
+#include "mm-regex-registry.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 static void iface_modem_3gpp_init (MMIfaceModem3gpp *iface);
@@ -82,15 +83,13 @@ load_unlock_retries_ready (MMBaseModem *self,
         return;
     }
 
-    r = g_regex_new (
+    r = mm_regex_get (
             "\\+EPINC:\\s*([0-9]+),\\s*([0-9]+),\\s*([0-9]+),\\s*([0-9]+)",
-            0,
-            0,
-            NULL);
+            0);
 
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &match_error)){
+    if (!mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &match_error)){
         if (match_error) {
             g_propagate_error (&error, match_error);
         } else {
@@ -194,11 +193,11 @@ get_supported_modes_ready (MMBaseModem *self,
         return;
     }
 
-    r = g_regex_new ("\\+EGMR:\\s*\"MT([0-9]+)",
-            G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    r = mm_regex_get ("\\+EGMR:\\s*\"MT([0-9]+)",
+            G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &match_error)) {
+    if (!mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &match_error)) {
         if (match_error) {
             g_propagate_error (&error, match_error);
         } else {
@@ -322,14 +321,12 @@ load_current_modes_finish (MMIfaceModem *self,
     if (!response)
         return result;
 
-    r = g_regex_new (
+    r = mm_regex_get (
                 "\\+ERAT:\\s*[0-9]+,\\s*[0-9]+,\\s*([0-9]+),\\s*([0-9]+)",
-                0,
-                0,
-                error);
+                0);
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &match_error)) {
+    if (!mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &match_error)) {
         if (match_error)
             g_propagate_error (error, match_error);
         else {
@@ -886,21 +883,21 @@ mm_broadband_modem_mtk_init (MMBroadbandModemMtk *self)
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE ((self),
                                               MM_TYPE_BROADBAND_MODEM_MTK,
                                               MMBroadbandModemMtkPrivate);
-    self->priv->ecsqg_regex = g_regex_new (
+    self->priv->ecsqg_regex = mm_regex_get (
         "\\r\\n\\+ECSQ:\\s*([0-9]*),\\s*[0-9]*,\\s*-[0-9]*\\r\\n",
-        G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ecsqu_regex = g_regex_new (
+        G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->ecsqu_regex = mm_regex_get (
         "\\r\\n\\+ECSQ:\\s*([0-9]*),\\s*[0-9]*,\\s*-[0-9]*,\\s*-[0-9]*,\\s*-[0-9]*\\r\\n",
-        G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ecsqeg_regex = g_regex_new (
+        G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->ecsqeg_regex = mm_regex_get (
         "\\r\\n\\+ECSQ:\\s*([0-9]*),\\s*[0-9]*,\\s*-[0-9]*,\\s*1,\\s*1,\\s*1,\\s*1,\\s*[0-9]*\\r\\n",
-        G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ecsqeu_regex = g_regex_new (
+        G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->ecsqeu_regex = mm_regex_get (
         "\\r\\n\\+ECSQ:\\s*([0-9]*),\\s*[0-9]*,\\s*1,\\s*-[0-9]*,\\s*-[0-9]*,\\s*1,\\s*1,\\s*[0-9]*\\r\\n",
-        G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ecsqel_regex = g_regex_new (
+        G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->ecsqel_regex = mm_regex_get (
         "\\r\\n\\+ECSQ:\\s*[0-9]*,\\s*([0-9]*),\\s*1,\\s*1,\\s*1,\\s*-[0-9]*,\\s*-[0-9]*,\\s*[0-9]*\\r\\n",
-        G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 static void
@@ -258,7 +258,7 @@ retry_atz (GTask *task)
     mm_base_modem_at_command_full (self,
                                    mm_base_modem_peek_port_primary (self),
                                    "Z",
-                                   6,
+                                   6000,
                                    FALSE,
                                    FALSE,
                                    NULL, /* cancellable */
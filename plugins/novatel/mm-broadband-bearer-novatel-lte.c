@@ -253,7 +253,7 @@ connect_3gpp_qmistatus (GTask *task)
         ctx->modem,
         ctx->primary,
         "$NWQMISTATUS",
-        3, /* timeout */
+        3000, /* timeout */
         FALSE, /* allow_cached */
         FALSE, /* is_raw */
         g_task_get_cancellable (task),
@@ -311,7 +311,7 @@ connect_3gpp_authenticate (GTask *task)
         ctx->modem,
         ctx->primary,
         command,
-        10, /* timeout */
+        10000, /* timeout */
         FALSE, /* allow_cached */
         FALSE, /* is_raw */
         g_task_get_cancellable (task),
@@ -452,7 +452,7 @@ disconnect_3gpp_qmistatus (GTask *task)
         ctx->modem,
         ctx->primary,
         "$NWQMISTATUS",
-        3, /* timeout */
+        3000, /* timeout */
         FALSE, /* allow_cached */
         FALSE, /* is_raw */
         NULL, /* cancellable */
@@ -507,7 +507,7 @@ disconnect_3gpp (MMBroadbandBearer *self,
         ctx->modem,
         ctx->primary,
         "$NWQMIDISCONNECT",
-        10, /* timeout */
+        10000, /* timeout */
         FALSE, /* allow_cached */
         FALSE, /* is_raw */
         NULL, /* cancellable */
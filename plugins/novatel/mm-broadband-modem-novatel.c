@@ -36,6 +36,7 @@
 #include "libqcdm/src/commands.h"
 #include "libqcdm/src/result.h"
 #include "mm-log-object.h"
+#include "mm-regex-registry.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 static void iface_modem_messaging_init (MMIfaceModemMessaging *iface);
@@ -173,10 +174,10 @@ nwrat_query_ready (MMBaseModem *self,
     }
 
     /* Parse response */
-    r = g_regex_new ("\\$NWRAT:\\s*(\\d),(\\d),(\\d)", G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_get ("\\$NWRAT:\\s*(\\d),(\\d),(\\d)", G_REGEX_UNGREEDY);
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &error)) {
+    if (!mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &error)) {
         if (error)
             g_task_return_error (task, error);
         else
@@ -1406,10 +1407,10 @@ parse_nwltime_reply (const char *response,
     gboolean success = FALSE;
 
     /* Sample reply: 2013.3.27.15.47.19.2.-5 */
-    r = g_regex_new ("(\\d+)\\.(\\d+)\\.(\\d+)\\.(\\d+)\\.(\\d+)\\.(\\d+)\\.(\\d+)\\.([\\-\\+\\d]+)$", 0, 0, NULL);
+    r = mm_regex_get ("(\\d+)\\.(\\d+)\\.(\\d+)\\.(\\d+)\\.(\\d+)\\.(\\d+)\\.(\\d+)\\.([\\-\\+\\d]+)$", 0);
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
+    if (!mm_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
         if (match_error) {
             g_propagate_error (error, match_error);
             g_prefix_error (error, "Could not parse $NWLTIME results: ");
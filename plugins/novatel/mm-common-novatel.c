@@ -108,7 +108,7 @@ custom_init_step (GTask *task)
         ctx->nwdmat_retries--;
         mm_port_serial_at_command (ctx->port,
                                    "$NWDMAT=1",
-                                   3,
+                                   3000,
                                    FALSE, /* raw */
                                    FALSE, /* allow_cached */
                                    g_task_get_cancellable (task),
@@ -203,7 +203,7 @@ get_ip_config_3gpp (MMBroadbandBearer *self,
         MM_BASE_MODEM (modem),
         primary,
         command,
-        3,
+        3000,
         FALSE,
         FALSE, /* raw */
         NULL, /* cancellable */
@@ -276,7 +276,7 @@ connect_reset (GTask *task)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -470,7 +470,7 @@ authenticate_ready (MMBaseModem  *modem,
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -563,7 +563,7 @@ authenticate (GTask *task)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    command,
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -686,7 +686,7 @@ disconnect_3gpp (MMBroadbandBearer *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (modem),
                                    primary,
                                    command,
-                                   MM_BASE_BEARER_DEFAULT_DISCONNECTION_TIMEOUT,
+                                   MM_BASE_BEARER_DEFAULT_DISCONNECTION_TIMEOUT * 1000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
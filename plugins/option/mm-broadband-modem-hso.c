@@ -34,6 +34,7 @@
 #include "mm-broadband-modem-hso.h"
 #include "mm-broadband-bearer-hso.h"
 #include "mm-bearer-list.h"
+#include "mm-regex-registry.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 static void iface_modem_3gpp_init (MMIfaceModem3gpp *iface);
@@ -483,7 +484,7 @@ disable_location_gathering (MMIfaceModemLocation *self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        mm_base_modem_peek_port_gps_control (MM_BASE_MODEM (self)),
                                        "_OGPS=0",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -587,7 +588,7 @@ parent_enable_location_gathering_ready (MMIfaceModemLocation *_self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        mm_base_modem_peek_port_gps_control (MM_BASE_MODEM (self)),
                                        "_OGPS=2",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -666,7 +667,7 @@ setup_ports (MMBroadbandModem *self)
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        gps_control_port,
                                        "_OGPS=0",
-                                       3, FALSE, FALSE, NULL, NULL, NULL);
+                                       3000, FALSE, FALSE, NULL, NULL, NULL);
 
         /* Add handler for the NMEA traces */
         mm_port_serial_gps_add_trace_handler (gps_data_port,
@@ -712,8 +713,8 @@ mm_broadband_modem_hso_init (MMBroadbandModemHso *self)
                                               MM_TYPE_BROADBAND_MODEM_HSO,
                                               MMBroadbandModemHsoPrivate);
 
-    self->priv->_owancall_regex = g_regex_new ("_OWANCALL: (\\d),\\s*(\\d)\\r\\n",
-                                               G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->_owancall_regex = mm_regex_get ("_OWANCALL: (\\d),\\s*(\\d)\\r\\n",
+                                                G_REGEX_RAW | G_REGEX_OPTIMIZE);
     self->priv->enabled_sources = MM_MODEM_LOCATION_SOURCE_NONE;
 }
 
@@ -31,6 +31,7 @@
 #include "mm-iface-modem-3gpp.h"
 #include "mm-base-modem-at.h"
 #include "mm-broadband-modem-option.h"
+#include "mm-regex-registry.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 static void iface_modem_3gpp_init (MMIfaceModem3gpp *iface);
@@ -367,10 +368,10 @@ parse_ossys_response (const gchar *response,
     gboolean success = FALSE;
 
     p = mm_strip_tag (response, "_OSSYS:");
-    r = g_regex_new ("(\\d),(\\d)", G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_get ("(\\d),(\\d)", G_REGEX_UNGREEDY);
     g_assert (r != NULL);
 
-    g_regex_match (r, p, 0, &match_info);
+    mm_regex_match (r, p, 0, &match_info);
     if (g_match_info_matches (match_info)) {
         str = g_match_info_fetch (match_info, 2);
         if (str && ossys_to_mm (str[0], &current)) {
@@ -450,10 +451,10 @@ parse_octi_response (const gchar *response,
     gboolean success = FALSE;
 
     p = mm_strip_tag (response, "_OCTI:");
-    r = g_regex_new ("(\\d),(\\d)", G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_get ("(\\d),(\\d)", G_REGEX_UNGREEDY);
     g_assert (r != NULL);
 
-    g_regex_match (r, p, 0, &match_info);
+    mm_regex_match (r, p, 0, &match_info);
     if (g_match_info_matches (match_info)) {
         str = g_match_info_fetch (match_info, 2);
         if (str && octi_to_mm (str[0], &current)) {
@@ -1164,16 +1165,16 @@ mm_broadband_modem_option_init (MMBroadbandModemOption *self)
     self->priv->after_power_up_wait_id = 0;
 
     /* Prepare regular expressions to setup */
-    self->priv->_ossysi_regex = g_regex_new ("\\r\\n_OSSYSI:\\s*(\\d+)\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->_octi_regex = g_regex_new ("\\r\\n_OCTI:\\s*(\\d+)\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->_ouwcti_regex = g_regex_new ("\\r\\n_OUWCTI:\\s*(\\d+)\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->_osigq_regex = g_regex_new ("\\r\\n_OSIGQ:\\s*(\\d+),(\\d)\\r\\n",
-                                            G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ignore_regex = g_regex_new ("\\r\\n\\+PACSP0\\r\\n",
-                                            G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->_ossysi_regex = mm_regex_get ("\\r\\n_OSSYSI:\\s*(\\d+)\\r\\n",
+                                              G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->_octi_regex = mm_regex_get ("\\r\\n_OCTI:\\s*(\\d+)\\r\\n",
+                                            G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->_ouwcti_regex = mm_regex_get ("\\r\\n_OUWCTI:\\s*(\\d+)\\r\\n",
+                                              G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->_osigq_regex = mm_regex_get ("\\r\\n_OSIGQ:\\s*(\\d+),(\\d)\\r\\n",
+                                             G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->ignore_regex = mm_regex_get ("\\r\\n\\+PACSP0\\r\\n",
+                                             G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 static void
@@ -29,6 +29,7 @@
 #include "mm-base-modem-at.h"
 #include "mm-shared-quectel.h"
 #include "mm-modem-helpers-quectel.h"
+#include "mm-regex-registry.h"
 
 /*****************************************************************************/
 /* Private context */
@@ -210,7 +211,7 @@ mm_shared_quectel_setup_sim_hot_swap (MMIfaceModem        *self,
     ports[0] = mm_base_modem_peek_port_primary   (MM_BASE_MODEM (self));
     ports[1] = mm_base_modem_peek_port_secondary (MM_BASE_MODEM (self));
 
-    pattern = g_regex_new ("\\+QUSIM:\\s*1\\r\\n", G_REGEX_RAW, 0, NULL);
+    pattern = mm_regex_get ("\\+QUSIM:\\s*1\\r\\n", G_REGEX_RAW);
     g_assert (pattern);
 
     for (i = 0; i < G_N_ELEMENTS (ports); i++) {
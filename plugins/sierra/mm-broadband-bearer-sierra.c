@@ -149,7 +149,7 @@ load_connection_status (MMBaseBearer        *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (modem),
                                    port,
                                    "!SCACT?",
-                                   3,
+                                   3000,
                                    FALSE, /* allow cached */
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -307,7 +307,7 @@ dial_3gpp_context_step (GTask *task)
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        "+CGATT=1",
-                                       10,
+                                       10000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -384,7 +384,7 @@ dial_3gpp_context_step (GTask *task)
             mm_base_modem_at_command_full (ctx->modem,
                                            ctx->primary,
                                            command,
-                                           3,
+                                           3000,
                                            FALSE,
                                            FALSE, /* raw */
                                            NULL, /* cancellable */
@@ -407,7 +407,7 @@ dial_3gpp_context_step (GTask *task)
             mm_base_modem_at_command_full (ctx->modem,
                                            ctx->primary,
                                            command,
-                                           MM_BASE_BEARER_DEFAULT_CONNECTION_TIMEOUT,
+                                           MM_BASE_BEARER_DEFAULT_CONNECTION_TIMEOUT * 1000,
                                            FALSE,
                                            FALSE, /* raw */
                                            NULL, /* cancellable */
@@ -538,7 +538,7 @@ disconnect_3gpp (MMBroadbandBearer *self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (modem),
                                        primary,
                                        command,
-                                       MM_BASE_BEARER_DEFAULT_DISCONNECTION_TIMEOUT,
+                                       MM_BASE_BEARER_DEFAULT_DISCONNECTION_TIMEOUT * 1000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
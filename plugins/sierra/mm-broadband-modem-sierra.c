@@ -35,6 +35,7 @@
 #include "mm-iface-modem-time.h"
 #include "mm-common-sierra.h"
 #include "mm-broadband-bearer-sierra.h"
+#include "mm-regex-registry.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 static void iface_modem_cdma_init (MMIfaceModemCdma *iface);
@@ -656,10 +657,10 @@ selrat_query_ready (MMBaseModem *self,
     result = g_new0 (LoadCurrentModesResult, 1);
 
     /* Example response: !SELRAT: 03, UMTS 3G Preferred */
-    r = g_regex_new ("!SELRAT:\\s*(\\d+).*$", 0, 0, NULL);
+    r = mm_regex_get ("!SELRAT:\\s*(\\d+).*$", 0);
     g_assert (r != NULL);
 
-    if (g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &error)) {
+    if (mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &error)) {
         guint mode;
 
         if (mm_get_uint_from_match_info (match_info, 1, &mode) && mode <= 7) {
@@ -772,7 +773,7 @@ load_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    primary,
                                    "!SELRAT?",
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -890,7 +891,7 @@ set_current_modes (MMIfaceModem *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    primary,
                                    command,
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -1635,10 +1636,10 @@ parse_time (const gchar *response,
     guint year, month, day, hour, minute, second;
     gchar *result = NULL;
 
-    r = g_regex_new (regex, 0, 0, NULL);
+    r = mm_regex_get_dynamic (regex, 0);
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
+    if (!mm_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
         if (match_error) {
             g_propagate_error (error, match_error);
             g_prefix_error (error, "Could not parse %s results: ", tag);
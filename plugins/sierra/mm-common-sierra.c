@@ -23,6 +23,7 @@
 #include "mm-log.h"
 #include "mm-modem-helpers.h"
 #include "mm-sim-sierra.h"
+#include "mm-regex-registry.h"
 
 static MMIfaceModem *iface_modem_parent;
 
@@ -210,7 +211,7 @@ sierra_custom_init_step (GTask *task)
     mm_port_serial_at_command (
         ctx->port,
         "ATI",
-        3,
+        3000,
         FALSE, /* raw */
         FALSE, /* allow_cached */
         cancellable,
@@ -482,7 +483,7 @@ mm_common_sierra_setup_ports (MMBroadbandModem *self)
     guint i;
     GRegex *pacsp_regex;
 
-    pacsp_regex = g_regex_new ("\\r\\n\\+PACSP.*\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    pacsp_regex = mm_regex_get ("\\r\\n\\+PACSP.*\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
 
     ports[0] = mm_base_modem_peek_port_primary (MM_BASE_MODEM (self));
     ports[1] = mm_base_modem_peek_port_secondary (MM_BASE_MODEM (self));
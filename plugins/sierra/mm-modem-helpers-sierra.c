@@ -18,6 +18,7 @@
 
 #include "mm-modem-helpers.h"
 #include "mm-modem-helpers-sierra.h"
+#include "mm-regex-registry.h"
 
 GList *
 mm_sierra_parse_scact_read_response (const gchar  *reply,
@@ -33,11 +34,11 @@ mm_sierra_parse_scact_read_response (const gchar  *reply,
         return NULL;
 
     list = NULL;
-    r = g_regex_new ("!SCACT:\\s*(\\d+),(\\d+)",
-                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW, 0, &inner_error);
+    r = mm_regex_get ("!SCACT:\\s*(\\d+),(\\d+)",
+                      G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW);
     g_assert (r);
 
-    g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, &inner_error);
     while (!inner_error && g_match_info_matches (match_info)) {
         MM3gppPdpContextActive *pdp_active;
         guint cid = 0;
@@ -36,6 +36,7 @@
 #include "mm-iface-modem-voice.h"
 #include "mm-shared-simtech.h"
 #include "mm-broadband-modem-simtech.h"
+#include "mm-regex-registry.h"
 
 static void iface_modem_init          (MMIfaceModem         *iface);
 static void iface_modem_3gpp_init     (MMIfaceModem3gpp     *iface);
@@ -1230,10 +1231,10 @@ mm_broadband_modem_simtech_init (MMBroadbandModemSimtech *self)
     self->priv->cnsmod_support = FEATURE_SUPPORT_UNKNOWN;
     self->priv->autocsq_support = FEATURE_SUPPORT_UNKNOWN;
 
-    self->priv->cnsmod_regex = g_regex_new ("\\r\\n\\+CNSMOD:\\s*(\\d+)\\r\\n",
-                                            G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->csq_regex    = g_regex_new ("\\r\\n\\+CSQ:\\s*(\\d+),(\\d+)\\r\\n",
-                                            G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->cnsmod_regex = mm_regex_get ("\\r\\n\\+CNSMOD:\\s*(\\d+)\\r\\n",
+                                             G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->csq_regex    = mm_regex_get ("\\r\\n\\+CSQ:\\s*(\\d+),(\\d+)\\r\\n",
+                                             G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 static void
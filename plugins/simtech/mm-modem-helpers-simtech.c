@@ -24,6 +24,7 @@
 #include "mm-errors-types.h"
 #include "mm-modem-helpers-simtech.h"
 #include "mm-modem-helpers.h"
+#include "mm-regex-registry.h"
 
 
 /*****************************************************************************/
@@ -72,8 +73,8 @@ mm_simtech_parse_clcc_test (const gchar  *response,
 GRegex *
 mm_simtech_get_clcc_urc_regex (void)
 {
-    return g_regex_new ("\\r\\n(\\+CLCC: .*\\r\\n)+",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    return mm_regex_get ("\\r\\n(\\+CLCC: .*\\r\\n)+",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 gboolean
@@ -103,8 +104,8 @@ mm_simtech_call_info_list_free (GList *call_info_list)
 GRegex *
 mm_simtech_get_voice_call_urc_regex (void)
 {
-    return g_regex_new ("\\r\\nVOICE CALL:\\s*([A-Z]+)(?::\\s*(\\d+))?\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    return mm_regex_get ("\\r\\nVOICE CALL:\\s*([A-Z]+)(?::\\s*(\\d+))?\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 gboolean
@@ -157,8 +158,8 @@ out:
 GRegex *
 mm_simtech_get_missed_call_urc_regex (void)
 {
-    return g_regex_new ("\\r\\nMISSED_CALL:\\s*(.+)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    return mm_regex_get ("\\r\\nMISSED_CALL:\\s*(.+)\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 gboolean
@@ -188,8 +189,8 @@ mm_simtech_parse_missed_call_urc (GMatchInfo  *match_info,
 GRegex *
 mm_simtech_get_cring_urc_regex (void)
 {
-    return g_regex_new ("(?:\\r)+\\n\\+CRING:\\s*(\\S+)(?:\\r)+\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    return mm_regex_get ("(?:\\r)+\\n\\+CRING:\\s*(\\S+)(?:\\r)+\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 /*****************************************************************************/
@@ -204,6 +205,6 @@ mm_simtech_get_cring_urc_regex (void)
 GRegex *
 mm_simtech_get_rxdtmf_urc_regex (void)
 {
-    return g_regex_new ("(?:\\r)+\\n\\+RXDTMF:\\s*([0-9A-D\\*\\#])(?:\\r)+\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    return mm_regex_get ("(?:\\r)+\\n\\+RXDTMF:\\s*([0-9A-D\\*\\#])(?:\\r)+\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
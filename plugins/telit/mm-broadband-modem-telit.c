@@ -35,6 +35,7 @@
 #include "mm-modem-helpers-telit.h"
 #include "mm-telit-enums-types.h"
 #include "mm-shared-telit.h"
+#include "mm-regex-registry.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 static void iface_modem_3gpp_init (MMIfaceModem3gpp *iface);
@@ -555,7 +556,7 @@ telit_qss_enable_ready (MMBaseModem *self,
         goto next_step;
     }
 
-    pattern = g_regex_new ("#QSS:\\s*([0-3])\\r\\n", G_REGEX_RAW, 0, NULL);
+    pattern = mm_regex_get ("#QSS:\\s*([0-3])\\r\\n", G_REGEX_RAW);
     g_assert (pattern);
     mm_port_serial_at_add_unsolicited_msg_handler (
         port,
@@ -631,7 +632,7 @@ qss_setup_step (GTask *task)
             mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                            ctx->primary,
                                            "#QSS=1",
-                                           3,
+                                           3000,
                                            FALSE,
                                            FALSE, /* raw */
                                            NULL, /* cancellable */
@@ -643,7 +644,7 @@ qss_setup_step (GTask *task)
                 mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                                ctx->secondary,
                                                "#QSS=1",
-                                               3,
+                                               3000,
                                                FALSE,
                                                FALSE, /* raw */
                                                NULL, /* cancellable */
@@ -1319,7 +1320,7 @@ parent_enable_unsolicited_events_ready (MMIfaceModem3gpp *self,
         mm_base_modem_peek_port_secondary (MM_BASE_MODEM (self)),
         /* Enable +CIEV only for: signal, service, roam */
         "AT+CIND=0,1,1,0,0,0,1,0,0",
-        5,
+        5000,
         FALSE,
         FALSE,
         NULL, /* cancellable */
@@ -18,6 +18,7 @@
 #include "mm-common-telit.h"
 #include "mm-log-object.h"
 #include "mm-serial-parsers.h"
+#include "mm-regex-registry.h"
 
 /*****************************************************************************/
 
@@ -120,10 +121,10 @@ cache_port_mode (MMPortProbe *probe,
     guint portcfg_current;
 
     /* #PORTCFG: <requested>,<active> */
-    r = g_regex_new ("#PORTCFG:\\s*(\\d+),(\\d+)", flags, 0, NULL);
+    r = mm_regex_get ("#PORTCFG:\\s*(\\d+),(\\d+)", flags);
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, &error))
+    if (!mm_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, &error))
         goto out;
 
     if (!mm_get_uint_from_match_info (match_info, 2, &portcfg_current)) {
@@ -267,7 +268,7 @@ telit_custom_init_step (GTask *task)
         mm_port_serial_at_command (
             ctx->port,
             "AT#PORTCFG?",
-            2,
+            2000,
             FALSE, /* raw */
             FALSE, /* allow_cached */
             g_task_get_cancellable (task),
@@ -301,7 +302,7 @@ wait_for_ready (GTask *task)
     mm_port_serial_at_command (
         ctx->port,
         "AT",
-        5,
+        5000,
         FALSE, /* raw */
         FALSE, /* allow_cached */
         g_task_get_cancellable (task),
@@ -26,6 +26,7 @@
 #include "mm-log-object.h"
 #include "mm-modem-helpers.h"
 #include "mm-modem-helpers-telit.h"
+#include "mm-regex-registry.h"
 
 /*****************************************************************************/
 /* AT#BND 2G values */
@@ -557,10 +558,10 @@ common_parse_bnd_response (const gchar    *response,
         [LOAD_BANDS_TYPE_CURRENT]   = "#BND:\\s*(?P<Bands2G>\\d+)(,\\s*(?P<Bands3G>\\d+))?(,\\s*(?P<Bands4G>\\d+))?",
     };
 
-    r = g_regex_new (load_bands_regex[load_type], G_REGEX_RAW, 0, NULL);
+    r = mm_regex_get_dynamic (load_bands_regex[load_type], G_REGEX_RAW);
     g_assert (r);
 
-    if (!g_regex_match (r, response, 0, &match_info)) {
+    if (!mm_regex_match (r, response, 0, &match_info)) {
         g_set_error (&inner_error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
                      "Could not parse response '%s'", response);
         goto out;
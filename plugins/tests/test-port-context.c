@@ -33,8 +33,25 @@ struct _TestPortContext {
     GSocketService *socket_service;
     GList *clients;
     GHashTable *commands;
+    GMutex reads_mutex;
+    GPtrArray *reads;
+    GQueue *script;
 };
 
+typedef struct {
+    GByteArray *command;
+    GPtrArray *responses;
+} ScriptStep;
+
+static void
+script_step_free (ScriptStep *step)
+{
+    if (step->command)
+        g_byte_array_unref (step->command);
+    g_ptr_array_unref (step->responses);
+    g_slice_free (ScriptStep, step);
+}
+
 /*****************************************************************************/
 
 void
@@ -92,6 +109,84 @@ test_port_context_load_commands (TestPortContext *self,
     g_free (contents);
 }
 
+void
+test_port_context_add_script_step (TestPortContext *self,
+                                   const guint8 *command,
+                                   gsize command_len)
+{
+    ScriptStep *step;
+
+    g_assert (self->thread == NULL);
+    g_assert (command_len > 0);
+
+    if (!self->script)
+        self->script = g_queue_new ();
+
+    step = g_slice_new0 (ScriptStep);
+    step->command = g_byte_array_sized_new (command_len);
+    g_byte_array_append (step->command, command, command_len);
+    step->responses = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+    g_queue_push_tail (self->script, step);
+}
+
+void
+test_port_context_add_script_response (TestPortContext *self,
+                                       const guint8 *data,
+                                       gsize len)
+{
+    ScriptStep *step;
+
+    g_assert (self->thread == NULL);
+
+    if (!self->script)
+        self->script = g_queue_new ();
+
+    /* Responses before the first command are sent on connection */
+    step = g_queue_peek_tail (self->script);
+    if (!step) {
+        step = g_slice_new0 (ScriptStep);
+        step->responses = g_ptr_array_new_with_free_func ((GDestroyNotify) g_bytes_unref);
+        g_queue_push_tail (self->script, step);
+    }
+    g_ptr_array_add (step->responses, g_bytes_new (data, len));
+}
+
+void
+test_port_context_set_record_reads (TestPortContext *self,
+                                    gboolean record)
+{
+    g_mutex_lock (&self->reads_mutex);
+    if (record && !self->reads)
+        self->reads = g_ptr_array_new_with_free_func (g_free);
+    else if (!record && self->reads)
+        g_clear_pointer (&self->reads, g_ptr_array_unref);
+    g_mutex_unlock (&self->reads_mutex);
+}
+
+GPtrArray *
+test_port_context_take_reads (TestPortContext *self)
+{
+    GPtrArray *reads;
+
+    g_mutex_lock (&self->reads_mutex);
+    g_assert (self->reads != NULL);
+    reads = self->reads;
+    self->reads = g_ptr_array_new_with_free_func (g_free);
+    g_mutex_unlock (&self->reads_mutex);
+    return reads;
+}
+
+static void
+record_read (TestPortContext *self,
+             const guint8 *data,
+             gsize len)
+{
+    g_mutex_lock (&self->reads_mutex);
+    if (self->reads)
+        g_ptr_array_add (self->reads, g_strndup ((const gchar *)data, len));
+    g_mutex_unlock (&self->reads_mutex);
+}
+
 static const gchar *
 process_next_command (TestPortContext *ctx,
                       GByteArray *buffer)
@@ -150,27 +245,80 @@ connection_close (Client *client)
     client_free (client);
 }
 
+static void
+client_write (Client *client,
+              const guint8 *data,
+              gsize len)
+{
+    GError *error = NULL;
+
+    if (!g_output_stream_write_all (g_io_stream_get_output_stream (G_IO_STREAM (client->connection)),
+                                    data,
+                                    len,
+                                    NULL, /* bytes_written */
+                                    NULL, /* cancellable */
+                                    &error)) {
+        g_warning ("Cannot send response to client: %s", error->message);
+        g_error_free (error);
+    }
+}
+
+static void
+client_send_script_responses (Client *client,
+                              ScriptStep *step)
+{
+    guint i;
+
+    /* Each response is written on its own, so that the client may get them
+     * in separate reads, as they were originally received */
+    for (i = 0; i < step->responses->len; i++) {
+        GBytes *response;
+
+        response = g_ptr_array_index (step->responses, i);
+        client_write (client,
+                      g_bytes_get_data (response, NULL),
+                      g_bytes_get_size (response));
+    }
+}
+
+static void
+client_run_script (Client *client)
+{
+    ScriptStep *step;
+
+    while ((step = g_queue_peek_head (client->ctx->script)) != NULL) {
+        if (!step->command || client->buffer->len < step->command->len)
+            return;
+
+        if (memcmp (client->buffer->data, step->command->data, step->command->len) != 0)
+            g_warning ("Unexpected command received, answering as scripted anyway");
+        g_byte_array_remove_range (client->buffer, 0, step->command->len);
+
+        g_queue_pop_head (client->ctx->script);
+        client_send_script_responses (client, step);
+        script_step_free (step);
+    }
+
+    if (client->buffer->len > 0) {
+        g_warning ("Unexpected data received after the end of the script");
+        g_byte_array_set_size (client->buffer, 0);
+    }
+}
+
 static void
 client_parse_request (Client *client)
 {
     const gchar *response;
 
+    if (client->ctx->script) {
+        client_run_script (client);
+        return;
+    }
+
     do {
         response = process_next_command (client->ctx, client->buffer);
-        if (response) {
-            GError *error = NULL;
-
-            if (!g_output_stream_write_all (g_io_stream_get_output_stream (G_IO_STREAM (client->connection)),
-                                            response,
-                                            strlen (response),
-                                            NULL, /* bytes_written */
-                                            NULL, /* cancellable */
-                                            &error)) {
-                g_warning ("Cannot send response to client: %s", error->message);
-                g_error_free (error);
-            }
-        }
-
+        if (response)
+            client_write (client, (const guint8 *)response, strlen (response));
     } while (response);
 }
 
@@ -211,6 +359,7 @@ connection_readable_cb (GSocket *socket,
         return TRUE;
 
     /* else, r > 0 */
+    record_read (client->ctx, buffer, r);
     if (!G_UNLIKELY (client->buffer))
         client->buffer = g_byte_array_sized_new (r);
     g_byte_array_append (client->buffer, buffer, r);
@@ -254,6 +403,18 @@ incoming_cb (GSocketService *service,
 
     client = client_new (self, connection);
     self->clients = g_list_append (self->clients, client);
+
+    /* Scripted responses not waiting for any command are sent right away */
+    if (self->script) {
+        ScriptStep *step;
+
+        step = g_queue_peek_head (self->script);
+        if (step && !step->command) {
+            g_queue_pop_head (self->script);
+            client_send_script_responses (client, step);
+            script_step_free (step);
+        }
+    }
 }
 
 static void
@@ -387,9 +548,14 @@ test_port_context_free (TestPortContext *self)
 
     g_cond_clear (&self->ready_cond);
     g_mutex_clear (&self->ready_mutex);
+    g_mutex_clear (&self->reads_mutex);
+    if (self->reads)
+        g_ptr_array_unref (self->reads);
 
     if (self->commands)
         g_hash_table_unref (self->commands);
+    if (self->script)
+        g_queue_free_full (self->script, (GDestroyNotify)script_step_free);
     g_list_free_full (self->clients, (GDestroyNotify)client_free);
     if (self->socket) {
         GError *error = NULL;
@@ -418,5 +584,6 @@ test_port_context_new (const gchar *name)
     self->name = g_strdup (name);
     g_cond_init (&self->ready_cond);
     g_mutex_init (&self->ready_mutex);
+    g_mutex_init (&self->reads_mutex);
     return self;
 }
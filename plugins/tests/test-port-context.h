@@ -32,4 +32,22 @@ void             test_port_context_set_command   (TestPortContext *self,
 void             test_port_context_load_commands (TestPortContext *self,
                                                   const gchar *commands_file);
 
+/* Scripted mode, used instead of the commands table once any step is added.
+ * Each step waits until as many bytes as the given command have been read,
+ * and then writes each of the responses added after it, in order, and one
+ * write each. Responses added before the first step are written as soon as
+ * a client connects. Only one client is expected in this mode. */
+void             test_port_context_add_script_step     (TestPortContext *self,
+                                                        const guint8 *command,
+                                                        gsize command_len);
+void             test_port_context_add_script_response (TestPortContext *self,
+                                                        const guint8 *data,
+                                                        gsize len);
+
+/* When enabled, every chunk of data read from the clients is recorded as is,
+ * so that tests can check how commands were written */
+void             test_port_context_set_record_reads (TestPortContext *self,
+                                                     gboolean record);
+GPtrArray       *test_port_context_take_reads       (TestPortContext *self);
+
 #endif /* TEST_PORT_CONTEXT_H */
@@ -0,0 +1,580 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+/* Tests of MMPortSerialAt driven against the fake AT responder in
+ * test-port-context. */
+
+#include <config.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <ModemManager.h>
+
+#include "mm-port-serial-at.h"
+#include "mm-error-helpers.h"
+#include "mm-log-test.h"
+#include "test-port-context.h"
+
+/*****************************************************************************/
+
+typedef struct {
+    TestPortContext *port_context;
+    gchar           *port_name;
+    MMPortSerialAt  *port;
+} Fixture;
+
+static void
+fixture_setup (Fixture *fixture,
+               gboolean pipeline)
+{
+    /* Add process ID so that multiple runs in the same system don't clash */
+    fixture->port_name = g_strdup_printf ("abstract:port-serial-at-%ld", (glong) getpid ());
+    fixture->port_context = test_port_context_new (fixture->port_name);
+
+    fixture->port = mm_port_serial_at_new (fixture->port_name, MM_PORT_SUBSYS_UNIX);
+    g_object_set (fixture->port,
+                  MM_PORT_SERIAL_SEND_DELAY,               (guint64) 0,
+                  MM_PORT_SERIAL_SEND_DELAY_ADAPTIVE,      FALSE,
+                  MM_PORT_SERIAL_PIPELINE,                 pipeline,
+                  MM_PORT_SERIAL_AT_REMOVE_ECHO,           FALSE,
+                  MM_PORT_SERIAL_AT_INIT_SEQUENCE_ENABLED, FALSE,
+                  NULL);
+}
+
+static void
+fixture_start (Fixture *fixture)
+{
+    GError *error = NULL;
+
+    test_port_context_start (fixture->port_context);
+    g_assert (mm_port_serial_open (MM_PORT_SERIAL (fixture->port), &error));
+    g_assert_no_error (error);
+}
+
+static void
+fixture_teardown (Fixture *fixture)
+{
+    mm_port_serial_close (MM_PORT_SERIAL (fixture->port));
+    g_object_unref (fixture->port);
+    test_port_context_stop (fixture->port_context);
+    test_port_context_free (fixture->port_context);
+    g_free (fixture->port_name);
+}
+
+static void
+set_response (Fixture     *fixture,
+              const gchar *command,
+              const gchar *response)
+{
+    g_autofree gchar *escaped = NULL;
+
+    /* The responder takes the responses escaped */
+    escaped = g_strescape (response, NULL);
+    test_port_context_set_command (fixture->port_context, command, escaped);
+}
+
+static void
+command_ready (MMPortSerialAt  *port,
+               GAsyncResult    *res,
+               gchar          **out_response)
+{
+    g_autoptr(GError) error = NULL;
+    const gchar      *response;
+
+    response = mm_port_serial_at_command_finish (port, res, &error);
+    g_assert_no_error (error);
+    *out_response = g_strdup (response);
+}
+
+static gchar *
+run_command (Fixture     *fixture,
+             const gchar *command)
+{
+    gchar *response = NULL;
+
+    mm_port_serial_at_command (fixture->port, command, 5000, FALSE, FALSE, NULL,
+                               (GAsyncReadyCallback) command_ready, &response);
+    while (!response)
+        g_main_context_iteration (NULL, TRUE);
+    return response;
+}
+
+/*****************************************************************************/
+/* Unsolicited message handlers */
+
+typedef struct {
+    const gchar        *pattern;
+    GRegexCompileFlags  flags;
+    gboolean            enabled;
+} UrcHandlerTest;
+
+static const UrcHandlerTest urc_handlers[] = {
+    /* Tagged */
+    { "\\r\\n\\+CREG:\\s*(\\d)\\r\\n",                     G_REGEX_RAW, TRUE },
+    /* Tagged, same tag as another one */
+    { "\\r\\n\\+CREG:\\s*(\\d),\"(\\w+)\",\"(\\w+)\"\\r\\n", G_REGEX_RAW, TRUE },
+    /* Whole line tag */
+    { "\\r\\n\\+PBREADY\\r\\n",                            G_REGEX_RAW, TRUE },
+    /* Tag ending in a space */
+    { "\\r\\n\\^CONNECT (\\d)\\r\\n",                      G_REGEX_RAW, TRUE },
+    /* Prefix without tag */
+    { "\\r\\n\\^SYSSTART.*\\r\\n",                         G_REGEX_RAW, TRUE },
+    /* Prefix without tag, due to a quantifier in the tag */
+    { "\\r\\n\\+CGREG?: (\\d)\\r\\n",                      G_REGEX_RAW, TRUE },
+    /* Top-level alternation, must always be run */
+    { "\\r\\n\\+CIEV: (\\d)|\\r\\n\\+CMTI: \"(\\w+)\",(\\d)\\r\\n", G_REGEX_RAW, TRUE },
+    /* Not right after <CR><LF> */
+    { "\\^SCKS:\\s*([0-3])\\r\\n",                         G_REGEX_RAW, TRUE },
+    /* Caseless */
+    { "\\r\\n\\+cring: (\\w+)\\r\\n",                      G_REGEX_RAW | G_REGEX_CASELESS, TRUE },
+    /* Disabled */
+    { "\\r\\n\\+CUSATEND\\r\\n",                           G_REGEX_RAW, FALSE },
+};
+
+static const gchar *urc_responses[] = {
+    "\r\n+CREG: 1\r\n\r\nOK\r\n",
+    "\r\n+CREG: 1,\"1A2B\",\"0C3D\"\r\n\r\n+CREG: 5\r\n\r\nOK\r\n",
+    "\r\n+CREG:2\r\n\r\n+CSQ: 20,99\r\n\r\nOK\r\n",
+    "\r\n+PBREADY\r\n\r\n+PBREADYX\r\n\r\nOK\r\n",
+    "\r\n^CONNECT 1\r\n\r\n^CONNECTED 2\r\n\r\nOK\r\n",
+    "\r\n^SYSSTART\r\n\r\n^SYSSTART AIRPLANE MODE\r\n\r\nOK\r\n",
+    "\r\n+CGRE: 1\r\n\r\n+CGREG: 2\r\n\r\n+CGREGG: 3\r\n\r\nOK\r\n",
+    "\r\n+CIEV: 7\r\n\r\n+CMTI: \"ME\",3\r\n\r\nOK\r\n",
+    "\r\n+CSQ: 20,99\r\n^SCKS: 1\r\n\r\nOK\r\n",
+    "\r\n+CRING: VOICE\r\n\r\n+Cring: DATA\r\n\r\nOK\r\n",
+    "\r\n+CUSATEND\r\n\r\nOK\r\n",
+    "\r\nOK\r\n\r\n+CREG: 3\r\n\r\n+PBREADY\r\n",
+    "\r\n+COPS: 0,0,\"+CREG: 1\",2\r\n\r\nOK\r\n",
+    "\r\n+CREG: 0\r\n+CREG: 1\r\n+CREG: 2\r\n\r\nOK\r\n",
+};
+
+typedef struct {
+    guint      index;
+    GPtrArray *records;
+} UrcHandlerContext;
+
+static void
+record_urc (GPtrArray   *records,
+            guint        index,
+            GMatchInfo  *match_info)
+{
+    g_autofree gchar *match = NULL;
+
+    match = g_match_info_fetch (match_info, 0);
+    g_ptr_array_add (records, g_strdup_printf ("%u: %s", index, match));
+}
+
+static void
+urc_received (MMPortSerialAt    *port,
+              GMatchInfo        *match_info,
+              UrcHandlerContext *ctx)
+{
+    record_urc (ctx->records, ctx->index, match_info);
+}
+
+/* Every enabled handler run over the whole response, in priority order, as
+ * done before handlers were indexed */
+static void
+reference_parse_unsolicited (GRegex    **regexes,
+                             GString    *response,
+                             GPtrArray  *records)
+{
+    guint i;
+
+    /* The last handler added has the highest priority */
+    for (i = G_N_ELEMENTS (urc_handlers); i > 0; i--) {
+        GMatchInfo *match_info = NULL;
+        GArray     *matches;
+        gint        j;
+
+        if (!urc_handlers[i - 1].enabled)
+            continue;
+
+        matches = g_array_new (FALSE, FALSE, sizeof (gint));
+        g_regex_match_full (regexes[i - 1], response->str, response->len, 0, 0, &match_info, NULL);
+        while (g_match_info_matches (match_info)) {
+            gint start;
+            gint end;
+
+            record_urc (records, i - 1, match_info);
+            g_assert (g_match_info_fetch_pos (match_info, 0, &start, &end));
+            g_array_append_val (matches, start);
+            g_array_append_val (matches, end);
+            g_match_info_next (match_info, NULL);
+        }
+        g_match_info_free (match_info);
+
+        for (j = (gint) matches->len - 2; j >= 0; j -= 2) {
+            gint start;
+            gint end;
+
+            start = g_array_index (matches, gint, j);
+            end = g_array_index (matches, gint, j + 1);
+            g_string_erase (response, start, end - start);
+        }
+        g_array_unref (matches);
+    }
+}
+
+static void
+test_urc_index (void)
+{
+    Fixture            fixture = { 0 };
+    GRegex            *regexes[G_N_ELEMENTS (urc_handlers)];
+    UrcHandlerContext  contexts[G_N_ELEMENTS (urc_handlers)];
+    GPtrArray         *records;
+    GPtrArray         *reference_records;
+    guint              i;
+    guint              j;
+
+    fixture_setup (&fixture, FALSE);
+    records = g_ptr_array_new_with_free_func (g_free);
+    reference_records = g_ptr_array_new_with_free_func (g_free);
+
+    for (i = 0; i < G_N_ELEMENTS (urc_handlers); i++) {
+        GError *error = NULL;
+
+        regexes[i] = g_regex_new (urc_handlers[i].pattern, urc_handlers[i].flags, 0, &error);
+        g_assert_no_error (error);
+        contexts[i].index = i;
+        contexts[i].records = records;
+        mm_port_serial_at_add_unsolicited_msg_handler (fixture.port,
+                                                       regexes[i],
+                                                       (MMPortSerialAtUnsolicitedMsgFn) urc_received,
+                                                       &contexts[i],
+                                                       NULL);
+        if (!urc_handlers[i].enabled)
+            mm_port_serial_at_enable_unsolicited_msg_handler (fixture.port, regexes[i], FALSE);
+    }
+
+    for (i = 0; i < G_N_ELEMENTS (urc_responses); i++) {
+        g_autofree gchar *command = NULL;
+
+        command = g_strdup_printf ("AT+TEST%u", i);
+        set_response (&fixture, command, urc_responses[i]);
+    }
+
+    fixture_start (&fixture);
+
+    for (i = 0; i < G_N_ELEMENTS (urc_responses); i++) {
+        g_autofree gchar *command = NULL;
+        g_autofree gchar *response = NULL;
+        GString          *reference;
+
+        command = g_strdup_printf ("AT+TEST%u", i);
+        response = run_command (&fixture, command);
+
+        reference = g_string_new (urc_responses[i]);
+        reference_parse_unsolicited (regexes, reference, reference_records);
+        g_string_free (reference, TRUE);
+
+        g_assert_cmpuint (records->len, ==, reference_records->len);
+        for (j = 0; j < records->len; j++)
+            g_assert_cmpstr (g_ptr_array_index (records, j), ==, g_ptr_array_index (reference_records, j));
+
+        g_ptr_array_set_size (records, 0);
+        g_ptr_array_set_size (reference_records, 0);
+    }
+
+    fixture_teardown (&fixture);
+    for (i = 0; i < G_N_ELEMENTS (urc_handlers); i++)
+        g_regex_unref (regexes[i]);
+    g_ptr_array_unref (records);
+    g_ptr_array_unref (reference_records);
+}
+
+/*****************************************************************************/
+/* Pipelining */
+
+typedef struct {
+    gboolean  done;
+    gchar    *response;
+    GError   *error;
+} PipelinedCommand;
+
+static void
+pipelined_command_ready (MMPortSerialAt   *port,
+                         GAsyncResult     *res,
+                         PipelinedCommand *cmd)
+{
+    cmd->response = g_strdup (mm_port_serial_at_command_finish (port, res, &cmd->error));
+    cmd->done = TRUE;
+}
+
+/* Queues all the given commands at once, so that they can be sent in
+ * pipelined mode, and waits for all of them to finish */
+static void
+run_commands (Fixture          *fixture,
+              const gchar     **commands,
+              PipelinedCommand *cmds,
+              guint             n_commands)
+{
+    guint i;
+
+    for (i = 0; i < n_commands; i++)
+        mm_port_serial_at_command (fixture->port, commands[i], 5000, FALSE, FALSE, NULL,
+                                   (GAsyncReadyCallback) pipelined_command_ready, &cmds[i]);
+
+    for (i = 0; i < n_commands; i++) {
+        while (!cmds[i].done)
+            g_main_context_iteration (NULL, TRUE);
+    }
+}
+
+static guint
+count_commands (const gchar *read)
+{
+    guint n = 0;
+
+    for (; *read; read++) {
+        if (*read == '\r')
+            n++;
+    }
+    return n;
+}
+
+#define N_PIPELINED_COMMANDS 20
+
+static void
+test_pipeline_replies (gconstpointer user_data)
+{
+    gboolean          pipeline = GPOINTER_TO_UINT (user_data);
+    Fixture           fixture = { 0 };
+    const gchar      *commands[N_PIPELINED_COMMANDS];
+    gchar            *command_strs[N_PIPELINED_COMMANDS];
+    PipelinedCommand  cmds[N_PIPELINED_COMMANDS] = { { 0 } };
+    GPtrArray        *reads;
+    guint             max_batch = 0;
+    guint             i;
+
+    fixture_setup (&fixture, pipeline);
+
+    for (i = 0; i < N_PIPELINED_COMMANDS; i++) {
+        g_autofree gchar *response = NULL;
+
+        command_strs[i] = g_strdup_printf ("AT+TEST%u", i);
+        commands[i] = command_strs[i];
+        /* Every fifth command fails, which must not affect the replies of
+         * the ones sent along with it */
+        if (i % 5 == 4)
+            continue;
+        response = g_strdup_printf ("\r\n+TEST: %u\r\n\r\nOK\r\n", i);
+        set_response (&fixture, command_strs[i], response);
+    }
+
+    test_port_context_set_record_reads (fixture.port_context, TRUE);
+    fixture_start (&fixture);
+
+    run_commands (&fixture, commands, cmds, N_PIPELINED_COMMANDS);
+
+    for (i = 0; i < N_PIPELINED_COMMANDS; i++) {
+        if (i % 5 == 4) {
+            g_assert_error (cmds[i].error, MM_MOBILE_EQUIPMENT_ERROR, MM_MOBILE_EQUIPMENT_ERROR_UNKNOWN);
+            g_assert (!cmds[i].response);
+        } else {
+            g_autofree gchar *expected = NULL;
+
+            expected = g_strdup_printf ("+TEST: %u", i);
+            g_assert_no_error (cmds[i].error);
+            g_assert_cmpstr (cmds[i].response, ==, expected);
+        }
+        g_clear_error (&cmds[i].error);
+        g_free (cmds[i].response);
+        g_free (command_strs[i]);
+    }
+
+    reads = test_port_context_take_reads (fixture.port_context);
+    for (i = 0; i < reads->len; i++)
+        max_batch = MAX (max_batch, count_commands (g_ptr_array_index (reads, i)));
+    g_ptr_array_unref (reads);
+
+    /* Several commands written at once only in pipelined mode, and never
+     * more than the maximum allowed in a single batch */
+    if (pipeline) {
+        g_assert_cmpuint (max_batch, >, 1);
+        g_assert_cmpuint (max_batch, <=, 8);
+    } else
+        g_assert_cmpuint (max_batch, ==, 1);
+
+    fixture_teardown (&fixture);
+}
+
+/* Commands that switch the port out of command mode or change the modem state
+ * in ways that affect the commands after them */
+static const gchar *no_pipelining_commands[] = {
+    "AT+CMGS=23",
+    "AT+CMGW=23",
+    "AT+CMGC=1",
+    "AT+CGDATA=\"PPP\",1",
+    "AT+CFUN=4",
+    "AT+CPWROFF",
+    "AT+CFUN=1;+CGATT=1",
+    "ATD*99#",
+    "ATA",
+    "ATO",
+    "ATZ",
+    "AT&F",
+};
+
+static void
+test_pipeline_no_batching (void)
+{
+    Fixture fixture = { 0 };
+    guint   i;
+
+    fixture_setup (&fixture, TRUE);
+    set_response (&fixture, "AT+TEST0", "\r\n+TEST: 0\r\n\r\nOK\r\n");
+    set_response (&fixture, "AT+TEST1", "\r\n+TEST: 1\r\n\r\nOK\r\n");
+    set_response (&fixture, "AT+TEST2", "\r\n+TEST: 2\r\n\r\nOK\r\n");
+    set_response (&fixture, "AT+TEST3", "\r\n+TEST: 3\r\n\r\nOK\r\n");
+    for (i = 0; i < G_N_ELEMENTS (no_pipelining_commands); i++)
+        set_response (&fixture, no_pipelining_commands[i], "\r\nSINGLE\r\n\r\nOK\r\n");
+
+    test_port_context_set_record_reads (fixture.port_context, TRUE);
+    fixture_start (&fixture);
+
+    for (i = 0; i < G_N_ELEMENTS (no_pipelining_commands); i++) {
+        g_autofree gchar *expected_read = NULL;
+        const gchar      *commands[5];
+        PipelinedCommand  cmds[5] = { { 0 } };
+        GPtrArray        *reads;
+        guint             j;
+        guint             n_found = 0;
+
+        commands[0] = "AT+TEST0";
+        commands[1] = "AT+TEST1";
+        commands[2] = no_pipelining_commands[i];
+        commands[3] = "AT+TEST2";
+        commands[4] = "AT+TEST3";
+        run_commands (&fixture, commands, cmds, G_N_ELEMENTS (cmds));
+
+        for (j = 0; j < G_N_ELEMENTS (cmds); j++) {
+            g_autofree gchar *expected = NULL;
+
+            expected = (j == 2 ? g_strdup ("SINGLE") : g_strdup_printf ("+TEST: %u", j < 2 ? j : j - 1));
+            g_assert_no_error (cmds[j].error);
+            g_assert_cmpstr (cmds[j].response, ==, expected);
+            g_free (cmds[j].response);
+        }
+
+        /* The command must have been written on its own, neither along with
+         * the ones before it nor with the ones after it */
+        expected_read = g_strdup_printf ("%s\r\n", no_pipelining_commands[i]);
+        reads = test_port_context_take_reads (fixture.port_context);
+        for (j = 0; j < reads->len; j++) {
+            const gchar *read = g_ptr_array_index (reads, j);
+
+            if (strstr (read, no_pipelining_commands[i])) {
+                g_assert_cmpstr (read, ==, expected_read);
+                n_found++;
+            }
+        }
+        g_assert_cmpuint (n_found, ==, 1);
+        /* And the others still pipelined */
+        g_assert_cmpstr (g_ptr_array_index (reads, 0), ==, "AT+TEST0\r\nAT+TEST1\r\n");
+        g_ptr_array_unref (reads);
+    }
+
+    fixture_teardown (&fixture);
+}
+
+/*****************************************************************************/
+/* Scripted responses, as used when replaying captures */
+
+static void
+add_script_step (Fixture     *fixture,
+                 const gchar *command)
+{
+    test_port_context_add_script_step (fixture->port_context, (const guint8 *) command, strlen (command));
+}
+
+static void
+add_script_response (Fixture     *fixture,
+                     const gchar *response)
+{
+    test_port_context_add_script_response (fixture->port_context, (const guint8 *) response, strlen (response));
+}
+
+static void
+test_scripted_replies (void)
+{
+    Fixture           fixture = { 0 };
+    GRegex           *regex;
+    UrcHandlerContext urc_context;
+    PipelinedCommand  cmds[2] = { { 0 } };
+
+    fixture_setup (&fixture, FALSE);
+
+    urc_context.index = 0;
+    urc_context.records = g_ptr_array_new_with_free_func (g_free);
+    regex = g_regex_new ("\\r\\n\\+CREG:\\s*(\\d)\\r\\n", G_REGEX_RAW, 0, NULL);
+    mm_port_serial_at_add_unsolicited_msg_handler (fixture.port,
+                                                   regex,
+                                                   (MMPortSerialAtUnsolicitedMsgFn) urc_received,
+                                                   &urc_context,
+                                                   NULL);
+
+    /* Sent on connection, before any command */
+    add_script_response (&fixture, "\r\n+CREG: 2\r\n");
+    /* Response split across writes, with a URC in the middle */
+    add_script_step (&fixture, "AT+CSQ\r");
+    add_script_response (&fixture, "\r\n+CSQ: 2");
+    add_script_response (&fixture, "0,99\r\n\r\n+CREG: 1\r\n");
+    add_script_response (&fixture, "\r\nOK\r\n");
+    add_script_step (&fixture, "AT+COPS?\r");
+    add_script_response (&fixture, "\r\nERROR\r\n");
+
+    fixture_start (&fixture);
+
+    mm_port_serial_at_command (fixture.port, "AT+CSQ\r", 5000, TRUE, FALSE, NULL,
+                               (GAsyncReadyCallback) pipelined_command_ready, &cmds[0]);
+    while (!cmds[0].done)
+        g_main_context_iteration (NULL, TRUE);
+    mm_port_serial_at_command (fixture.port, "AT+COPS?\r", 5000, TRUE, FALSE, NULL,
+                               (GAsyncReadyCallback) pipelined_command_ready, &cmds[1]);
+    while (!cmds[1].done)
+        g_main_context_iteration (NULL, TRUE);
+
+    g_assert_no_error (cmds[0].error);
+    g_assert_cmpstr (cmds[0].response, ==, "+CSQ: 20,99");
+    g_assert_error (cmds[1].error, MM_MOBILE_EQUIPMENT_ERROR, MM_MOBILE_EQUIPMENT_ERROR_UNKNOWN);
+    g_assert (!cmds[1].response);
+
+    g_assert_cmpuint (urc_context.records->len, ==, 2);
+    g_assert_cmpstr (g_ptr_array_index (urc_context.records, 0), ==, "0: \r\n+CREG: 2\r\n");
+    g_assert_cmpstr (g_ptr_array_index (urc_context.records, 1), ==, "0: \r\n+CREG: 1\r\n");
+
+    g_free (cmds[0].response);
+    g_clear_error (&cmds[1].error);
+    fixture_teardown (&fixture);
+    g_regex_unref (regex);
+    g_ptr_array_unref (urc_context.records);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/port-serial-at/urc-index", test_urc_index);
+    g_test_add_data_func ("/MM/port-serial-at/pipeline-replies", GUINT_TO_POINTER (TRUE), test_pipeline_replies);
+    g_test_add_data_func ("/MM/port-serial-at/no-pipeline-replies", GUINT_TO_POINTER (FALSE), test_pipeline_replies);
+    g_test_add_func ("/MM/port-serial-at/pipeline-no-batching", test_pipeline_no_batching);
+    g_test_add_func ("/MM/port-serial-at/scripted-replies", test_scripted_replies);
+
+    return g_test_run ();
+}
@@ -0,0 +1,600 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+/* Benchmark of the AT serial port stack: MMPortSerialAt, the v1 serial parser
+ * and the unsolicited message handlers of the plugins, driven against the
+ * fake AT responder in test-port-context.
+ *
+ * By default each session is only run a few times, to validate it. Run with
+ * '-m perf' to run the actual benchmarks. A serial capture written with
+ * --serial-capture-dir may be given in the MM_TEST_SERIAL_CAPTURE environment
+ * variable, to benchmark a recorded session as well. */
+
+#include <config.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <ModemManager.h>
+
+#include "mm-port-serial-at.h"
+#include "mm-serial-capture.h"
+#include "mm-modem-helpers.h"
+#include "mm-modem-helpers-cinterion.h"
+#include "mm-modem-helpers-huawei.h"
+#include "mm-modem-helpers-ublox.h"
+#include "mm-log-test.h"
+#include "test-port-context.h"
+
+/*****************************************************************************/
+/* Allocation counting, only available with glibc, where the malloc family
+ * may be interposed. Only the allocations of the main thread are counted,
+ * i.e. not the ones of the fake responder. */
+
+#if defined __GLIBC__
+
+extern void *__libc_malloc  (size_t size);
+extern void *__libc_calloc  (size_t n_members, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+
+static __thread guint64 n_allocations;
+
+void *
+malloc (size_t size)
+{
+    n_allocations++;
+    return __libc_malloc (size);
+}
+
+void *
+calloc (size_t n_members,
+        size_t size)
+{
+    n_allocations++;
+    return __libc_calloc (n_members, size);
+}
+
+void *
+realloc (void   *ptr,
+         size_t  size)
+{
+    n_allocations++;
+    return __libc_realloc (ptr, size);
+}
+
+# define ALLOCATIONS_COUNTED 1
+#else
+static guint64 n_allocations;
+# define ALLOCATIONS_COUNTED 0
+#endif
+
+/*****************************************************************************/
+/* Unsolicited messages, with the same expressions the modems use */
+
+typedef void (* AddUrcRegexesFunc) (GPtrArray *regexes);
+
+/* Handlers set up for all modems, before the plugin specific ones */
+static void
+add_generic_urc_regexes (GPtrArray *regexes)
+{
+    GPtrArray *creg_regexes;
+    guint      i;
+
+    creg_regexes = mm_3gpp_creg_regex_get (FALSE);
+    for (i = 0; i < creg_regexes->len; i++)
+        g_ptr_array_add (regexes, g_regex_ref (g_ptr_array_index (creg_regexes, i)));
+    mm_3gpp_creg_regex_destroy (creg_regexes);
+
+    g_ptr_array_add (regexes, mm_3gpp_ciev_regex_get ());
+    g_ptr_array_add (regexes, mm_3gpp_cgev_regex_get ());
+    g_ptr_array_add (regexes, mm_3gpp_cusd_regex_get ());
+    g_ptr_array_add (regexes, mm_3gpp_cmti_regex_get ());
+    g_ptr_array_add (regexes, mm_3gpp_cds_regex_get ());
+    g_ptr_array_add (regexes, mm_voice_ring_regex_get ());
+    g_ptr_array_add (regexes, mm_voice_cring_regex_get ());
+    g_ptr_array_add (regexes, mm_voice_clip_regex_get ());
+    g_ptr_array_add (regexes, mm_voice_ccwa_regex_get ());
+}
+
+static void
+add_huawei_urc_regexes (GPtrArray *regexes)
+{
+    guint i;
+
+    for (i = 0; i <= MM_HUAWEI_URC_LAST; i++)
+        g_ptr_array_add (regexes, mm_huawei_get_urc_regex ((MMHuaweiUrc) i));
+}
+
+static void
+add_cinterion_urc_regexes (GPtrArray *regexes)
+{
+    g_ptr_array_add (regexes, mm_cinterion_get_ciev_regex ());
+    g_ptr_array_add (regexes, mm_cinterion_get_sysstart_regex ());
+    g_ptr_array_add (regexes, mm_cinterion_get_scks_regex ());
+    g_ptr_array_add (regexes, mm_cinterion_get_shutdown_regex ());
+    g_ptr_array_add (regexes, mm_cinterion_get_slcc_regex ());
+    g_ptr_array_add (regexes, mm_cinterion_get_ctzu_regex ());
+}
+
+static void
+add_ublox_urc_regexes (GPtrArray *regexes)
+{
+    g_ptr_array_add (regexes, mm_ublox_get_ucallstat_regex ());
+    g_ptr_array_add (regexes, mm_ublox_get_uudtmfd_regex ());
+    g_ptr_array_add (regexes, mm_ublox_get_pbready_regex ());
+}
+
+static void
+add_all_urc_regexes (GPtrArray *regexes)
+{
+    add_huawei_urc_regexes (regexes);
+    add_cinterion_urc_regexes (regexes);
+    add_ublox_urc_regexes (regexes);
+}
+
+/*****************************************************************************/
+/* Scripted sessions */
+
+typedef struct {
+    const gchar *command;
+    const gchar *response;
+    gboolean     error;
+    guint        n_urcs;
+} ScriptedCommand;
+
+static const ScriptedCommand huawei_script[] = {
+    { "AT+CSQ",       "\r\n^RSSI: 20\r\n\r\n+CSQ: 20,99\r\n\r\nOK\r\n", FALSE, 1 },
+    { "AT^SYSINFOEX", "\r\n^SYSINFOEX: 2,3,0,1,,3,\"WCDMA\",41,\"WCDMA\"\r\n\r\nOK\r\n", FALSE, 0 },
+    { "AT+COPS?",     "\r\n+COPS: 0,0,\"Operator\",2\r\n\r\n^MODE: 5,4\r\n\r\nOK\r\n", FALSE, 1 },
+    { "AT^HCSQ?",     "\r\n^HCSQ: \"LTE\",50,50,180,20\r\n\r\nOK\r\n\r\n^HCSQ: \"LTE\",51,50,180,20\r\n", FALSE, 1 },
+    { "AT^NDISSTATQRY?", "\r\n^NDISSTATQRY: 1,,,\"IPV4\",0,,,\"IPV6\"\r\n\r\nOK\r\n", FALSE, 0 },
+    { "AT^DSFLOWQRY", "\r\n^DSFLOWRPT:00000124,00000000,00000000,00000000000000B8,00000000000000C4,0000BB80,0001F400\r\n"
+                      "\r\n^DSFLOWQRY:00000124,00000000000000B8,00000000000000C4,00000124,00000000000000B8,00000000000000C4\r\n\r\nOK\r\n", FALSE, 1 },
+    { "AT^CARDLOCK?", "\r\n+CME ERROR: 3\r\n", TRUE, 0 },
+    { NULL }
+};
+
+static const ScriptedCommand cinterion_script[] = {
+    { "AT+CSQ",       "\r\n+CSQ: 18,99\r\n\r\nOK\r\n", FALSE, 0 },
+    { "AT^SIND?",     "\r\n^SIND: battchg,1,5\r\n^SIND: signal,1,99\r\n^SIND: service,1,1\r\n^SIND: psinfo,1,10\r\n\r\nOK\r\n", FALSE, 0 },
+    /* The generic +CREG handlers also take the solicited reply, as in the daemon */
+    { "AT+CREG?",     "\r\n+CIEV: psinfo,10\r\n\r\n+CREG: 2,1,\"1A2B\",\"0C3D4E5F\",7\r\n\r\nOK\r\n", FALSE, 2 },
+    { "AT^SMONI",     "\r\n^SMONI: 4G,6300,20,10,10,FDD,262,02,BF75,0345103,350,33,-94,-7,NOCONN\r\n\r\nOK\r\n", FALSE, 0 },
+    { "AT^SWWAN?",    "\r\n^SWWAN: 3,1,1\r\n\r\nOK\r\n\r\n+CIEV: service,1\r\n", FALSE, 1 },
+    { "AT^SCFG?",     "\r\nERROR\r\n", TRUE, 0 },
+    { NULL }
+};
+
+static const ScriptedCommand ublox_script[] = {
+    { "AT+CSQ",       "\r\n+CSQ: 23,99\r\n\r\nOK\r\n", FALSE, 0 },
+    { "AT+UCGDFLT?",  "\r\n+UCGDFLT: 0,\"IP\",\"internet\",\"0.0.0.0\",0,0,0,0,0,0,0,1,0,0,0,0,0,0,0\r\n\r\nOK\r\n", FALSE, 0 },
+    { "AT+URAT?",     "\r\n+URAT: 1,2\r\n\r\n+PBREADY\r\n\r\nOK\r\n", FALSE, 1 },
+    { "AT+CGACT?",    "\r\n+CGACT: 1,1\r\n+CGACT: 4,0\r\n\r\nOK\r\n", FALSE, 0 },
+    { "AT+UIPADDR",   "\r\n+UIPADDR: 1,\"usb0:0\",\"5.168.120.13\",\"255.255.255.0\",\"\",\"\"\r\n\r\nOK\r\n\r\n+UCALLSTAT: 1,2\r\n", FALSE, 1 },
+    { "AT+UBMCONF?",  "\r\n+CME ERROR: 4\r\n", TRUE, 0 },
+    { NULL }
+};
+
+/*****************************************************************************/
+
+typedef struct {
+    const gchar      *name;
+    AddUrcRegexesFunc add_urc_regexes;
+    /* Commands to run, in order */
+    GPtrArray        *commands;
+    /* Per command, whether an error is expected and how many unsolicited
+     * messages come along; only known for scripted sessions */
+    GArray           *errors;
+    GArray           *n_urcs;
+    guint64           n_bytes;
+} Session;
+
+static void
+session_free (Session *session)
+{
+    g_ptr_array_unref (session->commands);
+    if (session->errors)
+        g_array_unref (session->errors);
+    if (session->n_urcs)
+        g_array_unref (session->n_urcs);
+    g_slice_free (Session, session);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (Session, session_free)
+
+static Session *
+session_new_scripted (const gchar            *name,
+                      AddUrcRegexesFunc       add_urc_regexes,
+                      const ScriptedCommand  *script,
+                      TestPortContext        *port_context)
+{
+    Session *session;
+    guint    i;
+
+    session = g_slice_new0 (Session);
+    session->name = name;
+    session->add_urc_regexes = add_urc_regexes;
+    session->commands = g_ptr_array_new_with_free_func (g_free);
+    session->errors = g_array_new (FALSE, FALSE, sizeof (gboolean));
+    session->n_urcs = g_array_new (FALSE, FALSE, sizeof (guint));
+
+    for (i = 0; script[i].command; i++) {
+        g_autofree gchar *escaped = NULL;
+
+        /* The responder takes the responses escaped */
+        escaped = g_strescape (script[i].response, NULL);
+        test_port_context_set_command (port_context, script[i].command, escaped);
+        g_ptr_array_add (session->commands, g_strdup (script[i].command));
+        g_array_append_val (session->errors, script[i].error);
+        g_array_append_val (session->n_urcs, script[i].n_urcs);
+        session->n_bytes += strlen (script[i].command) + 1 + strlen (script[i].response);
+    }
+
+    return session;
+}
+
+/* The commands in a capture are paired with all the data read until the next
+ * command is written. If the same command was run more than once, the
+ * responder replies with the last response captured for it. */
+static Session *
+session_new_recorded (const gchar     *capture_path,
+                      TestPortContext *port_context)
+{
+    g_autoptr(MMSerialCaptureReader)  reader = NULL;
+    g_autoptr(GString)                response = NULL;
+    g_autofree gchar                 *command = NULL;
+    gint64                            timestamp;
+    MMSerialCaptureDirection          direction;
+    const guint8                     *data;
+    gsize                             len;
+    GError                           *error = NULL;
+    Session                          *session;
+    guint                             k;
+
+    reader = mm_serial_capture_reader_new (capture_path, &error);
+    g_assert_no_error (error);
+
+    session = g_slice_new0 (Session);
+    session->name = "recorded";
+    /* The unsolicited messages of all plugins are expected */
+    session->add_urc_regexes = add_all_urc_regexes;
+    session->commands = g_ptr_array_new_with_free_func (g_free);
+    response = g_string_new (NULL);
+
+    do {
+        gboolean more;
+
+        more = mm_serial_capture_reader_next (reader, &timestamp, &direction, &data, &len, &error);
+        g_assert_no_error (error);
+
+        if (more && direction == MM_SERIAL_CAPTURE_DIRECTION_READ) {
+            g_string_append_len (response, (const gchar *) data, len);
+            continue;
+        }
+
+        if (command) {
+            g_autofree gchar *escaped = NULL;
+
+            escaped = g_strescape (response->str, NULL);
+            test_port_context_set_command (port_context, command, escaped);
+            session->n_bytes += strlen (command) + 1 + response->len;
+            g_ptr_array_add (session->commands, g_steal_pointer (&command));
+        }
+        g_string_truncate (response, 0);
+
+        if (!more)
+            break;
+
+        /* Only AT commands are replayed, e.g. not SMS PDUs */
+        if (len > 2 && g_ascii_strncasecmp ((const gchar *) data, "AT", 2) == 0) {
+            for (k = 0; k < len && data[k] != '\r' && data[k] != '\n'; k++);
+            command = g_strndup ((const gchar *) data, k);
+        }
+    } while (TRUE);
+
+    return session;
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    Session        *session;
+    MMPortSerialAt *port;
+    GMainLoop      *loop;
+    gboolean        pipeline;
+    guint           n_commands;
+    guint           n_in_flight;
+    guint           next;
+    guint           n_completed;
+    guint           n_urcs;
+    guint           n_expected_urcs;
+    GArray         *latencies;
+} RunContext;
+
+static void run_next_commands (RunContext *ctx);
+
+typedef struct {
+    RunContext *ctx;
+    guint       index;
+    gint64      start;
+} CommandContext;
+
+static void
+command_ready (MMPortSerialAt *port,
+               GAsyncResult   *res,
+               CommandContext *command_ctx)
+{
+    RunContext        *ctx = command_ctx->ctx;
+    g_autoptr(GError)  error = NULL;
+    gint64             latency;
+    guint              index;
+
+    mm_port_serial_at_command_finish (port, res, &error);
+    latency = g_get_monotonic_time () - command_ctx->start;
+    g_array_append_val (ctx->latencies, latency);
+
+    /* Only scripted sessions know which commands fail */
+    index = command_ctx->index % ctx->session->commands->len;
+    if (ctx->session->errors) {
+        if (g_array_index (ctx->session->errors, gboolean, index))
+            g_assert (error);
+        else
+            g_assert_no_error (error);
+        ctx->n_expected_urcs += g_array_index (ctx->session->n_urcs, guint, index);
+    } else
+        g_assert (!error || error->domain != MM_SERIAL_ERROR);
+
+    g_slice_free (CommandContext, command_ctx);
+
+    ctx->n_in_flight--;
+    ctx->n_completed++;
+    if (ctx->n_completed == ctx->n_commands)
+        g_main_loop_quit (ctx->loop);
+    else
+        run_next_commands (ctx);
+}
+
+static void
+run_next_commands (RunContext *ctx)
+{
+    guint max_in_flight;
+
+    /* The port sends at most 8 commands at once in pipelined mode */
+    max_in_flight = ctx->pipeline ? 8 : 1;
+
+    while (ctx->next < ctx->n_commands && ctx->n_in_flight < max_in_flight) {
+        CommandContext *command_ctx;
+
+        command_ctx = g_slice_new (CommandContext);
+        command_ctx->ctx = ctx;
+        command_ctx->index = ctx->next++;
+        command_ctx->start = g_get_monotonic_time ();
+        ctx->n_in_flight++;
+        mm_port_serial_at_command (ctx->port,
+                                   g_ptr_array_index (ctx->session->commands,
+                                                      command_ctx->index % ctx->session->commands->len),
+                                   10000,
+                                   FALSE,
+                                   FALSE,
+                                   NULL,
+                                   (GAsyncReadyCallback) command_ready,
+                                   command_ctx);
+    }
+}
+
+static void
+urc_received (MMPortSerialAt *port,
+              GMatchInfo     *match_info,
+              RunContext     *ctx)
+{
+    ctx->n_urcs++;
+}
+
+static gint
+compare_latencies (const gint64 *a,
+                   const gint64 *b)
+{
+    return (*a > *b) - (*a < *b);
+}
+
+static gint64
+latency_percentile (GArray *latencies,
+                    guint   percentile)
+{
+    return g_array_index (latencies, gint64, (latencies->len - 1) * percentile / 100);
+}
+
+static void
+run_session (TestPortContext *port_context,
+             const gchar     *port_name,
+             Session         *session,
+             gboolean         pipeline,
+             guint            n_commands)
+{
+    g_autoptr(MMPortSerialAt)  port = NULL;
+    g_autoptr(GMainLoop)       loop = NULL;
+    GPtrArray                 *regexes;
+    RunContext                 ctx = { 0 };
+    GError                    *error = NULL;
+    guint64                    n_bytes;
+    guint64                    start_allocations;
+    gint64                     start;
+    gdouble                    elapsed;
+    guint                      i;
+
+    port = mm_port_serial_at_new (port_name, MM_PORT_SUBSYS_UNIX);
+    g_object_set (port,
+                  MM_PORT_SERIAL_SEND_DELAY,                 (guint64) 0,
+                  MM_PORT_SERIAL_SEND_DELAY_ADAPTIVE,        FALSE,
+                  MM_PORT_SERIAL_PIPELINE,                   pipeline,
+                  MM_PORT_SERIAL_AT_REMOVE_ECHO,             FALSE,
+                  MM_PORT_SERIAL_AT_INIT_SEQUENCE_ENABLED,   FALSE,
+                  NULL);
+
+    regexes = g_ptr_array_new_with_free_func ((GDestroyNotify) g_regex_unref);
+    add_generic_urc_regexes (regexes);
+    session->add_urc_regexes (regexes);
+    for (i = 0; i < regexes->len; i++)
+        mm_port_serial_at_add_unsolicited_msg_handler (port,
+                                                       g_ptr_array_index (regexes, i),
+                                                       (MMPortSerialAtUnsolicitedMsgFn) urc_received,
+                                                       &ctx,
+                                                       NULL);
+
+    g_assert (mm_port_serial_open (MM_PORT_SERIAL (port), &error));
+    g_assert_no_error (error);
+
+    loop = g_main_loop_new (NULL, FALSE);
+    ctx.session = session;
+    ctx.port = port;
+    ctx.loop = loop;
+    ctx.pipeline = pipeline;
+    ctx.n_commands = n_commands;
+    ctx.latencies = g_array_sized_new (FALSE, FALSE, sizeof (gint64), n_commands);
+
+    start_allocations = n_allocations;
+    start = g_get_monotonic_time ();
+    run_next_commands (&ctx);
+    g_main_loop_run (loop);
+    elapsed = (gdouble) (g_get_monotonic_time () - start) / G_USEC_PER_SEC;
+
+    g_assert_cmpuint (ctx.n_completed, ==, n_commands);
+    if (session->n_urcs)
+        g_assert_cmpuint (ctx.n_urcs, ==, ctx.n_expected_urcs);
+
+    /* Average bytes per command in the session, both ways */
+    n_bytes = session->n_bytes * n_commands / session->commands->len;
+    g_array_sort (ctx.latencies, (GCompareFunc) compare_latencies);
+
+    g_test_message ("%s%s: %u commands in %.3f s: %.0f commands/s, %.0f bytes/s",
+                    session->name, pipeline ? " (pipelined)" : "",
+                    n_commands, elapsed, n_commands / elapsed, n_bytes / elapsed);
+    g_test_message ("%s%s: latency p50 %" G_GINT64_FORMAT " us, p90 %" G_GINT64_FORMAT " us, "
+                    "p99 %" G_GINT64_FORMAT " us, max %" G_GINT64_FORMAT " us",
+                    session->name, pipeline ? " (pipelined)" : "",
+                    latency_percentile (ctx.latencies, 50), latency_percentile (ctx.latencies, 90),
+                    latency_percentile (ctx.latencies, 99), latency_percentile (ctx.latencies, 100));
+    if (ALLOCATIONS_COUNTED)
+        g_test_message ("%s%s: %.1f allocations per command",
+                        session->name, pipeline ? " (pipelined)" : "",
+                        (gdouble) (n_allocations - start_allocations) / n_commands);
+    g_test_minimized_result (elapsed / n_commands,
+                             "%s%s: %.3f us per command",
+                             session->name, pipeline ? " (pipelined)" : "",
+                             elapsed * G_USEC_PER_SEC / n_commands);
+
+    mm_port_serial_close (MM_PORT_SERIAL (port));
+    g_array_unref (ctx.latencies);
+    g_ptr_array_unref (regexes);
+}
+
+/*****************************************************************************/
+
+#define VALIDATE_N_ITERATIONS   2
+#define BENCHMARK_N_ITERATIONS  2000
+
+typedef struct {
+    const gchar            *name;
+    AddUrcRegexesFunc       add_urc_regexes;
+    const ScriptedCommand  *script;
+    gboolean                pipeline;
+} SessionTest;
+
+static const SessionTest session_tests[] = {
+    { "huawei",    add_huawei_urc_regexes,    huawei_script,    FALSE },
+    { "huawei",    add_huawei_urc_regexes,    huawei_script,    TRUE  },
+    { "cinterion", add_cinterion_urc_regexes, cinterion_script, FALSE },
+    { "cinterion", add_cinterion_urc_regexes, cinterion_script, TRUE  },
+    { "ublox",     add_ublox_urc_regexes,     ublox_script,     FALSE },
+    { "ublox",     add_ublox_urc_regexes,     ublox_script,     TRUE  },
+};
+
+static gchar *
+build_port_name (const gchar *name)
+{
+    /* Add process ID so that multiple runs in the same system don't clash */
+    return g_strdup_printf ("abstract:port-serial-benchmark-%s:%ld", name, (glong) getpid ());
+}
+
+static void
+test_scripted_session (const SessionTest *test)
+{
+    g_autofree gchar   *port_name = NULL;
+    g_autoptr(Session)  session = NULL;
+    TestPortContext    *port_context;
+    guint               n_iterations;
+
+    port_name = build_port_name (test->name);
+    port_context = test_port_context_new (port_name);
+    session = session_new_scripted (test->name, test->add_urc_regexes, test->script, port_context);
+    test_port_context_start (port_context);
+
+    n_iterations = g_test_perf () ? BENCHMARK_N_ITERATIONS : VALIDATE_N_ITERATIONS;
+    run_session (port_context, port_name, session, test->pipeline, session->commands->len * n_iterations);
+
+    test_port_context_stop (port_context);
+    test_port_context_free (port_context);
+}
+
+static void
+test_recorded_session (void)
+{
+    g_autofree gchar   *port_name = NULL;
+    g_autoptr(Session)  session = NULL;
+    TestPortContext    *port_context;
+    const gchar        *capture_path;
+    guint               n_iterations;
+
+    capture_path = g_getenv ("MM_TEST_SERIAL_CAPTURE");
+    if (!capture_path) {
+        g_test_message ("no serial capture given in MM_TEST_SERIAL_CAPTURE");
+        return;
+    }
+
+    port_name = build_port_name ("recorded");
+    port_context = test_port_context_new (port_name);
+    session = session_new_recorded (capture_path, port_context);
+    test_port_context_start (port_context);
+
+    if (session->commands->len > 0) {
+        n_iterations = g_test_perf () ? MAX (BENCHMARK_N_ITERATIONS / session->commands->len, 1) : 1;
+        run_session (port_context, port_name, session, FALSE, session->commands->len * n_iterations);
+    }
+
+    test_port_context_stop (port_context);
+    test_port_context_free (port_context);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    guint i;
+
+    g_test_init (&argc, &argv, NULL);
+
+    for (i = 0; i < G_N_ELEMENTS (session_tests); i++) {
+        g_autofree gchar *path = NULL;
+
+        path = g_strdup_printf ("/MM/port-serial-benchmark/%s%s",
+                                session_tests[i].name,
+                                session_tests[i].pipeline ? "-pipelined" : "");
+        g_test_add_data_func (path, &session_tests[i], (GTestDataFunc) test_scripted_session);
+    }
+    g_test_add_func ("/MM/port-serial-benchmark/recorded", test_recorded_session);
+
+    return g_test_run ();
+}
@@ -0,0 +1,50 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <libmm-glib.h>
+
+#include "test-fixture.h"
+
+/*****************************************************************************/
+
+/* The daemon runs with all the plugins built in the tree, so the index is
+ * checked against the filters given by the real plugin objects */
+static void
+test_built_plugins (TestFixture *fixture)
+{
+    GError *error = NULL;
+    guint   n_ports = 0;
+
+    g_assert (fixture->test != NULL);
+    mm_gdbus_test_call_check_plugin_index_sync (fixture->test,
+                                                &n_ports,
+                                                NULL, /* cancellable */
+                                                &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (n_ports, >, 0);
+}
+
+/*****************************************************************************/
+
+int main (int   argc,
+          char *argv[])
+{
+    g_test_init (&argc, &argv, NULL);
+
+    TEST_ADD ("/MM/Service/PluginIndex/built-plugins", test_built_plugins);
+
+    return g_test_run ();
+}
@@ -25,6 +25,7 @@
 #include "mm-log.h"
 #include "mm-modem-helpers.h"
 #include "mm-modem-helpers-thuraya.h"
+#include "mm-regex-registry.h"
 
 /*************************************************************************/
 
@@ -92,7 +93,7 @@ mm_thuraya_3gpp_parse_cpms_test_response (const gchar  *reply,
         return FALSE;
     }
 
-    r = g_regex_new ("\\s*\"([^,\\)]+)\"\\s*", 0, 0, NULL);
+    r = mm_regex_get ("\\s*\"([^,\\)]+)\"\\s*", 0);
     g_assert (r);
 
     for (i = 0; i < N_EXPECTED_GROUPS; i++) {
@@ -103,7 +104,7 @@ mm_thuraya_3gpp_parse_cpms_test_response (const gchar  *reply,
         array = g_array_new (FALSE, FALSE, sizeof (MMSmsStorage));
 
         /* Got a range group to match */
-        if (g_regex_match (r, splita[i], 0, &match_info)) {
+        if (mm_regex_match (r, splita[i], 0, &match_info)) {
             while (g_match_info_matches (match_info)) {
                 g_autofree gchar *str = NULL;
 
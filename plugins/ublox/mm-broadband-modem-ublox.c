@@ -975,7 +975,7 @@ voice_unsolicited_events_context_step (GTask *task)
             mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                            ctx->primary,
                                            ctx->ucallstat_command,
-                                           3,
+                                           3000,
                                            FALSE,
                                            FALSE,
                                            NULL,
@@ -993,7 +993,7 @@ voice_unsolicited_events_context_step (GTask *task)
             mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                            ctx->secondary,
                                            ctx->ucallstat_command,
-                                           3,
+                                           3000,
                                            FALSE,
                                            FALSE,
                                            NULL,
@@ -1011,7 +1011,7 @@ voice_unsolicited_events_context_step (GTask *task)
             mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                            ctx->primary,
                                            ctx->udtmfd_command,
-                                           3,
+                                           3000,
                                            FALSE,
                                            FALSE,
                                            NULL,
@@ -1029,7 +1029,7 @@ voice_unsolicited_events_context_step (GTask *task)
             mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                            ctx->secondary,
                                            ctx->udtmfd_command,
-                                           3,
+                                           3000,
                                            FALSE,
                                            FALSE,
                                            NULL,
@@ -1279,12 +1279,10 @@ common_voice_setup_cleanup_unsolicited_events (MMBroadbandModemUblox *self,
     guint           i;
 
     if (G_UNLIKELY (!self->priv->ucallstat_regex))
-        self->priv->ucallstat_regex = g_regex_new ("\\r\\n\\+UCALLSTAT:\\s*(\\d+),(\\d+)\\r\\n",
-                                                   G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        self->priv->ucallstat_regex = mm_ublox_get_ucallstat_regex ();
 
     if (G_UNLIKELY (!self->priv->udtmfd_regex))
-        self->priv->udtmfd_regex = g_regex_new ("\\r\\n\\+UUDTMFD:\\s*([0-9A-D\\*\\#])\\r\\n",
-                                                G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        self->priv->udtmfd_regex = mm_ublox_get_uudtmfd_regex ();
 
     ports[0] = mm_base_modem_peek_port_primary   (MM_BASE_MODEM (self));
     ports[1] = mm_base_modem_peek_port_secondary (MM_BASE_MODEM (self));
@@ -1829,8 +1827,7 @@ mm_broadband_modem_ublox_init (MMBroadbandModemUblox *self)
     self->priv->support_config.uact     = FEATURE_SUPPORT_UNKNOWN;
     self->priv->support_config.ubandsel = FEATURE_SUPPORT_UNKNOWN;
     self->priv->udtmfd_support = FEATURE_SUPPORT_UNKNOWN;
-    self->priv->pbready_regex = g_regex_new ("\\r\\n\\+PBREADY\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->pbready_regex = mm_ublox_get_pbready_regex ();
 }
 
 static void
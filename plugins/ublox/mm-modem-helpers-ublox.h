@@ -210,4 +210,11 @@ gboolean mm_ublox_parse_ugcntrd_response_for_cid (const gchar  *response,
                                                   guint64      *total_rx_bytes,
                                                   GError      **error);
 
+/*****************************************************************************/
+/* Unsolicited message regexes */
+
+GRegex *mm_ublox_get_ucallstat_regex (void);
+GRegex *mm_ublox_get_uudtmfd_regex   (void);
+GRegex *mm_ublox_get_pbready_regex   (void);
+
 #endif  /* MM_MODEM_HELPERS_UBLOX_H */
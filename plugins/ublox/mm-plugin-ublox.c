@@ -23,6 +23,7 @@
 #include "mm-serial-parsers.h"
 #include "mm-broadband-modem-ublox.h"
 #include "mm-plugin-ublox.h"
+#include "mm-regex-registry.h"
 
 G_DEFINE_TYPE (MMPluginUblox, mm_plugin_ublox, MM_TYPE_PLUGIN)
 
@@ -201,8 +202,8 @@ ublox_custom_init (MMPortProbe         *probe,
     ctx = g_slice_new0 (CustomInitContext);
     ctx->wait_timeout_secs = wait_timeout_secs;
     ctx->port = g_object_ref (port);
-    ctx->ready_regex = g_regex_new ("\\r\\n\\+AT:\\s*READY\\r\\n",
-                                    G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    ctx->ready_regex = mm_regex_get ("\\r\\n\\+AT:\\s*READY\\r\\n",
+                                     G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_task_set_task_data (task, ctx, (GDestroyNotify) custom_init_context_free);
 
     /* If the device hasn't been plugged in right away, we assume it was already
@@ -213,7 +214,7 @@ ublox_custom_init (MMPortProbe         *probe,
     if (!mm_device_get_hotplugged (mm_port_probe_peek_device (probe))) {
         mm_port_serial_at_command (ctx->port,
                                    "AT",
-                                   1,
+                                   1000,
                                    FALSE, /* raw */
                                    FALSE, /* allow_cached */
                                    g_task_get_cancellable (task),
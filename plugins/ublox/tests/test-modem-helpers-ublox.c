@@ -25,6 +25,7 @@
 #include "mm-log-test.h"
 #include "mm-modem-helpers.h"
 #include "mm-modem-helpers-ublox.h"
+#include "mm-regex-registry.h"
 
 #include "test-helpers.h"
 
@@ -86,6 +87,35 @@ test_upincnt_response (void)
     }
 }
 
+static void
+test_upincnt_response_regex_reused (void)
+{
+    GError   *error = NULL;
+    gboolean  success;
+    guint     n_compiles;
+    guint     pin_attempts;
+    guint     pin2_attempts;
+    guint     puk_attempts;
+    guint     puk2_attempts;
+
+    /* First parse may compile the pattern, further ones must not */
+    success = mm_ublox_parse_upincnt_response (upincnt_response_tests[0].str,
+                                               &pin_attempts, &pin2_attempts,
+                                               &puk_attempts, &puk2_attempts,
+                                               &error);
+    g_assert_no_error (error);
+    g_assert (success);
+
+    n_compiles = mm_regex_registry_get_n_compiles ();
+    success = mm_ublox_parse_upincnt_response (upincnt_response_tests[1].str,
+                                               &pin_attempts, &pin2_attempts,
+                                               &puk_attempts, &puk2_attempts,
+                                               &error);
+    g_assert_no_error (error);
+    g_assert (success);
+    g_assert_cmpuint (mm_regex_registry_get_n_compiles (), ==, n_compiles);
+}
+
 /*****************************************************************************/
 /* Test UUSBCONF? responses */
 
@@ -986,6 +1016,7 @@ int main (int argc, char **argv)
     g_test_init (&argc, &argv, NULL);
 
     g_test_add_func ("/MM/ublox/upincnt/response",  test_upincnt_response);
+    g_test_add_func ("/MM/ublox/upincnt/regex-reused", test_upincnt_response_regex_reused);
     g_test_add_func ("/MM/ublox/uusbconf/response", test_uusbconf_response);
     g_test_add_func ("/MM/ublox/ubmconf/response",  test_ubmconf_response);
     g_test_add_func ("/MM/ublox/uipaddr/response",  test_uipaddr_response);
@@ -31,6 +31,7 @@
 #include "mm-broadband-modem-via.h"
 #include "mm-iface-modem-cdma.h"
 #include "mm-iface-modem.h"
+#include "mm-regex-registry.h"
 
 static void iface_modem_cdma_init (MMIfaceModemCdma *iface);
 
@@ -192,12 +193,12 @@ sysinfo_ready (MMBaseModem  *self,
     response = mm_strip_tag (response, "^SYSINFO:");
 
     /* Format is "<srv_status>,<srv_domain>,<roam_status>,<sys_mode>,<sim_state>" */
-    r = g_regex_new ("\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,\\s*(\\d+)",
-                     G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    r = mm_regex_get ("\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,\\s*(\\d+)",
+                      G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (r != NULL);
 
     /* Try to parse the results */
-    g_regex_match (r, response, 0, &match_info);
+    mm_regex_match (r, response, 0, &match_info);
     if (g_match_info_get_match_count (match_info) < 6) {
         mm_obj_warn (self, "failed to parse ^SYSINFO response: '%s'", response);
         goto out;
@@ -475,26 +476,26 @@ mm_broadband_modem_via_init (MMBroadbandModemVia *self)
                                               MMBroadbandModemViaPrivate);
 
     /* Prepare regular expressions to setup */
-    self->priv->hrssilvl_regex = g_regex_new ("\\r\\n\\^HRSSILVL:(.*)\\r\\n",
-                                              G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->mode_regex = g_regex_new ("\\r\\n\\^MODE:(.*)\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->dosession_regex = g_regex_new ("\\r\\n\\+DOSESSION:(.*)\\r\\n",
-                                               G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->simst_regex = g_regex_new ("\\r\\n\\^SIMST:(.*)\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->simst_regex = g_regex_new ("\\r\\n\\+VPON:(.*)\\r\\n",
-                                           G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->creg_regex = g_regex_new ("\\r\\n\\+CREG:(.*)\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->vrom_regex = g_regex_new ("\\r\\n\\+VROM:(.*)\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->vser_regex = g_regex_new ("\\r\\n\\+VSER:(.*)\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->ciev_regex = g_regex_new ("\\r\\n\\+CIEV:(.*)\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->vpup_regex = g_regex_new ("\\r\\n\\+VPUP:(.*)\\r\\n",
-                                          G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->hrssilvl_regex = mm_regex_get ("\\r\\n\\^HRSSILVL:(.*)\\r\\n",
+                                               G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->mode_regex = mm_regex_get ("\\r\\n\\^MODE:(.*)\\r\\n",
+                                           G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->dosession_regex = mm_regex_get ("\\r\\n\\+DOSESSION:(.*)\\r\\n",
+                                                G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->simst_regex = mm_regex_get ("\\r\\n\\^SIMST:(.*)\\r\\n",
+                                            G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->simst_regex = mm_regex_get ("\\r\\n\\+VPON:(.*)\\r\\n",
+                                            G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->creg_regex = mm_regex_get ("\\r\\n\\+CREG:(.*)\\r\\n",
+                                           G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->vrom_regex = mm_regex_get ("\\r\\n\\+VROM:(.*)\\r\\n",
+                                           G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->vser_regex = mm_regex_get ("\\r\\n\\+VSER:(.*)\\r\\n",
+                                           G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->ciev_regex = mm_regex_get ("\\r\\n\\+CIEV:(.*)\\r\\n",
+                                           G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->vpup_regex = mm_regex_get ("\\r\\n\\+VPUP:(.*)\\r\\n",
+                                           G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 static void
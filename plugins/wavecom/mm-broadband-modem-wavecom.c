@@ -34,6 +34,7 @@
 #include "mm-iface-modem-3gpp.h"
 #include "mm-base-modem-at.h"
 #include "mm-broadband-modem-wavecom.h"
+#include "mm-regex-registry.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 static void iface_modem_3gpp_init (MMIfaceModem3gpp *iface);
@@ -257,10 +258,10 @@ wwsm_read_ready (MMBaseModem  *self,
      *   +WWSM: 2,1  (2G preferred)
      *   +WWSM: 2,2  (3G preferred)
      */
-    r = g_regex_new ("\\r\\n\\+WWSM: ([0-2])(,([0-2]))?.*$", 0, 0, NULL);
+    r = mm_regex_get ("\\r\\n\\+WWSM: ([0-2])(,([0-2]))?.*$", 0);
     g_assert (r != NULL);
 
-    if (g_regex_match (r, response, 0, &match_info)) {
+    if (mm_regex_match (r, response, 0, &match_info)) {
         guint allowed = 0;
 
         if (mm_get_uint_from_match_info (match_info, 1, &allowed)) {
@@ -1030,10 +1031,10 @@ parse_network_registration_mode (const gchar *reply,
     if (!reply)
         return FALSE;
 
-    r = g_regex_new ("\\+COPS:\\s*(\\d)", G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_get ("\\+COPS:\\s*(\\d)", G_REGEX_UNGREEDY);
     g_assert (r != NULL);
 
-    g_regex_match (r, reply, 0, &match_info);
+    mm_regex_match (r, reply, 0, &match_info);
 
     return (g_match_info_matches (match_info) && mm_get_uint_from_match_info (match_info, 1, mode));
 }
@@ -1238,9 +1239,8 @@ setup_ports (MMBroadbandModem *self)
 
     /* AT+CPIN? replies will never have an OK appended */
     parser = mm_serial_parser_v1_new ();
-    regex = g_regex_new ("\\r\\n\\+CPIN: .*\\r\\n",
-                         G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                         0, NULL);
+    regex = mm_regex_get ("\\r\\n\\+CPIN: .*\\r\\n",
+                          G_REGEX_RAW | G_REGEX_OPTIMIZE);
     mm_serial_parser_v1_set_custom_regex (parser, regex, NULL);
     g_regex_unref (regex);
 
@@ -30,6 +30,7 @@
 #include "mm-base-modem-at.h"
 #include "mm-iface-modem.h"
 #include "mm-broadband-modem-x22x.h"
+#include "mm-regex-registry.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 
@@ -131,10 +132,10 @@ load_current_modes_finish (MMIfaceModem *self,
     if (!response)
         return FALSE;
 
-    r = g_regex_new ("\\+SYSSEL:\\s*(\\d+),(\\d+),(\\d+),(\\d+)", G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_get ("\\+SYSSEL:\\s*(\\d+),(\\d+),(\\d+),(\\d+)", G_REGEX_UNGREEDY);
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &match_error)) {
+    if (!mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &match_error)) {
         if (match_error) {
             g_propagate_error (error, match_error);
         } else {
@@ -379,14 +380,14 @@ mm_broadband_modem_x22x_init (MMBroadbandModemX22x *self)
                                               MM_TYPE_BROADBAND_MODEM_X22X,
                                               MMBroadbandModemX22xPrivate);
 
-    self->priv->mode_regex    = g_regex_new ("\\r\\n\\^MODE:.+\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->sysinfo_regex = g_regex_new ("\\r\\n\\^SYSINFO:.+\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->specc_regex   = g_regex_new ("\\r\\n\\+SPECC\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-    self->priv->sperror_regex = g_regex_new ("\\r\\n\\+SPERROR:.+\\r\\n",
-                                             G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    self->priv->mode_regex    = mm_regex_get ("\\r\\n\\^MODE:.+\\r\\n",
+                                              G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->sysinfo_regex = mm_regex_get ("\\r\\n\\^SYSINFO:.+\\r\\n",
+                                              G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->specc_regex   = mm_regex_get ("\\r\\n\\+SPECC\\r\\n",
+                                              G_REGEX_RAW | G_REGEX_OPTIMIZE);
+    self->priv->sperror_regex = mm_regex_get ("\\r\\n\\+SPERROR:.+\\r\\n",
+                                              G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 static void
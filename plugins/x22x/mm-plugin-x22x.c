@@ -133,7 +133,7 @@ x22x_custom_init_step (GTask *task)
     mm_port_serial_at_command (
         ctx->port,
         "AT+GMR",
-        3,
+        3000,
         FALSE, /* raw */
         FALSE, /* allow_cached */
         cancellable,
@@ -30,6 +30,7 @@
 #include "mm-base-modem-at.h"
 #include "mm-shared-xmm.h"
 #include "mm-modem-helpers-xmm.h"
+#include "mm-regex-registry.h"
 
 /*****************************************************************************/
 /* Private data context */
@@ -90,8 +91,8 @@ get_private (MMSharedXmm *self)
         priv->gps_engine_state = GPS_ENGINE_STATE_OFF;
 
         /* Setup regex for URCs */
-        priv->xlsrstop_regex = g_regex_new ("\\r\\n\\+XLSRSTOP:(.*)\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
-        priv->nmea_regex     = g_regex_new ("(?:\\r\\n)?(?:\\r\\n)?(\\$G.*)\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        priv->xlsrstop_regex = mm_regex_get ("\\r\\n\\+XLSRSTOP:(.*)\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
+        priv->nmea_regex     = mm_regex_get ("(?:\\r\\n)?(?:\\r\\n)?(\\$G.*)\\r\\n", G_REGEX_RAW | G_REGEX_OPTIMIZE);
 
         /* Setup parent class' MMBroadbandModemClass */
         g_assert (MM_SHARED_XMM_GET_INTERFACE (self)->peek_parent_broadband_modem_class);
@@ -1068,7 +1069,7 @@ gps_engine_start (GTask *task)
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    priv->gps_port,
                                    cmd,
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -1127,7 +1128,7 @@ gps_engine_stop (GTask *task)
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    priv->gps_port,
                                    "+XLSRSTOP",
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -1521,7 +1522,7 @@ mm_shared_xmm_setup_ports (MMBroadbandModem *self)
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        ports[i],
                                        "+XLSRSTOP",
-                                       3, FALSE, FALSE, NULL, NULL, NULL);
+                                       3000, FALSE, FALSE, NULL, NULL, NULL);
     }
 }
 
@@ -31,6 +31,7 @@
 #include "mm-iface-modem-3gpp.h"
 #include "mm-common-zte.h"
 #include "mm-broadband-modem-zte.h"
+#include "mm-regex-registry.h"
 
 static void iface_modem_init (MMIfaceModem *iface);
 static void iface_modem_3gpp_init (MMIfaceModem3gpp *iface);
@@ -343,11 +344,11 @@ load_current_modes_finish (MMIfaceModem *self,
     if (!response)
         return FALSE;
 
-    r = g_regex_new ("\\+ZSNT:\\s*(\\d),(\\d),(\\d)", G_REGEX_UNGREEDY, 0, error);
+    r = mm_regex_get ("\\+ZSNT:\\s*(\\d),(\\d),(\\d)", G_REGEX_UNGREEDY);
     g_assert (r != NULL);
 
     result = FALSE;
-    if (!g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &match_error)) {
+    if (!mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &match_error)) {
         if (match_error)
             g_propagate_error (error, match_error);
         else
@@ -20,6 +20,7 @@
 #include "mm-iface-modem.h"
 #include "mm-iface-modem-3gpp.h"
 #include "mm-common-zte.h"
+#include "mm-regex-registry.h"
 
 struct _MMCommonZteUnsolicitedSetup {
     /* Regex for access-technology related notifications */
@@ -41,24 +42,24 @@ mm_common_zte_unsolicited_setup_new (void)
 
     /* Prepare regular expressions to setup */
 
-    setup->zusimr_regex = g_regex_new ("\\r\\n\\+ZUSIMR:(.*)\\r\\n",
-                                       G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    setup->zusimr_regex = mm_regex_get ("\\r\\n\\+ZUSIMR:(.*)\\r\\n",
+                                        G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (setup->zusimr_regex != NULL);
 
-    setup->zdonr_regex = g_regex_new ("\\r\\n\\+ZDONR: (.*)\\r\\n",
-                                      G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    setup->zdonr_regex = mm_regex_get ("\\r\\n\\+ZDONR: (.*)\\r\\n",
+                                       G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (setup->zdonr_regex != NULL);
 
-    setup->zpasr_regex = g_regex_new ("\\r\\n\\+ZPASR:\\s*(.*)\\r\\n",
-                                      G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    setup->zpasr_regex = mm_regex_get ("\\r\\n\\+ZPASR:\\s*(.*)\\r\\n",
+                                       G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (setup->zpasr_regex != NULL);
 
-    setup->zpstm_regex = g_regex_new ("\\r\\n\\+ZPSTM: (.*)\\r\\n",
-                                      G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    setup->zpstm_regex = mm_regex_get ("\\r\\n\\+ZPSTM: (.*)\\r\\n",
+                                       G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (setup->zpstm_regex != NULL);
 
-    setup->zend_regex = g_regex_new ("\\r\\n\\+ZEND\\r\\n",
-                                     G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    setup->zend_regex = mm_regex_get ("\\r\\n\\+ZEND\\r\\n",
+                                      G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (setup->zend_regex != NULL);
 
     return setup;
@@ -19,6 +19,9 @@
 #include "config.h"
 
 #include <string.h>
+#include <errno.h>
+
+#include <glib/gstdio.h>
 
 #include <ModemManager.h>
 #define _LIBMM_INSIDE_MM
@@ -32,6 +35,10 @@ udev_rule_match_clear (MMUdevRuleMatch *rule_match)
 {
     g_free (rule_match->parameter);
     g_free (rule_match->value);
+    if (rule_match->regex)
+        g_regex_unref (rule_match->regex);
+    if (rule_match->prefix_regex)
+        g_regex_unref (rule_match->prefix_regex);
 }
 
 static void
@@ -115,6 +122,185 @@ out:
     return TRUE;
 }
 
+/*****************************************************************************/
+/* Rule precompilation */
+
+static const gchar *
+intern_braced_name (const gchar *str)
+{
+    g_autofree gchar *name = NULL;
+
+    name = g_strdup (str);
+    g_strdelimit (name, "{}", ' ');
+    g_strstrip (name);
+    return g_intern_string (name);
+}
+
+static MMUdevRuleAttribute
+compile_attribute (const gchar *name)
+{
+    static const struct {
+        const gchar         *name;
+        MMUdevRuleAttribute  attribute;
+    } attributes[] = {
+        { "idVendor",           MM_UDEV_RULE_ATTRIBUTE_VENDOR             },
+        { "vendor",             MM_UDEV_RULE_ATTRIBUTE_VENDOR             },
+        { "idProduct",          MM_UDEV_RULE_ATTRIBUTE_PRODUCT            },
+        { "device",             MM_UDEV_RULE_ATTRIBUTE_PRODUCT            },
+        { "manufacturer",       MM_UDEV_RULE_ATTRIBUTE_MANUFACTURER_NAME  },
+        { "product",            MM_UDEV_RULE_ATTRIBUTE_PRODUCT_NAME       },
+        { "bInterfaceClass",    MM_UDEV_RULE_ATTRIBUTE_INTERFACE_CLASS    },
+        { "bInterfaceSubClass", MM_UDEV_RULE_ATTRIBUTE_INTERFACE_SUBCLASS },
+        { "bInterfaceProtocol", MM_UDEV_RULE_ATTRIBUTE_INTERFACE_PROTOCOL },
+        { "bInterfaceNumber",   MM_UDEV_RULE_ATTRIBUTE_INTERFACE_NUMBER   },
+    };
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (attributes); i++) {
+        if (g_str_equal (name, attributes[i].name))
+            return attributes[i].attribute;
+    }
+    return MM_UDEV_RULE_ATTRIBUTE_OTHER;
+}
+
+static GRegex *
+compile_pattern (const gchar *pattern)
+{
+    g_autoptr(GError)  inner_error = NULL;
+    GRegex            *regex;
+
+    /* Invalid patterns never match, as if the rule didn't apply */
+    regex = g_regex_new (pattern, G_REGEX_OPTIMIZE, 0, &inner_error);
+    if (!regex)
+        mm_warn ("invalid pattern in rule '%s': %s", pattern, inner_error->message);
+    return regex;
+}
+
+static void
+compile_rule_match (MMUdevRuleMatch *rule_match)
+{
+    static const struct {
+        const gchar              *name;
+        MMUdevRuleMatchParameter  parameter;
+    } parameters[] = {
+        { "ACTION",     MM_UDEV_RULE_MATCH_PARAMETER_ACTION     },
+        { "SUBSYSTEM",  MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEM  },
+        { "SUBSYSTEMS", MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEMS },
+        { "DRIVER",     MM_UDEV_RULE_MATCH_PARAMETER_DRIVER     },
+        { "DRIVERS",    MM_UDEV_RULE_MATCH_PARAMETER_DRIVERS    },
+        { "KERNEL",     MM_UDEV_RULE_MATCH_PARAMETER_KERNEL     },
+        { "DEVPATH",    MM_UDEV_RULE_MATCH_PARAMETER_DEVPATH    },
+    };
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (parameters); i++) {
+        if (g_str_equal (rule_match->parameter, parameters[i].name)) {
+            rule_match->compiled_parameter = parameters[i].parameter;
+            break;
+        }
+    }
+
+    if (rule_match->compiled_parameter == MM_UDEV_RULE_MATCH_PARAMETER_UNKNOWN) {
+        if (g_str_has_prefix (rule_match->parameter, "ATTRS")) {
+            rule_match->compiled_parameter = MM_UDEV_RULE_MATCH_PARAMETER_ATTRS;
+            rule_match->name = intern_braced_name (&rule_match->parameter[5]);
+            rule_match->attribute = compile_attribute (rule_match->name);
+        } else if (g_str_has_prefix (rule_match->parameter, "ENV")) {
+            rule_match->compiled_parameter = MM_UDEV_RULE_MATCH_PARAMETER_ENV;
+            rule_match->name = intern_braced_name (&rule_match->parameter[3]);
+            rule_match->name_quark = g_quark_from_static_string (rule_match->name);
+        }
+    }
+
+    switch (rule_match->compiled_parameter) {
+    case MM_UDEV_RULE_MATCH_PARAMETER_ACTION:
+        rule_match->value_add = !!strstr (rule_match->value, "add");
+        break;
+    case MM_UDEV_RULE_MATCH_PARAMETER_ATTRS:
+        rule_match->value_any = g_str_equal (rule_match->value, "?*");
+        rule_match->value_uint_valid = mm_get_uint_from_hex_str (rule_match->value, &rule_match->value_uint);
+        break;
+    case MM_UDEV_RULE_MATCH_PARAMETER_KERNEL:
+    case MM_UDEV_RULE_MATCH_PARAMETER_DEVPATH:
+        /* Patterns compiled when first needed */
+    case MM_UDEV_RULE_MATCH_PARAMETER_UNKNOWN:
+    case MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEM:
+    case MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEMS:
+    case MM_UDEV_RULE_MATCH_PARAMETER_DRIVER:
+    case MM_UDEV_RULE_MATCH_PARAMETER_DRIVERS:
+    case MM_UDEV_RULE_MATCH_PARAMETER_ENV:
+    default:
+        break;
+    }
+}
+
+void
+mm_kernel_device_generic_rules_match_compile_patterns (MMUdevRuleMatch *rule_match)
+{
+    if (rule_match->patterns_compiled)
+        return;
+    rule_match->patterns_compiled = TRUE;
+
+    switch (rule_match->compiled_parameter) {
+    case MM_UDEV_RULE_MATCH_PARAMETER_KERNEL:
+        rule_match->regex = compile_pattern (rule_match->value);
+        break;
+    case MM_UDEV_RULE_MATCH_PARAMETER_DEVPATH:
+        rule_match->regex = compile_pattern (rule_match->value);
+        /* If not already doing a prefix match, do an implicit one. This is so that
+         * we can add properties to the usb_device owning all ports, and then apply
+         * the property to all ports individually processed. */
+        if (rule_match->value[0] && rule_match->value[strlen (rule_match->value) - 1] != '*') {
+            g_autofree gchar *prefix_pattern = NULL;
+
+            prefix_pattern = g_strdup_printf ("%s/*", rule_match->value);
+            rule_match->prefix_regex = compile_pattern (prefix_pattern);
+        }
+        break;
+    case MM_UDEV_RULE_MATCH_PARAMETER_UNKNOWN:
+    case MM_UDEV_RULE_MATCH_PARAMETER_ACTION:
+    case MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEM:
+    case MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEMS:
+    case MM_UDEV_RULE_MATCH_PARAMETER_DRIVER:
+    case MM_UDEV_RULE_MATCH_PARAMETER_DRIVERS:
+    case MM_UDEV_RULE_MATCH_PARAMETER_ATTRS:
+    case MM_UDEV_RULE_MATCH_PARAMETER_ENV:
+    default:
+        break;
+    }
+}
+
+static void
+compile_rule_result_property (MMUdevRuleResultProperty *property)
+{
+    property->name_quark = g_quark_from_string (property->name);
+
+    if (g_str_has_prefix (property->value, "$attr{") && g_str_has_suffix (property->value, "}")) {
+        const gchar *name;
+
+        name = intern_braced_name (&property->value[5]);
+        property->value_attribute = compile_attribute (name);
+        /* Only the interface attributes are expanded */
+        switch (property->value_attribute) {
+        case MM_UDEV_RULE_ATTRIBUTE_INTERFACE_CLASS:
+        case MM_UDEV_RULE_ATTRIBUTE_INTERFACE_SUBCLASS:
+        case MM_UDEV_RULE_ATTRIBUTE_INTERFACE_PROTOCOL:
+        case MM_UDEV_RULE_ATTRIBUTE_INTERFACE_NUMBER:
+            break;
+        case MM_UDEV_RULE_ATTRIBUTE_OTHER:
+        case MM_UDEV_RULE_ATTRIBUTE_VENDOR:
+        case MM_UDEV_RULE_ATTRIBUTE_PRODUCT:
+        case MM_UDEV_RULE_ATTRIBUTE_MANUFACTURER_NAME:
+        case MM_UDEV_RULE_ATTRIBUTE_PRODUCT_NAME:
+        default:
+            property->value_attribute = MM_UDEV_RULE_ATTRIBUTE_OTHER;
+            break;
+        }
+    }
+}
+
+/*****************************************************************************/
+
 static gboolean
 load_rule_result (MMUdevRuleResult  *rule_result,
                   const gchar       *item,
@@ -155,6 +341,7 @@ load_rule_result (MMUdevRuleResult  *rule_result,
         rule_result->content.property.name = g_strndup (left + 4, left_len - 5);
         rule_result->content.property.value = right;
         right = NULL;
+        compile_rule_result_property (&rule_result->content.property);
         goto out;
     }
 
@@ -203,6 +390,7 @@ load_rule_match (MMUdevRuleMatch  *rule_match,
     g_free (operator);
     rule_match->parameter = left;
     rule_match->value     = right;
+    compile_rule_match (rule_match);
     return TRUE;
 }
 
@@ -397,19 +585,18 @@ list_rule_files (const gchar *rules_dir_path)
     return g_list_sort (children, (GCompareFunc) g_strcmp0);
 }
 
-GArray *
-mm_kernel_device_generic_rules_load (const gchar  *rules_dir,
-                                     GError      **error)
+static GArray *
+load_rules_from_files (const gchar  *rules_dir,
+                       GList        *rule_files,
+                       GError      **error)
 {
-    GList  *rule_files, *l;
+    GList  *l;
     GArray *rules;
     GError *inner_error = NULL;
 
     rules = g_array_new (FALSE, FALSE, sizeof (MMUdevRule));
     g_array_set_clear_func (rules, (GDestroyNotify) udev_rule_clear);
 
-    /* List rule files in rules dir */
-    rule_files = list_rule_files (rules_dir);
     if (!rule_files) {
         inner_error = g_error_new (MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
                                    "No rule files found in '%s'", rules_dir);
@@ -429,9 +616,6 @@ mm_kernel_device_generic_rules_load (const gchar  *rules_dir,
     }
 
 out:
-    if (rule_files)
-        g_list_free_full (rule_files, g_free);
-
     if (inner_error) {
         g_propagate_error (error, inner_error);
         g_array_unref (rules);
@@ -440,3 +624,303 @@ out:
 
     return rules;
 }
+
+GArray *
+mm_kernel_device_generic_rules_load (const gchar  *rules_dir,
+                                     GError      **error)
+{
+    GList  *rule_files;
+    GArray *rules;
+
+    /* List rule files in rules dir */
+    rule_files = list_rule_files (rules_dir);
+    rules = load_rules_from_files (rules_dir, rule_files, error);
+    g_list_free_full (rule_files, g_free);
+    return rules;
+}
+
+/*****************************************************************************/
+/* Rules cache
+ *
+ * The cache is a serialized GVariant with the list of rule files it was built
+ * from (path, modification time and size of each one), and the list of parsed
+ * rules, with all GOTO tags already resolved to rule indices:
+ *   - rule conditions: array of (type, parameter, value)
+ *   - rule result: (type, name or tag, value, index)
+ */
+
+#define RULES_CACHE_VERSION 1
+#define RULES_CACHE_FORMAT  "(u@a(stt)a(a(yss)(yssu)))"
+
+static GVariant *
+rules_cache_build_file_stamps (GList *rule_files)
+{
+    GVariantBuilder  builder;
+    GList           *l;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(stt)"));
+    for (l = rule_files; l; l = g_list_next (l)) {
+        GStatBuf st;
+
+        /* Files that can't be checked won't be loaded either */
+        if (g_stat ((const gchar *)(l->data), &st) < 0) {
+            g_variant_builder_clear (&builder);
+            return NULL;
+        }
+        g_variant_builder_add (&builder, "(stt)",
+                               (const gchar *)(l->data),
+                               (guint64) st.st_mtime,
+                               (guint64) st.st_size);
+    }
+    return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
+static GVariant *
+rules_cache_build (GVariant *file_stamps,
+                   GArray   *rules)
+{
+    GVariantBuilder builder;
+    guint           i;
+
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(a(yss)(yssu))"));
+    for (i = 0; i < rules->len; i++) {
+        MMUdevRule      *rule;
+        GVariantBuilder  conditions;
+        const gchar     *first = "";
+        const gchar     *second = "";
+        guint            index = 0;
+
+        rule = &g_array_index (rules, MMUdevRule, i);
+
+        g_variant_builder_init (&conditions, G_VARIANT_TYPE ("a(yss)"));
+        if (rule->conditions) {
+            guint j;
+
+            for (j = 0; j < rule->conditions->len; j++) {
+                MMUdevRuleMatch *rule_match;
+
+                rule_match = &g_array_index (rule->conditions, MMUdevRuleMatch, j);
+                g_variant_builder_add (&conditions, "(yss)",
+                                       (guchar) rule_match->type,
+                                       rule_match->parameter,
+                                       rule_match->value);
+            }
+        }
+
+        switch (rule->result.type) {
+        case MM_UDEV_RULE_RESULT_TYPE_PROPERTY:
+            first = rule->result.content.property.name;
+            second = rule->result.content.property.value;
+            break;
+        case MM_UDEV_RULE_RESULT_TYPE_LABEL:
+            first = rule->result.content.tag;
+            break;
+        case MM_UDEV_RULE_RESULT_TYPE_GOTO_INDEX:
+            index = rule->result.content.index;
+            break;
+        case MM_UDEV_RULE_RESULT_TYPE_GOTO_TAG:
+        case MM_UDEV_RULE_RESULT_TYPE_UNKNOWN:
+        default:
+            g_assert_not_reached ();
+        }
+
+        g_variant_builder_add (&builder, "(a(yss)(yssu))",
+                               &conditions,
+                               (guchar) rule->result.type,
+                               first,
+                               second,
+                               index);
+    }
+
+    return g_variant_ref_sink (g_variant_new (RULES_CACHE_FORMAT,
+                                              RULES_CACHE_VERSION,
+                                              file_stamps,
+                                              &builder));
+}
+
+static gboolean
+rules_cache_parse_rule (MMUdevRule *rule,
+                        GVariant   *cached_rule,
+                        guint       rule_index,
+                        guint       n_rules)
+{
+    g_autoptr(GVariant)  conditions = NULL;
+    guchar               result_type;
+    const gchar         *first;
+    const gchar         *second;
+    guint                index;
+    gsize                n_conditions;
+
+    g_variant_get (cached_rule, "(@a(yss)(y&s&su))", &conditions, &result_type, &first, &second, &index);
+
+    n_conditions = g_variant_n_children (conditions);
+    if (n_conditions > 0) {
+        GVariantIter  iter;
+        guchar        type;
+        const gchar  *parameter;
+        const gchar  *value;
+
+        rule->conditions = g_array_sized_new (FALSE, FALSE, sizeof (MMUdevRuleMatch), n_conditions);
+        g_array_set_clear_func (rule->conditions, (GDestroyNotify) udev_rule_match_clear);
+
+        g_variant_iter_init (&iter, conditions);
+        while (g_variant_iter_next (&iter, "(y&s&s)", &type, &parameter, &value)) {
+            MMUdevRuleMatch rule_match = { 0 };
+
+            if ((type != MM_UDEV_RULE_MATCH_TYPE_EQUAL && type != MM_UDEV_RULE_MATCH_TYPE_NOT_EQUAL) ||
+                !parameter[0] || !value[0])
+                return FALSE;
+
+            rule_match.type = (MMUdevRuleMatchType) type;
+            rule_match.parameter = g_strdup (parameter);
+            rule_match.value = g_strdup (value);
+            compile_rule_match (&rule_match);
+            g_array_append_val (rule->conditions, rule_match);
+        }
+    }
+
+    switch (result_type) {
+    case MM_UDEV_RULE_RESULT_TYPE_PROPERTY:
+        if (!first[0] || !second[0])
+            return FALSE;
+        rule->result.type = MM_UDEV_RULE_RESULT_TYPE_PROPERTY;
+        rule->result.content.property.name = g_strdup (first);
+        rule->result.content.property.value = g_strdup (second);
+        compile_rule_result_property (&rule->result.content.property);
+        return TRUE;
+    case MM_UDEV_RULE_RESULT_TYPE_LABEL:
+        if (!first[0])
+            return FALSE;
+        rule->result.type = MM_UDEV_RULE_RESULT_TYPE_LABEL;
+        rule->result.content.tag = g_strdup (first);
+        return TRUE;
+    case MM_UDEV_RULE_RESULT_TYPE_GOTO_INDEX:
+        /* Labels are always found after the GOTO */
+        if (index <= rule_index || index >= n_rules)
+            return FALSE;
+        rule->result.type = MM_UDEV_RULE_RESULT_TYPE_GOTO_INDEX;
+        rule->result.content.index = index;
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+static GArray *
+rules_cache_parse (GVariant *cache,
+                   GVariant *file_stamps)
+{
+    g_autoptr(GVariant)  cached_file_stamps = NULL;
+    g_autoptr(GVariant)  cached_rules = NULL;
+    GArray              *rules;
+    guint32              version;
+    gsize                n_rules;
+    gsize                i;
+
+    g_variant_get (cache, RULES_CACHE_FORMAT, &version, &cached_file_stamps, NULL);
+    if (version != RULES_CACHE_VERSION) {
+        mm_dbg ("udev rules cache version mismatch");
+        return NULL;
+    }
+    if (!g_variant_equal (cached_file_stamps, file_stamps)) {
+        mm_dbg ("udev rules changed since the cache was built");
+        return NULL;
+    }
+
+    cached_rules = g_variant_get_child_value (cache, 2);
+    n_rules = g_variant_n_children (cached_rules);
+    if (!n_rules)
+        return NULL;
+
+    rules = g_array_sized_new (FALSE, FALSE, sizeof (MMUdevRule), n_rules);
+    g_array_set_clear_func (rules, (GDestroyNotify) udev_rule_clear);
+
+    for (i = 0; i < n_rules; i++) {
+        g_autoptr(GVariant) cached_rule = NULL;
+        MMUdevRule          rule = { 0 };
+
+        cached_rule = g_variant_get_child_value (cached_rules, i);
+        if (!rules_cache_parse_rule (&rule, cached_rule, i, n_rules)) {
+            mm_warn ("invalid rule %u found in udev rules cache", (guint) i);
+            udev_rule_clear (&rule);
+            g_array_unref (rules);
+            return NULL;
+        }
+        g_array_append_val (rules, rule);
+    }
+
+    return rules;
+}
+
+static GArray *
+rules_cache_load (const gchar *cache_file,
+                  GVariant    *file_stamps)
+{
+    g_autoptr(GMappedFile) mapped = NULL;
+    g_autoptr(GBytes)      bytes = NULL;
+    g_autoptr(GVariant)    cache = NULL;
+    g_autoptr(GError)      inner_error = NULL;
+
+    mapped = g_mapped_file_new (cache_file, FALSE, &inner_error);
+    if (!mapped) {
+        if (!g_error_matches (inner_error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+            mm_warn ("couldn't open udev rules cache: %s", inner_error->message);
+        return NULL;
+    }
+
+    /* Contents from disk are not trusted, the GVariant API takes care of
+     * returning defaults for anything not well-formed */
+    bytes = g_mapped_file_get_bytes (mapped);
+    cache = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (RULES_CACHE_FORMAT), bytes, FALSE));
+    return rules_cache_parse (cache, file_stamps);
+}
+
+static void
+rules_cache_save (const gchar *cache_file,
+                  GVariant    *file_stamps,
+                  GArray      *rules)
+{
+    g_autoptr(GVariant)  cache = NULL;
+    g_autoptr(GError)    inner_error = NULL;
+    g_autofree gchar    *cache_dir = NULL;
+
+    cache_dir = g_path_get_dirname (cache_file);
+    if (g_mkdir_with_parents (cache_dir, 0755) < 0) {
+        mm_warn ("couldn't create udev rules cache directory: %s", g_strerror (errno));
+        return;
+    }
+
+    cache = rules_cache_build (file_stamps, rules);
+    if (!g_file_set_contents (cache_file,
+                              g_variant_get_data (cache),
+                              g_variant_get_size (cache),
+                              &inner_error))
+        mm_warn ("couldn't save udev rules cache: %s", inner_error->message);
+}
+
+GArray *
+mm_kernel_device_generic_rules_load_cached (const gchar  *rules_dir,
+                                            const gchar  *cache_file,
+                                            GError      **error)
+{
+    g_autoptr(GVariant)  file_stamps = NULL;
+    GList               *rule_files;
+    GArray              *rules = NULL;
+
+    rule_files = list_rule_files (rules_dir);
+
+    file_stamps = rules_cache_build_file_stamps (rule_files);
+    if (file_stamps && rule_files)
+        rules = rules_cache_load (cache_file, file_stamps);
+
+    if (rules)
+        mm_dbg ("loaded %u udev rules from cache", rules->len);
+    else {
+        rules = load_rules_from_files (rules_dir, rule_files, error);
+        if (rules && file_stamps)
+            rules_cache_save (cache_file, file_stamps, rules);
+    }
+
+    g_list_free_full (rule_files, g_free);
+    return rules;
+}
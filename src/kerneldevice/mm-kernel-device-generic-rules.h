@@ -23,10 +23,57 @@ typedef enum {
     MM_UDEV_RULE_MATCH_TYPE_NOT_EQUAL,
 } MMUdevRuleMatchType;
 
+typedef enum {
+    MM_UDEV_RULE_MATCH_PARAMETER_UNKNOWN,
+    MM_UDEV_RULE_MATCH_PARAMETER_ACTION,
+    MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEM,
+    MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEMS,
+    MM_UDEV_RULE_MATCH_PARAMETER_DRIVER,
+    MM_UDEV_RULE_MATCH_PARAMETER_DRIVERS,
+    MM_UDEV_RULE_MATCH_PARAMETER_KERNEL,
+    MM_UDEV_RULE_MATCH_PARAMETER_DEVPATH,
+    MM_UDEV_RULE_MATCH_PARAMETER_ATTRS,
+    MM_UDEV_RULE_MATCH_PARAMETER_ENV,
+} MMUdevRuleMatchParameter;
+
+/* Attributes with a value already loaded in the kernel device object */
+typedef enum {
+    MM_UDEV_RULE_ATTRIBUTE_OTHER,
+    MM_UDEV_RULE_ATTRIBUTE_VENDOR,
+    MM_UDEV_RULE_ATTRIBUTE_PRODUCT,
+    MM_UDEV_RULE_ATTRIBUTE_MANUFACTURER_NAME,
+    MM_UDEV_RULE_ATTRIBUTE_PRODUCT_NAME,
+    MM_UDEV_RULE_ATTRIBUTE_INTERFACE_CLASS,
+    MM_UDEV_RULE_ATTRIBUTE_INTERFACE_SUBCLASS,
+    MM_UDEV_RULE_ATTRIBUTE_INTERFACE_PROTOCOL,
+    MM_UDEV_RULE_ATTRIBUTE_INTERFACE_NUMBER,
+} MMUdevRuleAttribute;
+
 typedef struct {
     MMUdevRuleMatchType  type;
     gchar               *parameter;
     gchar               *value;
+
+    /* Precompiled when loading the rules, so that matching doesn't need
+     * any parsing */
+    MMUdevRuleMatchParameter  compiled_parameter;
+    /* ATTRS and ENV name, interned */
+    const gchar              *name;
+    GQuark                    name_quark;
+    MMUdevRuleAttribute       attribute;
+    /* Value given as "?*", matching anything */
+    gboolean                  value_any;
+    /* Value given as hex number, for numeric attributes */
+    gboolean                  value_uint_valid;
+    guint                     value_uint;
+    /* ACTION value including "add" */
+    gboolean                  value_add;
+    /* KERNEL and DEVPATH patterns, plus the implicit DEVPATH prefix pattern.
+     * Only compiled when first needed, as most rules never get to be applied,
+     * see mm_kernel_device_generic_rules_match_compile_patterns() */
+    gboolean                  patterns_compiled;
+    GRegex                   *regex;
+    GRegex                   *prefix_regex;
 } MMUdevRuleMatch;
 
 typedef enum {
@@ -40,6 +87,11 @@ typedef enum {
 typedef struct {
     gchar *name;
     gchar *value;
+
+    /* Precompiled when loading the rules */
+    GQuark              name_quark;
+    /* Value given as an attribute of the device, e.g. "$attr{bInterfaceNumber}" */
+    MMUdevRuleAttribute value_attribute;
 } MMUdevRuleResultProperty;
 
 typedef struct {
@@ -56,7 +108,18 @@ typedef struct {
     MMUdevRuleResult  result;
 } MMUdevRule;
 
-GArray *mm_kernel_device_generic_rules_load (const gchar  *rules_dir,
-                                             GError      **error);
+GArray *mm_kernel_device_generic_rules_load        (const gchar  *rules_dir,
+                                                    GError      **error);
+
+/* Same as mm_kernel_device_generic_rules_load(), but reusing the rules parsed
+ * in a previous run, as long as none of the rule files changed. The cache
+ * file is rebuilt whenever it can't be used. */
+GArray *mm_kernel_device_generic_rules_load_cached (const gchar  *rules_dir,
+                                                    const gchar  *cache_file,
+                                                    GError      **error);
+
+/* Compiles the KERNEL and DEVPATH patterns of the rule match, if not
+ * already done. Invalid patterns are reported once, and never match. */
+void    mm_kernel_device_generic_rules_match_compile_patterns (MMUdevRuleMatch *rule_match);
 
 G_END_DECLS
@@ -668,30 +668,98 @@ kernel_device_cmp (MMKernelDevice *a,
 static gboolean
 string_match (MMKernelDeviceGeneric *self,
               const gchar           *str,
-              const gchar           *pattern)
+              GRegex                *regex)
 {
     g_autoptr(GError)     inner_error = NULL;
-    g_autoptr(GRegex)     regex = NULL;
     g_autoptr(GMatchInfo) match_info = NULL;
 
-    regex = g_regex_new (pattern, 0, 0, &inner_error);
-    if (!regex) {
-        mm_obj_warn (self, "invalid pattern in rule '%s': %s", pattern, inner_error->message);
+    /* Invalid patterns were already reported when compiling them */
+    if (!regex)
         return FALSE;
-    }
+
     g_regex_match_full (regex, str, -1, 0, 0, &match_info, &inner_error);
     if (inner_error) {
-        mm_obj_warn (self, "couldn't apply pattern match in rule '%s': %s", pattern, inner_error->message);
+        mm_obj_warn (self, "couldn't apply pattern match in rule '%s': %s",
+                     g_regex_get_pattern (regex), inner_error->message);
         return FALSE;
     }
 
     if (!g_match_info_matches (match_info))
         return FALSE;
 
-    mm_obj_dbg (self, "pattern '%s' matched: '%s'", pattern, str);
+    mm_obj_dbg (self, "pattern '%s' matched: '%s'", g_regex_get_pattern (regex), str);
     return TRUE;
 }
 
+static gboolean
+check_devpath_condition (MMKernelDeviceGeneric *self,
+                         MMUdevRuleMatch       *match,
+                         gboolean               condition_equal)
+{
+    /* If sysfs path invalid (e.g. path doesn't exist), no match */
+    if (!self->priv->sysfs_path)
+        return FALSE;
+
+    /* We allow both a direct match and a prefix match */
+    if (string_match (self, self->priv->sysfs_path, match->regex) == condition_equal)
+        return TRUE;
+    if (match->prefix_regex && string_match (self, self->priv->sysfs_path, match->prefix_regex) == condition_equal)
+        return TRUE;
+
+    if (g_str_has_prefix (self->priv->sysfs_path, "/sys")) {
+        if (string_match (self, &self->priv->sysfs_path[4], match->regex) == condition_equal)
+            return TRUE;
+        if (match->prefix_regex && string_match (self, &self->priv->sysfs_path[4], match->prefix_regex) == condition_equal)
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+static gboolean
+check_uint_attribute_condition (MMUdevRuleMatch *match,
+                                guint            value,
+                                gboolean         condition_equal)
+{
+    return (match->value_uint_valid && ((value == match->value_uint) == condition_equal));
+}
+
+static gboolean
+check_attrs_condition (MMKernelDeviceGeneric *self,
+                       MMUdevRuleMatch       *match,
+                       gboolean               condition_equal)
+{
+    switch (match->attribute) {
+    /* VID/PID directly from our API */
+    case MM_UDEV_RULE_ATTRIBUTE_VENDOR:
+        return check_uint_attribute_condition (match, mm_kernel_device_get_physdev_vid (MM_KERNEL_DEVICE (self)), condition_equal);
+    case MM_UDEV_RULE_ATTRIBUTE_PRODUCT:
+        return check_uint_attribute_condition (match, mm_kernel_device_get_physdev_pid (MM_KERNEL_DEVICE (self)), condition_equal);
+    /* manufacturer in the physdev */
+    case MM_UDEV_RULE_ATTRIBUTE_MANUFACTURER_NAME:
+        return ((self->priv->physdev_manufacturer && g_str_equal (self->priv->physdev_manufacturer, match->value)) == condition_equal);
+    /* product in the physdev */
+    case MM_UDEV_RULE_ATTRIBUTE_PRODUCT_NAME:
+        return ((self->priv->physdev_product && g_str_equal (self->priv->physdev_product, match->value)) == condition_equal);
+    /* interface class/subclass/protocol/number in the interface */
+    case MM_UDEV_RULE_ATTRIBUTE_INTERFACE_CLASS:
+        return (match->value_any || check_uint_attribute_condition (match, self->priv->interface_class, condition_equal));
+    case MM_UDEV_RULE_ATTRIBUTE_INTERFACE_SUBCLASS:
+        return (match->value_any || check_uint_attribute_condition (match, self->priv->interface_subclass, condition_equal));
+    case MM_UDEV_RULE_ATTRIBUTE_INTERFACE_PROTOCOL:
+        return (match->value_any || check_uint_attribute_condition (match, self->priv->interface_protocol, condition_equal));
+    case MM_UDEV_RULE_ATTRIBUTE_INTERFACE_NUMBER:
+        return (match->value_any || check_uint_attribute_condition (match, self->priv->interface_number, condition_equal));
+    case MM_UDEV_RULE_ATTRIBUTE_OTHER:
+    default: {
+        g_autofree gchar *found_value = NULL;
+
+        found_value = lookup_sysfs_attribute_as_string (self, match->name);
+        return ((found_value && g_str_equal (found_value, match->value)) == condition_equal);
+    }
+    }
+}
+
 static gboolean
 check_condition (MMKernelDeviceGeneric *self,
                  MMUdevRuleMatch       *match)
@@ -700,136 +768,73 @@ check_condition (MMKernelDeviceGeneric *self,
 
     condition_equal = (match->type == MM_UDEV_RULE_MATCH_TYPE_EQUAL);
 
+    switch (match->compiled_parameter) {
     /* We only apply 'add' rules */
-    if (g_str_equal (match->parameter, "ACTION"))
-        return ((!!strstr (match->value, "add")) == condition_equal);
+    case MM_UDEV_RULE_MATCH_PARAMETER_ACTION:
+        return (match->value_add == condition_equal);
 
     /* Exact SUBSYSTEM match */
-    if (g_str_equal (match->parameter, "SUBSYSTEM"))
+    case MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEM:
         return ((self->priv->subsystems && !g_strcmp0 (self->priv->subsystems[0], match->value)) == condition_equal);
 
     /* Loose SUBSYSTEMS match */
-    if (g_str_equal (match->parameter, "SUBSYSTEMS"))
+    case MM_UDEV_RULE_MATCH_PARAMETER_SUBSYSTEMS:
         return ((self->priv->subsystems && g_strv_contains ((const gchar * const *) self->priv->subsystems, match->value)) == condition_equal);
 
     /* Exact DRIVER match */
-    if (g_str_equal (match->parameter, "DRIVER"))
+    case MM_UDEV_RULE_MATCH_PARAMETER_DRIVER:
         return ((self->priv->drivers && !g_strcmp0 (self->priv->drivers[0], match->value)) == condition_equal);
 
     /* Loose DRIVERS match */
-    if (g_str_equal (match->parameter, "DRIVERS"))
+    case MM_UDEV_RULE_MATCH_PARAMETER_DRIVERS:
         return ((self->priv->drivers && g_strv_contains ((const gchar * const *) self->priv->drivers, match->value)) == condition_equal);
 
     /* Device name checks */
-    if (g_str_equal (match->parameter, "KERNEL"))
-        return (string_match (self, mm_kernel_device_get_name (MM_KERNEL_DEVICE (self)), match->value) == condition_equal);
-
-    /* Device sysfs path checks; we allow both a direct match and a prefix patch */
-    if (g_str_equal (match->parameter, "DEVPATH")) {
-        gchar    *prefix_match = NULL;
-        gboolean  result = FALSE;
-
-        /* If sysfs path invalid (e.g. path doesn't exist), no match */
-        if (!self->priv->sysfs_path)
-            return FALSE;
-
-        /* If not already doing a prefix match, do an implicit one. This is so that
-         * we can add properties to the usb_device owning all ports, and then apply
-         * the property to all ports individually processed here. */
-        if (match->value[0] && match->value[strlen (match->value) - 1] != '*')
-            prefix_match = g_strdup_printf ("%s/*", match->value);
-
-        if (string_match (self, self->priv->sysfs_path, match->value) == condition_equal) {
-            result = TRUE;
-            goto out;
-        }
-
-        if (prefix_match && string_match (self, self->priv->sysfs_path, prefix_match) == condition_equal) {
-            result = TRUE;
-            goto out;
-        }
+    case MM_UDEV_RULE_MATCH_PARAMETER_KERNEL:
+        mm_kernel_device_generic_rules_match_compile_patterns (match);
+        return (string_match (self, mm_kernel_device_get_name (MM_KERNEL_DEVICE (self)), match->regex) == condition_equal);
 
-        if (g_str_has_prefix (self->priv->sysfs_path, "/sys")) {
-            if (string_match (self, &self->priv->sysfs_path[4], match->value) == condition_equal) {
-                result = TRUE;
-                goto out;
-            }
-            if (prefix_match && string_match (self, &self->priv->sysfs_path[4], prefix_match) == condition_equal) {
-                result = TRUE;
-                goto out;
-            }
-        }
-    out:
-        g_free (prefix_match);
-        return result;
-    }
+    /* Device sysfs path checks */
+    case MM_UDEV_RULE_MATCH_PARAMETER_DEVPATH:
+        mm_kernel_device_generic_rules_match_compile_patterns (match);
+        return check_devpath_condition (self, match, condition_equal);
 
     /* Attributes checks */
-    if (g_str_has_prefix (match->parameter, "ATTRS")) {
-        gchar    *attribute;
-        gchar    *contents = NULL;
-        gboolean  result = FALSE;
-        guint     val;
-
-        attribute = g_strdup (&match->parameter[5]);
-        g_strdelimit (attribute, "{}", ' ');
-        g_strstrip (attribute);
-
-        /* VID/PID directly from our API */
-        if (g_str_equal (attribute, "idVendor") || g_str_equal (attribute, "vendor"))
-            result = ((mm_get_uint_from_hex_str (match->value, &val)) &&
-                      ((mm_kernel_device_get_physdev_vid (MM_KERNEL_DEVICE (self)) == val) == condition_equal));
-        else if (g_str_equal (attribute, "idProduct") || g_str_equal (attribute, "device"))
-            result = ((mm_get_uint_from_hex_str (match->value, &val)) &&
-                      ((mm_kernel_device_get_physdev_pid (MM_KERNEL_DEVICE (self)) == val) == condition_equal));
-        /* manufacturer in the physdev */
-        else if (g_str_equal (attribute, "manufacturer"))
-            result = ((self->priv->physdev_manufacturer && g_str_equal (self->priv->physdev_manufacturer, match->value)) == condition_equal);
-        /* product in the physdev */
-        else if (g_str_equal (attribute, "product"))
-            result = ((self->priv->physdev_product && g_str_equal (self->priv->physdev_product, match->value)) == condition_equal);
-        /* interface class/subclass/protocol/number in the interface */
-        else if (g_str_equal (attribute, "bInterfaceClass"))
-            result = (g_str_equal (match->value, "?*") || ((mm_get_uint_from_hex_str (match->value, &val)) &&
-                                                           ((self->priv->interface_class == val) == condition_equal)));
-        else if (g_str_equal (attribute, "bInterfaceSubClass"))
-            result = (g_str_equal (match->value, "?*") || ((mm_get_uint_from_hex_str (match->value, &val)) &&
-                                                           ((self->priv->interface_subclass == val) == condition_equal)));
-        else if (g_str_equal (attribute, "bInterfaceProtocol"))
-            result = (g_str_equal (match->value, "?*") || ((mm_get_uint_from_hex_str (match->value, &val)) &&
-                                                           ((self->priv->interface_protocol == val) == condition_equal)));
-        else if (g_str_equal (attribute, "bInterfaceNumber"))
-            result = (g_str_equal (match->value, "?*") || ((mm_get_uint_from_hex_str (match->value, &val)) &&
-                                                           ((self->priv->interface_number == val) == condition_equal)));
-        else {
-            g_autofree gchar *found_value = NULL;
-
-            found_value = lookup_sysfs_attribute_as_string (self, attribute);
-            result = ((found_value && g_str_equal (found_value, match->value)) == condition_equal);
-        }
-
-        g_free (contents);
-        g_free (attribute);
-        return result;
-    }
+    case MM_UDEV_RULE_MATCH_PARAMETER_ATTRS:
+        return check_attrs_condition (self, match, condition_equal);
 
     /* Previously set property checks */
-    if (g_str_has_prefix (match->parameter, "ENV")) {
-        gchar    *property;
-        gboolean  result = FALSE;
-
-        property = g_strdup (&match->parameter[3]);
-        g_strdelimit (property, "{}", ' ');
-        g_strstrip (property);
+    case MM_UDEV_RULE_MATCH_PARAMETER_ENV:
+        return ((!g_strcmp0 ((const gchar *) g_object_get_qdata (G_OBJECT (self), match->name_quark), match->value)) == condition_equal);
 
-        result = ((!g_strcmp0 ((const gchar *) g_object_get_data (G_OBJECT (self), property), match->value)) == condition_equal);
-
-        g_free (property);
-        return result;
+    case MM_UDEV_RULE_MATCH_PARAMETER_UNKNOWN:
+    default:
+        mm_obj_warn (self, "unknown match condition parameter: %s", match->parameter);
+        return FALSE;
     }
+}
 
-    mm_obj_warn (self, "unknown match condition parameter: %s", match->parameter);
-    return FALSE;
+static gchar *
+build_property_attribute_value (MMKernelDeviceGeneric *self,
+                                MMUdevRuleAttribute    attribute)
+{
+    switch (attribute) {
+    case MM_UDEV_RULE_ATTRIBUTE_INTERFACE_CLASS:
+        return g_strdup_printf ("%02x", self->priv->interface_class);
+    case MM_UDEV_RULE_ATTRIBUTE_INTERFACE_SUBCLASS:
+        return g_strdup_printf ("%02x", self->priv->interface_subclass);
+    case MM_UDEV_RULE_ATTRIBUTE_INTERFACE_PROTOCOL:
+        return g_strdup_printf ("%02x", self->priv->interface_protocol);
+    case MM_UDEV_RULE_ATTRIBUTE_INTERFACE_NUMBER:
+        return g_strdup_printf ("%02x", self->priv->interface_number);
+    case MM_UDEV_RULE_ATTRIBUTE_OTHER:
+    case MM_UDEV_RULE_ATTRIBUTE_VENDOR:
+    case MM_UDEV_RULE_ATTRIBUTE_PRODUCT:
+    case MM_UDEV_RULE_ATTRIBUTE_MANUFACTURER_NAME:
+    case MM_UDEV_RULE_ATTRIBUTE_PRODUCT_NAME:
+    default:
+        return NULL;
+    }
 }
 
 static guint
@@ -859,34 +864,29 @@ check_rule (MMKernelDeviceGeneric *self,
     if (apply) {
         switch (rule->result.type) {
         case MM_UDEV_RULE_RESULT_TYPE_PROPERTY: {
-            gchar *property_value_read = NULL;
+            MMUdevRuleResultProperty *property;
+            gchar                    *property_value_read;
 
-            if (g_str_equal (rule->result.content.property.value, "$attr{bInterfaceClass}"))
-                property_value_read = g_strdup_printf ("%02x", self->priv->interface_class);
-            else if (g_str_equal (rule->result.content.property.value, "$attr{bInterfaceSubClass}"))
-                property_value_read = g_strdup_printf ("%02x", self->priv->interface_subclass);
-            else if (g_str_equal (rule->result.content.property.value, "$attr{bInterfaceProtocol}"))
-                property_value_read = g_strdup_printf ("%02x", self->priv->interface_protocol);
-            else if (g_str_equal (rule->result.content.property.value, "$attr{bInterfaceNumber}"))
-                property_value_read = g_strdup_printf ("%02x", self->priv->interface_number);
+            property = &rule->result.content.property;
+            property_value_read = build_property_attribute_value (self, property->value_attribute);
 
             /* add new property */
             mm_obj_dbg (self, "property added: %s=%s",
-                        rule->result.content.property.name,
-                        property_value_read ? property_value_read : rule->result.content.property.value);
+                        property->name,
+                        property_value_read ? property_value_read : property->value);
 
             if (!property_value_read)
                 /* NOTE: we keep a reference to the list of rules ourselves, so it isn't
                  * an issue if we re-use the same string (i.e. without g_strdup-ing it)
                  * as a property value. */
-                g_object_set_data (G_OBJECT (self),
-                                   rule->result.content.property.name,
-                                   rule->result.content.property.value);
+                g_object_set_qdata (G_OBJECT (self),
+                                    property->name_quark,
+                                    property->value);
             else
-                g_object_set_data_full (G_OBJECT (self),
-                                        rule->result.content.property.name,
-                                        property_value_read,
-                                        g_free);
+                g_object_set_qdata_full (G_OBJECT (self),
+                                         property->name_quark,
+                                         property_value_read,
+                                         g_free);
             break;
         }
 
@@ -1013,6 +1013,15 @@ mm_kernel_device_generic_new_with_rules (MMKernelEventProperties  *props,
                                              NULL));
 }
 
+static gchar *rules_cache_file;
+
+void
+mm_kernel_device_generic_set_rules_cache_file (const gchar *cache_file)
+{
+    g_free (rules_cache_file);
+    rules_cache_file = g_strdup (cache_file);
+}
+
 MMKernelDevice *
 mm_kernel_device_generic_new (MMKernelEventProperties  *props,
                               GError                  **error)
@@ -1021,7 +1030,10 @@ mm_kernel_device_generic_new (MMKernelEventProperties  *props,
 
     /* We only try to load the default list of rules once */
     if (G_UNLIKELY (!rules)) {
-        rules = mm_kernel_device_generic_rules_load (UDEVRULESDIR, error);
+        if (rules_cache_file)
+            rules = mm_kernel_device_generic_rules_load_cached (UDEVRULESDIR, rules_cache_file, error);
+        else
+            rules = mm_kernel_device_generic_rules_load (UDEVRULESDIR, error);
         if (!rules)
             return NULL;
     }
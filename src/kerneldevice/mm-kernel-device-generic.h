@@ -49,6 +49,8 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC (MMKernelDeviceGeneric, g_object_unref)
 
 MMKernelDevice *mm_kernel_device_generic_new            (MMKernelEventProperties  *properties,
                                                          GError                  **error);
+/* Cache of the default rules parsed, to be set before creating any device */
+void            mm_kernel_device_generic_set_rules_cache_file (const gchar *cache_file);
 MMKernelDevice *mm_kernel_device_generic_new_with_rules (MMKernelEventProperties  *properties,
                                                          GArray                   *rules,
                                                          GError                  **error);
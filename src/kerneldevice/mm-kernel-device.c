@@ -331,6 +331,162 @@ mm_kernel_device_get_attribute_as_int_hex (MMKernelDevice *self,
     return ((value && mm_get_uint_from_hex_str (value, &aux)) ? aux : 0);
 }
 
+/*****************************************************************************/
+/* USB port enumeration */
+
+static gboolean
+read_sysfs_uint (const gchar *path,
+                 const gchar *attribute,
+                 guint        base,
+                 guint       *value)
+{
+    g_autofree gchar *filepath = NULL;
+    g_autofree gchar *contents = NULL;
+    gchar            *end = NULL;
+    guint64           aux;
+
+    filepath = g_build_filename (path, attribute, NULL);
+    if (!g_file_get_contents (filepath, &contents, NULL, NULL))
+        return FALSE;
+    g_strstrip (contents);
+    if (!contents[0])
+        return FALSE;
+
+    aux = g_ascii_strtoull (contents, &end, base);
+    if ((end && *end) || aux > G_MAXUINT)
+        return FALSE;
+    *value = (guint) aux;
+    return TRUE;
+}
+
+static void
+add_class_port_names (const gchar *path,
+                      const gchar *class_name,
+                      GPtrArray   *names)
+{
+    g_autofree gchar *class_path = NULL;
+    GDir             *dir;
+    const gchar      *name;
+
+    class_path = g_build_filename (path, class_name, NULL);
+    dir = g_dir_open (class_path, 0, NULL);
+    if (!dir)
+        return;
+    while ((name = g_dir_read_name (dir)) != NULL)
+        g_ptr_array_add (names, g_strdup (name));
+    g_dir_close (dir);
+}
+
+/* Interfaces of these classes never expose ports */
+static gboolean
+interface_class_ignored (guint interface_class)
+{
+    switch (interface_class) {
+    case 0x01: /* audio */
+    case 0x03: /* HID */
+    case 0x07: /* printer */
+    case 0x08: /* mass storage */
+    case 0x0a: /* CDC data */
+    case 0x0e: /* video */
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
+static gboolean
+add_interface_port_names (const gchar *interface_path,
+                          GPtrArray   *names)
+{
+    g_autofree gchar *driver_path = NULL;
+    GDir             *dir;
+    const gchar      *name;
+    guint             n_names;
+    guint             interface_class = 0;
+
+    if (read_sysfs_uint (interface_path, "bInterfaceClass", 16, &interface_class) &&
+        interface_class_ignored (interface_class))
+        return TRUE;
+
+    /* Interfaces not bound to a driver may still be waiting for one */
+    driver_path = g_build_filename (interface_path, "driver", NULL);
+    if (!g_file_test (driver_path, G_FILE_TEST_EXISTS))
+        return FALSE;
+
+    n_names = names->len;
+
+    /* net, cdc-wdm (usbmisc, or usb in older kernels) and cdc-acm ports */
+    add_class_port_names (interface_path, "net",     names);
+    add_class_port_names (interface_path, "usbmisc", names);
+    add_class_port_names (interface_path, "usb",     names);
+    add_class_port_names (interface_path, "tty",     names);
+
+    /* usb-serial ports, e.g. ttyUSB0 */
+    dir = g_dir_open (interface_path, 0, NULL);
+    if (dir) {
+        while ((name = g_dir_read_name (dir)) != NULL) {
+            if (g_str_has_prefix (name, "tty") && strcmp (name, "tty") != 0)
+                g_ptr_array_add (names, g_strdup (name));
+        }
+        g_dir_close (dir);
+    }
+
+    /* A bound interface exposing no port we know about, e.g. with ports in
+     * other subsystems, can't be used to tell whether all ports are exposed */
+    return (names->len > n_names);
+}
+
+GStrv
+mm_kernel_device_list_usb_port_names (const gchar *physdev_sysfs_path)
+{
+    g_autoptr(GPtrArray)  names = NULL;
+    g_autofree gchar     *physdev_name = NULL;
+    g_autofree gchar     *prefix = NULL;
+    GDir                 *dir;
+    const gchar          *name;
+    guint                 n_interfaces = 0;
+    guint                 n_found = 0;
+    guint                 configuration = 0;
+    gboolean              complete = TRUE;
+
+    if (!physdev_sysfs_path)
+        return NULL;
+
+    /* Only when the device is configured */
+    if (!read_sysfs_uint (physdev_sysfs_path, "bNumInterfaces", 10, &n_interfaces) ||
+        !read_sysfs_uint (physdev_sysfs_path, "bConfigurationValue", 10, &configuration) ||
+        !n_interfaces)
+        return NULL;
+
+    /* Interfaces of the active configuration are named <physdev>:<config>.<ifnum> */
+    physdev_name = g_path_get_basename (physdev_sysfs_path);
+    prefix = g_strdup_printf ("%s:%u.", physdev_name, configuration);
+
+    dir = g_dir_open (physdev_sysfs_path, 0, NULL);
+    if (!dir)
+        return NULL;
+
+    names = g_ptr_array_new_with_free_func (g_free);
+    while (complete && (name = g_dir_read_name (dir)) != NULL) {
+        g_autofree gchar *interface_path = NULL;
+
+        if (!g_str_has_prefix (name, prefix))
+            continue;
+
+        n_found++;
+        interface_path = g_build_filename (physdev_sysfs_path, name, NULL);
+        complete = add_interface_port_names (interface_path, names);
+    }
+    g_dir_close (dir);
+
+    /* All interfaces must have been created by the kernel */
+    if (!complete || n_found != n_interfaces || !names->len)
+        return NULL;
+
+    g_ptr_array_add (names, NULL);
+    return (GStrv) g_ptr_array_free (g_steal_pointer (&names), FALSE);
+}
+
 /*****************************************************************************/
 
 static gchar *
@@ -112,4 +112,9 @@ gboolean     mm_kernel_device_get_attribute_as_boolean (MMKernelDevice *self, co
 gint         mm_kernel_device_get_attribute_as_int     (MMKernelDevice *self, const gchar *attribute);
 guint        mm_kernel_device_get_attribute_as_int_hex (MMKernelDevice *self, const gchar *attribute);
 
+/* Names of all the ports exposed by the given USB device, or NULL if the
+ * kernel hasn't finished exposing them or if they can't be known (e.g. not a
+ * USB device, or interfaces with ports in other subsystems). */
+GStrv        mm_kernel_device_list_usb_port_names (const gchar *physdev_sysfs_path);
+
 #endif /* MM_KERNEL_DEVICE_H */
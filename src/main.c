@@ -30,6 +30,9 @@
 #include "mm-log.h"
 #include "mm-base-manager.h"
 #include "mm-context.h"
+#include "mm-serial-capture.h"
+#include "mm-regex-registry.h"
+#include "mm-state-key-file.h"
 
 #if defined WITH_SYSTEMD_SUSPEND_RESUME
 # include "mm-sleep-monitor.h"
@@ -152,6 +155,15 @@ register_dbus_errors (void)
   g_dbus_error_register_error   (G_IO_ERROR,    G_IO_ERROR_CANCELLED,    MM_CORE_ERROR_DBUS_PREFIX ".Cancelled");
 }
 
+static void
+log_regex_stats (const MMRegexStats *stats,
+                 gpointer            user_data)
+{
+    mm_dbg ("regex stats: %u sites, %u compiles, %u gets, %u matches in %" G_GINT64_FORMAT " us: '%s'",
+            stats->n_sites, stats->n_compiles, stats->n_gets,
+            stats->n_matches, stats->match_time, stats->pattern);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -163,7 +175,10 @@ main (int argc, char *argv[])
     mm_context_init (argc, argv);
 
     if (!mm_log_setup (mm_context_get_log_level (),
+                       mm_context_get_log_filter (),
                        mm_context_get_log_file (),
+                       mm_context_get_log_file_max_size (),
+                       mm_context_get_log_flush_interval (),
                        mm_context_get_log_journal (),
                        mm_context_get_log_timestamps (),
                        mm_context_get_log_relative_timestamps (),
@@ -173,6 +188,17 @@ main (int argc, char *argv[])
         exit (1);
     }
 
+    mm_serial_capture_setup (mm_context_get_serial_capture_dir (),
+                             mm_context_get_serial_capture_ports (),
+                             mm_context_get_serial_capture_max_size ());
+
+    /* State kept across runs is only kept in memory in test sessions */
+    if (!mm_context_get_test_session ())
+        mm_state_key_file_set_dir (MM_STATEDIR);
+
+    /* Regex match times are only accounted in debug mode */
+    mm_regex_registry_set_stats_enabled (mm_context_get_debug ());
+
     g_unix_signal_add (SIGTERM, quit_cb, NULL);
     g_unix_signal_add (SIGINT, quit_cb, NULL);
 
@@ -239,6 +265,9 @@ main (int argc, char *argv[])
 
     g_bus_unown_name (name_id);
 
+    if (mm_context_get_debug ())
+        mm_regex_registry_foreach_stats (log_regex_stats, NULL);
+
     mm_info ("ModemManager is shut down");
 
     mm_log_shutdown ();
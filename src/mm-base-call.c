@@ -1080,7 +1080,7 @@ call_start (MMBaseCall          *self,
     mm_base_modem_at_command_full (self->priv->modem,
                                    port,
                                    cmd,
-                                   90,
+                                   90000,
                                    FALSE, /* no cached */
                                    FALSE, /* no raw */
                                    cancellable,
@@ -1253,6 +1253,28 @@ out:
     return TRUE;
 }
 
+/*****************************************************************************/
+/* Plugin index check */
+
+static gboolean
+handle_check_plugin_index (MmGdbusTest           *skeleton,
+                           GDBusMethodInvocation *invocation,
+                           MMBaseManager         *self)
+{
+    GError *error = NULL;
+    guint   n_ports = 0;
+
+    if (!mm_plugin_manager_check_index (self->priv->plugin_manager, &n_ports, &error)) {
+        mm_obj_warn (self, "plugin index check failed: %s", error->message);
+        g_dbus_method_invocation_take_error (invocation, error);
+        return TRUE;
+    }
+
+    mm_obj_info (self, "plugin index checked with %u ports", n_ports);
+    mm_gdbus_test_complete_check_plugin_index (skeleton, invocation, n_ports);
+    return TRUE;
+}
+
 /*****************************************************************************/
 
 static gchar *
@@ -1420,11 +1442,20 @@ initable_init (GInitable     *initable,
     if (!self->priv->filter)
         return FALSE;
 
-    /* Create plugin manager */
-    self->priv->plugin_manager = mm_plugin_manager_new (self->priv->plugin_dir, self->priv->filter, error);
+    /* Create plugin manager; plugins listed in the manifest are only loaded
+     * when needed */
+    self->priv->plugin_manager = mm_plugin_manager_new (self->priv->plugin_dir,
+                                                        self->priv->filter,
+                                                        mm_context_get_test_session () ? NULL : MM_STATEDIR "/plugin-manifest",
+                                                        error);
     if (!self->priv->plugin_manager)
         return FALSE;
 
+    /* Without udev, the rules are parsed by ourselves; keep them parsed
+     * across runs */
+    if (!mm_context_get_test_session ())
+        mm_kernel_device_generic_set_rules_cache_file (MM_STATEDIR "/udev-rules-cache");
+
 #if defined WITH_UDEV
     if (!mm_context_get_test_no_udev ()) {
         /* Create udev client based on the subsystems requested by the plugins */
@@ -1453,6 +1484,10 @@ initable_init (GInitable     *initable,
                           "handle-set-profile",
                           G_CALLBACK (handle_set_profile),
                           initable);
+        g_signal_connect (self->priv->test_skeleton,
+                          "handle-check-plugin-index",
+                          G_CALLBACK (handle_check_plugin_index),
+                          initable);
         if (!g_dbus_interface_skeleton_export (G_DBUS_INTERFACE_SKELETON (self->priv->test_skeleton),
                                                self->priv->connection,
                                                MM_DBUS_PATH,
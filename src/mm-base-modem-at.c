@@ -13,6 +13,8 @@
  * Copyright (C) 2011 Aleksander Morgado <aleksander@gnu.org>
  */
 
+#include <string.h>
+
 #include <glib.h>
 #include <glib-object.h>
 
@@ -20,6 +22,8 @@
 
 #include "mm-base-modem-at.h"
 #include "mm-errors-types.h"
+#include "mm-log-object.h"
+#include "mm-modem-helpers.h"
 
 static gboolean
 abort_async_if_port_unusable (MMBaseModem *self,
@@ -89,7 +93,17 @@ modem_cancellable_cancelled (GCancellable *modem_cancellable,
 /*****************************************************************************/
 /* AT sequence handling */
 
+/* Set in AT ports that reject compound commands */
+#define AT_PORT_NO_COMPOUND_COMMANDS "at-port-no-compound-commands"
+
+typedef struct _AtSequenceContext AtSequenceContext;
+
 typedef struct {
+    AtSequenceContext *ctx;
+    guint              index;
+} AtSequencePipelinedCommand;
+
+struct _AtSequenceContext {
     MMBaseModem                *self;
     MMPortSerialAt             *port;
     GCancellable               *cancellable;
@@ -102,11 +116,24 @@ typedef struct {
     gpointer                    response_processor_context;
     GDestroyNotify              response_processor_context_free;
     GVariant                   *result;
-} AtSequenceContext;
+
+    /* Pipelined sequences: replies to all commands, collected before
+     * running the response processors */
+    guint                       n_commands;
+    guint                       n_pending;
+    gchar                     **responses;
+    GError                    **errors;
+    AtSequencePipelinedCommand *pipelined;
+    /* Whether the commands are run separately because the modem replied
+     * with an error or an unexpected response to the compound command */
+    gboolean                    compound_rejected;
+};
 
 static void
 at_sequence_context_free (AtSequenceContext *ctx)
 {
+    guint i;
+
     mm_port_serial_close (MM_PORT_SERIAL (ctx->port));
     g_object_unref (ctx->port);
     g_object_unref (ctx->self);
@@ -123,6 +150,15 @@ at_sequence_context_free (AtSequenceContext *ctx)
     g_object_unref (ctx->modem_cancellable);
     g_object_unref (ctx->cancellable);
 
+    for (i = 0; i < ctx->n_commands; i++) {
+        g_free (ctx->responses[i]);
+        if (ctx->errors[i])
+            g_error_free (ctx->errors[i]);
+    }
+    g_free (ctx->responses);
+    g_free (ctx->errors);
+    g_free (ctx->pipelined);
+
     if (ctx->result)
         g_variant_unref (ctx->result);
     if (ctx->simple)
@@ -151,28 +187,29 @@ mm_base_modem_at_sequence_full_finish (MMBaseModem   *self,
     return ctx->result;
 }
 
-static void
-at_sequence_parse_response (MMPortSerialAt    *port,
-                            GAsyncResult      *res,
-                            AtSequenceContext *ctx)
+static gboolean
+at_sequence_complete_if_cancelled (AtSequenceContext *ctx)
+{
+    if (!g_cancellable_is_cancelled (ctx->cancellable))
+        return FALSE;
+
+    g_simple_async_result_set_error (ctx->simple, G_IO_ERROR, G_IO_ERROR_CANCELLED, "AT sequence was cancelled");
+    g_simple_async_result_complete (ctx->simple);
+    at_sequence_context_free (ctx);
+    return TRUE;
+}
+
+/* Returns TRUE if the sequence should go on with the next command; otherwise
+ * the sequence is completed and the context is no longer valid */
+static gboolean
+at_sequence_process_response (AtSequenceContext *ctx,
+                              const gchar       *response,
+                              const GError      *error)
 {
     MMBaseModemAtResponseProcessorResult  processor_result;
     GVariant                             *result = NULL;
     GError                               *result_error = NULL;
     GSimpleAsyncResult                   *simple;
-    const gchar                          *response;
-    GError                               *error = NULL;
-
-    response = mm_port_serial_at_command_finish (port, res, &error);
-
-    /* Cancelled? */
-    if (g_cancellable_is_cancelled (ctx->cancellable)) {
-        g_simple_async_result_set_error (ctx->simple, G_IO_ERROR, G_IO_ERROR_CANCELLED, "AT sequence was cancelled");
-        g_clear_error (&error);
-        g_simple_async_result_complete (ctx->simple);
-        at_sequence_context_free (ctx);
-        return;
-    }
 
     if (!ctx->current->response_processor)
         processor_result = MM_BASE_MODEM_AT_RESPONSE_PROCESSOR_RESULT_CONTINUE;
@@ -201,32 +238,16 @@ at_sequence_parse_response (MMPortSerialAt    *port,
                 g_simple_async_result_take_error (ctx->simple, result_error);
                 g_simple_async_result_complete (ctx->simple);
                 at_sequence_context_free (ctx);
-                if (error)
-                    g_error_free (error);
-                return;
+                return FALSE;
             default:
                 g_assert_not_reached ();
         }
     }
 
-    if (error)
-        g_error_free (error);
-
     if (processor_result == MM_BASE_MODEM_AT_RESPONSE_PROCESSOR_RESULT_CONTINUE) {
         ctx->current++;
-        if (ctx->current->command) {
-            /* Schedule the next command in the probing group */
-            mm_port_serial_at_command (
-                ctx->port,
-                ctx->current->command,
-                ctx->current->timeout,
-                FALSE,
-                ctx->current->allow_cached,
-                ctx->cancellable,
-                (GAsyncReadyCallback)at_sequence_parse_response,
-                ctx);
-            return;
-        }
+        if (ctx->current->command)
+            return TRUE;
         /* On last command, end. */
     }
 
@@ -249,23 +270,55 @@ at_sequence_parse_response (MMPortSerialAt    *port,
      * be freed when completed. */
     g_simple_async_result_complete (simple);
     g_object_unref (simple);
+    return FALSE;
 }
 
-void
-mm_base_modem_at_sequence_full (MMBaseModem                *self,
-                                MMPortSerialAt             *port,
-                                const MMBaseModemAtCommand *sequence,
-                                gpointer                    response_processor_context,
-                                GDestroyNotify              response_processor_context_free,
-                                GCancellable               *cancellable,
-                                GAsyncReadyCallback         callback,
-                                gpointer                    user_data)
+static void
+at_sequence_parse_response (MMPortSerialAt    *port,
+                            GAsyncResult      *res,
+                            AtSequenceContext *ctx)
 {
-    AtSequenceContext *ctx;
+    const gchar *response;
+    GError      *error = NULL;
+    gboolean     next;
 
-    /* Ensure that we have an open port */
-    if (!abort_async_if_port_unusable (self, port, callback, user_data))
+    response = mm_port_serial_at_command_finish (port, res, &error);
+
+    /* Cancelled? */
+    if (at_sequence_complete_if_cancelled (ctx)) {
+        g_clear_error (&error);
         return;
+    }
+
+    next = at_sequence_process_response (ctx, response, error);
+    if (error)
+        g_error_free (error);
+
+    if (next) {
+        /* Schedule the next command in the probing group */
+        mm_port_serial_at_command (
+            ctx->port,
+            ctx->current->command,
+            ctx->current->timeout * 1000,
+            FALSE,
+            ctx->current->allow_cached,
+            ctx->cancellable,
+            (GAsyncReadyCallback)at_sequence_parse_response,
+            ctx);
+    }
+}
+
+static AtSequenceContext *
+at_sequence_context_new (MMBaseModem                *self,
+                         MMPortSerialAt             *port,
+                         const MMBaseModemAtCommand *sequence,
+                         gpointer                    response_processor_context,
+                         GDestroyNotify              response_processor_context_free,
+                         GCancellable               *cancellable,
+                         GAsyncReadyCallback         callback,
+                         gpointer                    user_data)
+{
+    AtSequenceContext *ctx;
 
     /* Setup context */
     ctx = g_new0 (AtSequenceContext, 1);
@@ -295,11 +348,39 @@ mm_base_modem_at_sequence_full (MMBaseModem                *self,
                                                    NULL);
     }
 
+    return ctx;
+}
+
+void
+mm_base_modem_at_sequence_full (MMBaseModem                *self,
+                                MMPortSerialAt             *port,
+                                const MMBaseModemAtCommand *sequence,
+                                gpointer                    response_processor_context,
+                                GDestroyNotify              response_processor_context_free,
+                                GCancellable               *cancellable,
+                                GAsyncReadyCallback         callback,
+                                gpointer                    user_data)
+{
+    AtSequenceContext *ctx;
+
+    /* Ensure that we have an open port */
+    if (!abort_async_if_port_unusable (self, port, callback, user_data))
+        return;
+
+    ctx = at_sequence_context_new (self,
+                                   port,
+                                   sequence,
+                                   response_processor_context,
+                                   response_processor_context_free,
+                                   cancellable,
+                                   callback,
+                                   user_data);
+
     /* Go on with the first one in the sequence */
     mm_port_serial_at_command (
         ctx->port,
         ctx->current->command,
-        ctx->current->timeout,
+        ctx->current->timeout * 1000,
         FALSE,
         ctx->current->allow_cached,
         ctx->cancellable,
@@ -353,6 +434,246 @@ mm_base_modem_at_sequence (MMBaseModem *self,
         user_data);
 }
 
+/*****************************************************************************/
+/* Pipelined AT sequence handling */
+
+static void
+at_sequence_pipelined_process (AtSequenceContext *ctx)
+{
+    guint i;
+
+    if (at_sequence_complete_if_cancelled (ctx))
+        return;
+
+    /* Run the response processors in order, as in a plain sequence */
+    do {
+        i = ctx->current - ctx->sequence;
+    } while (at_sequence_process_response (ctx, ctx->responses[i], ctx->errors[i]));
+}
+
+static void
+at_sequence_pipelined_command_ready (MMPortSerialAt             *port,
+                                     GAsyncResult               *res,
+                                     AtSequencePipelinedCommand *command)
+{
+    AtSequenceContext *ctx = command->ctx;
+    const gchar       *response;
+
+    response = mm_port_serial_at_command_finish (port, res, &ctx->errors[command->index]);
+    if (response)
+        ctx->responses[command->index] = g_strdup (response);
+
+    g_assert (ctx->n_pending > 0);
+    if (--ctx->n_pending > 0)
+        return;
+
+    /* If all the commands succeed separately, it was the compound command
+     * itself that the modem didn't accept, so don't try again in this port.
+     * Otherwise, the failure is explained by the failed command (e.g. +CIMI
+     * without SIM), which doesn't mean compound commands aren't supported. */
+    if (ctx->compound_rejected) {
+        guint i;
+
+        for (i = 0; i < ctx->n_commands && !ctx->errors[i]; i++);
+        if (i == ctx->n_commands) {
+            mm_obj_dbg (ctx->self, "compound commands not supported in port %s",
+                        mm_port_get_device (MM_PORT (ctx->port)));
+            g_object_set_data (G_OBJECT (ctx->port), AT_PORT_NO_COMPOUND_COMMANDS, GUINT_TO_POINTER (TRUE));
+        }
+    }
+
+    at_sequence_pipelined_process (ctx);
+}
+
+static void
+at_sequence_pipelined_run_commands (AtSequenceContext *ctx)
+{
+    guint i;
+
+    /* All commands queued at once; sent back to back if the port allows
+     * pipelining, otherwise still one by one but without waiting for the
+     * response processors in between */
+    ctx->n_pending = ctx->n_commands;
+    for (i = 0; i < ctx->n_commands; i++) {
+        ctx->pipelined[i].ctx = ctx;
+        ctx->pipelined[i].index = i;
+        mm_port_serial_at_command (
+            ctx->port,
+            ctx->sequence[i].command,
+            ctx->sequence[i].timeout * 1000,
+            FALSE,
+            ctx->sequence[i].allow_cached,
+            ctx->cancellable,
+            (GAsyncReadyCallback)at_sequence_pipelined_command_ready,
+            &ctx->pipelined[i]);
+    }
+}
+
+static const gchar **
+at_sequence_get_commands (AtSequenceContext *ctx)
+{
+    const gchar **commands;
+    guint         i;
+
+    commands = g_new0 (const gchar *, ctx->n_commands + 1);
+    for (i = 0; i < ctx->n_commands; i++)
+        commands[i] = ctx->sequence[i].command;
+    return commands;
+}
+
+static gchar *
+at_sequence_build_compound_command (AtSequenceContext *ctx)
+{
+    g_autofree const gchar **commands = NULL;
+
+    if (GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (ctx->port), AT_PORT_NO_COMPOUND_COMMANDS)))
+        return NULL;
+
+    commands = at_sequence_get_commands (ctx);
+    return mm_at_compound_command_build (commands, ctx->n_commands);
+}
+
+static gboolean
+at_sequence_split_compound_response (AtSequenceContext *ctx,
+                                     const gchar       *response)
+{
+    g_autofree const gchar **commands = NULL;
+    g_autofree gchar       **responses = NULL;
+    guint                    i;
+
+    commands = at_sequence_get_commands (ctx);
+    responses = mm_at_compound_response_split (commands, ctx->n_commands, response);
+    if (!responses)
+        return FALSE;
+
+    /* Strings now owned by the context */
+    for (i = 0; i < ctx->n_commands; i++) {
+        ctx->responses[i] = responses[i];
+        if (ctx->sequence[i].allow_cached)
+            mm_port_serial_at_set_cached_reply (ctx->port, ctx->sequence[i].command, ctx->responses[i]);
+    }
+    return TRUE;
+}
+
+static void
+at_sequence_compound_command_ready (MMPortSerialAt    *port,
+                                    GAsyncResult      *res,
+                                    AtSequenceContext *ctx)
+{
+    const gchar *response;
+    GError      *error = NULL;
+
+    response = mm_port_serial_at_command_finish (port, res, &error);
+
+    /* Cancelled? */
+    if (at_sequence_complete_if_cancelled (ctx)) {
+        g_clear_error (&error);
+        return;
+    }
+
+    if (response && at_sequence_split_compound_response (ctx, response)) {
+        at_sequence_pipelined_process (ctx);
+        return;
+    }
+
+    /* Either the compound command isn't supported, or any of the commands
+     * failed; run them again one by one to find out. Timeouts and other
+     * errors not coming from the modem don't tell anything about it. */
+    mm_obj_dbg (ctx->self, "compound command failed (%s), running commands separately",
+                error ? error->message : "unexpected response");
+    ctx->compound_rejected = (!error ||
+                              error->domain == MM_MOBILE_EQUIPMENT_ERROR ||
+                              error->domain == MM_MESSAGE_ERROR);
+    g_clear_error (&error);
+    at_sequence_pipelined_run_commands (ctx);
+}
+
+void
+mm_base_modem_at_sequence_pipelined_full (MMBaseModem                *self,
+                                          MMPortSerialAt             *port,
+                                          const MMBaseModemAtCommand *sequence,
+                                          gpointer                    response_processor_context,
+                                          GDestroyNotify              response_processor_context_free,
+                                          GCancellable               *cancellable,
+                                          GAsyncReadyCallback         callback,
+                                          gpointer                    user_data)
+{
+    AtSequenceContext *ctx;
+    g_autofree gchar  *compound = NULL;
+    guint              timeout = 0;
+    guint              i;
+
+    /* Ensure that we have an open port */
+    if (!abort_async_if_port_unusable (self, port, callback, user_data))
+        return;
+
+    ctx = at_sequence_context_new (self,
+                                   port,
+                                   sequence,
+                                   response_processor_context,
+                                   response_processor_context_free,
+                                   cancellable,
+                                   callback,
+                                   user_data);
+
+    for (i = 0; sequence[i].command; i++)
+        timeout += sequence[i].timeout;
+    ctx->n_commands = i;
+    g_assert (ctx->n_commands > 0);
+    ctx->responses = g_new0 (gchar *, ctx->n_commands);
+    ctx->errors = g_new0 (GError *, ctx->n_commands);
+    ctx->pipelined = g_new0 (AtSequencePipelinedCommand, ctx->n_commands);
+
+    compound = at_sequence_build_compound_command (ctx);
+    if (!compound) {
+        at_sequence_pipelined_run_commands (ctx);
+        return;
+    }
+
+    mm_port_serial_at_command (
+        ctx->port,
+        compound,
+        timeout * 1000,
+        FALSE,
+        FALSE,
+        ctx->cancellable,
+        (GAsyncReadyCallback)at_sequence_compound_command_ready,
+        ctx);
+}
+
+void
+mm_base_modem_at_sequence_pipelined (MMBaseModem                *self,
+                                     const MMBaseModemAtCommand *sequence,
+                                     gpointer                    response_processor_context,
+                                     GDestroyNotify              response_processor_context_free,
+                                     GAsyncReadyCallback         callback,
+                                     gpointer                    user_data)
+{
+    MMPortSerialAt *port;
+    GError *error = NULL;
+
+    /* No port given, so we'll try to guess which is best */
+    port = mm_base_modem_peek_best_at_port (self, &error);
+    if (!port) {
+        g_assert (error != NULL);
+        g_simple_async_report_take_gerror_in_idle (G_OBJECT (self),
+                                                   callback,
+                                                   user_data,
+                                                   error);
+        return;
+    }
+
+    mm_base_modem_at_sequence_pipelined_full (
+        self,
+        port,
+        sequence,
+        response_processor_context,
+        response_processor_context_free,
+        NULL,
+        callback,
+        user_data);
+}
+
 /*****************************************************************************/
 /* Response processor helpers */
 
@@ -543,7 +864,7 @@ void
 mm_base_modem_at_command_full (MMBaseModem *self,
                                MMPortSerialAt *port,
                                const gchar *command,
-                               guint timeout,
+                               guint timeout_ms,
                                gboolean allow_cached,
                                gboolean is_raw,
                                GCancellable *cancellable,
@@ -584,7 +905,7 @@ mm_base_modem_at_command_full (MMBaseModem *self,
     mm_port_serial_at_command (
         port,
         command,
-        timeout,
+        timeout_ms,
         is_raw,
         allow_cached,
         ctx->cancellable,
@@ -626,7 +947,7 @@ _at_command (MMBaseModem *self,
     mm_base_modem_at_command_full (self,
                                    port,
                                    command,
-                                   timeout,
+                                   timeout * 1000,
                                    allow_cached,
                                    is_raw,
                                    NULL,
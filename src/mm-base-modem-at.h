@@ -97,6 +97,32 @@ GVariant *mm_base_modem_at_sequence_full_finish (MMBaseModem *self,
                                                  gpointer *response_processor_context,
                                                  GError **error);
 
+/* Pipelined AT sequence handling, for sequences of independent queries where
+ * no command depends on the reply to the previous ones. All the commands are
+ * run without waiting for the previous replies: as a single compound command
+ * (e.g. "AT+CPIN?;+CSQ") if the replies can be split back (see
+ * mm_at_compound_command_build()) and the port didn't reject compound commands
+ * before, or otherwise all queued at once, each one getting its own reply.
+ * If the compound command fails, the commands are run separately; the port is
+ * only flagged as rejecting compound commands if all of them succeed then.
+ * The response processors are then run in order, exactly as in a plain
+ * sequence; but note that all commands are sent even if the sequence ends
+ * early. Results are retrieved with mm_base_modem_at_sequence_finish(). */
+void mm_base_modem_at_sequence_pipelined      (MMBaseModem *self,
+                                               const MMBaseModemAtCommand *sequence,
+                                               gpointer response_processor_context,
+                                               GDestroyNotify response_processor_context_free,
+                                               GAsyncReadyCallback callback,
+                                               gpointer user_data);
+void mm_base_modem_at_sequence_pipelined_full (MMBaseModem *self,
+                                               MMPortSerialAt *port,
+                                               const MMBaseModemAtCommand *sequence,
+                                               gpointer response_processor_context,
+                                               GDestroyNotify response_processor_context_free,
+                                               GCancellable *cancellable,
+                                               GAsyncReadyCallback callback,
+                                               gpointer user_data);
+
 /* Common helper response processors */
 
 /*
@@ -177,7 +203,7 @@ MMBaseModemAtResponseProcessorResult mm_base_modem_response_processor_string_ign
                                                                                                GError       **result_error);
 
 /* Generic AT command handling, using the best AT port available and without
- * explicit cancellations. */
+ * explicit cancellations. Timeout given in seconds. */
 void mm_base_modem_at_command                (MMBaseModem *self,
                                               const gchar *command,
                                               guint timeout,
@@ -196,11 +222,11 @@ const gchar *mm_base_modem_at_command_finish (MMBaseModem *self,
                                               GError **error);
 
 /* Fully detailed AT command handling, when specific AT port and/or explicit
- * cancellations need to be used. */
+ * cancellations need to be used. Timeout given in milliseconds. */
 void mm_base_modem_at_command_full                (MMBaseModem *self,
                                                    MMPortSerialAt *port,
                                                    const gchar *command,
-                                                   guint timeout,
+                                                   guint timeout_ms,
                                                    gboolean allow_cached,
                                                    gboolean is_raw,
                                                    GCancellable *cancellable,
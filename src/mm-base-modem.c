@@ -216,6 +216,12 @@ base_modem_create_tty_port (MMBaseModem        *self,
                          name, inner_error->message);
     }
 
+    /* Optional user-provided command pipelining */
+    if (ptype == MM_PORT_TYPE_AT && mm_kernel_device_get_property_as_boolean (kernel_device, ID_MM_TTY_PIPELINE))
+        g_object_set (port,
+                      MM_PORT_SERIAL_PIPELINE, TRUE,
+                      NULL);
+
     return port;
 }
 
@@ -69,6 +69,9 @@ struct _MMBaseSimPrivate {
     /* The SIM slot number, which will be 0 always if the system
      * doesn't support multiple SIMS. */
      guint slot_number;
+
+    /* IMSI query response received while loading the SIM identifier */
+    gchar *prefetched_imsi;
 };
 
 static guint signals[SIGNAL_LAST] = { 0 };
@@ -1200,21 +1203,132 @@ load_sim_identifier_finish (MMBaseSim *self,
 
 STR_REPLY_READY_FN (load_sim_identifier)
 
+static void load_imsi (MMBaseSim           *self,
+                       GAsyncReadyCallback  callback,
+                       gpointer             user_data);
+
+typedef struct {
+    gchar  *sim_identifier;
+    GError *sim_identifier_error;
+    gchar  *imsi;
+} SimIdentityContext;
+
+static void
+sim_identity_context_free (SimIdentityContext *ctx)
+{
+    g_free (ctx->sim_identifier);
+    if (ctx->sim_identifier_error)
+        g_error_free (ctx->sim_identifier_error);
+    g_free (ctx->imsi);
+    g_slice_free (SimIdentityContext, ctx);
+}
+
+static MMBaseModemAtResponseProcessorResult
+sim_identity_sim_identifier_processor (MMBaseModem   *modem,
+                                       gpointer       context,
+                                       const gchar   *command,
+                                       const gchar   *response,
+                                       gboolean       last_command,
+                                       const GError  *error,
+                                       GVariant     **result,
+                                       GError       **result_error)
+{
+    SimIdentityContext *ctx = context;
+
+    if (error)
+        ctx->sim_identifier_error = g_error_copy (error);
+    else
+        ctx->sim_identifier = g_strdup (response);
+    return MM_BASE_MODEM_AT_RESPONSE_PROCESSOR_RESULT_CONTINUE;
+}
+
+static MMBaseModemAtResponseProcessorResult
+sim_identity_imsi_processor (MMBaseModem   *modem,
+                             gpointer       context,
+                             const gchar   *command,
+                             const gchar   *response,
+                             gboolean       last_command,
+                             const GError  *error,
+                             GVariant     **result,
+                             GError       **result_error)
+{
+    SimIdentityContext *ctx = context;
+
+    /* On error, IMSI is just queried again when loaded */
+    if (!error)
+        ctx->imsi = g_strdup (response);
+    return MM_BASE_MODEM_AT_RESPONSE_PROCESSOR_RESULT_CONTINUE;
+}
+
+/* The IMSI is loaded right after the SIM identifier, so query both at once;
+ * +CRSM replies are prefixed, so they may be sent as a compound command */
+static const MMBaseModemAtCommand sim_identity_queries[] = {
+    /* READ BINARY of EFiccid (ICC Identification) ETSI TS 102.221 section 13.2 */
+    { "+CRSM=176,12258,0,0,10", 20, FALSE, sim_identity_sim_identifier_processor },
+    { "+CIMI",                   3, FALSE, sim_identity_imsi_processor },
+    { NULL }
+};
+
+static void
+sim_identity_queries_ready (MMBaseModem  *modem,
+                            GAsyncResult *res,
+                            GTask        *task)
+{
+    MMBaseSim          *self;
+    SimIdentityContext *ctx = NULL;
+    GError             *error = NULL;
+
+    self = g_task_get_source_object (task);
+
+    mm_base_modem_at_sequence_finish (modem, res, (gpointer *) &ctx, &error);
+    if (error) {
+        g_task_return_error (task, error);
+        g_object_unref (task);
+        return;
+    }
+
+    g_assert (ctx);
+    g_free (self->priv->prefetched_imsi);
+    self->priv->prefetched_imsi = g_steal_pointer (&ctx->imsi);
+
+    if (ctx->sim_identifier_error)
+        g_task_return_error (task, g_error_copy (ctx->sim_identifier_error));
+    else
+        g_task_return_pointer (task, g_steal_pointer (&ctx->sim_identifier), g_free);
+    g_object_unref (task);
+}
+
 static void
 load_sim_identifier (MMBaseSim *self,
                      GAsyncReadyCallback callback,
                      gpointer user_data)
 {
+    GTask *task;
+
     mm_obj_dbg (self, "loading SIM identifier...");
 
-    /* READ BINARY of EFiccid (ICC Identification) ETSI TS 102.221 section 13.2 */
+    task = g_task_new (self, NULL, callback, user_data);
+    g_clear_pointer (&self->priv->prefetched_imsi, g_free);
+
+    /* Only if the IMSI is loaded with the generic implementation */
+    if (MM_BASE_SIM_GET_CLASS (self)->load_imsi == load_imsi) {
+        mm_base_modem_at_sequence_pipelined (
+            self->priv->modem,
+            sim_identity_queries,
+            g_slice_new0 (SimIdentityContext),
+            (GDestroyNotify) sim_identity_context_free,
+            (GAsyncReadyCallback)sim_identity_queries_ready,
+            task);
+        return;
+    }
+
     mm_base_modem_at_command (
         self->priv->modem,
-        "+CRSM=176,12258,0,0,10",
-        20,
+        sim_identity_queries[0].command,
+        sim_identity_queries[0].timeout,
         FALSE,
         (GAsyncReadyCallback)load_sim_identifier_command_ready,
-        g_task_new (self, NULL, callback, user_data));
+        task);
 }
 
 /*****************************************************************************/
@@ -1275,6 +1389,15 @@ load_imsi (MMBaseSim *self,
 {
     mm_obj_dbg (self, "loading IMSI...");
 
+    if (self->priv->prefetched_imsi) {
+        GTask *task;
+
+        task = g_task_new (self, NULL, callback, user_data);
+        g_task_return_pointer (task, g_steal_pointer (&self->priv->prefetched_imsi), g_free);
+        g_object_unref (task);
+        return;
+    }
+
     mm_base_modem_at_command (
         self->priv->modem,
         "+CIMI",
@@ -2012,6 +2135,7 @@ finalize (GObject *object)
     MMBaseSim *self = MM_BASE_SIM (object);
 
     g_free (self->priv->path);
+    g_free (self->priv->prefetched_imsi);
 
     G_OBJECT_CLASS (mm_base_sim_parent_class)->finalize (object);
 }
@@ -269,7 +269,7 @@ cdma_connect_context_dial (GTask *task)
     mm_base_modem_at_command_full (ctx->modem,
                                    MM_PORT_SERIAL_AT (ctx->data),
                                    "DT#777",
-                                   MM_BASE_BEARER_DEFAULT_CONNECTION_TIMEOUT,
+                                   MM_BASE_BEARER_DEFAULT_CONNECTION_TIMEOUT * 1000,
                                    FALSE,
                                    FALSE,
                                    NULL,
@@ -358,7 +358,7 @@ current_rm_protocol_ready (MMBaseModem *self,
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        command,
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE,
                                        NULL,
@@ -410,7 +410,7 @@ connect_cdma (MMBroadbandBearer *self,
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        "+CRM?",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -514,7 +514,7 @@ atd_ready (MMBaseModem *modem,
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        "+CEER",
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -586,7 +586,7 @@ dial_3gpp (MMBroadbandBearer *self,
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->dial_port,
                                    command,
-                                   MM_BASE_BEARER_DEFAULT_CONNECTION_TIMEOUT,
+                                   MM_BASE_BEARER_DEFAULT_CONNECTION_TIMEOUT * 1000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -696,7 +696,7 @@ cid_selection_3gpp_initialize_context (GTask *task)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    cmd,
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -799,7 +799,7 @@ cid_selection_3gpp_query_current (GTask *task)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    "+CGDCONT?",
-                                   3,
+                                   3000,
                                    FALSE, /* cached */
                                    FALSE, /* raw */
                                    ctx->cancellable,
@@ -853,7 +853,7 @@ cid_selection_3gpp_query_format (GTask *task)
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    "+CGDCONT=?",
-                                   3,
+                                   3000,
                                    TRUE, /* cached */
                                    FALSE, /* raw */
                                    ctx->cancellable,
@@ -1603,7 +1603,7 @@ data_flash_3gpp_ready (MMPortSerial *data,
     mm_base_modem_at_command_full (ctx->modem,
                                    ctx->primary,
                                    ctx->cgact_command,
-                                   10,
+                                   10000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -1720,7 +1720,7 @@ disconnect_3gpp (MMBroadbandBearer *self,
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->primary,
                                        ctx->cgact_command,
-                                       45,
+                                       45000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -1739,7 +1739,7 @@ disconnect_3gpp (MMBroadbandBearer *self,
         mm_base_modem_at_command_full (ctx->modem,
                                        ctx->secondary,
                                        ctx->cgact_command,
-                                       45,
+                                       45000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -2000,7 +2000,7 @@ load_connection_status (MMBaseBearer        *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (modem),
                                    port,
                                    "+CGACT?",
-                                   3,
+                                   3000,
                                    FALSE, /* allow cached */
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -2155,7 +2155,7 @@ interface_initialization_step (GTask *task)
             mm_base_modem_at_command_full (ctx->modem,
                                            ctx->port,
                                            "+CRM=?",
-                                           3,
+                                           3000,
                                            TRUE, /* getting range, so reply can be cached */
                                            FALSE, /* raw */
                                            NULL, /* cancellable */
@@ -50,6 +50,7 @@
 #include "mm-base-sim.h"
 #include "mm-log-object.h"
 #include "mm-modem-helpers.h"
+#include "mm-regex-registry.h"
 #include "mm-error-helpers.h"
 #include "mm-port-serial-qcdm.h"
 #include "libqcdm/src/errors.h"
@@ -124,6 +125,7 @@ enum {
     PROP_MODEM_SIM_HOT_SWAP_CONFIGURED,
     PROP_MODEM_PERIODIC_SIGNAL_CHECK_DISABLED,
     PROP_MODEM_PERIODIC_ACCESS_TECH_CHECK_DISABLED,
+    PROP_MODEM_SUPPORTED_BANDS_CACHEABLE,
     PROP_MODEM_PERIODIC_CALL_LIST_CHECK_DISABLED,
     PROP_MODEM_CARRIER_CONFIG_MAPPING,
     PROP_MODEM_FIRMWARE_IGNORE_CARRIER,
@@ -150,6 +152,7 @@ struct _MMBroadbandModemPrivate {
     gboolean sim_hot_swap_configured;
     gboolean periodic_signal_check_disabled;
     gboolean periodic_access_tech_check_disabled;
+    gboolean supported_bands_cacheable;
 
     /*<--- Modem interface --->*/
     /* Properties */
@@ -920,23 +923,68 @@ static gchar *
 modem_load_manufacturer_finish (MMIfaceModem *self,
                                 GAsyncResult *res,
                                 GError **error)
+{
+    return g_task_propagate_pointer (G_TASK (res), error);
+}
+
+static const MMBaseModemAtCommand manufacturers[] = {
+    { "+CGMI",  3, TRUE, mm_base_modem_response_processor_string_ignore_at_errors },
+    { "+GMI",   3, TRUE, mm_base_modem_response_processor_string_ignore_at_errors },
+    { NULL }
+};
+
+/* Independent identity queries, run at once before loading the manufacturer
+ * so that the reply is already cached when the model is loaded. Their replies
+ * are usually just the value, so they are pipelined rather than sent as a
+ * compound command. Neither is needed when the manufacturer and model are
+ * taken from the static information cache, so they aren't prefetched along
+ * with the revision and equipment identifier. */
+static const MMBaseModemAtCommand identity_queries[] = {
+    { "+CGMI",  3, TRUE, NULL },
+    { "+CGMM",  3, TRUE, NULL },
+    { NULL }
+};
+
+static void
+manufacturers_ready (MMBaseModem  *self,
+                     GAsyncResult *res,
+                     GTask        *task)
 {
     GVariant *result;
-    gchar *manufacturer = NULL;
+    GError   *error = NULL;
+    gchar    *manufacturer = NULL;
+
+    result = mm_base_modem_at_sequence_finish (self, res, NULL, &error);
+    if (error) {
+        g_task_return_error (task, error);
+        g_object_unref (task);
+        return;
+    }
 
-    result = mm_base_modem_at_sequence_finish (MM_BASE_MODEM (self), res, NULL, error);
     if (result) {
         manufacturer = sanitize_info_reply (result, "GMI:");
         mm_obj_dbg (self, "loaded manufacturer: %s", manufacturer);
     }
-    return manufacturer;
+    g_task_return_pointer (task, manufacturer, g_free);
+    g_object_unref (task);
 }
 
-static const MMBaseModemAtCommand manufacturers[] = {
-    { "+CGMI",  3, TRUE, mm_base_modem_response_processor_string_ignore_at_errors },
-    { "+GMI",   3, TRUE, mm_base_modem_response_processor_string_ignore_at_errors },
-    { NULL }
-};
+static void
+identity_queries_ready (MMBaseModem  *self,
+                        GAsyncResult *res,
+                        GTask        *task)
+{
+    /* Errors are ignored, the queries are run again if needed */
+    mm_base_modem_at_sequence_finish (self, res, NULL, NULL);
+
+    mm_base_modem_at_sequence (
+        self,
+        manufacturers,
+        NULL, /* response_processor_context */
+        NULL, /* response_processor_context_free */
+        (GAsyncReadyCallback)manufacturers_ready,
+        task);
+}
 
 static void
 modem_load_manufacturer (MMIfaceModem *self,
@@ -944,13 +992,13 @@ modem_load_manufacturer (MMIfaceModem *self,
                          gpointer user_data)
 {
     mm_obj_dbg (self, "loading manufacturer...");
-    mm_base_modem_at_sequence (
+    mm_base_modem_at_sequence_pipelined (
         MM_BASE_MODEM (self),
-        manufacturers,
+        identity_queries,
         NULL, /* response_processor_context */
         NULL, /* response_processor_context_free */
-        callback,
-        user_data);
+        (GAsyncReadyCallback)identity_queries_ready,
+        g_task_new (self, NULL, callback, user_data));
 }
 
 /*****************************************************************************/
@@ -1000,37 +1048,87 @@ static gchar *
 modem_load_revision_finish (MMIfaceModem *self,
                             GAsyncResult *res,
                             GError **error)
+{
+    return g_task_propagate_pointer (G_TASK (res), error);
+}
+
+static const MMBaseModemAtCommand revisions[] = {
+    { "+CGMR",  3, TRUE, mm_base_modem_response_processor_string_ignore_at_errors },
+    { "+GMR",   3, TRUE, mm_base_modem_response_processor_string_ignore_at_errors },
+    { NULL }
+};
+
+/* The revision and equipment identifier are loaded one after the other to
+ * validate the static information cache, so both queries are pipelined
+ * before loading the revision and the equipment identifier reply is already
+ * cached when it's loaded. */
+static const MMBaseModemAtCommand validation_queries[] = {
+    { "+CGSN",  3, TRUE, NULL },
+    { "+CGMR",  3, TRUE, NULL },
+    { NULL }
+};
+
+static void
+revisions_ready (MMBaseModem  *self,
+                 GAsyncResult *res,
+                 GTask        *task)
 {
     GVariant *result;
-    gchar *revision = NULL;
+    GError   *error = NULL;
+    gchar    *revision = NULL;
+
+    result = mm_base_modem_at_sequence_finish (self, res, NULL, &error);
+    if (error) {
+        g_task_return_error (task, error);
+        g_object_unref (task);
+        return;
+    }
 
-    result = mm_base_modem_at_sequence_finish (MM_BASE_MODEM (self), res, NULL, error);
     if (result) {
         revision = sanitize_info_reply (result, "GMR:");
         mm_obj_dbg (self, "loaded revision: %s", revision);
     }
-    return revision;
+    g_task_return_pointer (task, revision, g_free);
+    g_object_unref (task);
 }
 
-static const MMBaseModemAtCommand revisions[] = {
-    { "+CGMR",  3, TRUE, mm_base_modem_response_processor_string_ignore_at_errors },
-    { "+GMR",   3, TRUE, mm_base_modem_response_processor_string_ignore_at_errors },
-    { NULL }
-};
+static void
+validation_queries_ready (MMBaseModem  *self,
+                          GAsyncResult *res,
+                          GTask        *task)
+{
+    /* Errors are ignored, the queries are run again if needed */
+    mm_base_modem_at_sequence_finish (self, res, NULL, NULL);
+
+    mm_base_modem_at_sequence (
+        self,
+        revisions,
+        NULL, /* response_processor_context */
+        NULL, /* response_processor_context_free */
+        (GAsyncReadyCallback)revisions_ready,
+        task);
+}
 
 static void
 modem_load_revision (MMIfaceModem *self,
                      GAsyncReadyCallback callback,
                      gpointer user_data)
 {
+    const MMBaseModemAtCommand *queries = validation_queries;
+
     mm_obj_dbg (self, "loading revision...");
-    mm_base_modem_at_sequence (
+
+    /* On CDMA-only (non-3GPP) modems, +GSN is used instead */
+    if (mm_iface_modem_is_cdma_only (self))
+        queries++;
+
+    mm_base_modem_at_sequence_pipelined (
         MM_BASE_MODEM (self),
-        revisions,
+        queries,
         NULL, /* response_processor_context */
         NULL, /* response_processor_context_free */
-        callback,
-        user_data);
+        (GAsyncReadyCallback)validation_queries_ready,
+        g_task_new (self, NULL, callback, user_data));
 }
 
 /*****************************************************************************/
@@ -1590,6 +1688,8 @@ load_unlock_retries (MMIfaceModem        *self,
 /*****************************************************************************/
 /* Supported modes loading (Modem interface) */
 
+#define INFO_CACHE_KEY_SUPPORTED_MODES "generic-supported-modes"
+
 typedef struct {
     MMModemMode mode;
     gboolean run_cnti;
@@ -1846,8 +1946,12 @@ load_supported_modes_step (GTask *task)
                                  MM_CORE_ERROR,
                                  MM_CORE_ERROR_FAILED,
                                  "Couldn't retrieve supported modes");
-    else
+    else {
+        mm_iface_modem_info_cache_store (MM_IFACE_MODEM (self),
+                                         INFO_CACHE_KEY_SUPPORTED_MODES,
+                                         g_variant_new_uint32 (ctx->mode));
         g_task_return_int (task, ctx->mode);
+    }
 
     g_object_unref (task);
 }
@@ -1859,8 +1963,19 @@ modem_load_supported_modes (MMIfaceModem *self,
 {
     LoadSupportedModesContext *ctx;
     GTask *task;
+    GVariant *cached;
 
     mm_obj_dbg (self, "loading supported modes...");
+    task = g_task_new (self, NULL, callback, user_data);
+
+    cached = mm_iface_modem_info_cache_lookup (self, INFO_CACHE_KEY_SUPPORTED_MODES, G_VARIANT_TYPE_UINT32);
+    if (cached) {
+        g_task_return_int (task, g_variant_get_uint32 (cached));
+        g_object_unref (task);
+        g_variant_unref (cached);
+        return;
+    }
+
     ctx = g_new0 (LoadSupportedModesContext, 1);
     ctx->mode = MM_MODEM_MODE_NONE;
 
@@ -1875,7 +1990,6 @@ modem_load_supported_modes (MMIfaceModem *self,
         ctx->run_gcap = TRUE;
     }
 
-    task = g_task_new (self, NULL, callback, user_data);
     g_task_set_task_data (task, ctx, g_free);
 
     load_supported_modes_step (task);
@@ -1884,6 +1998,8 @@ modem_load_supported_modes (MMIfaceModem *self,
 /*****************************************************************************/
 /* Supported IP families loading (Modem interface) */
 
+#define INFO_CACHE_KEY_SUPPORTED_IP_FAMILIES "generic-supported-ip-families"
+
 static MMBearerIpFamily
 modem_load_supported_ip_families_finish (MMIfaceModem *self,
                                          GAsyncResult *res,
@@ -1922,8 +2038,12 @@ supported_ip_families_cgdcont_test_ready (MMBaseModem *self,
 
     if (error)
         g_task_return_error (task, error);
-    else
+    else {
+        mm_iface_modem_info_cache_store (MM_IFACE_MODEM (self),
+                                         INFO_CACHE_KEY_SUPPORTED_IP_FAMILIES,
+                                         g_variant_new_uint32 (mask));
         g_task_return_int (task, mask);
+    }
 
     g_object_unref (task);
 }
@@ -1934,6 +2054,7 @@ modem_load_supported_ip_families (MMIfaceModem *self,
                                   gpointer user_data)
 {
     GTask *task;
+    GVariant *cached;
 
     mm_obj_dbg (self, "loading supported IP families...");
     task = g_task_new (self, NULL, callback, user_data);
@@ -1944,6 +2065,14 @@ modem_load_supported_ip_families (MMIfaceModem *self,
         return;
     }
 
+    cached = mm_iface_modem_info_cache_lookup (self, INFO_CACHE_KEY_SUPPORTED_IP_FAMILIES, G_VARIANT_TYPE_UINT32);
+    if (cached) {
+        g_task_return_int (task, g_variant_get_uint32 (cached));
+        g_object_unref (task);
+        g_variant_unref (cached);
+        return;
+    }
+
     /* Query with CGDCONT=? */
     mm_base_modem_at_command (
         MM_BASE_MODEM (self),
@@ -2203,7 +2332,7 @@ signal_quality_cind (GTask *task)
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    MM_PORT_SERIAL_AT (ctx->at_port),
                                    "+CIND?",
-                                   5,
+                                   5000,
                                    FALSE,
                                    FALSE, /* raw */
                                    NULL, /* cancellable */
@@ -3539,7 +3668,7 @@ run_unsolicited_events_setup (GTask *task)
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        port,
                                        command,
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -4822,7 +4951,7 @@ cops_ascii_set_ready (MMBaseModem  *self,
                 mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                                mm_base_modem_peek_best_at_port (MM_BASE_MODEM (self), NULL),
                                                command,
-                                               120,
+                                               120000,
                                                FALSE,
                                                FALSE, /* raw */
                                                g_task_get_cancellable (task),
@@ -4862,7 +4991,7 @@ modem_3gpp_register_in_network (MMIfaceModem3gpp    *self,
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        mm_base_modem_peek_best_at_port (MM_BASE_MODEM (self), NULL),
                                        "+COPS=0",
-                                       120,
+                                       120000,
                                        FALSE,
                                        FALSE, /* raw */
                                        cancellable,
@@ -4880,7 +5009,7 @@ modem_3gpp_register_in_network (MMIfaceModem3gpp    *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    mm_base_modem_peek_best_at_port (MM_BASE_MODEM (self), NULL),
                                    command,
-                                   120,
+                                   120000,
                                    FALSE,
                                    FALSE, /* raw */
                                    cancellable,
@@ -5450,7 +5579,7 @@ unsolicited_registration_events_sequence_ready (MMBroadbandModem *self,
                 MM_BASE_MODEM (self),
                 secondary,
                 g_variant_get_string (command, NULL),
-                3,
+                3000,
                 FALSE,
                 FALSE, /* raw */
                 NULL, /* cancellable */
@@ -7228,8 +7357,18 @@ modem_messaging_enable_unsolicited_events (MMIfaceModemMessaging *self,
 
 typedef struct {
     MMSmsStorage list_storage;
+    MMPortSerialAt *port;
+    /* Number of records processed while the response was being received */
+    guint n_streamed;
 } ListPartsContext;
 
+static void
+list_parts_context_free (ListPartsContext *ctx)
+{
+    g_clear_object (&ctx->port);
+    g_free (ctx);
+}
+
 static gboolean
 modem_messaging_load_initial_sms_parts_finish (MMIfaceModemMessaging *self,
                                                GAsyncResult *res,
@@ -7268,42 +7407,25 @@ sms_pdu_type_from_str (const gchar *str)
     return MM_SMS_PDU_TYPE_UNKNOWN;
 }
 
-static void
-sms_text_part_list_ready (MMBroadbandModem *self,
-                          GAsyncResult *res,
-                          GTask *task)
+/* Returns FALSE if the string doesn't have any +CMGL record */
+static gboolean
+sms_text_part_list_take_parts (MMBroadbandModem *self,
+                               ListPartsContext *ctx,
+                               const gchar      *str)
 {
-    ListPartsContext *ctx;
     GRegex *r;
     GMatchInfo *match_info = NULL;
-    const gchar *response;
-    GError *error = NULL;
-
-    response = mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, &error);
-    if (error) {
-        g_task_return_error (task, error);
-        g_object_unref (task);
-        return;
-    }
 
     /* +CMGL: <index>,<stat>,<oa/da>,[alpha],<scts><CR><LF><data><CR><LF> */
-    r = g_regex_new ("\\+CMGL:\\s*(\\d+)\\s*,\\s*([^,]*),\\s*([^,]*),\\s*([^,]*),\\s*([^\\r\\n]*)\\r\\n([^\\r\\n]*)",
-                     0, 0, NULL);
+    r = mm_regex_get ("\\+CMGL:\\s*(\\d+)\\s*,\\s*([^,]*),\\s*([^,]*),\\s*([^,]*),\\s*([^\\r\\n]*)\\r\\n([^\\r\\n]*)", 0);
     g_assert (r);
 
-    if (!g_regex_match (r, response, 0, &match_info)) {
-        g_task_return_new_error (task,
-                                 MM_CORE_ERROR,
-                                 MM_CORE_ERROR_INVALID_ARGS,
-                                 "Couldn't parse SMS list response");
-        g_object_unref (task);
+    if (!mm_regex_match (r, str, 0, &match_info)) {
         g_match_info_free (match_info);
         g_regex_unref (r);
-        return;
+        return FALSE;
     }
 
-    ctx = g_task_get_task_data (task);
-
     while (g_match_info_matches (match_info)) {
         MMSmsPart *part;
         guint matches, idx;
@@ -7376,6 +7498,37 @@ next:
     }
     g_match_info_free (match_info);
     g_regex_unref (r);
+    return TRUE;
+}
+
+static void
+sms_text_part_list_ready (MMBroadbandModem *self,
+                          GAsyncResult *res,
+                          GTask *task)
+{
+    ListPartsContext *ctx;
+    const gchar *response;
+    GError *error = NULL;
+
+    ctx = g_task_get_task_data (task);
+    mm_port_serial_at_set_stream_handler (ctx->port, NULL, NULL, NULL);
+
+    response = mm_base_modem_at_command_full_finish (MM_BASE_MODEM (self), res, &error);
+    if (error) {
+        g_task_return_error (task, error);
+        g_object_unref (task);
+        return;
+    }
+
+    /* Whatever wasn't already processed while being received */
+    if (!sms_text_part_list_take_parts (self, ctx, response) && !ctx->n_streamed) {
+        g_task_return_new_error (task,
+                                 MM_CORE_ERROR,
+                                 MM_CORE_ERROR_INVALID_ARGS,
+                                 "Couldn't parse SMS list response");
+        g_object_unref (task);
+        return;
+    }
 
     /* We consider all done */
     g_task_return_boolean (task, TRUE);
@@ -7399,6 +7552,44 @@ sms_state_from_index (guint index)
     }
 }
 
+static gboolean
+sms_pdu_part_list_take_parts (MMBroadbandModem  *self,
+                              ListPartsContext  *ctx,
+                              const gchar       *str,
+                              GError           **error)
+{
+    GError *inner_error = NULL;
+    GList *info_list;
+    GList *l;
+
+    info_list = mm_3gpp_parse_pdu_cmgl_response (str, &inner_error);
+    if (inner_error) {
+        g_propagate_error (error, inner_error);
+        return FALSE;
+    }
+
+    for (l = info_list; l; l = g_list_next (l)) {
+        MM3gppPduInfo *info = l->data;
+        MMSmsPart *part;
+
+        part = mm_sms_part_3gpp_new_from_pdu (info->index, info->pdu, self, &inner_error);
+        if (part) {
+            mm_obj_dbg (self, "correctly parsed PDU (%d)", info->index);
+            mm_iface_modem_messaging_take_part (MM_IFACE_MODEM_MESSAGING (self),
+                                                part,
+                                                sms_state_from_index (info->status),
+                                                ctx->list_storage);
+        } else {
+            /* Don't treat the error as critical */
+            mm_obj_dbg (self, "error parsing PDU (%d): %s", info->index, inner_error->message);
+            g_clear_error (&inner_error);
+        }
+    }
+
+    mm_3gpp_pdu_info_list_free (info_list);
+    return TRUE;
+}
+
 static void
 sms_pdu_part_list_ready (MMBroadbandModem *self,
                          GAsyncResult *res,
@@ -7407,51 +7598,64 @@ sms_pdu_part_list_ready (MMBroadbandModem *self,
     ListPartsContext *ctx;
     const gchar *response;
     GError *error = NULL;
-    GList *info_list;
-    GList *l;
+
+    ctx = g_task_get_task_data (task);
+    mm_port_serial_at_set_stream_handler (ctx->port, NULL, NULL, NULL);
 
     /* Always always always unlock mem1 storage. Warned you've been. */
     mm_broadband_modem_unlock_sms_storages (self, TRUE, FALSE);
 
-    response = mm_base_modem_at_command_finish (MM_BASE_MODEM (self), res, &error);
+    response = mm_base_modem_at_command_full_finish (MM_BASE_MODEM (self), res, &error);
     if (error) {
         g_task_return_error (task, error);
         g_object_unref (task);
         return;
     }
 
-    info_list = mm_3gpp_parse_pdu_cmgl_response (response, &error);
-    if (error) {
+    /* Whatever wasn't already processed while being received */
+    if (!sms_pdu_part_list_take_parts (self, ctx, response, &error)) {
         g_task_return_error (task, error);
         g_object_unref (task);
         return;
     }
 
+    /* We consider all done */
+    g_task_return_boolean (task, TRUE);
+    g_object_unref (task);
+}
+
+static gsize
+sms_part_list_stream (MMPortSerialAt *port,
+                      const gchar    *data,
+                      gsize           len,
+                      GTask          *task)
+{
+    MMBroadbandModem *self;
+    ListPartsContext *ctx;
+    gsize             consumed = 0;
+    gsize             record_len;
+
+    self = g_task_get_source_object (task);
     ctx = g_task_get_task_data (task);
 
-    for (l = info_list; l; l = g_list_next (l)) {
-        MM3gppPduInfo *info = l->data;
-        MMSmsPart *part;
+    /* Each complete +CMGL record is processed right away; the final OK is
+     * left for the generic response parser */
+    while ((record_len = mm_3gpp_cmgl_record_len (&data[consumed], len - consumed)) > 0) {
+        g_autofree gchar  *record = NULL;
+        g_autoptr(GError)  error = NULL;
 
-        part = mm_sms_part_3gpp_new_from_pdu (info->index, info->pdu, self, &error);
-        if (part) {
-            mm_obj_dbg (self, "correctly parsed PDU (%d)", info->index);
-            mm_iface_modem_messaging_take_part (MM_IFACE_MODEM_MESSAGING (self),
-                                                part,
-                                                sms_state_from_index (info->status),
-                                                ctx->list_storage);
-        } else {
-            /* Don't treat the error as critical */
-            mm_obj_dbg (self, "error parsing PDU (%d): %s", info->index, error->message);
-            g_clear_error (&error);
-        }
-    }
+        record = g_strndup (&data[consumed], record_len);
+        consumed += record_len;
+        ctx->n_streamed++;
 
-    mm_3gpp_pdu_info_list_free (info_list);
+        if (self->priv->modem_messaging_sms_pdu_mode) {
+            if (!sms_pdu_part_list_take_parts (self, ctx, record, &error))
+                mm_obj_dbg (self, "couldn't parse SMS list record: %s", error->message);
+        } else if (!sms_text_part_list_take_parts (self, ctx, record))
+            mm_obj_dbg (self, "couldn't parse SMS list record");
+    }
 
-    /* We consider all done */
-    g_task_return_boolean (task, TRUE);
-    g_object_unref (task);
+    return consumed;
 }
 
 static void
@@ -7459,6 +7663,8 @@ list_parts_lock_storages_ready (MMBroadbandModem *self,
                                 GAsyncResult *res,
                                 GTask *task)
 {
+    ListPartsContext *ctx;
+    MMPortSerialAt *port;
     GError *error = NULL;
 
     if (!mm_broadband_modem_lock_sms_storages_finish (self, res, &error)) {
@@ -7471,18 +7677,39 @@ list_parts_lock_storages_ready (MMBroadbandModem *self,
 
     /* Storage now set and locked */
 
+    port = mm_base_modem_peek_best_at_port (MM_BASE_MODEM (self), &error);
+    if (!port) {
+        mm_broadband_modem_unlock_sms_storages (self, TRUE, FALSE);
+        g_task_return_error (task, error);
+        g_object_unref (task);
+        return;
+    }
+
+    /* Parts are taken as soon as each of the records in the response is
+     * received, instead of waiting for the whole list, which may be very
+     * long with full storages */
+    ctx = g_task_get_task_data (task);
+    ctx->port = g_object_ref (port);
+    mm_port_serial_at_set_stream_handler (port,
+                                          (MMPortSerialAtStreamFn) sms_part_list_stream,
+                                          g_object_ref (task),
+                                          g_object_unref);
+
     /* Get SMS parts from ALL types.
      * Different command to be used if we are on Text or PDU mode */
-    mm_base_modem_at_command (MM_BASE_MODEM (self),
-                              (MM_BROADBAND_MODEM (self)->priv->modem_messaging_sms_pdu_mode ?
-                               "+CMGL=4" :
-                               "+CMGL=\"ALL\""),
-                              20,
-                              FALSE,
-                              (GAsyncReadyCallback) (MM_BROADBAND_MODEM (self)->priv->modem_messaging_sms_pdu_mode ?
-                                                     sms_pdu_part_list_ready :
-                                                     sms_text_part_list_ready),
-                              task);
+    mm_base_modem_at_command_full (MM_BASE_MODEM (self),
+                                   port,
+                                   (self->priv->modem_messaging_sms_pdu_mode ?
+                                    "+CMGL=4" :
+                                    "+CMGL=\"ALL\""),
+                                   20000,
+                                   FALSE,
+                                   FALSE,
+                                   NULL,
+                                   (GAsyncReadyCallback) (self->priv->modem_messaging_sms_pdu_mode ?
+                                                          sms_pdu_part_list_ready :
+                                                          sms_text_part_list_ready),
+                                   task);
 }
 
 static void
@@ -7494,11 +7721,11 @@ modem_messaging_load_initial_sms_parts (MMIfaceModemMessaging *self,
     ListPartsContext *ctx;
     GTask *task;
 
-    ctx = g_new (ListPartsContext, 1);
+    ctx = g_new0 (ListPartsContext, 1);
     ctx->list_storage = storage;
 
     task = g_task_new (self, NULL, callback, user_data);
-    g_task_set_task_data (task, ctx, g_free);
+    g_task_set_task_data (task, ctx, (GDestroyNotify) list_parts_context_free);
 
     mm_obj_dbg (self, "listing SMS parts in storage '%s'", mm_sms_storage_get_string (storage));
 
@@ -7710,8 +7937,8 @@ set_voice_in_call_unsolicited_events_handlers (MMBroadbandModem *self,
     GRegex         *in_call_event_regex;
     guint           i;
 
-    in_call_event_regex = g_regex_new ("\\r\\n(NO CARRIER|BUSY|NO ANSWER|NO DIALTONE)(\\r)?\\r\\n$",
-                                       G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    in_call_event_regex = mm_regex_get ("\\r\\n(NO CARRIER|BUSY|NO ANSWER|NO DIALTONE)(\\r)?\\r\\n$",
+                                        G_REGEX_RAW | G_REGEX_OPTIMIZE);
 
     ports[0] = MM_PORT_SERIAL_AT (ports_ctx->primary);
     ports[1] = MM_PORT_SERIAL_AT (ports_ctx->secondary);
@@ -8074,7 +8301,7 @@ run_voice_unsolicited_events_setup (GTask *task)
         mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                        port,
                                        command,
-                                       3,
+                                       3000,
                                        FALSE,
                                        FALSE, /* raw */
                                        NULL, /* cancellable */
@@ -9001,10 +9228,10 @@ css_query_ready (MMIfaceModemCdma *self,
         GMatchInfo *match_info;
 
         /* Format is "<band_class>,<band>,<sid>" */
-        r = g_regex_new ("\\s*([^,]*?)\\s*,\\s*([^,]*?)\\s*,\\s*(\\d+)", G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+        r = mm_regex_get ("\\s*([^,]*?)\\s*,\\s*([^,]*?)\\s*,\\s*(\\d+)", G_REGEX_RAW | G_REGEX_OPTIMIZE);
         g_assert (r);
 
-        g_regex_match (r, result, 0, &match_info);
+        mm_regex_match (r, result, 0, &match_info);
         if (g_match_info_get_match_count (match_info) >= 3) {
             gint override_class = 0;
             gchar *str;
@@ -10240,7 +10467,7 @@ enabling_modem_init (MMBroadbandModem *self,
     mm_base_modem_at_command_full (MM_BASE_MODEM (self),
                                    mm_base_modem_peek_port_primary (MM_BASE_MODEM (self)),
                                    "Z",
-                                   6,
+                                   6000,
                                    FALSE,
                                    FALSE,
                                    NULL, /* cancellable */
@@ -12106,6 +12333,9 @@ set_property (GObject *object,
     case PROP_MODEM_PERIODIC_ACCESS_TECH_CHECK_DISABLED:
         self->priv->periodic_access_tech_check_disabled = g_value_get_boolean (value);
         break;
+    case PROP_MODEM_SUPPORTED_BANDS_CACHEABLE:
+        self->priv->supported_bands_cacheable = g_value_get_boolean (value);
+        break;
     case PROP_MODEM_PERIODIC_CALL_LIST_CHECK_DISABLED:
         self->priv->periodic_call_list_check_disabled = g_value_get_boolean (value);
         break;
@@ -12247,6 +12477,9 @@ get_property (GObject *object,
     case PROP_MODEM_PERIODIC_ACCESS_TECH_CHECK_DISABLED:
         g_value_set_boolean (value, self->priv->periodic_access_tech_check_disabled);
         break;
+    case PROP_MODEM_SUPPORTED_BANDS_CACHEABLE:
+        g_value_set_boolean (value, self->priv->supported_bands_cacheable);
+        break;
     case PROP_MODEM_PERIODIC_CALL_LIST_CHECK_DISABLED:
         g_value_set_boolean (value, self->priv->periodic_call_list_check_disabled);
         break;
@@ -12294,6 +12527,7 @@ mm_broadband_modem_init (MMBroadbandModem *self)
     self->priv->sim_hot_swap_supported = FALSE;
     self->priv->periodic_signal_check_disabled = FALSE;
     self->priv->periodic_access_tech_check_disabled = FALSE;
+    self->priv->supported_bands_cacheable = FALSE;
     self->priv->periodic_call_list_check_disabled = FALSE;
     self->priv->modem_cmer_enable_mode = MM_3GPP_CMER_MODE_NONE;
     self->priv->modem_cmer_disable_mode = MM_3GPP_CMER_MODE_NONE;
@@ -12843,6 +13077,10 @@ mm_broadband_modem_class_init (MMBroadbandModemClass *klass)
                                       PROP_MODEM_PERIODIC_ACCESS_TECH_CHECK_DISABLED,
                                       MM_IFACE_MODEM_PERIODIC_ACCESS_TECH_CHECK_DISABLED);
 
+    g_object_class_override_property (object_class,
+                                      PROP_MODEM_SUPPORTED_BANDS_CACHEABLE,
+                                      MM_IFACE_MODEM_SUPPORTED_BANDS_CACHEABLE);
+
     g_object_class_override_property (object_class,
                                       PROP_MODEM_PERIODIC_CALL_LIST_CHECK_DISABLED,
                                       MM_IFACE_MODEM_VOICE_PERIODIC_CALL_LIST_CHECK_DISABLED);
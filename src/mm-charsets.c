@@ -163,11 +163,14 @@ gchar *
 mm_modem_charset_hex_to_utf8 (const gchar    *src,
                               MMModemCharset  charset)
 {
-    const gchar      *iconv_from;
-    g_autofree gchar *unconverted = NULL;
-    g_autofree gchar *converted = NULL;
-    g_autoptr(GError) error = NULL;
-    gsize             unconverted_len = 0;
+    const gchar       *iconv_from;
+    guint8             buffer[256];
+    g_autofree guint8 *allocated = NULL;
+    guint8            *unconverted;
+    g_autofree gchar  *converted = NULL;
+    g_autoptr(GError)  error = NULL;
+    gsize              src_len;
+    gsize              unconverted_len = 0;
 
     g_return_val_if_fail (src != NULL, NULL);
     g_return_val_if_fail (charset != MM_MODEM_CHARSET_UNKNOWN, NULL);
@@ -175,14 +178,29 @@ mm_modem_charset_hex_to_utf8 (const gchar    *src,
     iconv_from = charset_iconv_from (charset);
     g_return_val_if_fail (iconv_from != NULL, FALSE);
 
-    unconverted = mm_utils_hexstr2bin (src, &unconverted_len);
-    if (!unconverted)
-        return NULL;
+    src_len = strlen (src);
 
-    if (charset == MM_MODEM_CHARSET_UTF8 || charset == MM_MODEM_CHARSET_IRA)
-        return g_steal_pointer (&unconverted);
+    /* No conversion needed, just decode into the returned string. Odd length
+     * input is reported as a failure, as for any other invalid hex string. */
+    if (charset == MM_MODEM_CHARSET_UTF8 || charset == MM_MODEM_CHARSET_IRA) {
+        converted = g_malloc (src_len / 2 + 1);
+        if (!mm_utils_hexstr2bin_buf (src, src_len, (guint8 *) converted, src_len / 2, &unconverted_len))
+            return NULL;
+        converted[unconverted_len] = '\0';
+        return g_steal_pointer (&converted);
+    }
 
-    converted = g_convert (unconverted, unconverted_len,
+    /* The binary string is only needed until converted, so don't allocate it
+     * unless it's longer than usual */
+    if (src_len / 2 <= sizeof (buffer))
+        unconverted = buffer;
+    else
+        unconverted = allocated = g_malloc (src_len / 2);
+
+    if (!mm_utils_hexstr2bin_buf (src, src_len, unconverted, src_len / 2, &unconverted_len))
+        return NULL;
+
+    converted = g_convert ((const gchar *) unconverted, unconverted_len,
                            "UTF-8//TRANSLIT", iconv_from,
                            NULL, NULL, &error);
     if (!converted || error)
@@ -317,26 +335,72 @@ gsm_def_char_to_utf8 (const guint8 gsm,
     return gsm_def_utf8_alphabet[gsm].len;
 }
 
+/* Reverse lookup of gsm_def_utf8_alphabet, indexed by the UTF-8 sequence.
+ * Single bytes take the first 256 entries, and two-byte sequences follow, 64
+ * entries per lead byte. The default alphabet has no longer sequences. */
+#define GSM_DEF_REVERSE_LEAD_FIRST 0xc2
+#define GSM_DEF_REVERSE_LEAD_LAST  0xdf
+#define GSM_DEF_REVERSE_SIZE       (256 + (GSM_DEF_REVERSE_LEAD_LAST - GSM_DEF_REVERSE_LEAD_FIRST + 1) * 64)
+#define GSM_DEF_REVERSE_NONE       0xff
+
+static gint
+gsm_def_reverse_index (const guint8 *utf8,
+                       guint32       len)
+{
+    if (len == 1)
+        return utf8[0];
+    if (len == 2 &&
+        utf8[0] >= GSM_DEF_REVERSE_LEAD_FIRST &&
+        utf8[0] <= GSM_DEF_REVERSE_LEAD_LAST &&
+        (utf8[1] & 0xc0) == 0x80)
+        return 256 + ((utf8[0] - GSM_DEF_REVERSE_LEAD_FIRST) * 64) + (utf8[1] & 0x3f);
+    return -1;
+}
+
+static const guint8 *
+gsm_def_reverse_table_get (void)
+{
+    static guint8 table[GSM_DEF_REVERSE_SIZE];
+    static gsize  initialized;
+
+    if (g_once_init_enter (&initialized)) {
+        gint i;
+
+        memset (table, GSM_DEF_REVERSE_NONE, sizeof (table));
+        /* Walk backwards so that the lowest GSM code wins if a sequence were
+         * listed twice */
+        for (i = GSM_DEF_ALPHABET_SIZE - 1; i >= 0; i--) {
+            gint index;
+
+            index = gsm_def_reverse_index ((const guint8 *) gsm_def_utf8_alphabet[i].chars,
+                                           gsm_def_utf8_alphabet[i].len);
+            g_assert (index >= 0);
+            table[index] = (guint8) i;
+        }
+        g_once_init_leave (&initialized, 1);
+    }
+    return table;
+}
+
 static gboolean
 utf8_to_gsm_def_char (const gchar *utf8,
                       guint32      len,
                       guint8      *out_gsm)
 {
-    gint i;
+    gint   index;
+    guint8 gsm;
 
-    if (len > 0 && len < 4) {
-        for (i = 0; i < GSM_DEF_ALPHABET_SIZE; i++) {
-            if (gsm_def_utf8_alphabet[i].len == len) {
-                if (memcmp (&gsm_def_utf8_alphabet[i].chars[0], utf8, len) == 0) {
-                    *out_gsm = i;
-                    return TRUE;
-                }
-            }
-        }
-    }
-    return FALSE;
-}
+    index = gsm_def_reverse_index ((const guint8 *) utf8, len);
+    if (index < 0)
+        return FALSE;
 
+    gsm = gsm_def_reverse_table_get ()[index];
+    if (gsm == GSM_DEF_REVERSE_NONE)
+        return FALSE;
+
+    *out_gsm = gsm;
+    return TRUE;
+}
 
 #define EONE(a, g)        { {a, 0x00, 0x00}, 1, g }
 #define ETHR(a, b, c, g)  { {a, b,    c},    3, g }
@@ -682,40 +746,92 @@ mm_charset_can_convert_to (const gchar    *utf8,
     return TRUE;
 }
 
+/* Septets are packed LSB first, so 8 septets fill exactly 7 octets. Whenever a
+ * septet starts in an octet boundary, the pack and unpack kernels move full
+ * blocks through a 64-bit word instead of going septet by septet. */
+#define GSM_SEPTETS_PER_BLOCK 8
+#define GSM_OCTETS_PER_BLOCK  7
+
+static guint8
+gsm_unpack_septet (const guint8 *gsm,
+                   guint32       start_bit)
+{
+    guint8 offset;
+    guint8 c;
+
+    offset = start_bit % 8;
+    c = gsm[start_bit / 8] >> offset;
+    /* Grab any bits that spilled over to next byte */
+    if (offset > 1)
+        c |= gsm[(start_bit / 8) + 1] << (8 - offset);
+    return c & 0x7F;
+}
+
+static void
+gsm_pack_septet (guint8  *packed,
+                 guint32  start_bit,
+                 guint8   c)
+{
+    guint8 offset;
+
+    offset = start_bit % 8;
+    c &= 0x7F;
+    packed[start_bit / 8] |= c << offset;
+    /* Add the lost bits to next octet */
+    if (offset > 1)
+        packed[(start_bit / 8) + 1] |= c >> (8 - offset);
+}
+
+static void
+gsm_unpack_block (const guint8 *gsm,
+                  guint8       *unpacked)
+{
+    guint64 word = 0;
+    guint   i;
+
+    for (i = 0; i < GSM_OCTETS_PER_BLOCK; i++)
+        word |= ((guint64) gsm[i]) << (8 * i);
+    for (i = 0; i < GSM_SEPTETS_PER_BLOCK; i++)
+        unpacked[i] = (word >> (7 * i)) & 0x7F;
+}
+
+static void
+gsm_pack_block (const guint8 *src,
+                guint8       *packed)
+{
+    guint64 word = 0;
+    guint   i;
+
+    for (i = 0; i < GSM_SEPTETS_PER_BLOCK; i++)
+        word |= ((guint64) (src[i] & 0x7F)) << (7 * i);
+    for (i = 0; i < GSM_OCTETS_PER_BLOCK; i++)
+        packed[i] = (word >> (8 * i)) & 0xFF;
+}
+
 guint8 *
 mm_charset_gsm_unpack (const guint8 *gsm,
                        guint32       num_septets,
                        guint8        start_offset,  /* in _bits_ */
                        guint32      *out_unpacked_len)
 {
-    GByteArray *unpacked;
-    guint i;
+    guint8  *unpacked;
+    guint32  i = 0;
 
-    unpacked = g_byte_array_sized_new (num_septets + 1);
+    unpacked = g_malloc (num_septets + 1);
 
-    for (i = 0; i < num_septets; i++) {
-        guint8 bits_here, bits_in_next, octet, offset, c;
-        guint32 start_bit;
+    /* Septet by septet until one starts in an octet boundary */
+    for (; i < num_septets && ((start_offset + (i * 7)) % 8) != 0; i++)
+        unpacked[i] = gsm_unpack_septet (gsm, start_offset + (i * 7));
 
-        start_bit = start_offset + (i * 7); /* Overall bit offset of char in buffer */
-        offset = start_bit % 8;  /* Offset to start of char in this byte */
-        bits_here = offset ? (8 - offset) : 7;
-        bits_in_next = 7 - bits_here;
+    for (; num_septets - i >= GSM_SEPTETS_PER_BLOCK; i += GSM_SEPTETS_PER_BLOCK)
+        gsm_unpack_block (&gsm[(start_offset + (i * 7)) / 8], &unpacked[i]);
 
-        /* Grab bits in the current byte */
-        octet = gsm[start_bit / 8];
-        c = (octet >> offset) & (0xFF >> (8 - bits_here));
+    for (; i < num_septets; i++)
+        unpacked[i] = gsm_unpack_septet (gsm, start_offset + (i * 7));
 
-        /* Grab any bits that spilled over to next byte */
-        if (bits_in_next) {
-            octet = gsm[(start_bit / 8) + 1];
-            c |= (octet & (0xFF >> (8 - bits_in_next))) << bits_here;
-        }
-        g_byte_array_append (unpacked, &c, 1);
-    }
-
-    *out_unpacked_len = unpacked->len;
-    return g_byte_array_free (unpacked, FALSE);
+    unpacked[num_septets] = 0;
+    *out_unpacked_len = num_septets;
+    return unpacked;
 }
 
 guint8 *
@@ -725,7 +841,7 @@ mm_charset_gsm_pack (const guint8 *src,
                      guint32      *out_packed_len)
 {
     guint8 *packed;
-    guint octet = 0, lshift, plen;
+    guint plen;
     guint i = 0;
 
     g_return_val_if_fail (start_offset < 8, NULL);
@@ -737,17 +853,15 @@ mm_charset_gsm_pack (const guint8 *src,
 
     packed = g_malloc0 (plen);
 
-    for (i = 0, lshift = start_offset; i < src_len; i++) {
-        packed[octet] |= (src[i] & 0x7F) << lshift;
-        if (lshift > 1) {
-            /* Grab the lost bits and add to next octet */
-            g_assert (octet + 1 < plen);
-            packed[octet + 1] = (src[i] & 0x7F) >> (8 - lshift);
-        }
-        if (lshift)
-            octet++;
-        lshift = lshift ? lshift - 1 : 7;
-    }
+    /* Septet by septet until one starts in an octet boundary */
+    for (; i < src_len && ((start_offset + (i * 7)) % 8) != 0; i++)
+        gsm_pack_septet (packed, start_offset + (i * 7), src[i]);
+
+    for (; src_len - i >= GSM_SEPTETS_PER_BLOCK; i += GSM_SEPTETS_PER_BLOCK)
+        gsm_pack_block (&src[i], &packed[(start_offset + (i * 7)) / 8]);
+
+    for (; i < src_len; i++)
+        gsm_pack_septet (packed, start_offset + (i * 7), src[i]);
 
     if (out_packed_len)
         *out_packed_len = plen;
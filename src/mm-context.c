@@ -41,6 +41,7 @@ static gboolean      debug;
 static MMFilterRule  filter_policy = MM_FILTER_POLICY_STRICT;
 static gboolean      no_auto_scan = NO_AUTO_SCAN_DEFAULT;
 static const gchar  *initial_kernel_events;
+static gint          probing_limit;
 
 static gboolean
 filter_policy_option_arg (const gchar  *option_name,
@@ -90,6 +91,11 @@ static const GOptionEntry entries[] = {
         "Path to initial kernel events file",
         "[PATH]"
     },
+    {
+        "probing-limit", 0, 0, G_OPTION_ARG_INT, &probing_limit,
+        "Maximum number of ports being probed at the same time, 0 for no limit",
+        "[N]"
+    },
     {
         "debug", 0, 0, G_OPTION_ARG_NONE, &debug,
         "Run with extended debugging capabilities",
@@ -126,6 +132,12 @@ mm_context_get_no_auto_scan (void)
     return no_auto_scan;
 }
 
+guint
+mm_context_get_probing_limit (void)
+{
+    return (guint) MAX (probing_limit, 0);
+}
+
 MMFilterRule
 mm_context_get_filter_policy (void)
 {
@@ -136,10 +148,16 @@ mm_context_get_filter_policy (void)
 /* Log context */
 
 static const gchar *log_level;
+static const gchar *log_filter;
 static const gchar *log_file;
+static gint         log_file_max_size;
+static gint         log_flush_interval = 1000;
 static gboolean     log_journal;
 static gboolean     log_show_ts;
 static gboolean     log_rel_ts;
+static const gchar *serial_capture_dir;
+static const gchar *serial_capture_ports;
+static gint         serial_capture_max_size;
 
 static const GOptionEntry log_entries[] = {
     {
@@ -147,11 +165,26 @@ static const GOptionEntry log_entries[] = {
         "Log level: one of ERR, WARN, INFO, DEBUG",
         "[LEVEL]"
     },
+    {
+        "log-filter", 0, 0, G_OPTION_ARG_STRING, &log_filter,
+        "Log level of specific modules or objects, e.g. 'modem0=DEBUG,shared-telit=DEBUG'",
+        "[NAME=LEVEL,...]"
+    },
     {
         "log-file", 0, 0, G_OPTION_ARG_FILENAME, &log_file,
         "Path to log file",
         "[PATH]"
     },
+    {
+        "log-file-max-size", 0, 0, G_OPTION_ARG_INT, &log_file_max_size,
+        "Maximum size of the log file in KiB before it's rotated (0 for unlimited)",
+        "[SIZE]"
+    },
+    {
+        "log-flush-interval", 0, 0, G_OPTION_ARG_INT, &log_flush_interval,
+        "Maximum time in ms before logged messages are synced to disk (0 to sync right away)",
+        "[MS]"
+    },
 #if defined WITH_SYSTEMD_JOURNAL
     {
         "log-journal", 0, 0, G_OPTION_ARG_NONE, &log_journal,
@@ -169,6 +202,21 @@ static const GOptionEntry log_entries[] = {
         "Use relative timestamps (from MM start)",
         NULL
     },
+    {
+        "serial-capture-dir", 0, 0, G_OPTION_ARG_FILENAME, &serial_capture_dir,
+        "Directory where to store binary captures of the serial port traffic",
+        "[PATH]"
+    },
+    {
+        "serial-capture-ports", 0, 0, G_OPTION_ARG_STRING, &serial_capture_ports,
+        "Serial ports to capture, e.g. 'ttyUSB2,ttyUSB3' (default: all)",
+        "[PORT,...]"
+    },
+    {
+        "serial-capture-max-size", 0, 0, G_OPTION_ARG_INT, &serial_capture_max_size,
+        "Maximum size of each capture file in KiB before it's rotated (0 for unlimited)",
+        "[SIZE]"
+    },
     { NULL }
 };
 
@@ -192,12 +240,30 @@ mm_context_get_log_level (void)
     return log_level;
 }
 
+const gchar *
+mm_context_get_log_filter (void)
+{
+    return log_filter;
+}
+
 const gchar *
 mm_context_get_log_file (void)
 {
     return log_file;
 }
 
+guint64
+mm_context_get_log_file_max_size (void)
+{
+    return (guint64) MAX (log_file_max_size, 0) * 1024;
+}
+
+guint
+mm_context_get_log_flush_interval (void)
+{
+    return (guint) MAX (log_flush_interval, 0);
+}
+
 gboolean
 mm_context_get_log_journal (void)
 {
@@ -216,6 +282,24 @@ mm_context_get_log_relative_timestamps (void)
     return log_rel_ts;
 }
 
+const gchar *
+mm_context_get_serial_capture_dir (void)
+{
+    return serial_capture_dir;
+}
+
+const gchar *
+mm_context_get_serial_capture_ports (void)
+{
+    return serial_capture_ports;
+}
+
+guint64
+mm_context_get_serial_capture_max_size (void)
+{
+    return (guint64) MAX (serial_capture_max_size, 0) * 1024;
+}
+
 /*****************************************************************************/
 /* Test context */
 
@@ -31,16 +31,23 @@ void mm_context_init (gint    argc,
 gboolean     mm_context_get_debug                 (void);
 const gchar *mm_context_get_initial_kernel_events (void);
 gboolean     mm_context_get_no_auto_scan          (void);
+guint        mm_context_get_probing_limit         (void);
 
 /* Filter support */
 MMFilterRule mm_context_get_filter_policy (void);
 
 /* Logging support */
 const gchar *mm_context_get_log_level               (void);
+const gchar *mm_context_get_log_filter              (void);
 const gchar *mm_context_get_log_file                (void);
+guint64      mm_context_get_log_file_max_size       (void);
+guint        mm_context_get_log_flush_interval      (void);
 gboolean     mm_context_get_log_journal             (void);
 gboolean     mm_context_get_log_timestamps          (void);
 gboolean     mm_context_get_log_relative_timestamps (void);
+const gchar *mm_context_get_serial_capture_dir      (void);
+const gchar *mm_context_get_serial_capture_ports    (void);
+guint64      mm_context_get_serial_capture_max_size (void);
 
 /* Testing support */
 gboolean     mm_context_get_test_session    (void);
@@ -0,0 +1,103 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <string.h>
+
+#include "mm-gps-epoch.h"
+
+/* NMEA traces reported once per fix (GGA, RMC) or at least once per fix (GSA),
+ * used to find out when the receiver has reported a whole epoch */
+#define NMEA_EPOCH_GGA (1 << 0)
+#define NMEA_EPOCH_RMC (1 << 1)
+#define NMEA_EPOCH_GSA (1 << 2)
+#define NMEA_EPOCH_ALL (NMEA_EPOCH_GGA | NMEA_EPOCH_RMC | NMEA_EPOCH_GSA)
+
+/* Fixes are received with some jitter, so allow publishing them a bit earlier
+ * than the refresh rate says; otherwise a rate matching the rate at which the
+ * receiver computes fixes would end up skipping every other one. */
+#define GPS_REFRESH_MAX_JITTER_MS 50
+
+/*****************************************************************************/
+
+void
+mm_gps_epoch_init (MMGpsEpoch *epoch)
+{
+    memset (epoch, 0, sizeof (MMGpsEpoch));
+    /* Until we learn what the receiver reports */
+    epoch->expected = NMEA_EPOCH_ALL;
+}
+
+static guint
+nmea_trace_get_epoch_type (const gchar *trace)
+{
+    /* $<talker><type>, e.g. $GPGGA or $GNRMC */
+    if (trace[0] != '$' || strlen (trace) < 7 || trace[6] != ',')
+        return 0;
+    if (strncmp (&trace[3], "GGA", 3) == 0)
+        return NMEA_EPOCH_GGA;
+    if (strncmp (&trace[3], "RMC", 3) == 0)
+        return NMEA_EPOCH_RMC;
+    if (strncmp (&trace[3], "GSA", 3) == 0)
+        return NMEA_EPOCH_GSA;
+    return 0;
+}
+
+gboolean
+mm_gps_epoch_add_trace (MMGpsEpoch  *epoch,
+                        const gchar *nmea_trace)
+{
+    guint type;
+
+    type = nmea_trace_get_epoch_type (nmea_trace);
+    if (!type)
+        return !epoch->tracking;
+
+    epoch->tracking = TRUE;
+
+    /* GGA and RMC are reported once per fix, and GSA once per fix or once per
+     * constellation in a row, so getting one of them again means that a new
+     * epoch started, whatever the order in which the receiver reports them.
+     * The traces received in the last epoch are the ones the receiver reports,
+     * e.g. not all of them give GSA. */
+    if ((epoch->seen & type) && !(type == NMEA_EPOCH_GSA && epoch->last == NMEA_EPOCH_GSA)) {
+        epoch->expected = epoch->seen;
+        epoch->seen = 0;
+        epoch->complete = FALSE;
+    }
+
+    epoch->last = type;
+    epoch->seen |= type;
+    if (epoch->complete ||
+        (epoch->seen & epoch->expected) != epoch->expected)
+        return FALSE;
+
+    epoch->complete = TRUE;
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+gboolean
+mm_gps_refresh_due (gint64 last_time,
+                    gint64 now,
+                    guint  rate_ms)
+{
+    gint64 jitter_ms;
+
+    if (last_time == 0)
+        return TRUE;
+
+    jitter_ms = MIN (rate_ms / 10, GPS_REFRESH_MAX_JITTER_MS);
+    return (now - last_time) >= (((gint64) rate_ms - jitter_ms) * 1000);
+}
@@ -0,0 +1,45 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_GPS_EPOCH_H
+#define MM_GPS_EPOCH_H
+
+#include <glib.h>
+
+/* Tracks the NMEA traces reported by a GPS receiver for each fix (epoch), so
+ * that location updates are published once the whole fix has been received.
+ * Epochs are delimited by the GGA, RMC and GSA traces; the ones expected in
+ * an epoch are learned from what the receiver reported in the previous one. */
+
+typedef struct {
+    gboolean tracking;
+    guint    seen;
+    guint    expected;
+    guint    last;
+    gboolean complete;
+} MMGpsEpoch;
+
+void     mm_gps_epoch_init      (MMGpsEpoch  *epoch);
+
+/* Returns TRUE if the trace completes the current epoch. Receivers not
+ * reporting any of the epoch traces get every trace considered an epoch. */
+gboolean mm_gps_epoch_add_trace (MMGpsEpoch  *epoch,
+                                 const gchar *nmea_trace);
+
+/* Whether an update is due, given the monotonic times in microseconds of the
+ * last update (0 if none) and of now, and the refresh rate in milliseconds. */
+gboolean mm_gps_refresh_due     (gint64       last_time,
+                                 gint64       now,
+                                 guint        rate_ms);
+
+#endif /* MM_GPS_EPOCH_H */
@@ -23,6 +23,7 @@
 #include "mm-iface-modem-location.h"
 #include "mm-log-object.h"
 #include "mm-modem-helpers.h"
+#include "mm-gps-epoch.h"
 
 #define MM_LOCATION_GPS_REFRESH_TIME_SECS 30
 
@@ -40,21 +41,41 @@ mm_iface_modem_location_bind_simple_status (MMIfaceModemLocation *self,
 
 /*****************************************************************************/
 
+/* Sources published in the Location property, in the order they're added to
+ * the dictionary */
+static const MMModemLocationSource published_sources[] = {
+    MM_MODEM_LOCATION_SOURCE_3GPP_LAC_CI,
+    MM_MODEM_LOCATION_SOURCE_GPS_NMEA,
+    MM_MODEM_LOCATION_SOURCE_GPS_RAW,
+    MM_MODEM_LOCATION_SOURCE_CDMA_BS,
+};
+
+#define N_PUBLISHED_SOURCES G_N_ELEMENTS (published_sources)
+
 typedef struct {
     /* 3GPP location */
     MMLocation3gpp *location_3gpp;
-    /* GPS location */
-    time_t location_gps_nmea_last_time;
+    /* GPS location; last times are monotonic */
+    gint64 location_gps_nmea_last_time;
+    gboolean location_gps_nmea_pending;
     MMLocationGpsNmea *location_gps_nmea;
-    time_t location_gps_raw_last_time;
+    gint64 location_gps_raw_last_time;
+    gboolean location_gps_raw_pending;
     MMLocationGpsRaw *location_gps_raw;
+    /* GPS epoch tracking */
+    MMGpsEpoch gps_epoch;
     /* CDMA BS location */
     MMLocationCdmaBs *location_cdma_bs;
+    /* Values in the Location property, indexed as published_sources */
+    gboolean published_loaded;
+    GVariant *published[N_PUBLISHED_SOURCES];
 } LocationContext;
 
 static void
 location_context_free (LocationContext *ctx)
 {
+    guint i;
+
     if (ctx->location_3gpp)
         g_object_unref (ctx->location_3gpp);
     if (ctx->location_gps_nmea)
@@ -63,6 +84,10 @@ location_context_free (LocationContext *ctx)
         g_object_unref (ctx->location_gps_raw);
     if (ctx->location_cdma_bs)
         g_object_unref (ctx->location_cdma_bs);
+    for (i = 0; i < N_PUBLISHED_SOURCES; i++) {
+        if (ctx->published[i])
+            g_variant_unref (ctx->published[i]);
+    }
     g_free (ctx);
 }
 
@@ -92,6 +117,7 @@ get_location_context (MMIfaceModemLocation *self)
     if (!ctx) {
         /* Create context and keep it as object data */
         ctx = g_new0 (LocationContext, 1);
+        mm_gps_epoch_init (&ctx->gps_epoch);
 
         g_object_set_qdata_full (
             G_OBJECT (self),
@@ -105,158 +131,174 @@ get_location_context (MMIfaceModemLocation *self)
 
 /*****************************************************************************/
 
+static gboolean
+location_context_has_source (LocationContext       *ctx,
+                             MMModemLocationSource  source)
+{
+    switch (source) {
+    case MM_MODEM_LOCATION_SOURCE_3GPP_LAC_CI:
+        return !!ctx->location_3gpp;
+    case MM_MODEM_LOCATION_SOURCE_GPS_NMEA:
+        return !!ctx->location_gps_nmea;
+    case MM_MODEM_LOCATION_SOURCE_GPS_RAW:
+        return !!ctx->location_gps_raw;
+    case MM_MODEM_LOCATION_SOURCE_CDMA_BS:
+        return !!ctx->location_cdma_bs;
+    case MM_MODEM_LOCATION_SOURCE_NONE:
+    case MM_MODEM_LOCATION_SOURCE_GPS_UNMANAGED:
+    case MM_MODEM_LOCATION_SOURCE_AGPS_MSA:
+    case MM_MODEM_LOCATION_SOURCE_AGPS_MSB:
+    default:
+        g_assert_not_reached ();
+    }
+}
+
 static GVariant *
-build_location_dictionary (GVariant *previous,
-                           MMLocation3gpp *location_3gpp,
-                           MMLocationGpsNmea *location_gps_nmea,
-                           MMLocationGpsRaw *location_gps_raw,
-                           MMLocationCdmaBs *location_cdma_bs)
-{
-    GVariant *location_3gpp_value = NULL;
-    GVariant *location_gps_nmea_value = NULL;
-    GVariant *location_gps_raw_value = NULL;
-    GVariant *location_cdma_bs_value = NULL;
+build_location_source_value (LocationContext       *ctx,
+                             MMModemLocationSource  source)
+{
+    switch (source) {
+    case MM_MODEM_LOCATION_SOURCE_3GPP_LAC_CI:
+        return ctx->location_3gpp ? mm_location_3gpp_get_string_variant (ctx->location_3gpp) : NULL;
+    case MM_MODEM_LOCATION_SOURCE_GPS_NMEA:
+        return ctx->location_gps_nmea ? mm_location_gps_nmea_get_string_variant (ctx->location_gps_nmea) : NULL;
+    case MM_MODEM_LOCATION_SOURCE_GPS_RAW:
+        return ctx->location_gps_raw ? mm_location_gps_raw_get_dictionary (ctx->location_gps_raw) : NULL;
+    case MM_MODEM_LOCATION_SOURCE_CDMA_BS:
+        return ctx->location_cdma_bs ? mm_location_cdma_bs_get_dictionary (ctx->location_cdma_bs) : NULL;
+    case MM_MODEM_LOCATION_SOURCE_NONE:
+    case MM_MODEM_LOCATION_SOURCE_GPS_UNMANAGED:
+    case MM_MODEM_LOCATION_SOURCE_AGPS_MSA:
+    case MM_MODEM_LOCATION_SOURCE_AGPS_MSB:
+    default:
+        g_assert_not_reached ();
+    }
+}
+
+static GVariant *
+build_location_dictionary (GVariant **values)
+{
     GVariantBuilder builder;
+    guint           i;
 
-    /* If a previous dictionary given, parse its values */
-    if (previous) {
-        guint source;
-        GVariant *value;
-        GVariantIter iter;
-
-        g_variant_iter_init (&iter, previous);
-        while (g_variant_iter_next (&iter, "{uv}", &source, &value)) {
-            switch (source) {
-            case MM_MODEM_LOCATION_SOURCE_3GPP_LAC_CI:
-                g_assert (!location_3gpp_value);
-                location_3gpp_value = value;
-                break;
-            case MM_MODEM_LOCATION_SOURCE_GPS_NMEA:
-                g_assert (!location_gps_nmea_value);
-                location_gps_nmea_value = value;
-                break;
-            case MM_MODEM_LOCATION_SOURCE_GPS_RAW:
-                g_assert (!location_gps_raw_value);
-                location_gps_raw_value = value;
-                break;
-            case MM_MODEM_LOCATION_SOURCE_CDMA_BS:
-                g_assert (!location_cdma_bs_value);
-                location_cdma_bs_value = value;
-                break;
-            case MM_MODEM_LOCATION_SOURCE_GPS_UNMANAGED:
-                g_assert_not_reached ();
-            case MM_MODEM_LOCATION_SOURCE_AGPS_MSA:
-                g_assert_not_reached ();
-            case MM_MODEM_LOCATION_SOURCE_AGPS_MSB:
-                g_assert_not_reached ();
-            default:
-                g_warn_if_reached ();
-                g_variant_unref (value);
-                break;
-            }
+    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{uv}"));
+
+    for (i = 0; values && i < N_PUBLISHED_SOURCES; i++) {
+        if (values[i]) {
+            g_assert (!g_variant_is_floating (values[i]));
+            g_variant_builder_add (&builder, "{uv}", published_sources[i], values[i]);
         }
     }
 
-    /* Build the new one */
-    g_variant_builder_init (&builder, G_VARIANT_TYPE ("a{uv}"));
+    return g_variant_builder_end (&builder);
+}
 
-    /* If a new one given, use it */
-    if (location_3gpp) {
-        if (location_3gpp_value)
-            g_variant_unref (location_3gpp_value);
-        location_3gpp_value = mm_location_3gpp_get_string_variant (location_3gpp);
-    }
+static void
+load_published_location (LocationContext      *ctx,
+                         MmGdbusModemLocation *skeleton)
+{
+    GVariant     *previous;
+    GVariantIter  iter;
+    guint         source;
+    GVariant     *value;
 
-    if (location_3gpp_value) {
-        g_assert (!g_variant_is_floating (location_3gpp_value));
-        g_variant_builder_add (&builder,
-                               "{uv}",
-                               MM_MODEM_LOCATION_SOURCE_3GPP_LAC_CI,
-                               location_3gpp_value);
-        g_variant_unref (location_3gpp_value);
-    }
+    if (ctx->published_loaded)
+        return;
+    ctx->published_loaded = TRUE;
 
-    /* If a new one given, use it */
-    if (location_gps_nmea) {
-        if (location_gps_nmea_value)
-            g_variant_unref (location_gps_nmea_value);
-        location_gps_nmea_value = mm_location_gps_nmea_get_string_variant (location_gps_nmea);
-    }
+    /* The property may have values from before this context was created */
+    previous = mm_gdbus_modem_location_get_location (skeleton);
+    if (!previous)
+        return;
 
-    if (location_gps_nmea_value) {
-        g_assert (!g_variant_is_floating (location_gps_nmea_value));
-        g_variant_builder_add (&builder,
-                               "{uv}",
-                               MM_MODEM_LOCATION_SOURCE_GPS_NMEA,
-                               location_gps_nmea_value);
-        g_variant_unref (location_gps_nmea_value);
-    }
+    g_variant_iter_init (&iter, previous);
+    while (g_variant_iter_next (&iter, "{uv}", &source, &value)) {
+        guint i;
 
-    /* If a new one given, use it */
-    if (location_gps_raw) {
-        if (location_gps_raw_value)
-            g_variant_unref (location_gps_raw_value);
-        location_gps_raw_value = mm_location_gps_raw_get_dictionary (location_gps_raw);
+        for (i = 0; i < N_PUBLISHED_SOURCES; i++) {
+            if (published_sources[i] == source)
+                break;
+        }
+        if (i == N_PUBLISHED_SOURCES) {
+            g_warn_if_reached ();
+            g_variant_unref (value);
+            continue;
+        }
+        if (ctx->published[i])
+            g_variant_unref (ctx->published[i]);
+        ctx->published[i] = value;
     }
+}
 
-    if (location_gps_raw_value) {
-        g_assert (!g_variant_is_floating (location_gps_raw_value));
-        g_variant_builder_add (&builder,
-                               "{uv}",
-                               MM_MODEM_LOCATION_SOURCE_GPS_RAW,
-                               location_gps_raw_value);
-        g_variant_unref (location_gps_raw_value);
-    }
+static void
+clear_published_location (MMIfaceModemLocation *self,
+                          MmGdbusModemLocation *skeleton)
+{
+    LocationContext *ctx;
+    guint            i;
 
-    /* If a new one given, use it */
-    if (location_cdma_bs) {
-        if (location_cdma_bs_value)
-            g_variant_unref (location_cdma_bs_value);
-        location_cdma_bs_value = mm_location_cdma_bs_get_dictionary (location_cdma_bs);
-    }
+    ctx = get_location_context (self);
+    ctx->published_loaded = TRUE;
+    for (i = 0; i < N_PUBLISHED_SOURCES; i++)
+        g_clear_pointer (&ctx->published[i], g_variant_unref);
+
+    mm_gdbus_modem_location_set_location (skeleton, build_location_dictionary (ctx->published));
+}
+
+/* Only the values of the given sources are rebuilt, the ones of all the other
+ * sources are reused as they were */
+static void
+publish_location (MMIfaceModemLocation  *self,
+                  MmGdbusModemLocation  *skeleton,
+                  MMModemLocationSource  sources)
+{
+    LocationContext *ctx;
+    guint            i;
+
+    ctx = get_location_context (self);
+    load_published_location (ctx, skeleton);
+
+    for (i = 0; i < N_PUBLISHED_SOURCES; i++) {
+        GVariant *value;
+
+        if (!(sources & published_sources[i]))
+            continue;
+
+        /* Sources without location object keep their previous value */
+        if (!location_context_has_source (ctx, published_sources[i]))
+            continue;
 
-    if (location_cdma_bs_value) {
-        g_assert (!g_variant_is_floating (location_cdma_bs_value));
-        g_variant_builder_add (&builder,
-                               "{uv}",
-                               MM_MODEM_LOCATION_SOURCE_CDMA_BS,
-                               location_cdma_bs_value);
-        g_variant_unref (location_cdma_bs_value);
+        value = build_location_source_value (ctx, published_sources[i]);
+        if (ctx->published[i])
+            g_variant_unref (ctx->published[i]);
+        ctx->published[i] = value;
     }
 
-    return g_variant_builder_end (&builder);
+    mm_gdbus_modem_location_set_location (skeleton, build_location_dictionary (ctx->published));
 }
 
 /*****************************************************************************/
 
 static void
-notify_gps_location_update (MMIfaceModemLocation *self,
-                            MmGdbusModemLocation *skeleton,
-                            MMLocationGpsNmea *location_gps_nmea,
-                            MMLocationGpsRaw *location_gps_raw)
+notify_gps_location_update (MMIfaceModemLocation  *self,
+                            MmGdbusModemLocation  *skeleton,
+                            MMModemLocationSource  sources)
 {
     mm_obj_dbg (self, "GPS location updated");
 
     /* We only update the property if we are supposed to signal
      * location */
     if (mm_gdbus_modem_location_get_signals_location (skeleton))
-        mm_gdbus_modem_location_set_location (
-            skeleton,
-            build_location_dictionary (mm_gdbus_modem_location_get_location (skeleton),
-                                       NULL,
-                                       location_gps_nmea,
-                                       location_gps_raw,
-                                       NULL));
+        publish_location (self, skeleton, sources);
 }
 
 static void
 location_gps_update_nmea (MMIfaceModemLocation *self,
                           const gchar          *nmea_trace)
 {
-    MmGdbusModemLocation *skeleton;
-    LocationContext      *ctx;
-    gboolean              update_nmea = FALSE;
-    gboolean              update_raw = FALSE;
+    MmGdbusModemLocation  *skeleton;
+    LocationContext       *ctx;
+    MMModemLocationSource  updated = MM_MODEM_LOCATION_SOURCE_NONE;
 
     ctx = get_location_context (self);
     g_object_get (self,
@@ -267,29 +309,41 @@ location_gps_update_nmea (MMIfaceModemLocation *self,
 
     if (mm_gdbus_modem_location_get_enabled (skeleton) & MM_MODEM_LOCATION_SOURCE_GPS_NMEA) {
         g_assert (ctx->location_gps_nmea != NULL);
-        if (mm_location_gps_nmea_add_trace (ctx->location_gps_nmea, nmea_trace) &&
-            (ctx->location_gps_nmea_last_time == 0 ||
-             time (NULL) - ctx->location_gps_nmea_last_time >= (glong)mm_gdbus_modem_location_get_gps_refresh_rate (skeleton))) {
-            ctx->location_gps_nmea_last_time = time (NULL);
-            update_nmea = TRUE;
-        }
+        if (mm_location_gps_nmea_add_trace (ctx->location_gps_nmea, nmea_trace))
+            ctx->location_gps_nmea_pending = TRUE;
     }
 
     if (mm_gdbus_modem_location_get_enabled (skeleton) & MM_MODEM_LOCATION_SOURCE_GPS_RAW) {
         g_assert (ctx->location_gps_raw != NULL);
-        if (mm_location_gps_raw_add_trace (ctx->location_gps_raw, nmea_trace) &&
-            (ctx->location_gps_raw_last_time == 0 ||
-             time (NULL) - ctx->location_gps_raw_last_time >= (glong)mm_gdbus_modem_location_get_gps_refresh_rate (skeleton))) {
-            ctx->location_gps_raw_last_time = time (NULL);
-            update_raw = TRUE;
+        if (mm_location_gps_raw_add_trace (ctx->location_gps_raw, nmea_trace))
+            ctx->location_gps_raw_pending = TRUE;
+    }
+
+    /* Updates are only published once the whole fix has been received */
+    if (mm_gps_epoch_add_trace (&ctx->gps_epoch, nmea_trace)) {
+        gint64 now;
+        guint  rate_ms;
+
+        now = g_get_monotonic_time ();
+        rate_ms = mm_gdbus_modem_location_get_gps_refresh_rate_ms (skeleton);
+
+        if (ctx->location_gps_nmea_pending &&
+            mm_gps_refresh_due (ctx->location_gps_nmea_last_time, now, rate_ms)) {
+            ctx->location_gps_nmea_last_time = now;
+            ctx->location_gps_nmea_pending = FALSE;
+            updated |= MM_MODEM_LOCATION_SOURCE_GPS_NMEA;
+        }
+
+        if (ctx->location_gps_raw_pending &&
+            mm_gps_refresh_due (ctx->location_gps_raw_last_time, now, rate_ms)) {
+            ctx->location_gps_raw_last_time = now;
+            ctx->location_gps_raw_pending = FALSE;
+            updated |= MM_MODEM_LOCATION_SOURCE_GPS_RAW;
         }
     }
 
-    if (update_nmea || update_raw)
-        notify_gps_location_update (self,
-                                    skeleton,
-                                    update_nmea ? ctx->location_gps_nmea : NULL,
-                                    update_raw ? ctx->location_gps_raw : NULL);
+    if (updated != MM_MODEM_LOCATION_SOURCE_NONE)
+        notify_gps_location_update (self, skeleton, updated);
 
     g_object_unref (skeleton);
 }
@@ -356,12 +410,7 @@ notify_3gpp_location_update (MMIfaceModemLocation *self,
     /* We only update the property if we are supposed to signal
      * location */
     if (mm_gdbus_modem_location_get_signals_location (skeleton))
-        mm_gdbus_modem_location_set_location (
-            skeleton,
-            build_location_dictionary (mm_gdbus_modem_location_get_location (skeleton),
-                                       location_3gpp,
-                                       NULL, NULL,
-                                       NULL));
+        publish_location (self, skeleton, MM_MODEM_LOCATION_SOURCE_3GPP_LAC_CI);
 }
 
 void
@@ -498,12 +547,7 @@ notify_cdma_bs_location_update (MMIfaceModemLocation *self,
     /* We only update the property if we are supposed to signal
      * location */
     if (mm_gdbus_modem_location_get_signals_location (skeleton))
-        mm_gdbus_modem_location_set_location (
-            skeleton,
-            build_location_dictionary (mm_gdbus_modem_location_get_location (skeleton),
-                                       NULL,
-                                       NULL, NULL,
-                                       location_cdma_bs));
+        publish_location (self, skeleton, MM_MODEM_LOCATION_SOURCE_CDMA_BS);
 }
 
 void
@@ -576,15 +620,21 @@ update_location_source_status (MMIfaceModemLocation *self,
         if (enabled) {
             if (!ctx->location_gps_nmea)
                 ctx->location_gps_nmea = mm_location_gps_nmea_new ();
-        } else
+        } else {
             g_clear_object (&ctx->location_gps_nmea);
+            ctx->location_gps_nmea_pending = FALSE;
+            ctx->location_gps_nmea_last_time = 0;
+        }
         break;
     case MM_MODEM_LOCATION_SOURCE_GPS_RAW:
         if (enabled) {
             if (!ctx->location_gps_raw)
                 ctx->location_gps_raw = mm_location_gps_raw_new ();
-        } else
+        } else {
             g_clear_object (&ctx->location_gps_raw);
+            ctx->location_gps_raw_pending = FALSE;
+            ctx->location_gps_raw_last_time = 0;
+        }
         break;
     case MM_MODEM_LOCATION_SOURCE_CDMA_BS:
         if (enabled) {
@@ -974,17 +1024,14 @@ handle_setup_auth_ready (MMBaseModem *self,
         mm_gdbus_modem_location_set_signals_location (ctx->skeleton,
                                                       ctx->signal_location);
         if (ctx->signal_location)
-            mm_gdbus_modem_location_set_location (
-                ctx->skeleton,
-                build_location_dictionary (mm_gdbus_modem_location_get_location (ctx->skeleton),
-                                           location_ctx->location_3gpp,
-                                           location_ctx->location_gps_nmea,
-                                           location_ctx->location_gps_raw,
-                                           location_ctx->location_cdma_bs));
+            publish_location (ctx->self,
+                              ctx->skeleton,
+                              (MM_MODEM_LOCATION_SOURCE_3GPP_LAC_CI |
+                               MM_MODEM_LOCATION_SOURCE_GPS_NMEA |
+                               MM_MODEM_LOCATION_SOURCE_GPS_RAW |
+                               MM_MODEM_LOCATION_SOURCE_CDMA_BS));
         else
-            mm_gdbus_modem_location_set_location (
-                ctx->skeleton,
-                build_location_dictionary (NULL, NULL, NULL, NULL, NULL));
+            clear_published_location (ctx->self, ctx->skeleton);
     }
 
     str = mm_modem_location_source_build_string_from_mask (ctx->sources);
@@ -1251,7 +1298,8 @@ typedef struct {
     MmGdbusModemLocation *skeleton;
     GDBusMethodInvocation *invocation;
     MMIfaceModemLocation *self;
-    guint rate;
+    guint rate_ms;
+    gboolean in_ms;
 } HandleSetGpsRefreshRateContext;
 
 static void
@@ -1302,17 +1350,23 @@ handle_set_gps_refresh_rate_auth_ready (MMBaseModem *self,
         return;
     }
 
-    /* Set the new rate in the interface */
-    mm_gdbus_modem_location_set_gps_refresh_rate (ctx->skeleton, ctx->rate);
-    mm_gdbus_modem_location_complete_set_gps_refresh_rate (ctx->skeleton, ctx->invocation);
+    /* Set the new rate in the interface; the rate in seconds is kept rounded
+     * up so that it never reports updates more often than they happen */
+    mm_gdbus_modem_location_set_gps_refresh_rate_ms (ctx->skeleton, ctx->rate_ms);
+    mm_gdbus_modem_location_set_gps_refresh_rate (ctx->skeleton, ctx->rate_ms / 1000 + !!(ctx->rate_ms % 1000));
+    if (ctx->in_ms)
+        mm_gdbus_modem_location_complete_set_gps_refresh_rate_ms (ctx->skeleton, ctx->invocation);
+    else
+        mm_gdbus_modem_location_complete_set_gps_refresh_rate (ctx->skeleton, ctx->invocation);
     handle_set_gps_refresh_rate_context_free (ctx);
 }
 
-static gboolean
-handle_set_gps_refresh_rate (MmGdbusModemLocation *skeleton,
-                             GDBusMethodInvocation *invocation,
-                             guint rate,
-                             MMIfaceModemLocation *self)
+static void
+handle_set_gps_refresh_rate_common (MmGdbusModemLocation *skeleton,
+                                    GDBusMethodInvocation *invocation,
+                                    guint rate_ms,
+                                    gboolean in_ms,
+                                    MMIfaceModemLocation *self)
 {
     HandleSetGpsRefreshRateContext *ctx;
 
@@ -1320,13 +1374,37 @@ handle_set_gps_refresh_rate (MmGdbusModemLocation *skeleton,
     ctx->skeleton = g_object_ref (skeleton);
     ctx->invocation = g_object_ref (invocation);
     ctx->self = g_object_ref (self);
-    ctx->rate = rate;
+    ctx->rate_ms = rate_ms;
+    ctx->in_ms = in_ms;
 
     mm_base_modem_authorize (MM_BASE_MODEM (self),
                              invocation,
                              MM_AUTHORIZATION_DEVICE_CONTROL,
                              (GAsyncReadyCallback)handle_set_gps_refresh_rate_auth_ready,
                              ctx);
+}
+
+static gboolean
+handle_set_gps_refresh_rate (MmGdbusModemLocation *skeleton,
+                             GDBusMethodInvocation *invocation,
+                             guint rate,
+                             MMIfaceModemLocation *self)
+{
+    handle_set_gps_refresh_rate_common (skeleton,
+                                        invocation,
+                                        (rate > G_MAXUINT / 1000) ? G_MAXUINT : rate * 1000,
+                                        FALSE,
+                                        self);
+    return TRUE;
+}
+
+static gboolean
+handle_set_gps_refresh_rate_ms (MmGdbusModemLocation *skeleton,
+                                GDBusMethodInvocation *invocation,
+                                guint rate_ms,
+                                MMIfaceModemLocation *self)
+{
+    handle_set_gps_refresh_rate_common (skeleton, invocation, rate_ms, TRUE, self);
     return TRUE;
 }
 
@@ -1354,6 +1432,8 @@ handle_get_location_auth_ready (MMBaseModem *self,
 {
     MMModemState modem_state;
     LocationContext *location_ctx;
+    GVariant *values[N_PUBLISHED_SOURCES];
+    guint i;
     GError *error = NULL;
 
     if (!mm_base_modem_authorize_finish (self, res, &error)) {
@@ -1377,14 +1457,16 @@ handle_get_location_auth_ready (MMBaseModem *self,
     }
 
     location_ctx = get_location_context (ctx->self);
+    for (i = 0; i < N_PUBLISHED_SOURCES; i++)
+        values[i] = build_location_source_value (location_ctx, published_sources[i]);
     mm_gdbus_modem_location_complete_get_location (
         ctx->skeleton,
         ctx->invocation,
-        build_location_dictionary (NULL,
-                                   location_ctx->location_3gpp,
-                                   location_ctx->location_gps_nmea,
-                                   location_ctx->location_gps_raw,
-                                   location_ctx->location_cdma_bs));
+        build_location_dictionary (values));
+    for (i = 0; i < N_PUBLISHED_SOURCES; i++) {
+        if (values[i])
+            g_variant_unref (values[i]);
+    }
     handle_get_location_context_free (ctx);
 }
 
@@ -1882,9 +1964,11 @@ interface_initialization_step (GTask *task)
     case INITIALIZATION_STEP_GPS_REFRESH_RATE:
         /* If we have GPS capabilities, expose the GPS refresh rate */
         if (ctx->capabilities & ((MM_MODEM_LOCATION_SOURCE_GPS_RAW |
-                                  MM_MODEM_LOCATION_SOURCE_GPS_NMEA)))
+                                  MM_MODEM_LOCATION_SOURCE_GPS_NMEA))) {
             /* Set the default rate in the interface */
             mm_gdbus_modem_location_set_gps_refresh_rate (ctx->skeleton, MM_LOCATION_GPS_REFRESH_TIME_SECS);
+            mm_gdbus_modem_location_set_gps_refresh_rate_ms (ctx->skeleton, MM_LOCATION_GPS_REFRESH_TIME_SECS * 1000);
+        }
 
         ctx->step++;
         /* fall through */
@@ -1909,6 +1993,10 @@ interface_initialization_step (GTask *task)
                           "handle-set-gps-refresh-rate",
                           G_CALLBACK (handle_set_gps_refresh_rate),
                           self);
+        g_signal_connect (ctx->skeleton,
+                          "handle-set-gps-refresh-rate-ms",
+                          G_CALLBACK (handle_set_gps_refresh_rate_ms),
+                          self);
         g_signal_connect (ctx->skeleton,
                           "handle-get-location",
                           G_CALLBACK (handle_get_location),
@@ -1959,8 +2047,7 @@ mm_iface_modem_location_initialize (MMIfaceModemLocation *self,
         mm_gdbus_modem_location_set_supported_assistance_data (skeleton, MM_MODEM_LOCATION_ASSISTANCE_DATA_TYPE_NONE);
         mm_gdbus_modem_location_set_enabled (skeleton, MM_MODEM_LOCATION_SOURCE_NONE);
         mm_gdbus_modem_location_set_signals_location (skeleton, FALSE);
-        mm_gdbus_modem_location_set_location (skeleton,
-                                              build_location_dictionary (NULL, NULL, NULL, NULL, NULL));
+        mm_gdbus_modem_location_set_location (skeleton, build_location_dictionary (NULL));
 
         g_object_set (self,
                       MM_IFACE_MODEM_LOCATION_DBUS_SKELETON, skeleton,
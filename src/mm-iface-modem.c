@@ -28,6 +28,7 @@
 #include "mm-private-boxed-types.h"
 #include "mm-log-object.h"
 #include "mm-context.h"
+#include "mm-modem-info-cache.h"
 #if defined WITH_QMI
 # include "mm-broadband-modem-qmi.h"
 #endif
@@ -45,11 +46,13 @@
 #define SIGNAL_QUALITY_UPDATE_CONTEXT_TAG "signal-quality-update-context-tag"
 #define SIGNAL_CHECK_CONTEXT_TAG          "signal-check-context-tag"
 #define RESTART_INITIALIZE_IDLE_TAG       "restart-initialize-tag"
+#define INFO_CACHE_CONTEXT_TAG            "info-cache-context-tag"
 
 static GQuark state_update_context_quark;
 static GQuark signal_quality_update_context_quark;
 static GQuark signal_check_context_quark;
 static GQuark restart_initialize_idle_quark;
+static GQuark info_cache_context_quark;
 
 /*****************************************************************************/
 
@@ -4188,6 +4191,133 @@ mm_iface_modem_enable (MMIfaceModem *self,
     interface_enabling_step (task);
 }
 
+/*****************************************************************************/
+/* Static information cache */
+
+typedef struct {
+    gchar    *uid;
+    gboolean  valid;
+} InfoCacheContext;
+
+static void
+info_cache_context_free (InfoCacheContext *ctx)
+{
+    g_free (ctx->uid);
+    g_free (ctx);
+}
+
+static InfoCacheContext *
+peek_info_cache_context (MMIfaceModem *self)
+{
+    if (G_UNLIKELY (!info_cache_context_quark))
+        info_cache_context_quark = (g_quark_from_static_string (
+                                        INFO_CACHE_CONTEXT_TAG));
+
+    return g_object_get_qdata (G_OBJECT (self), info_cache_context_quark);
+}
+
+static void
+info_cache_validate (MMIfaceModem *self,
+                     MmGdbusModem *skeleton)
+{
+    InfoCacheContext *ctx;
+    const gchar      *uid;
+    const gchar      *equipment_id;
+    const gchar      *revision;
+
+    /* Validated only once during the whole lifetime of the modem */
+    if (peek_info_cache_context (self))
+        return;
+
+    uid = mm_base_modem_get_device (MM_BASE_MODEM (self));
+    equipment_id = mm_gdbus_modem_get_equipment_identifier (skeleton);
+    revision = mm_gdbus_modem_get_revision (skeleton);
+    if (!uid || !equipment_id || !revision) {
+        mm_obj_dbg (self, "modem identity unknown: static information won't be cached");
+        return;
+    }
+
+    ctx = g_new0 (InfoCacheContext, 1);
+    ctx->uid = g_strdup (uid);
+    ctx->valid = mm_modem_info_cache_validate (uid, equipment_id, revision, self);
+    g_object_set_qdata_full (G_OBJECT (self),
+                             info_cache_context_quark,
+                             ctx,
+                             (GDestroyNotify)info_cache_context_free);
+}
+
+GVariant *
+mm_iface_modem_info_cache_lookup (MMIfaceModem       *self,
+                                  const gchar        *key,
+                                  const GVariantType *type)
+{
+    InfoCacheContext *ctx;
+    GVariant         *value;
+
+    ctx = peek_info_cache_context (self);
+    if (!ctx || !ctx->valid)
+        return NULL;
+
+    value = mm_modem_info_cache_lookup (ctx->uid, key, type, self);
+    if (value)
+        mm_obj_dbg (self, "using cached %s", key);
+    return value;
+}
+
+void
+mm_iface_modem_info_cache_store (MMIfaceModem *self,
+                                 const gchar  *key,
+                                 GVariant     *value)
+{
+    InfoCacheContext *ctx;
+
+    ctx = peek_info_cache_context (self);
+    if (!ctx) {
+        g_variant_unref (g_variant_ref_sink (value));
+        return;
+    }
+
+    mm_modem_info_cache_store (ctx->uid, key, value, self);
+}
+
+/* Keys of the information cached by the initialization sequence itself */
+#define INFO_CACHE_KEY_SUPPORTED_CAPABILITIES "supported-capabilities"
+#define INFO_CACHE_KEY_SUPPORTED_CHARSETS     "supported-charsets"
+#define INFO_CACHE_KEY_MANUFACTURER           "manufacturer"
+#define INFO_CACHE_KEY_MODEL                  "model"
+#define INFO_CACHE_KEY_HARDWARE_REVISION      "hardware-revision"
+#define INFO_CACHE_KEY_DEVICE_IDENTIFIER      "device-identifier"
+#define INFO_CACHE_KEY_SUPPORTED_BANDS        "supported-bands"
+
+static gboolean
+info_cache_load_string (MMIfaceModem  *self,
+                        const gchar   *key,
+                        MmGdbusModem  *skeleton,
+                        void         (*set_value) (MmGdbusModem *skeleton,
+                                                   const gchar  *value))
+{
+    GVariant *cached;
+
+    cached = mm_iface_modem_info_cache_lookup (self, key, G_VARIANT_TYPE_STRING);
+    if (!cached)
+        return FALSE;
+
+    set_value (skeleton, g_variant_get_string (cached, NULL));
+    g_variant_unref (cached);
+    return TRUE;
+}
+
+static gboolean
+supported_bands_cacheable (MMIfaceModem *self)
+{
+    gboolean cacheable = FALSE;
+
+    g_object_get (self,
+                  MM_IFACE_MODEM_SUPPORTED_BANDS_CACHEABLE, &cacheable,
+                  NULL);
+    return cacheable;
+}
+
 /*****************************************************************************/
 /* MODEM INITIALIZATION */
 
@@ -4197,16 +4327,17 @@ static void interface_initialization_step (GTask *task);
 typedef enum {
     INITIALIZATION_STEP_FIRST,
     INITIALIZATION_STEP_CURRENT_CAPABILITIES,
+    INITIALIZATION_STEP_REVISION,
+    INITIALIZATION_STEP_EQUIPMENT_ID,
+    INITIALIZATION_STEP_INFO_CACHE,
     INITIALIZATION_STEP_SUPPORTED_CAPABILITIES,
     INITIALIZATION_STEP_SUPPORTED_CHARSETS,
     INITIALIZATION_STEP_CHARSET,
     INITIALIZATION_STEP_BEARERS,
     INITIALIZATION_STEP_MANUFACTURER,
     INITIALIZATION_STEP_MODEL,
-    INITIALIZATION_STEP_REVISION,
     INITIALIZATION_STEP_CARRIER_CONFIG,
     INITIALIZATION_STEP_HARDWARE_REVISION,
-    INITIALIZATION_STEP_EQUIPMENT_ID,
     INITIALIZATION_STEP_DEVICE_ID,
     INITIALIZATION_STEP_SUPPORTED_MODES,
     INITIALIZATION_STEP_SUPPORTED_BANDS,
@@ -4240,7 +4371,7 @@ initialization_context_free (InitializationContext *ctx)
 }
 
 #undef STR_REPLY_READY_FN
-#define STR_REPLY_READY_FN(NAME,DISPLAY)                                \
+#define STR_REPLY_READY_FN(NAME,DISPLAY,CACHE_KEY)                      \
     static void                                                         \
     load_##NAME##_ready (MMIfaceModem *self,                            \
                          GAsyncResult *res,                             \
@@ -4248,18 +4379,20 @@ initialization_context_free (InitializationContext *ctx)
     {                                                                   \
         InitializationContext *ctx;                                     \
         GError *error = NULL;                                           \
+        const gchar *cache_key = CACHE_KEY;                             \
         gchar *val;                                                     \
                                                                         \
         ctx = g_task_get_task_data (task);                              \
                                                                         \
         val = MM_IFACE_MODEM_GET_INTERFACE (self)->load_##NAME##_finish (self, res, &error); \
         mm_gdbus_modem_set_##NAME (ctx->skeleton, val);                 \
-        g_free (val);                                                   \
                                                                         \
         if (error) {                                                    \
             mm_obj_warn (self, "couldn't load %s: %s", DISPLAY, error->message); \
             g_error_free (error);                                       \
-        }                                                               \
+        } else if (val && cache_key)                                    \
+            mm_iface_modem_info_cache_store (self, cache_key, g_variant_new_string (val)); \
+        g_free (val);                                                   \
                                                                         \
         /* Go on to next step */                                        \
         ctx->step++;                                                    \
@@ -4430,17 +4563,22 @@ load_supported_capabilities_ready (MMIfaceModem *self,
     mm_gdbus_modem_set_supported_capabilities (ctx->skeleton,
                                                mm_common_capability_combinations_garray_to_variant (supported_capabilities));
     g_array_unref (supported_capabilities);
+    mm_iface_modem_info_cache_store (self,
+                                     INFO_CACHE_KEY_SUPPORTED_CAPABILITIES,
+                                     mm_gdbus_modem_get_supported_capabilities (ctx->skeleton));
 
     ctx->step++;
     interface_initialization_step (task);
 }
 
-STR_REPLY_READY_FN (manufacturer, "manufacturer")
-STR_REPLY_READY_FN (model, "model")
-STR_REPLY_READY_FN (revision, "revision")
-STR_REPLY_READY_FN (hardware_revision, "hardware revision")
-STR_REPLY_READY_FN (equipment_identifier, "equipment identifier")
-STR_REPLY_READY_FN (device_identifier, "device identifier")
+/* Revision and equipment identifier validate the cache, so they are never
+ * cached themselves */
+STR_REPLY_READY_FN (manufacturer, "manufacturer", INFO_CACHE_KEY_MANUFACTURER)
+STR_REPLY_READY_FN (model, "model", INFO_CACHE_KEY_MODEL)
+STR_REPLY_READY_FN (revision, "revision", NULL)
+STR_REPLY_READY_FN (hardware_revision, "hardware revision", INFO_CACHE_KEY_HARDWARE_REVISION)
+STR_REPLY_READY_FN (equipment_identifier, "equipment identifier", NULL)
+STR_REPLY_READY_FN (device_identifier, "device identifier", INFO_CACHE_KEY_DEVICE_IDENTIFIER)
 
 static void
 load_supported_charsets_ready (MMIfaceModem *self,
@@ -4457,7 +4595,10 @@ load_supported_charsets_ready (MMIfaceModem *self,
     if (error) {
         mm_obj_warn (self, "couldn't load supported charsets: %s", error->message);
         g_error_free (error);
-    }
+    } else if (ctx->supported_charsets != MM_MODEM_CHARSET_UNKNOWN)
+        mm_iface_modem_info_cache_store (self,
+                                         INFO_CACHE_KEY_SUPPORTED_CHARSETS,
+                                         g_variant_new_uint32 (ctx->supported_charsets));
 
     /* Go on to next step */
     ctx->step++;
@@ -4533,6 +4674,10 @@ load_supported_bands_ready (MMIfaceModem *self,
         mm_gdbus_modem_set_supported_bands (ctx->skeleton,
                                             mm_common_bands_garray_to_variant (bands_array));
         g_array_unref (bands_array);
+        if (!error && supported_bands_cacheable (self))
+            mm_iface_modem_info_cache_store (self,
+                                             INFO_CACHE_KEY_SUPPORTED_BANDS,
+                                             mm_gdbus_modem_get_supported_bands (ctx->skeleton));
     }
 
     if (error) {
@@ -4994,7 +5139,13 @@ interface_initialization_step (GTask *task)
         /* Current capabilities may change during runtime, i.e. if new firmware reloaded; but we'll
          * try to handle that by making sure the capabilities are cleared when the new firmware is
          * reloaded. So if we're asked to re-initialize, if we already have current capabilities loaded,
-         * don't try to load them again. */
+         * don't try to load them again.
+         *
+         * These are never taken from the static information cache: they are
+         * loaded before the identity of the modem is known (the equipment
+         * identifier may depend on them, and some implementations load it
+         * along with them), and multimode devices adjust them based on
+         * whether there is a SIM. */
         if (mm_gdbus_modem_get_current_capabilities (ctx->skeleton) == MM_MODEM_CAPABILITY_NONE &&
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_current_capabilities &&
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_current_capabilities_finish) {
@@ -5007,6 +5158,46 @@ interface_initialization_step (GTask *task)
         ctx->step++;
         /* fall-through */
 
+    case INITIALIZATION_STEP_REVISION:
+        /* Revision is meant to be loaded only once during the whole
+         * lifetime of the modem. Therefore, if we already have them loaded,
+         * don't try to load them again. */
+        if (mm_gdbus_modem_get_revision (ctx->skeleton) == NULL &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision_finish) {
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision (
+                self,
+                (GAsyncReadyCallback)load_revision_ready,
+                task);
+            return;
+        }
+        ctx->step++;
+        /* fall-through */
+
+    case INITIALIZATION_STEP_EQUIPMENT_ID:
+        /* Equipment ID is meant to be loaded only once during the whole
+         * lifetime of the modem. Therefore, if we already have them loaded,
+         * don't try to load them again. */
+        if (mm_gdbus_modem_get_equipment_identifier (ctx->skeleton) == NULL &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier &&
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier_finish) {
+            MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier (
+                self,
+                (GAsyncReadyCallback)load_equipment_identifier_ready,
+                task);
+            return;
+        }
+        ctx->step++;
+        /* fall-through */
+
+    case INITIALIZATION_STEP_INFO_CACHE:
+        /* Once the identity of the modem is known, check whether the static
+         * information cached in a previous run can be used, so that all the
+         * loaders below may be skipped */
+        info_cache_validate (self, ctx->skeleton);
+        ctx->step++;
+        /* fall-through */
+
     case INITIALIZATION_STEP_SUPPORTED_CAPABILITIES: {
         GArray *supported_capabilities;
 
@@ -5018,26 +5209,31 @@ interface_initialization_step (GTask *task)
          * don't try to load them again. */
         if (supported_capabilities->len == 0 ||
             g_array_index (supported_capabilities, MMModemCapability, 0) == MM_MODEM_CAPABILITY_NONE) {
-            MMModemCapability current;
-
-            if (MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_capabilities &&
-                MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_capabilities_finish) {
+            MMModemCapability  current;
+            GVariant          *cached;
+
+            cached = mm_iface_modem_info_cache_lookup (self, INFO_CACHE_KEY_SUPPORTED_CAPABILITIES, G_VARIANT_TYPE ("au"));
+            if (cached) {
+                mm_gdbus_modem_set_supported_capabilities (ctx->skeleton, cached);
+                g_variant_unref (cached);
+            } else if (MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_capabilities &&
+                       MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_capabilities_finish) {
                 MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_capabilities (
                     self,
                     (GAsyncReadyCallback)load_supported_capabilities_ready,
                     task);
                 g_array_unref (supported_capabilities);
                 return;
+            } else {
+                /* If no specific way of getting modem capabilities, default to the current ones */
+                g_array_unref (supported_capabilities);
+                supported_capabilities = g_array_sized_new (FALSE, FALSE, sizeof (MMModemCapability), 1);
+                current = mm_gdbus_modem_get_current_capabilities (ctx->skeleton);
+                g_array_append_val (supported_capabilities, current);
+                mm_gdbus_modem_set_supported_capabilities (
+                    ctx->skeleton,
+                    mm_common_capability_combinations_garray_to_variant (supported_capabilities));
             }
-
-            /* If no specific way of getting modem capabilities, default to the current ones */
-            g_array_unref (supported_capabilities);
-            supported_capabilities = g_array_sized_new (FALSE, FALSE, sizeof (MMModemCapability), 1);
-            current = mm_gdbus_modem_get_current_capabilities (ctx->skeleton);
-            g_array_append_val (supported_capabilities, current);
-            mm_gdbus_modem_set_supported_capabilities (
-                ctx->skeleton,
-                mm_common_capability_combinations_garray_to_variant (supported_capabilities));
         }
         g_array_unref (supported_capabilities);
 
@@ -5047,11 +5243,20 @@ interface_initialization_step (GTask *task)
     case INITIALIZATION_STEP_SUPPORTED_CHARSETS:
         if (MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_charsets &&
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_charsets_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_charsets (
-                self,
-                (GAsyncReadyCallback)load_supported_charsets_ready,
-                task);
-            return;
+            GVariant *cached;
+
+            /* The charset itself is always set up again below, as that is
+             * state of the device and not static information */
+            cached = mm_iface_modem_info_cache_lookup (self, INFO_CACHE_KEY_SUPPORTED_CHARSETS, G_VARIANT_TYPE_UINT32);
+            if (!cached) {
+                MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_charsets (
+                    self,
+                    (GAsyncReadyCallback)load_supported_charsets_ready,
+                    task);
+                return;
+            }
+            ctx->supported_charsets = g_variant_get_uint32 (cached);
+            g_variant_unref (cached);
         }
         ctx->step++;
         /* fall-through */
@@ -5144,6 +5349,7 @@ interface_initialization_step (GTask *task)
          * lifetime of the modem. Therefore, if we already have them loaded,
          * don't try to load them again. */
         if (mm_gdbus_modem_get_manufacturer (ctx->skeleton) == NULL &&
+            !info_cache_load_string (self, INFO_CACHE_KEY_MANUFACTURER, ctx->skeleton, mm_gdbus_modem_set_manufacturer) &&
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_manufacturer &&
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_manufacturer_finish) {
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_manufacturer (
@@ -5160,6 +5366,7 @@ interface_initialization_step (GTask *task)
          * lifetime of the modem. Therefore, if we already have them loaded,
          * don't try to load them again. */
         if (mm_gdbus_modem_get_model (ctx->skeleton) == NULL &&
+            !info_cache_load_string (self, INFO_CACHE_KEY_MODEL, ctx->skeleton, mm_gdbus_modem_set_model) &&
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_model &&
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_model_finish) {
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_model (
@@ -5171,22 +5378,6 @@ interface_initialization_step (GTask *task)
         ctx->step++;
         /* fall-through */
 
-    case INITIALIZATION_STEP_REVISION:
-        /* Revision is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_revision (ctx->skeleton) == NULL &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_revision (
-                self,
-                (GAsyncReadyCallback)load_revision_ready,
-                task);
-            return;
-        }
-        ctx->step++;
-        /* fall-through */
-
     case INITIALIZATION_STEP_CARRIER_CONFIG:
         /* Current carrier config is meant to be loaded only once during the whole
          * lifetime of the modem. Therefore, if we already have them loaded,
@@ -5207,6 +5398,7 @@ interface_initialization_step (GTask *task)
          * lifetime of the modem. Therefore, if we already have them loaded,
          * don't try to load them again. */
         if (mm_gdbus_modem_get_hardware_revision (ctx->skeleton) == NULL &&
+            !info_cache_load_string (self, INFO_CACHE_KEY_HARDWARE_REVISION, ctx->skeleton, mm_gdbus_modem_set_hardware_revision) &&
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_hardware_revision &&
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_hardware_revision_finish) {
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_hardware_revision (
@@ -5218,27 +5410,12 @@ interface_initialization_step (GTask *task)
         ctx->step++;
         /* fall-through */
 
-    case INITIALIZATION_STEP_EQUIPMENT_ID:
-        /* Equipment ID is meant to be loaded only once during the whole
-         * lifetime of the modem. Therefore, if we already have them loaded,
-         * don't try to load them again. */
-        if (mm_gdbus_modem_get_equipment_identifier (ctx->skeleton) == NULL &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier &&
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier_finish) {
-            MM_IFACE_MODEM_GET_INTERFACE (self)->load_equipment_identifier (
-                self,
-                (GAsyncReadyCallback)load_equipment_identifier_ready,
-                task);
-            return;
-        }
-        ctx->step++;
-        /* fall-through */
-
     case INITIALIZATION_STEP_DEVICE_ID:
         /* Device ID is meant to be loaded only once during the whole
          * lifetime of the modem. Therefore, if we already have them loaded,
          * don't try to load them again. */
         if (mm_gdbus_modem_get_device_identifier (ctx->skeleton) == NULL &&
+            !info_cache_load_string (self, INFO_CACHE_KEY_DEVICE_IDENTIFIER, ctx->skeleton, mm_gdbus_modem_set_device_identifier) &&
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_device_identifier &&
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_device_identifier_finish) {
             MM_IFACE_MODEM_GET_INTERFACE (self)->load_device_identifier (
@@ -5290,19 +5467,29 @@ interface_initialization_step (GTask *task)
          * don't try to load them again. */
         if (supported_bands->len == 0 ||
             g_array_index (supported_bands, MMModemBand, 0)  == MM_MODEM_BAND_UNKNOWN) {
-            if (MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_bands &&
-                MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_bands_finish) {
+            GVariant *cached = NULL;
+
+            /* Implementations that keep their own state while loading
+             * supported bands need the loader to run every time */
+            if (supported_bands_cacheable (self))
+                cached = mm_iface_modem_info_cache_lookup (self, INFO_CACHE_KEY_SUPPORTED_BANDS, G_VARIANT_TYPE ("au"));
+
+            if (cached) {
+                mm_gdbus_modem_set_supported_bands (ctx->skeleton, cached);
+                g_variant_unref (cached);
+            } else if (MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_bands &&
+                       MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_bands_finish) {
                 MM_IFACE_MODEM_GET_INTERFACE (self)->load_supported_bands (
                     self,
                     (GAsyncReadyCallback)load_supported_bands_ready,
                     task);
                 g_array_unref (supported_bands);
                 return;
+            } else {
+                /* Loading supported bands not implemented, default to UNKNOWN */
+                mm_gdbus_modem_set_supported_bands (ctx->skeleton, mm_common_build_bands_unknown ());
+                mm_gdbus_modem_set_current_bands (ctx->skeleton, mm_common_build_bands_unknown ());
             }
-
-            /* Loading supported bands not implemented, default to UNKNOWN */
-            mm_gdbus_modem_set_supported_bands (ctx->skeleton, mm_common_build_bands_unknown ());
-            mm_gdbus_modem_set_current_bands (ctx->skeleton, mm_common_build_bands_unknown ());
         }
         g_array_unref (supported_bands);
 
@@ -6030,6 +6217,14 @@ iface_modem_init (gpointer g_iface)
                                FALSE,
                                G_PARAM_READWRITE));
 
+    g_object_interface_install_property
+        (g_iface,
+         g_param_spec_boolean (MM_IFACE_MODEM_SUPPORTED_BANDS_CACHEABLE,
+                               "Supported bands cacheable",
+                               "Whether supported bands may be taken from the static information cache instead of being loaded.",
+                               FALSE,
+                               G_PARAM_READWRITE));
+
     g_object_interface_install_property
         (g_iface,
          g_param_spec_string (MM_IFACE_MODEM_CARRIER_CONFIG_MAPPING,
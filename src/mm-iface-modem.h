@@ -42,6 +42,7 @@
 #define MM_IFACE_MODEM_CARRIER_CONFIG_MAPPING  "iface-modem-carrier-config-mapping"
 #define MM_IFACE_MODEM_PERIODIC_SIGNAL_CHECK_DISABLED      "iface-modem-periodic-signal-check-disabled"
 #define MM_IFACE_MODEM_PERIODIC_ACCESS_TECH_CHECK_DISABLED "iface-modem-periodic-access-tech-check-disabled"
+#define MM_IFACE_MODEM_SUPPORTED_BANDS_CACHEABLE           "iface-modem-supported-bands-cacheable"
 
 typedef struct _MMIfaceModem MMIfaceModem;
 
@@ -417,6 +418,19 @@ gboolean          mm_iface_modem_is_3gpp_5gnr             (MMIfaceModem *self);
 gboolean          mm_iface_modem_is_cdma                  (MMIfaceModem *self);
 gboolean          mm_iface_modem_is_cdma_only             (MMIfaceModem *self);
 
+/* Persistent cache of static information, for implementations to skip
+ * loading it again when the same device (same physical device, equipment
+ * identifier and revision) is found. Only available once the equipment
+ * identifier and revision are loaded during initialization, which happens
+ * right after loading current capabilities. Stored values are consumed if
+ * floating. */
+GVariant *mm_iface_modem_info_cache_lookup (MMIfaceModem       *self,
+                                            const gchar        *key,
+                                            const GVariantType *type);
+void      mm_iface_modem_info_cache_store  (MMIfaceModem       *self,
+                                            const gchar        *key,
+                                            GVariant           *value);
+
 /* Helpers to query supported modes */
 gboolean mm_iface_modem_is_2g      (MMIfaceModem *self);
 gboolean mm_iface_modem_is_2g_only (MMIfaceModem *self);
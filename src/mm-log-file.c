@@ -0,0 +1,345 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <glib/gstdio.h>
+
+#include <ModemManager.h>
+#include <mm-errors-types.h>
+
+#include "mm-log-file.h"
+
+/* The writer thread must never log anything itself, any error writing the
+ * file is silently ignored, as it was before when writing synchronously. */
+
+typedef struct _LogItem LogItem;
+struct _LogItem {
+    LogItem  *next;
+    gboolean  flush;
+    gsize     length;
+    gchar     message[];
+};
+
+struct _MMLogFile {
+    gchar   *path;
+    gchar   *rotated_path;
+    guint64  max_size;
+    guint    flush_interval;
+
+    /* Owned by the writer thread once running */
+    gint     fd;
+    guint64  size;
+    GString *batch;
+
+    /* Queued items, most recent first. Producers only push with an atomic
+     * compare-and-exchange, and the writer takes all of them at once, so
+     * neither of them ever waits for the other. */
+    LogItem *pending;
+
+    /* Only used to wake up the writer when the queue was empty, and to
+     * request and wait for syncs */
+    GMutex   mutex;
+    GCond    cond;
+    GCond    sync_cond;
+    guint    sync_requested;
+    guint    sync_done;
+    gboolean quit;
+
+    GThread *thread;
+};
+
+/*****************************************************************************/
+
+static gint
+log_file_open (MMLogFile  *self,
+               gint        extra_flags,
+               GError    **error)
+{
+    struct stat st;
+    gint        fd;
+
+    fd = open (self->path,
+               O_CREAT | O_APPEND | O_WRONLY | O_CLOEXEC | extra_flags,
+               S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
+    if (fd < 0) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "Couldn't open log file: (%d) %s",
+                     errno, strerror (errno));
+        return -1;
+    }
+
+    self->size = (fstat (fd, &st) == 0) ? (guint64) st.st_size : 0;
+    return fd;
+}
+
+static void
+log_file_rotate (MMLogFile *self)
+{
+    fsync (self->fd);
+    close (self->fd);
+
+    /* If renaming fails, just start over in the same file */
+    g_rename (self->path, self->rotated_path);
+    self->fd = log_file_open (self, O_TRUNC, NULL);
+}
+
+static void
+log_file_write_batch (MMLogFile *self)
+{
+    const gchar *data;
+    gsize        remaining;
+
+    if (self->fd < 0)
+        self->fd = log_file_open (self, 0, NULL);
+    if (self->fd < 0)
+        return;
+
+    if (self->max_size && self->size && (self->size + self->batch->len > self->max_size)) {
+        log_file_rotate (self);
+        if (self->fd < 0)
+            return;
+    }
+
+    data = self->batch->str;
+    remaining = self->batch->len;
+    while (remaining > 0) {
+        gssize written;
+
+        written = write (self->fd, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        data += written;
+        remaining -= written;
+        self->size += written;
+    }
+}
+
+/* Takes all queued items, and returns them in the order they were queued */
+static LogItem *
+log_file_take_pending (MMLogFile *self)
+{
+    LogItem *items;
+    LogItem *reversed = NULL;
+
+    do {
+        items = g_atomic_pointer_get (&self->pending);
+    } while (items && !g_atomic_pointer_compare_and_exchange (&self->pending, items, NULL));
+
+    while (items) {
+        LogItem *next;
+
+        next = items->next;
+        items->next = reversed;
+        reversed = items;
+        items = next;
+    }
+    return reversed;
+}
+
+/* Writes all queued items, returns FALSE if there were none */
+static gboolean
+log_file_write_pending (MMLogFile *self,
+                        gboolean  *flush)
+{
+    LogItem *items;
+
+    items = log_file_take_pending (self);
+    if (!items)
+        return FALSE;
+
+    g_string_truncate (self->batch, 0);
+    while (items) {
+        LogItem *next;
+
+        next = items->next;
+        g_string_append_len (self->batch, items->message, items->length);
+        *flush |= items->flush;
+        g_free (items);
+        items = next;
+    }
+    log_file_write_batch (self);
+    return TRUE;
+}
+
+static gpointer
+log_file_thread (MMLogFile *self)
+{
+    gint64   last_sync;
+    gboolean unsynced = FALSE;
+    gboolean quit = FALSE;
+
+    last_sync = g_get_monotonic_time ();
+
+    while (!quit) {
+        guint    sync_requested;
+        gboolean flush = FALSE;
+        gint64   now;
+
+        g_mutex_lock (&self->mutex);
+        while (!g_atomic_pointer_get (&self->pending) &&
+               !self->quit &&
+               self->sync_requested == self->sync_done) {
+            if (!unsynced || !self->flush_interval)
+                g_cond_wait (&self->cond, &self->mutex);
+            else if (!g_cond_wait_until (&self->cond, &self->mutex,
+                                         last_sync + self->flush_interval * G_TIME_SPAN_MILLISECOND))
+                break;
+        }
+        /* Read before taking the items, so that all the ones queued before
+         * the sync was requested are included */
+        sync_requested = self->sync_requested;
+        quit = self->quit;
+        g_mutex_unlock (&self->mutex);
+
+        if (log_file_write_pending (self, &flush))
+            unsynced = TRUE;
+
+        now = g_get_monotonic_time ();
+        if (unsynced &&
+            (flush ||
+             quit ||
+             !self->flush_interval ||
+             sync_requested != self->sync_done ||
+             (now - last_sync) >= self->flush_interval * G_TIME_SPAN_MILLISECOND)) {
+            if (self->fd >= 0)
+                fsync (self->fd);
+            unsynced = FALSE;
+            last_sync = now;
+        }
+
+        if (sync_requested != self->sync_done) {
+            g_mutex_lock (&self->mutex);
+            self->sync_done = sync_requested;
+            g_cond_broadcast (&self->sync_cond);
+            g_mutex_unlock (&self->mutex);
+        }
+    }
+
+    return NULL;
+}
+
+/*****************************************************************************/
+
+void
+mm_log_file_write (MMLogFile   *self,
+                   const gchar *message,
+                   gsize        length,
+                   gboolean     flush)
+{
+    LogItem *item;
+    LogItem *head;
+
+    item = g_malloc (sizeof (LogItem) + length);
+    item->flush = flush;
+    item->length = length;
+    memcpy (item->message, message, length);
+
+    do {
+        head = g_atomic_pointer_get (&self->pending);
+        item->next = head;
+    } while (!g_atomic_pointer_compare_and_exchange (&self->pending, head, item));
+
+    /* The writer only needs to be woken up if the queue was empty, otherwise
+     * it either has been woken up already or is busy writing */
+    if (!head) {
+        g_mutex_lock (&self->mutex);
+        g_cond_signal (&self->cond);
+        g_mutex_unlock (&self->mutex);
+    }
+}
+
+void
+mm_log_file_sync (MMLogFile *self)
+{
+    guint sync_requested;
+
+    g_mutex_lock (&self->mutex);
+    sync_requested = ++self->sync_requested;
+    g_cond_signal (&self->cond);
+    while ((gint) (self->sync_done - sync_requested) < 0)
+        g_cond_wait (&self->sync_cond, &self->mutex);
+    g_mutex_unlock (&self->mutex);
+}
+
+/*****************************************************************************/
+
+MMLogFile *
+mm_log_file_new (const gchar  *path,
+                 guint64       max_size,
+                 guint         flush_interval,
+                 GError      **error)
+{
+    MMLogFile *self;
+
+    self = g_slice_new0 (MMLogFile);
+    self->path = g_strdup (path);
+    self->rotated_path = g_strdup_printf ("%s.1", path);
+    self->max_size = max_size;
+    self->flush_interval = flush_interval;
+    self->batch = g_string_sized_new (4096);
+    g_mutex_init (&self->mutex);
+    g_cond_init (&self->cond);
+    g_cond_init (&self->sync_cond);
+
+    self->fd = log_file_open (self, 0, error);
+    if (self->fd < 0)
+        goto failed;
+
+    self->thread = g_thread_try_new ("mm-log-file", (GThreadFunc) log_file_thread, self, error);
+    if (!self->thread)
+        goto failed;
+
+    return self;
+
+failed:
+    mm_log_file_free (self);
+    return NULL;
+}
+
+void
+mm_log_file_free (MMLogFile *self)
+{
+    gboolean flush = FALSE;
+
+    if (self->thread) {
+        g_mutex_lock (&self->mutex);
+        self->quit = TRUE;
+        g_cond_signal (&self->cond);
+        g_mutex_unlock (&self->mutex);
+        g_thread_join (self->thread);
+    }
+
+    /* Items queued by other threads after the writer took its last batch
+     * are written here, instead of being lost */
+    if (log_file_write_pending (self, &flush) && self->fd >= 0)
+        fsync (self->fd);
+    if (self->fd >= 0)
+        close (self->fd);
+    g_string_free (self->batch, TRUE);
+    g_cond_clear (&self->sync_cond);
+    g_cond_clear (&self->cond);
+    g_mutex_clear (&self->mutex);
+    g_free (self->rotated_path);
+    g_free (self->path);
+    g_slice_free (MMLogFile, self);
+}
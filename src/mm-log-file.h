@@ -0,0 +1,44 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_LOG_FILE_H
+#define MM_LOG_FILE_H
+
+#include <glib.h>
+
+/* Log file written from a dedicated thread, so that callers never block on
+ * disk I/O. Messages are queued without taking any lock, and the writer thread
+ * writes them in batches.
+ *
+ * Data is synced to disk right after writing a message queued with the flush
+ * flag set, or once the flush interval (in ms) elapses since the last sync;
+ * with a 0 interval, every batch is synced. If a maximum size (in bytes) is
+ * given, the file is rotated to '<path>.1' before it would go over it. */
+
+typedef struct _MMLogFile MMLogFile;
+
+MMLogFile *mm_log_file_new   (const gchar  *path,
+                              guint64       max_size,
+                              guint         flush_interval,
+                              GError      **error);
+void       mm_log_file_free  (MMLogFile    *self);
+
+void       mm_log_file_write (MMLogFile    *self,
+                              const gchar  *message,
+                              gsize         length,
+                              gboolean      flush);
+
+/* Blocks until all messages queued so far are written and synced to disk */
+void       mm_log_file_sync  (MMLogFile    *self);
+
+#endif /* MM_LOG_FILE_H */
@@ -21,6 +21,17 @@
 
 /* This is a common logging method to be used by all test applications */
 
+guint32  _mm_log_enabled_levels = MM_LOG_LEVEL_ERR | MM_LOG_LEVEL_WARN | MM_LOG_LEVEL_INFO | MM_LOG_LEVEL_DEBUG;
+gboolean _mm_log_filtered = FALSE;
+
+gboolean
+_mm_log_check_filters (gpointer     obj,
+                       const gchar *module,
+                       MMLogLevel   level)
+{
+    return TRUE;
+}
+
 void
 _mm_log (gpointer     obj,
          const gchar *module,
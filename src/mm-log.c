@@ -42,6 +42,7 @@
 #endif
 
 #include "mm-log.h"
+#include "mm-log-file.h"
 #include "mm-log-object.h"
 
 enum {
@@ -52,8 +53,9 @@ enum {
 
 static gboolean ts_flags = TS_FLAG_NONE;
 static guint32 log_level = MM_LOG_LEVEL_INFO | MM_LOG_LEVEL_WARN | MM_LOG_LEVEL_ERR;
+static GArray *log_filters;
 static GTimeVal rel_start = { 0, 0 };
-static int logfd = -1;
+static MMLogFile *logfile;
 static gboolean append_log_level_text = TRUE;
 
 static void (*log_backend) (const char *loc,
@@ -78,6 +80,9 @@ static const LogDesc level_descs[] = {
 static GString *msgbuf = NULL;
 static volatile gsize msgbuf_once = 0;
 
+guint32  _mm_log_enabled_levels = MM_LOG_LEVEL_INFO | MM_LOG_LEVEL_WARN | MM_LOG_LEVEL_ERR;
+gboolean _mm_log_filtered = FALSE;
+
 static int
 mm_to_syslog_priority (MMLogLevel level)
 {
@@ -152,11 +157,27 @@ log_backend_file (const char *loc,
                   const char *message,
                   size_t length)
 {
-    ssize_t ign;
-    ign = write (logfd, message, length);
-    if (ign) {} /* whatever; really shut up about unused result */
+    MMLogFile *file;
 
-    fsync (logfd);  /* Make sure output is dumped to disk immediately  */
+    /* Another thread may have seen the file backend right before shutdown */
+    file = g_atomic_pointer_get (&logfile);
+    if (!file) {
+        fwrite (message, 1, length, stderr);
+        return;
+    }
+
+    /* Warnings and errors are synced to disk right away */
+    mm_log_file_write (file, message, length, syslog_level <= LOG_WARNING);
+}
+
+static void
+log_backend_stderr (const char *loc,
+                    const char *func,
+                    int syslog_level,
+                    const char *message,
+                    size_t length)
+{
+    fwrite (message, 1, length, stderr);
 }
 
 static void
@@ -218,8 +239,7 @@ _mm_log (gpointer     obj,
     va_list args;
     GTimeVal tv;
 
-    if (!(log_level & level))
-        return;
+    /* Enabled level already checked by the caller, see mm_log_check_enabled() */
 
     if (g_once_init_enter (&msgbuf_once)) {
         msgbuf = g_string_sized_new (512);
@@ -273,25 +293,169 @@ log_handler (const gchar *log_domain,
              gpointer ignored)
 {
     log_backend (NULL, NULL, glib_to_syslog_priority (level), message, strlen (message));
+
+    /* The program is aborted right after fatal messages */
+    if (level & (G_LOG_FLAG_FATAL | G_LOG_LEVEL_ERROR)) {
+        MMLogFile *file;
+
+        file = g_atomic_pointer_get (&logfile);
+        if (file)
+            mm_log_file_sync (file);
+    }
+}
+
+/*****************************************************************************/
+/* Log filters
+ *
+ * Each filter sets the log level of the messages of a given module, or of a
+ * given object (and all the objects it owns). Objects are matched by any
+ * sequence of '/'-separated components of their ids, e.g. 'modem0' or
+ * 'ttyUSB2' match 'modem0/ttyUSB2/at'. Filters on objects take precedence
+ * over filters on modules, and the most specific object filter (i.e. the one
+ * with the longest match) wins.
+ */
+
+typedef struct {
+    gchar   *name;
+    gsize    name_len;
+    guint32  levels;
+} LogFilter;
+
+static void
+log_filter_clear (LogFilter *filter)
+{
+    g_free (filter->name);
+}
+
+static gboolean
+log_filter_match_object (const LogFilter *filter,
+                         const gchar     *id)
+{
+    const gchar *component = id;
+
+    while (TRUE) {
+        if (!strncmp (component, filter->name, filter->name_len) &&
+            (component[filter->name_len] == '\0' || component[filter->name_len] == '/'))
+            return TRUE;
+        component = strchr (component, '/');
+        if (!component)
+            return FALSE;
+        component++;
+    }
 }
 
 gboolean
-mm_log_set_level (const char *level, GError **error)
+_mm_log_check_filters (gpointer     obj,
+                       const gchar *module,
+                       MMLogLevel   level)
+{
+    const gchar *id = NULL;
+    guint32      levels = log_level;
+    gsize        best_len = 0;
+    gboolean     object_matched = FALSE;
+    guint        i;
+
+    if (obj)
+        id = mm_log_object_get_id (MM_LOG_OBJECT (obj));
+
+    for (i = 0; i < log_filters->len; i++) {
+        const LogFilter *filter;
+
+        filter = &g_array_index (log_filters, LogFilter, i);
+        if (id && filter->name_len >= best_len && log_filter_match_object (filter, id)) {
+            object_matched = TRUE;
+            best_len = filter->name_len;
+            levels = filter->levels;
+        } else if (!object_matched && module && g_str_equal (module, filter->name))
+            levels = filter->levels;
+    }
+
+    return !!(levels & level);
+}
+
+static void
+log_update_enabled_levels (void)
+{
+    guint i;
+
+    _mm_log_enabled_levels = log_level;
+    for (i = 0; log_filters && i < log_filters->len; i++)
+        _mm_log_enabled_levels |= g_array_index (log_filters, LogFilter, i).levels;
+    _mm_log_filtered = (log_filters && log_filters->len > 0);
+}
+
+static gboolean
+log_level_parse (const char  *level,
+                 guint32     *out_levels,
+                 GError     **error)
 {
-    gboolean found = FALSE;
     const LogDesc *diter;
 
     for (diter = &level_descs[0]; diter->name; diter++) {
         if (!strcasecmp (diter->name, level)) {
-            log_level = diter->num;
-            found = TRUE;
-            break;
+            *out_levels = diter->num;
+            return TRUE;
+        }
+    }
+
+    g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_INVALID_ARGS,
+                 "Unknown log level '%s'", level);
+    return FALSE;
+}
+
+gboolean
+mm_log_set_filter (const char *filter, GError **error)
+{
+    g_auto(GStrv)  rules = NULL;
+    GArray        *filters;
+    guint          i;
+
+    filters = g_array_new (FALSE, FALSE, sizeof (LogFilter));
+    g_array_set_clear_func (filters, (GDestroyNotify) log_filter_clear);
+
+    rules = g_strsplit (filter ? filter : "", ",", -1);
+    for (i = 0; rules[i]; i++) {
+        LogFilter  new_filter;
+        gchar     *rule;
+        gchar     *equal;
+
+        rule = g_strstrip (rules[i]);
+        if (!rule[0])
+            continue;
+
+        equal = strchr (rule, '=');
+        if (!equal || equal == rule) {
+            g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_INVALID_ARGS,
+                         "Invalid log filter '%s': expected NAME=LEVEL", rule);
+            g_array_unref (filters);
+            return FALSE;
         }
+        *equal = '\0';
+        if (!log_level_parse (g_strstrip (equal + 1), &new_filter.levels, error)) {
+            g_array_unref (filters);
+            return FALSE;
+        }
+        new_filter.name = g_strdup (g_strstrip (rule));
+        new_filter.name_len = strlen (new_filter.name);
+        g_array_append_val (filters, new_filter);
     }
 
-    if (!found)
-        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_INVALID_ARGS,
-                     "Unknown log level '%s'", level);
+    if (log_filters)
+        g_array_unref (log_filters);
+    log_filters = filters;
+    log_update_enabled_levels ();
+    return TRUE;
+}
+
+/*****************************************************************************/
+
+gboolean
+mm_log_set_level (const char *level, GError **error)
+{
+    gboolean found;
+
+    found = log_level_parse (level, &log_level, error);
+    log_update_enabled_levels ();
 
 #if defined WITH_QMI
     qmi_utils_set_traces_enabled (log_level & MM_LOG_LEVEL_DEBUG ? TRUE : FALSE);
@@ -306,7 +470,10 @@ mm_log_set_level (const char *level, GError **error)
 
 gboolean
 mm_log_setup (const char *level,
+              const char *log_filter,
               const char *log_file,
+              guint64 log_file_max_size,
+              guint log_flush_interval,
               gboolean log_journal,
               gboolean show_timestamps,
               gboolean rel_timestamps,
@@ -316,6 +483,10 @@ mm_log_setup (const char *level,
     if (level && strlen (level) && !mm_log_set_level (level, error))
         return FALSE;
 
+    /* per-module and per-object levels */
+    if (log_filter && !mm_log_set_filter (log_filter, error))
+        return FALSE;
+
     if (show_timestamps)
         ts_flags = TS_FLAG_WALL;
     else if (rel_timestamps)
@@ -334,15 +505,9 @@ mm_log_setup (const char *level,
         openlog (G_LOG_DOMAIN, LOG_CONS | LOG_PID | LOG_PERROR, LOG_DAEMON);
         log_backend = log_backend_syslog;
     } else {
-        logfd = open (log_file,
-                      O_CREAT | O_APPEND | O_WRONLY,
-                      S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP);
-        if (logfd < 0) {
-            g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
-                         "Couldn't open log file: (%d) %s",
-                         errno, strerror (errno));
+        logfile = mm_log_file_new (log_file, log_file_max_size, log_flush_interval, error);
+        if (!logfile)
             return FALSE;
-        }
         log_backend = log_backend_file;
     }
 
@@ -371,8 +536,17 @@ mm_log_setup (const char *level,
 void
 mm_log_shutdown (void)
 {
-    if (logfd < 0)
+    MMLogFile *file;
+
+    if (!logfile) {
         closelog ();
-    else
-        close (logfd);
+        return;
+    }
+
+    /* Anything logged from now on goes to stderr, the file is no longer
+     * available once freed */
+    log_backend = log_backend_stderr;
+    file = g_atomic_pointer_get (&logfile);
+    g_atomic_pointer_set (&logfile, NULL);
+    mm_log_file_free (file);
 }
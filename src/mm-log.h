@@ -31,10 +31,43 @@ typedef enum {
 # define MM_MODULE_NAME (const gchar *)NULL
 #endif
 
-#define mm_obj_err(obj, ...)  _mm_log (obj, MM_MODULE_NAME, G_STRLOC, G_STRFUNC, MM_LOG_LEVEL_ERR,   ## __VA_ARGS__ )
-#define mm_obj_warn(obj, ...) _mm_log (obj, MM_MODULE_NAME, G_STRLOC, G_STRFUNC, MM_LOG_LEVEL_WARN,  ## __VA_ARGS__ )
-#define mm_obj_info(obj, ...) _mm_log (obj, MM_MODULE_NAME, G_STRLOC, G_STRFUNC, MM_LOG_LEVEL_INFO,  ## __VA_ARGS__ )
-#define mm_obj_dbg(obj, ...)  _mm_log (obj, MM_MODULE_NAME, G_STRLOC, G_STRFUNC, MM_LOG_LEVEL_DEBUG, ## __VA_ARGS__ )
+/* Levels enabled either globally or by any of the log filters, and whether
+ * there are log filters at all; not to be used directly */
+extern guint32  _mm_log_enabled_levels;
+extern gboolean _mm_log_filtered;
+
+gboolean _mm_log_check_filters (gpointer     obj,
+                                const gchar *module,
+                                MMLogLevel   level);
+
+/* Whether a message would be logged; in the common case of no log filters,
+ * just a check of the level */
+static inline gboolean
+mm_log_check_enabled (gpointer     obj,
+                      const gchar *module,
+                      MMLogLevel   level)
+{
+    if (!(_mm_log_enabled_levels & level))
+        return FALSE;
+    if (G_LIKELY (!_mm_log_filtered))
+        return TRUE;
+    return _mm_log_check_filters (obj, module, level);
+}
+
+#define mm_obj_check_enabled(obj, level) mm_log_check_enabled (obj, MM_MODULE_NAME, level)
+
+/* The message arguments are only evaluated if the message is logged */
+#define _mm_obj_log(obj, level, ...) G_STMT_START {                                     \
+        gpointer _mm_log_obj = (obj);                                                   \
+                                                                                        \
+        if (mm_log_check_enabled (_mm_log_obj, MM_MODULE_NAME, level))                  \
+            _mm_log (_mm_log_obj, MM_MODULE_NAME, G_STRLOC, G_STRFUNC, level, ## __VA_ARGS__ ); \
+    } G_STMT_END
+
+#define mm_obj_err(obj, ...)  _mm_obj_log (obj, MM_LOG_LEVEL_ERR,   ## __VA_ARGS__ )
+#define mm_obj_warn(obj, ...) _mm_obj_log (obj, MM_LOG_LEVEL_WARN,  ## __VA_ARGS__ )
+#define mm_obj_info(obj, ...) _mm_obj_log (obj, MM_LOG_LEVEL_INFO,  ## __VA_ARGS__ )
+#define mm_obj_dbg(obj, ...)  _mm_obj_log (obj, MM_LOG_LEVEL_DEBUG, ## __VA_ARGS__ )
 
 /* only allow using non-object logging API if explicitly requested
  * (e.g. in the main daemon source) */
@@ -55,8 +88,13 @@ void _mm_log (gpointer     obj,
 
 gboolean mm_log_set_level (const char *level, GError **error);
 
+gboolean mm_log_set_filter (const char *filter, GError **error);
+
 gboolean mm_log_setup (const char *level,
+                       const char *log_filter,
                        const char *log_file,
+                       guint64 log_file_max_size,
+                       guint log_flush_interval,
                        gboolean log_journal,
                        gboolean show_ts,
                        gboolean rel_ts,
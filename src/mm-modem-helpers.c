@@ -32,6 +32,7 @@
 #include "mm-modem-helpers.h"
 #include "mm-helper-enums-types.h"
 #include "mm-log-object.h"
+#include "mm-regex-registry.h"
 
 /*****************************************************************************/
 
@@ -69,6 +70,220 @@ mm_strip_tag (const gchar *str, const gchar *cmd)
 
 /*****************************************************************************/
 
+/* Exec commands whose information response is always prefixed with the
+ * command name; most others, e.g. +CGMI or +CGSN, reply just the value */
+static const gchar *prefixed_exec_commands[] = {
+    "+CSQ",
+    "+CESQ",
+    "+CBC",
+};
+
+/* Write commands whose information response is always prefixed with the
+ * command name */
+static const gchar *prefixed_write_commands[] = {
+    "+CRSM",
+};
+
+/* Returns the length of the name of the given extended command, or 0 if not
+ * an extended command */
+static gsize
+at_command_get_name_length (const gchar *command)
+{
+    const gchar *p;
+
+    if (command[0] != '+')
+        return 0;
+    for (p = command + 1; g_ascii_isalnum (*p); p++);
+    return (p - command) >= 2 ? (gsize) (p - command) : 0;
+}
+
+static const gchar *
+at_command_skip_at (const gchar *command)
+{
+    if (g_ascii_strncasecmp (command, "AT", 2) == 0)
+        return command + 2;
+    return command;
+}
+
+static gboolean
+at_command_name_in_list (const gchar        *command,
+                         gsize               len,
+                         const gchar * const *list,
+                         guint               n_items)
+{
+    guint i;
+
+    for (i = 0; i < n_items; i++) {
+        if (strlen (list[i]) == len && g_ascii_strncasecmp (command, list[i], len) == 0)
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/* Returns the prefix of the information response of the given command, if
+ * it is known to always have one */
+static gchar *
+at_command_get_response_prefix (const gchar *command)
+{
+    const gchar *p;
+    gsize        len;
+
+    command = at_command_skip_at (command);
+    len = at_command_get_name_length (command);
+    if (!len)
+        return NULL;
+    p = command + len;
+
+    /* Read and test commands always reply with the prefix */
+    if (g_str_equal (p, "?") || g_str_equal (p, "=?") ||
+        (*p == '\0' && at_command_name_in_list (command, len, prefixed_exec_commands, G_N_ELEMENTS (prefixed_exec_commands))) ||
+        (*p == '=' && at_command_name_in_list (command, len, prefixed_write_commands, G_N_ELEMENTS (prefixed_write_commands))))
+        return g_strdup_printf ("%.*s:", (gint) len, command);
+
+    return NULL;
+}
+
+/* Exec commands without a known prefix, e.g. +CIMI, may be combined with
+ * prefixed ones: their reply is whatever doesn't have any of the prefixes */
+static gboolean
+at_command_is_unprefixed_exec (const gchar *command)
+{
+    gsize len;
+
+    command = at_command_skip_at (command);
+    len = at_command_get_name_length (command);
+    return (len && command[len] == '\0');
+}
+
+/* Gets the response prefixes of the commands. At most one command may have
+ * no prefix, and the prefixes must be different, so that each line of the
+ * response can be assigned to a single command. */
+static GStrv
+at_compound_get_prefixes (const gchar * const *commands,
+                          guint                n_commands)
+{
+    g_auto(GStrv) prefixes = NULL;
+    gboolean      unprefixed = FALSE;
+    guint         i;
+    guint         j;
+
+    prefixes = g_new0 (gchar *, n_commands + 1);
+    for (i = 0; i < n_commands; i++) {
+        prefixes[i] = at_command_get_response_prefix (commands[i]);
+        if (!prefixes[i]) {
+            if (unprefixed || !at_command_is_unprefixed_exec (commands[i]))
+                return NULL;
+            unprefixed = TRUE;
+            /* Keep the array NULL-terminated at the end only */
+            prefixes[i] = g_strdup ("");
+            continue;
+        }
+        for (j = 0; j < i; j++) {
+            if (g_ascii_strcasecmp (prefixes[i], prefixes[j]) == 0)
+                return NULL;
+        }
+    }
+
+    return g_steal_pointer (&prefixes);
+}
+
+gchar *
+mm_at_compound_command_build (const gchar * const *commands,
+                              guint                n_commands)
+{
+    g_auto(GStrv)  prefixes = NULL;
+    GString       *compound;
+    guint          i;
+
+    if (n_commands < 2)
+        return NULL;
+
+    prefixes = at_compound_get_prefixes (commands, n_commands);
+    if (!prefixes)
+        return NULL;
+
+    compound = g_string_new (NULL);
+    for (i = 0; i < n_commands; i++) {
+        if (i > 0)
+            g_string_append_c (compound, ';');
+        g_string_append (compound, at_command_skip_at (commands[i]));
+    }
+
+    return g_string_free (compound, FALSE);
+}
+
+/* Assign each line of the compound response to the command whose prefix it
+ * has, or to the command without prefix if none; commands reply in order,
+ * and all of them must reply something */
+gchar **
+mm_at_compound_response_split (const gchar * const *commands,
+                               guint                n_commands,
+                               const gchar         *response)
+{
+    g_autofree gsize  *starts = NULL;
+    g_autofree gsize  *ends = NULL;
+    g_auto(GStrv)      prefixes = NULL;
+    gchar            **responses;
+    const gchar       *line;
+    gint               current = -1;
+    gint               unprefixed = -1;
+    guint              i;
+
+    prefixes = at_compound_get_prefixes (commands, n_commands);
+    if (!prefixes)
+        return NULL;
+    for (i = 0; i < n_commands; i++) {
+        if (!prefixes[i][0])
+            unprefixed = i;
+    }
+
+    starts = g_new0 (gsize, n_commands);
+    ends = g_new0 (gsize, n_commands);
+
+    for (line = response; *line; ) {
+        const gchar *eol;
+        gsize        line_len;
+
+        eol = strchr (line, '\n');
+        line_len = eol ? (gsize) (eol - line) : strlen (line);
+        while (line_len > 0 && line[line_len - 1] == '\r')
+            line_len--;
+
+        if (line_len > 0) {
+            for (i = MAX (current, 0); i < n_commands; i++) {
+                if (prefixes[i][0] && g_ascii_strncasecmp (line, prefixes[i], strlen (prefixes[i])) == 0)
+                    break;
+            }
+            if (i == n_commands && unprefixed >= MAX (current, 0))
+                i = unprefixed;
+            /* A line without any of the expected prefixes can't be assigned */
+            if (i == n_commands)
+                return NULL;
+            if ((gint) i != current) {
+                starts[i] = line - response;
+                current = i;
+            }
+            ends[i] = (line - response) + line_len;
+        }
+
+        if (!eol)
+            break;
+        line = eol + 1;
+    }
+
+    for (i = 0; i < n_commands; i++) {
+        if (!ends[i])
+            return NULL;
+    }
+
+    responses = g_new0 (gchar *, n_commands + 1);
+    for (i = 0; i < n_commands; i++)
+        responses[i] = g_strndup (&response[starts[i]], ends[i] - starts[i]);
+    return responses;
+}
+
+/*****************************************************************************/
+
 gchar **
 mm_split_string_groups (const gchar *str)
 {
@@ -499,10 +714,8 @@ mm_voice_ring_regex_get (void)
     /* Example:
      * <CR><LF>RING<CR><LF>
      */
-    return g_regex_new ("\\r\\nRING\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_get ("\\r\\nRING\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 GRegex *
@@ -512,10 +725,8 @@ mm_voice_cring_regex_get (void)
      * <CR><LF>+CRING: VOICE<CR><LF>
      * <CR><LF>+CRING: DATA<CR><LF>
      */
-    return g_regex_new ("\\r\\n\\+CRING:\\s*(\\S+)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_get ("\\r\\n\\+CRING:\\s*(\\S+)\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 GRegex *
@@ -529,10 +740,8 @@ mm_voice_clip_regex_get (void)
      *   <CR><LF>+CLIP: "+393351391306",145,,,,0<CR><LF>
      *                   \_ Number      \_ Type
      */
-    return g_regex_new ("\\r\\n\\+CLIP:\\s*([^,\\s]*)\\s*,\\s*(\\d+)\\s*,?(.*)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_get ("\\r\\n\\+CLIP:\\s*([^,\\s]*)\\s*,\\s*(\\d+)\\s*,?(.*)\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 GRegex *
@@ -546,10 +755,8 @@ mm_voice_ccwa_regex_get (void)
      *   <CR><LF>+CCWA: "+393351391306",145,1
      *                   \_ Number      \_ Type
      */
-    return g_regex_new ("\\r\\n\\+CCWA:\\s*([^,\\s]*)\\s*,\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,?(.*)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_get ("\\r\\n\\+CCWA:\\s*([^,\\s]*)\\s*,\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,?(.*)\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 static void
@@ -604,18 +811,16 @@ mm_3gpp_parse_clcc_response (const gchar  *str,
      *  ...
      */
 
-    r = g_regex_new ("\\+CLCC:\\s*(\\d+),\\s*(\\d+),\\s*(\\d+),\\s*(\\d+),\\s*(\\d+)" /* mandatory fields */
-                     "(?:,\\s*([^,]*),\\s*(\\d+)"                                     /* number and type */
-                     "(?:,\\s*([^,]*)"                                                /* alpha */
-                     "(?:,\\s*(\\d*)"                                                 /* priority */
-                     "(?:,\\s*(\\d*)"                                                 /* CLI validity */
-                     ")?)?)?)?$",
-                     G_REGEX_RAW | G_REGEX_MULTILINE | G_REGEX_NEWLINE_CRLF,
-                     G_REGEX_MATCH_NEWLINE_CRLF,
-                     NULL);
+    r = mm_regex_get ("\\+CLCC:\\s*(\\d+),\\s*(\\d+),\\s*(\\d+),\\s*(\\d+),\\s*(\\d+)" /* mandatory fields */
+                      "(?:,\\s*([^,]*),\\s*(\\d+)"                                     /* number and type */
+                      "(?:,\\s*([^,]*)"                                                /* alpha */
+                      "(?:,\\s*(\\d*)"                                                 /* priority */
+                      "(?:,\\s*(\\d*)"                                                 /* CLI validity */
+                      ")?)?)?)?$",
+                      G_REGEX_RAW | G_REGEX_MULTILINE | G_REGEX_NEWLINE_CRLF);
     g_assert (r != NULL);
 
-    g_regex_match_full (r, str, strlen (str), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, str, strlen (str), 0, G_REGEX_MATCH_NEWLINE_CRLF, &match_info, &inner_error);
     if (inner_error)
         goto out;
 
@@ -759,10 +964,10 @@ mm_parse_ifc_test_response (const gchar  *response,
     MMFlowControl  ta_mask     = MM_FLOW_CONTROL_UNKNOWN;
     MMFlowControl  mask        = MM_FLOW_CONTROL_UNKNOWN;
 
-    r = g_regex_new ("(?:\\+IFC:)?\\s*\\((.*)\\),\\((.*)\\)(?:\\r\\n)?", 0, 0, NULL);
+    r = mm_regex_get ("(?:\\+IFC:)?\\s*\\((.*)\\),\\((.*)\\)(?:\\r\\n)?", 0);
     g_assert (r != NULL);
 
-    g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
     if (inner_error)
         goto out;
 
@@ -866,10 +1071,10 @@ mm_3gpp_creg_regex_get (gboolean solicited)
 
         if (solicited) {
             pattern = g_strdup_printf ("%s$", creg_regex[i]);
-            regex = g_regex_new (pattern, G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+            regex = mm_regex_get_dynamic (pattern, G_REGEX_RAW | G_REGEX_OPTIMIZE);
         } else {
             pattern = g_strdup_printf ("\\r\\n%s\\r\\n", creg_regex[i]);
-            regex = g_regex_new (pattern, G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+            regex = mm_regex_get_dynamic (pattern, G_REGEX_RAW | G_REGEX_OPTIMIZE);
         }
         g_assert (regex);
         g_ptr_array_add (array, regex);
@@ -889,10 +1094,8 @@ mm_3gpp_creg_regex_destroy (GPtrArray *array)
 GRegex *
 mm_3gpp_ciev_regex_get (void)
 {
-    return g_regex_new ("\\r\\n\\+CIEV: (.*),(\\d)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_get ("\\r\\n\\+CIEV: (.*),(\\d)\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 /*************************************************************************/
@@ -900,10 +1103,8 @@ mm_3gpp_ciev_regex_get (void)
 GRegex *
 mm_3gpp_cgev_regex_get (void)
 {
-    return g_regex_new ("\\r\\n\\+CGEV:\\s*(.*)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_get ("\\r\\n\\+CGEV:\\s*(.*)\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 /*************************************************************************/
@@ -911,10 +1112,8 @@ mm_3gpp_cgev_regex_get (void)
 GRegex *
 mm_3gpp_cusd_regex_get (void)
 {
-    return g_regex_new ("\\r\\n\\+CUSD:\\s*(.*)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_get ("\\r\\n\\+CUSD:\\s*(.*)\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 /*************************************************************************/
@@ -922,10 +1121,8 @@ mm_3gpp_cusd_regex_get (void)
 GRegex *
 mm_3gpp_cmti_regex_get (void)
 {
-    return g_regex_new ("\\r\\n\\+CMTI:\\s*\"(\\S+)\",\\s*(\\d+)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_get ("\\r\\n\\+CMTI:\\s*\"(\\S+)\",\\s*(\\d+)\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 GRegex *
@@ -934,10 +1131,8 @@ mm_3gpp_cds_regex_get (void)
     /* Example:
      * <CR><LF>+CDS: 24<CR><LF>07914356060013F10659098136395339F6219011707193802190117071938030<CR><LF>
      */
-    return g_regex_new ("\\r\\n\\+CDS:\\s*(\\d+)\\r\\n(.*)\\r\\n",
-                        G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                        0,
-                        NULL);
+    return mm_regex_get ("\\r\\n\\+CDS:\\s*(\\d+)\\r\\n(.*)\\r\\n",
+                         G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 /*************************************************************************/
@@ -1013,10 +1208,10 @@ mm_3gpp_parse_ws46_test_response (const gchar  *response,
     gboolean    supported_mode_25 = FALSE;
     gboolean    supported_mode_29 = FALSE;
 
-    r = g_regex_new ("(?:\\+WS46:)?\\s*\\((.*)\\)(?:\\r\\n)?", 0, 0, NULL);
+    r = mm_regex_get ("(?:\\+WS46:)?\\s*\\((.*)\\)(?:\\r\\n)?", 0);
     g_assert (r != NULL);
 
-    g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
     if (inner_error)
         goto out;
 
@@ -1243,11 +1438,11 @@ mm_3gpp_parse_cops_test_response (const gchar     *reply,
      *       +COPS: (2,"","T-Mobile","31026",0),(1,"AT&T","AT&T","310410"),0)
      */
 
-    r = g_regex_new ("\\((\\d),\"([^\"\\)]*)\",([^,\\)]*),([^,\\)]*)[\\)]?,(\\d)\\)", G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_get ("\\((\\d),\"([^\"\\)]*)\",([^,\\)]*),([^,\\)]*)[\\)]?,(\\d)\\)", G_REGEX_UNGREEDY);
     g_assert (r);
 
     /* If we didn't get any hits, try the pre-UMTS format match */
-    if (!g_regex_match (r, reply, 0, &match_info)) {
+    if (!mm_regex_match (r, reply, 0, &match_info)) {
         g_regex_unref (r);
         g_match_info_free (match_info);
         match_info = NULL;
@@ -1265,10 +1460,10 @@ mm_3gpp_parse_cops_test_response (const gchar     *reply,
          *       +COPS: (2,"T - Mobile",,"31026"),(1,"Einstein PCS",,"31064"),(1,"Cingular",,"31041"),,(0,1,3),(0,2)
          */
 
-        r = g_regex_new ("\\((\\d),([^,\\)]*),([^,\\)]*),([^\\)]*)\\)", G_REGEX_UNGREEDY, 0, NULL);
+        r = mm_regex_get ("\\((\\d),([^,\\)]*),([^,\\)]*),([^\\)]*)\\)", G_REGEX_UNGREEDY);
         g_assert (r);
 
-        g_regex_match (r, reply, 0, &match_info);
+        mm_regex_match (r, reply, 0, &match_info);
         umts_format = FALSE;
     }
 
@@ -1370,10 +1565,10 @@ mm_3gpp_parse_cops_read_response (const gchar              *response,
      * or:
      *   +COPS: <mode>,<format>,<oper>,<AcT>
      */
-    r = g_regex_new ("\\+COPS:\\s*(\\d+),(\\d+),([^,]*)(?:,(\\d+))?(?:\\r\\n)?", 0, 0, NULL);
+    r = mm_regex_get ("\\+COPS:\\s*(\\d+),(\\d+),([^,]*)(?:,(\\d+))?(?:\\r\\n)?", 0);
     g_assert (r != NULL);
 
-    g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
     if (inner_error)
         goto out;
 
@@ -1633,12 +1828,11 @@ mm_3gpp_parse_cgdcont_test_response (const gchar  *response,
         return NULL;
     }
 
-    r = g_regex_new ("\\+CGDCONT:\\s*\\(\\s*(\\d+)\\s*-?\\s*(\\d+)?[^\\)]*\\)\\s*,\\s*\\(?\"(\\S+)\"",
-                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
-                     0, &inner_error);
+    r = mm_regex_get ("\\+CGDCONT:\\s*\\(\\s*(\\d+)\\s*-?\\s*(\\d+)?[^\\)]*\\)\\s*,\\s*\\(?\"(\\S+)\"",
+                      G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW);
     g_assert (r != NULL);
 
-    g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
     while (!inner_error && g_match_info_matches (match_info)) {
         gchar *pdp_type_str;
         guint min_cid;
@@ -1721,11 +1915,10 @@ mm_3gpp_parse_cgdcont_read_response (const gchar *reply,
         return NULL;
 
     list = NULL;
-    r = g_regex_new ("\\+CGDCONT:\\s*(\\d+)\\s*,([^, \\)]*)\\s*,([^, \\)]*)\\s*,([^, \\)]*)",
-                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
-                     0, &inner_error);
+    r = mm_regex_get ("\\+CGDCONT:\\s*(\\d+)\\s*,([^, \\)]*)\\s*,([^, \\)]*)\\s*,([^, \\)]*)",
+                      G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW);
     if (r) {
-        g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, &inner_error);
+        mm_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, &inner_error);
 
         while (!inner_error &&
                g_match_info_matches (match_info)) {
@@ -1806,11 +1999,11 @@ mm_3gpp_parse_cgact_read_response (const gchar *reply,
         return NULL;
 
     list = NULL;
-    r = g_regex_new ("\\+CGACT:\\s*(\\d+),(\\d+)",
-                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW, 0, &inner_error);
+    r = mm_regex_get ("\\+CGACT:\\s*(\\d+),(\\d+)",
+                      G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW);
     g_assert (r);
 
-    g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, &inner_error);
     while (!inner_error && g_match_info_matches (match_info)) {
         MM3gppPdpContextActive *pdp_active;
         guint cid = 0;
@@ -2049,11 +2242,10 @@ mm_3gpp_parse_cmgf_test_response (const gchar *reply,
     while (isspace (*reply))
         reply++;
 
-    r = g_regex_new ("\\(?\\s*(\\d+)\\s*[-,]?\\s*(\\d+)?\\s*\\)?", 0, 0, error);
-    if (!r)
-        return FALSE;
+    r = mm_regex_get ("\\(?\\s*(\\d+)\\s*[-,]?\\s*(\\d+)?\\s*\\)?", 0);
+    g_assert (r != NULL);
 
-    if (!g_regex_match (r, reply, 0, &match_info)) {
+    if (!mm_regex_match (r, reply, 0, &match_info)) {
         g_set_error (error,
                      MM_CORE_ERROR,
                      MM_CORE_ERROR_FAILED,
@@ -2101,10 +2293,10 @@ mm_3gpp_parse_cmgr_read_response (const gchar *reply,
 
     /* +CMGR: <stat>,<alpha>,<length>(whitespace)<pdu> */
     /* The <alpha> and <length> fields are matched, but not currently used */
-    r = g_regex_new ("\\+CMGR:\\s*(\\d+)\\s*,([^,]*),\\s*(\\d+)\\s*([^\\r\\n]*)", 0, 0, NULL);
+    r = mm_regex_get ("\\+CMGR:\\s*(\\d+)\\s*,([^,]*),\\s*(\\d+)\\s*([^\\r\\n]*)", 0);
     g_assert (r);
 
-    if (!g_regex_match (r, reply, 0, &match_info)) {
+    if (!mm_regex_match (r, reply, 0, &match_info)) {
         g_set_error (error,
                      MM_CORE_ERROR,
                      MM_CORE_ERROR_FAILED,
@@ -2182,11 +2374,11 @@ mm_3gpp_parse_crsm_response (const gchar *reply,
         return FALSE;
     }
 
-    r = g_regex_new ("\\+CRSM:\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,\\s*\"?([0-9a-fA-F]+)\"?",
-                     G_REGEX_RAW, 0, NULL);
+    r = mm_regex_get ("\\+CRSM:\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,\\s*\"?([0-9a-fA-F]+)\"?",
+                      G_REGEX_RAW);
     g_assert (r != NULL);
 
-    if (g_regex_match (r, reply, 0, &match_info) &&
+    if (mm_regex_match (r, reply, 0, &match_info) &&
         mm_get_uint_from_match_info (match_info, 1, sw1) &&
         mm_get_uint_from_match_info (match_info, 2, sw2))
         *hex = mm_get_string_unquoted_from_match_info (match_info, 3);
@@ -2296,19 +2488,19 @@ mm_3gpp_parse_cgcontrdp_response (const gchar  *response,
      * The format of the response changed in TS 27.007 v9.4.0, we try to detect
      * both formats ('a' if >= v9.4.0, 'b' if < v9.4.0) with a single regex here.
      */
-    r = g_regex_new ("\\+CGCONTRDP: "
-                     "(\\d+),(\\d+),([^,]*)" /* cid, bearer id, apn */
-                     "(?:,([^,]*))?" /* (a)ip+mask        or (b)ip */
-                     "(?:,([^,]*))?" /* (a)gateway        or (b)mask */
-                     "(?:,([^,]*))?" /* (a)dns1           or (b)gateway */
-                     "(?:,([^,]*))?" /* (a)dns2           or (b)dns1 */
-                     "(?:,([^,]*))?" /* (a)p-cscf primary or (b)dns2 */
-                     "(?:,(.*))?"    /* others, ignored */
-                     "(?:\\r\\n)?",
-                     0, 0, NULL);
+    r = mm_regex_get ("\\+CGCONTRDP: "
+                      "(\\d+),(\\d+),([^,]*)" /* cid, bearer id, apn */
+                      "(?:,([^,]*))?" /* (a)ip+mask        or (b)ip */
+                      "(?:,([^,]*))?" /* (a)gateway        or (b)mask */
+                      "(?:,([^,]*))?" /* (a)dns1           or (b)gateway */
+                      "(?:,([^,]*))?" /* (a)dns2           or (b)dns1 */
+                      "(?:,([^,]*))?" /* (a)p-cscf primary or (b)dns2 */
+                      "(?:,(.*))?"    /* others, ignored */
+                      "(?:\\r\\n)?",
+                      0);
     g_assert (r != NULL);
 
-    g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
     if (inner_error)
         goto out;
 
@@ -2420,10 +2612,10 @@ mm_3gpp_parse_cfun_query_response (const gchar  *response,
      * +CFUN: 1,0
      *   ..but we don't care about the second number
      */
-    r = g_regex_new ("\\+CFUN: (\\d+)(?:,(?:\\d+))?(?:\\r\\n)?", 0, 0, NULL);
+    r = mm_regex_get ("\\+CFUN: (\\d+)(?:,(?:\\d+))?(?:\\r\\n)?", 0);
     g_assert (r != NULL);
 
-    g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
     if (inner_error)
         goto out;
 
@@ -2487,10 +2679,10 @@ mm_3gpp_parse_cesq_response (const gchar  *response,
     /* Response may be e.g.:
      * +CESQ: 99,99,255,255,20,80
      */
-    r = g_regex_new ("\\+CESQ: (\\d+),(\\d+),(\\d+),(\\d+),(\\d+),(\\d+)(?:\\r\\n)?", 0, 0, NULL);
+    r = mm_regex_get ("\\+CESQ: (\\d+),(\\d+),(\\d+),(\\d+),(\\d+),(\\d+)(?:\\r\\n)?", 0);
     g_assert (r != NULL);
 
-    g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
     if (!inner_error && g_match_info_matches (match_info)) {
         if (!mm_get_uint_from_match_info (match_info, 1, &rxlev)) {
             inner_error = g_error_new (MM_CORE_ERROR, MM_CORE_ERROR_FAILED, "Couldn't read RXLEV");
@@ -2795,13 +2987,11 @@ mm_3gpp_parse_ccwa_service_query_response (const gchar  *response,
      *
      * We're only interested in class 1 (voice)
      */
-    r = g_regex_new ("\\+CCWA:\\s*(\\d+),\\s*(\\d+)$",
-                     G_REGEX_RAW | G_REGEX_MULTILINE | G_REGEX_NEWLINE_CRLF,
-                     G_REGEX_MATCH_NEWLINE_CRLF,
-                     NULL);
+    r = mm_regex_get ("\\+CCWA:\\s*(\\d+),\\s*(\\d+)$",
+                      G_REGEX_RAW | G_REGEX_MULTILINE | G_REGEX_NEWLINE_CRLF);
     g_assert (r != NULL);
 
-    g_regex_match_full (r, response, strlen (response), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, response, strlen (response), 0, G_REGEX_MATCH_NEWLINE_CRLF, &match_info, &inner_error);
     if (inner_error)
         goto out;
 
@@ -2904,7 +3094,7 @@ mm_3gpp_parse_cpms_test_response (const gchar  *reply,
         return FALSE;
     }
 
-    r = g_regex_new ("\\s*\"([^,\\)]+)\"\\s*", 0, 0, NULL);
+    r = mm_regex_get ("\\s*\"([^,\\)]+)\"\\s*", 0);
     g_assert (r);
 
     for (i = 0; i < N_EXPECTED_GROUPS; i++) {
@@ -2915,7 +3105,7 @@ mm_3gpp_parse_cpms_test_response (const gchar  *reply,
         array = g_array_new (FALSE, FALSE, sizeof (MMSmsStorage));
 
         /* Got a range group to match */
-        if (g_regex_match (r, split[i], 0, &match_info)) {
+        if (mm_regex_match (r, split[i], 0, &match_info)) {
             while (g_match_info_matches (match_info)) {
                 gchar *str;
 
@@ -2977,11 +3167,11 @@ mm_3gpp_parse_cpms_query_response (const gchar *reply,
     gboolean ret = FALSE;
     GMatchInfo *match_info = NULL;
 
-    r = g_regex_new (CPMS_QUERY_REGEX, G_REGEX_RAW, 0, NULL);
+    r = mm_regex_get (CPMS_QUERY_REGEX, G_REGEX_RAW);
 
     g_assert (r);
 
-    if (!g_regex_match (r, reply, 0, &match_info)) {
+    if (!mm_regex_match (r, reply, 0, &match_info)) {
         g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
                      "Could not parse CPMS query response '%s'", reply);
         goto end;
@@ -3066,11 +3256,11 @@ mm_3gpp_parse_cscs_test_response (const gchar *reply,
     }
 
     /* Now parse each charset */
-    r = g_regex_new ("\\s*([^,\\)]+)\\s*", 0, 0, NULL);
+    r = mm_regex_get ("\\s*([^,\\)]+)\\s*", 0);
     if (!r)
         return FALSE;
 
-    if (g_regex_match (r, p, 0, &match_info)) {
+    if (mm_regex_match (r, p, 0, &match_info)) {
         while (g_match_info_matches (match_info)) {
             str = g_match_info_fetch (match_info, 1);
             charsets |= mm_modem_charset_from_string (str);
@@ -3108,11 +3298,11 @@ mm_3gpp_parse_clck_test_response (const gchar *reply,
     reply = mm_strip_tag (reply, "+CLCK:");
 
     /* Now parse each facility */
-    r = g_regex_new ("\\s*\"([^,\\)]+)\"\\s*", 0, 0, NULL);
+    r = mm_regex_get ("\\s*\"([^,\\)]+)\"\\s*", 0);
     g_assert (r != NULL);
 
     *out_facilities = MM_MODEM_3GPP_FACILITY_NONE;
-    if (g_regex_match (r, reply, 0, &match_info)) {
+    if (mm_regex_match (r, reply, 0, &match_info)) {
         while (g_match_info_matches (match_info)) {
             gchar *str;
 
@@ -3146,10 +3336,10 @@ mm_3gpp_parse_clck_write_response (const gchar *reply,
 
     reply = mm_strip_tag (reply, "+CLCK:");
 
-    r = g_regex_new ("\\s*([01])\\s*", 0, 0, NULL);
+    r = mm_regex_get ("\\s*([01])\\s*", 0);
     g_assert (r != NULL);
 
-    if (g_regex_match (r, reply, 0, &match_info)) {
+    if (mm_regex_match (r, reply, 0, &match_info)) {
         gchar *str;
 
         str = g_match_info_fetch (match_info, 1);
@@ -3186,12 +3376,12 @@ mm_3gpp_parse_cnum_exec_response (const gchar *reply)
     if (!reply || !reply[0])
         return NULL;
 
-    r = g_regex_new ("\\+CNUM:\\s*((\"([^\"]|(\\\"))*\")|([^,]*)),\"(?<num>\\S+)\",\\d",
-                     G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_get ("\\+CNUM:\\s*((\"([^\"]|(\\\"))*\")|([^,]*)),\"(?<num>\\S+)\",\\d",
+                      G_REGEX_UNGREEDY);
     g_assert (r != NULL);
 
     array = g_ptr_array_new ();
-    g_regex_match (r, reply, 0, &match_info);
+    mm_regex_match (r, reply, 0, &match_info);
     while (g_match_info_matches (match_info)) {
         g_autofree gchar *number = NULL;
 
@@ -3416,7 +3606,7 @@ mm_3gpp_parse_cind_test_response (const gchar *reply,
     while (isspace (*reply))
         reply++;
 
-    r = g_regex_new ("\\(([^,]*),\\((\\d+)[-,](\\d+).*\\)", G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_get ("\\(([^,]*),\\((\\d+)[-,](\\d+).*\\)", G_REGEX_UNGREEDY);
     if (!r) {
         g_set_error_literal (error,
                              MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
@@ -3426,7 +3616,7 @@ mm_3gpp_parse_cind_test_response (const gchar *reply,
 
     hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) cind_response_free);
 
-    if (g_regex_match (r, reply, 0, &match_info)) {
+    if (mm_regex_match (r, reply, 0, &match_info)) {
         while (g_match_info_matches (match_info)) {
             MM3gppCindResponse *resp;
             gchar *desc, *tmp;
@@ -3480,10 +3670,10 @@ mm_3gpp_parse_cind_read_response (const gchar *reply,
 
     reply = mm_strip_tag (reply, CIND_TAG);
 
-    r = g_regex_new ("(\\d+)[^0-9]+", G_REGEX_UNGREEDY, 0, NULL);
+    r = mm_regex_get ("(\\d+)[^0-9]+", G_REGEX_UNGREEDY);
     g_assert (r != NULL);
 
-    if (!g_regex_match (r, reply, 0, &match_info)) {
+    if (!mm_regex_match (r, reply, 0, &match_info)) {
         g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
                      "Could not parse the +CIND response '%s': didn't match",
                      reply);
@@ -3640,14 +3830,14 @@ mm_3gpp_parse_cgev_indication_pdp (const gchar  *str,
               type == MM_3GPP_CGEV_NW_DEACT_PDP ||
               type == MM_3GPP_CGEV_ME_DEACT_PDP);
 
-    r = g_regex_new ("(?:"
-                     "REJECT|"
-                     "NW REACT|"
-                     "NW DEACT|ME DEACT"
-                     ")\\s*([^,]*),\\s*([^,]*)(?:,\\s*([0-9]+))?", 0, 0, NULL);
+    r = mm_regex_get ("(?:"
+                      "REJECT|"
+                      "NW REACT|"
+                      "NW DEACT|ME DEACT"
+                      ")\\s*([^,]*),\\s*([^,]*)(?:,\\s*([0-9]+))?", 0);
 
     str = mm_strip_tag (str, "+CGEV:");
-    g_regex_match_full (r, str, strlen (str), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, str, strlen (str), 0, 0, &match_info, &inner_error);
     if (inner_error)
         goto out;
 
@@ -3724,13 +3914,13 @@ mm_3gpp_parse_cgev_indication_primary (const gchar  *str,
               (type == MM_3GPP_CGEV_NW_DEACT_PRIMARY) ||
               (type == MM_3GPP_CGEV_ME_DEACT_PRIMARY));
 
-    r = g_regex_new ("(?:"
-                     "NW PDN ACT|ME PDN ACT|"
-                     "NW PDN DEACT|ME PDN DEACT|"
-                     ")\\s*([0-9]+)", 0, 0, NULL);
+    r = mm_regex_get ("(?:"
+                      "NW PDN ACT|ME PDN ACT|"
+                      "NW PDN DEACT|ME PDN DEACT|"
+                      ")\\s*([0-9]+)", 0);
 
     str = mm_strip_tag (str, "+CGEV:");
-    g_regex_match_full (r, str, strlen (str), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, str, strlen (str), 0, 0, &match_info, &inner_error);
     if (inner_error)
         goto out;
 
@@ -3785,13 +3975,13 @@ mm_3gpp_parse_cgev_indication_secondary (const gchar  *str,
               type == MM_3GPP_CGEV_NW_DEACT_SECONDARY ||
               type == MM_3GPP_CGEV_ME_DEACT_SECONDARY);
 
-    r = g_regex_new ("(?:"
-                     "NW ACT|ME ACT|"
-                     "NW DEACT|ME DEACT"
-                     ")\\s*([0-9]+),\\s*([0-9]+),\\s*([0-9]+)", 0, 0, NULL);
+    r = mm_regex_get ("(?:"
+                      "NW ACT|ME ACT|"
+                      "NW DEACT|ME DEACT"
+                      ")\\s*([0-9]+),\\s*([0-9]+),\\s*([0-9]+)", 0);
 
     str = mm_strip_tag (str, "+CGEV:");
-    g_regex_match_full (r, str, strlen (str), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, str, strlen (str), 0, 0, &match_info, &inner_error);
     if (inner_error)
         goto out;
 
@@ -3849,6 +4039,51 @@ mm_3gpp_pdu_info_list_free (GList *info_list)
     g_list_free_full (info_list, (GDestroyNotify)mm_3gpp_pdu_info_free);
 }
 
+#define CMGL_TAG "+CMGL:"
+
+static const gchar *
+find_crlf (const gchar *data,
+           gsize        len)
+{
+    const gchar *p;
+
+    for (p = memchr (data, '\r', len); p; p = memchr (p + 1, '\r', len - (p + 1 - data))) {
+        if ((gsize) (p + 1 - data) >= len)
+            return NULL;
+        if (p[1] == '\n')
+            return p;
+    }
+    return NULL;
+}
+
+gsize
+mm_3gpp_cmgl_record_len (const gchar *data,
+                         gsize        len)
+{
+    const gchar *end;
+    const gchar *header_end;
+    const gchar *data_end;
+    const gchar *p;
+
+    end = data + len;
+    p = data;
+    while ((end - p) >= 2 && p[0] == '\r' && p[1] == '\n')
+        p += 2;
+
+    if ((gsize) (end - p) < strlen (CMGL_TAG) || strncmp (p, CMGL_TAG, strlen (CMGL_TAG)) != 0)
+        return 0;
+
+    header_end = find_crlf (p, end - p);
+    if (!header_end)
+        return 0;
+
+    data_end = find_crlf (header_end + 2, end - (header_end + 2));
+    if (!data_end)
+        return 0;
+
+    return (data_end + 2) - data;
+}
+
 GList *
 mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
                                  GError **error)
@@ -3865,11 +4100,11 @@ mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
      *
      * We just read <index>, <stat> and the PDU itself.
      */
-    r = g_regex_new ("\\+CMGL:\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,(.*)\\r\\n([^\\r\\n]*)(\\r\\n)?",
-                     G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, NULL);
+    r = mm_regex_get ("\\+CMGL:\\s*(\\d+)\\s*,\\s*(\\d+)\\s*,(.*)\\r\\n([^\\r\\n]*)(\\r\\n)?",
+                      G_REGEX_RAW | G_REGEX_OPTIMIZE);
     g_assert (r != NULL);
 
-    g_regex_match_full (r, str, strlen (str), 0, 0, &match_info, &inner_error);
+    mm_regex_match_full (r, str, strlen (str), 0, 0, &match_info, &inner_error);
     while (!inner_error && g_match_info_matches (match_info)) {
         MM3gppPduInfo *info;
 
@@ -4611,12 +4846,11 @@ mm_cdma_parse_crm_test_response (const gchar *reply,
      *   <--- +CRM: (0-2)
      */
 
-    r = g_regex_new ("\\+CRM:\\s*\\((\\d+)-(\\d+)\\)",
-                     G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW,
-                     0, error);
+    r = mm_regex_get ("\\+CRM:\\s*\\((\\d+)-(\\d+)\\)",
+                      G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW);
     g_assert (r != NULL);
 
-    if (g_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, &match_error)) {
+    if (mm_regex_match_full (r, reply, strlen (reply), 0, 0, &match_info, &match_error)) {
         gchar *aux;
         guint min_val = 0;
         guint max_val = 0;
@@ -4899,10 +5133,10 @@ mm_parse_cclk_response (const char *response,
      *  +CCLK: "15/03/05,14:14:26-32"
      *  +CCLK: 17/07/26,11:42:15+01
      */
-    r = g_regex_new ("\\+CCLK:\\s*\"?(\\d+)/(\\d+)/(\\d+),(\\d+):(\\d+):(\\d+)([-+]\\d+)?\"?", 0, 0, NULL);
+    r = mm_regex_get ("\\+CCLK:\\s*\"?(\\d+)/(\\d+)/(\\d+),(\\d+):(\\d+):(\\d+)([-+]\\d+)?\"?", 0);
     g_assert (r != NULL);
 
-    if (!g_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
+    if (!mm_regex_match_full (r, response, -1, 0, 0, &match_info, &match_error)) {
         if (match_error) {
             g_propagate_error (error, match_error);
             g_prefix_error (error, "Could not parse +CCLK results: ");
@@ -4991,8 +5225,8 @@ mm_parse_csim_response (const gchar *response,
     guint hex_code;
     GError *inner_error = NULL;
 
-    r = g_regex_new ("\\+CSIM:\\s*[0-9]+,\\s*\".*([0-9a-fA-F]{4})\"", G_REGEX_RAW, 0, NULL);
-    g_regex_match (r, response, 0, &match_info);
+    r = mm_regex_get ("\\+CSIM:\\s*[0-9]+,\\s*\".*([0-9a-fA-F]{4})\"", G_REGEX_RAW);
+    mm_regex_match (r, response, 0, &match_info);
 
     if (!g_match_info_matches (match_info)) {
         inner_error = g_error_new (MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
@@ -50,6 +50,16 @@ const gchar *mm_strip_tag    (const gchar *str,
 
 gchar **mm_split_string_groups (const gchar *str);
 
+/* Compound commands, e.g. "AT+CPIN?;+CSQ". Only commands known to prefix
+ * their information response with the command name can be combined, plus at
+ * most one exec command without prefix (e.g. +CIMI), so that the response
+ * can be split back; both return NULL otherwise. */
+gchar  *mm_at_compound_command_build  (const gchar * const  *commands,
+                                       guint                 n_commands);
+gchar **mm_at_compound_response_split (const gchar * const  *commands,
+                                       guint                 n_commands,
+                                       const gchar          *response);
+
 GArray *mm_parse_uint_list (const gchar  *str,
                             GError      **error);
 
@@ -355,6 +365,12 @@ void   mm_3gpp_pdu_info_list_free      (GList *info_list);
 GList *mm_3gpp_parse_pdu_cmgl_response (const gchar *str,
                                         GError **error);
 
+/* Length of the complete +CMGL record (header and data lines, including any
+ * leading empty line) found at the start of a partial AT+CMGL response,
+ * or 0 if there is none yet. Valid for both PDU and text modes. */
+gsize mm_3gpp_cmgl_record_len (const gchar *data,
+                               gsize        len);
+
 /* AT+CMGR (Read message) response parser */
 MM3gppPduInfo *mm_3gpp_parse_cmgr_read_response (const gchar *reply,
                                                  guint index,
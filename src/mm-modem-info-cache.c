@@ -0,0 +1,106 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+
+#include "mm-modem-info-cache.h"
+#include "mm-state-key-file.h"
+#include "mm-log-object.h"
+
+#define CACHE_KEY_EQUIPMENT_ID "equipment-id"
+#define CACHE_KEY_REVISION     "revision"
+
+static MMStateKeyFile cache = MM_STATE_KEY_FILE_INIT ("modem-info-cache", "modem info cache");
+
+gboolean
+mm_modem_info_cache_validate (const gchar *uid,
+                              const gchar *equipment_id,
+                              const gchar *revision,
+                              gpointer     log_object)
+{
+    GKeyFile         *key_file;
+    g_autofree gchar *cached_equipment_id = NULL;
+    g_autofree gchar *cached_revision = NULL;
+
+    g_return_val_if_fail (uid && equipment_id && revision, FALSE);
+
+    key_file = mm_state_key_file_peek (&cache, log_object);
+    cached_equipment_id = g_key_file_get_string (key_file, uid, CACHE_KEY_EQUIPMENT_ID, NULL);
+    cached_revision = g_key_file_get_string (key_file, uid, CACHE_KEY_REVISION, NULL);
+    if (!g_strcmp0 (cached_equipment_id, equipment_id) && !g_strcmp0 (cached_revision, revision)) {
+        mm_obj_dbg (log_object, "cached modem info is valid");
+        return TRUE;
+    }
+
+    /* Either a different device in the same physical location, or a firmware
+     * upgrade; start over */
+    if (g_key_file_has_group (key_file, uid)) {
+        mm_obj_dbg (log_object, "cached modem info is stale, removing it");
+        g_key_file_remove_group (key_file, uid, NULL);
+    }
+    g_key_file_set_string (key_file, uid, CACHE_KEY_EQUIPMENT_ID, equipment_id);
+    g_key_file_set_string (key_file, uid, CACHE_KEY_REVISION, revision);
+    mm_state_key_file_save (&cache, log_object);
+    return FALSE;
+}
+
+GVariant *
+mm_modem_info_cache_lookup (const gchar        *uid,
+                            const gchar        *key,
+                            const GVariantType *type,
+                            gpointer            log_object)
+{
+    g_autofree gchar *text = NULL;
+    GVariant         *value;
+    GError           *error = NULL;
+
+    text = g_key_file_get_string (mm_state_key_file_peek (&cache, log_object), uid, key, NULL);
+    if (!text)
+        return NULL;
+
+    value = g_variant_parse (type, text, NULL, NULL, &error);
+    if (!value) {
+        mm_obj_warn (log_object, "couldn't parse cached '%s': %s", key, error->message);
+        g_error_free (error);
+        return NULL;
+    }
+    return value;
+}
+
+void
+mm_modem_info_cache_store (const gchar *uid,
+                           const gchar *key,
+                           GVariant    *value,
+                           gpointer     log_object)
+{
+    GKeyFile         *key_file;
+    g_autofree gchar *text = NULL;
+    g_autofree gchar *current = NULL;
+
+    key_file = mm_state_key_file_peek (&cache, log_object);
+
+    /* Nothing to store if the identity of the device wasn't validated */
+    if (!g_key_file_has_group (key_file, uid)) {
+        g_variant_unref (g_variant_ref_sink (value));
+        return;
+    }
+
+    text = g_variant_print (g_variant_ref_sink (value), TRUE);
+    g_variant_unref (value);
+    current = g_key_file_get_string (key_file, uid, key, NULL);
+    if (!g_strcmp0 (current, text))
+        return;
+
+    g_key_file_set_string (key_file, uid, key, text);
+    mm_state_key_file_save (&cache, log_object);
+}
@@ -0,0 +1,38 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_MODEM_INFO_CACHE_H
+#define MM_MODEM_INFO_CACHE_H
+
+#include <glib.h>
+
+/* Persistent cache of static modem information (e.g. supported modes), keyed
+ * by the physical device UID. The cached information of a device is only
+ * valid while its equipment identifier and firmware revision don't change;
+ * validating with a different identity drops all of it. Stored values are
+ * consumed if floating. */
+
+gboolean  mm_modem_info_cache_validate (const gchar        *uid,
+                                        const gchar        *equipment_id,
+                                        const gchar        *revision,
+                                        gpointer            log_object);
+GVariant *mm_modem_info_cache_lookup   (const gchar        *uid,
+                                        const gchar        *key,
+                                        const GVariantType *type,
+                                        gpointer            log_object);
+void      mm_modem_info_cache_store    (const gchar        *uid,
+                                        const gchar        *key,
+                                        GVariant           *value,
+                                        gpointer            log_object);
+
+#endif /* MM_MODEM_INFO_CACHE_H */
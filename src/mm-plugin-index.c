@@ -0,0 +1,234 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+
+#include "mm-plugin-index.h"
+
+/* Each filter is a dimension of the index; an entry is a candidate only if it
+ * passes all of them, either because it has no filter of that kind (wildcard)
+ * or because one of the keys it registered matches the port. */
+typedef enum {
+    DIMENSION_SUBSYSTEM,
+    DIMENSION_DRIVER,
+    DIMENSION_ID,
+    DIMENSION_UDEV_TAG,
+    N_DIMENSIONS
+} Dimension;
+
+struct _MMPluginIndex {
+    guint       n_entries;
+    GArray     *wildcards[N_DIMENSIONS];
+    GHashTable *subsystems;
+    GHashTable *drivers;
+    GHashTable *vendor_ids;
+    GHashTable *product_ids;
+    GHashTable *udev_tags;
+};
+
+#define PRODUCT_ID_KEY(vid, pid) GUINT_TO_POINTER (((guint)(vid) << 16) | (guint)(pid))
+
+/*****************************************************************************/
+
+static GHashTable *
+entries_table_new (GHashFunc  hash_func,
+                   GEqualFunc equal_func,
+                   gboolean   string_keys)
+{
+    return g_hash_table_new_full (hash_func,
+                                  equal_func,
+                                  string_keys ? g_free : NULL,
+                                  (GDestroyNotify) g_array_unref);
+}
+
+static void
+entries_table_add (GHashTable    *table,
+                   gconstpointer  key,
+                   gboolean       string_key,
+                   guint          position)
+{
+    GArray *entries;
+
+    entries = g_hash_table_lookup (table, key);
+    if (!entries) {
+        entries = g_array_new (FALSE, FALSE, sizeof (guint));
+        g_hash_table_insert (table, string_key ? g_strdup (key) : (gpointer) key, entries);
+    }
+
+    /* Filters listing the same key twice register the entry once */
+    if (!entries->len || g_array_index (entries, guint, entries->len - 1) != position)
+        g_array_append_val (entries, position);
+}
+
+/* Moves each entry from the given dimension to the next one; entries that
+ * already moved (e.g. matched by several keys) are left untouched, so that once
+ * all dimensions are processed, candidates are those at N_DIMENSIONS */
+static void
+entries_mark (GArray    *entries,
+              guint8    *matches,
+              Dimension  dimension)
+{
+    guint i;
+
+    if (!entries)
+        return;
+
+    for (i = 0; i < entries->len; i++) {
+        guint position;
+
+        position = g_array_index (entries, guint, i);
+        if (matches[position] == dimension)
+            matches[position] = dimension + 1;
+    }
+}
+
+/*****************************************************************************/
+
+guint
+mm_plugin_index_add (MMPluginIndex         *self,
+                     const gchar          **subsystems,
+                     const gchar          **drivers,
+                     const guint16         *vendor_ids,
+                     const mm_uint16_pair  *product_ids,
+                     gboolean               ids_optional,
+                     const gchar          **udev_tags)
+{
+    guint position;
+    guint i;
+
+    g_assert (self->n_entries < G_MAXUINT);
+    position = self->n_entries++;
+
+    if (subsystems) {
+        for (i = 0; subsystems[i]; i++)
+            entries_table_add (self->subsystems, subsystems[i], TRUE, position);
+    } else
+        g_array_append_val (self->wildcards[DIMENSION_SUBSYSTEM], position);
+
+    if (drivers) {
+        for (i = 0; drivers[i]; i++)
+            entries_table_add (self->drivers, drivers[i], TRUE, position);
+    } else
+        g_array_append_val (self->wildcards[DIMENSION_DRIVER], position);
+
+    if ((vendor_ids || product_ids) && !ids_optional) {
+        for (i = 0; vendor_ids && vendor_ids[i]; i++)
+            entries_table_add (self->vendor_ids, GUINT_TO_POINTER ((guint) vendor_ids[i]), FALSE, position);
+        for (i = 0; product_ids && product_ids[i].l; i++)
+            entries_table_add (self->product_ids, PRODUCT_ID_KEY (product_ids[i].l, product_ids[i].r), FALSE, position);
+    } else
+        g_array_append_val (self->wildcards[DIMENSION_ID], position);
+
+    if (udev_tags) {
+        for (i = 0; udev_tags[i]; i++)
+            entries_table_add (self->udev_tags, udev_tags[i], TRUE, position);
+    } else
+        g_array_append_val (self->wildcards[DIMENSION_UDEV_TAG], position);
+
+    return position;
+}
+
+guint
+mm_plugin_index_get_n_entries (MMPluginIndex *self)
+{
+    return self->n_entries;
+}
+
+guint8 *
+mm_plugin_index_lookup (MMPluginIndex             *self,
+                        const gchar               *subsystem,
+                        const gchar              **drivers,
+                        guint16                    vendor,
+                        guint16                    product,
+                        MMPluginIndexUdevTagFunc   udev_tag_func,
+                        gpointer                   user_data)
+{
+    guint8 *matches;
+    guint   i;
+
+    matches = g_new0 (guint8, self->n_entries);
+
+    entries_mark (self->wildcards[DIMENSION_SUBSYSTEM], matches, DIMENSION_SUBSYSTEM);
+    if (subsystem)
+        entries_mark (g_hash_table_lookup (self->subsystems, subsystem), matches, DIMENSION_SUBSYSTEM);
+
+    if (!drivers) {
+        for (i = 0; i < self->n_entries; i++)
+            if (matches[i] == DIMENSION_DRIVER)
+                matches[i] = DIMENSION_DRIVER + 1;
+    } else {
+        entries_mark (self->wildcards[DIMENSION_DRIVER], matches, DIMENSION_DRIVER);
+        for (i = 0; drivers[i]; i++)
+            entries_mark (g_hash_table_lookup (self->drivers, drivers[i]), matches, DIMENSION_DRIVER);
+    }
+
+    entries_mark (self->wildcards[DIMENSION_ID], matches, DIMENSION_ID);
+    if (vendor) {
+        entries_mark (g_hash_table_lookup (self->vendor_ids, GUINT_TO_POINTER ((guint) vendor)), matches, DIMENSION_ID);
+        if (product)
+            entries_mark (g_hash_table_lookup (self->product_ids, PRODUCT_ID_KEY (vendor, product)), matches, DIMENSION_ID);
+    }
+
+    /* Only the tags registered by some entry are checked in the port */
+    entries_mark (self->wildcards[DIMENSION_UDEV_TAG], matches, DIMENSION_UDEV_TAG);
+    if (udev_tag_func) {
+        GHashTableIter  iter;
+        const gchar    *tag;
+        GArray         *entries;
+
+        g_hash_table_iter_init (&iter, self->udev_tags);
+        while (g_hash_table_iter_next (&iter, (gpointer *) &tag, (gpointer *) &entries)) {
+            if (udev_tag_func (tag, user_data))
+                entries_mark (entries, matches, DIMENSION_UDEV_TAG);
+        }
+    }
+
+    for (i = 0; i < self->n_entries; i++)
+        matches[i] = (matches[i] == N_DIMENSIONS);
+
+    return matches;
+}
+
+/*****************************************************************************/
+
+MMPluginIndex *
+mm_plugin_index_new (void)
+{
+    MMPluginIndex *self;
+    guint          i;
+
+    self = g_slice_new0 (MMPluginIndex);
+    for (i = 0; i < N_DIMENSIONS; i++)
+        self->wildcards[i] = g_array_new (FALSE, FALSE, sizeof (guint));
+    self->subsystems  = entries_table_new (g_str_hash, g_str_equal, TRUE);
+    self->drivers     = entries_table_new (g_str_hash, g_str_equal, TRUE);
+    self->vendor_ids  = entries_table_new (g_direct_hash, g_direct_equal, FALSE);
+    self->product_ids = entries_table_new (g_direct_hash, g_direct_equal, FALSE);
+    self->udev_tags   = entries_table_new (g_str_hash, g_str_equal, TRUE);
+    return self;
+}
+
+void
+mm_plugin_index_free (MMPluginIndex *self)
+{
+    guint i;
+
+    for (i = 0; i < N_DIMENSIONS; i++)
+        g_array_unref (self->wildcards[i]);
+    g_hash_table_unref (self->subsystems);
+    g_hash_table_unref (self->drivers);
+    g_hash_table_unref (self->vendor_ids);
+    g_hash_table_unref (self->product_ids);
+    g_hash_table_unref (self->udev_tags);
+    g_slice_free (MMPluginIndex, self);
+}
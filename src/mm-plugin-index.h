@@ -0,0 +1,63 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_PLUGIN_INDEX_H
+#define MM_PLUGIN_INDEX_H
+
+#include <glib.h>
+
+#include "mm-private-boxed-types.h"
+
+/* Index of the allow-list pre-probing filters of the plugins (subsystems,
+ * drivers, vendor/product IDs and udev tags), so that the set of plugins that
+ * may support a given port is found with a few hash table lookups instead of
+ * running every filter of every plugin.
+ *
+ * The lookup returns a superset of the plugins that pass those filters; the
+ * remaining checks (forbidden drivers, forbidden product IDs...) must still be
+ * run on each of the candidates. */
+
+typedef struct _MMPluginIndex MMPluginIndex;
+
+typedef gboolean (* MMPluginIndexUdevTagFunc) (const gchar *tag,
+                                               gpointer     user_data);
+
+MMPluginIndex *mm_plugin_index_new  (void);
+void           mm_plugin_index_free (MMPluginIndex *self);
+
+/* Returns the position of the new entry, entries are numbered in the same
+ * order as they're added. If ids_optional is TRUE, the vendor and product IDs
+ * are not used as a filter, e.g. because the plugin also accepts vendor or
+ * product strings. */
+guint   mm_plugin_index_add           (MMPluginIndex         *self,
+                                       const gchar          **subsystems,
+                                       const gchar          **drivers,
+                                       const guint16         *vendor_ids,
+                                       const mm_uint16_pair  *product_ids,
+                                       gboolean               ids_optional,
+                                       const gchar          **udev_tags);
+guint   mm_plugin_index_get_n_entries (MMPluginIndex         *self);
+
+/* Returns an array of mm_plugin_index_get_n_entries() booleans, TRUE for each
+ * candidate entry. If drivers is NULL, entries aren't filtered by driver. */
+guint8 *mm_plugin_index_lookup        (MMPluginIndex             *self,
+                                       const gchar               *subsystem,
+                                       const gchar              **drivers,
+                                       guint16                    vendor,
+                                       guint16                    product,
+                                       MMPluginIndexUdevTagFunc   udev_tag_func,
+                                       gpointer                   user_data);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MMPluginIndex, mm_plugin_index_free)
+
+#endif /* MM_PLUGIN_INDEX_H */
@@ -25,8 +25,11 @@
 #include <ModemManager.h>
 #include <mm-errors-types.h>
 
+#include "mm-context.h"
 #include "mm-plugin-manager.h"
 #include "mm-plugin.h"
+#include "mm-plugin-index.h"
+#include "mm-plugin-manifest.h"
 #include "mm-shared.h"
 #include "mm-log-object.h"
 
@@ -44,56 +47,173 @@ enum {
     PROP_0,
     PROP_PLUGIN_DIR,
     PROP_FILTER,
+    PROP_MANIFEST_FILE,
     LAST_PROP
 };
 
+/* Upper bounds (in ms) of the buckets of the probing time histograms, the last
+ * one is unbounded */
+static const guint probing_time_histogram_bounds[] = {
+    500, 1000, 1500, 2000, 2500, 3000, 4000, 5000, 7500, 10000, 15000, 30000
+};
+#define PROBING_TIME_HISTOGRAM_N_BUCKETS (G_N_ELEMENTS (probing_time_histogram_bounds) + 1)
+
 struct _MMPluginManagerPrivate {
     /* Path to look for plugins */
     gchar *plugin_dir;
     /* Device filter */
     MMFilter *filter;
 
-    /* This list contains all plugins except for the generic one, order is not
-     * important. It is loaded once when the program starts, and the list is NOT
-     * expected to change after that.*/
-    GList *plugins;
-    /* Last, the generic plugin. */
+    /* Where the manifest of the installed plugins is kept across runs */
+    gchar *manifest_file;
+
+    /* This array contains all plugins except for the generic one, order is not
+     * important. It is set up once when the program starts, and the array is
+     * NOT expected to change after that; the plugin modules themselves are
+     * loaded on demand, the first time one of them may support a port. */
+    GPtrArray *plugins;
+    /* Last, the generic plugin, always loaded. */
     MMPlugin *generic;
+    /* Index of the pre-probing filters of the plugins in the array above, with
+     * entries in the same order as the array */
+    MMPluginIndex *plugin_index;
+
+    /* Shared utils, loaded right before the first plugin module */
+    GList    *shared_paths;
+    gboolean  shared_loaded;
 
     /* List of ongoing device support checks */
     GList *device_contexts;
 
     /* Full list of subsystems requested by the registered plugins */
     gchar **subsystems;
+
+    /* Maximum number of plugin support checks run at the same time across all
+     * devices (0 if unlimited), number of the ones running, and port contexts
+     * waiting to run one */
+    guint   probing_limit;
+    guint   n_probing;
+    GQueue *probing_queue;
+
+    /* Histograms of the time required to check support of each device, for the
+     * devices where all ports were known to be exposed and for the rest */
+    guint probing_time_histogram[2][PROBING_TIME_HISTOGRAM_N_BUCKETS];
 };
 
+/*****************************************************************************/
+/* Plugins known by the manager, either already loaded or still to be */
+
+typedef struct {
+    gchar    *path;
+    gchar    *name;
+    MMPlugin *plugin;
+    gboolean  load_failed;
+} PluginEntry;
+
+static void
+plugin_entry_free (PluginEntry *entry)
+{
+    g_clear_object (&entry->plugin);
+    g_free (entry->path);
+    g_free (entry->name);
+    g_slice_free (PluginEntry, entry);
+}
+
+static MMPlugin *plugin_manager_peek_entry_plugin (MMPluginManager *self,
+                                                   PluginEntry     *entry);
+
 /*****************************************************************************/
 /* Build plugin list for a single port */
 
+static gboolean
+port_has_udev_tag (const gchar    *tag,
+                   MMKernelDevice *port)
+{
+    return mm_kernel_device_get_global_property_as_boolean (port, tag);
+}
+
+static guint8 *
+plugin_manager_lookup_candidates (MMPluginManager           *self,
+                                  const gchar               *subsystem,
+                                  const gchar              **device_drivers,
+                                  guint16                    vendor,
+                                  guint16                    product,
+                                  MMPluginIndexUdevTagFunc   udev_tag_func,
+                                  gpointer                   udev_tag_user_data)
+{
+    g_autoptr(GPtrArray) drivers = NULL;
+    guint                i;
+
+    /* Ports in the list of virtual ports are checked against the 'virtual'
+     * driver instead of the device ones; as that list isn't known here, look
+     * for both, the plugins will do the exact check themselves. */
+    drivers = g_ptr_array_new ();
+    for (i = 0; device_drivers && device_drivers[i]; i++)
+        g_ptr_array_add (drivers, (gpointer) device_drivers[i]);
+    g_ptr_array_add (drivers, (gpointer) "virtual");
+    g_ptr_array_add (drivers, NULL);
+
+    return mm_plugin_index_lookup (self->priv->plugin_index,
+                                   subsystem,
+                                   (const gchar **) drivers->pdata,
+                                   vendor,
+                                   product,
+                                   udev_tag_func,
+                                   udev_tag_user_data);
+}
+
+static guint8 *
+plugin_manager_lookup_candidate_plugins (MMPluginManager *self,
+                                         MMDevice        *device,
+                                         MMKernelDevice  *port)
+{
+    return plugin_manager_lookup_candidates (self,
+                                             mm_kernel_device_get_subsystem (port),
+                                             mm_device_get_drivers (device),
+                                             mm_device_get_vendor (device),
+                                             mm_device_get_product (device),
+                                             (MMPluginIndexUdevTagFunc) port_has_udev_tag,
+                                             port);
+}
+
 static GList *
 plugin_manager_build_plugins_list (MMPluginManager *self,
                                    MMDevice        *device,
                                    MMKernelDevice  *port)
 {
+    g_autofree guint8 *candidates = NULL;
     GList *list = NULL;
-    GList *l;
+    guint i;
     gboolean supported_found = FALSE;
 
-    for (l = self->priv->plugins; l && !supported_found; l = g_list_next (l)) {
+    /* Only run the full set of pre-probing filters on the plugins that the
+     * index didn't already discard; this is also the point where the plugin
+     * modules are loaded, if not done yet */
+    candidates = plugin_manager_lookup_candidate_plugins (self, device, port);
+
+    for (i = 0; i < self->priv->plugins->len && !supported_found; i++) {
         MMPluginSupportsHint hint;
+        MMPlugin *plugin;
+
+        if (!candidates[i])
+            continue;
+
+        plugin = plugin_manager_peek_entry_plugin (self, g_ptr_array_index (self->priv->plugins, i));
+        if (!plugin)
+            continue;
 
-        hint = mm_plugin_discard_port_early (MM_PLUGIN (l->data), device, port);
+        hint = mm_plugin_discard_port_early (plugin, device, port);
         switch (hint) {
         case MM_PLUGIN_SUPPORTS_HINT_UNSUPPORTED:
             /* Fully discard */
             break;
         case MM_PLUGIN_SUPPORTS_HINT_MAYBE:
             /* Maybe supported, add to tail of list */
-            list = g_list_append (list, g_object_ref (l->data));
+            list = g_list_append (list, g_object_ref (plugin));
             break;
         case MM_PLUGIN_SUPPORTS_HINT_LIKELY:
             /* Likely supported, add to head of list */
-            list = g_list_prepend (list, g_object_ref (l->data));
+            list = g_list_prepend (list, g_object_ref (plugin));
             break;
         case MM_PLUGIN_SUPPORTS_HINT_SUPPORTED:
             /* Really supported, clean existing list and add it alone */
@@ -101,7 +221,7 @@ plugin_manager_build_plugins_list (MMPluginManager *self,
                 g_list_free_full (list, g_object_unref);
                 list = NULL;
             }
-            list = g_list_prepend (list, g_object_ref (l->data));
+            list = g_list_prepend (list, g_object_ref (plugin));
             /* This will end the loop as well */
             supported_found = TRUE;
             break;
@@ -218,6 +338,8 @@ struct _PortContext {
     /* The probe must be deferred until a result is suggested by other
      * port probe results (e.g. for WWAN ports). */
     gboolean defer_until_suggested;
+    /* The probe is waiting in the probing queue of the plugin manager */
+    gboolean waiting_probing_slot;
 };
 
 static void
@@ -229,6 +351,7 @@ port_context_unref (PortContext *port_context)
 
         /* The port support check task must have been completed previously */
         g_assert (!port_context->task);
+        g_assert (!port_context->waiting_probing_slot);
 
         if (port_context->best_plugin)
             g_object_unref (port_context->best_plugin);
@@ -289,6 +412,95 @@ port_context_complete (PortContext *port_context)
 
 static void port_context_next (PortContext *port_context);
 
+/*****************************************************************************/
+/* Probing slots
+ *
+ * Each plugin support check (i.e. the actual probing of a port) requires one
+ * of the probing slots of the plugin manager, so that the number of ports being
+ * probed at the same time across all devices can be limited. Slots are only
+ * held while the plugin checks support, never while the port context is
+ * deferred, so that a deferred port never blocks the ones it's waiting for. */
+
+static gboolean
+plugin_manager_acquire_probing_slot (MMPluginManager *self,
+                                     PortContext     *port_context)
+{
+    /* Keep FIFO order with the ones already waiting */
+    if (g_queue_is_empty (self->priv->probing_queue) &&
+        (!self->priv->probing_limit || self->priv->n_probing < self->priv->probing_limit)) {
+        self->priv->n_probing++;
+        return TRUE;
+    }
+
+    mm_obj_dbg (self, "task %s: waiting for a probing slot (%u probing, %u waiting)",
+                port_context->name, self->priv->n_probing, g_queue_get_length (self->priv->probing_queue));
+    port_context->waiting_probing_slot = TRUE;
+    g_queue_push_tail (self->priv->probing_queue, port_context_ref (port_context));
+    return FALSE;
+}
+
+static void
+plugin_manager_release_probing_slot (MMPluginManager *self)
+{
+    g_assert (self->priv->n_probing > 0);
+    self->priv->n_probing--;
+}
+
+static void
+plugin_manager_dispatch_probing_queue (MMPluginManager *self)
+{
+    while (!g_queue_is_empty (self->priv->probing_queue) &&
+           (!self->priv->probing_limit || self->priv->n_probing < self->priv->probing_limit)) {
+        PortContext *port_context;
+
+        port_context = g_queue_pop_head (self->priv->probing_queue);
+        port_context->waiting_probing_slot = FALSE;
+        port_context_next (port_context);
+        port_context_unref (port_context);
+    }
+}
+
+static void
+plugin_manager_cancel_probing_slot (MMPluginManager *self,
+                                    PortContext     *port_context)
+{
+    g_assert (port_context->waiting_probing_slot);
+    port_context->waiting_probing_slot = FALSE;
+    g_queue_remove (self->priv->probing_queue, port_context);
+    port_context_unref (port_context);
+}
+
+/*****************************************************************************/
+
+static MMPortProbe *
+port_context_peek_probe (PortContext *port_context)
+{
+    GObject *probe;
+
+    probe = mm_device_peek_port_probe (port_context->device, port_context->port);
+    return probe ? MM_PORT_PROBE (probe) : NULL;
+}
+
+static void
+port_context_load_probe_results (PortContext *port_context)
+{
+    MMPortProbe *probe;
+
+    probe = port_context_peek_probe (port_context);
+    if (probe)
+        mm_port_probe_load_cached_results (probe);
+}
+
+static void
+port_context_store_probe_results (PortContext *port_context)
+{
+    MMPortProbe *probe;
+
+    probe = port_context_peek_probe (port_context);
+    if (probe)
+        mm_port_probe_store_cached_results (probe);
+}
+
 static void
 port_context_supported (PortContext *port_context,
                         MMPlugin    *plugin)
@@ -303,6 +515,10 @@ port_context_supported (PortContext *port_context,
 
     /* Found a best plugin, store it to return it */
     port_context->best_plugin = g_object_ref (plugin);
+
+    /* Remember the probing results for the next time the port is found */
+    port_context_store_probe_results (port_context);
+
     port_context_complete (port_context);
 }
 
@@ -489,11 +705,15 @@ plugin_supports_port_ready (MMPlugin     *plugin,
                             GAsyncResult *res,
                             PortContext  *port_context)
 {
-    MMPluginManager        *self;
-    MMPluginSupportsResult  support_result;
-    GError                 *error = NULL;
+    g_autoptr(MMPluginManager)  self = NULL;
+    MMPluginSupportsResult      support_result;
+    GError                     *error = NULL;
 
-    self = g_task_get_source_object (port_context->task);
+    self = g_object_ref (g_task_get_source_object (port_context->task));
+
+    /* The slot is given back before processing the result, so that the next
+     * check of this same port gets in the queue after the ones waiting */
+    plugin_manager_release_probing_slot (self);
 
     /* Get supports check results */
     support_result = mm_plugin_supports_port_finish (plugin, res, &error);
@@ -525,6 +745,9 @@ plugin_supports_port_ready (MMPlugin     *plugin,
     /* We received a full reference, to make sure the context was always
      * valid during the async call */
     port_context_unref (port_context);
+
+    /* Let others use the released slot */
+    plugin_manager_dispatch_probing_queue (self);
 }
 
 static void
@@ -552,6 +775,10 @@ port_context_next (PortContext *port_context)
      * A full new reference to the port context is given as user data to the
      * async method because we want to make sure the context is still valid
      * once the method finishes. */
+    /* Checked once a probing slot is available */
+    if (!plugin_manager_acquire_probing_slot (self, port_context))
+        return;
+
     plugin = MM_PLUGIN (port_context->current->data);
     mm_obj_dbg (self, "task %s: checking with plugin '%s'",
                 port_context->name, mm_plugin_get_name (plugin));
@@ -598,6 +825,11 @@ port_context_cancel (PortContext *port_context)
          * complete it right away */
         else if (port_context->defer_until_suggested)
             port_context_complete (port_context);
+        /* If the task was waiting for a probing slot, same thing */
+        else if (port_context->waiting_probing_slot) {
+            plugin_manager_cancel_probing_slot (self, port_context);
+            port_context_complete (port_context);
+        }
         /* else, the task may be currently checking support with a given plugin */
     }
     port_context_unref (port_context);
@@ -677,6 +909,9 @@ port_context_run (MMPluginManager     *self,
 
     mm_obj_dbg (self, "task %s: started", port_context->name);
 
+    /* Probing results from a previous run spare most of the probing */
+    port_context_load_probe_results (port_context);
+
     /* Go probe with the first plugin */
     port_context_next (port_context);
 }
@@ -718,6 +953,11 @@ port_context_new (MMPluginManager *self,
 /* The wait time we define must always be less than the probing time */
 G_STATIC_ASSERT (MIN_WAIT_TIME_MSECS < MIN_PROBING_TIME_MSECS);
 
+/* The timeouts above are only a fallback for the devices where the kernel
+ * doesn't tell us which ports to expect: once all the ports of the device are
+ * exposed, probing starts right away, and the device support check finishes
+ * as soon as all port contexts are done. */
+
 /*
  * Device context
  *
@@ -774,6 +1014,11 @@ struct _DeviceContext {
 
     /* Port support check contexts being run */
     GList *port_contexts;
+
+    /* Names of the ports currently in the device, and whether these are all
+     * the ports the kernel exposes for the device */
+    GHashTable *port_names;
+    gboolean    all_ports_exposed;
 };
 
 static void
@@ -793,6 +1038,7 @@ device_context_unref (DeviceContext *device_context)
         g_assert (!device_context->task);
 
         g_free (device_context->name);
+        g_hash_table_unref (device_context->port_names);
         g_timer_destroy (device_context->timer);
         if (device_context->cancellable)
             g_object_unref (device_context->cancellable);
@@ -845,6 +1091,39 @@ device_context_peek_waiting_port_context (DeviceContext  *device_context,
     return NULL;
 }
 
+static void
+plugin_manager_record_probing_time (MMPluginManager *self,
+                                    gdouble          elapsed,
+                                    gboolean         all_ports_exposed)
+{
+    g_autoptr(GString)  str = NULL;
+    guint              *histogram;
+    guint               elapsed_ms;
+    guint               i;
+
+    histogram = self->priv->probing_time_histogram[all_ports_exposed];
+    elapsed_ms = (guint) MIN (elapsed * 1000.0, (gdouble) G_MAXUINT);
+    for (i = 0; i < G_N_ELEMENTS (probing_time_histogram_bounds); i++) {
+        if (elapsed_ms < probing_time_histogram_bounds[i])
+            break;
+    }
+    histogram[i]++;
+
+    str = g_string_new (NULL);
+    for (i = 0; i < PROBING_TIME_HISTOGRAM_N_BUCKETS; i++) {
+        if (!histogram[i])
+            continue;
+        if (i < G_N_ELEMENTS (probing_time_histogram_bounds))
+            g_string_append_printf (str, "%s<%.1lfs: %u", str->len ? ", " : "",
+                                    probing_time_histogram_bounds[i] / 1000.0, histogram[i]);
+        else
+            g_string_append_printf (str, "%s>=%.1lfs: %u", str->len ? ", " : "",
+                                    probing_time_histogram_bounds[i - 1] / 1000.0, histogram[i]);
+    }
+    mm_obj_dbg (self, "device probing time histogram (%s): %s",
+                all_ports_exposed ? "all ports known" : "timeouts", str->str);
+}
+
 static MMPlugin *
 device_context_run_finish (MMPluginManager  *self,
                            GAsyncResult     *res,
@@ -886,6 +1165,9 @@ device_context_complete (DeviceContext *device_context)
     /* Log about the time required to complete the checks */
     mm_obj_dbg (self, "task %s: finished in '%lf' seconds",
                 device_context->name, g_timer_elapsed (device_context->timer, NULL));
+    plugin_manager_record_probing_time (self,
+                                        g_timer_elapsed (device_context->timer, NULL),
+                                        device_context->all_ports_exposed);
 
     /* Remove signal handlers */
     if (device_context->grabbed_id) {
@@ -1223,6 +1505,50 @@ device_context_min_wait_time_elapsed (DeviceContext *device_context)
     return G_SOURCE_REMOVE;
 }
 
+static void
+device_context_check_all_ports_exposed (DeviceContext  *device_context,
+                                        MMKernelDevice *port)
+{
+    MMPluginManager *self;
+    g_auto(GStrv)    port_names = NULL;
+    guint            i;
+
+    if (device_context->all_ports_exposed || g_cancellable_is_cancelled (device_context->cancellable))
+        return;
+
+    port_names = mm_kernel_device_list_usb_port_names (mm_kernel_device_get_physdev_sysfs_path (port));
+    if (!port_names)
+        return;
+
+    for (i = 0; port_names[i]; i++) {
+        if (!g_hash_table_contains (device_context->port_names, port_names[i]))
+            return;
+    }
+
+    self = device_context->self;
+    mm_obj_dbg (self, "task %s: all %u ports exposed in the device", device_context->name, i);
+    device_context->all_ports_exposed = TRUE;
+
+    /* Start probing the ports right away */
+    if (device_context->min_wait_time_id) {
+        g_source_remove (device_context->min_wait_time_id);
+        device_context_min_wait_time_elapsed (device_context);
+    }
+
+    /* And don't wait for more ports to appear */
+    if (device_context->min_probing_time_id) {
+        g_source_remove (device_context->min_probing_time_id);
+        device_context->min_probing_time_id = 0;
+    }
+    if (device_context->extra_probing_time_id) {
+        g_source_remove (device_context->extra_probing_time_id);
+        device_context->extra_probing_time_id = 0;
+    }
+
+    /* Wakeup the device context logic, in case all port contexts are done */
+    device_context_continue (device_context);
+}
+
 static void
 device_context_port_released (DeviceContext  *device_context,
                               MMKernelDevice *port)
@@ -1233,6 +1559,7 @@ device_context_port_released (DeviceContext  *device_context,
     self = g_task_get_source_object (device_context->task);
     mm_obj_dbg (self, "task %s: port released: %s",
                 device_context->name, mm_kernel_device_get_name (port));
+    g_hash_table_remove (device_context->port_names, mm_kernel_device_get_name (port));
 
     /* Check if there's a waiting port context */
     port_context = device_context_peek_waiting_port_context (device_context, port);
@@ -1269,6 +1596,7 @@ device_context_port_grabbed (DeviceContext  *device_context,
 
     mm_obj_dbg (self, "task %s: port grabbed: %s",
                 device_context->name, mm_kernel_device_get_name (port));
+    g_hash_table_add (device_context->port_names, g_strdup (mm_kernel_device_get_name (port)));
 
     /* Ignore if for any reason we still have it in the running list */
     port_context = device_context_peek_running_port_context (device_context, port);
@@ -1308,15 +1636,17 @@ device_context_port_grabbed (DeviceContext  *device_context,
                     port_context->name);
         /* Store the port reference in the list within the device */
         device_context->wait_port_contexts = g_list_prepend (device_context->wait_port_contexts, port_context);
-        return;
-    }
+    } else {
+        /* Store the port reference in the list within the device */
+        device_context->port_contexts = g_list_prepend (device_context->port_contexts, port_context) ;
 
-    /* Store the port reference in the list within the device */
-    device_context->port_contexts = g_list_prepend (device_context->port_contexts, port_context) ;
+        /* If the port has been grabbed after the min wait timeout expired, launch
+         * probing directly */
+        device_context_run_port_context (device_context, port_context);
+    }
 
-    /* If the port has been grabbed after the min wait timeout expired, launch
-     * probing directly */
-    device_context_run_port_context (device_context, port_context);
+    /* No need to wait any longer if this was the last port to expect */
+    device_context_check_all_ports_exposed (device_context, port);
 }
 
 static gboolean
@@ -1434,6 +1764,7 @@ device_context_new (MMPluginManager *self,
     device_context->self        = g_object_ref (self);
     device_context->device      = g_object_ref (device);
     device_context->timer       = g_timer_new ();
+    device_context->port_names  = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
     /* Set context name (just for logging) */
     device_context->name = g_strdup_printf ("%lu", unique_task_id++);
@@ -1587,16 +1918,17 @@ MMPlugin *
 mm_plugin_manager_peek_plugin (MMPluginManager *self,
                                const gchar *plugin_name)
 {
-    GList *l;
+    guint i;
 
     if (self->priv->generic && g_str_equal (plugin_name, mm_plugin_get_name (self->priv->generic)))
         return self->priv->generic;
 
-    for (l = self->priv->plugins; l; l = g_list_next (l)) {
-        MMPlugin *plugin = MM_PLUGIN (l->data);
+    for (i = 0; i < self->priv->plugins->len; i++) {
+        PluginEntry *entry;
 
-        if (g_str_equal (plugin_name, mm_plugin_get_name (plugin)))
-            return plugin;
+        entry = g_ptr_array_index (self->priv->plugins, i);
+        if (g_str_equal (plugin_name, entry->name))
+            return plugin_manager_peek_entry_plugin (self, entry);
     }
 
     return NULL;
@@ -1610,26 +1942,227 @@ mm_plugin_manager_get_subsystems (MMPluginManager *self)
     return (const gchar **) self->priv->subsystems;
 }
 
+/*****************************************************************************/
+/* Plugin index check */
+
+typedef struct {
+    const gchar *subsystem;
+    const gchar *name;
+    const gchar *driver;
+    guint16      vendor;
+    guint16      product;
+    const gchar *udev_tag;
+} IndexCheckPort;
+
+static gboolean
+index_check_port_has_udev_tag (const gchar    *tag,
+                               IndexCheckPort *port)
+{
+    return !g_strcmp0 (tag, port->udev_tag);
+}
+
+static void
+index_check_add_string (GPtrArray   *array,
+                        const gchar *str)
+{
+    guint i;
+
+    /* NULL is also a valid value, e.g. no driver or no udev tag */
+    for (i = 0; i < array->len; i++) {
+        if (!g_strcmp0 (g_ptr_array_index (array, i), str))
+            return;
+    }
+    g_ptr_array_add (array, (gpointer) str);
+}
+
+static void
+index_check_add_ids (GArray  *array,
+                     guint16  vendor,
+                     guint16  product)
+{
+    mm_uint16_pair ids = { vendor, product };
+
+    g_array_append_val (array, ids);
+}
+
+static gboolean
+plugin_manager_check_index_port (MMPluginManager  *self,
+                                 IndexCheckPort   *port,
+                                 GError          **error)
+{
+    g_autofree guint8 *candidates = NULL;
+    const gchar       *drivers[] = { port->driver, NULL };
+    guint              i;
+
+    candidates = plugin_manager_lookup_candidates (self,
+                                                   port->subsystem,
+                                                   port->driver ? drivers : NULL,
+                                                   port->vendor,
+                                                   port->product,
+                                                   (MMPluginIndexUdevTagFunc) index_check_port_has_udev_tag,
+                                                   port);
+
+    for (i = 0; i < self->priv->plugins->len; i++) {
+        PluginEntry *entry;
+        const gchar *filtered_reason = NULL;
+        gboolean     need_vendor_probing;
+        gboolean     need_product_probing;
+
+        entry = g_ptr_array_index (self->priv->plugins, i);
+        if (candidates[i] || !entry->plugin)
+            continue;
+
+        /* Every plugin discarded by the index must also be discarded by its
+         * own filters, or the list of plugins built for the port changes */
+        if (!mm_plugin_apply_pre_probing_filters (entry->plugin,
+                                                  port->subsystem,
+                                                  port->name,
+                                                  port->driver ? drivers : NULL,
+                                                  port->vendor,
+                                                  port->product,
+                                                  (MMPluginIndexUdevTagFunc) index_check_port_has_udev_tag,
+                                                  port,
+                                                  &need_vendor_probing,
+                                                  &need_product_probing,
+                                                  &filtered_reason)) {
+            g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                         "plugin '%s' discarded by the index for port %s/%s "
+                         "(driver %s, vendor 0x%04x, product 0x%04x, udev tag %s)",
+                         entry->name, port->subsystem, port->name,
+                         port->driver ? port->driver : "none",
+                         port->vendor, port->product,
+                         port->udev_tag ? port->udev_tag : "none");
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static const gchar *
+index_check_port_name (const gchar *subsystem)
+{
+    if (g_str_equal (subsystem, "tty"))
+        return "ttyUSB0";
+    if (g_str_equal (subsystem, "net"))
+        return "wwan0";
+    if (g_str_equal (subsystem, "usbmisc"))
+        return "cdc-wdm0";
+    return "port0";
+}
+
+gboolean
+mm_plugin_manager_check_index (MMPluginManager  *self,
+                               guint            *n_ports,
+                               GError          **error)
+{
+    g_autoptr(GPtrArray) subsystems = NULL;
+    g_autoptr(GPtrArray) drivers = NULL;
+    g_autoptr(GPtrArray) udev_tags = NULL;
+    g_autoptr(GArray)    ids = NULL;
+    guint                i;
+
+    *n_ports = 0;
+
+    /* Values used in the filters of all the plugins, plus some used by none */
+    subsystems = g_ptr_array_new ();
+    drivers = g_ptr_array_new ();
+    udev_tags = g_ptr_array_new ();
+    ids = g_array_new (FALSE, FALSE, sizeof (mm_uint16_pair));
+
+    index_check_add_string (subsystems, "wwan");
+    index_check_add_string (drivers, NULL);
+    index_check_add_string (drivers, "cdc_acm");
+    index_check_add_string (drivers, "qmi_wwan");
+    index_check_add_string (drivers, "cdc_mbim");
+    index_check_add_string (udev_tags, NULL);
+    index_check_add_string (udev_tags, "ID_MM_UNKNOWN_TAG");
+    index_check_add_ids (ids, 0, 0);
+    index_check_add_ids (ids, 0x1234, 0x5678);
+
+    for (i = 0; i < self->priv->plugins->len; i++) {
+        MMPlugin              *plugin;
+        const gchar          **strv;
+        const guint16         *vendor_ids;
+        const mm_uint16_pair  *product_ids;
+        guint                  j;
+
+        plugin = plugin_manager_peek_entry_plugin (self, g_ptr_array_index (self->priv->plugins, i));
+        if (!plugin)
+            continue;
+
+        strv = mm_plugin_get_allowed_subsystems (plugin);
+        for (j = 0; strv && strv[j]; j++)
+            index_check_add_string (subsystems, strv[j]);
+        strv = mm_plugin_get_allowed_drivers (plugin);
+        for (j = 0; strv && strv[j]; j++)
+            index_check_add_string (drivers, strv[j]);
+        strv = mm_plugin_get_allowed_udev_tags (plugin);
+        for (j = 0; strv && strv[j]; j++)
+            index_check_add_string (udev_tags, strv[j]);
+
+        vendor_ids = mm_plugin_get_allowed_vendor_ids (plugin);
+        for (j = 0; vendor_ids && vendor_ids[j]; j++) {
+            index_check_add_ids (ids, vendor_ids[j], 0);
+            index_check_add_ids (ids, vendor_ids[j], 0x0001);
+        }
+        product_ids = mm_plugin_get_allowed_product_ids (plugin);
+        for (j = 0; product_ids && product_ids[j].l; j++) {
+            index_check_add_ids (ids, product_ids[j].l, product_ids[j].r);
+            index_check_add_ids (ids, product_ids[j].l, 0xffff);
+        }
+    }
+
+    for (i = 0; i < subsystems->len; i++) {
+        guint j;
+
+        for (j = 0; j < drivers->len; j++) {
+            guint k;
+
+            for (k = 0; k < ids->len; k++) {
+                guint l;
+
+                for (l = 0; l < udev_tags->len; l++) {
+                    IndexCheckPort port = {
+                        .subsystem = g_ptr_array_index (subsystems, i),
+                        .name      = index_check_port_name (g_ptr_array_index (subsystems, i)),
+                        .driver    = g_ptr_array_index (drivers, j),
+                        .vendor    = g_array_index (ids, mm_uint16_pair, k).l,
+                        .product   = g_array_index (ids, mm_uint16_pair, k).r,
+                        .udev_tag  = g_ptr_array_index (udev_tags, l),
+                    };
+
+                    if (!plugin_manager_check_index_port (self, &port, error))
+                        return FALSE;
+                    (*n_ports)++;
+                }
+            }
+        }
+    }
+
+    return TRUE;
+}
+
 /*****************************************************************************/
 
 static void
-register_plugin_whitelist_tags (MMPluginManager *self,
-                                MMPlugin        *plugin)
+register_plugin_whitelist_tags (MMPluginManager       *self,
+                                MMPluginManifestEntry *entry)
 {
-    const gchar **tags;
-    guint         i;
+    gchar **tags;
+    guint   i;
 
     if (!mm_filter_check_rule_enabled (self->priv->filter, MM_FILTER_RULE_PLUGIN_WHITELIST))
         return;
 
-    tags = mm_plugin_get_allowed_udev_tags (plugin);
+    tags = entry->udev_tags;
     for (i = 0; tags && tags[i]; i++)
         mm_filter_register_plugin_whitelist_tag (self->priv->filter, tags[i]);
 }
 
 static void
-register_plugin_whitelist_vendor_ids (MMPluginManager *self,
-                                       MMPlugin        *plugin)
+register_plugin_whitelist_vendor_ids (MMPluginManager       *self,
+                                      MMPluginManifestEntry *entry)
 {
     const guint16 *vendor_ids;
     guint          i;
@@ -1637,14 +2170,14 @@ register_plugin_whitelist_vendor_ids (MMPluginManager *self,
     if (!mm_filter_check_rule_enabled (self->priv->filter, MM_FILTER_RULE_PLUGIN_WHITELIST))
         return;
 
-    vendor_ids = mm_plugin_get_allowed_vendor_ids (plugin);
+    vendor_ids = entry->vendor_ids;
     for (i = 0; vendor_ids && vendor_ids[i]; i++)
         mm_filter_register_plugin_whitelist_vendor_id (self->priv->filter, vendor_ids[i]);
 }
 
 static void
-register_plugin_whitelist_product_ids (MMPluginManager *self,
-                                       MMPlugin        *plugin)
+register_plugin_whitelist_product_ids (MMPluginManager       *self,
+                                       MMPluginManifestEntry *entry)
 {
     const mm_uint16_pair *product_ids;
     guint                 i;
@@ -1652,7 +2185,7 @@ register_plugin_whitelist_product_ids (MMPluginManager *self,
     if (!mm_filter_check_rule_enabled (self->priv->filter, MM_FILTER_RULE_PLUGIN_WHITELIST))
         return;
 
-    product_ids = mm_plugin_get_allowed_product_ids (plugin);
+    product_ids = entry->product_ids;
     for (i = 0; product_ids && product_ids[i].l; i++)
         mm_filter_register_plugin_whitelist_product_id (self->priv->filter, product_ids[i].l, product_ids[i].r);
 }
@@ -1775,18 +2308,123 @@ out:
     g_free (path_display);
 }
 
+static void
+plugin_manager_ensure_shared_loaded (MMPluginManager *self)
+{
+    GList *l;
+
+    if (self->priv->shared_loaded)
+        return;
+    self->priv->shared_loaded = TRUE;
+
+    /* Plugins may use symbols from any of the shared utils, so all of them
+     * must be loaded before the first plugin */
+    for (l = self->priv->shared_paths; l; l = g_list_next (l))
+        load_shared (self, (const gchar *)(l->data));
+}
+
+static MMPlugin *
+plugin_manager_peek_entry_plugin (MMPluginManager *self,
+                                  PluginEntry     *entry)
+{
+    if (entry->plugin || entry->load_failed)
+        return entry->plugin;
+
+    plugin_manager_ensure_shared_loaded (self);
+    entry->plugin = load_plugin (self, entry->path);
+    if (!entry->plugin) {
+        /* Don't retry with every new port */
+        entry->load_failed = TRUE;
+        return NULL;
+    }
+
+    if (!g_str_equal (entry->name, mm_plugin_get_name (entry->plugin)))
+        mm_obj_warn (self, "plugin '%s' loaded from '%s' was listed as '%s' in the manifest",
+                     mm_plugin_get_name (entry->plugin), entry->path, entry->name);
+    return entry->plugin;
+}
+
+static MMPluginManifestEntry *
+manifest_entry_new_from_plugin (MMPlugin *plugin)
+{
+    MMPluginManifestEntry *entry;
+    const guint16         *vendor_ids;
+    const mm_uint16_pair  *product_ids;
+    guint                  n;
+
+    entry = g_slice_new0 (MMPluginManifestEntry);
+    entry->name         = g_strdup (mm_plugin_get_name (plugin));
+    entry->generic      = mm_plugin_is_generic (plugin);
+    entry->ids_optional = mm_plugin_has_string_filters (plugin);
+    entry->subsystems   = g_strdupv ((gchar **) mm_plugin_get_allowed_subsystems (plugin));
+    entry->drivers      = g_strdupv ((gchar **) mm_plugin_get_allowed_drivers (plugin));
+    entry->udev_tags    = g_strdupv ((gchar **) mm_plugin_get_allowed_udev_tags (plugin));
+
+    vendor_ids = mm_plugin_get_allowed_vendor_ids (plugin);
+    if (vendor_ids) {
+        for (n = 0; vendor_ids[n]; n++);
+        entry->vendor_ids = g_memdup (vendor_ids, (n + 1) * sizeof (guint16));
+    }
+
+    product_ids = mm_plugin_get_allowed_product_ids (plugin);
+    if (product_ids) {
+        for (n = 0; product_ids[n].l; n++);
+        entry->product_ids = g_memdup (product_ids, (n + 1) * sizeof (mm_uint16_pair));
+    }
+
+    return entry;
+}
+
+static MMPluginManifest *
+plugin_manager_load_manifest (MMPluginManager *self)
+{
+    MMPluginManifest *manifest;
+    GError           *error = NULL;
+
+    if (!self->priv->manifest_file)
+        return NULL;
+
+    manifest = mm_plugin_manifest_load (self->priv->manifest_file, &error);
+    if (!manifest) {
+        if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+            mm_obj_dbg (self, "couldn't load plugin manifest: %s", error->message);
+        g_error_free (error);
+    }
+    return manifest;
+}
+
+static void
+plugin_manager_save_manifest (MMPluginManager  *self,
+                              MMPluginManifest *manifest)
+{
+    GError *error = NULL;
+
+    if (!self->priv->manifest_file)
+        return;
+
+    if (!mm_plugin_manifest_save (manifest, self->priv->manifest_file, &error)) {
+        mm_obj_warn (self, "couldn't save plugin manifest: %s", error->message);
+        g_error_free (error);
+        return;
+    }
+    mm_obj_dbg (self, "plugin manifest updated");
+}
+
 static gboolean
 load_plugins (MMPluginManager  *self,
               GError          **error)
 {
-    GDir             *dir = NULL;
-    const gchar      *fname;
-    GList            *shared_paths = NULL;
-    GList            *plugin_paths = NULL;
-    GList            *l;
-    GPtrArray        *subsystems = NULL;
-    g_autofree gchar *subsystems_str = NULL;
-    g_autofree gchar *plugindir_display = NULL;
+    GDir                        *dir = NULL;
+    const gchar                 *fname;
+    GList                       *plugin_paths = NULL;
+    GList                       *l;
+    GPtrArray                   *subsystems = NULL;
+    g_autofree gchar            *subsystems_str = NULL;
+    g_autofree gchar            *plugindir_display = NULL;
+    g_autoptr(MMPluginManifest)  previous_manifest = NULL;
+    g_autoptr(MMPluginManifest)  manifest = NULL;
+    guint                        n_from_manifest = 0;
+    guint                        n_loaded = 0;
 
     if (!g_module_supported ()) {
         g_set_error (error,
@@ -1814,63 +2452,110 @@ load_plugins (MMPluginManager  *self,
         if (!g_str_has_suffix (fname, G_MODULE_SUFFIX))
             continue;
         if (g_str_has_prefix (fname, SHARED_PREFIX))
-            shared_paths = g_list_prepend (shared_paths, g_module_build_path (self->priv->plugin_dir, fname));
+            self->priv->shared_paths = g_list_prepend (self->priv->shared_paths, g_module_build_path (self->priv->plugin_dir, fname));
         else if (g_str_has_prefix (fname, PLUGIN_PREFIX))
             plugin_paths = g_list_prepend (plugin_paths, g_module_build_path (self->priv->plugin_dir, fname));
     }
 
-    /* Load all shared utils */
-    for (l = shared_paths; l; l = g_list_next (l))
-        load_shared (self, (const gchar *)(l->data));
+    /* The filters of the plugins listed in the manifest of a previous run are
+     * taken from there, and the plugins themselves are only loaded once they
+     * may support a port. Plugins not listed (or changed since then) are
+     * loaded right away, and a new manifest is written. */
+    previous_manifest = plugin_manager_load_manifest (self);
+    manifest = mm_plugin_manifest_new ();
 
-    /* Load all plugins */
+    /* Setup all plugins */
     subsystems = g_ptr_array_new ();
     for (l = plugin_paths; l; l = g_list_next (l)) {
-        MMPlugin     *plugin;
-        const gchar **plugin_subsystems;
-        guint         i;
+        const gchar                      *path = (const gchar *)(l->data);
+        MMPlugin                         *plugin = NULL;
+        g_autoptr(MMPluginManifestEntry)  entry = NULL;
+        GError                           *inner_error = NULL;
+        guint                             i;
+
+        if (previous_manifest)
+            entry = mm_plugin_manifest_lookup (previous_manifest, path);
+
+        if (entry)
+            n_from_manifest++;
+        else {
+            plugin_manager_ensure_shared_loaded (self);
+            plugin = load_plugin (self, path);
+            if (!plugin)
+                continue;
+            entry = manifest_entry_new_from_plugin (plugin);
+        }
 
-        plugin = load_plugin (self, (const gchar *)(l->data));
-        if (!plugin)
-            continue;
+        if (!mm_plugin_manifest_add (manifest, path, entry, &inner_error)) {
+            mm_obj_dbg (self, "couldn't add plugin '%s' to the manifest: %s", entry->name, inner_error->message);
+            g_error_free (inner_error);
+        }
 
         /* Ignore plugins that don't specify subsystems */
-        plugin_subsystems = mm_plugin_get_allowed_subsystems (plugin);
-        if (!plugin_subsystems) {
-            mm_obj_warn (self, "plugin '%s' doesn't specify allowed subsystems: ignored",
-                         mm_plugin_get_name (plugin));
+        if (!entry->subsystems) {
+            mm_obj_warn (self, "plugin '%s' doesn't specify allowed subsystems: ignored", entry->name);
+            g_clear_object (&plugin);
             continue;
         }
 
-        /* Process generic plugin */
-        if (mm_plugin_is_generic (plugin)) {
+        /* Process generic plugin, which is always required */
+        if (entry->generic) {
             if (self->priv->generic) {
-                mm_obj_warn (self, "plugin '%s' is generic and another one is already registered: ignored",
-                             mm_plugin_get_name (plugin));
+                mm_obj_warn (self, "plugin '%s' is generic and another one is already registered: ignored", entry->name);
+                g_clear_object (&plugin);
                 continue;
             }
+            /* The generic plugin doesn't use any of the shared utils */
+            if (!plugin) {
+                plugin = load_plugin (self, path);
+                if (!plugin)
+                    continue;
+            }
             self->priv->generic = plugin;
-        } else
-            self->priv->plugins = g_list_append (self->priv->plugins, plugin);
+        } else {
+            PluginEntry *plugin_entry;
+
+            plugin_entry = g_slice_new0 (PluginEntry);
+            plugin_entry->path = g_strdup (path);
+            plugin_entry->name = g_strdup (entry->name);
+            plugin_entry->plugin = plugin;
+            g_ptr_array_add (self->priv->plugins, plugin_entry);
+            mm_plugin_index_add (self->priv->plugin_index,
+                                 (const gchar **) entry->subsystems,
+                                 (const gchar **) entry->drivers,
+                                 entry->vendor_ids,
+                                 entry->product_ids,
+                                 entry->ids_optional,
+                                 (const gchar **) entry->udev_tags);
+        }
+
+        if (plugin)
+            n_loaded++;
 
         /* Track required subsystems, avoiding duplicates in the list */
-        for (i = 0; plugin_subsystems[i]; i++) {
-            if (!g_ptr_array_find_with_equal_func (subsystems, plugin_subsystems[i], g_str_equal, NULL))
-                g_ptr_array_add (subsystems, g_strdup (plugin_subsystems[i]));
+        for (i = 0; entry->subsystems[i]; i++) {
+            if (!g_ptr_array_find_with_equal_func (subsystems, entry->subsystems[i], g_str_equal, NULL))
+                g_ptr_array_add (subsystems, g_strdup (entry->subsystems[i]));
         }
 
         /* Register plugin whitelist rules in filter, if any */
-        register_plugin_whitelist_tags        (self, plugin);
-        register_plugin_whitelist_vendor_ids  (self, plugin);
-        register_plugin_whitelist_product_ids (self, plugin);
+        register_plugin_whitelist_tags        (self, entry);
+        register_plugin_whitelist_vendor_ids  (self, entry);
+        register_plugin_whitelist_product_ids (self, entry);
     }
 
+    /* Rewrite the manifest if any plugin was added, changed or removed */
+    if (!previous_manifest ||
+        n_from_manifest != mm_plugin_manifest_get_n_entries (previous_manifest) ||
+        n_from_manifest != mm_plugin_manifest_get_n_entries (manifest))
+        plugin_manager_save_manifest (self, manifest);
+
     /* Check the generic plugin once all looped */
     if (!self->priv->generic)
         mm_obj_dbg (self, "generic plugin not loaded");
 
     /* Treat as error if we don't find any plugin */
-    if (!self->priv->plugins && !self->priv->generic) {
+    if (!self->priv->plugins->len && !self->priv->generic) {
         g_set_error (error,
                      MM_CORE_ERROR,
                      MM_CORE_ERROR_NO_PLUGINS,
@@ -1892,18 +2577,17 @@ load_plugins (MMPluginManager  *self,
     self->priv->subsystems = (gchar **) g_ptr_array_free (subsystems, FALSE);
     subsystems_str = g_strjoinv (", ", self->priv->subsystems);
 
-    mm_obj_dbg (self, "successfully loaded %u plugins registering %u subsystems: %s",
-                g_list_length (self->priv->plugins) + !!self->priv->generic,
+    mm_obj_dbg (self, "successfully set up %u plugins (%u loaded, %u from manifest) registering %u subsystems: %s",
+                self->priv->plugins->len + !!self->priv->generic, n_loaded, n_from_manifest,
                 g_strv_length (self->priv->subsystems), subsystems_str);
 
 out:
-    g_list_free_full (shared_paths, g_free);
     g_list_free_full (plugin_paths, g_free);
     if (dir)
         g_dir_close (dir);
 
     /* Return TRUE if at least one plugin found */
-    return (self->priv->plugins || self->priv->generic);
+    return (self->priv->plugins->len || self->priv->generic);
 }
 
 /*****************************************************************************/
@@ -1919,13 +2603,15 @@ log_object_build_id (MMLogObject *_self)
 MMPluginManager *
 mm_plugin_manager_new (const gchar  *plugin_dir,
                        MMFilter     *filter,
+                       const gchar  *manifest_file,
                        GError      **error)
 {
     return g_initable_new (MM_TYPE_PLUGIN_MANAGER,
                            NULL,
                            error,
-                           MM_PLUGIN_MANAGER_PLUGIN_DIR, plugin_dir,
-                           MM_PLUGIN_MANAGER_FILTER,     filter,
+                           MM_PLUGIN_MANAGER_PLUGIN_DIR,    plugin_dir,
+                           MM_PLUGIN_MANAGER_FILTER,        filter,
+                           MM_PLUGIN_MANAGER_MANIFEST_FILE, manifest_file,
                            NULL);
 }
 
@@ -1936,6 +2622,10 @@ mm_plugin_manager_init (MMPluginManager *self)
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                                               MM_TYPE_PLUGIN_MANAGER,
                                               MMPluginManagerPrivate);
+    self->priv->plugins = g_ptr_array_new_with_free_func ((GDestroyNotify) plugin_entry_free);
+    self->priv->plugin_index = mm_plugin_index_new ();
+    self->priv->probing_queue = g_queue_new ();
+    self->priv->probing_limit = mm_context_get_probing_limit ();
 }
 
 static void
@@ -1954,6 +2644,10 @@ set_property (GObject *object,
     case PROP_FILTER:
         priv->filter = g_value_dup_object (value);
         break;
+    case PROP_MANIFEST_FILE:
+        g_free (priv->manifest_file);
+        priv->manifest_file = g_value_dup_string (value);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -1975,6 +2669,9 @@ get_property (GObject *object,
     case PROP_FILTER:
         g_value_set_object (value, priv->filter);
         break;
+    case PROP_MANIFEST_FILE:
+        g_value_set_string (value, priv->manifest_file);
+        break;
     default:
         G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
         break;
@@ -1995,9 +2692,16 @@ dispose (GObject *object)
 {
     MMPluginManager *self = MM_PLUGIN_MANAGER (object);
 
-    g_list_free_full (g_steal_pointer (&self->priv->plugins), g_object_unref);
+    g_clear_pointer (&self->priv->plugins, g_ptr_array_unref);
+    g_clear_pointer (&self->priv->plugin_index, mm_plugin_index_free);
+    if (self->priv->probing_queue) {
+        g_assert (g_queue_is_empty (self->priv->probing_queue));
+        g_clear_pointer (&self->priv->probing_queue, g_queue_free);
+    }
     g_clear_object (&self->priv->generic);
     g_clear_pointer (&self->priv->plugin_dir, g_free);
+    g_clear_pointer (&self->priv->manifest_file, g_free);
+    g_list_free_full (g_steal_pointer (&self->priv->shared_paths), g_free);
     g_clear_object (&self->priv->filter);
     g_clear_pointer (&self->priv->subsystems, g_strfreev);
 
@@ -2043,4 +2747,11 @@ mm_plugin_manager_class_init (MMPluginManagerClass *manager_class)
                               "Device filter",
                               MM_TYPE_FILTER,
                               G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+    g_object_class_install_property
+        (object_class, PROP_MANIFEST_FILE,
+         g_param_spec_string (MM_PLUGIN_MANAGER_MANIFEST_FILE,
+                              "Manifest file",
+                              "Where to keep the manifest of the installed plugins",
+                              NULL,
+                              G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
 }
@@ -32,8 +32,9 @@
 #define MM_IS_PLUGIN_MANAGER_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((obj), MM_TYPE_PLUGIN_MANAGER))
 #define MM_PLUGIN_MANAGER_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), MM_TYPE_PLUGIN_MANAGER, MMPluginManagerClass))
 
-#define MM_PLUGIN_MANAGER_PLUGIN_DIR "plugin-dir" /* Construct-only */
-#define MM_PLUGIN_MANAGER_FILTER     "filter"     /* Construct-only */
+#define MM_PLUGIN_MANAGER_PLUGIN_DIR    "plugin-dir"    /* Construct-only */
+#define MM_PLUGIN_MANAGER_FILTER        "filter"        /* Construct-only */
+#define MM_PLUGIN_MANAGER_MANIFEST_FILE "manifest-file" /* Construct-only */
 
 typedef struct _MMPluginManager MMPluginManager;
 typedef struct _MMPluginManagerClass MMPluginManagerClass;
@@ -53,6 +54,7 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC (MMPluginManager, g_object_unref)
 
 MMPluginManager *mm_plugin_manager_new                         (const gchar          *plugindir,
                                                                 MMFilter             *filter,
+                                                                const gchar          *manifest_file,
                                                                 GError              **error);
 void             mm_plugin_manager_device_support_check        (MMPluginManager      *self,
                                                                 MMDevice             *device,
@@ -67,4 +69,11 @@ MMPlugin        *mm_plugin_manager_peek_plugin                 (MMPluginManager
                                                                 const gchar          *plugin_name);
 const gchar    **mm_plugin_manager_get_subsystems              (MMPluginManager      *self);
 
+/* Checks that the index of plugin filters doesn't discard any plugin that
+ * would pass its own pre-probing filters, for all the combinations of the
+ * values used in those filters. All plugins are loaded. */
+gboolean         mm_plugin_manager_check_index                 (MMPluginManager      *self,
+                                                                guint                *n_ports,
+                                                                GError              **error);
+
 #endif /* MM_PLUGIN_MANAGER_H */
@@ -0,0 +1,318 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <errno.h>
+
+#include <glib/gstdio.h>
+
+#include <ModemManager.h>
+#include <libmm-glib.h>
+
+#include "mm-plugin-manifest.h"
+
+/* The manifest is a key file with one group per plugin module, named after the
+ * module path, plus a header group with the version of the daemon that wrote
+ * it. Vendor IDs are stored as hex strings, and product IDs as 'vid:pid' hex
+ * strings. Filters that the plugin doesn't use are not stored at all. */
+
+#define MANIFEST_GROUP              "manifest"
+#define MANIFEST_KEY_DAEMON_VERSION "daemon-version"
+
+#define ENTRY_KEY_MTIME        "mtime"
+#define ENTRY_KEY_SIZE         "size"
+#define ENTRY_KEY_NAME         "name"
+#define ENTRY_KEY_GENERIC      "generic"
+#define ENTRY_KEY_SUBSYSTEMS   "subsystems"
+#define ENTRY_KEY_DRIVERS      "drivers"
+#define ENTRY_KEY_VENDOR_IDS   "vendor-ids"
+#define ENTRY_KEY_PRODUCT_IDS  "product-ids"
+#define ENTRY_KEY_IDS_OPTIONAL "ids-optional"
+#define ENTRY_KEY_UDEV_TAGS    "udev-tags"
+
+struct _MMPluginManifest {
+    GKeyFile *key_file;
+};
+
+/*****************************************************************************/
+
+void
+mm_plugin_manifest_entry_free (MMPluginManifestEntry *entry)
+{
+    g_free (entry->name);
+    g_strfreev (entry->subsystems);
+    g_strfreev (entry->drivers);
+    g_free (entry->vendor_ids);
+    g_free (entry->product_ids);
+    g_strfreev (entry->udev_tags);
+    g_slice_free (MMPluginManifestEntry, entry);
+}
+
+/*****************************************************************************/
+
+static gboolean
+parse_hex_uint16 (const gchar  *str,
+                  gchar         end,
+                  const gchar **next,
+                  guint16      *out)
+{
+    gchar   *endptr = NULL;
+    guint64  value;
+
+    errno = 0;
+    value = g_ascii_strtoull (str, &endptr, 16);
+    if (errno || endptr == str || *endptr != end || !value || value > G_MAXUINT16)
+        return FALSE;
+    *out = (guint16) value;
+    if (next)
+        *next = endptr + 1;
+    return TRUE;
+}
+
+static gboolean
+load_vendor_ids (GKeyFile     *key_file,
+                 const gchar  *group,
+                 guint16     **out)
+{
+    g_auto(GStrv)  strv = NULL;
+    gsize          len = 0;
+    guint16       *vendor_ids;
+    guint          i;
+
+    strv = g_key_file_get_string_list (key_file, group, ENTRY_KEY_VENDOR_IDS, &len, NULL);
+    if (!strv)
+        return TRUE;
+
+    vendor_ids = g_new0 (guint16, len + 1);
+    for (i = 0; i < len; i++) {
+        if (!parse_hex_uint16 (strv[i], '\0', NULL, &vendor_ids[i])) {
+            g_free (vendor_ids);
+            return FALSE;
+        }
+    }
+    *out = vendor_ids;
+    return TRUE;
+}
+
+static gboolean
+load_product_ids (GKeyFile        *key_file,
+                  const gchar     *group,
+                  mm_uint16_pair **out)
+{
+    g_auto(GStrv)   strv = NULL;
+    gsize           len = 0;
+    mm_uint16_pair *product_ids;
+    guint           i;
+
+    strv = g_key_file_get_string_list (key_file, group, ENTRY_KEY_PRODUCT_IDS, &len, NULL);
+    if (!strv)
+        return TRUE;
+
+    product_ids = g_new0 (mm_uint16_pair, len + 1);
+    for (i = 0; i < len; i++) {
+        const gchar *next = NULL;
+
+        if (!parse_hex_uint16 (strv[i], ':', &next, &product_ids[i].l) ||
+            !parse_hex_uint16 (next, '\0', NULL, &product_ids[i].r)) {
+            g_free (product_ids);
+            return FALSE;
+        }
+    }
+    *out = product_ids;
+    return TRUE;
+}
+
+static gboolean
+stat_plugin (const gchar  *plugin_path,
+             guint64      *mtime,
+             guint64      *size,
+             GError      **error)
+{
+    GStatBuf st;
+
+    if (g_stat (plugin_path, &st) < 0) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "couldn't stat '%s': %s", plugin_path, g_strerror (errno));
+        return FALSE;
+    }
+    *mtime = (guint64) st.st_mtime;
+    *size = (guint64) st.st_size;
+    return TRUE;
+}
+
+MMPluginManifestEntry *
+mm_plugin_manifest_lookup (MMPluginManifest *self,
+                           const gchar      *plugin_path)
+{
+    g_autoptr(MMPluginManifestEntry)  entry = NULL;
+    GKeyFile                         *key_file = self->key_file;
+    guint64                           mtime;
+    guint64                           size;
+
+    if (!g_key_file_has_group (key_file, plugin_path))
+        return NULL;
+
+    if (!stat_plugin (plugin_path, &mtime, &size, NULL) ||
+        g_key_file_get_uint64 (key_file, plugin_path, ENTRY_KEY_MTIME, NULL) != mtime ||
+        g_key_file_get_uint64 (key_file, plugin_path, ENTRY_KEY_SIZE, NULL) != size)
+        return NULL;
+
+    entry = g_slice_new0 (MMPluginManifestEntry);
+    entry->name = g_key_file_get_string (key_file, plugin_path, ENTRY_KEY_NAME, NULL);
+    if (!entry->name || !entry->name[0])
+        return NULL;
+    entry->generic      = g_key_file_get_boolean (key_file, plugin_path, ENTRY_KEY_GENERIC, NULL);
+    entry->ids_optional = g_key_file_get_boolean (key_file, plugin_path, ENTRY_KEY_IDS_OPTIONAL, NULL);
+    entry->subsystems   = g_key_file_get_string_list (key_file, plugin_path, ENTRY_KEY_SUBSYSTEMS, NULL, NULL);
+    entry->drivers      = g_key_file_get_string_list (key_file, plugin_path, ENTRY_KEY_DRIVERS, NULL, NULL);
+    entry->udev_tags    = g_key_file_get_string_list (key_file, plugin_path, ENTRY_KEY_UDEV_TAGS, NULL, NULL);
+    if (!load_vendor_ids (key_file, plugin_path, &entry->vendor_ids) ||
+        !load_product_ids (key_file, plugin_path, &entry->product_ids))
+        return NULL;
+
+    return g_steal_pointer (&entry);
+}
+
+/*****************************************************************************/
+
+static void
+set_string_list (GKeyFile     *key_file,
+                 const gchar  *group,
+                 const gchar  *key,
+                 gchar       **strv)
+{
+    if (strv)
+        g_key_file_set_string_list (key_file, group, key, (const gchar * const *) strv, g_strv_length (strv));
+}
+
+gboolean
+mm_plugin_manifest_add (MMPluginManifest             *self,
+                        const gchar                  *plugin_path,
+                        const MMPluginManifestEntry  *entry,
+                        GError                      **error)
+{
+    GKeyFile *key_file = self->key_file;
+    guint64   mtime;
+    guint64   size;
+    guint     i;
+
+    g_return_val_if_fail (entry->name, FALSE);
+
+    if (!stat_plugin (plugin_path, &mtime, &size, error))
+        return FALSE;
+
+    g_key_file_remove_group (key_file, plugin_path, NULL);
+    g_key_file_set_uint64  (key_file, plugin_path, ENTRY_KEY_MTIME,        mtime);
+    g_key_file_set_uint64  (key_file, plugin_path, ENTRY_KEY_SIZE,         size);
+    g_key_file_set_string  (key_file, plugin_path, ENTRY_KEY_NAME,         entry->name);
+    g_key_file_set_boolean (key_file, plugin_path, ENTRY_KEY_GENERIC,      entry->generic);
+    g_key_file_set_boolean (key_file, plugin_path, ENTRY_KEY_IDS_OPTIONAL, entry->ids_optional);
+    set_string_list (key_file, plugin_path, ENTRY_KEY_SUBSYSTEMS, entry->subsystems);
+    set_string_list (key_file, plugin_path, ENTRY_KEY_DRIVERS,    entry->drivers);
+    set_string_list (key_file, plugin_path, ENTRY_KEY_UDEV_TAGS,  entry->udev_tags);
+
+    if (entry->vendor_ids) {
+        g_autoptr(GPtrArray) strs = NULL;
+
+        strs = g_ptr_array_new_with_free_func (g_free);
+        for (i = 0; entry->vendor_ids[i]; i++)
+            g_ptr_array_add (strs, g_strdup_printf ("%04x", entry->vendor_ids[i]));
+        g_ptr_array_add (strs, NULL);
+        g_key_file_set_string_list (key_file, plugin_path, ENTRY_KEY_VENDOR_IDS,
+                                    (const gchar * const *) strs->pdata, strs->len - 1);
+    }
+
+    if (entry->product_ids) {
+        g_autoptr(GPtrArray) strs = NULL;
+
+        strs = g_ptr_array_new_with_free_func (g_free);
+        for (i = 0; entry->product_ids[i].l; i++)
+            g_ptr_array_add (strs, g_strdup_printf ("%04x:%04x", entry->product_ids[i].l, entry->product_ids[i].r));
+        g_ptr_array_add (strs, NULL);
+        g_key_file_set_string_list (key_file, plugin_path, ENTRY_KEY_PRODUCT_IDS,
+                                    (const gchar * const *) strs->pdata, strs->len - 1);
+    }
+
+    return TRUE;
+}
+
+guint
+mm_plugin_manifest_get_n_entries (MMPluginManifest *self)
+{
+    g_auto(GStrv) groups = NULL;
+    gsize         n_groups = 0;
+
+    groups = g_key_file_get_groups (self->key_file, &n_groups);
+    g_assert (n_groups > 0);
+    return (guint) n_groups - 1;
+}
+
+/*****************************************************************************/
+
+gboolean
+mm_plugin_manifest_save (MMPluginManifest  *self,
+                         const gchar       *path,
+                         GError           **error)
+{
+    g_autofree gchar *dir = NULL;
+
+    dir = g_path_get_dirname (path);
+    if (g_mkdir_with_parents (dir, 0755) < 0) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "couldn't create directory '%s': %s", dir, g_strerror (errno));
+        return FALSE;
+    }
+
+    return g_key_file_save_to_file (self->key_file, path, error);
+}
+
+MMPluginManifest *
+mm_plugin_manifest_load (const gchar  *path,
+                         GError      **error)
+{
+    g_autoptr(MMPluginManifest)  self = NULL;
+    g_autofree gchar            *daemon_version = NULL;
+
+    self = g_slice_new0 (MMPluginManifest);
+    self->key_file = g_key_file_new ();
+    if (!g_key_file_load_from_file (self->key_file, path, G_KEY_FILE_NONE, error))
+        return NULL;
+
+    daemon_version = g_key_file_get_string (self->key_file, MANIFEST_GROUP, MANIFEST_KEY_DAEMON_VERSION, NULL);
+    if (g_strcmp0 (daemon_version, PACKAGE_VERSION) != 0) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_WRONG_STATE,
+                     "manifest written by daemon version '%s'",
+                     daemon_version ? daemon_version : "unknown");
+        return NULL;
+    }
+
+    return g_steal_pointer (&self);
+}
+
+MMPluginManifest *
+mm_plugin_manifest_new (void)
+{
+    MMPluginManifest *self;
+
+    self = g_slice_new0 (MMPluginManifest);
+    self->key_file = g_key_file_new ();
+    g_key_file_set_string (self->key_file, MANIFEST_GROUP, MANIFEST_KEY_DAEMON_VERSION, PACKAGE_VERSION);
+    return self;
+}
+
+void
+mm_plugin_manifest_free (MMPluginManifest *self)
+{
+    g_key_file_unref (self->key_file);
+    g_slice_free (MMPluginManifest, self);
+}
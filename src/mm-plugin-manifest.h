@@ -0,0 +1,66 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_PLUGIN_MANIFEST_H
+#define MM_PLUGIN_MANIFEST_H
+
+#include <glib.h>
+
+#include "mm-private-boxed-types.h"
+
+/* Manifest of the pre-probing filters of the plugins installed in the system,
+ * so that they can be known without loading each plugin module.
+ *
+ * Each entry is keyed by the path of the plugin module, and is only valid while
+ * the modification time and size of the module are the ones recorded when the
+ * entry was added. The whole manifest is discarded if it was written by a
+ * different daemon version. */
+
+typedef struct {
+    gchar           *name;
+    gboolean         generic;
+    gchar          **subsystems;
+    gchar          **drivers;
+    guint16         *vendor_ids;
+    mm_uint16_pair  *product_ids;
+    gboolean         ids_optional;
+    gchar          **udev_tags;
+} MMPluginManifestEntry;
+
+void mm_plugin_manifest_entry_free (MMPluginManifestEntry *entry);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MMPluginManifestEntry, mm_plugin_manifest_entry_free)
+
+typedef struct _MMPluginManifest MMPluginManifest;
+
+MMPluginManifest      *mm_plugin_manifest_new           (void);
+MMPluginManifest      *mm_plugin_manifest_load          (const gchar                  *path,
+                                                         GError                      **error);
+gboolean               mm_plugin_manifest_save          (MMPluginManifest             *self,
+                                                         const gchar                  *path,
+                                                         GError                      **error);
+void                   mm_plugin_manifest_free          (MMPluginManifest             *self);
+
+guint                  mm_plugin_manifest_get_n_entries (MMPluginManifest             *self);
+
+/* Returns NULL if there is no entry for the module, or if it's stale */
+MMPluginManifestEntry *mm_plugin_manifest_lookup        (MMPluginManifest             *self,
+                                                         const gchar                  *plugin_path);
+gboolean               mm_plugin_manifest_add           (MMPluginManifest             *self,
+                                                         const gchar                  *plugin_path,
+                                                         const MMPluginManifestEntry  *entry,
+                                                         GError                      **error);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MMPluginManifest, mm_plugin_manifest_free)
+
+#endif /* MM_PLUGIN_MANIFEST_H */
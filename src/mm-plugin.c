@@ -96,6 +96,7 @@ struct _MMPluginPrivate {
     gboolean xmm_probe;
     MMPortProbeAtCommand *custom_at_probe;
     guint64 send_delay;
+    gboolean send_delay_adaptive;
     gboolean remove_echo;
     gboolean send_lf;
 
@@ -133,6 +134,7 @@ enum {
     PROP_CUSTOM_AT_PROBE,
     PROP_CUSTOM_INIT,
     PROP_SEND_DELAY,
+    PROP_SEND_DELAY_ADAPTIVE,
     PROP_REMOVE_ECHO,
     PROP_SEND_LF,
     LAST_PROP
@@ -152,6 +154,12 @@ mm_plugin_get_allowed_subsystems (MMPlugin *self)
     return (const gchar **) self->priv->subsystems;
 }
 
+const gchar **
+mm_plugin_get_allowed_drivers (MMPlugin *self)
+{
+    return (const gchar **) self->priv->drivers;
+}
+
 const gchar **
 mm_plugin_get_allowed_udev_tags (MMPlugin *self)
 {
@@ -170,6 +178,16 @@ mm_plugin_get_allowed_product_ids (MMPlugin *self)
     return self->priv->product_ids;
 }
 
+/* When vendor or product strings are given, ports filtered by vendor and
+ * product IDs may still be probed for those strings */
+gboolean
+mm_plugin_has_string_filters (MMPlugin *self)
+{
+    return (self->priv->vendor_strings ||
+            self->priv->product_strings ||
+            self->priv->forbidden_product_strings);
+}
+
 gboolean
 mm_plugin_is_generic (MMPlugin *self)
 {
@@ -212,14 +230,12 @@ is_virtual_port (const gchar *device_name)
 
 /* Returns TRUE if the support check request was filtered out */
 static gboolean
-apply_subsystem_filter (MMPlugin       *self,
-                        MMKernelDevice *port)
+apply_subsystem_filter (MMPlugin    *self,
+                        const gchar *subsys)
 {
     if (self->priv->subsystems) {
-        const gchar *subsys;
         guint i;
 
-        subsys = mm_kernel_device_get_subsystem (port);
         for (i = 0; self->priv->subsystems[i]; i++) {
             if (g_str_equal (subsys, self->priv->subsystems[i]))
                 break;
@@ -233,16 +249,19 @@ apply_subsystem_filter (MMPlugin       *self,
     return FALSE;
 }
 
-/* Returns TRUE if the support check request was filtered out */
-static gboolean
-apply_pre_probing_filters (MMPlugin       *self,
-                           MMDevice       *device,
-                           MMKernelDevice *port,
-                           gboolean       *need_vendor_probing,
-                           gboolean       *need_product_probing)
+gboolean
+mm_plugin_apply_pre_probing_filters (MMPlugin                  *self,
+                                     const gchar               *subsystem,
+                                     const gchar               *name,
+                                     const gchar              **drivers,
+                                     guint16                    vendor,
+                                     guint16                    product,
+                                     MMPluginIndexUdevTagFunc   udev_tag_func,
+                                     gpointer                   udev_tag_user_data,
+                                     gboolean                  *need_vendor_probing,
+                                     gboolean                  *need_product_probing,
+                                     const gchar              **filtered_reason)
 {
-    guint16 vendor;
-    guint16 product;
     gboolean product_filtered = FALSE;
     gboolean vendor_filtered = FALSE;
     guint i;
@@ -252,8 +271,8 @@ apply_pre_probing_filters (MMPlugin       *self,
 
     /* The plugin may specify that only some subsystems are supported. If that
      * is the case, filter by subsystem */
-    if (apply_subsystem_filter (self, port)) {
-        mm_obj_dbg (self, "port %s filtered by subsystem", mm_kernel_device_get_name (port));
+    if (apply_subsystem_filter (self, subsystem)) {
+        *filtered_reason = "by subsystem";
         return TRUE;
     }
 
@@ -272,17 +291,9 @@ apply_pre_probing_filters (MMPlugin       *self,
         self->priv->forbidden_drivers ||
         !self->priv->qmi ||
         !self->priv->mbim) {
-        static const gchar *virtual_drivers [] = { "virtual", NULL };
-        const gchar **drivers;
-
-        /* Detect any modems accessible through the list of virtual ports */
-        drivers = (is_virtual_port (mm_kernel_device_get_name (port)) ?
-                   virtual_drivers :
-                   mm_device_get_drivers (device));
-
         /* If error retrieving driver: unsupported */
         if (!drivers) {
-            mm_obj_dbg (self, "port %s filtered as couldn't retrieve drivers", mm_kernel_device_get_name (port));
+            *filtered_reason = "as couldn't retrieve drivers";
             return TRUE;
         }
 
@@ -301,7 +312,7 @@ apply_pre_probing_filters (MMPlugin       *self,
 
             /* If we didn't match any driver: unsupported */
             if (!found) {
-                mm_obj_dbg (self, "port %s filtered by drivers", mm_kernel_device_get_name (port));
+                *filtered_reason = "by drivers";
                 return TRUE;
             }
         }
@@ -314,7 +325,7 @@ apply_pre_probing_filters (MMPlugin       *self,
                 for (j = 0; drivers[j]; j++) {
                     /* If we match a forbidden driver: unsupported */
                     if (g_str_equal (drivers[j], self->priv->forbidden_drivers[i])) {
-                        mm_obj_dbg (self, "port %s filtered by forbidden drivers", mm_kernel_device_get_name (port));
+                        *filtered_reason = "by forbidden drivers";
                         return TRUE;
                     }
                 }
@@ -328,7 +339,7 @@ apply_pre_probing_filters (MMPlugin       *self,
             for (j = 0; drivers[j]; j++) {
                 /* If we match the QMI driver: unsupported */
                 if (g_str_equal (drivers[j], "qmi_wwan")) {
-                    mm_obj_dbg (self, "port %s filtered by implicit QMI driver", mm_kernel_device_get_name (port));
+                    *filtered_reason = "by implicit QMI driver";
                     return TRUE;
                 }
             }
@@ -341,16 +352,13 @@ apply_pre_probing_filters (MMPlugin       *self,
             for (j = 0; drivers[j]; j++) {
                 /* If we match the MBIM driver: unsupported */
                 if (g_str_equal (drivers[j], "cdc_mbim")) {
-                    mm_obj_dbg (self, "port %s filtered by implicit MBIM driver", mm_kernel_device_get_name (port));
+                    *filtered_reason = "by implicit MBIM driver";
                     return TRUE;
                 }
             }
         }
     }
 
-    vendor = mm_device_get_vendor (device);
-    product = mm_device_get_product (device);
-
     /* The plugin may specify that only some vendor IDs are supported. If that
      * is the case, filter by vendor ID. */
     if (self->priv->vendor_ids) {
@@ -403,9 +411,9 @@ apply_pre_probing_filters (MMPlugin       *self,
         ((!self->priv->vendor_strings &&
           !self->priv->product_strings &&
           !self->priv->forbidden_product_strings) ||
-         g_str_equal (mm_kernel_device_get_subsystem (port), "net") ||
-         g_str_has_prefix (mm_kernel_device_get_name (port), "cdc-wdm"))) {
-        mm_obj_dbg (self, "port %s filtered by vendor/product IDs", mm_kernel_device_get_name (port));
+         g_str_equal (subsystem, "net") ||
+         g_str_has_prefix (name, "cdc-wdm"))) {
+        *filtered_reason = "by vendor/product IDs";
         return TRUE;
     }
 
@@ -415,7 +423,7 @@ apply_pre_probing_filters (MMPlugin       *self,
         for (i = 0; self->priv->forbidden_product_ids[i].l; i++) {
             if (vendor == self->priv->forbidden_product_ids[i].l &&
                 product == self->priv->forbidden_product_ids[i].r) {
-                mm_obj_dbg (self, "port %s filtered by forbidden vendor/product IDs", mm_kernel_device_get_name (port));
+                *filtered_reason = "by forbidden vendor/product IDs";
                 return TRUE;
             }
         }
@@ -448,13 +456,13 @@ apply_pre_probing_filters (MMPlugin       *self,
     if (self->priv->udev_tags) {
         for (i = 0; self->priv->udev_tags[i]; i++) {
             /* Check if the port or device was tagged */
-            if (mm_kernel_device_get_global_property_as_boolean (port, self->priv->udev_tags[i]))
+            if (udev_tag_func && udev_tag_func (self->priv->udev_tags[i], udev_tag_user_data))
                 break;
         }
 
         /* If we didn't match any udev tag: unsupported */
         if (!self->priv->udev_tags[i]) {
-            mm_obj_dbg (self, "port %s filtered by udev tags", mm_kernel_device_get_name (port));
+            *filtered_reason = "by udev tags";
             return TRUE;
         }
     }
@@ -462,6 +470,47 @@ apply_pre_probing_filters (MMPlugin       *self,
     return FALSE;
 }
 
+static gboolean
+port_has_udev_tag (const gchar    *tag,
+                   MMKernelDevice *port)
+{
+    return mm_kernel_device_get_global_property_as_boolean (port, tag);
+}
+
+/* Returns TRUE if the support check request was filtered out */
+static gboolean
+apply_pre_probing_filters (MMPlugin       *self,
+                           MMDevice       *device,
+                           MMKernelDevice *port,
+                           gboolean       *need_vendor_probing,
+                           gboolean       *need_product_probing)
+{
+    static const gchar *virtual_drivers [] = { "virtual", NULL };
+    const gchar **drivers;
+    const gchar *filtered_reason = NULL;
+
+    /* Detect any modems accessible through the list of virtual ports */
+    drivers = (is_virtual_port (mm_kernel_device_get_name (port)) ?
+               virtual_drivers :
+               mm_device_get_drivers (device));
+
+    if (!mm_plugin_apply_pre_probing_filters (self,
+                                              mm_kernel_device_get_subsystem (port),
+                                              mm_kernel_device_get_name (port),
+                                              drivers,
+                                              mm_device_get_vendor (device),
+                                              mm_device_get_product (device),
+                                              (MMPluginIndexUdevTagFunc) port_has_udev_tag,
+                                              port,
+                                              need_vendor_probing,
+                                              need_product_probing,
+                                              &filtered_reason))
+        return FALSE;
+
+    mm_obj_dbg (self, "port %s filtered %s", mm_kernel_device_get_name (port), filtered_reason);
+    return TRUE;
+}
+
 /* Returns TRUE if the support check request was filtered out */
 static gboolean
 apply_post_probing_filters (MMPlugin *self,
@@ -844,6 +893,7 @@ mm_plugin_supports_port (MMPlugin            *self,
     mm_port_probe_run (probe,
                        ctx->flags,
                        self->priv->send_delay,
+                       self->priv->send_delay_adaptive,
                        self->priv->remove_echo,
                        self->priv->send_lf,
                        self->priv->custom_at_probe,
@@ -1115,6 +1165,7 @@ mm_plugin_init (MMPlugin *self)
 
     /* Defaults */
     self->priv->send_delay = 100000;
+    self->priv->send_delay_adaptive = TRUE;
     self->priv->remove_echo = TRUE;
     self->priv->send_lf = FALSE;
 }
@@ -1232,6 +1283,10 @@ set_property (GObject *object,
         /* Construct only */
         self->priv->send_delay = (guint64)g_value_get_uint64 (value);
         break;
+    case PROP_SEND_DELAY_ADAPTIVE:
+        /* Construct only */
+        self->priv->send_delay_adaptive = g_value_get_boolean (value);
+        break;
     case PROP_REMOVE_ECHO:
         /* Construct only */
         self->priv->remove_echo = g_value_get_boolean (value);
@@ -1333,6 +1388,9 @@ get_property (GObject *object,
     case PROP_SEND_DELAY:
         g_value_set_uint64 (value, self->priv->send_delay);
         break;
+    case PROP_SEND_DELAY_ADAPTIVE:
+        g_value_set_boolean (value, self->priv->send_delay_adaptive);
+        break;
     case PROP_REMOVE_ECHO:
         g_value_set_boolean (value, self->priv->remove_echo);
         break;
@@ -1612,6 +1670,16 @@ mm_plugin_class_init (MMPluginClass *klass)
                               0, G_MAXUINT64, 100000,
                               G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
 
+    g_object_class_install_property
+        (object_class, PROP_SEND_DELAY_ADAPTIVE,
+         g_param_spec_boolean (MM_PLUGIN_SEND_DELAY_ADAPTIVE,
+                               "Send delay adaptive",
+                               "Send full AT commands in a single write while "
+                               "probing, and only apply the send delay in the "
+                               "devices found losing characters",
+                               TRUE,
+                               G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
     g_object_class_install_property
         (object_class, PROP_REMOVE_ECHO,
          g_param_spec_boolean (MM_PLUGIN_REMOVE_ECHO,
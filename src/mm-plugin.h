@@ -26,6 +26,7 @@
 #include "mm-port-probe.h"
 #include "mm-device.h"
 #include "mm-kernel-device.h"
+#include "mm-plugin-index.h"
 
 #define MM_PLUGIN_MAJOR_VERSION 4
 #define MM_PLUGIN_MINOR_VERSION 0
@@ -72,6 +73,7 @@
 #define MM_PLUGIN_CUSTOM_INIT               "custom-init"
 #define MM_PLUGIN_CUSTOM_AT_PROBE           "custom-at-probe"
 #define MM_PLUGIN_SEND_DELAY                "send-delay"
+#define MM_PLUGIN_SEND_DELAY_ADAPTIVE       "send-delay-adaptive"
 #define MM_PLUGIN_REMOVE_ECHO               "remove-echo"
 #define MM_PLUGIN_SEND_LF                   "send-lf"
 
@@ -127,11 +129,28 @@ G_DEFINE_AUTOPTR_CLEANUP_FUNC (MMPlugin, g_object_unref)
 
 const gchar           *mm_plugin_get_name                (MMPlugin *self);
 const gchar          **mm_plugin_get_allowed_subsystems  (MMPlugin *self);
+const gchar          **mm_plugin_get_allowed_drivers     (MMPlugin *self);
 const gchar          **mm_plugin_get_allowed_udev_tags   (MMPlugin *self);
 const guint16         *mm_plugin_get_allowed_vendor_ids  (MMPlugin *self);
 const mm_uint16_pair  *mm_plugin_get_allowed_product_ids (MMPlugin *self);
+gboolean               mm_plugin_has_string_filters      (MMPlugin *self);
 gboolean               mm_plugin_is_generic              (MMPlugin *self);
 
+/* Runs all pre-probing filters on the given port details, without requiring
+ * the device or port objects. Returns TRUE if the port is filtered out, with a
+ * short description of the filter that discarded it. */
+gboolean mm_plugin_apply_pre_probing_filters (MMPlugin                  *self,
+                                              const gchar               *subsystem,
+                                              const gchar               *name,
+                                              const gchar              **drivers,
+                                              guint16                    vendor,
+                                              guint16                    product,
+                                              MMPluginIndexUdevTagFunc   udev_tag_func,
+                                              gpointer                   udev_tag_user_data,
+                                              gboolean                  *need_vendor_probing,
+                                              gboolean                  *need_product_probing,
+                                              const gchar              **filtered_reason);
+
 /* This method will run all pre-probing filters, to see if we can discard this
  * plugin from the probing logic as soon as possible. */
 MMPluginSupportsHint mm_plugin_discard_port_early (MMPlugin       *self,
@@ -53,7 +53,7 @@ typedef gboolean (* MMPortProbeAtResponseProcessor) (const gchar *command,
 typedef struct {
     /* The AT command */
     const gchar *command;
-    /* Timeout of the command, in seconds */
+    /* Timeout of the command, in milliseconds */
     guint timeout;
     /* The response processor */
     MMPortProbeAtResponseProcessor response_processor;
@@ -0,0 +1,124 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <string.h>
+
+#include "mm-port-probe-cache.h"
+#include "mm-state-key-file.h"
+#include "mm-log-object.h"
+
+#define CACHE_KEY_FLAGS    "flags"
+#define CACHE_KEY_AT       "at"
+#define CACHE_KEY_QCDM     "qcdm"
+#define CACHE_KEY_QMI      "qmi"
+#define CACHE_KEY_MBIM     "mbim"
+#define CACHE_KEY_VENDOR   "vendor"
+#define CACHE_KEY_PRODUCT  "product"
+#define CACHE_KEY_ICERA    "icera"
+#define CACHE_KEY_XMM      "xmm"
+
+static MMStateKeyFile cache = MM_STATE_KEY_FILE_INIT ("port-probe-cache", "port probe cache");
+
+/*****************************************************************************/
+
+void
+mm_port_probe_cache_entry_clear (MMPortProbeCacheEntry *entry)
+{
+    g_free (entry->vendor);
+    g_free (entry->product);
+    memset (entry, 0, sizeof (MMPortProbeCacheEntry));
+}
+
+gboolean
+mm_port_probe_cache_lookup (const gchar           *key,
+                            MMPortProbeCacheEntry *entry,
+                            gpointer               log_object)
+{
+    GKeyFile *key_file;
+    GError   *error = NULL;
+
+    memset (entry, 0, sizeof (MMPortProbeCacheEntry));
+
+    key_file = mm_state_key_file_peek (&cache, log_object);
+    entry->flags = (guint32) g_key_file_get_uint64 (key_file, key, CACHE_KEY_FLAGS, &error);
+    if (error) {
+        g_error_free (error);
+        return FALSE;
+    }
+
+    entry->is_at    = g_key_file_get_boolean (key_file, key, CACHE_KEY_AT,    NULL);
+    entry->is_qcdm  = g_key_file_get_boolean (key_file, key, CACHE_KEY_QCDM,  NULL);
+    entry->is_qmi   = g_key_file_get_boolean (key_file, key, CACHE_KEY_QMI,   NULL);
+    entry->is_mbim  = g_key_file_get_boolean (key_file, key, CACHE_KEY_MBIM,  NULL);
+    entry->is_icera = g_key_file_get_boolean (key_file, key, CACHE_KEY_ICERA, NULL);
+    entry->is_xmm   = g_key_file_get_boolean (key_file, key, CACHE_KEY_XMM,   NULL);
+    entry->vendor   = g_key_file_get_string  (key_file, key, CACHE_KEY_VENDOR,  NULL);
+    entry->product  = g_key_file_get_string  (key_file, key, CACHE_KEY_PRODUCT, NULL);
+    return TRUE;
+}
+
+void
+mm_port_probe_cache_update (const gchar                 *key,
+                            const MMPortProbeCacheEntry *entry,
+                            gpointer                     log_object)
+{
+    GKeyFile              *key_file;
+    MMPortProbeCacheEntry  current;
+    gboolean               unchanged;
+
+    /* Nothing to do if already known */
+    if (mm_port_probe_cache_lookup (key, &current, log_object)) {
+        unchanged = (current.flags == entry->flags &&
+                     current.is_at == entry->is_at &&
+                     current.is_qcdm == entry->is_qcdm &&
+                     current.is_qmi == entry->is_qmi &&
+                     current.is_mbim == entry->is_mbim &&
+                     current.is_icera == entry->is_icera &&
+                     current.is_xmm == entry->is_xmm &&
+                     !g_strcmp0 (current.vendor, entry->vendor) &&
+                     !g_strcmp0 (current.product, entry->product));
+        mm_port_probe_cache_entry_clear (&current);
+        if (unchanged)
+            return;
+    }
+
+    /* Always rewrite the whole key, so that no stale key is kept */
+    key_file = mm_state_key_file_peek (&cache, log_object);
+    g_key_file_remove_group (key_file, key, NULL);
+    g_key_file_set_uint64  (key_file, key, CACHE_KEY_FLAGS, entry->flags);
+    g_key_file_set_boolean (key_file, key, CACHE_KEY_AT,    entry->is_at);
+    g_key_file_set_boolean (key_file, key, CACHE_KEY_QCDM,  entry->is_qcdm);
+    g_key_file_set_boolean (key_file, key, CACHE_KEY_QMI,   entry->is_qmi);
+    g_key_file_set_boolean (key_file, key, CACHE_KEY_MBIM,  entry->is_mbim);
+    g_key_file_set_boolean (key_file, key, CACHE_KEY_ICERA, entry->is_icera);
+    g_key_file_set_boolean (key_file, key, CACHE_KEY_XMM,   entry->is_xmm);
+    if (entry->vendor)
+        g_key_file_set_string (key_file, key, CACHE_KEY_VENDOR, entry->vendor);
+    if (entry->product)
+        g_key_file_set_string (key_file, key, CACHE_KEY_PRODUCT, entry->product);
+    mm_obj_dbg (log_object, "port probing results of %s stored in cache", key);
+
+    mm_state_key_file_save (&cache, log_object);
+}
+
+void
+mm_port_probe_cache_invalidate (const gchar *key,
+                                gpointer     log_object)
+{
+    if (!g_key_file_remove_group (mm_state_key_file_peek (&cache, log_object), key, NULL))
+        return;
+    mm_obj_dbg (log_object, "port probing results of %s removed from cache", key);
+
+    mm_state_key_file_save (&cache, log_object);
+}
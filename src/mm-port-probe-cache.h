@@ -0,0 +1,47 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_PORT_PROBE_CACHE_H
+#define MM_PORT_PROBE_CACHE_H
+
+#include <glib.h>
+
+/* Persistent record of the port probing results. The key given identifies
+ * the port across runs, e.g. the vid:pid of the physical device plus the USB
+ * interface number, driver and subsystem of the port. */
+
+typedef struct {
+    /* Mask of MMPortProbeFlag values with a known result */
+    guint32   flags;
+    gboolean  is_at;
+    gboolean  is_qcdm;
+    gboolean  is_qmi;
+    gboolean  is_mbim;
+    gchar    *vendor;
+    gchar    *product;
+    gboolean  is_icera;
+    gboolean  is_xmm;
+} MMPortProbeCacheEntry;
+
+void     mm_port_probe_cache_entry_clear (MMPortProbeCacheEntry       *entry);
+
+gboolean mm_port_probe_cache_lookup      (const gchar                 *key,
+                                          MMPortProbeCacheEntry       *entry,
+                                          gpointer                     log_object);
+void     mm_port_probe_cache_update      (const gchar                 *key,
+                                          const MMPortProbeCacheEntry *entry,
+                                          gpointer                     log_object);
+void     mm_port_probe_cache_invalidate  (const gchar                 *key,
+                                          gpointer                     log_object);
+
+#endif /* MM_PORT_PROBE_CACHE_H */
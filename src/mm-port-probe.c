@@ -32,6 +32,8 @@
 #include "mm-port-serial.h"
 #include "mm-serial-parsers.h"
 #include "mm-port-probe-at.h"
+#include "mm-send-delay-store.h"
+#include "mm-port-probe-cache.h"
 #include "libqcdm/src/commands.h"
 #include "libqcdm/src/utils.h"
 #include "libqcdm/src/errors.h"
@@ -104,6 +106,11 @@ struct _MMPortProbePrivate {
     gboolean maybe_qmi;
     gboolean maybe_mbim;
 
+    /* Port type loaded from the cache, pending confirmation */
+    MMPortProbeFlag cached_unconfirmed;
+    /* Cached results dropped while probing */
+    gboolean cached_dropped;
+
     /* Current probing task. Only one can be available at a time */
     GTask *task;
 };
@@ -156,10 +163,84 @@ port_probe_task_return_boolean (MMPortProbe *self,
 
 /*****************************************************************************/
 
+/* Ports are cached by the vid:pid of the physical device plus the USB
+ * interface number, driver and subsystem of the port; ports without vid, pid
+ * or interface number are never cached */
+static gchar *
+port_probe_build_cache_key (MMPortProbe *self)
+{
+    guint16      vid;
+    guint16      pid;
+    const gchar *interface_number;
+    const gchar *driver;
+
+    vid = mm_kernel_device_get_physdev_vid (self->priv->port);
+    pid = mm_kernel_device_get_physdev_pid (self->priv->port);
+    interface_number = mm_kernel_device_get_property (self->priv->port, "ID_USB_INTERFACE_NUM");
+    driver = mm_kernel_device_get_driver (self->priv->port);
+    if (!vid || !pid || !interface_number)
+        return NULL;
+
+    return g_strdup_printf ("%04x:%04x:%s:%s:%s",
+                            vid, pid, interface_number,
+                            driver ? driver : "unknown",
+                            mm_kernel_device_get_subsystem (self->priv->port));
+}
+
+static void
+port_probe_invalidate_cached_results (MMPortProbe *self)
+{
+    g_autofree gchar *key = NULL;
+
+    key = port_probe_build_cache_key (self);
+    if (key)
+        mm_port_probe_cache_invalidate (key, self);
+}
+
+static void
+port_probe_clear_results (MMPortProbe *self)
+{
+    self->priv->flags = MM_PORT_PROBE_NONE;
+    self->priv->is_at = FALSE;
+    self->priv->is_qcdm = FALSE;
+    self->priv->is_qmi = FALSE;
+    self->priv->is_mbim = FALSE;
+    self->priv->is_icera = FALSE;
+    self->priv->is_xmm = FALSE;
+    g_clear_pointer (&self->priv->vendor, g_free);
+    g_clear_pointer (&self->priv->product, g_free);
+}
+
+/* A new result for the port type loaded from the cache either confirms all
+ * the cached results, or drops all of them so that the port is probed again
+ * as if nothing was cached */
+static void
+port_probe_confirm_cached_results (MMPortProbe     *self,
+                                   MMPortProbeFlag  flag,
+                                   const gchar     *type,
+                                   gboolean         result)
+{
+    if (self->priv->cached_unconfirmed != flag)
+        return;
+
+    self->priv->cached_unconfirmed = MM_PORT_PROBE_NONE;
+    if (result) {
+        mm_obj_dbg (self, "cached port probing results confirmed");
+        return;
+    }
+
+    mm_obj_dbg (self, "cached port probing results invalidated: port is no longer %s-capable", type);
+    port_probe_invalidate_cached_results (self);
+    port_probe_clear_results (self);
+    self->priv->cached_dropped = TRUE;
+}
+
 void
 mm_port_probe_set_result_at (MMPortProbe *self,
                              gboolean at)
 {
+    port_probe_confirm_cached_results (self, MM_PORT_PROBE_AT, "AT", at);
+
     self->priv->is_at = at;
     self->priv->flags |= MM_PORT_PROBE_AT;
 
@@ -249,6 +330,8 @@ void
 mm_port_probe_set_result_qcdm (MMPortProbe *self,
                                gboolean qcdm)
 {
+    port_probe_confirm_cached_results (self, MM_PORT_PROBE_QCDM, "QCDM", qcdm);
+
     self->priv->is_qcdm = qcdm;
     self->priv->flags |= MM_PORT_PROBE_QCDM;
 
@@ -278,6 +361,8 @@ void
 mm_port_probe_set_result_qmi (MMPortProbe *self,
                               gboolean qmi)
 {
+    port_probe_confirm_cached_results (self, MM_PORT_PROBE_QMI, "QMI", qmi);
+
     self->priv->is_qmi = qmi;
     self->priv->flags |= MM_PORT_PROBE_QMI;
 
@@ -305,6 +390,8 @@ void
 mm_port_probe_set_result_mbim (MMPortProbe *self,
                                gboolean mbim)
 {
+    port_probe_confirm_cached_results (self, MM_PORT_PROBE_MBIM, "MBIM", mbim);
+
     self->priv->is_mbim = mbim;
     self->priv->flags |= MM_PORT_PROBE_MBIM;
 
@@ -330,8 +417,104 @@ mm_port_probe_set_result_mbim (MMPortProbe *self,
 
 /*****************************************************************************/
 
+gboolean
+mm_port_probe_load_cached_results (MMPortProbe *self)
+{
+    g_autofree gchar      *key = NULL;
+    MMPortProbeCacheEntry  entry;
+
+    g_return_val_if_fail (MM_IS_PORT_PROBE (self), FALSE);
+
+    /* Only before any probing has been done */
+    if (self->priv->flags != MM_PORT_PROBE_NONE || self->priv->task)
+        return FALSE;
+
+    key = port_probe_build_cache_key (self);
+    if (!key || !mm_port_probe_cache_lookup (key, &entry, self)) {
+        mm_obj_dbg (self, "no cached port probing results");
+        return FALSE;
+    }
+
+    /* Only ports with a known type are ever stored */
+    if (!entry.is_at && !entry.is_qcdm && !entry.is_qmi && !entry.is_mbim) {
+        mm_obj_dbg (self, "cached port probing results invalidated: unknown port type");
+        mm_port_probe_cache_invalidate (key, self);
+        mm_port_probe_cache_entry_clear (&entry);
+        return FALSE;
+    }
+
+    self->priv->flags = entry.flags;
+    self->priv->is_at = entry.is_at;
+    self->priv->is_qcdm = entry.is_qcdm;
+    self->priv->is_qmi = entry.is_qmi;
+    self->priv->is_mbim = entry.is_mbim;
+    self->priv->is_icera = entry.is_icera;
+    self->priv->is_xmm = entry.is_xmm;
+    g_free (self->priv->vendor);
+    self->priv->vendor = g_steal_pointer (&entry.vendor);
+    g_free (self->priv->product);
+    self->priv->product = g_steal_pointer (&entry.product);
+    mm_port_probe_cache_entry_clear (&entry);
+
+    /* The probing of the cached port type is still run, which is quick on a
+     * port of that type, and all the cached results are dropped if it fails.
+     * A positive AT result also implies the QCDM, QMI and MBIM ones, so leave
+     * those unknown until confirmed. */
+    if (self->priv->is_at) {
+        self->priv->flags &= ~(MM_PORT_PROBE_AT | MM_PORT_PROBE_QCDM | MM_PORT_PROBE_QMI | MM_PORT_PROBE_MBIM);
+        self->priv->cached_unconfirmed = MM_PORT_PROBE_AT;
+    } else if (self->priv->is_qcdm) {
+        self->priv->flags &= ~MM_PORT_PROBE_QCDM;
+        self->priv->cached_unconfirmed = MM_PORT_PROBE_QCDM;
+    } else if (self->priv->is_qmi) {
+        self->priv->flags &= ~MM_PORT_PROBE_QMI;
+        self->priv->cached_unconfirmed = MM_PORT_PROBE_QMI;
+    } else {
+        self->priv->flags &= ~MM_PORT_PROBE_MBIM;
+        self->priv->cached_unconfirmed = MM_PORT_PROBE_MBIM;
+    }
+
+    mm_obj_dbg (self, "using cached port probing results (%s-capable, pending confirmation)",
+                self->priv->is_at ? "AT" : (self->priv->is_qcdm ? "QCDM" : (self->priv->is_qmi ? "QMI" : "MBIM")));
+    return TRUE;
+}
+
+void
+mm_port_probe_store_cached_results (MMPortProbe *self)
+{
+    g_autofree gchar      *key = NULL;
+    MMPortProbeCacheEntry  entry;
+
+    g_return_if_fail (MM_IS_PORT_PROBE (self));
+
+    /* Nothing new learned if the cached results were never confirmed; and
+     * ports without a known type may just have been slow to reply */
+    if (self->priv->cached_unconfirmed != MM_PORT_PROBE_NONE)
+        return;
+    if (!self->priv->is_at && !self->priv->is_qcdm && !self->priv->is_qmi && !self->priv->is_mbim)
+        return;
+
+    key = port_probe_build_cache_key (self);
+    if (!key)
+        return;
+
+    entry.flags = self->priv->flags;
+    entry.is_at = self->priv->is_at;
+    entry.is_qcdm = self->priv->is_qcdm;
+    entry.is_qmi = self->priv->is_qmi;
+    entry.is_mbim = self->priv->is_mbim;
+    entry.vendor = self->priv->vendor;
+    entry.product = self->priv->product;
+    entry.is_icera = self->priv->is_icera;
+    entry.is_xmm = self->priv->is_xmm;
+    mm_port_probe_cache_update (key, &entry, self);
+}
+
+/*****************************************************************************/
+
 typedef struct {
     /* ---- Generic task context ---- */
+    guint32 requested_flags;
     guint32 flags;
     guint source_id;
     GCancellable *cancellable;
@@ -347,6 +530,10 @@ typedef struct {
     gulong at_probing_cancellable_linked;
     /* Send delay for AT commands */
     guint64 at_send_delay;
+    /* Flag to only apply the send delay if characters are found lost */
+    gboolean at_send_delay_adaptive;
+    /* Flag to learn whether the device needs the send delay */
+    gboolean at_send_delay_learn;
     /* Flag to leave/remove echo in AT responses */
     gboolean at_remove_echo;
     /* Flag to send line-feed at the end of AT commands */
@@ -378,9 +565,10 @@ typedef struct {
 #endif
 } PortProbeRunContext;
 
-static gboolean serial_probe_at       (MMPortProbe *self);
-static gboolean serial_probe_qcdm     (MMPortProbe *self);
-static void     serial_probe_schedule (MMPortProbe *self);
+static gboolean serial_probe_at        (MMPortProbe *self);
+static gboolean serial_probe_qcdm      (MMPortProbe *self);
+static void     serial_probe_schedule  (MMPortProbe *self);
+static void     port_probe_run_restart (MMPortProbe *self);
 
 static void
 port_probe_run_context_free (PortProbeRunContext *ctx)
@@ -602,6 +790,12 @@ wdm_probe (MMPortProbe *self)
     if (port_probe_task_return_error_if_cancelled (self))
         return G_SOURCE_REMOVE;
 
+    /* Cached results dropped? */
+    if (self->priv->cached_dropped) {
+        port_probe_run_restart (self);
+        return G_SOURCE_REMOVE;
+    }
+
     /* QMI probing needed? */
     if ((ctx->flags & MM_PORT_PROBE_QMI) &&
         !(self->priv->flags & MM_PORT_PROBE_QMI)) {
@@ -1063,35 +1257,35 @@ serial_probe_at (MMPortProbe *self)
 }
 
 static const MMPortProbeAtCommand at_probing[] = {
-    { "AT",  3, mm_port_probe_response_processor_is_at },
-    { "AT",  3, mm_port_probe_response_processor_is_at },
-    { "AT",  3, mm_port_probe_response_processor_is_at },
+    { "AT",  3000, mm_port_probe_response_processor_is_at },
+    { "AT",  3000, mm_port_probe_response_processor_is_at },
+    { "AT",  3000, mm_port_probe_response_processor_is_at },
     { NULL }
 };
 
 static const MMPortProbeAtCommand vendor_probing[] = {
-    { "+CGMI", 3, mm_port_probe_response_processor_string },
-    { "+GMI",  3, mm_port_probe_response_processor_string },
-    { "I",     3, mm_port_probe_response_processor_string },
+    { "+CGMI", 3000, mm_port_probe_response_processor_string },
+    { "+GMI",  3000, mm_port_probe_response_processor_string },
+    { "I",     3000, mm_port_probe_response_processor_string },
     { NULL }
 };
 
 static const MMPortProbeAtCommand product_probing[] = {
-    { "+CGMM", 3, mm_port_probe_response_processor_string },
-    { "+GMM",  3, mm_port_probe_response_processor_string },
-    { "I",     3, mm_port_probe_response_processor_string },
+    { "+CGMM", 3000, mm_port_probe_response_processor_string },
+    { "+GMM",  3000, mm_port_probe_response_processor_string },
+    { "I",     3000, mm_port_probe_response_processor_string },
     { NULL }
 };
 
 static const MMPortProbeAtCommand icera_probing[] = {
-    { "%IPSYS?", 3, mm_port_probe_response_processor_string },
-    { "%IPSYS?", 3, mm_port_probe_response_processor_string },
-    { "%IPSYS?", 3, mm_port_probe_response_processor_string },
+    { "%IPSYS?", 3000, mm_port_probe_response_processor_string },
+    { "%IPSYS?", 3000, mm_port_probe_response_processor_string },
+    { "%IPSYS?", 3000, mm_port_probe_response_processor_string },
     { NULL }
 };
 
 static const MMPortProbeAtCommand xmm_probing[] = {
-    { "+XACT=?", 3, mm_port_probe_response_processor_string },
+    { "+XACT=?", 3000, mm_port_probe_response_processor_string },
     { NULL }
 };
 
@@ -1118,6 +1312,60 @@ at_custom_init_ready (MMPortProbe *self,
 
 /***************************************************************/
 
+static void
+serial_probe_at_setup_send_delay (MMPortProbe         *self,
+                                  PortProbeRunContext *ctx)
+{
+    guint16  vid;
+    guint16  pid;
+    gboolean paced;
+
+    vid = mm_kernel_device_get_physdev_vid (self->priv->port);
+    pid = mm_kernel_device_get_physdev_pid (self->priv->port);
+
+    /* Devices known to lose characters get the send delay right away */
+    if (vid && pid && mm_send_delay_store_lookup (vid, pid, &paced, self)) {
+        if (paced) {
+            mm_obj_dbg (self, "device known to require per-byte pacing when sending AT commands");
+            return;
+        }
+    }
+
+    g_object_set (ctx->serial,
+                  MM_PORT_SERIAL_SEND_DELAY_ADAPTIVE, TRUE,
+                  NULL);
+    ctx->at_send_delay_learn = (vid && pid);
+}
+
+static void
+serial_probe_at_learn_send_delay (MMPortProbe         *self,
+                                  PortProbeRunContext *ctx)
+{
+    MMPortSerialSendStats stats;
+
+    if (!ctx->serial || !MM_IS_PORT_SERIAL_AT (ctx->serial))
+        return;
+
+    mm_port_serial_get_send_stats (ctx->serial, &stats);
+    mm_obj_dbg (self, "AT commands sent: %u in a single write (%u echoes verified), "
+                "%u with per-byte pacing (%" G_GUINT64_FORMAT " ms spent); %u losses detected",
+                stats.n_unpaced_commands, stats.n_echoes_verified,
+                stats.n_paced_commands, stats.pacing_time_ms,
+                stats.n_send_losses);
+
+    /* Only learn from actual AT ports; a device is only recorded as not
+     * requiring pacing if the echo of some command was verified */
+    if (!(self->priv->flags & MM_PORT_PROBE_AT) || !self->priv->is_at)
+        return;
+    if (!stats.paced && !stats.n_echoes_verified)
+        return;
+
+    mm_send_delay_store_update (mm_kernel_device_get_physdev_vid (self->priv->port),
+                                mm_kernel_device_get_physdev_pid (self->priv->port),
+                                stats.paced,
+                                self);
+}
+
 static void
 serial_probe_schedule (MMPortProbe *self)
 {
@@ -1130,6 +1378,12 @@ serial_probe_schedule (MMPortProbe *self)
     if (port_probe_task_return_error_if_cancelled (self))
         return;
 
+    /* Cached results dropped? */
+    if (self->priv->cached_dropped) {
+        port_probe_run_restart (self);
+        return;
+    }
+
     /* If we got some custom initialization setup requested, go on with it
      * first. We completely ignore the custom initialization if the serial port
      * that we receive in the context isn't an AT port (e.g. if it was flagged
@@ -1199,6 +1453,12 @@ serial_probe_schedule (MMPortProbe *self)
         return;
     }
 
+    /* AT probing is over, record what was learned about the send delay */
+    if (ctx->at_send_delay_learn) {
+        serial_probe_at_learn_send_delay (self, ctx);
+        ctx->at_send_delay_learn = FALSE;
+    }
+
     /* QCDM requested and not already probed? */
     if ((ctx->flags & MM_PORT_PROBE_QCDM) &&
         !(self->priv->flags & MM_PORT_PROBE_QCDM)) {
@@ -1222,9 +1482,9 @@ serial_flash_ready (MMPortSerial *port,
 }
 
 static void
-serial_buffer_full (MMPortSerial *serial,
-                    GByteArray   *buffer,
-                    MMPortProbe  *self)
+serial_buffer_full (MMPortSerial   *serial,
+                    MMSerialBuffer *buffer,
+                    MMPortProbe    *self)
 {
     PortProbeRunContext *ctx;
 
@@ -1300,6 +1560,9 @@ serial_open_at (MMPortProbe *self)
                       MM_PORT_SERIAL_AT_SEND_LF,     ctx->at_send_lf,
                       NULL);
 
+        if (subsys == MM_PORT_SUBSYS_TTY && ctx->at_send_delay && ctx->at_send_delay_adaptive)
+            serial_probe_at_setup_send_delay (self, ctx);
+
         common_serial_port_setup (self, ctx->serial);
 
         parser = mm_serial_parser_v1_new ();
@@ -1395,50 +1658,16 @@ mm_port_probe_run_finish (MMPortProbe   *self,
     return g_task_propagate_boolean (G_TASK (result), error);
 }
 
-void
-mm_port_probe_run (MMPortProbe                *self,
-                   MMPortProbeFlag             flags,
-                   guint64                     at_send_delay,
-                   gboolean                    at_remove_echo,
-                   gboolean                    at_send_lf,
-                   const MMPortProbeAtCommand *at_custom_probe,
-                   const MMAsyncMethod        *at_custom_init,
-                   GCancellable               *cancellable,
-                   GAsyncReadyCallback         callback,
-                   gpointer                    user_data)
+/* Launches the first of the requested probings still missing */
+static void
+port_probe_run_launch (MMPortProbe *self)
 {
     PortProbeRunContext *ctx;
     gchar               *probe_list_str;
     guint32              i;
 
-    g_return_if_fail (MM_IS_PORT_PROBE (self));
-    g_return_if_fail (flags != MM_PORT_PROBE_NONE);
-    g_return_if_fail (callback != NULL);
-
-    /* Shouldn't schedule more than one probing at a time */
-    g_assert (self->priv->task == NULL);
-    self->priv->task = g_task_new (self, cancellable, callback, user_data);
-
-    /* Task context */
-    ctx = g_slice_new0 (PortProbeRunContext);
-    ctx->at_send_delay = at_send_delay;
-    ctx->at_remove_echo = at_remove_echo;
-    ctx->at_send_lf = at_send_lf;
-    ctx->flags = MM_PORT_PROBE_NONE;
-    ctx->at_custom_probe = at_custom_probe;
-    ctx->at_custom_init = at_custom_init ? (MMPortProbeAtCustomInit)at_custom_init->async : NULL;
-    ctx->at_custom_init_finish = at_custom_init ? (MMPortProbeAtCustomInitFinish)at_custom_init->finish : NULL;
-    ctx->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
-
-    /* The context will be owned by the task */
-    g_task_set_task_data (self->priv->task, ctx, (GDestroyNotify) port_probe_run_context_free);
-
-    /* If we're told to completely ignore the port, don't do any probing */
-    if (self->priv->is_ignored) {
-        mm_obj_dbg (self, "port probing finished: skipping for blacklisted port");
-        port_probe_task_return_boolean (self, TRUE);
-        return;
-    }
+    g_assert (self->priv->task);
+    ctx = g_task_get_task_data (self->priv->task);
 
     /* If this is a port flagged as a GPS port, don't do any other probing */
     if (self->priv->is_gps) {
@@ -1490,11 +1719,15 @@ mm_port_probe_run (MMPortProbe                *self,
         mm_port_probe_set_result_qmi  (self, FALSE);
     }
 
+    /* Any cached result dropped by now is already accounted for */
+    self->priv->cached_dropped = FALSE;
+
     /* Check if we already have the requested probing results.
      * We will fix here the 'ctx->flags' so that we only request probing
      * for the missing things. */
+    ctx->flags = MM_PORT_PROBE_NONE;
     for (i = MM_PORT_PROBE_AT; i <= MM_PORT_PROBE_MBIM; i = (i << 1)) {
-        if ((flags & i) && !(self->priv->flags & i))
+        if ((ctx->requested_flags & i) && !(self->priv->flags & i))
             ctx->flags += i;
     }
 
@@ -1516,13 +1749,15 @@ mm_port_probe_run (MMPortProbe                *self,
         ctx->flags & MM_PORT_PROBE_AT_PRODUCT ||
         ctx->flags & MM_PORT_PROBE_AT_ICERA ||
         ctx->flags & MM_PORT_PROBE_AT_XMM) {
-        ctx->at_probing_cancellable = g_cancellable_new ();
-        /* If the main cancellable is cancelled, so will be the at-probing one */
-        if (cancellable)
-            ctx->at_probing_cancellable_linked = g_cancellable_connect (cancellable,
-                                                                        (GCallback) at_cancellable_cancel,
-                                                                        ctx,
-                                                                        NULL);
+        if (!ctx->at_probing_cancellable) {
+            ctx->at_probing_cancellable = g_cancellable_new ();
+            /* If the main cancellable is cancelled, so will be the at-probing one */
+            if (ctx->cancellable)
+                ctx->at_probing_cancellable_linked = g_cancellable_connect (ctx->cancellable,
+                                                                            (GCallback) at_cancellable_cancel,
+                                                                            ctx,
+                                                                            NULL);
+        }
         ctx->source_id = g_idle_add ((GSourceFunc) serial_open_at, self);
         return;
     }
@@ -1543,6 +1778,87 @@ mm_port_probe_run (MMPortProbe                *self,
     g_assert_not_reached ();
 }
 
+/* The cached results were dropped while probing, so start over with all the
+ * requested probings still missing, as if nothing was cached */
+static void
+port_probe_run_restart (MMPortProbe *self)
+{
+    PortProbeRunContext *ctx;
+
+    g_assert (self->priv->task);
+    ctx = g_task_get_task_data (self->priv->task);
+
+    if (ctx->serial) {
+        if (ctx->buffer_full_id) {
+            g_signal_handler_disconnect (ctx->serial, ctx->buffer_full_id);
+            ctx->buffer_full_id = 0;
+        }
+        if (mm_port_serial_is_open (ctx->serial))
+            mm_port_serial_close (ctx->serial);
+        g_clear_object (&ctx->serial);
+    }
+    ctx->at_open_tries = 0;
+    ctx->at_custom_init_run = FALSE;
+
+#if defined WITH_QMI
+    g_clear_object (&ctx->port_qmi);
+#endif
+#if defined WITH_MBIM
+    g_clear_object (&ctx->mbim_port);
+#endif
+
+    port_probe_run_launch (self);
+}
+
+void
+mm_port_probe_run (MMPortProbe                *self,
+                   MMPortProbeFlag             flags,
+                   guint64                     at_send_delay,
+                   gboolean                    at_send_delay_adaptive,
+                   gboolean                    at_remove_echo,
+                   gboolean                    at_send_lf,
+                   const MMPortProbeAtCommand *at_custom_probe,
+                   const MMAsyncMethod        *at_custom_init,
+                   GCancellable               *cancellable,
+                   GAsyncReadyCallback         callback,
+                   gpointer                    user_data)
+{
+    PortProbeRunContext *ctx;
+
+    g_return_if_fail (MM_IS_PORT_PROBE (self));
+    g_return_if_fail (flags != MM_PORT_PROBE_NONE);
+    g_return_if_fail (callback != NULL);
+
+    /* Shouldn't schedule more than one probing at a time */
+    g_assert (self->priv->task == NULL);
+    self->priv->task = g_task_new (self, cancellable, callback, user_data);
+
+    /* Task context */
+    ctx = g_slice_new0 (PortProbeRunContext);
+    ctx->at_send_delay = at_send_delay;
+    ctx->at_send_delay_adaptive = at_send_delay_adaptive;
+    ctx->at_remove_echo = at_remove_echo;
+    ctx->at_send_lf = at_send_lf;
+    ctx->flags = MM_PORT_PROBE_NONE;
+    ctx->at_custom_probe = at_custom_probe;
+    ctx->at_custom_init = at_custom_init ? (MMPortProbeAtCustomInit)at_custom_init->async : NULL;
+    ctx->at_custom_init_finish = at_custom_init ? (MMPortProbeAtCustomInitFinish)at_custom_init->finish : NULL;
+    ctx->cancellable = cancellable ? g_object_ref (cancellable) : NULL;
+
+    /* The context will be owned by the task */
+    g_task_set_task_data (self->priv->task, ctx, (GDestroyNotify) port_probe_run_context_free);
+
+    /* If we're told to completely ignore the port, don't do any probing */
+    if (self->priv->is_ignored) {
+        mm_obj_dbg (self, "port probing finished: skipping for blacklisted port");
+        port_probe_task_return_boolean (self, TRUE);
+        return;
+    }
+
+    ctx->requested_flags = flags;
+    port_probe_run_launch (self);
+}
+
 gboolean
 mm_port_probe_is_at (MMPortProbe *self)
 {
@@ -109,10 +109,17 @@ void mm_port_probe_set_result_qmi        (MMPortProbe *self,
 void mm_port_probe_set_result_mbim       (MMPortProbe *self,
                                           gboolean mbim);
 
+/* Persistent cache of probing results. Loading the cached results is only
+ * possible before any probing is run; cached results of AT ports are only
+ * trusted once the AT probing confirms the port is still AT-capable. */
+gboolean mm_port_probe_load_cached_results  (MMPortProbe *self);
+void     mm_port_probe_store_cached_results (MMPortProbe *self);
+
 /* Run probing */
 void     mm_port_probe_run        (MMPortProbe *self,
                                    MMPortProbeFlag flags,
                                    guint64 at_send_delay,
+                                   gboolean at_send_delay_adaptive,
                                    gboolean at_remove_echo,
                                    gboolean at_send_lf,
                                    const MMPortProbeAtCommand *at_custom_probe,
@@ -22,6 +22,7 @@
 #include <string.h>
 
 #include "mm-port-serial-at.h"
+#include "mm-serial-parsers.h"
 #include "mm-log-object.h"
 
 G_DEFINE_TYPE (MMPortSerialAt, mm_port_serial_at, MM_TYPE_PORT_SERIAL)
@@ -40,8 +41,25 @@ struct _MMPortSerialAtPrivate {
     MMPortSerialAtResponseParserFn response_parser_fn;
     gpointer response_parser_user_data;
     GDestroyNotify response_parser_notify;
-
-    GSList *unsolicited_msg_handlers;
+    /* String given to the response parser, reused until a response is found */
+    GString *response_string;
+    /* Length of the response given to the parser when it didn't find one,
+     * and the generation of the response buffer at that time */
+    gsize response_unparsed_len;
+    guint response_unparsed_generation;
+
+    /* Stream handler, consuming partial responses as they arrive */
+    MMPortSerialAtStreamFn stream_fn;
+    gpointer stream_user_data;
+    GDestroyNotify stream_notify;
+
+    /* Unsolicited message handlers, in priority order, and the same handlers
+     * indexed by the tag of the line they apply to */
+    GSList     *unsolicited_msg_handlers;
+    GHashTable *unsolicited_msg_handlers_by_tag;
+    /* Reusable buffers used while dispatching unsolicited messages */
+    GArray     *unsolicited_line_starts;
+    GArray     *unsolicited_matches;
 
     MMPortSerialAtFlag flags;
 
@@ -94,88 +112,221 @@ mm_port_serial_at_set_response_parser (MMPortSerialAt *self,
     self->priv->response_parser_fn = fn;
     self->priv->response_parser_user_data = user_data;
     self->priv->response_parser_notify = notify;
+    self->priv->response_unparsed_len = 0;
 }
 
 void
-mm_port_serial_at_remove_echo (GByteArray *response)
+mm_port_serial_at_set_stream_handler (MMPortSerialAt *self,
+                                      MMPortSerialAtStreamFn fn,
+                                      gpointer user_data,
+                                      GDestroyNotify notify)
+{
+    g_return_if_fail (MM_IS_PORT_SERIAL_AT (self));
+
+    if (self->priv->stream_notify)
+        self->priv->stream_notify (self->priv->stream_user_data);
+
+    self->priv->stream_fn = fn;
+    self->priv->stream_user_data = user_data;
+    self->priv->stream_notify = notify;
+}
+
+static guint
+find_echo_len (MMSerialBuffer *response)
 {
     guint i;
 
     if (response->len <= 2)
-        return;
+        return 0;
 
     for (i = 0; i < (response->len - 1); i++) {
         /* If there is any content before the first
-         * <CR><LF>, assume it's echo or garbage, and skip it */
-        if (response->data[i] == '\r' && response->data[i + 1] == '\n') {
-            if (i > 0)
-                g_byte_array_remove_range (response, 0, i);
-            /* else, good, we're already started with <CR><LF> */
-            break;
-        }
+         * <CR><LF>, assume it's echo or garbage */
+        if (response->data[i] == '\r' && response->data[i + 1] == '\n')
+            return i;
+    }
+
+    return 0;
+}
+
+void
+mm_port_serial_at_remove_echo (MMSerialBuffer *response)
+{
+    guint echo_len;
+
+    echo_len = find_echo_len (response);
+    if (echo_len > 0)
+        mm_serial_buffer_consume (response, echo_len);
+}
+
+static void
+port_serial_at_remove_echo (MMPortSerialAt *self,
+                            MMSerialBuffer *response)
+{
+    guint echo_len;
+
+    echo_len = find_echo_len (response);
+    if (echo_len > 0) {
+        /* Let the generic port validate the echo before discarding it */
+        mm_port_serial_check_echo (MM_PORT_SERIAL (self), response->data, echo_len);
+        mm_serial_buffer_consume (response, echo_len);
     }
 }
 
 static MMPortSerialResponseType
 parse_response (MMPortSerial *port,
-                GByteArray *response,
+                MMSerialBuffer *response,
                 GByteArray **parsed_response,
                 GError **error)
 {
     MMPortSerialAt *self = MM_PORT_SERIAL_AT (port);
     GString *string;
     gsize parsed_len;
+    gsize response_len;
+    gsize unchanged_len = 0;
     GError *inner_error = NULL;
 
     g_return_val_if_fail (self->priv->response_parser_fn != NULL, FALSE);
 
     /* Remove echo */
     if (self->priv->remove_echo)
-        mm_port_serial_at_remove_echo (response);
+        port_serial_at_remove_echo (self, response);
 
     /* If there's no response to receive, we're done; e.g. if we only got
      * unsolicited messages */
     if (!response->len)
         return MM_PORT_SERIAL_RESPONSE_NONE;
 
-    /* Construct the string that AT-parsing functions expect */
-    string = g_string_sized_new (response->len + 1);
-    g_string_append_len (string, (const char *) response->data, response->len);
+    /* Let the stream handler process whatever complete records there are at
+     * the start of the response, so that they don't need to be kept around
+     * until the whole response is received */
+    if (self->priv->stream_fn) {
+        gsize consumed;
+
+        consumed = self->priv->stream_fn (self,
+                                          (const gchar *) response->data,
+                                          response->len,
+                                          self->priv->stream_user_data);
+        if (consumed > 0) {
+            g_assert (consumed <= response->len);
+            mm_serial_buffer_consume (response, consumed);
+            if (!response->len)
+                return MM_PORT_SERIAL_RESPONSE_NONE;
+        }
+    }
+
+    /* If several commands were sent at once, the buffer may contain the
+     * replies to more than one of them; only the first one is processed now.
+     * If the end of the reply cannot be found, e.g. because a custom response
+     * parser is in use, the whole buffer is given as usual. */
+    response_len = response->len;
+    if (mm_port_serial_get_n_commands_in_flight (port) > 1) {
+        gsize first_len;
+
+        first_len = mm_serial_parser_v1_find_response_end ((const gchar *) response->data, response->len);
+        if (first_len > 0)
+            response_len = first_len;
+    }
+
+    /* Construct the string that AT-parsing functions expect, reusing the
+     * one from the previous attempt if the response wasn't complete */
+    if (!self->priv->response_string)
+        self->priv->response_string = g_string_sized_new (MAX (response_len + 1, 256));
+    string = self->priv->response_string;
+    g_string_truncate (string, 0);
+    g_string_append_len (string, (const char *) response->data, response_len);
 
-    /* Fully cleanup the response array, we'll consider the contents we got
-     * as the full reply that the command may expect. */
-    g_byte_array_remove_range (response, 0, response->len);
+    /* If nothing was removed from the response buffer since the last attempt,
+     * the parser may skip what it already looked at back then */
+    if (self->priv->response_unparsed_len &&
+        self->priv->response_unparsed_generation == mm_serial_buffer_get_generation (response))
+        unchanged_len = MIN (self->priv->response_unparsed_len, response_len);
 
     /* Parse it; returns FALSE if there is nothing we can do with this
-     * response yet. */
-    if (!self->priv->response_parser_fn (self->priv->response_parser_user_data, string, self, &inner_error)) {
-        /* Copy what we got back in the response buffer. */
-        g_byte_array_append (response, (const guint8 *) string->str, string->len);
-        g_string_free (string, TRUE);
+     * response yet. Any change done by the parser in the string is discarded
+     * in that case, the response buffer is left untouched. */
+    if (!self->priv->response_parser_fn (self->priv->response_parser_user_data, string, unchanged_len, self, &inner_error)) {
+        self->priv->response_unparsed_len = response_len;
+        self->priv->response_unparsed_generation = mm_serial_buffer_get_generation (response);
         return MM_PORT_SERIAL_RESPONSE_NONE;
     }
+    self->priv->response_unparsed_len = 0;
+
+    /* Fully cleanup the response buffer, we'll consider the contents we got
+     * as the full reply that the command may expect; the replies to any other
+     * command already sent are kept. */
+    if (response_len < response->len)
+        mm_serial_buffer_consume (response, response_len);
+    else
+        mm_serial_buffer_clear (response);
 
     /* If we got an error, propagate it without any further response string */
     if (inner_error) {
-        g_string_free (string, TRUE);
         g_propagate_error (error, inner_error);
         return MM_PORT_SERIAL_RESPONSE_ERROR;
     }
 
-    /* Otherwise, build a new GByteArray considered as parsed response */
+    /* Otherwise, hand over the string as the parsed response; the string
+     * contents are NUL-terminated, so they can be given as they are to the
+     * caller of the AT command. */
+    self->priv->response_string = NULL;
     parsed_len = string->len;
     *parsed_response = g_byte_array_new_take ((guint8 *) g_string_free (string, FALSE), parsed_len);
     return MM_PORT_SERIAL_RESPONSE_BUFFER;
 }
 
+/* Commands after which the device may not accept further commands right away,
+ * e.g. because it switches to data mode, waits for input after a prompt, or
+ * resets itself; these are never sent along with other commands */
+static const gchar *no_pipelining_commands[] = {
+    "+CMGS", "+CMGW", "+CMGC", "+CGDATA", "+CFUN", "+CPWROFF",
+};
+
+static gboolean
+command_allows_pipelining (MMPortSerial     *port,
+                           const GByteArray *command)
+{
+    g_autofree gchar *str = NULL;
+    const gchar      *p;
+    guint             i;
+
+    /* Raw commands, e.g. SMS PDUs, are never pipelined */
+    if (command->len < 2 || g_ascii_strncasecmp ((const gchar *) command->data, "AT", 2) != 0)
+        return FALSE;
+
+    str = g_ascii_strup ((const gchar *) &command->data[2], command->len - 2);
+    for (p = str; *p == ' '; p++);
+
+    /* Dial, go online, answer, and reset to default configuration */
+    if (*p == 'D' || *p == 'O' || *p == 'A' || *p == 'Z' || g_str_has_prefix (p, "&F"))
+        return FALSE;
+
+    for (i = 0; i < G_N_ELEMENTS (no_pipelining_commands); i++) {
+        if (strstr (p, no_pipelining_commands[i]))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
 /*****************************************************************************/
 
+/* Maximum length of the tag used to index unsolicited message handlers */
+#define MAX_TAG_LEN 32
+
 typedef struct {
     GRegex *regex;
     MMPortSerialAtUnsolicitedMsgFn callback;
     gboolean enable;
     gpointer user_data;
     GDestroyNotify notify;
+    /* Literal text that must be found at the start of a line for the regex
+     * to match, and the tag (e.g. '+CREG') of that line, if known */
+    gchar *prefix;
+    gsize prefix_len;
+    gchar *tag;
+    /* Set while dispatching if a line with the handler tag was found */
+    gboolean tag_found;
 } MMAtUnsolicitedMsgHandler;
 
 static gint
@@ -186,6 +337,122 @@ unsolicited_msg_handler_cmp (MMAtUnsolicitedMsgHandler *handler,
                       g_regex_get_pattern (regex));
 }
 
+static gboolean
+is_tag_separator (gchar c)
+{
+    return (c == ':' || c == ' ' || c == '\r' || c == '\n');
+}
+
+static gboolean
+regex_has_top_level_alternation (const gchar *pattern)
+{
+    gint     depth = 0;
+    gboolean in_class = FALSE;
+
+    for (; *pattern; pattern++) {
+        if (*pattern == '\\') {
+            if (!*(++pattern))
+                break;
+            continue;
+        }
+        if (in_class) {
+            if (*pattern == ']')
+                in_class = FALSE;
+            continue;
+        }
+        switch (*pattern) {
+        case '[':
+            in_class = TRUE;
+            break;
+        case '(':
+            depth++;
+            break;
+        case ')':
+            depth--;
+            break;
+        case '|':
+            if (depth <= 0)
+                return TRUE;
+            break;
+        default:
+            break;
+        }
+    }
+    return FALSE;
+}
+
+/* Most URC regexes look like '\r\n\+CREG:...'; i.e. they require a given
+ * literal text right after a <CR><LF>. Find that literal text, if any, so
+ * that the regex is only run when there is a line starting with it. */
+static void
+unsolicited_msg_handler_setup_prefix (MMAtUnsolicitedMsgHandler *handler)
+{
+    const gchar *pattern;
+    GString     *prefix;
+    gboolean     cr_terminated = FALSE;
+
+    if (g_regex_get_compile_flags (handler->regex) & (G_REGEX_CASELESS | G_REGEX_EXTENDED))
+        return;
+
+    pattern = g_regex_get_pattern (handler->regex);
+    if (regex_has_top_level_alternation (pattern))
+        return;
+
+    if (g_str_has_prefix (pattern, "\\r\\n"))
+        pattern += 4;
+    else if (g_str_has_prefix (pattern, "\r\n"))
+        pattern += 2;
+    else
+        return;
+
+    prefix = g_string_new (NULL);
+    while (*pattern) {
+        if (*pattern == '\\') {
+            if (g_ascii_isalnum (pattern[1]) || !pattern[1]) {
+                /* An escape sequence like '\r' or '\d' ends the literal; if it
+                 * is a mandatory <CR>, the literal is a whole tag */
+                cr_terminated = (pattern[1] == 'r' && !strchr ("*?{", pattern[2]));
+                break;
+            }
+            g_string_append_c (prefix, pattern[1]);
+            pattern += 2;
+        } else if (strchr (".^$|()[]{}*+?", *pattern)) {
+            break;
+        } else if (*pattern == '\r' || *pattern == '\n') {
+            cr_terminated = (*pattern == '\r' && !strchr ("*?{", pattern[1]));
+            break;
+        } else {
+            g_string_append_c (prefix, *pattern);
+            pattern++;
+        }
+
+        /* A quantifier applies to the last literal char, drop it */
+        if (*pattern && strchr ("*+?{", *pattern)) {
+            g_string_truncate (prefix, prefix->len - 1);
+            cr_terminated = FALSE;
+            break;
+        }
+    }
+
+    if (!prefix->len) {
+        g_string_free (prefix, TRUE);
+        return;
+    }
+
+    handler->prefix_len = prefix->len;
+    handler->prefix = g_string_free (prefix, FALSE);
+
+    /* The tag is the text up to the first separator in the line, which we
+     * only know if the literal includes a separator or is a whole line */
+    if (strchr (handler->prefix, ':') || strchr (handler->prefix, ' ') || cr_terminated) {
+        gsize tag_len;
+
+        for (tag_len = 0; tag_len < handler->prefix_len && !is_tag_separator (handler->prefix[tag_len]); tag_len++);
+        if (tag_len > 0 && tag_len <= MAX_TAG_LEN)
+            handler->tag = g_strndup (handler->prefix, tag_len);
+    }
+}
+
 void
 mm_port_serial_at_add_unsolicited_msg_handler (MMPortSerialAt *self,
                                                GRegex *regex,
@@ -211,9 +478,21 @@ mm_port_serial_at_add_unsolicited_msg_handler (MMPortSerialAt *self,
         /* The new handler is always PREPENDED, so that e.g. plugins can provide
          * more specific matches for URCs that are also handled by the generic
          * plugin. */
-        handler = g_slice_new (MMAtUnsolicitedMsgHandler);
+        handler = g_slice_new0 (MMAtUnsolicitedMsgHandler);
         handler->regex = g_regex_ref (regex);
         self->priv->unsolicited_msg_handlers = g_slist_prepend (self->priv->unsolicited_msg_handlers, handler);
+
+        unsolicited_msg_handler_setup_prefix (handler);
+        if (handler->tag) {
+            GPtrArray *tagged;
+
+            tagged = g_hash_table_lookup (self->priv->unsolicited_msg_handlers_by_tag, handler->tag);
+            if (!tagged) {
+                tagged = g_ptr_array_new ();
+                g_hash_table_insert (self->priv->unsolicited_msg_handlers_by_tag, g_strdup (handler->tag), tagged);
+            }
+            g_ptr_array_add (tagged, handler);
+        }
     }
 
     handler->callback = callback;
@@ -242,66 +521,153 @@ mm_port_serial_at_enable_unsolicited_msg_handler (MMPortSerialAt *self,
     }
 }
 
+/* Split the response in lines once, and flag the handlers whose tag is found
+ * at the start of any of them. */
+static void
+index_unsolicited_lines (MMPortSerialAt *self,
+                         MMSerialBuffer *response)
+{
+    GSList *iter;
+    guint   i;
+
+    for (iter = self->priv->unsolicited_msg_handlers; iter; iter = g_slist_next (iter))
+        ((MMAtUnsolicitedMsgHandler *) iter->data)->tag_found = FALSE;
+
+    g_array_set_size (self->priv->unsolicited_line_starts, 0);
+    for (i = 1; i < response->len; i++) {
+        GPtrArray *tagged;
+        gchar      tag[MAX_TAG_LEN + 1];
+        guint      tag_len;
+        guint      j;
+
+        if (response->data[i] != '\n' || response->data[i - 1] != '\r')
+            continue;
+
+        g_array_append_val (self->priv->unsolicited_line_starts, i);
+
+        for (tag_len = 0;
+             tag_len <= MAX_TAG_LEN && (i + 1 + tag_len) < response->len && !is_tag_separator (response->data[i + 1 + tag_len]);
+             tag_len++);
+        if (!tag_len || tag_len > MAX_TAG_LEN)
+            continue;
+
+        memcpy (tag, &response->data[i + 1], tag_len);
+        tag[tag_len] = '\0';
+        tagged = g_hash_table_lookup (self->priv->unsolicited_msg_handlers_by_tag, tag);
+        if (!tagged)
+            continue;
+
+        for (j = 0; j < tagged->len; j++)
+            ((MMAtUnsolicitedMsgHandler *) g_ptr_array_index (tagged, j))->tag_found = TRUE;
+    }
+}
+
 static gboolean
-remove_eval_cb (const GMatchInfo *match_info,
-                GString *result,
-                gpointer user_data)
+unsolicited_msg_handler_may_match (MMPortSerialAt            *self,
+                                   MMAtUnsolicitedMsgHandler *handler,
+                                   MMSerialBuffer            *response)
 {
-    int *result_len = (int *) user_data;
-    int start;
-    int end;
+    guint i;
+
+    if (handler->tag)
+        return handler->tag_found;
 
-    if (g_match_info_fetch_pos  (match_info, 0, &start, &end))
-        *result_len -= (end - start);
+    if (!handler->prefix)
+        return TRUE;
 
+    /* Line starts point to the <LF> of the <CR><LF> preceding the line */
+    for (i = 0; i < self->priv->unsolicited_line_starts->len; i++) {
+        guint start;
+
+        start = g_array_index (self->priv->unsolicited_line_starts, guint, i) + 1;
+        if ((response->len - start) >= handler->prefix_len &&
+            !memcmp (&response->data[start], handler->prefix, handler->prefix_len))
+            return TRUE;
+    }
     return FALSE;
 }
 
+typedef struct {
+    gint start;
+    gint end;
+} UnsolicitedMatch;
+
+/* Remove the matched ranges from the response, without reallocating */
 static void
-parse_unsolicited (MMPortSerial *port, GByteArray *response)
+remove_unsolicited_matches (MMSerialBuffer *response,
+                            GArray         *matches)
+{
+    guint r = 0;
+    guint w = 0;
+    guint i;
+
+    for (i = 0; i < matches->len; i++) {
+        UnsolicitedMatch *match;
+
+        match = &g_array_index (matches, UnsolicitedMatch, i);
+        if ((guint) match->start < r)
+            continue;
+        if (w != r)
+            memmove (&response->data[w], &response->data[r], match->start - r);
+        w += match->start - r;
+        r = match->end;
+    }
+
+    if (w != r)
+        memmove (&response->data[w], &response->data[r], response->len - r);
+    w += response->len - r;
+    mm_serial_buffer_truncate (response, w);
+}
+
+static void
+parse_unsolicited (MMPortSerial *port, MMSerialBuffer *response)
 {
     MMPortSerialAt *self = MM_PORT_SERIAL_AT (port);
     GSList *iter;
 
     /* Remove echo */
     if (self->priv->remove_echo)
-        mm_port_serial_at_remove_echo (response);
+        port_serial_at_remove_echo (self, response);
+
+    if (!self->priv->unsolicited_msg_handlers || !response->len)
+        return;
+
+    index_unsolicited_lines (self, response);
 
     for (iter = self->priv->unsolicited_msg_handlers; iter; iter = iter->next) {
         MMAtUnsolicitedMsgHandler *handler = (MMAtUnsolicitedMsgHandler *) iter->data;
         GMatchInfo *match_info;
-        gboolean matches;
 
         if (!handler->enable)
             continue;
 
-        matches = g_regex_match_full (handler->regex,
-                                      (const char *) response->data,
-                                      response->len,
-                                      0, 0, &match_info, NULL);
-        if (handler->callback) {
-            while (g_match_info_matches (match_info)) {
+        if (!unsolicited_msg_handler_may_match (self, handler, response))
+            continue;
+
+        g_regex_match_full (handler->regex,
+                            (const char *) response->data,
+                            response->len,
+                            0, 0, &match_info, NULL);
+
+        g_array_set_size (self->priv->unsolicited_matches, 0);
+        while (g_match_info_matches (match_info)) {
+            UnsolicitedMatch match;
+
+            if (handler->callback)
                 handler->callback (self, match_info, handler->user_data);
-                g_match_info_next (match_info, NULL);
-            }
+            if (g_match_info_fetch_pos (match_info, 0, &match.start, &match.end) && match.end > match.start)
+                g_array_append_val (self->priv->unsolicited_matches, match);
+            g_match_info_next (match_info, NULL);
         }
 
         g_match_info_free (match_info);
 
-        if (matches) {
-            /* Remove matches */
-            char *str;
-            int result_len = response->len;
-
-            str = g_regex_replace_eval (handler->regex,
-                                        (const char *) response->data,
-                                        response->len,
-                                        0, 0,
-                                        remove_eval_cb, &result_len, NULL);
-
-            g_byte_array_remove_range (response, 0, response->len);
-            g_byte_array_append (response, (const guint8 *) str, result_len);
-            g_free (str);
+        /* Remove matches, and re-index the lines of what's left */
+        if (self->priv->unsolicited_matches->len > 0) {
+            remove_unsolicited_matches (response, self->priv->unsolicited_matches);
+            if (!response->len)
+                break;
+            index_unsolicited_lines (self, response);
         }
     }
 }
@@ -343,24 +709,31 @@ at_command_to_byte_array (const char *command, gboolean is_raw, gboolean send_lf
     return buf;
 }
 
+static GByteArray *
+port_serial_at_command_to_byte_array (MMPortSerialAt *self,
+                                      const gchar    *command,
+                                      gboolean        is_raw)
+{
+    return at_command_to_byte_array (command,
+                                     is_raw,
+                                     (mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY ?
+                                      self->priv->send_lf :
+                                      TRUE));
+}
+
 const gchar *
 mm_port_serial_at_command_finish (MMPortSerialAt *self,
                                   GAsyncResult *res,
                                   GError **error)
 {
-    GString *str;
+    GByteArray *response;
 
     if (g_simple_async_result_propagate_error (G_SIMPLE_ASYNC_RESULT (res), error))
         return NULL;
 
-    str = (GString *)g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res));
-    return str->str;
-}
-
-static void
-string_free (GString *str)
-{
-    g_string_free (str, TRUE);
+    /* The parsed response is always NUL-terminated, see parse_response() */
+    response = (GByteArray *)g_simple_async_result_get_op_res_gpointer (G_SIMPLE_ASYNC_RESULT (res));
+    return (const gchar *) response->data;
 }
 
 static void
@@ -368,28 +741,21 @@ serial_command_ready (MMPortSerial *port,
                       GAsyncResult *res,
                       GSimpleAsyncResult *simple)
 {
-    GByteArray *response_buffer;
+    GByteArray *response;
     GError *error = NULL;
-    GString *response;
 
-    response_buffer = mm_port_serial_command_finish (port, res, &error);
-    if (!response_buffer) {
+    response = mm_port_serial_command_finish (port, res, &error);
+    if (!response) {
         g_simple_async_result_take_error (simple, error);
         g_simple_async_result_complete (simple);
         g_object_unref (simple);
         return;
     }
 
-    /* Build a GString just with the response we need, and clear the
-     * processed range from the response buffer */
-    response = g_string_new_len ((const gchar *)response_buffer->data, response_buffer->len);
-    if (response_buffer->len > 0)
-        g_byte_array_remove_range (response_buffer, 0, response_buffer->len);
-    g_byte_array_unref (response_buffer);
-
+    /* The parsed response is given as is to the caller, no copy needed */
     g_simple_async_result_set_op_res_gpointer (simple,
                                                response,
-                                               (GDestroyNotify)string_free);
+                                               (GDestroyNotify)g_byte_array_unref);
     g_simple_async_result_complete (simple);
     g_object_unref (simple);
 }
@@ -397,7 +763,7 @@ serial_command_ready (MMPortSerial *port,
 void
 mm_port_serial_at_command (MMPortSerialAt *self,
                            const char *command,
-                           guint32 timeout_seconds,
+                           guint32 timeout_ms,
                            gboolean is_raw,
                            gboolean allow_cached,
                            GCancellable *cancellable,
@@ -411,11 +777,7 @@ mm_port_serial_at_command (MMPortSerialAt *self,
     g_return_if_fail (MM_IS_PORT_SERIAL_AT (self));
     g_return_if_fail (command != NULL);
 
-    buf = at_command_to_byte_array (command,
-                                    is_raw,
-                                    (mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY ?
-                                     self->priv->send_lf :
-                                     TRUE));
+    buf = port_serial_at_command_to_byte_array (self, command, is_raw);
     g_return_if_fail (buf != NULL);
 
     simple = g_simple_async_result_new (G_OBJECT (self),
@@ -425,7 +787,7 @@ mm_port_serial_at_command (MMPortSerialAt *self,
 
     mm_port_serial_command (MM_PORT_SERIAL (self),
                             buf,
-                            timeout_seconds,
+                            timeout_ms,
                             allow_cached,
                             is_raw, /* raw commands always run next, never queued last */
                             cancellable,
@@ -434,6 +796,25 @@ mm_port_serial_at_command (MMPortSerialAt *self,
     g_byte_array_unref (buf);
 }
 
+void
+mm_port_serial_at_set_cached_reply (MMPortSerialAt *self,
+                                    const gchar    *command,
+                                    const gchar    *response)
+{
+    g_autoptr(GByteArray) buf = NULL;
+    g_autoptr(GByteArray) reply = NULL;
+
+    g_return_if_fail (MM_IS_PORT_SERIAL_AT (self));
+    g_return_if_fail (command != NULL);
+    g_return_if_fail (response != NULL);
+
+    buf = port_serial_at_command_to_byte_array (self, command, FALSE);
+
+    /* Parsed responses are always NUL-terminated, see parse_response() */
+    reply = g_byte_array_new_take ((guint8 *) g_strdup (response), strlen (response));
+    mm_port_serial_set_cached_reply (MM_PORT_SERIAL (self), buf, reply);
+}
+
 static void
 debug_log (MMPortSerial *self,
            const gchar  *prefix,
@@ -508,7 +889,7 @@ mm_port_serial_at_run_init_sequence (MMPortSerialAt *self)
     for (i = 0; self->priv->init_sequence[i]; i++) {
         mm_port_serial_at_command (self,
                                    self->priv->init_sequence[i],
-                                   3,
+                                   3000,
                                    FALSE,
                                    FALSE,
                                    NULL,
@@ -551,6 +932,13 @@ mm_port_serial_at_init (MMPortSerialAt *self)
 
     /* By default, don't send line feed */
     self->priv->send_lf = FALSE;
+
+    self->priv->unsolicited_msg_handlers_by_tag = g_hash_table_new_full (g_str_hash,
+                                                                          g_str_equal,
+                                                                          g_free,
+                                                                          (GDestroyNotify) g_ptr_array_unref);
+    self->priv->unsolicited_line_starts = g_array_new (FALSE, FALSE, sizeof (guint));
+    self->priv->unsolicited_matches = g_array_new (FALSE, FALSE, sizeof (UnsolicitedMatch));
 }
 
 static void
@@ -620,6 +1008,8 @@ finalize (GObject *object)
             handler->notify (handler->user_data);
 
         g_regex_unref (handler->regex);
+        g_free (handler->prefix);
+        g_free (handler->tag);
         g_slice_free (MMAtUnsolicitedMsgHandler, handler);
         self->priv->unsolicited_msg_handlers = g_slist_delete_link (self->priv->unsolicited_msg_handlers,
                                                                     self->priv->unsolicited_msg_handlers);
@@ -628,6 +1018,16 @@ finalize (GObject *object)
     if (self->priv->response_parser_notify)
         self->priv->response_parser_notify (self->priv->response_parser_user_data);
 
+    if (self->priv->stream_notify)
+        self->priv->stream_notify (self->priv->stream_user_data);
+
+    if (self->priv->response_string)
+        g_string_free (self->priv->response_string, TRUE);
+
+    g_hash_table_unref (self->priv->unsolicited_msg_handlers_by_tag);
+    g_array_unref (self->priv->unsolicited_line_starts);
+    g_array_unref (self->priv->unsolicited_matches);
+
     g_strfreev (self->priv->init_sequence);
 
     G_OBJECT_CLASS (mm_port_serial_at_parent_class)->finalize (object);
@@ -648,6 +1048,7 @@ mm_port_serial_at_class_init (MMPortSerialAtClass *klass)
 
     serial_class->parse_unsolicited = parse_unsolicited;
     serial_class->parse_response = parse_response;
+    serial_class->command_allows_pipelining = command_allows_pipelining;
     serial_class->debug_log = debug_log;
     serial_class->config = config;
 
@@ -56,8 +56,11 @@ typedef enum { /*< underscore_name=mm_port_serial_at_flag >*/
     MM_PORT_SERIAL_AT_FLAG_NONE_NO_GENERIC = 1 << 4,
 } MMPortSerialAtFlag;
 
+/* 'unchanged_len' is the amount of bytes at the start of the response which
+ * are the same as in the previous call, if that one didn't find a response */
 typedef gboolean (*MMPortSerialAtResponseParserFn) (gpointer   user_data,
                                                     GString   *response,
+                                                    gsize      unchanged_len,
                                                     gpointer   log_object,
                                                     GError   **error);
 
@@ -65,6 +68,14 @@ typedef void (*MMPortSerialAtUnsolicitedMsgFn) (MMPortSerialAt *port,
                                                 GMatchInfo *match_info,
                                                 gpointer user_data);
 
+/* Called with the pending response data every time new data arrives, before
+ * looking for the end of the response; returns the number of bytes consumed
+ * from the start of the data, if any. */
+typedef gsize (*MMPortSerialAtStreamFn) (MMPortSerialAt *port,
+                                         const gchar    *data,
+                                         gsize           len,
+                                         gpointer        user_data);
+
 #define MM_PORT_SERIAL_AT_REMOVE_ECHO           "remove-echo"
 #define MM_PORT_SERIAL_AT_INIT_SEQUENCE_ENABLED "init-sequence-enabled"
 #define MM_PORT_SERIAL_AT_INIT_SEQUENCE         "init-sequence"
@@ -95,6 +106,13 @@ void     mm_port_serial_at_enable_unsolicited_msg_handler (MMPortSerialAt *self,
                                                            GRegex *regex,
                                                            gboolean enable);
 
+/* Only one stream handler may be set at a time; the caller must unset it once
+ * the command it was set for is finished */
+void     mm_port_serial_at_set_stream_handler (MMPortSerialAt *self,
+                                               MMPortSerialAtStreamFn fn,
+                                               gpointer user_data,
+                                               GDestroyNotify notify);
+
 void     mm_port_serial_at_set_response_parser (MMPortSerialAt *self,
                                                 MMPortSerialAtResponseParserFn fn,
                                                 gpointer user_data,
@@ -102,7 +120,7 @@ void     mm_port_serial_at_set_response_parser (MMPortSerialAt *self,
 
 void         mm_port_serial_at_command        (MMPortSerialAt *self,
                                                const char *command,
-                                               guint32 timeout_seconds,
+                                               guint32 timeout_ms,
                                                gboolean is_raw,
                                                gboolean allow_cached,
                                                GCancellable *cancellable,
@@ -112,6 +130,12 @@ const gchar *mm_port_serial_at_command_finish (MMPortSerialAt *self,
                                                GAsyncResult *res,
                                                GError **error);
 
+/* Store the reply to a command in the cache, so that running the command
+ * allowing cached replies returns it without sending the command again */
+void         mm_port_serial_at_set_cached_reply (MMPortSerialAt *self,
+                                                 const gchar    *command,
+                                                 const gchar    *response);
+
 /*
  * Convert a string into a quoted and escaped string. Returns a new
  * allocated string. Follows ITU V.250 5.4.2.2 "String constants".
@@ -119,7 +143,7 @@ const gchar *mm_port_serial_at_command_finish (MMPortSerialAt *self,
 gchar   *mm_port_serial_at_quote_string (const char *string);
 
 /* Just for unit tests */
-void     mm_port_serial_at_remove_echo (GByteArray *response);
+void     mm_port_serial_at_remove_echo (MMSerialBuffer *response);
 
 void     mm_port_serial_at_set_flags (MMPortSerialAt *self,
                                       MMPortSerialAtFlag flags);
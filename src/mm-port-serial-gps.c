@@ -20,6 +20,7 @@
 
 #include "mm-port-serial-gps.h"
 #include "mm-log-object.h"
+#include "mm-regex-registry.h"
 
 G_DEFINE_TYPE (MMPortSerialGps, mm_port_serial_gps, MM_TYPE_PORT_SERIAL)
 
@@ -70,7 +71,7 @@ remove_eval_cb (const GMatchInfo *match_info,
 
 static MMPortSerialResponseType
 parse_response (MMPortSerial *port,
-                GByteArray *response,
+                MMSerialBuffer *response,
                 GByteArray **parsed_response,
                 GError **error)
 {
@@ -86,16 +87,16 @@ parse_response (MMPortSerial *port,
          * assume it's garbage, and skip it */
         if (response->data[i] == '$') {
             if (i > 0)
-                g_byte_array_remove_range (response, 0, i);
+                mm_serial_buffer_consume (response, i);
             /* else, good, we're already started with $ */
             break;
         }
     }
 
-    matches = g_regex_match_full (self->priv->known_traces_regex,
-                                  (const gchar *) response->data,
-                                  response->len,
-                                  0, 0, &match_info, NULL);
+    matches = mm_regex_match_full (self->priv->known_traces_regex,
+                                   (const gchar *) response->data,
+                                   response->len,
+                                   0, 0, &match_info, NULL);
 
     if (self->priv->callback) {
         while (g_match_info_matches (match_info)) {
@@ -124,7 +125,7 @@ parse_response (MMPortSerial *port,
                                 remove_eval_cb, &result_len, NULL);
 
     /* Cleanup response buffer */
-    g_byte_array_remove_range (response, 0, response->len);
+    mm_serial_buffer_clear (response);
 
     /* Build parsed response */
     *parsed_response = g_byte_array_new_take ((guint8 *)str, result_len);
@@ -189,10 +190,8 @@ mm_port_serial_gps_init (MMPortSerialGps *self)
 
     /* We'll assume that all traces start with the dollar sign and end with \r\n */
     self->priv->known_traces_regex =
-        g_regex_new ("\\$.*\\r\\n",
-                     G_REGEX_RAW | G_REGEX_OPTIMIZE,
-                     0,
-                     NULL);
+        mm_regex_get ("\\$.*\\r\\n",
+                      G_REGEX_RAW | G_REGEX_OPTIMIZE);
 }
 
 static void
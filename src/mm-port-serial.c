@@ -25,6 +25,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <string.h>
 #include <linux/serial.h>
 
@@ -34,6 +35,8 @@
 #include <mm-errors-types.h>
 
 #include "mm-port-serial.h"
+#include "mm-timer-wheel.h"
+#include "mm-serial-capture.h"
 #include "mm-log-object.h"
 #include "mm-helper-enums-types.h"
 
@@ -44,7 +47,9 @@ static void     port_serial_close_force            (MMPortSerial *self);
 static void     port_serial_reopen_cancel          (MMPortSerial *self);
 static void     port_serial_set_cached_reply       (MMPortSerial *self,
                                                     const GByteArray *command,
-                                                    const GByteArray *response);
+                                                    GByteArray *response);
+static GByteArray *port_serial_get_cached_reply    (MMPortSerial *self,
+                                                    GByteArray *command);
 
 G_DEFINE_TYPE (MMPortSerial, mm_port_serial, MM_TYPE_PORT)
 
@@ -56,6 +61,8 @@ enum {
     PROP_STOPBITS,
     PROP_FLOW_CONTROL,
     PROP_SEND_DELAY,
+    PROP_SEND_DELAY_ADAPTIVE,
+    PROP_PIPELINE,
     PROP_FD,
     PROP_SPEW_CONTROL,
     PROP_FLASH_OK,
@@ -75,13 +82,24 @@ static guint signals[LAST_SIGNAL] = { 0 };
 
 #define SERIAL_BUF_SIZE 2048
 
+/* Maximum number of commands sent at once in pipelined mode */
+#define PIPELINE_MAX_COMMANDS 8
+
+/* Consecutive timeouts of commands sent in a single write after which bytes
+ * are considered lost, in adaptive send delay mode */
+#define MAX_UNPACED_TIMEOUTS 2
+
+/* Consecutive mismatched echoes of commands sent in a single write after
+ * which bytes are considered lost, in adaptive send delay mode */
+#define MAX_ECHO_MISMATCHES 2
+
 struct _MMPortSerialPrivate {
     guint32 open_count;
     gboolean forced_close;
     int fd;
     GHashTable *reply_cache;
     GQueue *queue;
-    GByteArray *response;
+    MMSerialBuffer *response;
 
     /* For real ports, iochannel, and we implement the eagain limit */
     GIOChannel *iochannel;
@@ -98,21 +116,33 @@ struct _MMPortSerialPrivate {
     guint stopbits;
     MMFlowControl flow_control;
     guint64 send_delay;
+    gboolean send_delay_adaptive;
+    gboolean pipeline;
     gboolean spew_control;
     gboolean flash_ok;
 
     guint queue_id;
+    guint send_id;
     guint timeout_id;
 
     GCancellable *cancellable;
     gulong cancellable_id;
 
     guint n_consecutive_timeouts;
+    /* Consecutive timeouts of commands sent in a single write */
+    guint n_unpaced_timeouts;
+    /* Consecutive mismatched echoes of commands sent in a single write */
+    guint n_echo_mismatches;
+
+    MMPortSerialSendStats send_stats;
 
     guint connected_id;
 
     GTask *flash_task;
     GTask *reopen_task;
+
+    /* Binary capture of the traffic, if enabled for this port */
+    MMSerialCapture *capture;
 };
 
 /*****************************************************************************/
@@ -123,15 +153,42 @@ typedef struct {
     GSimpleAsyncResult *result;
     GCancellable *cancellable;
     GByteArray *command;
-    guint32 timeout;
+    guint32 timeout_ms;
     gboolean allow_cached;
     guint32 eagain_count;
 
     guint32 idx;
     gboolean started;
     gboolean done;
+    gboolean paced;
+    gboolean echo_checked;
+    gint64 send_start;
 } CommandContext;
 
+static gboolean
+port_serial_send_delay_applies (MMPortSerial *self)
+{
+    return (self->priv->send_delay && mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY);
+}
+
+static gboolean
+port_serial_send_paced (MMPortSerial *self)
+{
+    if (!port_serial_send_delay_applies (self))
+        return FALSE;
+
+    /* In adaptive mode, only pace once some bytes were found lost */
+    return (!self->priv->send_delay_adaptive || self->priv->send_stats.n_send_losses > 0);
+}
+
+static void
+port_serial_send_lost (MMPortSerial *self,
+                       const gchar  *reason)
+{
+    if (self->priv->send_stats.n_send_losses++ == 0)
+        mm_obj_dbg (self, "%s: sending commands with per-byte pacing from now on", reason);
+}
+
 static void
 command_context_complete_and_free (CommandContext *ctx, gboolean idle)
 {
@@ -147,6 +204,81 @@ command_context_complete_and_free (CommandContext *ctx, gboolean idle)
     g_slice_free (CommandContext, ctx);
 }
 
+void
+mm_port_serial_check_echo (MMPortSerial *self,
+                           const guint8 *echo,
+                           gsize         echo_len)
+{
+    CommandContext *ctx;
+    gsize           command_len;
+
+    g_return_if_fail (MM_IS_PORT_SERIAL (self));
+
+    if (!self->priv->send_delay_adaptive || !port_serial_send_delay_applies (self))
+        return;
+
+    /* Only for commands fully sent in a single write, and just once. When
+     * several commands were sent at once, the echoes may come mixed. */
+    ctx = (CommandContext *) g_queue_peek_head (self->priv->queue);
+    if (!ctx || !ctx->done || ctx->paced || ctx->echo_checked)
+        return;
+    if (mm_port_serial_get_n_commands_in_flight (self) > 1)
+        return;
+    ctx->echo_checked = TRUE;
+
+    /* Line terminators are not compared */
+    command_len = ctx->command->len;
+    while (command_len > 0 && (ctx->command->data[command_len - 1] == '\r' || ctx->command->data[command_len - 1] == '\n'))
+        command_len--;
+    while (echo_len > 0 && (echo[echo_len - 1] == '\r' || echo[echo_len - 1] == '\n'))
+        echo_len--;
+
+    if (echo_len == command_len && memcmp (echo, ctx->command->data, echo_len) == 0) {
+        self->priv->send_stats.n_echoes_verified++;
+        self->priv->n_echo_mismatches = 0;
+        return;
+    }
+
+    /* A single mismatch may just be some unsolicited message received in the
+     * middle of the echo, so only consecutive ones are taken as a loss */
+    if (++self->priv->n_echo_mismatches < MAX_ECHO_MISMATCHES) {
+        mm_obj_dbg (self, "command echo doesn't match");
+        return;
+    }
+    self->priv->n_echo_mismatches = 0;
+    port_serial_send_lost (self, "command echoes don't match");
+}
+
+void
+mm_port_serial_get_send_stats (MMPortSerial          *self,
+                               MMPortSerialSendStats *stats)
+{
+    g_return_if_fail (MM_IS_PORT_SERIAL (self));
+    g_return_if_fail (stats != NULL);
+
+    *stats = self->priv->send_stats;
+    stats->paced = port_serial_send_paced (self);
+}
+
+guint
+mm_port_serial_get_n_commands_in_flight (MMPortSerial *self)
+{
+    GList *l;
+    guint  n = 0;
+
+    g_return_val_if_fail (MM_IS_PORT_SERIAL (self), 0);
+
+    /* Sent commands are always at the head of the queue */
+    for (l = self->priv->queue->head; l; l = g_list_next (l)) {
+        CommandContext *ctx = l->data;
+
+        if (!ctx->done)
+            break;
+        n++;
+    }
+    return n;
+}
+
 GByteArray *
 mm_port_serial_command_finish (MMPortSerial *self,
                                GAsyncResult *res,
@@ -161,7 +293,7 @@ mm_port_serial_command_finish (MMPortSerial *self,
 void
 mm_port_serial_command (MMPortSerial *self,
                         GByteArray *command,
-                        guint32 timeout_seconds,
+                        guint32 timeout_ms,
                         gboolean allow_cached,
                         gboolean run_next,
                         GCancellable *cancellable,
@@ -182,11 +314,11 @@ mm_port_serial_command (MMPortSerial *self,
                                              mm_port_serial_command);
     ctx->command = g_byte_array_ref (command);
     ctx->allow_cached = allow_cached;
-    ctx->timeout = timeout_seconds;
+    ctx->timeout_ms = timeout_ms;
     ctx->cancellable = (cancellable ? g_object_ref (cancellable) : NULL);
 
     /* Only accept about 3 seconds of EAGAIN for this command */
-    if (self->priv->send_delay && mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY)
+    if (port_serial_send_paced (self))
         ctx->eagain_count = 3000000 / self->priv->send_delay;
     else
         ctx->eagain_count = 1000;
@@ -205,10 +337,14 @@ mm_port_serial_command (MMPortSerial *self,
         port_serial_set_cached_reply (self, ctx->command, NULL);
 
     /* If requested to run next, push to the head of the queue so that it really is
-     * the next one sent */
-    if (run_next)
-        g_queue_push_head (self->priv->queue, ctx);
-    else
+     * the next one sent; but after all the commands already sent in pipelined
+     * mode, as their replies are expected first */
+    if (run_next) {
+        guint n_in_flight;
+
+        n_in_flight = mm_port_serial_get_n_commands_in_flight (self);
+        g_queue_push_nth (self->priv->queue, ctx, n_in_flight > 1 ? (gint) n_in_flight : 0);
+    } else
         g_queue_push_tail (self->priv->queue, ctx);
 
     if (g_queue_get_length (self->priv->queue) == 1)
@@ -532,19 +668,29 @@ serial_debug (MMPortSerial *self,
 {
     g_return_if_fail (len > 0);
 
+    /* Building the traces is expensive, skip it altogether if not logged */
+    if (!mm_obj_check_enabled (self, MM_LOG_LEVEL_DEBUG))
+        return;
+
     if (MM_PORT_SERIAL_GET_CLASS (self)->debug_log)
         MM_PORT_SERIAL_GET_CLASS (self)->debug_log (self, prefix, buf, len);
 }
 
-static gboolean
-port_serial_process_command (MMPortSerial *self,
-                             CommandContext *ctx,
-                             GError **error)
+static void
+serial_capture (MMPortSerial             *self,
+                MMSerialCaptureDirection  direction,
+                const gchar              *buf,
+                gsize                     len)
 {
-    const gchar *p;
-    gsize written;
-    gssize send_len;
+    /* Captured regardless of the log level */
+    if (self->priv->capture)
+        mm_serial_capture_append (self->priv->capture, direction, (const guint8 *) buf, len);
+}
 
+static gboolean
+port_serial_check_can_send (MMPortSerial  *self,
+                            GError       **error)
+{
     if (self->priv->iochannel == NULL && self->priv->socket == NULL) {
         g_set_error_literal (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_SEND_FAILED,
                              "Sending command failed: device is not enabled");
@@ -557,16 +703,80 @@ port_serial_process_command (MMPortSerial *self,
         return FALSE;
     }
 
+    return TRUE;
+}
+
+static void
+port_serial_command_start (MMPortSerial   *self,
+                           CommandContext *ctx)
+{
     /* Only print command the first time */
-    if (ctx->started == FALSE) {
-        ctx->started = TRUE;
-        serial_debug (self, "-->", (const gchar *) ctx->command->data, ctx->command->len);
+    if (ctx->started)
+        return;
+
+    ctx->started = TRUE;
+    ctx->paced = port_serial_send_paced (self);
+    ctx->send_start = g_get_monotonic_time ();
+    serial_debug (self, "-->", (const gchar *) ctx->command->data, ctx->command->len);
+    serial_capture (self, MM_SERIAL_CAPTURE_DIRECTION_WRITE, (const gchar *) ctx->command->data, ctx->command->len);
+}
+
+static void
+port_serial_command_sent (MMPortSerial   *self,
+                          CommandContext *ctx,
+                          gsize           written)
+{
+    ctx->idx += written;
+    if (ctx->idx < ctx->command->len)
+        return;
+
+    ctx->done = TRUE;
+    if (ctx->paced) {
+        self->priv->send_stats.n_paced_commands++;
+        self->priv->send_stats.pacing_time_ms += (g_get_monotonic_time () - ctx->send_start) / 1000;
+    } else
+        self->priv->send_stats.n_unpaced_commands++;
+}
+
+static gboolean
+port_serial_command_send_again (MMPortSerial    *self,
+                                CommandContext  *ctx,
+                                GError         **error)
+{
+    /* We're in a non-blocking channel or socket and therefore we're up to
+     * receive EAGAIN; just retry in this case. */
+    ctx->eagain_count--;
+    if (ctx->eagain_count <= 0) {
+        /* If we reach the limit of EAGAIN errors, treat as a timeout error. */
+        self->priv->n_consecutive_timeouts++;
+        g_signal_emit (self, signals[TIMED_OUT], 0, self->priv->n_consecutive_timeouts);
+        g_set_error (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_SEND_FAILED,
+                     "Sending command failed: '%s'", g_strerror (errno));
+        return FALSE;
     }
 
-    if (self->priv->send_delay == 0 || mm_port_get_subsys (MM_PORT (self)) != MM_PORT_SUBSYS_TTY) {
-        /* Send the whole command in one write */
-        send_len = (gssize)ctx->command->len;
-        p = (gchar *)ctx->command->data;
+    /* Just keep on, will retry... */
+    return TRUE;
+}
+
+static gboolean
+port_serial_process_command (MMPortSerial *self,
+                             CommandContext *ctx,
+                             GError **error)
+{
+    const gchar *p;
+    gsize written;
+    gssize send_len;
+
+    if (!port_serial_check_can_send (self, error))
+        return FALSE;
+
+    port_serial_command_start (self, ctx);
+
+    if (!ctx->paced) {
+        /* Send the rest of the command in one write */
+        send_len = (gssize)(ctx->command->len - ctx->idx);
+        p = (gchar *)&ctx->command->data[ctx->idx];
     } else {
         /* Send just one byte of the command */
         send_len = 1;
@@ -590,27 +800,13 @@ port_serial_process_command (MMPortSerial *self,
             break;
 
         case G_IO_STATUS_NORMAL:
-            if (written > 0) {
-                ctx->idx += written;
+            if (written > 0)
                 break;
-            }
             /* If written == 0 treat as EAGAIN */
             /* Fall through */
 
         case G_IO_STATUS_AGAIN:
-            /* We're in a non-blocking channel and therefore we're up to receive
-             * EAGAIN; just retry in this case. */
-            ctx->eagain_count--;
-            if (ctx->eagain_count <= 0) {
-                /* If we reach the limit of EAGAIN errors, treat as a timeout error. */
-                self->priv->n_consecutive_timeouts++;
-                g_signal_emit (self, signals[TIMED_OUT], 0, self->priv->n_consecutive_timeouts);
-
-                g_set_error (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_SEND_FAILED,
-                             "Sending command failed: '%s'", g_strerror (errno));
-                return FALSE;
-            }
-            break;
+            return port_serial_command_send_again (self, ctx, error);
 
         default:
             g_assert_not_reached ();
@@ -630,41 +826,142 @@ port_serial_process_command (MMPortSerial *self,
                 g_prefix_error (error, "Sending command failed: ");
                 return FALSE;
             }
+            g_error_free (inner_error);
+            return port_serial_command_send_again (self, ctx, error);
+        }
+        written = bytes_sent;
+    } else
+        g_assert_not_reached ();
 
-            /* We're in a non-blocking socket and therefore we're up to receive
-             * EWOULDBLOCK; just retry in this case. */
+    port_serial_command_sent (self, ctx, written);
+    return TRUE;
+}
 
-            g_error_free (inner_error);
+static gboolean
+port_serial_command_allows_pipelining (MMPortSerial   *self,
+                                       CommandContext *ctx)
+{
+    /* Commands already being sent byte by byte are never pipelined */
+    if (ctx->started && ctx->paced)
+        return FALSE;
+
+    if (!MM_PORT_SERIAL_GET_CLASS (self)->command_allows_pipelining)
+        return TRUE;
+    return MM_PORT_SERIAL_GET_CLASS (self)->command_allows_pipelining (self, ctx->command);
+}
+
+/* Collect the commands at the head of the queue which can be sent at once */
+static guint
+port_serial_build_pipeline (MMPortSerial    *self,
+                            CommandContext **batch)
+{
+    GList *l;
+    guint  n = 0;
 
-            ctx->eagain_count--;
-            if (ctx->eagain_count <= 0) {
-                /* If we reach the limit of EAGAIN errors, treat as a timeout error. */
-                self->priv->n_consecutive_timeouts++;
-                g_signal_emit (self, signals[TIMED_OUT], 0, self->priv->n_consecutive_timeouts);
+    if (!self->priv->pipeline || port_serial_send_paced (self))
+        return 0;
+
+    for (l = self->priv->queue->head; l && n < PIPELINE_MAX_COMMANDS; l = g_list_next (l)) {
+        CommandContext *ctx = l->data;
+
+        /* Commands with a cached reply are completed once they reach the
+         * head of the queue, never sent */
+        if (n > 0 && ctx->allow_cached && port_serial_get_cached_reply (self, ctx->command))
+            break;
+        if (!port_serial_command_allows_pipelining (self, ctx))
+            break;
+        batch[n++] = ctx;
+    }
+    return n;
+}
+
+/* Send the given commands with a single write; any command not fully sent
+ * is continued in the next queue processing */
+static gboolean
+port_serial_process_pipeline (MMPortSerial    *self,
+                              CommandContext **batch,
+                              guint            n_batch,
+                              GError         **error)
+{
+    GOutputVector vectors[PIPELINE_MAX_COMMANDS];
+    gsize         written;
+    guint         i;
+
+    if (!port_serial_check_can_send (self, error))
+        return FALSE;
+
+    for (i = 0; i < n_batch; i++) {
+        port_serial_command_start (self, batch[i]);
+        vectors[i].buffer = &batch[i]->command->data[batch[i]->idx];
+        vectors[i].size = batch[i]->command->len - batch[i]->idx;
+    }
+
+    /* GIOChannel based setup; the channel is unbuffered, so it's safe to
+     * write directly to the fd */
+    if (self->priv->iochannel) {
+        struct iovec iov[PIPELINE_MAX_COMMANDS];
+        gssize       bytes_written;
+
+        for (i = 0; i < n_batch; i++) {
+            iov[i].iov_base = (gpointer) vectors[i].buffer;
+            iov[i].iov_len = vectors[i].size;
+        }
+
+        do {
+            bytes_written = writev (self->priv->fd, iov, n_batch);
+        } while (bytes_written < 0 && errno == EINTR);
+
+        if (bytes_written < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
                 g_set_error (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_SEND_FAILED,
-                             "Sending command failed: '%s'", g_strerror (errno));
+                             "Sending command failed: %s", g_strerror (errno));
                 return FALSE;
             }
+            bytes_written = 0;
+        }
+        written = bytes_written;
+    }
+    /* Socket based setup */
+    else if (self->priv->socket) {
+        GError *inner_error = NULL;
+        gssize  bytes_sent;
 
-            /* Just keep on, will retry... */
-            written = 0;
-        } else
-            written = bytes_sent;
-
-        ctx->idx += written;
+        bytes_sent = g_socket_send_message (self->priv->socket, NULL, vectors, n_batch,
+                                            NULL, 0, 0, NULL, &inner_error);
+        if (bytes_sent < 0) {
+            /* Non-EWOULDBLOCK error? */
+            if (!g_error_matches (inner_error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK)) {
+                g_propagate_error (error, inner_error);
+                g_prefix_error (error, "Sending command failed: ");
+                return FALSE;
+            }
+            g_error_free (inner_error);
+            bytes_sent = 0;
+        }
+        written = bytes_sent;
     } else
         g_assert_not_reached ();
 
-    if (ctx->idx >= ctx->command->len)
-        ctx->done = TRUE;
+    if (!written)
+        return port_serial_command_send_again (self, batch[0], error);
+
+    for (i = 0; i < n_batch && written > 0; i++) {
+        gsize chunk;
 
+        chunk = MIN (written, vectors[i].size);
+        port_serial_command_sent (self, batch[i], chunk);
+        written -= chunk;
+    }
+
+    if (n_batch > 1)
+        mm_obj_dbg (self, "%u commands pipelined", i);
     return TRUE;
 }
 
 static void
 port_serial_set_cached_reply (MMPortSerial *self,
                               const GByteArray *command,
-                              const GByteArray *response)
+                              GByteArray *response)
 {
     g_return_if_fail (self != NULL);
     g_return_if_fail (MM_IS_PORT_SERIAL (self));
@@ -672,20 +969,36 @@ port_serial_set_cached_reply (MMPortSerial *self,
 
     if (response) {
         GByteArray *cmd_copy = g_byte_array_sized_new (command->len);
-        GByteArray *rsp_copy = g_byte_array_sized_new (response->len);
 
         g_byte_array_append (cmd_copy, command->data, command->len);
-        g_byte_array_append (rsp_copy, response->data, response->len);
-        g_hash_table_insert (self->priv->reply_cache, cmd_copy, rsp_copy);
+        /* Parsed responses are never modified, so just keep a reference */
+        g_hash_table_insert (self->priv->reply_cache, cmd_copy, g_byte_array_ref (response));
     } else
         g_hash_table_remove (self->priv->reply_cache, command);
 }
 
-static const GByteArray *
+void
+mm_port_serial_set_cached_reply (MMPortSerial     *self,
+                                 const GByteArray *command,
+                                 GByteArray       *response)
+{
+    g_return_if_fail (response != NULL);
+
+    port_serial_set_cached_reply (self, command, response);
+}
+
+static GByteArray *
 port_serial_get_cached_reply (MMPortSerial *self,
                               GByteArray *command)
 {
-    return (const GByteArray *)g_hash_table_lookup (self->priv->reply_cache, command);
+    return (GByteArray *)g_hash_table_lookup (self->priv->reply_cache, command);
+}
+
+static void
+port_serial_send_delay_elapsed (MMPortSerial *self)
+{
+    self->priv->send_id = 0;
+    port_serial_queue_process (self);
 }
 
 static void
@@ -696,13 +1009,15 @@ port_serial_schedule_queue_process (MMPortSerial *self, guint timeout_ms)
         return;
     }
 
-    if (self->priv->queue_id) {
+    if (self->priv->queue_id || self->priv->send_id) {
         /* Already scheduled */
         return;
     }
 
     if (timeout_ms)
-        self->priv->queue_id = g_timeout_add (timeout_ms, port_serial_queue_process, self);
+        self->priv->send_id = mm_timer_wheel_add (timeout_ms,
+                                                  (MMTimerWheelFunc) port_serial_send_delay_elapsed,
+                                                  self);
     else
         self->priv->queue_id = g_idle_add (port_serial_queue_process, self);
 }
@@ -716,7 +1031,7 @@ port_serial_got_response (MMPortSerial *self,
     g_assert ((parsed_response && !error) || (!parsed_response && error));
 
     if (self->priv->timeout_id) {
-        g_source_remove (self->priv->timeout_id);
+        mm_timer_wheel_remove (self->priv->timeout_id);
         self->priv->timeout_id = 0;
     }
 
@@ -761,10 +1076,9 @@ port_serial_got_response (MMPortSerial *self,
     g_object_unref (self);
 }
 
-static gboolean
-port_serial_timed_out (gpointer data)
+static void
+port_serial_timed_out (MMPortSerial *self)
 {
-    MMPortSerial *self = MM_PORT_SERIAL (data);
     GError *error;
 
     self->priv->timeout_id = 0;
@@ -772,6 +1086,21 @@ port_serial_timed_out (gpointer data)
     /* Update number of consecutive timeouts found */
     self->priv->n_consecutive_timeouts++;
 
+    /* In adaptive send delay mode, commands sent in a single write which
+     * don't get any response may have lost some bytes on the way; a single
+     * timeout may just be a slow or unsupported command though, so only
+     * consecutive ones are taken as a loss */
+    if (self->priv->send_delay_adaptive && port_serial_send_delay_applies (self)) {
+        CommandContext *ctx;
+
+        ctx = (CommandContext *) g_queue_peek_head (self->priv->queue);
+        if (ctx && ctx->started && !ctx->paced &&
+            ++self->priv->n_unpaced_timeouts >= MAX_UNPACED_TIMEOUTS) {
+            self->priv->n_unpaced_timeouts = 0;
+            port_serial_send_lost (self, "commands timed out");
+        }
+    }
+
     /* FIXME: This is not completely correct - if the response finally arrives and there's
      * some other command waiting for response right now, the other command will
      * get the output of the timed out command. Not sure what to do here. */
@@ -791,8 +1120,6 @@ port_serial_timed_out (gpointer data)
     g_object_unref (self);
 
     g_error_free (error);
-
-    return G_SOURCE_REMOVE;
 }
 
 static void
@@ -819,6 +1146,8 @@ port_serial_queue_process (gpointer data)
 {
     MMPortSerial *self = MM_PORT_SERIAL (data);
     CommandContext *ctx;
+    CommandContext *batch[PIPELINE_MAX_COMMANDS];
+    guint n_batch;
     GError *error = NULL;
 
     self->priv->queue_id = 0;
@@ -827,39 +1156,47 @@ port_serial_queue_process (gpointer data)
     if (!ctx)
         return G_SOURCE_REMOVE;
 
-    if (ctx->allow_cached) {
-        const GByteArray *cached;
+    if (!ctx->started && ctx->allow_cached) {
+        GByteArray *cached;
 
         cached = port_serial_get_cached_reply (self, ctx->command);
         if (cached) {
-            GByteArray *parsed_response;
-
-            parsed_response = g_byte_array_sized_new (cached->len);
-            g_byte_array_append (parsed_response, cached->data, cached->len);
+            /* The cached reply may be replaced while completing the command,
+             * so keep our own reference */
+            g_byte_array_ref (cached);
             /* Note: may complete last operation and unref the MMPortSerial */
-            port_serial_got_response (self, parsed_response, NULL);
-            g_byte_array_unref (parsed_response);
+            port_serial_got_response (self, cached, NULL);
+            g_byte_array_unref (cached);
             return G_SOURCE_REMOVE;
         }
 
         /* Cached reply wasn't found, keep on */
     }
 
-    /* If error, report it */
-    if (!port_serial_process_command (self, ctx, &error)) {
-        /* Note: may complete last operation and unref the MMPortSerial */
-        port_serial_got_response (self, NULL, error);
-        g_error_free (error);
-        return G_SOURCE_REMOVE;
-    }
-
-    /* Schedule the next byte of the command to be sent */
+    /* In pipelined mode, the command may have already been sent along with
+     * the previous one, so just wait for its reply */
     if (!ctx->done) {
-        port_serial_schedule_queue_process (self,
-                                            (mm_port_get_subsys (MM_PORT (self)) == MM_PORT_SUBSYS_TTY ?
-                                             self->priv->send_delay / 1000 :
-                                             0));
-        return G_SOURCE_REMOVE;
+        gboolean sent;
+
+        n_batch = port_serial_build_pipeline (self, batch);
+        if (n_batch > 1)
+            sent = port_serial_process_pipeline (self, batch, n_batch, &error);
+        else
+            sent = port_serial_process_command (self, ctx, &error);
+
+        /* If error, report it */
+        if (!sent) {
+            /* Note: may complete last operation and unref the MMPortSerial */
+            port_serial_got_response (self, NULL, error);
+            g_error_free (error);
+            return G_SOURCE_REMOVE;
+        }
+
+        /* Schedule the next byte of the command to be sent */
+        if (!ctx->done) {
+            port_serial_schedule_queue_process (self, ctx->paced ? self->priv->send_delay / 1000 : 0);
+            return G_SOURCE_REMOVE;
+        }
     }
 
     /* Setup the cancellable so that we can stop waiting for a response */
@@ -886,14 +1223,14 @@ port_serial_queue_process (gpointer data)
     }
 
     /* If the command is finished being sent, schedule the timeout */
-    self->priv->timeout_id = g_timeout_add_seconds (ctx->timeout,
-                                                    port_serial_timed_out,
-                                                    self);
+    self->priv->timeout_id = mm_timer_wheel_add (ctx->timeout_ms,
+                                                 (MMTimerWheelFunc) port_serial_timed_out,
+                                                 self);
     return G_SOURCE_REMOVE;
 }
 
-static void
-parse_response_buffer (MMPortSerial *self)
+static gboolean
+parse_response_buffer_once (MMPortSerial *self)
 {
     GError *error = NULL;
     GByteArray *parsed_response = NULL;
@@ -922,26 +1259,39 @@ parse_response_buffer (MMPortSerial *self)
         /* We have a valid response to process */
         g_assert (parsed_response);
         self->priv->n_consecutive_timeouts = 0;
+        self->priv->n_unpaced_timeouts = 0;
         /* Note: may complete last operation and unref the MMPortSerial */
         port_serial_got_response (self, parsed_response, NULL);
         g_byte_array_unref (parsed_response);
-        break;
+        return TRUE;
     case MM_PORT_SERIAL_RESPONSE_ERROR:
         /* We have an error to process */
         g_assert (error);
         self->priv->n_consecutive_timeouts = 0;
+        self->priv->n_unpaced_timeouts = 0;
         /* Note: may complete last operation and unref the MMPortSerial */
         port_serial_got_response (self, NULL, error);
         g_error_free (error);
-        break;
+        return TRUE;
     case MM_PORT_SERIAL_RESPONSE_NONE:
         /* Nothing to do this time */
-        break;
+        return FALSE;
     default:
         g_assert_not_reached ();
     }
 }
 
+static void
+parse_response_buffer (MMPortSerial *self)
+{
+    /* In pipelined mode the buffer may contain the replies to several of the
+     * commands already sent, so keep on parsing while there is a command
+     * waiting for its reply. The caller holds a reference to the port. */
+    while (parse_response_buffer_once (self) &&
+           self->priv->response->len > 0 &&
+           mm_port_serial_get_n_commands_in_flight (self) > 0);
+}
+
 static gboolean
 common_input_available (MMPortSerial *self,
                         GIOCondition condition)
@@ -956,15 +1306,13 @@ common_input_available (MMPortSerial *self,
 
     if (condition & G_IO_HUP) {
         mm_obj_dbg (self, "unexpected port hangup!");
-        if (self->priv->response->len)
-            g_byte_array_remove_range (self->priv->response, 0, self->priv->response->len);
+        mm_serial_buffer_clear (self->priv->response);
         port_serial_close_force (self);
         return G_SOURCE_REMOVE;
     }
 
     if (condition & G_IO_ERR) {
-        if (self->priv->response->len)
-            g_byte_array_remove_range (self->priv->response, 0, self->priv->response->len);
+        mm_serial_buffer_clear (self->priv->response);
         return G_SOURCE_CONTINUE;
     }
 
@@ -1015,13 +1363,14 @@ common_input_available (MMPortSerial *self,
 
         g_assert (bytes_read > 0);
         serial_debug (self, "<--", buf, bytes_read);
-        g_byte_array_append (self->priv->response, (const guint8 *) buf, bytes_read);
+        serial_capture (self, MM_SERIAL_CAPTURE_DIRECTION_READ, buf, bytes_read);
+        mm_serial_buffer_append (self->priv->response, (const guint8 *) buf, bytes_read);
 
         /* Make sure the response doesn't grow too long */
         if ((self->priv->response->len > SERIAL_BUF_SIZE) && self->priv->spew_control) {
             /* Notify listeners and then trim the buffer */
             g_signal_emit (self, signals[BUFFER_FULL], 0, self->priv->response);
-            g_byte_array_remove_range (self->priv->response, 0, (SERIAL_BUF_SIZE / 2));
+            mm_serial_buffer_consume (self->priv->response, (SERIAL_BUF_SIZE / 2));
         }
 
         /* See if we can parse anything. The response parsing may actually
@@ -1307,6 +1656,18 @@ success:
     self->priv->open_count++;
     mm_obj_dbg (self, "device open count is %d (open)", self->priv->open_count);
 
+    /* Start capturing the traffic if requested for this port */
+    if (self->priv->open_count == 1 && !self->priv->capture) {
+        GError *capture_error = NULL;
+
+        self->priv->capture = mm_serial_capture_new_for_port (device, &capture_error);
+        if (capture_error) {
+            mm_obj_warn (self, "couldn't start capturing traffic: %s", capture_error->message);
+            g_error_free (capture_error);
+        } else if (self->priv->capture)
+            mm_obj_dbg (self, "capturing traffic");
+    }
+
     /* Run additional port config if just opened */
     if (self->priv->open_count == 1 && MM_PORT_SERIAL_GET_CLASS (self)->config)
         MM_PORT_SERIAL_GET_CLASS (self)->config (self);
@@ -1437,6 +1798,8 @@ _close_internal (MMPortSerial *self, gboolean force)
             mm_obj_warn (self, "close blocked by driver for more than 7 seconds!");
     }
 
+    g_clear_pointer (&self->priv->capture, mm_serial_capture_free);
+
     /* Clear the command queue */
     for (i = 0; i < g_queue_get_length (self->priv->queue); i++) {
         CommandContext *ctx;
@@ -1451,7 +1814,7 @@ _close_internal (MMPortSerial *self, gboolean force)
     g_queue_clear (self->priv->queue);
 
     if (self->priv->timeout_id) {
-        g_source_remove (self->priv->timeout_id);
+        mm_timer_wheel_remove (self->priv->timeout_id);
         self->priv->timeout_id = 0;
     }
 
@@ -1460,6 +1823,11 @@ _close_internal (MMPortSerial *self, gboolean force)
         self->priv->queue_id = 0;
     }
 
+    if (self->priv->send_id) {
+        mm_timer_wheel_remove (self->priv->send_id);
+        self->priv->send_id = 0;
+    }
+
     if (self->priv->cancellable_id) {
         g_assert (self->priv->cancellable != NULL);
         g_cancellable_disconnect (self->priv->cancellable,
@@ -1963,7 +2331,10 @@ mm_port_serial_init (MMPortSerial *self)
     self->priv->send_delay = 1000;
 
     self->priv->queue = g_queue_new ();
-    self->priv->response = g_byte_array_sized_new (500);
+    /* With spew control, at most SERIAL_BUF_SIZE bytes are kept pending plus
+     * up to SERIAL_BUF_SIZE bytes of a new read, so this capacity ensures the
+     * buffer never needs to be reallocated */
+    self->priv->response = mm_serial_buffer_new (4 * SERIAL_BUF_SIZE);
 }
 
 static void
@@ -1996,6 +2367,12 @@ set_property (GObject *object,
     case PROP_SEND_DELAY:
         self->priv->send_delay = g_value_get_uint64 (value);
         break;
+    case PROP_SEND_DELAY_ADAPTIVE:
+        self->priv->send_delay_adaptive = g_value_get_boolean (value);
+        break;
+    case PROP_PIPELINE:
+        self->priv->pipeline = g_value_get_boolean (value);
+        break;
     case PROP_SPEW_CONTROL:
         self->priv->spew_control = g_value_get_boolean (value);
         break;
@@ -2038,6 +2415,12 @@ get_property (GObject *object,
     case PROP_SEND_DELAY:
         g_value_set_uint64 (value, self->priv->send_delay);
         break;
+    case PROP_SEND_DELAY_ADAPTIVE:
+        g_value_set_boolean (value, self->priv->send_delay_adaptive);
+        break;
+    case PROP_PIPELINE:
+        g_value_set_boolean (value, self->priv->pipeline);
+        break;
     case PROP_SPEW_CONTROL:
         g_value_set_boolean (value, self->priv->spew_control);
         break;
@@ -2065,13 +2448,16 @@ finalize (GObject *object)
     g_assert (self->priv->socket_source == NULL);
 
     if (self->priv->timeout_id)
-        g_source_remove (self->priv->timeout_id);
+        mm_timer_wheel_remove (self->priv->timeout_id);
 
     if (self->priv->queue_id)
         g_source_remove (self->priv->queue_id);
 
+    if (self->priv->send_id)
+        mm_timer_wheel_remove (self->priv->send_id);
+
     g_hash_table_destroy (self->priv->reply_cache);
-    g_byte_array_unref (self->priv->response);
+    mm_serial_buffer_free (self->priv->response);
     g_queue_free (self->priv->queue);
 
     G_OBJECT_CLASS (mm_port_serial_parent_class)->finalize (object);
@@ -2149,6 +2535,24 @@ mm_port_serial_class_init (MMPortSerialClass *klass)
                               0, G_MAXUINT64, 0,
                               G_PARAM_READWRITE));
 
+    g_object_class_install_property
+        (object_class, PROP_SEND_DELAY_ADAPTIVE,
+         g_param_spec_boolean (MM_PORT_SERIAL_SEND_DELAY_ADAPTIVE,
+                               "SendDelayAdaptive",
+                               "Send commands in a single write, and only apply "
+                               "the send delay once some bytes are found lost",
+                               FALSE,
+                               G_PARAM_READWRITE));
+
+    g_object_class_install_property
+        (object_class, PROP_PIPELINE,
+         g_param_spec_boolean (MM_PORT_SERIAL_PIPELINE,
+                               "Pipeline",
+                               "Send queued commands at once, without waiting "
+                               "for the replies to the previous ones",
+                               FALSE,
+                               G_PARAM_READWRITE));
+
     g_object_class_install_property
         (object_class, PROP_SPEW_CONTROL,
          g_param_spec_boolean (MM_PORT_SERIAL_SPEW_CONTROL,
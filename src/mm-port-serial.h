@@ -23,6 +23,7 @@
 
 #include "mm-modem-helpers.h"
 #include "mm-port.h"
+#include "mm-serial-buffer.h"
 
 #define MM_TYPE_PORT_SERIAL            (mm_port_serial_get_type ())
 #define MM_PORT_SERIAL(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), MM_TYPE_PORT_SERIAL, MMPortSerial))
@@ -31,15 +32,17 @@
 #define MM_IS_PORT_SERIAL_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass),  MM_TYPE_PORT_SERIAL))
 #define MM_PORT_SERIAL_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj),  MM_TYPE_PORT_SERIAL, MMPortSerialClass))
 
-#define MM_PORT_SERIAL_BAUD         "baud"
-#define MM_PORT_SERIAL_BITS         "bits"
-#define MM_PORT_SERIAL_PARITY       "parity"
-#define MM_PORT_SERIAL_STOPBITS     "stopbits"
-#define MM_PORT_SERIAL_FLOW_CONTROL "flowcontrol"
-#define MM_PORT_SERIAL_SEND_DELAY   "send-delay"
-#define MM_PORT_SERIAL_FD           "fd" /* Construct-only */
-#define MM_PORT_SERIAL_SPEW_CONTROL "spew-control" /* Construct-only */
-#define MM_PORT_SERIAL_FLASH_OK     "flash-ok" /* Construct-only */
+#define MM_PORT_SERIAL_BAUD                 "baud"
+#define MM_PORT_SERIAL_BITS                 "bits"
+#define MM_PORT_SERIAL_PARITY               "parity"
+#define MM_PORT_SERIAL_STOPBITS             "stopbits"
+#define MM_PORT_SERIAL_FLOW_CONTROL         "flowcontrol"
+#define MM_PORT_SERIAL_SEND_DELAY           "send-delay"
+#define MM_PORT_SERIAL_SEND_DELAY_ADAPTIVE  "send-delay-adaptive"
+#define MM_PORT_SERIAL_PIPELINE             "pipeline"
+#define MM_PORT_SERIAL_FD                   "fd" /* Construct-only */
+#define MM_PORT_SERIAL_SPEW_CONTROL         "spew-control" /* Construct-only */
+#define MM_PORT_SERIAL_FLASH_OK             "flash-ok" /* Construct-only */
 
 typedef enum {
     MM_PORT_SERIAL_RESPONSE_NONE,
@@ -47,6 +50,21 @@ typedef enum {
     MM_PORT_SERIAL_RESPONSE_ERROR,
 } MMPortSerialResponseType;
 
+/* Statistics of how commands have been sent through the port */
+typedef struct {
+    /* Whether per-byte pacing is in use for the next commands */
+    gboolean paced;
+    /* Times bytes were found lost when sending a command in a single write */
+    guint    n_send_losses;
+    /* Commands sent in a single write, and how many of them got their echo
+     * verified */
+    guint    n_unpaced_commands;
+    guint    n_echoes_verified;
+    /* Commands sent with per-byte pacing, and total time spent sending them */
+    guint    n_paced_commands;
+    guint64  pacing_time_ms;
+} MMPortSerialSendStats;
+
 typedef struct _MMPortSerial MMPortSerial;
 typedef struct _MMPortSerialClass MMPortSerialClass;
 typedef struct _MMPortSerialPrivate MMPortSerialPrivate;
@@ -61,9 +79,9 @@ struct _MMPortSerialClass {
 
     /* Called for subclasses to parse unsolicited responses.  If any recognized
      * unsolicited response is found, it should be removed from the 'response'
-     * byte array before returning.
+     * buffer before returning.
      */
-    void     (*parse_unsolicited) (MMPortSerial *self, GByteArray *response);
+    void     (*parse_unsolicited) (MMPortSerial *self, MMSerialBuffer *response);
 
     /*
      * Called to parse the device's response to a command or determine if the
@@ -78,11 +96,11 @@ struct _MMPortSerialClass {
      * If there is no response, @MM_PORT_SERIAL_RESPONSE_NONE will be returned,
      * and neither @error nor @parsed_response will be set.
      *
-     * The implementation is allowed to cleanup the @response byte array, e.g. to
+     * The implementation is allowed to cleanup the @response buffer, e.g. to
      * just remove 1 single response if more than one found.
      */
     MMPortSerialResponseType (*parse_response) (MMPortSerial *self,
-                                                GByteArray *response,
+                                                MMSerialBuffer *response,
                                                 GByteArray **parsed_response,
                                                 GError **error);
 
@@ -100,8 +118,14 @@ struct _MMPortSerialClass {
                                    const gchar  *buf,
                                    gsize         len);
 
+    /* Called in pipelined mode to check whether the given command may be sent
+     * along with other queued commands, before the replies to the previous
+     * ones are received. If not implemented, all commands are allowed. */
+    gboolean (*command_allows_pipelining) (MMPortSerial     *self,
+                                           const GByteArray *command);
+
     /* Signals */
-    void (*buffer_full)           (MMPortSerial *port, const GByteArray *buffer);
+    void (*buffer_full)           (MMPortSerial *port, const MMSerialBuffer *buffer);
     void (*timed_out)             (MMPortSerial *port, guint n_consecutive_replies);
     void (*forced_close)          (MMPortSerial *port);
 };
@@ -143,16 +167,39 @@ void     mm_port_serial_flash_cancel      (MMPortSerial *self);
 
 void        mm_port_serial_command        (MMPortSerial *self,
                                            GByteArray *command,
-                                           guint32 timeout_seconds,
+                                           guint32 timeout_ms,
                                            gboolean allow_cached,
                                            gboolean run_next,
                                            GCancellable *cancellable,
                                            GAsyncReadyCallback callback,
                                            gpointer user_data);
+/* The returned response may be shared with the reply cache, so it must not
+ * be modified by the caller. */
 GByteArray *mm_port_serial_command_finish (MMPortSerial *self,
                                            GAsyncResult *res,
                                            GError **error);
 
+/* For subclasses: validate the echo of the command being sent, so that in
+ * adaptive send delay mode the port falls back to per-byte pacing as soon as
+ * the echo shows that some bytes were lost. */
+void        mm_port_serial_check_echo     (MMPortSerial *self,
+                                           const guint8 *echo,
+                                           gsize         echo_len);
+
+void        mm_port_serial_get_send_stats (MMPortSerial          *self,
+                                           MMPortSerialSendStats *stats);
+
+/* Store a reply in the cache, as if the command had been run allowing cached
+ * replies; e.g. when the reply was received as part of a compound command. */
+void        mm_port_serial_set_cached_reply (MMPortSerial     *self,
+                                             const GByteArray *command,
+                                             GByteArray       *response);
+
+/* For subclasses: number of commands already sent and waiting for a reply.
+ * More than one only in pipelined mode, in which case the replies are
+ * expected in the same order as the commands. */
+guint       mm_port_serial_get_n_commands_in_flight (MMPortSerial *self);
+
 gboolean mm_port_serial_set_flow_control (MMPortSerial   *self,
                                           MMFlowControl   flow_control,
                                           GError        **error);
@@ -0,0 +1,289 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <string.h>
+
+#include "mm-regex-registry.h"
+
+typedef struct {
+    gchar              *key;
+    gchar              *pattern;
+    GRegexCompileFlags  compile_flags;
+    GRegex             *regex;
+    guint               n_sites;
+    guint               n_compiles;
+    volatile gint       n_gets;
+    /* Protected by the stats lock */
+    guint               n_matches;
+    gint64              match_time;
+} RegexRecord;
+
+typedef struct {
+    const gchar *pattern; /* literal given at the call site */
+    RegexRecord *record;
+} RegexSite;
+
+typedef struct {
+    GRWLock     lock;
+    GHashTable *records;          /* key: flags + pattern, value: RegexRecord */
+    GHashTable *sites;            /* key: G_STRLOC literal, value: RegexSite */
+    GHashTable *records_by_regex; /* key: GRegex, value: RegexRecord */
+    guint       n_compiles;
+    GMutex      stats_lock;
+} RegexRegistry;
+
+static volatile gint stats_enabled;
+
+static RegexRegistry *
+registry_get (void)
+{
+    static RegexRegistry *registry;
+
+    if (g_once_init_enter (&registry)) {
+        RegexRegistry *new_registry;
+
+        new_registry = g_new0 (RegexRegistry, 1);
+        g_rw_lock_init (&new_registry->lock);
+        g_mutex_init (&new_registry->stats_lock);
+        new_registry->records = g_hash_table_new (g_str_hash, g_str_equal);
+        new_registry->sites = g_hash_table_new (g_direct_hash, g_direct_equal);
+        new_registry->records_by_regex = g_hash_table_new (g_direct_hash, g_direct_equal);
+        g_once_init_leave (&registry, new_registry);
+    }
+    return registry;
+}
+
+/*****************************************************************************/
+
+/* Must be called with the write lock held */
+static RegexRecord *
+registry_ensure_record (RegexRegistry      *registry,
+                        const gchar        *pattern,
+                        GRegexCompileFlags  compile_flags)
+{
+    RegexRecord      *record;
+    g_autofree gchar *key = NULL;
+    g_autoptr(GError) error = NULL;
+
+    key = g_strdup_printf ("%x:%s", (guint) compile_flags, pattern);
+    record = g_hash_table_lookup (registry->records, key);
+    if (record)
+        return record;
+
+    record = g_slice_new0 (RegexRecord);
+    record->key = g_steal_pointer (&key);
+    record->pattern = g_strdup (pattern);
+    record->compile_flags = compile_flags;
+    record->regex = g_regex_new (pattern, compile_flags, 0, &error);
+    record->n_compiles++;
+    registry->n_compiles++;
+
+    /* Patterns are part of the code, so failing to compile one is a bug; the
+     * record is kept anyway so that it isn't retried on every call */
+    if (!record->regex)
+        g_warning ("couldn't compile regex '%s': %s", pattern, error->message);
+    else
+        g_hash_table_insert (registry->records_by_regex, record->regex, record);
+
+    g_hash_table_insert (registry->records, record->key, record);
+    return record;
+}
+
+static GRegex *
+record_ref_regex (RegexRecord *record)
+{
+    g_atomic_int_inc (&record->n_gets);
+    return record->regex ? g_regex_ref (record->regex) : NULL;
+}
+
+GRegex *
+mm_regex_get_full (const gchar        *location,
+                   const gchar        *pattern,
+                   GRegexCompileFlags  compile_flags)
+{
+    RegexRegistry *registry;
+    RegexSite     *site;
+    RegexRecord   *record;
+
+    registry = registry_get ();
+
+    g_rw_lock_reader_lock (&registry->lock);
+    site = g_hash_table_lookup (registry->sites, location);
+    record = (site && site->pattern == pattern) ? site->record : NULL;
+    g_rw_lock_reader_unlock (&registry->lock);
+    if (record)
+        return record_ref_regex (record);
+
+    g_rw_lock_writer_lock (&registry->lock);
+    site = g_hash_table_lookup (registry->sites, location);
+    if (!site) {
+        site = g_slice_new0 (RegexSite);
+        site->pattern = pattern;
+        site->record = registry_ensure_record (registry, pattern, compile_flags);
+        site->record->n_sites++;
+        g_hash_table_insert (registry->sites, (gpointer) location, site);
+        record = site->record;
+    } else if (site->pattern == pattern) {
+        /* Another thread got here first */
+        record = site->record;
+    } else {
+        /* Not a literal; don't let it take over the site */
+        g_warn_if_reached ();
+        record = registry_ensure_record (registry, pattern, compile_flags);
+    }
+    g_rw_lock_writer_unlock (&registry->lock);
+
+    return record_ref_regex (record);
+}
+
+GRegex *
+mm_regex_get_dynamic (const gchar        *pattern,
+                      GRegexCompileFlags  compile_flags)
+{
+    RegexRegistry    *registry;
+    RegexRecord      *record;
+    g_autofree gchar *key = NULL;
+
+    registry = registry_get ();
+    key = g_strdup_printf ("%x:%s", (guint) compile_flags, pattern);
+
+    g_rw_lock_reader_lock (&registry->lock);
+    record = g_hash_table_lookup (registry->records, key);
+    g_rw_lock_reader_unlock (&registry->lock);
+    if (record)
+        return record_ref_regex (record);
+
+    g_rw_lock_writer_lock (&registry->lock);
+    record = registry_ensure_record (registry, pattern, compile_flags);
+    g_rw_lock_writer_unlock (&registry->lock);
+
+    return record_ref_regex (record);
+}
+
+/*****************************************************************************/
+
+gboolean
+mm_regex_match (const GRegex      *regex,
+                const gchar       *string,
+                GRegexMatchFlags   match_options,
+                GMatchInfo       **match_info)
+{
+    return mm_regex_match_full (regex, string, -1, 0, match_options, match_info, NULL);
+}
+
+gboolean
+mm_regex_match_full (const GRegex      *regex,
+                     const gchar       *string,
+                     gssize             string_len,
+                     gint               start_position,
+                     GRegexMatchFlags   match_options,
+                     GMatchInfo       **match_info,
+                     GError           **error)
+{
+    RegexRegistry *registry;
+    RegexRecord   *record;
+    gint64         start;
+    gboolean       matched;
+
+    if (!g_atomic_int_get (&stats_enabled))
+        return g_regex_match_full (regex, string, string_len, start_position, match_options, match_info, error);
+
+    start = g_get_monotonic_time ();
+    matched = g_regex_match_full (regex, string, string_len, start_position, match_options, match_info, error);
+
+    registry = registry_get ();
+    g_rw_lock_reader_lock (&registry->lock);
+    record = g_hash_table_lookup (registry->records_by_regex, regex);
+    g_rw_lock_reader_unlock (&registry->lock);
+
+    /* Regexes not coming from the registry aren't accounted */
+    if (record) {
+        g_mutex_lock (&registry->stats_lock);
+        record->n_matches++;
+        record->match_time += g_get_monotonic_time () - start;
+        g_mutex_unlock (&registry->stats_lock);
+    }
+
+    return matched;
+}
+
+/*****************************************************************************/
+
+void
+mm_regex_registry_set_stats_enabled (gboolean enabled)
+{
+    g_atomic_int_set (&stats_enabled, !!enabled);
+}
+
+guint
+mm_regex_registry_get_n_compiles (void)
+{
+    RegexRegistry *registry;
+    guint          n_compiles;
+
+    registry = registry_get ();
+    g_rw_lock_reader_lock (&registry->lock);
+    n_compiles = registry->n_compiles;
+    g_rw_lock_reader_unlock (&registry->lock);
+    return n_compiles;
+}
+
+static gint
+stats_cmp (const MMRegexStats *a,
+           const MMRegexStats *b)
+{
+    /* Most expensive patterns first */
+    if (a->match_time != b->match_time)
+        return (a->match_time > b->match_time) ? -1 : 1;
+    if (a->n_gets != b->n_gets)
+        return (a->n_gets > b->n_gets) ? -1 : 1;
+    return strcmp (a->pattern, b->pattern);
+}
+
+void
+mm_regex_registry_foreach_stats (MMRegexStatsFunc func,
+                                 gpointer         user_data)
+{
+    RegexRegistry  *registry;
+    GHashTableIter  iter;
+    RegexRecord    *record;
+    g_autoptr(GArray) stats = NULL;
+    guint           i;
+
+    registry = registry_get ();
+    stats = g_array_new (FALSE, FALSE, sizeof (MMRegexStats));
+
+    /* Records are never removed, so the patterns stay valid after unlocking */
+    g_rw_lock_reader_lock (&registry->lock);
+    g_mutex_lock (&registry->stats_lock);
+    g_hash_table_iter_init (&iter, registry->records);
+    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &record)) {
+        MMRegexStats item;
+
+        item.pattern = record->pattern;
+        item.compile_flags = record->compile_flags;
+        item.n_sites = record->n_sites;
+        item.n_compiles = record->n_compiles;
+        item.n_gets = (guint) g_atomic_int_get (&record->n_gets);
+        item.n_matches = record->n_matches;
+        item.match_time = record->match_time;
+        g_array_append_val (stats, item);
+    }
+    g_mutex_unlock (&registry->stats_lock);
+    g_rw_lock_reader_unlock (&registry->lock);
+
+    g_array_sort (stats, (GCompareFunc) stats_cmp);
+    for (i = 0; i < stats->len; i++)
+        func (&g_array_index (stats, MMRegexStats, i), user_data);
+}
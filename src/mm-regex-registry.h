@@ -0,0 +1,76 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_REGEX_REGISTRY_H
+#define MM_REGEX_REGISTRY_H
+
+#include <glib.h>
+
+/* Process-wide registry of compiled regular expressions.
+ *
+ * Patterns are compiled the first time they are requested and kept around
+ * until the process exits, so that parsers which run on every response don't
+ * need to compile the same pattern over and over. The returned GRegex is a new
+ * reference, to be released with g_regex_unref() as if it had been created
+ * with g_regex_new(). GRegex objects are immutable, so they may be shared
+ * across call sites and threads.
+ *
+ * mm_regex_get() is keyed by call site, and must only be given string literals
+ * as pattern. Patterns built at runtime must use mm_regex_get_dynamic()
+ * instead, which is keyed by the pattern itself. */
+
+#define mm_regex_get(pattern, compile_flags) \
+    mm_regex_get_full (G_STRLOC, pattern, compile_flags)
+
+GRegex *mm_regex_get_full    (const gchar        *location,
+                              const gchar        *pattern,
+                              GRegexCompileFlags  compile_flags);
+GRegex *mm_regex_get_dynamic (const gchar        *pattern,
+                              GRegexCompileFlags  compile_flags);
+
+/* Same as g_regex_match() and g_regex_match_full(), but the time spent in the
+ * match is accounted to the pattern when statistics are enabled */
+gboolean mm_regex_match      (const GRegex      *regex,
+                              const gchar       *string,
+                              GRegexMatchFlags   match_options,
+                              GMatchInfo       **match_info);
+gboolean mm_regex_match_full (const GRegex      *regex,
+                              const gchar       *string,
+                              gssize             string_len,
+                              gint               start_position,
+                              GRegexMatchFlags   match_options,
+                              GMatchInfo       **match_info,
+                              GError           **error);
+
+/*****************************************************************************/
+/* Statistics */
+
+typedef struct {
+    const gchar        *pattern;
+    GRegexCompileFlags  compile_flags;
+    guint               n_sites;    /* call sites using the pattern */
+    guint               n_compiles;
+    guint               n_gets;
+    guint               n_matches;  /* only counted if stats enabled */
+    gint64              match_time; /* us, only counted if stats enabled */
+} MMRegexStats;
+
+typedef void (* MMRegexStatsFunc) (const MMRegexStats *stats,
+                                   gpointer            user_data);
+
+void  mm_regex_registry_set_stats_enabled (gboolean          enabled);
+void  mm_regex_registry_foreach_stats     (MMRegexStatsFunc  func,
+                                           gpointer          user_data);
+guint mm_regex_registry_get_n_compiles    (void);
+
+#endif /* MM_REGEX_REGISTRY_H */
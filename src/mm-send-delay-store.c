@@ -0,0 +1,93 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+
+#include "mm-send-delay-store.h"
+#include "mm-state-key-file.h"
+#include "mm-log-object.h"
+
+#define STORE_KEY_PACED    "paced"
+#define STORE_KEY_VERIFIED "verified"
+
+/* Devices recorded as requiring pacing are never probed in adaptive mode, so
+ * they would never be learned again if e.g. some spurious loss was taken as
+ * the reason. They're only trusted for some time since last learned. */
+#define PACED_MAX_AGE_SECS (7 * 24 * 60 * 60)
+
+static MMStateKeyFile store = MM_STATE_KEY_FILE_INIT ("send-delay", "send delay store");
+
+static gchar *
+build_group_name (guint16 vid,
+                  guint16 pid)
+{
+    return g_strdup_printf ("%04x:%04x", vid, pid);
+}
+
+gboolean
+mm_send_delay_store_lookup (guint16   vid,
+                            guint16   pid,
+                            gboolean *paced,
+                            gpointer  log_object)
+{
+    g_autofree gchar *group = NULL;
+    GError           *error = NULL;
+    gboolean          value;
+
+    group = build_group_name (vid, pid);
+    value = g_key_file_get_boolean (mm_state_key_file_peek (&store, log_object), group, STORE_KEY_PACED, &error);
+    if (error) {
+        g_error_free (error);
+        return FALSE;
+    }
+
+    if (value) {
+        gint64 verified;
+        gint64 now;
+
+        verified = g_key_file_get_int64 (mm_state_key_file_peek (&store, log_object), group, STORE_KEY_VERIFIED, NULL);
+        now = g_get_real_time () / G_USEC_PER_SEC;
+        if (verified <= 0 || verified > now || (now - verified) > PACED_MAX_AGE_SECS) {
+            mm_obj_dbg (log_object, "device %s per-byte pacing requirement needs to be learned again", group);
+            return FALSE;
+        }
+    }
+
+    *paced = value;
+    return TRUE;
+}
+
+void
+mm_send_delay_store_update (guint16  vid,
+                            guint16  pid,
+                            gboolean paced,
+                            gpointer log_object)
+{
+    g_autofree gchar *group = NULL;
+    gboolean          current;
+
+    /* Nothing to do if already known, unless it needs to be verified again */
+    if (!paced && mm_send_delay_store_lookup (vid, pid, &current, log_object) && current == paced)
+        return;
+
+    group = build_group_name (vid, pid);
+    g_key_file_set_boolean (mm_state_key_file_peek (&store, log_object), group, STORE_KEY_PACED, paced);
+    if (paced)
+        g_key_file_set_int64 (mm_state_key_file_peek (&store, log_object), group, STORE_KEY_VERIFIED,
+                              g_get_real_time () / G_USEC_PER_SEC);
+    else
+        g_key_file_remove_key (mm_state_key_file_peek (&store, log_object), group, STORE_KEY_VERIFIED, NULL);
+    mm_obj_dbg (log_object, "device %s %s per-byte pacing when sending AT commands",
+                group, paced ? "requires" : "doesn't require");
+    mm_state_key_file_save (&store, log_object);
+}
@@ -0,0 +1,33 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_SEND_DELAY_STORE_H
+#define MM_SEND_DELAY_STORE_H
+
+#include <glib.h>
+
+/* Persistent record of whether the AT ports of a given device (by vid:pid)
+ * need per-byte pacing when sending commands, as learned while probing in
+ * adaptive send delay mode. Devices requiring pacing are only reported as
+ * such for some days after it was last learned, so that it's verified again. */
+
+gboolean mm_send_delay_store_lookup (guint16   vid,
+                                     guint16   pid,
+                                     gboolean *paced,
+                                     gpointer  log_object);
+void     mm_send_delay_store_update (guint16   vid,
+                                     guint16   pid,
+                                     gboolean  paced,
+                                     gpointer  log_object);
+
+#endif /* MM_SEND_DELAY_STORE_H */
@@ -0,0 +1,131 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <string.h>
+
+#include "mm-serial-buffer.h"
+
+MMSerialBuffer *
+mm_serial_buffer_new (guint capacity)
+{
+    MMSerialBuffer *self;
+
+    g_return_val_if_fail (capacity > 0, NULL);
+
+    self = g_slice_new0 (MMSerialBuffer);
+    self->capacity = capacity;
+    self->storage = g_malloc (capacity);
+    self->data = self->storage;
+    return self;
+}
+
+void
+mm_serial_buffer_free (MMSerialBuffer *self)
+{
+    if (!self)
+        return;
+
+    g_free (self->storage);
+    g_slice_free (MMSerialBuffer, self);
+}
+
+void
+mm_serial_buffer_append (MMSerialBuffer *self,
+                         const guint8   *data,
+                         guint           len)
+{
+    guint offset;
+
+    g_return_if_fail (self != NULL);
+
+    if (!len)
+        return;
+
+    offset = self->data - self->storage;
+
+    /* Not enough room at the end? */
+    if ((self->capacity - offset - self->len) < len) {
+        /* Only move the pending data back to the beginning of the storage if
+         * that leaves at least half of it free; otherwise grow it, so that
+         * the amount of data moved around is always bound by the amount of
+         * data consumed. */
+        if ((self->len + len) > (self->capacity / 2)) {
+            guint8 *storage;
+
+            while ((self->len + len) > (self->capacity / 2))
+                self->capacity *= 2;
+
+            storage = g_malloc (self->capacity);
+            memcpy (storage, self->data, self->len);
+            g_free (self->storage);
+            self->storage = storage;
+        } else
+            memmove (self->storage, self->data, self->len);
+        self->data = self->storage;
+    }
+
+    memcpy (&self->data[self->len], data, len);
+    self->len += len;
+}
+
+void
+mm_serial_buffer_consume (MMSerialBuffer *self,
+                          guint           len)
+{
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (len <= self->len);
+
+    if (!len)
+        return;
+
+    self->len -= len;
+    self->generation++;
+    /* Rewind the view if all consumed, so that we reuse the storage from the
+     * beginning without moving anything */
+    self->data = (self->len ? &self->data[len] : self->storage);
+}
+
+void
+mm_serial_buffer_truncate (MMSerialBuffer *self,
+                           guint           len)
+{
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (len <= self->len);
+
+    if (len == self->len)
+        return;
+
+    self->len = len;
+    self->generation++;
+    if (!self->len)
+        self->data = self->storage;
+}
+
+void
+mm_serial_buffer_clear (MMSerialBuffer *self)
+{
+    g_return_if_fail (self != NULL);
+
+    if (self->len)
+        self->generation++;
+    self->len = 0;
+    self->data = self->storage;
+}
+
+guint
+mm_serial_buffer_get_generation (MMSerialBuffer *self)
+{
+    g_return_val_if_fail (self != NULL, 0);
+
+    return self->generation;
+}
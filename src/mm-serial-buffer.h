@@ -0,0 +1,63 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_SERIAL_BUFFER_H
+#define MM_SERIAL_BUFFER_H
+
+#include <glib.h>
+
+/* Buffer of data read from a serial port.
+ *
+ * Data is always appended at the end and consumed from the front. Consuming
+ * data from the front is O(1), as it just moves the start of the view; the
+ * pending data is only moved back to the beginning of the storage when
+ * there's no room left at the end of it.
+ *
+ * The 'data' and 'len' fields give a contiguous view of the pending data, in
+ * the same way as a GByteArray does, so that parsers can run directly on it.
+ *
+ * The buffer generation changes every time pending data is removed, so users
+ * can tell whether the data they already looked at is still the same.
+ */
+typedef struct {
+    guint8 *data;
+    guint   len;
+
+    /*< private >*/
+    guint8 *storage;
+    guint   capacity;
+    guint   generation;
+} MMSerialBuffer;
+
+MMSerialBuffer *mm_serial_buffer_new      (guint           capacity);
+void            mm_serial_buffer_free     (MMSerialBuffer *self);
+
+void            mm_serial_buffer_append   (MMSerialBuffer *self,
+                                           const guint8   *data,
+                                           guint           len);
+
+/* Remove the given amount of bytes from the front of the buffer */
+void            mm_serial_buffer_consume  (MMSerialBuffer *self,
+                                           guint           len);
+
+/* Keep just the given amount of bytes in the front of the buffer */
+void            mm_serial_buffer_truncate (MMSerialBuffer *self,
+                                           guint           len);
+
+void            mm_serial_buffer_clear    (MMSerialBuffer *self);
+
+guint           mm_serial_buffer_get_generation (MMSerialBuffer *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MMSerialBuffer, mm_serial_buffer_free)
+
+#endif /* MM_SERIAL_BUFFER_H */
@@ -0,0 +1,343 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <glib/gstdio.h>
+
+#include <ModemManager.h>
+#include <mm-errors-types.h>
+
+#include "mm-serial-capture.h"
+
+#define CAPTURE_MAGIC       "MMSCAP"
+#define CAPTURE_MAGIC_LEN   6
+#define CAPTURE_VERSION     1
+#define CAPTURE_HEADER_LEN  (CAPTURE_MAGIC_LEN + 2)
+#define RECORD_HEADER_LEN   (8 + 1 + 4)
+
+struct _MMSerialCapture {
+    gchar   *path;
+    gchar   *rotated_path;
+    guint64  max_size;
+    gint     fd;
+    guint64  size;
+};
+
+/*****************************************************************************/
+
+static gboolean
+capture_write_all (MMSerialCapture *self,
+                   struct iovec    *iov,
+                   guint            n_iov)
+{
+    while (n_iov > 0) {
+        gssize written;
+
+        written = writev (self->fd, iov, n_iov);
+        if (written < 0) {
+            if (errno == EINTR)
+                continue;
+            return FALSE;
+        }
+        self->size += written;
+
+        /* Skip whatever was fully written, and retry with the rest */
+        while (n_iov > 0 && (gsize) written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            n_iov--;
+        }
+        if (n_iov > 0) {
+            iov->iov_base = (guint8 *) iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+    return TRUE;
+}
+
+static gint
+capture_open (MMSerialCapture  *self,
+              gint              extra_flags,
+              GError          **error)
+{
+    struct stat st;
+
+    self->fd = open (self->path,
+                     O_CREAT | O_APPEND | O_WRONLY | O_CLOEXEC | extra_flags,
+                     S_IRUSR | S_IWUSR | S_IRGRP);
+    if (self->fd < 0) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "Couldn't open capture file '%s': (%d) %s",
+                     self->path, errno, strerror (errno));
+        return -1;
+    }
+
+    self->size = (fstat (self->fd, &st) == 0) ? (guint64) st.st_size : 0;
+
+    /* New files get the header; existing ones are appended to as they are */
+    if (!self->size) {
+        guint8       header[CAPTURE_HEADER_LEN];
+        guint16      version;
+        struct iovec iov;
+
+        memcpy (header, CAPTURE_MAGIC, CAPTURE_MAGIC_LEN);
+        version = GUINT16_TO_LE (CAPTURE_VERSION);
+        memcpy (&header[CAPTURE_MAGIC_LEN], &version, 2);
+        iov.iov_base = header;
+        iov.iov_len = sizeof (header);
+        capture_write_all (self, &iov, 1);
+    }
+
+    return self->fd;
+}
+
+static void
+capture_rotate (MMSerialCapture *self)
+{
+    close (self->fd);
+
+    /* If renaming fails, just start over in the same file */
+    g_rename (self->path, self->rotated_path);
+    capture_open (self, O_TRUNC, NULL);
+}
+
+void
+mm_serial_capture_append (MMSerialCapture          *self,
+                          MMSerialCaptureDirection  direction,
+                          const guint8             *data,
+                          gsize                     len)
+{
+    guint8       header[RECORD_HEADER_LEN];
+    guint64      timestamp;
+    guint32      length;
+    struct iovec iov[2];
+
+    /* Errors writing the capture are silently ignored; the capture is only
+     * a debugging aid and must never affect the port operation */
+    if (self->fd < 0 || len > G_MAXUINT32)
+        return;
+
+    if (self->max_size && (self->size + RECORD_HEADER_LEN + len > self->max_size) &&
+        (self->size > CAPTURE_HEADER_LEN)) {
+        capture_rotate (self);
+        if (self->fd < 0)
+            return;
+    }
+
+    timestamp = GUINT64_TO_LE ((guint64) g_get_real_time ());
+    length = GUINT32_TO_LE ((guint32) len);
+    memcpy (&header[0], &timestamp, 8);
+    header[8] = (guint8) direction;
+    memcpy (&header[9], &length, 4);
+
+    iov[0].iov_base = header;
+    iov[0].iov_len = sizeof (header);
+    iov[1].iov_base = (gpointer) data;
+    iov[1].iov_len = len;
+    capture_write_all (self, iov, len ? 2 : 1);
+}
+
+/*****************************************************************************/
+
+MMSerialCapture *
+mm_serial_capture_new (const gchar  *path,
+                       guint64       max_size,
+                       GError      **error)
+{
+    MMSerialCapture *self;
+
+    self = g_slice_new0 (MMSerialCapture);
+    self->path = g_strdup (path);
+    self->rotated_path = g_strdup_printf ("%s.1", path);
+    self->max_size = max_size;
+
+    if (capture_open (self, 0, error) < 0) {
+        mm_serial_capture_free (self);
+        return NULL;
+    }
+    return self;
+}
+
+void
+mm_serial_capture_free (MMSerialCapture *self)
+{
+    if (self->fd >= 0)
+        close (self->fd);
+    g_free (self->rotated_path);
+    g_free (self->path);
+    g_slice_free (MMSerialCapture, self);
+}
+
+/*****************************************************************************/
+
+static gchar    *capture_dir;
+static gchar   **capture_port_names;
+static guint64   capture_max_size;
+
+void
+mm_serial_capture_setup (const gchar *dir,
+                         const gchar *port_names,
+                         guint64      max_size)
+{
+    g_clear_pointer (&capture_dir, g_free);
+    g_clear_pointer (&capture_port_names, g_strfreev);
+
+    capture_dir = g_strdup (dir);
+    capture_max_size = max_size;
+    if (port_names && port_names[0]) {
+        guint i;
+
+        capture_port_names = g_strsplit (port_names, ",", -1);
+        for (i = 0; capture_port_names[i]; i++)
+            g_strstrip (capture_port_names[i]);
+    }
+}
+
+MMSerialCapture *
+mm_serial_capture_new_for_port (const gchar  *port_name,
+                                GError      **error)
+{
+    g_autofree gchar *filename = NULL;
+    g_autofree gchar *path = NULL;
+
+    if (!capture_dir)
+        return NULL;
+
+    if (capture_port_names && !g_strv_contains ((const gchar * const *) capture_port_names, port_name))
+        return NULL;
+
+    /* Port names of unix socket based ports may be paths */
+    filename = g_strdup_printf ("%s.mmcap", port_name);
+    g_strdelimit (filename, G_DIR_SEPARATOR_S, '_');
+    path = g_build_filename (capture_dir, filename, NULL);
+
+    return mm_serial_capture_new (path, capture_max_size, error);
+}
+
+/*****************************************************************************/
+
+struct _MMSerialCaptureReader {
+    GMappedFile  *file;
+    const guint8 *data;
+    gsize         len;
+    gsize         offset;
+};
+
+MMSerialCaptureReader *
+mm_serial_capture_reader_new (const gchar  *path,
+                              GError      **error)
+{
+    g_autoptr(GMappedFile)  file = NULL;
+    MMSerialCaptureReader  *self;
+    const guint8           *data;
+    gsize                   len;
+    guint16                 version;
+
+    file = g_mapped_file_new (path, FALSE, error);
+    if (!file)
+        return NULL;
+
+    data = (const guint8 *) g_mapped_file_get_contents (file);
+    len = g_mapped_file_get_length (file);
+    if (len < CAPTURE_HEADER_LEN || memcmp (data, CAPTURE_MAGIC, CAPTURE_MAGIC_LEN) != 0) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_INVALID_ARGS,
+                     "Not a serial capture file: '%s'", path);
+        return NULL;
+    }
+
+    memcpy (&version, &data[CAPTURE_MAGIC_LEN], 2);
+    if (GUINT16_FROM_LE (version) != CAPTURE_VERSION) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_UNSUPPORTED,
+                     "Unsupported serial capture file version: %u", GUINT16_FROM_LE (version));
+        return NULL;
+    }
+
+    self = g_slice_new0 (MMSerialCaptureReader);
+    self->file = g_steal_pointer (&file);
+    self->data = data;
+    self->len = len;
+    self->offset = CAPTURE_HEADER_LEN;
+    return self;
+}
+
+void
+mm_serial_capture_reader_free (MMSerialCaptureReader *self)
+{
+    g_mapped_file_unref (self->file);
+    g_slice_free (MMSerialCaptureReader, self);
+}
+
+void
+mm_serial_capture_reader_rewind (MMSerialCaptureReader *self)
+{
+    self->offset = CAPTURE_HEADER_LEN;
+}
+
+gboolean
+mm_serial_capture_reader_next (MMSerialCaptureReader     *self,
+                               gint64                    *timestamp,
+                               MMSerialCaptureDirection  *direction,
+                               const guint8             **data,
+                               gsize                     *len,
+                               GError                   **error)
+{
+    const guint8 *record;
+    guint64       record_timestamp;
+    guint32       record_len;
+
+    if (self->offset == self->len)
+        return FALSE;
+
+    if (self->len - self->offset < RECORD_HEADER_LEN) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "Truncated record header at offset %" G_GSIZE_FORMAT, self->offset);
+        return FALSE;
+    }
+
+    record = &self->data[self->offset];
+    memcpy (&record_timestamp, &record[0], 8);
+    memcpy (&record_len, &record[9], 4);
+    record_len = GUINT32_FROM_LE (record_len);
+
+    if (record[8] > MM_SERIAL_CAPTURE_DIRECTION_WRITE) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "Invalid record direction at offset %" G_GSIZE_FORMAT, self->offset);
+        return FALSE;
+    }
+
+    if (self->len - self->offset - RECORD_HEADER_LEN < record_len) {
+        g_set_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED,
+                     "Truncated record data at offset %" G_GSIZE_FORMAT, self->offset);
+        return FALSE;
+    }
+
+    if (timestamp)
+        *timestamp = (gint64) GUINT64_FROM_LE (record_timestamp);
+    if (direction)
+        *direction = (MMSerialCaptureDirection) record[8];
+    if (data)
+        *data = &record[RECORD_HEADER_LEN];
+    if (len)
+        *len = record_len;
+
+    self->offset += RECORD_HEADER_LEN + record_len;
+    return TRUE;
+}
@@ -0,0 +1,85 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_SERIAL_CAPTURE_H
+#define MM_SERIAL_CAPTURE_H
+
+#include <glib.h>
+
+/* Binary capture of the raw data read from and written to a serial port.
+ *
+ * The capture file starts with an 8-byte header ("MMSCAP" followed by the
+ * format version as a 16-bit little endian integer), and then one record per
+ * read or write operation:
+ *
+ *   - timestamp: 64-bit little endian, microseconds since the epoch
+ *   - direction: 8-bit, see MMSerialCaptureDirection
+ *   - length:    32-bit little endian
+ *   - data:      'length' bytes, as read or written
+ *
+ * Records are only ever appended. If a maximum size (in bytes) is given, the
+ * file is rotated to '<path>.1' before it would go over it, and the new file
+ * starts with its own header. */
+
+typedef enum {
+    MM_SERIAL_CAPTURE_DIRECTION_READ  = 0,
+    MM_SERIAL_CAPTURE_DIRECTION_WRITE = 1,
+} MMSerialCaptureDirection;
+
+typedef struct _MMSerialCapture MMSerialCapture;
+
+MMSerialCapture *mm_serial_capture_new    (const gchar               *path,
+                                           guint64                    max_size,
+                                           GError                   **error);
+void             mm_serial_capture_free   (MMSerialCapture           *self);
+
+void             mm_serial_capture_append (MMSerialCapture           *self,
+                                           MMSerialCaptureDirection   direction,
+                                           const guint8              *data,
+                                           gsize                      len);
+
+/* Capture setup for all serial ports. When a directory is given, ports whose
+ * name is in the given list (or all of them, if no list is given) are captured
+ * to '<dir>/<port name>.mmcap' while open. */
+void             mm_serial_capture_setup             (const gchar  *dir,
+                                                      const gchar  *port_names,
+                                                      guint64       max_size);
+/* Returns NULL without error if the port isn't captured */
+MMSerialCapture *mm_serial_capture_new_for_port      (const gchar  *port_name,
+                                                      GError      **error);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MMSerialCapture, mm_serial_capture_free)
+
+/*****************************************************************************/
+/* Capture reader */
+
+typedef struct _MMSerialCaptureReader MMSerialCaptureReader;
+
+MMSerialCaptureReader *mm_serial_capture_reader_new  (const gchar               *path,
+                                                      GError                   **error);
+void                   mm_serial_capture_reader_free (MMSerialCaptureReader     *self);
+
+/* Returns FALSE with no error once the end of the capture is reached. The
+ * returned data is owned by the reader, and valid as long as it exists. */
+gboolean               mm_serial_capture_reader_next (MMSerialCaptureReader     *self,
+                                                      gint64                    *timestamp,
+                                                      MMSerialCaptureDirection  *direction,
+                                                      const guint8             **data,
+                                                      gsize                     *len,
+                                                      GError                   **error);
+
+void                   mm_serial_capture_reader_rewind (MMSerialCaptureReader   *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MMSerialCaptureReader, mm_serial_capture_reader_free)
+
+#endif /* MM_SERIAL_CAPTURE_H */
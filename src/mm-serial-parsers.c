@@ -50,81 +50,349 @@ response_clean (GString *response)
 }
 
 
+/*****************************************************************************/
+/* Final result code scanner
+ *
+ * The response is split in lines delimited by <CR><LF>, and every line is
+ * matched once against a small table of known final result codes. This
+ * replaces the cascade of regular expressions that used to be run over the
+ * whole response buffer, keeping the same precedence order among the
+ * different result codes.
+ */
+
+typedef enum {
+    FINAL_RESULT_OK,
+    FINAL_RESULT_CONNECT,
+    FINAL_RESULT_SMS_PROMPT,
+    FINAL_RESULT_CME_ERROR,
+    FINAL_RESULT_CMS_ERROR,
+    FINAL_RESULT_CME_ERROR_STR,
+    FINAL_RESULT_CMS_ERROR_STR,
+    FINAL_RESULT_EZX_ERROR,
+    FINAL_RESULT_UNKNOWN_ERROR,
+    FINAL_RESULT_CONNECT_FAILED,
+    FINAL_RESULT_NA,
+    FINAL_RESULT_NONE
+} FinalResult;
+
+typedef enum {
+    LINE_MATCH_EXACT,     /* whole line, <CR><LF> terminated */
+    LINE_MATCH_PREFIX,    /* line start, not necessarily terminated */
+    LINE_MATCH_COMPLETE,  /* line start, <CR><LF> terminated */
+    LINE_MATCH_SUFFIX,    /* line end, <CR><LF> terminated, may be the first line */
+} LineMatch;
+
+typedef struct {
+    const gchar *token;
+    guint        token_len;
+    LineMatch    match;
+    FinalResult  result;
+    guint        code; /* MMConnectionError for connection failures */
+} FinalResultToken;
+
+#define TOKEN(str) str, sizeof (str) - 1
+
+static const FinalResultToken final_result_tokens[] = {
+    { TOKEN ("OK"),                  LINE_MATCH_EXACT,    FINAL_RESULT_OK,             0 },
+    { TOKEN ("CONNECT"),             LINE_MATCH_COMPLETE, FINAL_RESULT_CONNECT,        0 },
+    { TOKEN ("+CME ERROR:"),         LINE_MATCH_COMPLETE, FINAL_RESULT_CME_ERROR,      0 },
+    { TOKEN ("+CMS ERROR:"),         LINE_MATCH_COMPLETE, FINAL_RESULT_CMS_ERROR,      0 },
+    /* Motorola EZX errors */
+    { TOKEN ("MODEM ERROR:"),        LINE_MATCH_COMPLETE, FINAL_RESULT_EZX_ERROR,      0 },
+    { TOKEN ("ERROR"),               LINE_MATCH_PREFIX,   FINAL_RESULT_UNKNOWN_ERROR,  0 },
+    { TOKEN ("COMMAND NOT SUPPORT"), LINE_MATCH_SUFFIX,   FINAL_RESULT_UNKNOWN_ERROR,  0 },
+    { TOKEN ("NO CARRIER"),          LINE_MATCH_PREFIX,   FINAL_RESULT_CONNECT_FAILED, MM_CONNECTION_ERROR_NO_CARRIER },
+    { TOKEN ("BUSY"),                LINE_MATCH_PREFIX,   FINAL_RESULT_CONNECT_FAILED, MM_CONNECTION_ERROR_BUSY },
+    { TOKEN ("NO ANSWER"),           LINE_MATCH_PREFIX,   FINAL_RESULT_CONNECT_FAILED, MM_CONNECTION_ERROR_NO_ANSWER },
+    { TOKEN ("NO DIALTONE"),         LINE_MATCH_PREFIX,   FINAL_RESULT_CONNECT_FAILED, MM_CONNECTION_ERROR_NO_DIALTONE },
+    /* Samsung Z810 may reply "NA" to report a not-available error */
+    { TOKEN ("NA"),                  LINE_MATCH_EXACT,    FINAL_RESULT_NA,             0 },
+};
+
+#undef TOKEN
+
+typedef struct {
+    FinalResult  result;
+    /* Value reported after the result code, if any (not NUL-terminated) */
+    const gchar *value;
+    gsize        value_len;
+    guint        code;
+} FinalResultMatch;
+
 static gboolean
-remove_eval_cb (const GMatchInfo *match_info,
-                GString *result,
-                gpointer user_data)
+is_blank (gchar c)
 {
-    int *result_len = (int *) user_data;
-    int start;
-    int end;
+    return (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v');
+}
 
-    if (g_match_info_fetch_pos  (match_info, 0, &start, &end))
-        *result_len -= (end - start);
+/* Classifies the value given after a '+CME ERROR:', '+CMS ERROR:' or
+ * 'MODEM ERROR:' prefix: either a numeric code, a string, or nothing. */
+static FinalResult
+classify_error_value (const FinalResultToken *token,
+                      const gchar            *value,
+                      gsize                   value_len,
+                      const gchar           **out_value,
+                      gsize                  *out_value_len)
+{
+    gsize i = 0;
+    gsize j;
 
-    return TRUE;
+    while (i < value_len && is_blank (value[i]))
+        i++;
+
+    for (j = i; j < value_len && g_ascii_isdigit (value[j]); j++);
+    if (j > i && j == value_len) {
+        *out_value = &value[i];
+        *out_value_len = j - i;
+        return token->result;
+    }
+
+    /* Motorola EZX errors are only numeric */
+    if (token->result == FINAL_RESULT_EZX_ERROR || !value_len)
+        return FINAL_RESULT_NONE;
+
+    if (i == value_len) {
+        /* If there is only whitespace, the last whitespace char is the value */
+        i--;
+        if (value[i] == '\r' || value[i] == '\n')
+            return FINAL_RESULT_NONE;
+    } else if (memchr (&value[i], '\r', value_len - i) || memchr (&value[i], '\n', value_len - i))
+        return FINAL_RESULT_NONE;
+
+    *out_value = &value[i];
+    *out_value_len = value_len - i;
+    return (token->result == FINAL_RESULT_CME_ERROR ? FINAL_RESULT_CME_ERROR_STR : FINAL_RESULT_CMS_ERROR_STR);
+}
+
+static FinalResult
+scan_line (const gchar  *line,
+           gsize         line_len,
+           gboolean      line_start,
+           gboolean      terminated,
+           const gchar **value,
+           gsize        *value_len,
+           guint        *code)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (final_result_tokens); i++) {
+        const FinalResultToken *token = &final_result_tokens[i];
+
+        if (line_len < token->token_len)
+            continue;
+
+        if (token->match == LINE_MATCH_SUFFIX) {
+            if (terminated &&
+                line[line_len - 1] == token->token[token->token_len - 1] &&
+                !memcmp (&line[line_len - token->token_len], token->token, token->token_len)) {
+                *code = token->code;
+                return token->result;
+            }
+            continue;
+        }
+
+        /* Cheap first-char check before comparing the whole token */
+        if (!line_start || line[0] != token->token[0])
+            continue;
+        if (memcmp (line, token->token, token->token_len) != 0)
+            continue;
+
+        switch (token->match) {
+        case LINE_MATCH_EXACT:
+            if (!terminated || line_len != token->token_len)
+                continue;
+            break;
+        case LINE_MATCH_COMPLETE:
+            if (!terminated)
+                continue;
+            break;
+        case LINE_MATCH_PREFIX:
+        case LINE_MATCH_SUFFIX:
+        default:
+            break;
+        }
+
+        /* The CONNECT line may have any suffix, but never a <LF> */
+        if (token->result == FINAL_RESULT_CONNECT && memchr (line, '\n', line_len))
+            continue;
+
+        if (token->result == FINAL_RESULT_CME_ERROR ||
+            token->result == FINAL_RESULT_CMS_ERROR ||
+            token->result == FINAL_RESULT_EZX_ERROR) {
+            FinalResult result;
+
+            result = classify_error_value (token,
+                                           &line[token->token_len],
+                                           line_len - token->token_len,
+                                           value,
+                                           value_len);
+            if (result == FINAL_RESULT_NONE)
+                continue;
+            return result;
+        }
+
+        *code = token->code;
+        return token->result;
+    }
+
+    return FINAL_RESULT_NONE;
+}
+
+/* SMS prompt: '<CR><LF>>' followed only by whitespace until the end */
+static gboolean
+scan_sms_prompt (const gchar *str,
+                 gsize        len)
+{
+    while (len > 0 && is_blank (str[len - 1]))
+        len--;
+    return (len >= 3 && str[len - 1] == '>' && str[len - 2] == '\n' && str[len - 3] == '\r');
 }
 
+/* Lines before 'from' must be already known not to have any final result
+ * code; the offset of the last line, which isn't <CR><LF> terminated yet, is
+ * given in 'last_line', so that the scan can be resumed from there once more
+ * data is received. */
 static void
-remove_matches (GRegex *r, GString *string)
+scan_final_result (const gchar      *str,
+                   gsize             len,
+                   gsize             from,
+                   FinalResultMatch *match,
+                   gsize            *last_line)
 {
-    char *str;
-    int result_len = string->len;
+    const gchar *line;
+    const gchar *end;
+    gboolean     line_start;
+
+    match->result = FINAL_RESULT_NONE;
+    match->value = NULL;
+    match->value_len = 0;
+    match->code = 0;
+
+    end = str + len;
+    line = str + from;
+    line_start = (from > 0);
+    *last_line = from;
+    while (line <= end) {
+        const gchar *eol;
+        const gchar *lf;
+        gboolean     terminated = FALSE;
+        FinalResult  result;
+        const gchar *value = NULL;
+        gsize        value_len = 0;
+        guint        code = 0;
+
+        /* Look for the next <CR><LF> */
+        eol = end;
+        for (lf = line; lf < end && (lf = memchr (lf, '\n', end - lf)) != NULL; lf++) {
+            if (lf > line && *(lf - 1) == '\r') {
+                eol = lf - 1;
+                terminated = TRUE;
+                break;
+            }
+        }
 
-    str = g_regex_replace_eval (r, string->str, string->len, 0, 0,
-                                remove_eval_cb, &result_len, NULL);
+        result = scan_line (line, eol - line, line_start, terminated, &value, &value_len, &code);
+        if (result < match->result) {
+            match->result = result;
+            match->value = value;
+            match->value_len = value_len;
+            match->code = code;
+            /* Nothing has more precedence than OK */
+            if (result == FINAL_RESULT_OK)
+                return;
+        }
 
-    g_string_truncate (string, 0);
-    g_string_append_len (string, str, result_len);
-    g_free (str);
+        if (!terminated) {
+            *last_line = line - str;
+            break;
+        }
+        line = eol + 2;
+        line_start = TRUE;
+    }
+
+    if (match->result > FINAL_RESULT_SMS_PROMPT && scan_sms_prompt (str, len))
+        match->result = FINAL_RESULT_SMS_PROMPT;
 }
 
+gsize
+mm_serial_parser_v1_find_response_end (const gchar *str,
+                                       gsize        len)
+{
+    const gchar *line;
+    const gchar *end;
+    gboolean     line_start = FALSE;
+
+    end = str + len;
+    line = str;
+    while (line < end) {
+        const gchar *lf;
+        const gchar *value = NULL;
+        gsize        value_len = 0;
+        guint        code = 0;
+
+        /* Look for the next <CR><LF>; only terminated lines are considered */
+        for (lf = line; lf < end && (lf = memchr (lf, '\n', end - lf)) != NULL; lf++) {
+            if (lf > line && *(lf - 1) == '\r')
+                break;
+        }
+        if (!lf || lf >= end)
+            break;
+
+        if (scan_line (line, lf - 1 - line, line_start, TRUE, &value, &value_len, &code) != FINAL_RESULT_NONE)
+            return (lf + 1) - str;
+
+        line = lf + 1;
+        line_start = TRUE;
+    }
+
+    return 0;
+}
+
+/* Remove every '<CR><LF>OK' and the <CR><LF>s following it, in place */
+static void
+remove_ok (GString *response)
+{
+    gsize r = 0;
+    gsize w = 0;
+
+    while (r < response->len) {
+        if ((response->len - r) >= 6 && !memcmp (&response->str[r], "\r\nOK\r\n", 6)) {
+            r += 4;
+            while ((response->len - r) >= 2 && response->str[r] == '\r' && response->str[r + 1] == '\n')
+                r += 2;
+            continue;
+        }
+        response->str[w++] = response->str[r++];
+    }
+
+    g_string_truncate (response, w);
+}
+
+/*****************************************************************************/
+
 typedef struct {
-    /* Regular expressions for successful replies */
-    GRegex *regex_ok;
-    GRegex *regex_connect;
-    GRegex *regex_sms;
+    /* Regular expressions for custom replies */
     GRegex *regex_custom_successful;
-    /* Regular expressions for error replies */
-    GRegex *regex_cme_error;
-    GRegex *regex_cms_error;
-    GRegex *regex_cme_error_str;
-    GRegex *regex_cms_error_str;
-    GRegex *regex_ezx_error;
-    GRegex *regex_unknown_error;
-    GRegex *regex_connect_failed;
-    GRegex *regex_na;
     GRegex *regex_custom_error;
     /* User-provided parser filter */
     mm_serial_parser_v1_filter_fn filter_callback;
     gpointer                      filter_user_data;
+    /* Offset of the first line not scanned yet in the last response */
+    gsize                         scan_offset;
 } MMSerialParserV1;
 
 gpointer
 mm_serial_parser_v1_new (void)
 {
     MMSerialParserV1 *parser;
-    GRegexCompileFlags flags = G_REGEX_DOLLAR_ENDONLY | G_REGEX_RAW | G_REGEX_OPTIMIZE;
 
     parser = g_slice_new (MMSerialParserV1);
 
-    parser->regex_ok = g_regex_new ("\\r\\nOK(\\r\\n)+", flags, 0, NULL);
-    parser->regex_connect = g_regex_new ("\\r\\nCONNECT.*\\r\\n", flags, 0, NULL);
-    parser->regex_sms = g_regex_new ("\\r\\n>\\s*$", flags, 0, NULL);
-    parser->regex_cme_error = g_regex_new ("\\r\\n\\+CME ERROR:\\s*(\\d+)\\r\\n", flags, 0, NULL);
-    parser->regex_cms_error = g_regex_new ("\\r\\n\\+CMS ERROR:\\s*(\\d+)\\r\\n", flags, 0, NULL);
-    parser->regex_cme_error_str = g_regex_new ("\\r\\n\\+CME ERROR:\\s*([^\\n\\r]+)\\r\\n", flags, 0, NULL);
-    parser->regex_cms_error_str = g_regex_new ("\\r\\n\\+CMS ERROR:\\s*([^\\n\\r]+)\\r\\n", flags, 0, NULL);
-    parser->regex_ezx_error = g_regex_new ("\\r\\n\\MODEM ERROR:\\s*(\\d+)\\r\\n", flags, 0, NULL);
-    parser->regex_unknown_error = g_regex_new ("\\r\\n(ERROR)|(COMMAND NOT SUPPORT)\\r\\n", flags, 0, NULL);
-    parser->regex_connect_failed = g_regex_new ("\\r\\n(NO CARRIER)|(BUSY)|(NO ANSWER)|(NO DIALTONE)\\r\\n", flags, 0, NULL);
-    /* Samsung Z810 may reply "NA" to report a not-available error */
-    parser->regex_na = g_regex_new ("\\r\\nNA\\r\\n", flags, 0, NULL);
-
     parser->regex_custom_successful = NULL;
     parser->regex_custom_error = NULL;
     parser->filter_callback = NULL;
     parser->filter_user_data = NULL;
+    parser->scan_offset = 0;
 
     return parser;
 }
@@ -163,21 +431,30 @@ mm_serial_parser_v1_add_filter (gpointer data,
 gboolean
 mm_serial_parser_v1_parse (gpointer   data,
                            GString   *response,
+                           gsize      unchanged_len,
                            gpointer   log_object,
                            GError   **error)
 {
     MMSerialParserV1 *parser = (MMSerialParserV1 *) data;
-    GMatchInfo *match_info;
-    GError *local_error = NULL;
-    gboolean found = FALSE;
-    char *str = NULL;
+    FinalResultMatch  match;
+    GError           *local_error = NULL;
+    gchar            *str = NULL;
+    gsize             scan_from;
 
     g_return_val_if_fail (parser != NULL, FALSE);
     g_return_val_if_fail (response != NULL, FALSE);
 
+    /* Resume the scan where the previous one stopped, as long as the data
+     * scanned back then hasn't changed */
+    scan_from = (parser->scan_offset <= MIN (unchanged_len, response->len)) ? parser->scan_offset : 0;
+    parser->scan_offset = 0;
+
     /* Skip NUL bytes if they are found leading the response */
-    while (response->len > 0 && response->str[0] == '\0')
-        g_string_erase (response, 0, 1);
+    if (response->len > 0 && response->str[0] == '\0') {
+        while (response->len > 0 && response->str[0] == '\0')
+            g_string_erase (response, 0, 1);
+        scan_from = 0;
+    }
 
     if (G_UNLIKELY (!response->len))
         return FALSE;
@@ -195,178 +472,83 @@ mm_serial_parser_v1_parse (gpointer   data,
         return TRUE;
     }
 
-    /* Then, check for successful responses */
-
-    /* Custom successful replies first, if any */
-    if (parser->regex_custom_successful) {
-        found = g_regex_match_full (parser->regex_custom_successful,
-                                    response->str, response->len,
-                                    0, 0, NULL, NULL);
-    }
-
-    if (!found) {
-        found = g_regex_match_full (parser->regex_ok,
-                                    response->str, response->len,
-                                    0, 0, NULL, NULL);
-        if (found)
-            remove_matches (parser->regex_ok, response);
-    }
+    /* Look for a standard final result code in a single pass */
+    scan_final_result (response->str, response->len, scan_from, &match, &parser->scan_offset);
 
-    if (!found) {
-        found = g_regex_match_full (parser->regex_connect,
-                                    response->str, response->len,
-                                    0, 0, NULL, NULL);
-    }
-
-    if (!found) {
-        found = g_regex_match_full (parser->regex_sms,
-                                    response->str, response->len,
-                                    0, 0, NULL, NULL);
-    }
-
-    if (found) {
+    switch (match.result) {
+    case FINAL_RESULT_OK:
+        remove_ok (response);
+        /* fall through */
+    case FINAL_RESULT_CONNECT:
+    case FINAL_RESULT_SMS_PROMPT:
+        parser->scan_offset = 0;
         response_clean (response);
         return TRUE;
-    }
-
-    /* Now failures */
-
-    /* Custom error matches first, if any */
-    if (parser->regex_custom_error) {
-        found = g_regex_match_full (parser->regex_custom_error,
-                                    response->str, response->len,
-                                    0, 0, &match_info, NULL);
-        if (found) {
-            str = g_match_info_fetch (match_info, 1);
-            g_assert (str);
-            local_error = mm_mobile_equipment_error_for_code (atoi (str), log_object);
-            goto done;
-        }
-        g_match_info_free (match_info);
-    }
-
-    /* Numeric CME errors */
-    found = g_regex_match_full (parser->regex_cme_error,
-                                response->str, response->len,
-                                0, 0, &match_info, NULL);
-    if (found) {
-        str = g_match_info_fetch (match_info, 1);
-        g_assert (str);
-        local_error = mm_mobile_equipment_error_for_code (atoi (str), log_object);
-        goto done;
-    }
-    g_match_info_free (match_info);
-
-    /* Numeric CMS errors */
-    found = g_regex_match_full (parser->regex_cms_error,
-                                response->str, response->len,
-                                0, 0, &match_info, NULL);
-    if (found) {
-        str = g_match_info_fetch (match_info, 1);
-        g_assert (str);
-        local_error = mm_message_error_for_code (atoi (str), log_object);
-        goto done;
-    }
-    g_match_info_free (match_info);
-
-    /* String CME errors */
-    found = g_regex_match_full (parser->regex_cme_error_str,
-                                response->str, response->len,
-                                0, 0, &match_info, NULL);
-    if (found) {
-        str = g_match_info_fetch (match_info, 1);
-        g_assert (str);
+    case FINAL_RESULT_CME_ERROR:
+        /* value is followed by <CR><LF>, so atoi() stops there */
+        local_error = mm_mobile_equipment_error_for_code (atoi (match.value), log_object);
+        break;
+    case FINAL_RESULT_CMS_ERROR:
+        local_error = mm_message_error_for_code (atoi (match.value), log_object);
+        break;
+    case FINAL_RESULT_CME_ERROR_STR:
+        str = g_strndup (match.value, match.value_len);
         local_error = mm_mobile_equipment_error_for_string (str, log_object);
-        goto done;
-    }
-    g_match_info_free (match_info);
-
-    /* String CMS errors */
-    found = g_regex_match_full (parser->regex_cms_error_str,
-                                response->str, response->len,
-                                0, 0, &match_info, NULL);
-    if (found) {
-        str = g_match_info_fetch (match_info, 1);
-        g_assert (str);
+        break;
+    case FINAL_RESULT_CMS_ERROR_STR:
+        str = g_strndup (match.value, match.value_len);
         local_error = mm_message_error_for_string (str, log_object);
-        goto done;
-    }
-    g_match_info_free (match_info);
-
-    /* Motorola EZX errors */
-    found = g_regex_match_full (parser->regex_ezx_error,
-                                response->str, response->len,
-                                0, 0, &match_info, NULL);
-    if (found) {
-        str = g_match_info_fetch (match_info, 1);
-        g_assert (str);
+        break;
+    case FINAL_RESULT_EZX_ERROR:
+    case FINAL_RESULT_UNKNOWN_ERROR:
         local_error = mm_mobile_equipment_error_for_code (MM_MOBILE_EQUIPMENT_ERROR_UNKNOWN, log_object);
-        goto done;
-    }
-    g_match_info_free (match_info);
-
-    /* Last resort; unknown error */
-    found = g_regex_match_full (parser->regex_unknown_error,
-                                response->str, response->len,
-                                0, 0, &match_info, NULL);
-    if (found) {
-        local_error = mm_mobile_equipment_error_for_code (MM_MOBILE_EQUIPMENT_ERROR_UNKNOWN, log_object);
-        goto done;
-    }
-    g_match_info_free (match_info);
-
-    /* Connection failures */
-    found = g_regex_match_full (parser->regex_connect_failed,
-                                response->str, response->len,
-                                0, 0, &match_info, NULL);
-    if (found) {
-        MMConnectionError code;
-
-        str = g_match_info_fetch (match_info, 1);
-        g_assert (str);
-
-        if (!strcmp (str, "NO CARRIER"))
-            code = MM_CONNECTION_ERROR_NO_CARRIER;
-        else if (!strcmp (str, "BUSY"))
-            code = MM_CONNECTION_ERROR_BUSY;
-        else if (!strcmp (str, "NO ANSWER"))
-            code = MM_CONNECTION_ERROR_NO_ANSWER;
-        else if (!strcmp (str, "NO DIALTONE"))
-            code = MM_CONNECTION_ERROR_NO_DIALTONE;
-        else {
-            /* uhm... make something up (yes, ok, lie!). */
-            code = MM_CONNECTION_ERROR_NO_CARRIER;
-        }
-
-        local_error = mm_connection_error_for_code (code, log_object);
-        goto done;
-    }
-    g_match_info_free (match_info);
-
-    /* NA error */
-    found = g_regex_match_full (parser->regex_na,
-                                response->str, response->len,
-                                0, 0, &match_info, NULL);
-    if (found) {
+        break;
+    case FINAL_RESULT_CONNECT_FAILED:
+        local_error = mm_connection_error_for_code ((MMConnectionError) match.code, log_object);
+        break;
+    case FINAL_RESULT_NA:
         /* Assume NA means 'Not Allowed' :) */
         local_error = g_error_new (MM_MOBILE_EQUIPMENT_ERROR,
                                    MM_MOBILE_EQUIPMENT_ERROR_NOT_ALLOWED,
                                    "Not Allowed");
-        goto done;
+        break;
+    case FINAL_RESULT_NONE:
+    default:
+        /* Custom replies only if no standard final result code found */
+        if (parser->regex_custom_successful &&
+            g_regex_match_full (parser->regex_custom_successful,
+                                response->str, response->len,
+                                0, 0, NULL, NULL)) {
+            parser->scan_offset = 0;
+            response_clean (response);
+            return TRUE;
+        }
+
+        if (parser->regex_custom_error) {
+            GMatchInfo *match_info = NULL;
+
+            if (g_regex_match_full (parser->regex_custom_error,
+                                    response->str, response->len,
+                                    0, 0, &match_info, NULL)) {
+                str = g_match_info_fetch (match_info, 1);
+                g_assert (str);
+                local_error = mm_mobile_equipment_error_for_code (atoi (str), log_object);
+            }
+            g_match_info_free (match_info);
+        }
+        break;
     }
 
-done:
     g_free (str);
-    g_match_info_free (match_info);
-    if (found)
-        response_clean (response);
 
-    if (local_error) {
-        mm_obj_dbg (log_object, "operation failure: %d (%s)", local_error->code, local_error->message);
-        g_propagate_error (error, local_error);
-    }
+    if (!local_error)
+        return FALSE;
 
-    return found;
+    parser->scan_offset = 0;
+    response_clean (response);
+    mm_obj_dbg (log_object, "operation failure: %d (%s)", local_error->code, local_error->message);
+    g_propagate_error (error, local_error);
+    return TRUE;
 }
 
 gboolean
@@ -386,18 +568,6 @@ mm_serial_parser_v1_destroy (gpointer data)
 
     g_return_if_fail (parser != NULL);
 
-    g_regex_unref (parser->regex_ok);
-    g_regex_unref (parser->regex_connect);
-    g_regex_unref (parser->regex_sms);
-    g_regex_unref (parser->regex_cme_error);
-    g_regex_unref (parser->regex_cms_error);
-    g_regex_unref (parser->regex_cme_error_str);
-    g_regex_unref (parser->regex_cms_error_str);
-    g_regex_unref (parser->regex_ezx_error);
-    g_regex_unref (parser->regex_unknown_error);
-    g_regex_unref (parser->regex_connect_failed);
-    g_regex_unref (parser->regex_na);
-
     if (parser->regex_custom_successful)
         g_regex_unref (parser->regex_custom_successful);
     if (parser->regex_custom_error)
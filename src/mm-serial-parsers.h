@@ -22,13 +22,23 @@ gpointer mm_serial_parser_v1_new                  (void);
 void     mm_serial_parser_v1_set_custom_regex     (gpointer data,
                                                    GRegex *successful,
                                                    GRegex *error);
+/* The first 'unchanged_len' bytes of the response must be the same ones given
+ * in the previous call, if it returned FALSE; the lines in there that were
+ * already scanned are not scanned again. Give 0 if unknown. */
 gboolean mm_serial_parser_v1_parse                (gpointer parser,
                                                    GString *response,
+                                                   gsize    unchanged_len,
                                                    gpointer log_object,
                                                    GError **error);
 void     mm_serial_parser_v1_destroy              (gpointer parser);
 gboolean mm_serial_parser_v1_is_known_error       (const GError *error);
 
+/* Length of the first response in the string, up to and including the first
+ * line with a final result code; or 0 if there is no such line yet. Used to
+ * split the responses to several commands sent at once. */
+gsize    mm_serial_parser_v1_find_response_end    (const gchar *str,
+                                                   gsize        len);
+
 /* Parser filter: when FALSE returned, error should be set. This error will be
  * reported to the response listener right away. */
 typedef gboolean (* mm_serial_parser_v1_filter_fn) (gpointer data,
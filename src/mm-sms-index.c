@@ -0,0 +1,283 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+
+#include "mm-sms-index.h"
+#include "mm-sms-part.h"
+
+struct _MMSmsIndex {
+    guint                  expiration_ms;
+    MMSmsIndexExpiredFunc  expired;
+    gpointer               user_data;
+    /* Entries of each item in the index */
+    GHashTable            *entries;
+    /* Multipart items, indexed by reference and number */
+    GHashTable            *multipart_index;
+    /* Items, indexed by storage and index of each of their parts */
+    GHashTable            *part_index;
+};
+
+typedef struct {
+    MMSmsIndex *self;
+    gpointer    item;
+    /* Keys under which the item is indexed */
+    gchar      *multipart_key;
+    GArray     *part_keys;
+    guint       expiration_id;
+} Entry;
+
+static void
+entry_free (Entry *entry)
+{
+    if (entry->expiration_id)
+        g_source_remove (entry->expiration_id);
+    g_array_unref (entry->part_keys);
+    g_free (entry->multipart_key);
+    g_slice_free (Entry, entry);
+}
+
+static gchar *
+build_multipart_key (guint        reference,
+                     const gchar *number)
+{
+    return g_strdup_printf ("%u/%s", reference, number ? number : "");
+}
+
+static gint64
+build_part_key (MMSmsStorage storage,
+                guint        index)
+{
+    return ((gint64) storage << 32) | index;
+}
+
+/*****************************************************************************/
+
+static void
+entry_clear_part_keys (Entry *entry)
+{
+    guint i;
+
+    for (i = 0; i < entry->part_keys->len; i++) {
+        gint64 *key;
+
+        key = &g_array_index (entry->part_keys, gint64, i);
+        if (g_hash_table_lookup (entry->self->part_index, key) == entry)
+            g_hash_table_remove (entry->self->part_index, key);
+    }
+    g_array_set_size (entry->part_keys, 0);
+}
+
+static void
+entry_add_part_key (Entry        *entry,
+                    MMSmsStorage  storage,
+                    guint         index)
+{
+    gint64 *key;
+
+    if (storage == MM_SMS_STORAGE_UNKNOWN || index == SMS_PART_INVALID_INDEX)
+        return;
+
+    key = g_new (gint64, 1);
+    *key = build_part_key (storage, index);
+    g_array_append_val (entry->part_keys, *key);
+    g_hash_table_replace (entry->self->part_index, key, entry);
+}
+
+static void
+entry_remove (Entry *entry)
+{
+    MMSmsIndex *self;
+
+    self = entry->self;
+    entry_clear_part_keys (entry);
+    if (entry->multipart_key &&
+        g_hash_table_lookup (self->multipart_index, entry->multipart_key) == entry)
+        g_hash_table_remove (self->multipart_index, entry->multipart_key);
+    g_hash_table_remove (self->entries, entry->item);
+}
+
+static gboolean
+expired_cb (Entry *entry)
+{
+    MMSmsIndex *self;
+    gpointer    item;
+
+    self = entry->self;
+    item = entry->item;
+
+    entry->expiration_id = 0;
+    entry_remove (entry);
+    if (self->expired)
+        self->expired (item, self->user_data);
+
+    return G_SOURCE_REMOVE;
+}
+
+/*****************************************************************************/
+
+void
+mm_sms_index_add (MMSmsIndex  *self,
+                  gpointer     item,
+                  gboolean     multipart,
+                  guint        reference,
+                  const gchar *number)
+{
+    Entry *entry;
+
+    g_assert (!g_hash_table_contains (self->entries, item));
+
+    entry = g_slice_new0 (Entry);
+    entry->self = self;
+    entry->item = item;
+    entry->part_keys = g_array_new (FALSE, FALSE, sizeof (gint64));
+    g_hash_table_insert (self->entries, item, entry);
+
+    if (multipart) {
+        entry->multipart_key = build_multipart_key (reference, number);
+        g_hash_table_replace (self->multipart_index, entry->multipart_key, entry);
+    }
+}
+
+void
+mm_sms_index_remove (MMSmsIndex *self,
+                     gpointer    item)
+{
+    Entry *entry;
+
+    entry = g_hash_table_lookup (self->entries, item);
+    if (entry)
+        entry_remove (entry);
+}
+
+guint
+mm_sms_index_get_count (MMSmsIndex *self)
+{
+    return g_hash_table_size (self->entries);
+}
+
+gpointer
+mm_sms_index_lookup_multipart (MMSmsIndex  *self,
+                               guint        reference,
+                               const gchar *number)
+{
+    g_autofree gchar *key = NULL;
+    Entry            *entry;
+
+    key = build_multipart_key (reference, number);
+    entry = g_hash_table_lookup (self->multipart_index, key);
+    return entry ? entry->item : NULL;
+}
+
+/*****************************************************************************/
+
+void
+mm_sms_index_set_parts (MMSmsIndex   *self,
+                        gpointer      item,
+                        MMSmsStorage  storage,
+                        GList        *parts)
+{
+    Entry *entry;
+    GList *l;
+
+    entry = g_hash_table_lookup (self->entries, item);
+    g_assert (entry);
+
+    entry_clear_part_keys (entry);
+    for (l = parts; l; l = g_list_next (l))
+        entry_add_part_key (entry, storage, mm_sms_part_get_index ((MMSmsPart *)l->data));
+}
+
+void
+mm_sms_index_add_part (MMSmsIndex   *self,
+                       gpointer      item,
+                       MMSmsStorage  storage,
+                       guint         index)
+{
+    Entry *entry;
+
+    entry = g_hash_table_lookup (self->entries, item);
+    g_assert (entry);
+
+    entry_add_part_key (entry, storage, index);
+}
+
+gboolean
+mm_sms_index_has_part (MMSmsIndex   *self,
+                       MMSmsStorage  storage,
+                       guint         index)
+{
+    gint64 key;
+
+    if (storage == MM_SMS_STORAGE_UNKNOWN || index == SMS_PART_INVALID_INDEX)
+        return FALSE;
+
+    key = build_part_key (storage, index);
+    return g_hash_table_contains (self->part_index, &key);
+}
+
+/*****************************************************************************/
+
+void
+mm_sms_index_set_expires (MMSmsIndex *self,
+                          gpointer    item,
+                          gboolean    expires)
+{
+    Entry *entry;
+
+    entry = g_hash_table_lookup (self->entries, item);
+    g_assert (entry);
+
+    if (!expires && entry->expiration_id) {
+        g_source_remove (entry->expiration_id);
+        entry->expiration_id = 0;
+    } else if (expires && !entry->expiration_id)
+        entry->expiration_id = g_timeout_add (self->expiration_ms,
+                                              (GSourceFunc) expired_cb,
+                                              entry);
+}
+
+/*****************************************************************************/
+
+MMSmsIndex *
+mm_sms_index_new (guint                 expiration_ms,
+                  MMSmsIndexExpiredFunc expired,
+                  gpointer              user_data)
+{
+    MMSmsIndex *self;
+
+    self = g_slice_new0 (MMSmsIndex);
+    self->expiration_ms = expiration_ms;
+    self->expired = expired;
+    self->user_data = user_data;
+    self->entries = g_hash_table_new_full (g_direct_hash,
+                                           g_direct_equal,
+                                           NULL,
+                                           (GDestroyNotify) entry_free);
+    self->multipart_index = g_hash_table_new (g_str_hash, g_str_equal);
+    self->part_index = g_hash_table_new_full (g_int64_hash,
+                                              g_int64_equal,
+                                              g_free,
+                                              NULL);
+    return self;
+}
+
+void
+mm_sms_index_free (MMSmsIndex *self)
+{
+    /* Indexes first, as the keys of the multipart one are owned by the entries */
+    g_hash_table_unref (self->multipart_index);
+    g_hash_table_unref (self->part_index);
+    g_hash_table_unref (self->entries);
+    g_slice_free (MMSmsIndex, self);
+}
@@ -0,0 +1,70 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_SMS_INDEX_H
+#define MM_SMS_INDEX_H
+
+#include <glib.h>
+#include <ModemManager.h>
+
+/* Lookup tables for the SMS list: items (the SMS objects, not owned by the
+ * index) are indexed by the storage and index of each of their parts, and
+ * multipart ones also by their reference and number. Multipart items may be
+ * flagged to expire if they don't get completed in time. */
+
+typedef struct _MMSmsIndex MMSmsIndex;
+
+/* Called when an item expires; the item is already removed from the index */
+typedef void (* MMSmsIndexExpiredFunc) (gpointer item,
+                                        gpointer user_data);
+
+MMSmsIndex *mm_sms_index_new              (guint                  expiration_ms,
+                                           MMSmsIndexExpiredFunc  expired,
+                                           gpointer               user_data);
+void        mm_sms_index_free             (MMSmsIndex            *self);
+
+void        mm_sms_index_add              (MMSmsIndex            *self,
+                                           gpointer               item,
+                                           gboolean               multipart,
+                                           guint                  reference,
+                                           const gchar           *number);
+void        mm_sms_index_remove           (MMSmsIndex            *self,
+                                           gpointer               item);
+guint       mm_sms_index_get_count        (MMSmsIndex            *self);
+
+gpointer    mm_sms_index_lookup_multipart (MMSmsIndex            *self,
+                                           guint                  reference,
+                                           const gchar           *number);
+
+/* Replaces all the part keys of the item; parts without a valid index (e.g.
+ * already deleted from the device) are skipped */
+void        mm_sms_index_set_parts        (MMSmsIndex            *self,
+                                           gpointer               item,
+                                           MMSmsStorage           storage,
+                                           GList                 *parts);
+void        mm_sms_index_add_part         (MMSmsIndex            *self,
+                                           gpointer               item,
+                                           MMSmsStorage           storage,
+                                           guint                  index);
+gboolean    mm_sms_index_has_part         (MMSmsIndex            *self,
+                                           MMSmsStorage           storage,
+                                           guint                  index);
+
+/* Starts the expiration timeout if not already running, or stops it */
+void        mm_sms_index_set_expires      (MMSmsIndex            *self,
+                                           gpointer               item,
+                                           gboolean               expires);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MMSmsIndex, mm_sms_index_free)
+
+#endif /* MM_SMS_INDEX_H */
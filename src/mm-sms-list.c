@@ -27,6 +27,7 @@
 #include "mm-iface-modem-messaging.h"
 #include "mm-sms-list.h"
 #include "mm-base-sms.h"
+#include "mm-sms-index.h"
 #include "mm-log-object.h"
 
 static void log_object_iface_init (MMLogObjectInterface *iface);
@@ -48,13 +49,115 @@ enum {
 };
 static guint signals[SIGNAL_LAST];
 
+/* Multipart SMS received without being stored in the device (e.g. via +CMT)
+ * can't be listed again, so if some part never arrives they would be kept
+ * in memory forever. */
+#define MULTIPART_SMS_EXPIRATION_TIMEOUT_SECS (30 * 60)
+
 struct _MMSmsListPrivate {
     /* The owner modem */
     MMBaseModem *modem;
     /* List of sms objects */
     GList *list;
+    /* Sms objects, indexed by their parts and multipart reference */
+    MMSmsIndex *index;
 };
 
+/*****************************************************************************/
+/* Indexes */
+
+static void
+sms_update_part_keys (MMSmsList *self,
+                      MMBaseSms *sms)
+{
+    mm_sms_index_set_parts (self->priv->index,
+                            sms,
+                            mm_base_sms_get_storage (sms),
+                            mm_base_sms_get_parts (sms));
+}
+
+static void
+sms_storage_updated (MMBaseSms  *sms,
+                     GParamSpec *pspec,
+                     MMSmsList  *self)
+{
+    /* SMS created by the user get their parts stored at once */
+    sms_update_part_keys (self, sms);
+}
+
+static void
+sms_update_expiration (MMSmsList *self,
+                       MMBaseSms *sms)
+{
+    mm_sms_index_set_expires (self->priv->index,
+                              sms,
+                              (mm_base_sms_get_storage (sms) == MM_SMS_STORAGE_UNKNOWN &&
+                               !mm_base_sms_multipart_is_complete (sms)));
+}
+
+static void list_remove_sms (MMSmsList *self,
+                             MMBaseSms *sms);
+
+static void
+multipart_expired_cb (MMBaseSms *sms,
+                      MMSmsList *self)
+{
+    g_autoptr(MMBaseSms)  sms_ref = NULL;
+    g_autofree gchar     *path = NULL;
+
+    sms_ref = g_object_ref (sms);
+    path = g_strdup (mm_base_sms_get_path (sms));
+
+    mm_obj_dbg (self, "multipart SMS with reference '%u' expired: only %u parts received",
+                mm_base_sms_get_multipart_reference (sms),
+                g_list_length (mm_base_sms_get_parts (sms)));
+
+    list_remove_sms (self, sms);
+    mm_base_sms_unexport (sms);
+    if (path)
+        g_signal_emit (self, signals[SIGNAL_DELETED], 0, path);
+}
+
+/* Takes the given sms reference */
+static void
+list_add_sms (MMSmsList *self,
+              MMBaseSms *sms)
+{
+    gboolean multipart;
+
+    self->priv->list = g_list_prepend (self->priv->list, sms);
+
+    multipart = mm_base_sms_is_multipart (sms);
+    mm_sms_index_add (self->priv->index,
+                      sms,
+                      multipart,
+                      multipart ? mm_base_sms_get_multipart_reference (sms) : 0,
+                      mm_gdbus_sms_get_number (MM_GDBUS_SMS (sms)));
+    g_signal_connect (sms,
+                      "notify::storage",
+                      G_CALLBACK (sms_storage_updated),
+                      self);
+
+    sms_update_part_keys (self, sms);
+    if (multipart)
+        sms_update_expiration (self, sms);
+}
+
+/* Drops the reference owned by the list */
+static void
+list_remove_sms (MMSmsList *self,
+                 MMBaseSms *sms)
+{
+    if (!g_list_find (self->priv->list, sms))
+        return;
+
+    g_signal_handlers_disconnect_by_func (sms, sms_storage_updated, self);
+    mm_sms_index_remove (self->priv->index, sms);
+
+    self->priv->list = g_list_remove (self->priv->list, sms);
+    g_object_unref (sms);
+}
+
 /*****************************************************************************/
 
 gboolean
@@ -89,7 +192,7 @@ mm_sms_list_has_local_multipart_reference (MMSmsList *self,
 guint
 mm_sms_list_get_count (MMSmsList *self)
 {
-    return g_list_length (self->priv->list);
+    return mm_sms_index_get_count (self->priv->index);
 }
 
 GStrv
@@ -141,23 +244,26 @@ delete_ready (MMBaseSms *sms,
     GError *error = NULL;
     GList *l;
 
+    self = g_task_get_source_object (task);
+
     if (!mm_base_sms_delete_finish (sms, res, &error)) {
+        /* Some parts may have been deleted before the failure, and their
+         * storage indexes may be reused by new messages right away */
+        if (g_list_find (self->priv->list, sms))
+            sms_update_part_keys (self, sms);
         /* We report the error */
         g_task_return_error (task, error);
         g_object_unref (task);
         return;
     }
 
-    self = g_task_get_source_object (task);
     path = g_task_get_task_data (task);
     /* The SMS was properly deleted, we now remove it from our list */
     l = g_list_find_custom (self->priv->list,
                             path,
                             (GCompareFunc)cmp_sms_by_path);
-    if (l) {
-        g_object_unref (MM_BASE_SMS (l->data));
-        self->priv->list = g_list_delete_link (self->priv->list, l);
-    }
+    if (l)
+        list_remove_sms (self, MM_BASE_SMS (l->data));
 
     /* We don't need to unref the SMS any more, but we can use the
      * reference we got in the method, which is the one kept alive
@@ -211,7 +317,7 @@ void
 mm_sms_list_add_sms (MMSmsList *self,
                      MMBaseSms *sms)
 {
-    self->priv->list = g_list_prepend (self->priv->list, g_object_ref (sms));
+    list_add_sms (self, g_object_ref (sms));
     g_signal_emit (self, signals[SIGNAL_ADDED], 0,
                    mm_base_sms_get_path (sms),
                    FALSE);
@@ -219,29 +325,6 @@ mm_sms_list_add_sms (MMSmsList *self,
 
 /*****************************************************************************/
 
-static guint
-cmp_sms_by_concat_reference (MMBaseSms *sms,
-                             gpointer user_data)
-{
-    if (!mm_base_sms_is_multipart (sms))
-        return -1;
-
-    return (GPOINTER_TO_UINT (user_data) - mm_base_sms_get_multipart_reference (sms));
-}
-
-typedef struct {
-    guint part_index;
-    MMSmsStorage storage;
-} PartIndexAndStorage;
-
-static guint
-cmp_sms_by_part_index_and_storage (MMBaseSms *sms,
-                                   PartIndexAndStorage *ctx)
-{
-    return !(mm_base_sms_get_storage (sms) == ctx->storage &&
-             mm_base_sms_has_part_index (sms, ctx->part_index));
-}
-
 static gboolean
 take_singlepart (MMSmsList *self,
                  MMSmsPart *part,
@@ -259,7 +342,7 @@ take_singlepart (MMSmsList *self,
     if (!sms)
         return FALSE;
 
-    self->priv->list = g_list_prepend (self->priv->list, sms);
+    list_add_sms (self, sms);
     g_signal_emit (self, signals[SIGNAL_ADDED], 0,
                    mm_base_sms_get_path (sms),
                    state == MM_SMS_STATE_RECEIVED);
@@ -273,18 +356,24 @@ take_multipart (MMSmsList *self,
                 MMSmsStorage storage,
                 GError **error)
 {
-    GList *l;
     MMBaseSms *sms;
     guint concat_reference;
 
     concat_reference = mm_sms_part_get_concat_reference (part);
-    l = g_list_find_custom (self->priv->list,
-                            GUINT_TO_POINTER (concat_reference),
-                            (GCompareFunc)cmp_sms_by_concat_reference);
-    if (l) {
+    sms = mm_sms_index_lookup_multipart (self->priv->index,
+                                         concat_reference,
+                                         mm_sms_part_get_number (part));
+    if (sms) {
         /* Try to take the part */
         mm_obj_dbg (self, "found existing multipart SMS object with reference '%u': adding new part", concat_reference);
-        return mm_base_sms_multipart_take_part (MM_BASE_SMS (l->data), part, error);
+        if (!mm_base_sms_multipart_take_part (sms, part, error))
+            return FALSE;
+        mm_sms_index_add_part (self->priv->index,
+                               sms,
+                               mm_base_sms_get_storage (sms),
+                               mm_sms_part_get_index (part));
+        sms_update_expiration (self, sms);
+        return TRUE;
     }
 
     /* Create new Multipart */
@@ -301,7 +390,7 @@ take_multipart (MMSmsList *self,
     mm_obj_dbg (self, "creating new multipart SMS object: need to receive %u parts with reference '%u'",
                 mm_sms_part_get_concat_max (part),
                 concat_reference);
-    self->priv->list = g_list_prepend (self->priv->list, sms);
+    list_add_sms (self, sms);
     g_signal_emit (self, signals[SIGNAL_ADDED], 0,
                    mm_base_sms_get_path (sms),
                    (state == MM_SMS_STATE_RECEIVED ||
@@ -315,18 +404,7 @@ mm_sms_list_has_part (MMSmsList *self,
                       MMSmsStorage storage,
                       guint index)
 {
-    PartIndexAndStorage ctx;
-
-    if (storage == MM_SMS_STORAGE_UNKNOWN ||
-        index == SMS_PART_INVALID_INDEX)
-        return FALSE;
-
-    ctx.part_index = index;
-    ctx.storage = storage;
-
-    return !!g_list_find_custom (self->priv->list,
-                                 &ctx,
-                                 (GCompareFunc)cmp_sms_by_part_index_and_storage);
+    return mm_sms_index_has_part (self->priv->index, storage, index);
 }
 
 gboolean
@@ -443,6 +521,9 @@ mm_sms_list_init (MMSmsList *self)
     self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                                               MM_TYPE_SMS_LIST,
                                               MMSmsListPrivate);
+    self->priv->index = mm_sms_index_new (MULTIPART_SMS_EXPIRATION_TIMEOUT_SECS * 1000,
+                                          (MMSmsIndexExpiredFunc) multipart_expired_cb,
+                                          self);
 }
 
 static void
@@ -451,12 +532,22 @@ dispose (GObject *object)
     MMSmsList *self = MM_SMS_LIST (object);
 
     g_clear_object (&self->priv->modem);
-    g_list_free_full (self->priv->list, g_object_unref);
-    self->priv->list = NULL;
+    while (self->priv->list)
+        list_remove_sms (self, MM_BASE_SMS (self->priv->list->data));
 
     G_OBJECT_CLASS (mm_sms_list_parent_class)->dispose (object);
 }
 
+static void
+finalize (GObject *object)
+{
+    MMSmsList *self = MM_SMS_LIST (object);
+
+    mm_sms_index_free (self->priv->index);
+
+    G_OBJECT_CLASS (mm_sms_list_parent_class)->finalize (object);
+}
+
 static void
 log_object_iface_init (MMLogObjectInterface *iface)
 {
@@ -474,6 +565,7 @@ mm_sms_list_class_init (MMSmsListClass *klass)
     object_class->get_property = get_property;
     object_class->set_property = set_property;
     object_class->dispose = dispose;
+    object_class->finalize = finalize;
 
     /* Properties */
     properties[PROP_MODEM] =
@@ -0,0 +1,88 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <errno.h>
+
+#include "mm-state-key-file.h"
+#include "mm-log-object.h"
+
+static gchar  *state_dir;
+/* Key files loaded so far */
+static GSList *loaded;
+
+void
+mm_state_key_file_set_dir (const gchar *dir)
+{
+    GSList *l;
+
+    if (!g_strcmp0 (dir, state_dir))
+        return;
+
+    g_free (state_dir);
+    state_dir = g_strdup (dir);
+
+    for (l = loaded; l; l = g_slist_next (l)) {
+        MMStateKeyFile *self = l->data;
+
+        g_clear_pointer (&self->key_file, g_key_file_unref);
+    }
+    g_clear_pointer (&loaded, g_slist_free);
+}
+
+GKeyFile *
+mm_state_key_file_peek (MMStateKeyFile *self,
+                        gpointer        log_object)
+{
+    g_autofree gchar *path = NULL;
+    GError           *error = NULL;
+
+    if (G_LIKELY (self->key_file))
+        return self->key_file;
+
+    self->key_file = g_key_file_new ();
+    loaded = g_slist_prepend (loaded, self);
+    if (!state_dir)
+        return self->key_file;
+
+    path = g_build_filename (state_dir, self->name, NULL);
+    if (!g_key_file_load_from_file (self->key_file, path, G_KEY_FILE_NONE, &error)) {
+        if (!g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+            mm_obj_warn (log_object, "couldn't load %s: %s", self->description, error->message);
+        g_error_free (error);
+    }
+    return self->key_file;
+}
+
+void
+mm_state_key_file_save (MMStateKeyFile *self,
+                        gpointer        log_object)
+{
+    g_autofree gchar *path = NULL;
+    GError           *error = NULL;
+
+    g_assert (self->key_file);
+    if (!state_dir)
+        return;
+
+    if (g_mkdir_with_parents (state_dir, 0755) < 0) {
+        mm_obj_warn (log_object, "couldn't create state directory: %s", g_strerror (errno));
+        return;
+    }
+
+    path = g_build_filename (state_dir, self->name, NULL);
+    if (!g_key_file_save_to_file (self->key_file, path, &error)) {
+        mm_obj_warn (log_object, "couldn't save %s: %s", self->description, error->message);
+        g_error_free (error);
+    }
+}
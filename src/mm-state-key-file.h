@@ -0,0 +1,43 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_STATE_KEY_FILE_H
+#define MM_STATE_KEY_FILE_H
+
+#include <glib.h>
+
+/* Key files with state kept across runs of the daemon (e.g. caches of probing
+ * results), loaded from the state directory on first use and saved back to it
+ * on every change. Until a state directory is set (e.g. in test sessions),
+ * they are only kept in memory. */
+
+typedef struct {
+    /* File name in the state directory */
+    const gchar *name;
+    /* Description used in log messages */
+    const gchar *description;
+    GKeyFile    *key_file;
+} MMStateKeyFile;
+
+#define MM_STATE_KEY_FILE_INIT(name, description) { name, description, NULL }
+
+/* Setting a different directory drops all the state already loaded, so that
+ * it's loaded again from the new one */
+void      mm_state_key_file_set_dir (const gchar    *dir);
+
+GKeyFile *mm_state_key_file_peek    (MMStateKeyFile *self,
+                                     gpointer        log_object);
+void      mm_state_key_file_save    (MMStateKeyFile *self,
+                                     gpointer        log_object);
+
+#endif /* MM_STATE_KEY_FILE_H */
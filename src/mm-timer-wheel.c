@@ -0,0 +1,248 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include "mm-timer-wheel.h"
+
+/* Each slot of the wheel covers 8ms, so a full turn of the wheel covers a bit
+ * more than 2s. Timers further away than a full turn just stay in their slot
+ * until the wheel gets back to it with their deadline already reached. */
+#define SLOT_WIDTH_US (8 * G_TIME_SPAN_MILLISECOND)
+#define N_SLOTS       256
+
+#define TICK(time) ((time) / SLOT_WIDTH_US)
+#define SLOT(tick) (&wheel->slots[(tick) % N_SLOTS])
+
+typedef struct {
+    guint             id;
+    gint64            deadline;
+    MMTimerWheelFunc  func;
+    gpointer          user_data;
+    GQueue           *slot;
+    GList             link;
+} Timer;
+
+typedef struct {
+    GSource     source;
+    GQueue      slots[N_SLOTS];
+    GHashTable *timers;
+    guint       next_id;
+    gint64      current_tick;
+    GArray     *expired;
+} TimerWheel;
+
+typedef struct {
+    gint64 deadline;
+    guint  id;
+} ExpiredTimer;
+
+static TimerWheel *wheel;
+
+static void
+timer_free (Timer *timer)
+{
+    g_slice_free (Timer, timer);
+}
+
+static gint
+expired_timer_cmp (const ExpiredTimer *a,
+                   const ExpiredTimer *b)
+{
+    if (a->deadline != b->deadline)
+        return (a->deadline < b->deadline) ? -1 : 1;
+    /* Same deadline, keep the order in which they were added */
+    return (a->id < b->id) ? -1 : (a->id > b->id);
+}
+
+/*****************************************************************************/
+
+static void
+timer_wheel_update_ready_time (void)
+{
+    gint64 tick;
+    guint  i;
+
+    if (g_hash_table_size (wheel->timers) == 0) {
+        g_source_set_ready_time (&wheel->source, -1);
+        return;
+    }
+
+    /* Look for the earliest timer in the closest slot with timers expiring
+     * within the slot itself */
+    for (i = 0, tick = wheel->current_tick; i < N_SLOTS; i++, tick++) {
+        GList  *l;
+        gint64  slot_end;
+        gint64  earliest = G_MAXINT64;
+
+        slot_end = (tick + 1) * SLOT_WIDTH_US;
+        for (l = SLOT (tick)->head; l; l = g_list_next (l)) {
+            Timer *timer = l->data;
+
+            if (timer->deadline < slot_end && timer->deadline < earliest)
+                earliest = timer->deadline;
+        }
+
+        if (earliest != G_MAXINT64) {
+            g_source_set_ready_time (&wheel->source, earliest);
+            return;
+        }
+    }
+
+    /* All timers are more than a full turn away, just look again after the
+     * turn has finished */
+    g_source_set_ready_time (&wheel->source, tick * SLOT_WIDTH_US);
+}
+
+static gboolean
+timer_wheel_dispatch (GSource     *source,
+                      GSourceFunc  callback,
+                      gpointer     user_data)
+{
+    gint64 now;
+    gint64 now_tick;
+    gint64 tick;
+    guint  i;
+
+    now = g_get_monotonic_time ();
+    now_tick = TICK (now);
+
+    /* Collect all the expired timers, looking at most at every slot once */
+    g_array_set_size (wheel->expired, 0);
+    for (i = 0, tick = wheel->current_tick; i < N_SLOTS && tick <= now_tick; i++, tick++) {
+        GList *l;
+
+        for (l = SLOT (tick)->head; l; l = g_list_next (l)) {
+            Timer *timer = l->data;
+
+            if (timer->deadline <= now) {
+                ExpiredTimer expired;
+
+                expired.deadline = timer->deadline;
+                expired.id = timer->id;
+                g_array_append_val (wheel->expired, expired);
+            }
+        }
+    }
+    wheel->current_tick = now_tick;
+
+    /* Slots only keep the order in which timers were added */
+    if (wheel->expired->len > 1)
+        g_array_sort (wheel->expired, (GCompareFunc) expired_timer_cmp);
+
+    /* Timers may be added or removed by the callbacks, so look up each of
+     * them again before running it */
+    for (i = 0; i < wheel->expired->len; i++) {
+        Timer            *timer;
+        MMTimerWheelFunc  func;
+        gpointer          func_data;
+
+        timer = g_hash_table_lookup (wheel->timers,
+                                     GUINT_TO_POINTER (g_array_index (wheel->expired, ExpiredTimer, i).id));
+        if (!timer)
+            continue;
+
+        func = timer->func;
+        func_data = timer->user_data;
+        g_queue_unlink (timer->slot, &timer->link);
+        g_hash_table_remove (wheel->timers, GUINT_TO_POINTER (timer->id));
+
+        func (func_data);
+    }
+
+    timer_wheel_update_ready_time ();
+    return G_SOURCE_CONTINUE;
+}
+
+static GSourceFuncs timer_wheel_source_funcs = {
+    NULL, /* prepare */
+    NULL, /* check */
+    timer_wheel_dispatch,
+    NULL, /* finalize */
+};
+
+static void
+timer_wheel_setup (void)
+{
+    wheel = (TimerWheel *) g_source_new (&timer_wheel_source_funcs, sizeof (TimerWheel));
+    wheel->timers = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) timer_free);
+    wheel->expired = g_array_new (FALSE, FALSE, sizeof (ExpiredTimer));
+    wheel->next_id = 1;
+    g_source_set_name (&wheel->source, "MMTimerWheel");
+    g_source_attach (&wheel->source, NULL);
+}
+
+/*****************************************************************************/
+
+guint
+mm_timer_wheel_add (guint            timeout_ms,
+                    MMTimerWheelFunc func,
+                    gpointer         user_data)
+{
+    Timer  *timer;
+    gint64  now;
+    gint64  ready_time;
+
+    g_return_val_if_fail (func != NULL, 0);
+
+    if (G_UNLIKELY (!wheel))
+        timer_wheel_setup ();
+
+    now = g_get_monotonic_time ();
+
+    /* If the wheel was idle, just move it to the current time */
+    if (g_hash_table_size (wheel->timers) == 0)
+        wheel->current_tick = TICK (now);
+
+    timer = g_slice_new0 (Timer);
+    timer->deadline = now + (gint64) timeout_ms * G_TIME_SPAN_MILLISECOND;
+    timer->func = func;
+    timer->user_data = user_data;
+    timer->link.data = timer;
+
+    /* Never place timers in slots already processed */
+    timer->slot = SLOT (MAX (TICK (timer->deadline), wheel->current_tick));
+    g_queue_push_tail_link (timer->slot, &timer->link);
+
+    /* Ids are never 0, and never reused while still in use */
+    do {
+        timer->id = wheel->next_id++;
+        if (G_UNLIKELY (wheel->next_id == 0))
+            wheel->next_id = 1;
+    } while (g_hash_table_contains (wheel->timers, GUINT_TO_POINTER (timer->id)));
+    g_hash_table_insert (wheel->timers, GUINT_TO_POINTER (timer->id), timer);
+
+    ready_time = g_source_get_ready_time (&wheel->source);
+    if (ready_time < 0 || timer->deadline < ready_time)
+        g_source_set_ready_time (&wheel->source, timer->deadline);
+
+    return timer->id;
+}
+
+void
+mm_timer_wheel_remove (guint id)
+{
+    Timer *timer;
+
+    g_return_if_fail (id != 0);
+    g_return_if_fail (wheel != NULL);
+
+    timer = g_hash_table_lookup (wheel->timers, GUINT_TO_POINTER (id));
+    g_return_if_fail (timer != NULL);
+
+    g_queue_unlink (timer->slot, &timer->link);
+    g_hash_table_remove (wheel->timers, GUINT_TO_POINTER (id));
+
+    /* Don't bother looking for the new earliest timer, an early wakeup will
+     * just find nothing to do; but avoid the wakeup if there's nothing left */
+    if (g_hash_table_size (wheel->timers) == 0)
+        g_source_set_ready_time (&wheel->source, -1);
+}
@@ -0,0 +1,40 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#ifndef MM_TIMER_WHEEL_H
+#define MM_TIMER_WHEEL_H
+
+#include <glib.h>
+
+/* Shared one-shot timers with millisecond resolution.
+ *
+ * All timers are kept in a single hashed timer wheel, driven by one GSource
+ * attached to the default main context, instead of having one GSource per
+ * pending timeout. Adding and removing timers is O(1), and the GSource is
+ * only woken up when the earliest pending timer expires.
+ *
+ * Timers are always one-shot, and the given callback is called from the
+ * default main context. Timer ids are never 0, so 0 may be used to flag that
+ * no timer is scheduled.
+ */
+
+typedef void (* MMTimerWheelFunc) (gpointer user_data);
+
+guint mm_timer_wheel_add    (guint            timeout_ms,
+                             MMTimerWheelFunc func,
+                             gpointer         user_data);
+
+/* Removing a timer which already expired is a programmer error */
+void  mm_timer_wheel_remove (guint            id);
+
+#endif /* MM_TIMER_WHEEL_H */
@@ -19,6 +19,7 @@
 
 #include "mm-port-serial-at.h"
 #include "mm-serial-parsers.h"
+#include "mm-error-helpers.h"
 #include "mm-log-test.h"
 
 typedef struct {
@@ -52,6 +53,13 @@ static const ParseResponseTest parse_ok_tests[] = {
     { "\r\nOK\r\n", TRUE, FALSE},
     { "\r\nOK\r\n\r\n+CMTI: \"ME\",1\r\n", TRUE, FALSE},
     { "\r\nOK\r\n\r\n+CIEV: 7,1\r\n\r\n+CRING: VOICE\r\n\r\n+CLIP: \"+0123456789\",145,,,,0\r\n", TRUE, FALSE},
+    { "\r\n+CPIN: READY\r\n\r\nOK\r\n", TRUE, FALSE},
+    { "\r\nOKAY\r\n", FALSE, FALSE},
+    { "\r\nCONNECT\r\n", TRUE, FALSE},
+    { "\r\nCONNECT 115200\r\n", TRUE, FALSE},
+    { "\r\nCONNECT 115200", FALSE, FALSE},
+    { "\r\n> ", TRUE, FALSE},
+    { "\r\n>\r\n", TRUE, FALSE},
     { "\r\nUNKNOWN COMMAND\r\n", FALSE, FALSE}
 };
 
@@ -80,29 +88,70 @@ static const ParseResponseTest parse_error_tests[] = {
     { "\r\nNO ANSWER\r\n", TRUE, TRUE},
     { "\r\nNO ANSWER\r\n\r\nSomething extra\r\n", TRUE, TRUE},
     { "\r\nNO DIALTONE\r\n", TRUE, TRUE},
-    { "\r\nNO DIALTONE\r\n\r\nSomething extra\r\n", TRUE, TRUE}
+    { "\r\nNO DIALTONE\r\n\r\nSomething extra\r\n", TRUE, TRUE},
+    { "\r\nNA\r\n", TRUE, TRUE},
+    { "\r\nNAME\r\n", FALSE, FALSE},
+    { "\r\n+COPS: 0,0,\"BUSY NETWORK\"\r\n", FALSE, FALSE}
 };
 
+typedef struct {
+    const gchar *response;
+    GQuark       domain;
+    gint         code;
+    const gchar *cleaned;
+} ParseResponseErrorCodeTest;
+
+static void
+at_serial_parse_error_codes (void)
+{
+    guint i;
+    const ParseResponseErrorCodeTest tests[] = {
+        { "\r\n+CME ERROR: 10\r\n",           MM_MOBILE_EQUIPMENT_ERROR, MM_MOBILE_EQUIPMENT_ERROR_SIM_NOT_INSERTED, "+CME ERROR: 10" },
+        { "\r\n+CMS ERROR: 310\r\n",          MM_MESSAGE_ERROR,          MM_MESSAGE_ERROR_SIM_NOT_INSERTED,          "+CMS ERROR: 310" },
+        { "\r\nERROR\r\n",                    MM_MOBILE_EQUIPMENT_ERROR, MM_MOBILE_EQUIPMENT_ERROR_UNKNOWN,          "ERROR" },
+        { "\r\nNO CARRIER\r\n",               MM_CONNECTION_ERROR,       MM_CONNECTION_ERROR_NO_CARRIER,             "NO CARRIER" },
+        { "\r\nBUSY\r\n",                     MM_CONNECTION_ERROR,       MM_CONNECTION_ERROR_BUSY,                   "BUSY" },
+        { "\r\nNO ANSWER\r\n",                MM_CONNECTION_ERROR,       MM_CONNECTION_ERROR_NO_ANSWER,              "NO ANSWER" },
+        { "\r\nNO DIALTONE\r\n",              MM_CONNECTION_ERROR,       MM_CONNECTION_ERROR_NO_DIALTONE,            "NO DIALTONE" },
+        { "\r\n+CMTI: \"ME\",1\r\n\r\nERROR\r\n", MM_MOBILE_EQUIPMENT_ERROR, MM_MOBILE_EQUIPMENT_ERROR_UNKNOWN,          "+CMTI: \"ME\",1\r\n\r\nERROR" },
+    };
+
+    for (i = 0; i < G_N_ELEMENTS (tests); i++) {
+        gpointer  parser;
+        GString  *response;
+        GError   *error = NULL;
+
+        parser = mm_serial_parser_v1_new ();
+        response = g_string_new (tests[i].response);
+        g_assert (mm_serial_parser_v1_parse (parser, response, 0, NULL, &error));
+        g_assert_error (error, tests[i].domain, tests[i].code);
+        g_assert_cmpstr (response->str, ==, tests[i].cleaned);
+        g_error_free (error);
+        g_string_free (response, TRUE);
+        mm_serial_parser_v1_destroy (parser);
+    }
+}
+
 static void
 at_serial_echo_removal (void)
 {
     guint i;
 
     for (i = 0; i < G_N_ELEMENTS (echo_removal_tests); i++) {
-        GByteArray *ba;
+        MMSerialBuffer *buffer;
 
-        /* Note that we add last NUL also to the byte array, so that we can compare
+        /* Note that we add last NUL also to the buffer, so that we can compare
          * C strings later on */
-        ba = g_byte_array_sized_new (strlen (echo_removal_tests[i].original) + 1);
-        g_byte_array_prepend (ba,
-                              (guint8 *)echo_removal_tests[i].original,
-                              strlen (echo_removal_tests[i].original) + 1);
+        buffer = mm_serial_buffer_new (strlen (echo_removal_tests[i].original) + 1);
+        mm_serial_buffer_append (buffer,
+                                 (guint8 *)echo_removal_tests[i].original,
+                                 strlen (echo_removal_tests[i].original) + 1);
 
-        mm_port_serial_at_remove_echo (ba);
+        mm_port_serial_at_remove_echo (buffer);
 
-        g_assert_cmpstr ((gchar *)ba->data, ==, echo_removal_tests[i].without_echo);
+        g_assert_cmpstr ((gchar *)buffer->data, ==, echo_removal_tests[i].without_echo);
 
-        g_byte_array_unref (ba);
+        mm_serial_buffer_free (buffer);
     }
 }
 
@@ -118,7 +167,7 @@ _run_parse_test (const ParseResponseTest tests[], guint number_of_tests)
     for (i = 0; i < number_of_tests; i++) {
         parser = mm_serial_parser_v1_new ();
         response = g_string_new (tests[i].response);
-        found = mm_serial_parser_v1_parse (parser, response, NULL, &error);
+        found = mm_serial_parser_v1_parse (parser, response, 0, NULL, &error);
 
         /* Verify if we expect a match or not */
         g_assert_cmpint (found, ==, tests[i].found);
@@ -149,6 +198,137 @@ at_serial_parse_error (void)
     _run_parse_test (parse_error_tests, G_N_ELEMENTS(parse_error_tests));
 }
 
+/* Parse the response as it's received in chunks, letting the parser resume
+ * the scan from where it stopped; every step must give the same result as
+ * parsing the whole data received so far from scratch */
+static void
+run_parse_incremental (const gchar *full,
+                       gsize        chunk_len)
+{
+    gpointer parser;
+    gsize    full_len;
+    gsize    len = 0;
+    gsize    unchanged_len = 0;
+
+    parser = mm_serial_parser_v1_new ();
+    full_len = strlen (full);
+
+    while (len < full_len) {
+        gpointer  reference_parser;
+        GString  *response;
+        GString  *reference;
+        GError   *error = NULL;
+        GError   *reference_error = NULL;
+        gboolean  found;
+        gboolean  reference_found;
+
+        len = MIN (len + chunk_len, full_len);
+
+        response = g_string_new_len (full, len);
+        found = mm_serial_parser_v1_parse (parser, response, unchanged_len, NULL, &error);
+
+        reference_parser = mm_serial_parser_v1_new ();
+        reference = g_string_new_len (full, len);
+        reference_found = mm_serial_parser_v1_parse (reference_parser, reference, 0, NULL, &reference_error);
+
+        g_assert_cmpint (found, ==, reference_found);
+        g_assert_cmpstr (response->str, ==, reference->str);
+        if (reference_error)
+            g_assert_error (error, reference_error->domain, reference_error->code);
+        else
+            g_assert_no_error (error);
+
+        g_clear_error (&error);
+        g_clear_error (&reference_error);
+        g_string_free (response, TRUE);
+        g_string_free (reference, TRUE);
+        mm_serial_parser_v1_destroy (reference_parser);
+
+        if (found)
+            break;
+        unchanged_len = len;
+    }
+
+    mm_serial_parser_v1_destroy (parser);
+}
+
+static void
+at_serial_parse_incremental (void)
+{
+    GString *cmgl;
+    guint    i;
+    gsize    chunk_len;
+
+    cmgl = g_string_new (NULL);
+    for (i = 0; i < 50; i++)
+        g_string_append_printf (cmgl,
+                                "\r\n+CMGL: %u,1,,40\r\n"
+                                "07914356060013F1065A098136397339F7219011700463802190117004638030",
+                                i);
+    g_string_append (cmgl, "\r\n\r\nOK\r\n");
+
+    for (chunk_len = 1; chunk_len <= 8; chunk_len++) {
+        for (i = 0; i < G_N_ELEMENTS (parse_ok_tests); i++)
+            run_parse_incremental (parse_ok_tests[i].response, chunk_len);
+        for (i = 0; i < G_N_ELEMENTS (parse_error_tests); i++)
+            run_parse_incremental (parse_error_tests[i].response, chunk_len);
+        run_parse_incremental (cmgl->str, chunk_len);
+    }
+    run_parse_incremental (cmgl->str, 64);
+
+    g_string_free (cmgl, TRUE);
+}
+
+static void
+at_serial_parse_changed (void)
+{
+    gpointer  parser;
+    GString  *response;
+    GError   *error = NULL;
+
+    parser = mm_serial_parser_v1_new ();
+
+    response = g_string_new ("\r\n+CMTI: \"ME\",1\r\n\r\n+CPIN: READY\r\n");
+    g_assert (!mm_serial_parser_v1_parse (parser, response, 0, NULL, &error));
+    g_assert_no_error (error);
+    g_string_free (response, TRUE);
+
+    /* The unsolicited message got removed, so nothing can be skipped */
+    response = g_string_new ("\r\n+CPIN: READY\r\n\r\nOK\r\n");
+    g_assert (mm_serial_parser_v1_parse (parser, response, 0, NULL, &error));
+    g_assert_no_error (error);
+    g_assert_cmpstr (response->str, ==, "+CPIN: READY");
+    g_string_free (response, TRUE);
+
+    mm_serial_parser_v1_destroy (parser);
+}
+
+typedef struct {
+    const gchar *response;
+    gsize        first_len;
+} ResponseEndTest;
+
+static const ResponseEndTest response_end_tests[] = {
+    { "\r\nOK", 0 },
+    { "\r\n+CGMI: X\r\n", 0 },
+    { "\r\nOK\r\n", 6 },
+    { "\r\nOK\r\n\r\n+CGMI: X\r\n\r\nOK\r\n", 6 },
+    { "\r\n+CGMI: X\r\n\r\nOK\r\n\r\nOK\r\n", 18 },
+    { "\r\n+CME ERROR: 10\r\nAT+CGMM\r\r\nOK\r\n", 18 },
+    { "\r\n+COPS: 0,0,\"OK\"\r\n\r\nOK\r\n", 25 },
+};
+
+static void
+at_serial_response_end (void)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (response_end_tests); i++)
+        g_assert_cmpuint (mm_serial_parser_v1_find_response_end (response_end_tests[i].response,
+                                                                 strlen (response_end_tests[i].response)),
+                          ==, response_end_tests[i].first_len);
+}
+
 int main (int argc, char **argv)
 {
     g_test_init (&argc, &argv, NULL);
@@ -156,6 +336,10 @@ int main (int argc, char **argv)
     g_test_add_func ("/ModemManager/AT-serial/echo-removal", at_serial_echo_removal);
     g_test_add_func ("/ModemManager/AT-serial/parse-ok", at_serial_parse_ok);
     g_test_add_func ("/ModemManager/AT-serial/parse-error", at_serial_parse_error);
+    g_test_add_func ("/ModemManager/AT-serial/parse-error-codes", at_serial_parse_error_codes);
+    g_test_add_func ("/ModemManager/AT-serial/parse-incremental", at_serial_parse_incremental);
+    g_test_add_func ("/ModemManager/AT-serial/parse-changed", at_serial_parse_changed);
+    g_test_add_func ("/ModemManager/AT-serial/response-end", at_serial_response_end);
 
     return g_test_run ();
 }
@@ -313,6 +313,302 @@ test_gsm7_pack_7_chars_offset (void)
     g_free (packed);
 }
 
+/* Septet by septet implementations the block kernels are checked against */
+
+static guint8 *
+reference_gsm_unpack (const guint8 *gsm,
+                      guint32       num_septets,
+                      guint8        start_offset,
+                      guint32      *out_unpacked_len)
+{
+    GByteArray *unpacked;
+    guint i;
+
+    unpacked = g_byte_array_sized_new (num_septets + 1);
+
+    for (i = 0; i < num_septets; i++) {
+        guint8 bits_here, bits_in_next, octet, offset, c;
+        guint32 start_bit;
+
+        start_bit = start_offset + (i * 7);
+        offset = start_bit % 8;
+        bits_here = offset ? (8 - offset) : 7;
+        bits_in_next = 7 - bits_here;
+
+        octet = gsm[start_bit / 8];
+        c = (octet >> offset) & (0xFF >> (8 - bits_here));
+
+        if (bits_in_next) {
+            octet = gsm[(start_bit / 8) + 1];
+            c |= (octet & (0xFF >> (8 - bits_in_next))) << bits_here;
+        }
+        g_byte_array_append (unpacked, &c, 1);
+    }
+
+    *out_unpacked_len = unpacked->len;
+    return g_byte_array_free (unpacked, FALSE);
+}
+
+static guint8 *
+reference_gsm_pack (const guint8 *src,
+                    guint32       src_len,
+                    guint8        start_offset,
+                    guint32      *out_packed_len)
+{
+    guint8 *packed;
+    guint octet = 0, lshift, plen;
+    guint i = 0;
+
+    plen = (src_len * 7) + start_offset;
+    if (plen % 8)
+        plen += 8;
+    plen /= 8;
+
+    packed = g_malloc0 (plen);
+
+    for (i = 0, lshift = start_offset; i < src_len; i++) {
+        packed[octet] |= (src[i] & 0x7F) << lshift;
+        if (lshift > 1) {
+            g_assert (octet + 1 < plen);
+            packed[octet + 1] = (src[i] & 0x7F) >> (8 - lshift);
+        }
+        if (lshift)
+            octet++;
+        lshift = lshift ? lshift - 1 : 7;
+    }
+
+    *out_packed_len = plen;
+    return packed;
+}
+
+/* Enough to go through several full blocks with any head and tail */
+#define GSM7_TEST_MAX_SEPTETS 80
+#define GSM7_TEST_N_RUNS      20
+
+static void
+test_gsm7_unpack_reference (void)
+{
+    guint8  gsm[GSM7_TEST_MAX_SEPTETS];
+    guint   run;
+    guint32 num_septets;
+    guint8  start_offset;
+    guint   i;
+
+    for (run = 0; run < GSM7_TEST_N_RUNS; run++) {
+        for (i = 0; i < sizeof (gsm); i++)
+            gsm[i] = (run == 0) ? 0xFF : g_test_rand_int_range (0, 256);
+
+        for (num_septets = 0; num_septets <= GSM7_TEST_MAX_SEPTETS; num_septets++) {
+            for (start_offset = 0; start_offset < 8; start_offset++) {
+                g_autofree guint8 *unpacked = NULL;
+                g_autofree guint8 *expected = NULL;
+                guint32            unpacked_len = 0;
+                guint32            expected_len = 0;
+
+                if ((start_offset + (num_septets * 7) + 7) / 8 > sizeof (gsm))
+                    continue;
+
+                unpacked = mm_charset_gsm_unpack (gsm, num_septets, start_offset, &unpacked_len);
+                expected = reference_gsm_unpack (gsm, num_septets, start_offset, &expected_len);
+                g_assert (unpacked);
+                g_assert_cmpuint (unpacked_len, ==, expected_len);
+                g_assert_cmpint (memcmp (unpacked, expected, unpacked_len), ==, 0);
+            }
+        }
+    }
+}
+
+static void
+test_gsm7_pack_reference (void)
+{
+    guint8  src[GSM7_TEST_MAX_SEPTETS];
+    guint   run;
+    guint32 src_len;
+    guint8  start_offset;
+    guint   i;
+
+    for (run = 0; run < GSM7_TEST_N_RUNS; run++) {
+        /* Upper bits must be ignored */
+        for (i = 0; i < sizeof (src); i++)
+            src[i] = (run == 0) ? 0xFF : g_test_rand_int_range (0, 256);
+
+        for (src_len = 0; src_len <= GSM7_TEST_MAX_SEPTETS; src_len++) {
+            for (start_offset = 0; start_offset < 8; start_offset++) {
+                g_autofree guint8 *packed = NULL;
+                g_autofree guint8 *expected = NULL;
+                g_autofree guint8 *unpacked = NULL;
+                guint32            packed_len = 0;
+                guint32            expected_len = 0;
+                guint32            unpacked_len = 0;
+
+                packed = mm_charset_gsm_pack (src, src_len, start_offset, &packed_len);
+                expected = reference_gsm_pack (src, src_len, start_offset, &expected_len);
+                g_assert_cmpuint (packed_len, ==, expected_len);
+                g_assert_cmpint (memcmp (packed, expected, packed_len), ==, 0);
+
+                /* And back */
+                unpacked = mm_charset_gsm_unpack (packed, src_len, start_offset, &unpacked_len);
+                g_assert_cmpuint (unpacked_len, ==, src_len);
+                for (i = 0; i < src_len; i++)
+                    g_assert_cmpuint (unpacked[i], ==, src[i] & 0x7F);
+            }
+        }
+    }
+}
+
+static void
+add_gsm7_reverse_mapping (GHashTable   *mappings,
+                          const guint8 *gsm,
+                          guint32       len)
+{
+    g_autofree guint8 *seq = NULL;
+    g_autofree gchar  *utf8 = NULL;
+    gsize              utf8_len;
+
+    /* Trailing 'A' so that '@' isn't taken as padding */
+    seq = g_malloc (len + 1);
+    memcpy (seq, gsm, len);
+    seq[len] = 0x41;
+    utf8 = (gchar *) mm_charset_gsm_unpacked_to_utf8 (seq, len + 1);
+    utf8_len = strlen (utf8);
+    g_assert_cmpuint (utf8_len, >, 1);
+    g_assert (utf8[utf8_len - 1] == 'A');
+    utf8[utf8_len - 1] = '\0';
+
+    if (!g_hash_table_contains (mappings, utf8))
+        g_hash_table_insert (mappings, g_steal_pointer (&utf8), g_bytes_new (gsm, len));
+}
+
+static void
+test_gsm7_reverse_lookup (void)
+{
+    static const guint8  ext[] = { 0x0A, 0x14, 0x28, 0x29, 0x2F, 0x3C, 0x3D, 0x3E, 0x40, 0x65 };
+    GHashTable          *mappings;
+    gunichar             c;
+    guint8               gsm[2];
+    guint                i;
+
+    /* Every UTF-8 character that decoding GSM may give, built only with the
+     * GSM to UTF-8 direction */
+    mappings = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_bytes_unref);
+    for (i = 0; i < 128; i++) {
+        if (i == 0x1B)
+            continue;
+        gsm[0] = i;
+        add_gsm7_reverse_mapping (mappings, gsm, 1);
+    }
+    for (i = 0; i < G_N_ELEMENTS (ext); i++) {
+        gsm[0] = 0x1B;
+        gsm[1] = ext[i];
+        add_gsm7_reverse_mapping (mappings, gsm, 2);
+    }
+
+    /* Whole BMP the other way around */
+    for (c = 1; c < 0x10000; c++) {
+        g_autofree guint8 *unpacked = NULL;
+        gchar              utf8[7];
+        guint32            unpacked_len = 0;
+        GBytes            *expected;
+        gint               len;
+
+        if (!g_unichar_validate (c))
+            continue;
+
+        len = g_unichar_to_utf8 (c, utf8);
+        utf8[len] = '\0';
+
+        expected = g_hash_table_lookup (mappings, utf8);
+        unpacked = mm_charset_utf8_to_unpacked_gsm (utf8, &unpacked_len);
+        g_assert (unpacked);
+        if (expected) {
+            g_assert_cmpuint (unpacked_len, ==, g_bytes_get_size (expected));
+            g_assert_cmpint (memcmp (unpacked, g_bytes_get_data (expected, NULL), unpacked_len), ==, 0);
+        } else
+            g_assert_cmpuint (unpacked_len, ==, 0);
+        g_assert (mm_charset_can_convert_to (utf8, MM_MODEM_CHARSET_GSM) == !!expected);
+    }
+
+    g_hash_table_unref (mappings);
+}
+
+#define BENCHMARK_N_ITERATIONS 100000
+#define BENCHMARK_N_SEPTETS    160
+
+static void
+test_gsm7_benchmark (void)
+{
+    static const gchar *text = "Meet at Café Δelta at 10:00 {room 3} €5 entry, ñ ö ü ß Ω!";
+    GString            *long_text;
+    guint8              src[BENCHMARK_N_SEPTETS];
+    g_autofree guint8  *packed = NULL;
+    guint32             packed_len = 0;
+    GTimer             *timer;
+    gdouble             elapsed;
+    gdouble             reference_elapsed;
+    guint               i;
+
+    if (!g_test_perf ())
+        return;
+
+    for (i = 0; i < BENCHMARK_N_SEPTETS; i++)
+        src[i] = g_test_rand_int_range (0, 128);
+    packed = mm_charset_gsm_pack (src, BENCHMARK_N_SEPTETS, 0, &packed_len);
+
+    timer = g_timer_new ();
+
+    /* Pack */
+    for (i = 0; i < BENCHMARK_N_ITERATIONS; i++)
+        g_free (mm_charset_gsm_pack (src, BENCHMARK_N_SEPTETS, 0, NULL));
+    elapsed = g_timer_elapsed (timer, NULL);
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_N_ITERATIONS; i++) {
+        guint32 len;
+
+        g_free (reference_gsm_pack (src, BENCHMARK_N_SEPTETS, 0, &len));
+    }
+    reference_elapsed = g_timer_elapsed (timer, NULL);
+    g_test_message ("pack %u septets: %.3f us, reference %.3f us", BENCHMARK_N_SEPTETS,
+                    (elapsed * G_USEC_PER_SEC) / BENCHMARK_N_ITERATIONS,
+                    (reference_elapsed * G_USEC_PER_SEC) / BENCHMARK_N_ITERATIONS);
+    g_test_minimized_result (elapsed / BENCHMARK_N_ITERATIONS, "pack: %.3f us",
+                             (elapsed * G_USEC_PER_SEC) / BENCHMARK_N_ITERATIONS);
+
+    /* Unpack */
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_N_ITERATIONS; i++) {
+        guint32 len;
+
+        g_free (mm_charset_gsm_unpack (packed, BENCHMARK_N_SEPTETS, 0, &len));
+    }
+    elapsed = g_timer_elapsed (timer, NULL);
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_N_ITERATIONS; i++) {
+        guint32 len;
+
+        g_free (reference_gsm_unpack (packed, BENCHMARK_N_SEPTETS, 0, &len));
+    }
+    reference_elapsed = g_timer_elapsed (timer, NULL);
+    g_test_message ("unpack %u septets: %.3f us, reference %.3f us", BENCHMARK_N_SEPTETS,
+                    (elapsed * G_USEC_PER_SEC) / BENCHMARK_N_ITERATIONS,
+                    (reference_elapsed * G_USEC_PER_SEC) / BENCHMARK_N_ITERATIONS);
+    g_test_minimized_result (elapsed / BENCHMARK_N_ITERATIONS, "unpack: %.3f us",
+                             (elapsed * G_USEC_PER_SEC) / BENCHMARK_N_ITERATIONS);
+
+    /* UTF-8 to GSM */
+    long_text = g_string_new (NULL);
+    while (g_utf8_strlen (long_text->str, -1) < BENCHMARK_N_SEPTETS)
+        g_string_append (long_text, text);
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_N_ITERATIONS; i++)
+        g_free (mm_charset_utf8_to_unpacked_gsm (long_text->str, NULL));
+    elapsed = g_timer_elapsed (timer, NULL);
+    g_test_minimized_result (elapsed / BENCHMARK_N_ITERATIONS, "UTF-8 to GSM, %u bytes: %.3f us",
+                             (guint) long_text->len, (elapsed * G_USEC_PER_SEC) / BENCHMARK_N_ITERATIONS);
+
+    g_string_free (long_text, TRUE);
+    g_timer_destroy (timer);
+}
+
 static void
 test_take_convert_ucs2_hex_utf8 (void)
 {
@@ -363,6 +659,43 @@ test_take_convert_gsm_utf8 (void)
     g_free (utf8);
 }
 
+static void
+test_hex_to_utf8_invalid (void)
+{
+    static const MMModemCharset charsets[] = {
+        MM_MODEM_CHARSET_UTF8,
+        MM_MODEM_CHARSET_IRA,
+        MM_MODEM_CHARSET_UCS2,
+    };
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (charsets); i++) {
+        g_autofree gchar *odd = NULL;
+        g_autofree gchar *invalid = NULL;
+        g_autofree gchar *empty = NULL;
+
+        /* Invalid input is just reported as not converted */
+        odd = mm_modem_charset_hex_to_utf8 ("0054002", charsets[i]);
+        g_assert_null (odd);
+        invalid = mm_modem_charset_hex_to_utf8 ("00X4", charsets[i]);
+        g_assert_null (invalid);
+        empty = mm_modem_charset_hex_to_utf8 ("", charsets[i]);
+        g_assert_cmpstr (empty, ==, "");
+    }
+}
+
+static void
+test_hex_to_utf8_plain (void)
+{
+    g_autofree gchar *utf8 = NULL;
+    g_autofree gchar *ira = NULL;
+
+    utf8 = mm_modem_charset_hex_to_utf8 ("542D4D6F62696C65C3A9", MM_MODEM_CHARSET_UTF8);
+    g_assert_cmpstr (utf8, ==, "T-Mobile\xc3\xa9");
+    ira = mm_modem_charset_hex_to_utf8 ("542d4d6f62696c65", MM_MODEM_CHARSET_IRA);
+    g_assert_cmpstr (ira, ==, "T-Mobile");
+}
+
 struct charset_can_convert_to_test_s {
     const char *utf8;
     gboolean    to_gsm;
@@ -443,12 +776,19 @@ int main (int argc, char **argv)
     g_test_add_func ("/MM/charsets/gsm7/pack/24-chars",          test_gsm7_pack_24_chars);
     g_test_add_func ("/MM/charsets/gsm7/pack/last-septet-alone", test_gsm7_pack_last_septet_alone);
     g_test_add_func ("/MM/charsets/gsm7/pack/7-chars-offset",    test_gsm7_pack_7_chars_offset);
+    g_test_add_func ("/MM/charsets/gsm7/unpack/reference",       test_gsm7_unpack_reference);
+    g_test_add_func ("/MM/charsets/gsm7/pack/reference",         test_gsm7_pack_reference);
+    g_test_add_func ("/MM/charsets/gsm7/reverse-lookup",         test_gsm7_reverse_lookup);
+    g_test_add_func ("/MM/charsets/gsm7/benchmark",              test_gsm7_benchmark);
 
     g_test_add_func ("/MM/charsets/take-convert/ucs2/hex",         test_take_convert_ucs2_hex_utf8);
     g_test_add_func ("/MM/charsets/take-convert/ucs2/bad-ascii",   test_take_convert_ucs2_bad_ascii);
     g_test_add_func ("/MM/charsets/take-convert/ucs2/bad-ascii-2", test_take_convert_ucs2_bad_ascii2);
     g_test_add_func ("/MM/charsets/take-convert/gsm",              test_take_convert_gsm_utf8);
 
+    g_test_add_func ("/MM/charsets/hex-to-utf8/invalid", test_hex_to_utf8_invalid);
+    g_test_add_func ("/MM/charsets/hex-to-utf8/plain",   test_hex_to_utf8_plain);
+
     g_test_add_func ("/MM/charsets/can-convert-to", test_charset_can_covert_to);
 
     return g_test_run ();
@@ -0,0 +1,255 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <glib.h>
+
+#include "mm-gps-epoch.h"
+#include "mm-log-test.h"
+
+#define GGA "$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,*76"
+#define RMC "$GPRMC,092750.000,A,5321.6802,N,00630.3372,W,0.02,31.66,280511,,,A*43"
+#define GSA "$GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A"
+#define GSV "$GPGSV,3,1,11,10,63,137,17,07,61,098,15,05,59,290,20,08,54,157,30*70"
+#define VTG "$GPVTG,31.66,T,,M,0.02,N,0.04,K,A*3B"
+/* Multi-constellation receivers give one GSA per constellation */
+#define GNGSA_GPS     "$GNGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38,1*0A"
+#define GNGSA_GLONASS "$GNGSA,A,3,65,66,74,,,,,,,,,,1.72,1.03,1.38,2*0A"
+
+/*****************************************************************************/
+
+/* Each epoch is given as its traces, and which one is expected to complete
+ * it, if any (-1) */
+typedef struct {
+    const gchar *traces[8];
+    gint         completed_by;
+} EpochTest;
+
+static void
+common_test_epochs (const EpochTest *epochs,
+                    guint            n_epochs)
+{
+    MMGpsEpoch epoch;
+    guint      i;
+
+    mm_gps_epoch_init (&epoch);
+
+    for (i = 0; i < n_epochs; i++) {
+        guint j;
+
+        for (j = 0; epochs[i].traces[j]; j++) {
+            gboolean completed;
+
+            completed = mm_gps_epoch_add_trace (&epoch, epochs[i].traces[j]);
+            g_debug ("epoch %u, trace %u (%.6s): %s", i, j, epochs[i].traces[j], completed ? "completed" : "-");
+            g_assert_cmpint (completed, ==, ((gint) j == epochs[i].completed_by));
+        }
+    }
+}
+
+static void
+test_epoch_gga_gsa_rmc (void)
+{
+    static const EpochTest epochs[] = {
+        { { GGA, GSA, GSV, GSV, RMC, VTG }, 4 },
+        { { GGA, GSA, GSV, GSV, RMC, VTG }, 4 },
+        { { GGA, GSA, GSV, GSV, RMC, VTG }, 4 },
+    };
+
+    common_test_epochs (epochs, G_N_ELEMENTS (epochs));
+}
+
+static void
+test_epoch_rmc_gga_gsa (void)
+{
+    static const EpochTest epochs[] = {
+        { { RMC, VTG, GGA, GSA, GSV }, 3 },
+        { { RMC, VTG, GGA, GSA, GSV }, 3 },
+        { { RMC, VTG, GGA, GSA, GSV }, 3 },
+    };
+
+    common_test_epochs (epochs, G_N_ELEMENTS (epochs));
+}
+
+static void
+test_epoch_gsa_first (void)
+{
+    static const EpochTest epochs[] = {
+        { { GSA, GSV, GGA, RMC }, 3 },
+        { { GSA, GSV, GGA, RMC }, 3 },
+        { { GSA, GSV, GGA, RMC }, 3 },
+    };
+
+    common_test_epochs (epochs, G_N_ELEMENTS (epochs));
+}
+
+static void
+test_epoch_no_gsa (void)
+{
+    static const EpochTest epochs[] = {
+        /* Until the first epoch is over, GSA is expected */
+        { { GGA, GSV, RMC, VTG }, -1 },
+        { { GGA, GSV, RMC, VTG },  2 },
+        { { GGA, GSV, RMC, VTG },  2 },
+    };
+
+    common_test_epochs (epochs, G_N_ELEMENTS (epochs));
+}
+
+static void
+test_epoch_rmc_only (void)
+{
+    static const EpochTest epochs[] = {
+        { { RMC, GSV }, -1 },
+        { { RMC, GSV },  0 },
+        { { RMC, GSV },  0 },
+    };
+
+    common_test_epochs (epochs, G_N_ELEMENTS (epochs));
+}
+
+static void
+test_epoch_multiple_gsa (void)
+{
+    static const EpochTest epochs[] = {
+        { { GGA, GNGSA_GPS, GNGSA_GLONASS, GSV, RMC },  4 },
+        { { GGA, GNGSA_GPS, GNGSA_GLONASS, GSV, RMC },  4 },
+        /* The epoch is completed by the first GSA when it comes last */
+        { { GGA, RMC, GNGSA_GPS, GSV, GNGSA_GLONASS }, 2 },
+        { { GGA, RMC, GNGSA_GPS, GSV, GNGSA_GLONASS }, 2 },
+    };
+
+    common_test_epochs (epochs, G_N_ELEMENTS (epochs));
+}
+
+static void
+test_epoch_untracked (void)
+{
+    static const EpochTest epochs[] = {
+        /* Without any of the epoch traces, each trace is a whole epoch */
+        { { GSV }, 0 },
+        { { VTG }, 0 },
+        { { "$PQXFI,092750.0,5321.6802,N,00630.3372,W,61.7,4.2,2.1,0.1*5C" }, 0 },
+        /* Truncated or unprefixed traces are not epoch traces */
+        { { "$GPGGA" }, 0 },
+        { { "GPGGA,092750.000" }, 0 },
+        /* But once one is seen, the others are never an epoch on their own */
+        { { GGA, GSV, RMC, GSA }, 3 },
+        { { GSV, VTG }, -1 },
+    };
+
+    common_test_epochs (epochs, G_N_ELEMENTS (epochs));
+}
+
+/*****************************************************************************/
+
+#define MS(x) ((gint64) (x) * 1000)
+
+static void
+test_refresh_due_first (void)
+{
+    /* Nothing published yet */
+    g_assert (mm_gps_refresh_due (0, MS (10), 30000));
+    g_assert (mm_gps_refresh_due (0, MS (10), 0));
+}
+
+static void
+test_refresh_due_rate_0 (void)
+{
+    /* Every complete fix is published */
+    g_assert (mm_gps_refresh_due (MS (1000), MS (1000), 0));
+    g_assert (mm_gps_refresh_due (MS (1000), MS (1001), 0));
+}
+
+static void
+test_refresh_due_jitter (void)
+{
+    /* Up to 50ms earlier than the rate says */
+    g_assert (!mm_gps_refresh_due (MS (1000), MS (1000 + 949), 1000));
+    g_assert (mm_gps_refresh_due (MS (1000), MS (1000 + 950), 1000));
+    g_assert (!mm_gps_refresh_due (MS (1000), MS (1000 + 29949), 30000));
+    g_assert (mm_gps_refresh_due (MS (1000), MS (1000 + 29950), 30000));
+
+    /* Or a tenth of the rate, if lower */
+    g_assert (!mm_gps_refresh_due (MS (1000), MS (1000 + 179), 200));
+    g_assert (mm_gps_refresh_due (MS (1000), MS (1000 + 180), 200));
+    g_assert (!mm_gps_refresh_due (MS (1000), MS (1000 + 8), 10));
+    g_assert (mm_gps_refresh_due (MS (1000), MS (1000 + 9), 10));
+    /* None below 10ms */
+    g_assert (!mm_gps_refresh_due (MS (1000), MS (1000 + 8), 9));
+    g_assert (mm_gps_refresh_due (MS (1000), MS (1000 + 9), 9));
+}
+
+/* Fixes computed by the receiver every fix_ms, received with some jitter,
+ * with updates published every rate_ms */
+static guint
+common_count_refreshes (guint fix_ms,
+                        guint rate_ms,
+                        guint duration_ms)
+{
+    static const gint jitter_ms[] = { 0, 3, -2, 5, -4, 1 };
+    gint64 last_time = 0;
+    guint  refreshes = 0;
+    guint  i;
+
+    for (i = 0; i * fix_ms < duration_ms; i++) {
+        gint64 now;
+
+        now = MS (10000 + i * fix_ms + jitter_ms[i % G_N_ELEMENTS (jitter_ms)]);
+        if (mm_gps_refresh_due (last_time, now, rate_ms)) {
+            last_time = now;
+            refreshes++;
+        }
+    }
+
+    return refreshes;
+}
+
+static void
+test_refresh_due_sub_second (void)
+{
+    /* Rates matching the fix rate publish every fix */
+    g_assert_cmpuint (common_count_refreshes (100, 100, 10000), ==, 100);
+    g_assert_cmpuint (common_count_refreshes (200, 200, 10000), ==, 50);
+    g_assert_cmpuint (common_count_refreshes (1000, 1000, 10000), ==, 10);
+
+    /* Rates slower than the fix rate publish the first fix due */
+    g_assert_cmpuint (common_count_refreshes (100, 250, 10000), ==, 34);
+    g_assert_cmpuint (common_count_refreshes (100, 500, 10000), ==, 20);
+    g_assert_cmpuint (common_count_refreshes (200, 1000, 10000), ==, 10);
+
+    /* Rates faster than the fix rate can't publish more than every fix */
+    g_assert_cmpuint (common_count_refreshes (1000, 100, 10000), ==, 10);
+    g_assert_cmpuint (common_count_refreshes (100, 0, 10000), ==, 100);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/gps-epoch/gga-gsa-rmc",  test_epoch_gga_gsa_rmc);
+    g_test_add_func ("/MM/gps-epoch/rmc-gga-gsa",  test_epoch_rmc_gga_gsa);
+    g_test_add_func ("/MM/gps-epoch/gsa-first",    test_epoch_gsa_first);
+    g_test_add_func ("/MM/gps-epoch/no-gsa",       test_epoch_no_gsa);
+    g_test_add_func ("/MM/gps-epoch/rmc-only",     test_epoch_rmc_only);
+    g_test_add_func ("/MM/gps-epoch/multiple-gsa", test_epoch_multiple_gsa);
+    g_test_add_func ("/MM/gps-epoch/untracked",    test_epoch_untracked);
+
+    g_test_add_func ("/MM/gps-epoch/refresh-due/first",      test_refresh_due_first);
+    g_test_add_func ("/MM/gps-epoch/refresh-due/rate-0",     test_refresh_due_rate_0);
+    g_test_add_func ("/MM/gps-epoch/refresh-due/jitter",     test_refresh_due_jitter);
+    g_test_add_func ("/MM/gps-epoch/refresh-due/sub-second", test_refresh_due_sub_second);
+
+    return g_test_run ();
+}
@@ -0,0 +1,226 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <stdlib.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "mm-kernel-device.h"
+#include "mm-log-test.h"
+
+/*****************************************************************************/
+/* Fake sysfs tree of a USB device */
+
+typedef struct {
+    gchar *root;
+    gchar *physdev;
+} FakeSysfs;
+
+static void
+fake_sysfs_write (const gchar *dir,
+                  const gchar *name,
+                  const gchar *contents)
+{
+    g_autofree gchar *path = NULL;
+    GError           *error = NULL;
+
+    g_assert_cmpint (g_mkdir_with_parents (dir, 0755), ==, 0);
+    path = g_build_filename (dir, name, NULL);
+    g_file_set_contents (path, contents, -1, &error);
+    g_assert_no_error (error);
+}
+
+static void
+fake_sysfs_mkdir (const gchar *dir,
+                  const gchar *name)
+{
+    g_autofree gchar *path = NULL;
+
+    path = g_build_filename (dir, name, NULL);
+    g_assert_cmpint (g_mkdir_with_parents (path, 0755), ==, 0);
+}
+
+static void
+fake_sysfs_init (FakeSysfs   *fake,
+                 const gchar *n_interfaces)
+{
+    GError *error = NULL;
+
+    fake->root = g_dir_make_tmp ("mm-test-kernel-device-XXXXXX", &error);
+    g_assert_no_error (error);
+    fake->physdev = g_build_filename (fake->root, "1-1", NULL);
+    fake_sysfs_write (fake->physdev, "bNumInterfaces", n_interfaces);
+    fake_sysfs_write (fake->physdev, "bConfigurationValue", "1\n");
+}
+
+static gchar *
+fake_sysfs_add_interface (FakeSysfs   *fake,
+                          guint        number,
+                          const gchar *class,
+                          gboolean     bound)
+{
+    g_autofree gchar *name = NULL;
+    gchar            *path;
+
+    name = g_strdup_printf ("1-1:1.%u", number);
+    path = g_build_filename (fake->physdev, name, NULL);
+    fake_sysfs_write (path, "bInterfaceClass", class);
+    if (bound)
+        fake_sysfs_write (path, "driver", "");
+    return path;
+}
+
+static void
+remove_recursive (const gchar *path)
+{
+    GDir *dir;
+
+    dir = g_dir_open (path, 0, NULL);
+    if (dir) {
+        const gchar *name;
+
+        while ((name = g_dir_read_name (dir)) != NULL) {
+            g_autofree gchar *child = NULL;
+
+            child = g_build_filename (path, name, NULL);
+            remove_recursive (child);
+        }
+        g_dir_close (dir);
+        g_rmdir (path);
+    } else
+        g_unlink (path);
+}
+
+static void
+fake_sysfs_clear (FakeSysfs *fake)
+{
+    remove_recursive (fake->root);
+    g_free (fake->physdev);
+    g_free (fake->root);
+}
+
+/*****************************************************************************/
+
+static gint
+compare_strings (gconstpointer a,
+                 gconstpointer b)
+{
+    return g_strcmp0 (*(const gchar **) a, *(const gchar **) b);
+}
+
+/* Order depends on the directory listing */
+static void
+sort_port_names (GStrv port_names)
+{
+    qsort (port_names, g_strv_length (port_names), sizeof (gchar *), compare_strings);
+}
+
+static void
+test_usb_port_names_complete (void)
+{
+    FakeSysfs         fake;
+    g_autofree gchar *iface = NULL;
+    g_auto(GStrv)     port_names = NULL;
+    g_autofree gchar *joined = NULL;
+
+    fake_sysfs_init (&fake, " 5\n");
+
+    /* usb-serial ports */
+    iface = fake_sysfs_add_interface (&fake, 0, "ff\n", TRUE);
+    fake_sysfs_mkdir (iface, "ttyUSB0/tty/ttyUSB0");
+    g_free (iface);
+    iface = fake_sysfs_add_interface (&fake, 1, "ff\n", TRUE);
+    fake_sysfs_mkdir (iface, "ttyUSB1/tty/ttyUSB1");
+    /* QMI port and its net interface */
+    g_free (iface);
+    iface = fake_sysfs_add_interface (&fake, 2, "ff\n", TRUE);
+    fake_sysfs_mkdir (iface, "net/wwan0");
+    fake_sysfs_mkdir (iface, "usbmisc/cdc-wdm0");
+    /* cdc-acm port and its data interface */
+    g_free (iface);
+    iface = fake_sysfs_add_interface (&fake, 3, "02\n", TRUE);
+    fake_sysfs_mkdir (iface, "tty/ttyACM0");
+    g_free (iface);
+    iface = fake_sysfs_add_interface (&fake, 4, "0a\n", TRUE);
+
+    port_names = mm_kernel_device_list_usb_port_names (fake.physdev);
+    g_assert_nonnull (port_names);
+    sort_port_names (port_names);
+    joined = g_strjoinv (",", port_names);
+    g_assert_cmpstr (joined, ==, "cdc-wdm0,ttyACM0,ttyUSB0,ttyUSB1,wwan0");
+
+    fake_sysfs_clear (&fake);
+}
+
+static void
+test_usb_port_names_incomplete (void)
+{
+    FakeSysfs         fake;
+    g_autofree gchar *iface = NULL;
+    g_auto(GStrv)     port_names = NULL;
+
+    fake_sysfs_init (&fake, " 3\n");
+
+    iface = fake_sysfs_add_interface (&fake, 0, "ff\n", TRUE);
+    fake_sysfs_mkdir (iface, "ttyUSB0/tty/ttyUSB0");
+
+    /* Not all interfaces created yet */
+    g_free (iface);
+    iface = fake_sysfs_add_interface (&fake, 1, "08\n", TRUE);
+    g_assert_null (mm_kernel_device_list_usb_port_names (fake.physdev));
+
+    /* Interface without driver */
+    g_free (iface);
+    iface = fake_sysfs_add_interface (&fake, 2, "ff\n", FALSE);
+    g_assert_null (mm_kernel_device_list_usb_port_names (fake.physdev));
+
+    /* Bound, but without known ports */
+    fake_sysfs_write (iface, "driver", "");
+    g_assert_null (mm_kernel_device_list_usb_port_names (fake.physdev));
+
+    /* Complete, the mass storage interface is ignored */
+    fake_sysfs_mkdir (iface, "ttyUSB1/tty/ttyUSB1");
+    port_names = mm_kernel_device_list_usb_port_names (fake.physdev);
+    g_assert_nonnull (port_names);
+    g_assert_cmpuint (g_strv_length (port_names), ==, 2);
+
+    fake_sysfs_clear (&fake);
+}
+
+static void
+test_usb_port_names_not_usb (void)
+{
+    FakeSysfs fake;
+
+    g_assert_null (mm_kernel_device_list_usb_port_names (NULL));
+
+    /* Unconfigured device */
+    fake_sysfs_init (&fake, "\n");
+    g_assert_null (mm_kernel_device_list_usb_port_names (fake.physdev));
+    fake_sysfs_clear (&fake);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/kernel-device/usb-port-names/complete",   test_usb_port_names_complete);
+    g_test_add_func ("/MM/kernel-device/usb-port-names/incomplete", test_usb_port_names_incomplete);
+    g_test_add_func ("/MM/kernel-device/usb-port-names/not-usb",    test_usb_port_names_not_usb);
+
+    return g_test_run ();
+}
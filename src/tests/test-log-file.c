@@ -0,0 +1,269 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "mm-log-file.h"
+#include "mm-log-test.h"
+
+/*****************************************************************************/
+
+typedef struct {
+    gchar *dir;
+    gchar *path;
+    gchar *rotated_path;
+} Fixture;
+
+static void
+fixture_setup (Fixture       *fixture,
+               gconstpointer  data)
+{
+    GError *error = NULL;
+
+    fixture->dir = g_dir_make_tmp ("mm-test-log-file-XXXXXX", &error);
+    g_assert_no_error (error);
+    fixture->path = g_build_filename (fixture->dir, "mm.log", NULL);
+    fixture->rotated_path = g_strdup_printf ("%s.1", fixture->path);
+}
+
+static void
+fixture_teardown (Fixture       *fixture,
+                  gconstpointer  data)
+{
+    g_unlink (fixture->path);
+    g_unlink (fixture->rotated_path);
+    g_rmdir (fixture->dir);
+    g_free (fixture->rotated_path);
+    g_free (fixture->path);
+    g_free (fixture->dir);
+}
+
+static gchar *
+read_file (const gchar *path)
+{
+    gchar  *contents = NULL;
+    GError *error = NULL;
+
+    g_file_get_contents (path, &contents, NULL, &error);
+    g_assert_no_error (error);
+    return contents;
+}
+
+static void
+write_message (MMLogFile *log_file,
+               guint      producer,
+               guint      i,
+               gboolean   flush)
+{
+    gchar message[64];
+    gint  length;
+
+    length = g_snprintf (message, sizeof (message), "producer %u message %04u\n", producer, i);
+    mm_log_file_write (log_file, message, length, flush);
+}
+
+/*****************************************************************************/
+
+static void
+test_order (Fixture       *fixture,
+            gconstpointer  data)
+{
+    MMLogFile        *log_file;
+    g_autofree gchar *contents = NULL;
+    g_auto(GStrv)     lines = NULL;
+    GError           *error = NULL;
+    guint             i;
+
+    log_file = mm_log_file_new (fixture->path, 0, 1000, &error);
+    g_assert_no_error (error);
+    for (i = 0; i < 1000; i++)
+        write_message (log_file, 0, i, FALSE);
+    mm_log_file_free (log_file);
+
+    contents = read_file (fixture->path);
+    lines = g_strsplit (contents, "\n", -1);
+    g_assert_cmpuint (g_strv_length (lines), ==, 1001);
+    for (i = 0; i < 1000; i++) {
+        g_autofree gchar *expected = NULL;
+
+        expected = g_strdup_printf ("producer 0 message %04u", i);
+        g_assert_cmpstr (lines[i], ==, expected);
+    }
+}
+
+static void
+test_sync (Fixture       *fixture,
+           gconstpointer  data)
+{
+    MMLogFile        *log_file;
+    g_autofree gchar *contents = NULL;
+    GError           *error = NULL;
+
+    /* Existing contents are kept */
+    g_file_set_contents (fixture->path, "previous\n", -1, &error);
+    g_assert_no_error (error);
+
+    log_file = mm_log_file_new (fixture->path, 0, 60000, &error);
+    g_assert_no_error (error);
+    write_message (log_file, 0, 0, FALSE);
+    mm_log_file_sync (log_file);
+
+    contents = read_file (fixture->path);
+    g_assert_cmpstr (contents, ==, "previous\nproducer 0 message 0000\n");
+
+    /* Syncing with nothing queued doesn't block */
+    mm_log_file_sync (log_file);
+    mm_log_file_free (log_file);
+}
+
+static void
+test_rotation (Fixture       *fixture,
+               gconstpointer  data)
+{
+    MMLogFile        *log_file;
+    g_autofree gchar *contents = NULL;
+    g_autofree gchar *rotated_contents = NULL;
+    GError           *error = NULL;
+    guint             i;
+
+    /* 24 bytes per message, and syncing after each one so that they're
+     * written one by one */
+    log_file = mm_log_file_new (fixture->path, 100, 0, &error);
+    g_assert_no_error (error);
+    for (i = 0; i < 10; i++) {
+        write_message (log_file, 0, i, TRUE);
+        mm_log_file_sync (log_file);
+    }
+    mm_log_file_free (log_file);
+
+    contents = read_file (fixture->path);
+    rotated_contents = read_file (fixture->rotated_path);
+    g_assert_cmpstr (rotated_contents, ==,
+                     "producer 0 message 0004\n"
+                     "producer 0 message 0005\n"
+                     "producer 0 message 0006\n"
+                     "producer 0 message 0007\n");
+    g_assert_cmpstr (contents, ==,
+                     "producer 0 message 0008\n"
+                     "producer 0 message 0009\n");
+}
+
+#define N_PRODUCERS 4
+#define N_MESSAGES  5000
+
+typedef struct {
+    MMLogFile *log_file;
+    guint      producer;
+} ProducerContext;
+
+static gpointer
+producer_thread (ProducerContext *ctx)
+{
+    guint i;
+
+    for (i = 0; i < N_MESSAGES; i++)
+        write_message (ctx->log_file, ctx->producer, i, (i % 100) == 0);
+    return NULL;
+}
+
+static void
+test_concurrent_producers (Fixture       *fixture,
+                           gconstpointer  data)
+{
+    MMLogFile        *log_file;
+    ProducerContext   ctxs[N_PRODUCERS];
+    GThread          *threads[N_PRODUCERS];
+    guint             next[N_PRODUCERS] = { 0 };
+    g_autofree gchar *contents = NULL;
+    g_auto(GStrv)     lines = NULL;
+    GError           *error = NULL;
+    guint             i;
+
+    log_file = mm_log_file_new (fixture->path, 0, 10, &error);
+    g_assert_no_error (error);
+
+    for (i = 0; i < N_PRODUCERS; i++) {
+        ctxs[i].log_file = log_file;
+        ctxs[i].producer = i;
+        threads[i] = g_thread_new ("producer", (GThreadFunc) producer_thread, &ctxs[i]);
+    }
+    for (i = 0; i < N_PRODUCERS; i++)
+        g_thread_join (threads[i]);
+    mm_log_file_free (log_file);
+
+    /* All messages of each producer are written, in order */
+    contents = read_file (fixture->path);
+    lines = g_strsplit (contents, "\n", -1);
+    g_assert_cmpuint (g_strv_length (lines), ==, N_PRODUCERS * N_MESSAGES + 1);
+    for (i = 0; lines[i] && lines[i][0]; i++) {
+        guint producer;
+        guint message;
+
+        g_assert_cmpint (sscanf (lines[i], "producer %u message %u", &producer, &message), ==, 2);
+        g_assert_cmpuint (producer, <, N_PRODUCERS);
+        g_assert_cmpuint (message, ==, next[producer]);
+        next[producer]++;
+    }
+    for (i = 0; i < N_PRODUCERS; i++)
+        g_assert_cmpuint (next[i], ==, N_MESSAGES);
+}
+
+static void
+test_free_drains (Fixture       *fixture,
+                  gconstpointer  data)
+{
+    MMLogFile        *log_file;
+    g_autofree gchar *contents = NULL;
+    g_auto(GStrv)     lines = NULL;
+    GError           *error = NULL;
+    guint             i;
+
+    /* Long flush interval, nothing is synced before freeing */
+    log_file = mm_log_file_new (fixture->path, 0, 60000, &error);
+    g_assert_no_error (error);
+
+    for (i = 0; i < N_MESSAGES; i++)
+        write_message (log_file, 0, i, FALSE);
+    mm_log_file_free (log_file);
+
+    /* Nothing queued right before freeing is lost */
+    contents = read_file (fixture->path);
+    lines = g_strsplit (contents, "\n", -1);
+    g_assert_cmpuint (g_strv_length (lines), ==, N_MESSAGES + 1);
+    for (i = 0; i < N_MESSAGES; i++) {
+        g_autofree gchar *expected = NULL;
+
+        expected = g_strdup_printf ("producer 0 message %04u", i);
+        g_assert_cmpstr (lines[i], ==, expected);
+    }
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add ("/MM/log-file/order",                Fixture, NULL, fixture_setup, test_order,                fixture_teardown);
+    g_test_add ("/MM/log-file/sync",                 Fixture, NULL, fixture_setup, test_sync,                 fixture_teardown);
+    g_test_add ("/MM/log-file/rotation",             Fixture, NULL, fixture_setup, test_rotation,             fixture_teardown);
+    g_test_add ("/MM/log-file/concurrent-producers", Fixture, NULL, fixture_setup, test_concurrent_producers, fixture_teardown);
+    g_test_add ("/MM/log-file/free-drains",          Fixture, NULL, fixture_setup, test_free_drains,          fixture_teardown);
+
+    return g_test_run ();
+}
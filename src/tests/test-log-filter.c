@@ -0,0 +1,200 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <ModemManager.h>
+#include <libmm-glib.h>
+
+/* This test uses the real logging implementation, so mm-log-test.h is not
+ * included */
+#include "mm-log.h"
+#include "mm-log-object.h"
+
+/*****************************************************************************/
+/* Test log object, with a fixed id */
+
+#define TEST_TYPE_LOG_OBJECT test_log_object_get_type ()
+G_DECLARE_FINAL_TYPE (TestLogObject, test_log_object, TEST, LOG_OBJECT, GObject)
+
+struct _TestLogObject {
+    GObject  parent;
+    gchar   *id;
+};
+
+static void log_object_iface_init (MMLogObjectInterface *iface);
+
+G_DEFINE_TYPE_EXTENDED (TestLogObject, test_log_object, G_TYPE_OBJECT, 0,
+                        G_IMPLEMENT_INTERFACE (MM_TYPE_LOG_OBJECT, log_object_iface_init))
+
+static gchar *
+log_object_build_id (MMLogObject *self)
+{
+    return g_strdup (TEST_LOG_OBJECT (self)->id);
+}
+
+static void
+log_object_iface_init (MMLogObjectInterface *iface)
+{
+    iface->build_id = log_object_build_id;
+}
+
+static void
+test_log_object_init (TestLogObject *self)
+{
+}
+
+static void
+finalize (GObject *object)
+{
+    g_free (TEST_LOG_OBJECT (object)->id);
+    G_OBJECT_CLASS (test_log_object_parent_class)->finalize (object);
+}
+
+static void
+test_log_object_class_init (TestLogObjectClass *klass)
+{
+    G_OBJECT_CLASS (klass)->finalize = finalize;
+}
+
+static TestLogObject *
+test_log_object_new (const gchar *owner_id,
+                     const gchar *id)
+{
+    TestLogObject *self;
+
+    self = g_object_new (TEST_TYPE_LOG_OBJECT, NULL);
+    self->id = g_strdup (id);
+    if (owner_id)
+        mm_log_object_set_owner_id (MM_LOG_OBJECT (self), owner_id);
+    return self;
+}
+
+/*****************************************************************************/
+
+static void
+set_filter (const gchar *level,
+            const gchar *filter)
+{
+    GError *error = NULL;
+
+    g_assert (mm_log_set_level (level, &error));
+    g_assert_no_error (error);
+    g_assert (mm_log_set_filter (filter, &error));
+    g_assert_no_error (error);
+}
+
+static void
+test_no_filters (void)
+{
+    set_filter ("INFO", NULL);
+
+    g_assert (mm_log_check_enabled (NULL, NULL, MM_LOG_LEVEL_ERR));
+    g_assert (mm_log_check_enabled (NULL, NULL, MM_LOG_LEVEL_INFO));
+    g_assert (!mm_log_check_enabled (NULL, NULL, MM_LOG_LEVEL_DEBUG));
+    g_assert (!mm_log_check_enabled (NULL, "shared-telit", MM_LOG_LEVEL_DEBUG));
+}
+
+static void
+test_object_filters (void)
+{
+    g_autoptr(TestLogObject) modem0 = NULL;
+    g_autoptr(TestLogObject) modem1 = NULL;
+    g_autoptr(TestLogObject) port0 = NULL;
+    g_autoptr(TestLogObject) port1 = NULL;
+    g_autoptr(TestLogObject) probe = NULL;
+
+    modem0 = test_log_object_new (NULL, "modem0");
+    modem1 = test_log_object_new (NULL, "modem1");
+    port0 = test_log_object_new ("modem0", "ttyUSB0/at");
+    port1 = test_log_object_new ("modem1", "ttyUSB2/at");
+    probe = test_log_object_new (NULL, "ttyUSB2/probe");
+
+    set_filter ("INFO", "modem0=DEBUG, ttyUSB2=ERR");
+
+    /* Owned objects are included */
+    g_assert (mm_log_check_enabled (modem0, NULL, MM_LOG_LEVEL_DEBUG));
+    g_assert (mm_log_check_enabled (port0, NULL, MM_LOG_LEVEL_DEBUG));
+    g_assert (!mm_log_check_enabled (modem1, NULL, MM_LOG_LEVEL_DEBUG));
+    g_assert (mm_log_check_enabled (modem1, NULL, MM_LOG_LEVEL_INFO));
+    g_assert (!mm_log_check_enabled (NULL, NULL, MM_LOG_LEVEL_DEBUG));
+
+    /* Matched in any component of the id, and the more specific one wins */
+    g_assert (!mm_log_check_enabled (port1, NULL, MM_LOG_LEVEL_WARN));
+    g_assert (mm_log_check_enabled (port1, NULL, MM_LOG_LEVEL_ERR));
+    g_assert (!mm_log_check_enabled (probe, NULL, MM_LOG_LEVEL_INFO));
+    set_filter ("INFO", "modem1=DEBUG,modem1/ttyUSB2=WARN");
+    g_assert (mm_log_check_enabled (modem1, NULL, MM_LOG_LEVEL_DEBUG));
+    g_assert (!mm_log_check_enabled (port1, NULL, MM_LOG_LEVEL_INFO));
+
+    /* Only full components are matched */
+    set_filter ("INFO", "modem=DEBUG,USB0=DEBUG");
+    g_assert (!mm_log_check_enabled (modem0, NULL, MM_LOG_LEVEL_DEBUG));
+    g_assert (!mm_log_check_enabled (port0, NULL, MM_LOG_LEVEL_DEBUG));
+}
+
+static void
+test_module_filters (void)
+{
+    g_autoptr(TestLogObject) modem0 = NULL;
+
+    modem0 = test_log_object_new (NULL, "modem0");
+
+    set_filter ("WARN", "shared-telit=DEBUG,modem0=ERR");
+    g_assert (mm_log_check_enabled (NULL, "shared-telit", MM_LOG_LEVEL_DEBUG));
+    g_assert (!mm_log_check_enabled (NULL, "shared-sierra", MM_LOG_LEVEL_INFO));
+    g_assert (!mm_log_check_enabled (NULL, NULL, MM_LOG_LEVEL_INFO));
+
+    /* Object filters take precedence */
+    g_assert (!mm_log_check_enabled (modem0, "shared-telit", MM_LOG_LEVEL_WARN));
+
+    /* Filters are replaced as a whole */
+    set_filter ("WARN", "");
+    g_assert (!mm_log_check_enabled (NULL, "shared-telit", MM_LOG_LEVEL_DEBUG));
+    g_assert (mm_log_check_enabled (modem0, NULL, MM_LOG_LEVEL_WARN));
+}
+
+static void
+test_invalid_filters (void)
+{
+    static const gchar *invalid[] = { "modem0", "=DEBUG", "modem0=VERBOSE", "modem0=DEBUG,foo" };
+    GError             *error = NULL;
+    guint               i;
+
+    set_filter ("INFO", "modem0=DEBUG");
+    for (i = 0; i < G_N_ELEMENTS (invalid); i++) {
+        g_assert (!mm_log_set_filter (invalid[i], &error));
+        g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_INVALID_ARGS);
+        g_clear_error (&error);
+    }
+
+    /* Previous filters kept */
+    g_assert (mm_log_check_enabled (NULL, "modem0", MM_LOG_LEVEL_DEBUG));
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/log-filter/no-filters",      test_no_filters);
+    g_test_add_func ("/MM/log-filter/object-filters",  test_object_filters);
+    g_test_add_func ("/MM/log-filter/module-filters",  test_module_filters);
+    g_test_add_func ("/MM/log-filter/invalid-filters", test_invalid_filters);
+
+    return g_test_run ();
+}
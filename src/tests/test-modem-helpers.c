@@ -407,6 +407,49 @@ test_cmgl_response_pantech_multiple (void *f, gpointer d)
     test_cmgl_response (str, expected, G_N_ELEMENTS (expected));
 }
 
+static void
+test_cmgl_record_len (void *f, gpointer d)
+{
+    const gchar *str =
+        "\r\n+CMGL: 17,3,35\r\n079100F40D1101000F001000B917118336058F300001954747A0E4ACF41F27298CDCE83C6EF371B0402814020\r\n"
+        "+CMGL: 15,3,,35\r\n079100F40D1101000F001000B917118336058F300001954747A0E4ACF41F27298CDCE83C6EF371B0402814020\r\n"
+        "+CMGL: 13,3,35\r\n079100F40D1101000F001000B917118336058F300\r\n"
+        "\r\nOK\r\n";
+    const guint expected_index[] = { 17, 15, 13 };
+    gsize       len;
+    gsize       start = 0;
+    guint       n_records = 0;
+
+    /* Data given byte by byte, as if it was read from the port; records must
+     * be reported once both of their lines are complete, not before */
+    for (len = 1; len <= strlen (str); len++) {
+        gsize record_len;
+
+        record_len = mm_3gpp_cmgl_record_len (&str[start], len - start);
+        if (record_len > 0) {
+            g_autofree gchar *record = NULL;
+            GList            *list;
+            GError           *error = NULL;
+
+            g_assert_cmpuint (record_len, ==, len - start);
+            g_assert (str[len - 2] == '\r' && str[len - 1] == '\n');
+
+            record = g_strndup (&str[start], record_len);
+            list = mm_3gpp_parse_pdu_cmgl_response (record, &error);
+            g_assert_no_error (error);
+            g_assert_cmpuint (g_list_length (list), ==, 1);
+            g_assert_cmpint (((MM3gppPduInfo *)list->data)->index, ==, expected_index[n_records]);
+            mm_3gpp_pdu_info_list_free (list);
+
+            n_records++;
+            start = len;
+        }
+    }
+
+    g_assert_cmpuint (n_records, ==, G_N_ELEMENTS (expected_index));
+    g_assert_cmpstr (&str[start], ==, "\r\nOK\r\n");
+}
+
 /*****************************************************************************/
 /* Test CMGR responses */
 
@@ -4471,6 +4514,148 @@ test_bcd_to_string (void *f, gpointer d)
 
 /*****************************************************************************/
 
+typedef struct {
+    const gchar *commands[4];
+    const gchar *compound;
+} CompoundCommandTest;
+
+static const CompoundCommandTest compound_command_tests[] = {
+    { { "+CPIN?", "+CSQ" },                  "+CPIN?;+CSQ" },
+    { { "AT+CGDCONT=?", "AT+CPMS?", "+CBC" }, "+CGDCONT=?;+CPMS?;+CBC" },
+    { { "+CPIN?" },                          NULL },
+    { { "AT+CRSM=176,12258,0,0,10", "+CPIN?" }, "+CRSM=176,12258,0,0,10;+CPIN?" },
+    /* Replies of these usually don't have the prefix, only one allowed */
+    { { "+CGMI", "+CGMM" },                  NULL },
+    { { "+CPIN?", "+CGSN" },                 "+CPIN?;+CGSN" },
+    { { "+CRSM=176,12258,0,0,10", "+CIMI" }, "+CRSM=176,12258,0,0,10;+CIMI" },
+    /* Same prefix more than once */
+    { { "+CPIN?", "+CPIN=?" },               NULL },
+    /* Write commands and basic commands */
+    { { "+CPIN?", "+CMGF=0" },               NULL },
+    { { "+CPIN?", "I" },                     NULL },
+};
+
+static void
+test_at_compound_command_build (void *f, gpointer d)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (compound_command_tests); i++) {
+        g_autofree gchar *compound = NULL;
+
+        compound = mm_at_compound_command_build (compound_command_tests[i].commands,
+                                                 g_strv_length ((gchar **) compound_command_tests[i].commands));
+        g_assert_cmpstr (compound, ==, compound_command_tests[i].compound);
+    }
+}
+
+typedef struct {
+    const gchar *commands[4];
+    const gchar *response;
+    const gchar *responses[4];
+} CompoundResponseTest;
+
+static const CompoundResponseTest compound_response_tests[] = {
+    /* Prefixed replies */
+    {
+        { "+CPIN?", "+CSQ" },
+        "+CPIN: READY\r\n\r\n+CSQ: 20,99",
+        { "+CPIN: READY", "+CSQ: 20,99" }
+    },
+    /* Multi-line replies, case-insensitive prefixes */
+    {
+        { "+CGDCONT?", "+CPMS?", "+CBC" },
+        "+CGDCONT: 1,\"IP\",\"internet\"\r\n+CGDCONT: 2,\"IPV6\",\"ims\"\r\n\r\n+cpms: \"SM\",1,20\r\n+CBC: 0,80",
+        { "+CGDCONT: 1,\"IP\",\"internet\"\r\n+CGDCONT: 2,\"IPV6\",\"ims\"", "+cpms: \"SM\",1,20", "+CBC: 0,80" }
+    },
+    /* Bare replies */
+    {
+        { "+CPIN?", "+CSQ" },
+        "READY\r\n\r\n20,99",
+        { NULL }
+    },
+    {
+        { "+CPIN?", "+CSQ" },
+        "+CPIN: READY\r\n\r\n20,99",
+        { NULL }
+    },
+    /* Bare reply in between prefixed lines */
+    {
+        { "+CPIN?", "+CSQ" },
+        "+CPIN: READY\r\nREADY\r\n+CSQ: 20,99",
+        { NULL }
+    },
+    /* Commands without a known prefix */
+    {
+        { "+CGMI", "+CGMM" },
+        "+CGMI: ACME\r\n+CGMM: Rocket",
+        { NULL }
+    },
+    /* A single command without prefix gets the remaining lines */
+    {
+        { "+CRSM=176,12258,0,0,10", "+CIMI" },
+        "+CRSM: 144,0,\"98231400000000000058\"\r\n\r\n214070000000000",
+        { "+CRSM: 144,0,\"98231400000000000058\"", "214070000000000" }
+    },
+    {
+        { "+CIMI", "+CPIN?" },
+        "214070000000000\r\n\r\n+CPIN: READY",
+        { "214070000000000", "+CPIN: READY" }
+    },
+    /* But not if it comes before in the command */
+    {
+        { "+CIMI", "+CPIN?" },
+        "+CPIN: READY\r\n214070000000000",
+        { NULL }
+    },
+    /* Or if missing */
+    {
+        { "+CRSM=176,12258,0,0,10", "+CIMI" },
+        "+CRSM: 144,0,\"98231400000000000058\"",
+        { NULL }
+    },
+    /* Missing reply */
+    {
+        { "+CPIN?", "+CSQ" },
+        "+CSQ: 20,99",
+        { NULL }
+    },
+    /* Out of order */
+    {
+        { "+CPIN?", "+CSQ" },
+        "+CSQ: 20,99\r\n+CPIN: READY",
+        { NULL }
+    },
+};
+
+static void
+test_at_compound_response_split (void *f, gpointer d)
+{
+    guint i;
+
+    for (i = 0; i < G_N_ELEMENTS (compound_response_tests); i++) {
+        g_auto(GStrv) responses = NULL;
+        guint         n_commands;
+        guint         j;
+
+        n_commands = g_strv_length ((gchar **) compound_response_tests[i].commands);
+        responses = mm_at_compound_response_split (compound_response_tests[i].commands,
+                                                   n_commands,
+                                                   compound_response_tests[i].response);
+        if (!compound_response_tests[i].responses[0]) {
+            g_assert (!responses);
+            continue;
+        }
+
+        g_assert (responses);
+        g_assert_cmpuint (g_strv_length (responses), ==, n_commands);
+        for (j = 0; j < n_commands; j++)
+            g_assert_cmpstr (responses[j], ==, compound_response_tests[i].responses[j]);
+    }
+}
+
+/*****************************************************************************/
+
 #define TESTCASE(t, d) g_test_create_case (#t, 0, d, NULL, (GTestFixtureFunc) t, NULL)
 
 int main (int argc, char **argv)
@@ -4667,6 +4852,7 @@ int main (int argc, char **argv)
     g_test_suite_add (suite, TESTCASE (test_cmgl_response_generic_multiple, NULL));
     g_test_suite_add (suite, TESTCASE (test_cmgl_response_pantech, NULL));
     g_test_suite_add (suite, TESTCASE (test_cmgl_response_pantech_multiple, NULL));
+    g_test_suite_add (suite, TESTCASE (test_cmgl_record_len, NULL));
 
     g_test_suite_add (suite, TESTCASE (test_cmgr_response_generic, NULL));
     g_test_suite_add (suite, TESTCASE (test_cmgr_response_telit, NULL));
@@ -4702,6 +4888,9 @@ int main (int argc, char **argv)
 
     g_test_suite_add (suite, TESTCASE (test_bcd_to_string, NULL));
 
+    g_test_suite_add (suite, TESTCASE (test_at_compound_command_build, NULL));
+    g_test_suite_add (suite, TESTCASE (test_at_compound_response_split, NULL));
+
     result = g_test_run ();
 
     reg_test_data_free (reg_data);
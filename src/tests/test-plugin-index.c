@@ -0,0 +1,158 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <string.h>
+#include <glib.h>
+
+#include "mm-plugin-index.h"
+#include "mm-log-test.h"
+
+/* The index is checked against the filters of the real plugins by the
+ * test-service-plugin-index test in plugins/tests; these are just the basic
+ * lookup rules, with a few made up entries. */
+
+/*****************************************************************************/
+
+#define STRV(...) ((const gchar *[]) { __VA_ARGS__, NULL })
+#define VIDS(...) ((const guint16[]) { __VA_ARGS__, 0 })
+#define PIDS(...) ((const mm_uint16_pair[]) { __VA_ARGS__, { 0, 0 } })
+
+static MMPluginIndex *
+build_index (void)
+{
+    MMPluginIndex *index;
+
+    index = mm_plugin_index_new ();
+    /* 0: vendor ID */
+    g_assert_cmpuint (mm_plugin_index_add (index, STRV ("tty", "net", "usbmisc"), NULL, VIDS (0x1199), NULL, FALSE, NULL), ==, 0);
+    /* 1: drivers */
+    g_assert_cmpuint (mm_plugin_index_add (index, STRV ("tty", "net"), STRV ("qmi_wwan"), NULL, NULL, FALSE, NULL), ==, 1);
+    /* 2: vendor and product IDs */
+    g_assert_cmpuint (mm_plugin_index_add (index, STRV ("tty"), NULL, NULL, PIDS ({ 0x22b8, 0x3802 }), FALSE, NULL), ==, 2);
+    /* 3: a full vendor and a subset of another one */
+    g_assert_cmpuint (mm_plugin_index_add (index, STRV ("tty"), NULL, VIDS (0x1111), PIDS ({ 0x2222, 0x0001 }), FALSE, NULL), ==, 3);
+    /* 4: vendor ID, but also vendor strings */
+    g_assert_cmpuint (mm_plugin_index_add (index, STRV ("tty"), NULL, VIDS (0x1bc7), NULL, TRUE, NULL), ==, 4);
+    /* 5: udev tags */
+    g_assert_cmpuint (mm_plugin_index_add (index, STRV ("tty"), NULL, NULL, NULL, FALSE, STRV ("ID_MM_TEST_TAGGED")), ==, 5);
+    /* 6: subsystem only */
+    g_assert_cmpuint (mm_plugin_index_add (index, STRV ("rpmsg"), NULL, NULL, NULL, FALSE, NULL), ==, 6);
+    g_assert_cmpuint (mm_plugin_index_get_n_entries (index), ==, 7);
+
+    return index;
+}
+
+static gboolean
+has_udev_tag (const gchar *tag,
+              const gchar *port_tag)
+{
+    return !g_strcmp0 (tag, port_tag);
+}
+
+/* Expected candidates given as a string of '0' and '1', one per entry */
+static void
+assert_candidates (MMPluginIndex  *index,
+                   const gchar    *subsystem,
+                   const gchar   **drivers,
+                   guint16         vendor,
+                   guint16         product,
+                   const gchar    *udev_tag,
+                   const gchar    *expected)
+{
+    g_autofree guint8 *candidates = NULL;
+    guint              i;
+
+    g_assert_cmpuint (strlen (expected), ==, mm_plugin_index_get_n_entries (index));
+
+    candidates = mm_plugin_index_lookup (index,
+                                         subsystem,
+                                         drivers,
+                                         vendor,
+                                         product,
+                                         (MMPluginIndexUdevTagFunc) has_udev_tag,
+                                         (gpointer) udev_tag);
+    for (i = 0; expected[i]; i++) {
+        g_debug ("  entry %u: %s", i, candidates[i] ? "candidate" : "discarded");
+        g_assert_cmpuint (!!candidates[i], ==, (expected[i] == '1'));
+    }
+}
+
+static void
+test_subsystems (void)
+{
+    g_autoptr(MMPluginIndex) index = NULL;
+
+    index = build_index ();
+    assert_candidates (index, "rpmsg",   STRV ("qmi_wwan"), 0x1199, 0x0001, "ID_MM_TEST_TAGGED", "0000001");
+    assert_candidates (index, "usbmisc", STRV ("qmi_wwan"), 0x1199, 0x0001, NULL,                "1000000");
+    assert_candidates (index, "wwan",    STRV ("qmi_wwan"), 0x1199, 0x0001, NULL,                "0000000");
+}
+
+static void
+test_drivers (void)
+{
+    g_autoptr(MMPluginIndex) index = NULL;
+
+    index = build_index ();
+    assert_candidates (index, "net", STRV ("qmi_wwan"),              0x1234, 0x0001, NULL, "0100000");
+    assert_candidates (index, "net", STRV ("cdc_ether", "qmi_wwan"), 0x1234, 0x0001, NULL, "0100000");
+    assert_candidates (index, "net", STRV ("cdc_ether"),             0x1234, 0x0001, NULL, "0000000");
+    /* Without drivers given, no entry is discarded by driver */
+    assert_candidates (index, "net", NULL,                           0x1234, 0x0001, NULL, "0100000");
+}
+
+static void
+test_ids (void)
+{
+    g_autoptr(MMPluginIndex) index = NULL;
+
+    index = build_index ();
+    assert_candidates (index, "tty", STRV ("option"), 0x1199, 0x68c0, NULL, "1000100");
+    assert_candidates (index, "tty", STRV ("option"), 0x22b8, 0x3802, NULL, "0010100");
+    assert_candidates (index, "tty", STRV ("option"), 0x22b8, 0x3803, NULL, "0000100");
+    assert_candidates (index, "tty", STRV ("option"), 0x1111, 0x0009, NULL, "0001100");
+    assert_candidates (index, "tty", STRV ("option"), 0x2222, 0x0001, NULL, "0001100");
+    assert_candidates (index, "tty", STRV ("option"), 0x2222, 0x0002, NULL, "0000100");
+    /* Unknown vendor and product */
+    assert_candidates (index, "tty", STRV ("option"), 0,      0,      NULL, "0000100");
+}
+
+static void
+test_udev_tags (void)
+{
+    g_autoptr(MMPluginIndex)  index = NULL;
+    g_autofree guint8        *candidates = NULL;
+
+    index = build_index ();
+    assert_candidates (index, "tty", STRV ("option"), 0x1234, 0x0001, "ID_MM_TEST_TAGGED", "0000110");
+    assert_candidates (index, "tty", STRV ("option"), 0x1234, 0x0001, "ID_MM_OTHER_TAG",   "0000100");
+
+    /* Without a tag checker, entries with tags are discarded */
+    candidates = mm_plugin_index_lookup (index, "tty", NULL, 0x1234, 0x0001, NULL, NULL);
+    g_assert_false (candidates[5]);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/plugin-index/subsystems", test_subsystems);
+    g_test_add_func ("/MM/plugin-index/drivers",    test_drivers);
+    g_test_add_func ("/MM/plugin-index/ids",        test_ids);
+    g_test_add_func ("/MM/plugin-index/udev-tags",  test_udev_tags);
+
+    return g_test_run ();
+}
@@ -0,0 +1,278 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <ModemManager.h>
+#include <libmm-glib.h>
+
+#include "mm-plugin-manifest.h"
+#include "mm-log-test.h"
+
+/*****************************************************************************/
+
+typedef struct {
+    gchar *dir;
+    gchar *manifest_path;
+    gchar *plugin_path;
+    gchar *generic_path;
+} Fixture;
+
+static gchar *
+fixture_create_module (Fixture     *fixture,
+                       const gchar *name,
+                       const gchar *contents)
+{
+    gchar  *path;
+    GError *error = NULL;
+
+    path = g_build_filename (fixture->dir, name, NULL);
+    g_file_set_contents (path, contents, -1, &error);
+    g_assert_no_error (error);
+    return path;
+}
+
+static void
+fixture_setup (Fixture       *fixture,
+               gconstpointer  data)
+{
+    GError *error = NULL;
+
+    fixture->dir = g_dir_make_tmp ("mm-test-plugin-manifest-XXXXXX", &error);
+    g_assert_no_error (error);
+    fixture->manifest_path = g_build_filename (fixture->dir, "state", "plugin-manifest", NULL);
+    fixture->plugin_path = fixture_create_module (fixture, "libmm-plugin-test.so", "plugin");
+    fixture->generic_path = fixture_create_module (fixture, "libmm-plugin-generic.so", "generic");
+}
+
+static void
+fixture_teardown (Fixture       *fixture,
+                  gconstpointer  data)
+{
+    g_autofree gchar *state_dir = NULL;
+
+    state_dir = g_path_get_dirname (fixture->manifest_path);
+    g_unlink (fixture->manifest_path);
+    g_rmdir (state_dir);
+    g_unlink (fixture->plugin_path);
+    g_unlink (fixture->generic_path);
+    g_rmdir (fixture->dir);
+    g_free (fixture->manifest_path);
+    g_free (fixture->plugin_path);
+    g_free (fixture->generic_path);
+    g_free (fixture->dir);
+}
+
+/*****************************************************************************/
+
+static const gchar          *test_subsystems[]  = { "tty", "net", NULL };
+static const gchar          *test_drivers[]     = { "qmi_wwan", "option", NULL };
+static const gchar          *test_udev_tags[]   = { "ID_MM_TEST_TAG", NULL };
+static const guint16         test_vendor_ids[]  = { 0x1199, 0x05c6, 0 };
+static const mm_uint16_pair  test_product_ids[] = { { 0x1199, 0x68a3 }, { 0x413c, 0x81d7 }, { 0, 0 } };
+
+static void
+fill_test_entry (MMPluginManifestEntry *entry)
+{
+    entry->name         = (gchar *) "Test";
+    entry->subsystems   = (gchar **) test_subsystems;
+    entry->drivers      = (gchar **) test_drivers;
+    entry->udev_tags    = (gchar **) test_udev_tags;
+    entry->vendor_ids   = (guint16 *) test_vendor_ids;
+    entry->product_ids  = (mm_uint16_pair *) test_product_ids;
+    entry->ids_optional = TRUE;
+}
+
+static void
+assert_strv_equal (gchar       **strv,
+                   const gchar **expected)
+{
+    guint i;
+
+    g_assert_nonnull (strv);
+    for (i = 0; expected[i]; i++)
+        g_assert_cmpstr (strv[i], ==, expected[i]);
+    g_assert_null (strv[i]);
+}
+
+static void
+save_test_manifest (Fixture *fixture)
+{
+    g_autoptr(MMPluginManifest) manifest = NULL;
+    MMPluginManifestEntry       entry = { 0 };
+    MMPluginManifestEntry       generic = { 0 };
+    GError                     *error = NULL;
+
+    manifest = mm_plugin_manifest_new ();
+
+    fill_test_entry (&entry);
+    g_assert (mm_plugin_manifest_add (manifest, fixture->plugin_path, &entry, &error));
+    g_assert_no_error (error);
+
+    generic.name = (gchar *) "generic";
+    generic.generic = TRUE;
+    generic.subsystems = (gchar **) test_subsystems;
+    g_assert (mm_plugin_manifest_add (manifest, fixture->generic_path, &generic, &error));
+    g_assert_no_error (error);
+
+    g_assert_cmpuint (mm_plugin_manifest_get_n_entries (manifest), ==, 2);
+    g_assert (mm_plugin_manifest_save (manifest, fixture->manifest_path, &error));
+    g_assert_no_error (error);
+}
+
+static void
+test_round_trip (Fixture       *fixture,
+                 gconstpointer  data)
+{
+    g_autoptr(MMPluginManifest)      manifest = NULL;
+    g_autoptr(MMPluginManifestEntry) entry = NULL;
+    g_autoptr(MMPluginManifestEntry) generic = NULL;
+    GError                          *error = NULL;
+    guint                            i;
+
+    save_test_manifest (fixture);
+
+    manifest = mm_plugin_manifest_load (fixture->manifest_path, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (manifest);
+    g_assert_cmpuint (mm_plugin_manifest_get_n_entries (manifest), ==, 2);
+
+    entry = mm_plugin_manifest_lookup (manifest, fixture->plugin_path);
+    g_assert_nonnull (entry);
+    g_assert_cmpstr (entry->name, ==, "Test");
+    g_assert (!entry->generic);
+    g_assert (entry->ids_optional);
+    assert_strv_equal (entry->subsystems, test_subsystems);
+    assert_strv_equal (entry->drivers,    test_drivers);
+    assert_strv_equal (entry->udev_tags,  test_udev_tags);
+    for (i = 0; i < G_N_ELEMENTS (test_vendor_ids); i++)
+        g_assert_cmpuint (entry->vendor_ids[i], ==, test_vendor_ids[i]);
+    for (i = 0; i < G_N_ELEMENTS (test_product_ids); i++) {
+        g_assert_cmpuint (entry->product_ids[i].l, ==, test_product_ids[i].l);
+        g_assert_cmpuint (entry->product_ids[i].r, ==, test_product_ids[i].r);
+    }
+
+    /* Unused filters are kept unset */
+    generic = mm_plugin_manifest_lookup (manifest, fixture->generic_path);
+    g_assert_nonnull (generic);
+    g_assert_cmpstr (generic->name, ==, "generic");
+    g_assert (generic->generic);
+    g_assert (!generic->ids_optional);
+    g_assert_nonnull (generic->subsystems);
+    g_assert_null (generic->drivers);
+    g_assert_null (generic->udev_tags);
+    g_assert_null (generic->vendor_ids);
+    g_assert_null (generic->product_ids);
+
+    /* Unknown modules */
+    g_assert_null (mm_plugin_manifest_lookup (manifest, "/nonexistent/libmm-plugin-test.so"));
+}
+
+static void
+test_stale_entry (Fixture       *fixture,
+                  gconstpointer  data)
+{
+    g_autoptr(MMPluginManifest)       manifest = NULL;
+    g_autoptr(MMPluginManifestEntry)  generic = NULL;
+    g_autofree gchar                 *plugin_path = NULL;
+    GError                           *error = NULL;
+
+    save_test_manifest (fixture);
+
+    /* Module replaced by a different one */
+    plugin_path = fixture_create_module (fixture, "libmm-plugin-test.so", "updated plugin");
+
+    manifest = mm_plugin_manifest_load (fixture->manifest_path, &error);
+    g_assert_no_error (error);
+    g_assert_null (mm_plugin_manifest_lookup (manifest, fixture->plugin_path));
+    generic = mm_plugin_manifest_lookup (manifest, fixture->generic_path);
+    g_assert_nonnull (generic);
+
+    /* Module removed */
+    g_unlink (fixture->generic_path);
+    g_assert_null (mm_plugin_manifest_lookup (manifest, fixture->generic_path));
+}
+
+static void
+test_invalid_manifest (Fixture       *fixture,
+                       gconstpointer  data)
+{
+    g_autoptr(MMPluginManifest)  manifest = NULL;
+    g_autofree gchar            *contents = NULL;
+    gchar                       *version;
+    GError                      *error = NULL;
+
+    /* Missing */
+    manifest = mm_plugin_manifest_load (fixture->manifest_path, &error);
+    g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+    g_assert_null (manifest);
+    g_clear_error (&error);
+
+    /* Written by another daemon version */
+    save_test_manifest (fixture);
+    g_file_get_contents (fixture->manifest_path, &contents, NULL, &error);
+    g_assert_no_error (error);
+    version = strstr (contents, "daemon-version=");
+    g_assert_nonnull (version);
+    version[strlen ("daemon-version=")] = 'x';
+    g_file_set_contents (fixture->manifest_path, contents, -1, &error);
+    g_assert_no_error (error);
+
+    manifest = mm_plugin_manifest_load (fixture->manifest_path, &error);
+    g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_WRONG_STATE);
+    g_assert_null (manifest);
+    g_clear_error (&error);
+}
+
+static void
+test_invalid_entry (Fixture       *fixture,
+                    gconstpointer  data)
+{
+    g_autoptr(MMPluginManifest)  manifest = NULL;
+    g_autofree gchar            *contents = NULL;
+    gchar                       *product_ids;
+    GError                      *error = NULL;
+
+    save_test_manifest (fixture);
+
+    /* Malformed product IDs make the entry invalid */
+    g_file_get_contents (fixture->manifest_path, &contents, NULL, &error);
+    g_assert_no_error (error);
+    product_ids = strstr (contents, "1199:68a3");
+    g_assert_nonnull (product_ids);
+    product_ids[4] = '-';
+    g_file_set_contents (fixture->manifest_path, contents, -1, &error);
+    g_assert_no_error (error);
+
+    manifest = mm_plugin_manifest_load (fixture->manifest_path, &error);
+    g_assert_no_error (error);
+    g_assert_null (mm_plugin_manifest_lookup (manifest, fixture->plugin_path));
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add ("/MM/plugin-manifest/round-trip",       Fixture, NULL, fixture_setup, test_round_trip,       fixture_teardown);
+    g_test_add ("/MM/plugin-manifest/stale-entry",      Fixture, NULL, fixture_setup, test_stale_entry,      fixture_teardown);
+    g_test_add ("/MM/plugin-manifest/invalid-manifest", Fixture, NULL, fixture_setup, test_invalid_manifest, fixture_teardown);
+    g_test_add ("/MM/plugin-manifest/invalid-entry",    Fixture, NULL, fixture_setup, test_invalid_entry,    fixture_teardown);
+
+    return g_test_run ();
+}
@@ -0,0 +1,227 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "mm-regex-registry.h"
+#include "mm-modem-helpers.h"
+#include "mm-log-test.h"
+
+/*****************************************************************************/
+
+static GRegex *
+get_csq_regex (void)
+{
+    return mm_regex_get ("\\+CSQ:\\s*(\\d+),(\\d+)", G_REGEX_RAW);
+}
+
+static GRegex *
+get_csq_regex_other_site (void)
+{
+    return mm_regex_get ("\\+CSQ:\\s*(\\d+),(\\d+)", G_REGEX_RAW);
+}
+
+typedef struct {
+    const gchar  *pattern;
+    MMRegexStats  stats;
+    gboolean      found;
+} FindStatsContext;
+
+static void
+find_stats (const MMRegexStats *stats,
+            FindStatsContext   *ctx)
+{
+    if (g_str_equal (stats->pattern, ctx->pattern)) {
+        g_assert (!ctx->found);
+        ctx->stats = *stats;
+        ctx->found = TRUE;
+    }
+}
+
+static void
+assert_stats (const gchar  *pattern,
+              MMRegexStats *out_stats)
+{
+    FindStatsContext ctx = { .pattern = pattern };
+
+    mm_regex_registry_foreach_stats ((MMRegexStatsFunc) find_stats, &ctx);
+    g_assert (ctx.found);
+    *out_stats = ctx.stats;
+}
+
+/*****************************************************************************/
+
+static void
+test_compiled_once (void)
+{
+    GRegex       *r1;
+    GRegex       *r2;
+    GRegex       *r3;
+    guint         n_compiles;
+    MMRegexStats  stats;
+
+    r1 = get_csq_regex ();
+    g_assert (r1);
+    n_compiles = mm_regex_registry_get_n_compiles ();
+
+    /* Same call site */
+    r2 = get_csq_regex ();
+    g_assert (r1 == r2);
+
+    /* Different call site, same pattern */
+    r3 = get_csq_regex_other_site ();
+    g_assert (r1 == r3);
+    g_assert_cmpuint (mm_regex_registry_get_n_compiles (), ==, n_compiles);
+
+    assert_stats ("\\+CSQ:\\s*(\\d+),(\\d+)", &stats);
+    g_assert_cmpuint (stats.n_sites, ==, 2);
+    g_assert_cmpuint (stats.n_compiles, ==, 1);
+    g_assert_cmpuint (stats.n_gets, ==, 3);
+
+    /* References are owned by the callers, the registry keeps its own */
+    g_regex_unref (r1);
+    g_regex_unref (r2);
+    g_regex_unref (r3);
+    r1 = get_csq_regex ();
+    g_assert (g_regex_match (r1, "+CSQ: 20,99", 0, NULL));
+    g_regex_unref (r1);
+}
+
+static void
+test_flags (void)
+{
+    GRegex *r1;
+    GRegex *r2;
+
+    /* Same pattern with different flags are different regexes */
+    r1 = mm_regex_get_dynamic ("^ok$", 0);
+    r2 = mm_regex_get_dynamic ("^ok$", G_REGEX_CASELESS);
+    g_assert (r1 != r2);
+    g_assert (!g_regex_match (r1, "OK", 0, NULL));
+    g_assert (g_regex_match (r2, "OK", 0, NULL));
+    g_regex_unref (r1);
+    g_regex_unref (r2);
+}
+
+static void
+test_dynamic (void)
+{
+    GPtrArray *array1;
+    GPtrArray *array2;
+    guint      n_compiles;
+    guint      i;
+
+    array1 = mm_3gpp_creg_regex_get (TRUE);
+    n_compiles = mm_regex_registry_get_n_compiles ();
+    array2 = mm_3gpp_creg_regex_get (TRUE);
+    g_assert_cmpuint (mm_regex_registry_get_n_compiles (), ==, n_compiles);
+
+    g_assert_cmpuint (array1->len, ==, array2->len);
+    for (i = 0; i < array1->len; i++) {
+        g_assert (g_ptr_array_index (array1, i) == g_ptr_array_index (array2, i));
+        /* All patterns built in the same call site must still be different */
+        if (i > 0)
+            g_assert (g_ptr_array_index (array1, i) != g_ptr_array_index (array1, i - 1));
+    }
+
+    mm_3gpp_creg_regex_destroy (array1);
+    mm_3gpp_creg_regex_destroy (array2);
+}
+
+static void
+test_match_stats (void)
+{
+    GRegex       *r;
+    GMatchInfo   *match_info = NULL;
+    MMRegexStats  stats;
+    guint         n_matches;
+    guint         i;
+
+    r = mm_regex_get ("\\+CMTI:\\s*\"(\\S+)\",\\s*(\\d+)", 0);
+    assert_stats ("\\+CMTI:\\s*\"(\\S+)\",\\s*(\\d+)", &stats);
+    n_matches = stats.n_matches;
+
+    /* Not accounted unless enabled */
+    g_assert (mm_regex_match (r, "+CMTI: \"SM\",3", 0, NULL));
+    assert_stats ("\\+CMTI:\\s*\"(\\S+)\",\\s*(\\d+)", &stats);
+    g_assert_cmpuint (stats.n_matches, ==, n_matches);
+
+    mm_regex_registry_set_stats_enabled (TRUE);
+    for (i = 0; i < 10; i++) {
+        g_assert (mm_regex_match (r, "+CMTI: \"SM\",3", 0, &match_info));
+        g_assert (g_match_info_matches (match_info));
+        g_match_info_free (match_info);
+    }
+    g_assert (!mm_regex_match_full (r, "+CMTI: \"SM\",3", -1, 8, 0, NULL, NULL));
+    mm_regex_registry_set_stats_enabled (FALSE);
+
+    assert_stats ("\\+CMTI:\\s*\"(\\S+)\",\\s*(\\d+)", &stats);
+    g_assert_cmpuint (stats.n_matches, ==, n_matches + 11);
+    g_assert_cmpint (stats.match_time, >=, 0);
+
+    g_regex_unref (r);
+}
+
+#define N_THREADS 8
+
+static gpointer
+get_from_thread (gpointer user_data)
+{
+    guint i;
+
+    for (i = 0; i < 1000; i++) {
+        GRegex *r;
+
+        r = mm_regex_get ("^\\+CREG:\\s*(\\d+)\\s*$", 0);
+        g_assert (r);
+        g_assert (g_regex_match (r, "+CREG: 1", 0, NULL));
+        g_regex_unref (r);
+    }
+    return NULL;
+}
+
+static void
+test_threads (void)
+{
+    GThread      *threads[N_THREADS];
+    MMRegexStats  stats;
+    guint         i;
+
+    for (i = 0; i < N_THREADS; i++)
+        threads[i] = g_thread_new ("regex", get_from_thread, NULL);
+    for (i = 0; i < N_THREADS; i++)
+        g_thread_join (threads[i]);
+
+    assert_stats ("^\\+CREG:\\s*(\\d+)\\s*$", &stats);
+    g_assert_cmpuint (stats.n_compiles, ==, 1);
+    g_assert_cmpuint (stats.n_sites, ==, 1);
+    g_assert_cmpuint (stats.n_gets, ==, N_THREADS * 1000);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/regex-registry/compiled-once", test_compiled_once);
+    g_test_add_func ("/MM/regex-registry/flags",         test_flags);
+    g_test_add_func ("/MM/regex-registry/dynamic",       test_dynamic);
+    g_test_add_func ("/MM/regex-registry/match-stats",   test_match_stats);
+    g_test_add_func ("/MM/regex-registry/threads",       test_threads);
+
+    return g_test_run ();
+}
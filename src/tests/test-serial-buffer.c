@@ -0,0 +1,221 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <string.h>
+#include <glib.h>
+
+#include "mm-serial-buffer.h"
+#include "mm-log-test.h"
+
+/*****************************************************************************/
+/* Recorded modem traffic */
+
+/* A +CMGL listing record, as received from a modem with PDU mode */
+static const gchar *cmgl_record =
+    "\r\n+CMGL: 0,1,,40\r\n"
+    "07914356060013F1065A098136397339F7219011700463802190117004638030\r\n";
+
+/* NMEA traces received in an AT port with GPS enabled */
+static const gchar *nmea_traces =
+    "$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,*76\r\n"
+    "$GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A\r\n"
+    "$GPGSV,3,1,11,10,63,137,17,07,61,098,15,05,59,290,20,08,54,157,30*70\r\n"
+    "$GPRMC,092750.000,A,5321.6802,N,00630.3372,W,0.02,31.66,280511,,,A*43\r\n";
+
+/*****************************************************************************/
+
+static void
+test_append_consume (void)
+{
+    g_autoptr(MMSerialBuffer) buffer = NULL;
+
+    buffer = mm_serial_buffer_new (8);
+    g_assert_cmpuint (buffer->len, ==, 0);
+
+    mm_serial_buffer_append (buffer, (const guint8 *) "abc", 3);
+    g_assert_cmpuint (buffer->len, ==, 3);
+    g_assert (memcmp (buffer->data, "abc", 3) == 0);
+
+    mm_serial_buffer_consume (buffer, 1);
+    g_assert_cmpuint (buffer->len, ==, 2);
+    g_assert (memcmp (buffer->data, "bc", 2) == 0);
+
+    /* Needs room: either moves pending data back or grows */
+    mm_serial_buffer_append (buffer, (const guint8 *) "defghij", 7);
+    g_assert_cmpuint (buffer->len, ==, 9);
+    g_assert (memcmp (buffer->data, "bcdefghij", 9) == 0);
+
+    mm_serial_buffer_truncate (buffer, 4);
+    g_assert_cmpuint (buffer->len, ==, 4);
+    g_assert (memcmp (buffer->data, "bcde", 4) == 0);
+
+    mm_serial_buffer_consume (buffer, 4);
+    g_assert_cmpuint (buffer->len, ==, 0);
+
+    mm_serial_buffer_append (buffer, (const guint8 *) "k", 1);
+    mm_serial_buffer_clear (buffer);
+    g_assert_cmpuint (buffer->len, ==, 0);
+}
+
+static void
+test_random_operations (void)
+{
+    g_autoptr(MMSerialBuffer) buffer = NULL;
+    g_autoptr(GByteArray)     reference = NULL;
+    guint8                    chunk[300];
+    guint                     i;
+    guint                     j;
+
+    buffer = mm_serial_buffer_new (64);
+    reference = g_byte_array_new ();
+
+    for (i = 0; i < 10000; i++) {
+        guint len;
+
+        switch (g_test_rand_int_range (0, 3)) {
+        case 0:
+            len = g_test_rand_int_range (0, sizeof (chunk));
+            for (j = 0; j < len; j++)
+                chunk[j] = (guint8) g_test_rand_int_range (0, 256);
+            mm_serial_buffer_append (buffer, chunk, len);
+            g_byte_array_append (reference, chunk, len);
+            break;
+        case 1:
+            len = g_test_rand_int_range (0, reference->len + 1);
+            mm_serial_buffer_consume (buffer, len);
+            g_byte_array_remove_range (reference, 0, len);
+            break;
+        case 2:
+            len = g_test_rand_int_range (0, reference->len + 1);
+            mm_serial_buffer_truncate (buffer, len);
+            g_byte_array_set_size (reference, len);
+            break;
+        default:
+            g_assert_not_reached ();
+        }
+
+        g_assert_cmpuint (buffer->len, ==, reference->len);
+        g_assert (memcmp (buffer->data, reference->data, reference->len) == 0);
+    }
+}
+
+/*****************************************************************************/
+/* Benchmark: feed recorded traffic in read-sized chunks, consuming each line
+ * from the front as soon as it's complete, like the serial port parsers do. */
+
+#define BENCHMARK_READ_SIZE 64
+
+static guint
+consume_lines_serial_buffer (MMSerialBuffer *buffer)
+{
+    guint n_lines = 0;
+    guint8 *lf;
+
+    while ((lf = memchr (buffer->data, '\n', buffer->len)) != NULL) {
+        mm_serial_buffer_consume (buffer, (lf - buffer->data) + 1);
+        n_lines++;
+    }
+    return n_lines;
+}
+
+static guint
+consume_lines_byte_array (GByteArray *array)
+{
+    guint n_lines = 0;
+    guint8 *lf;
+
+    while ((lf = memchr (array->data, '\n', array->len)) != NULL) {
+        g_byte_array_remove_range (array, 0, (lf - array->data) + 1);
+        n_lines++;
+    }
+    return n_lines;
+}
+
+static void
+run_benchmark (const gchar *name,
+               const gchar *record,
+               guint        n_records)
+{
+    g_autoptr(GString)        traffic = NULL;
+    g_autoptr(MMSerialBuffer) buffer = NULL;
+    g_autoptr(GByteArray)     array = NULL;
+    GTimer                   *timer;
+    gdouble                   buffer_elapsed;
+    gdouble                   array_elapsed;
+    guint                     buffer_lines = 0;
+    guint                     array_lines = 0;
+    guint                     i;
+
+    traffic = g_string_new (NULL);
+    for (i = 0; i < n_records; i++)
+        g_string_append (traffic, record);
+
+    buffer = mm_serial_buffer_new (8192);
+    array = g_byte_array_sized_new (500);
+    timer = g_timer_new ();
+
+    g_timer_start (timer);
+    for (i = 0; i < traffic->len; i += BENCHMARK_READ_SIZE) {
+        mm_serial_buffer_append (buffer, (const guint8 *) &traffic->str[i], MIN (BENCHMARK_READ_SIZE, traffic->len - i));
+        buffer_lines += consume_lines_serial_buffer (buffer);
+    }
+    buffer_elapsed = g_timer_elapsed (timer, NULL);
+
+    g_timer_start (timer);
+    for (i = 0; i < traffic->len; i += BENCHMARK_READ_SIZE) {
+        g_byte_array_append (array, (const guint8 *) &traffic->str[i], MIN (BENCHMARK_READ_SIZE, traffic->len - i));
+        array_lines += consume_lines_byte_array (array);
+    }
+    array_elapsed = g_timer_elapsed (timer, NULL);
+
+    g_timer_destroy (timer);
+
+    g_assert_cmpuint (buffer_lines, ==, array_lines);
+    g_test_message ("%s: %u bytes, %u lines: serial buffer %.3f ms, byte array %.3f ms",
+                    name, (guint) traffic->len, buffer_lines,
+                    buffer_elapsed * 1000.0, array_elapsed * 1000.0);
+    g_test_minimized_result (buffer_elapsed, "%s: %.3f ms", name, buffer_elapsed * 1000.0);
+}
+
+static void
+test_benchmark_cmgl (void)
+{
+    if (!g_test_perf ())
+        return;
+
+    run_benchmark ("CMGL listing", cmgl_record, 10000);
+}
+
+static void
+test_benchmark_nmea (void)
+{
+    if (!g_test_perf ())
+        return;
+
+    run_benchmark ("NMEA on AT", nmea_traces, 10000);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/serial-buffer/append-consume",   test_append_consume);
+    g_test_add_func ("/MM/serial-buffer/random-operations", test_random_operations);
+    g_test_add_func ("/MM/serial-buffer/benchmark/cmgl",   test_benchmark_cmgl);
+    g_test_add_func ("/MM/serial-buffer/benchmark/nmea",   test_benchmark_nmea);
+
+    return g_test_run ();
+}
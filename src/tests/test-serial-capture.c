@@ -0,0 +1,242 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <ModemManager.h>
+#include <libmm-glib.h>
+
+#include "mm-serial-capture.h"
+#include "mm-log-test.h"
+
+/*****************************************************************************/
+
+typedef struct {
+    gchar *dir;
+    gchar *path;
+    gchar *rotated_path;
+} Fixture;
+
+static void
+fixture_setup (Fixture       *fixture,
+               gconstpointer  data)
+{
+    GError *error = NULL;
+
+    fixture->dir = g_dir_make_tmp ("mm-test-serial-capture-XXXXXX", &error);
+    g_assert_no_error (error);
+    fixture->path = g_build_filename (fixture->dir, "ttyUSB0.mmcap", NULL);
+    fixture->rotated_path = g_strdup_printf ("%s.1", fixture->path);
+}
+
+static void
+fixture_teardown (Fixture       *fixture,
+                  gconstpointer  data)
+{
+    mm_serial_capture_setup (NULL, NULL, 0);
+    g_unlink (fixture->path);
+    g_unlink (fixture->rotated_path);
+    g_rmdir (fixture->dir);
+    g_free (fixture->rotated_path);
+    g_free (fixture->path);
+    g_free (fixture->dir);
+}
+
+static void
+assert_next_record (MMSerialCaptureReader    *reader,
+                    MMSerialCaptureDirection  expected_direction,
+                    const gchar              *expected_data)
+{
+    gint64                    timestamp = 0;
+    MMSerialCaptureDirection  direction;
+    const guint8             *data;
+    gsize                     len;
+    GError                   *error = NULL;
+
+    g_assert (mm_serial_capture_reader_next (reader, &timestamp, &direction, &data, &len, &error));
+    g_assert_no_error (error);
+    g_assert_cmpint (timestamp, >, 0);
+    g_assert_cmpuint (direction, ==, expected_direction);
+    g_assert_cmpuint (len, ==, strlen (expected_data));
+    g_assert (memcmp (data, expected_data, len) == 0);
+}
+
+static void
+assert_no_more_records (MMSerialCaptureReader *reader)
+{
+    GError *error = NULL;
+
+    g_assert (!mm_serial_capture_reader_next (reader, NULL, NULL, NULL, NULL, &error));
+    g_assert_no_error (error);
+}
+
+/*****************************************************************************/
+
+static void
+test_round_trip (Fixture       *fixture,
+                 gconstpointer  data)
+{
+    g_autoptr(MMSerialCapture)       capture = NULL;
+    g_autoptr(MMSerialCaptureReader) reader = NULL;
+    GError                          *error = NULL;
+
+    capture = mm_serial_capture_new (fixture->path, 0, &error);
+    g_assert_no_error (error);
+    mm_serial_capture_append (capture, MM_SERIAL_CAPTURE_DIRECTION_WRITE, (const guint8 *) "AT+CSQ\r", 7);
+    mm_serial_capture_append (capture, MM_SERIAL_CAPTURE_DIRECTION_READ,  (const guint8 *) "\r\n+CSQ: 2", 9);
+    mm_serial_capture_append (capture, MM_SERIAL_CAPTURE_DIRECTION_READ,  (const guint8 *) "1,99\r\n\r\nOK\r\n", 12);
+    g_clear_pointer (&capture, mm_serial_capture_free);
+
+    /* Existing captures are appended to */
+    capture = mm_serial_capture_new (fixture->path, 0, &error);
+    g_assert_no_error (error);
+    mm_serial_capture_append (capture, MM_SERIAL_CAPTURE_DIRECTION_READ, (const guint8 *) "\r\nRING\r\n", 8);
+
+    reader = mm_serial_capture_reader_new (fixture->path, &error);
+    g_assert_no_error (error);
+    assert_next_record (reader, MM_SERIAL_CAPTURE_DIRECTION_WRITE, "AT+CSQ\r");
+    assert_next_record (reader, MM_SERIAL_CAPTURE_DIRECTION_READ,  "\r\n+CSQ: 2");
+    assert_next_record (reader, MM_SERIAL_CAPTURE_DIRECTION_READ,  "1,99\r\n\r\nOK\r\n");
+    assert_next_record (reader, MM_SERIAL_CAPTURE_DIRECTION_READ,  "\r\nRING\r\n");
+    assert_no_more_records (reader);
+
+    /* Rewinding starts over */
+    mm_serial_capture_reader_rewind (reader);
+    assert_next_record (reader, MM_SERIAL_CAPTURE_DIRECTION_WRITE, "AT+CSQ\r");
+}
+
+static void
+test_rotation (Fixture       *fixture,
+               gconstpointer  data)
+{
+    g_autoptr(MMSerialCapture)       capture = NULL;
+    g_autoptr(MMSerialCaptureReader) reader = NULL;
+    g_autoptr(MMSerialCaptureReader) rotated_reader = NULL;
+    GError                          *error = NULL;
+    guint                            i;
+
+    /* 8 bytes of file header, and 13 bytes of header plus 6 bytes of data
+     * per record; so up to 4 records per file */
+    capture = mm_serial_capture_new (fixture->path, 100, &error);
+    g_assert_no_error (error);
+    for (i = 0; i < 10; i++) {
+        gchar command[8];
+
+        g_snprintf (command, sizeof (command), "ATE%u\r\n", i);
+        mm_serial_capture_append (capture, MM_SERIAL_CAPTURE_DIRECTION_WRITE, (const guint8 *) command, strlen (command));
+    }
+    g_clear_pointer (&capture, mm_serial_capture_free);
+
+    rotated_reader = mm_serial_capture_reader_new (fixture->rotated_path, &error);
+    g_assert_no_error (error);
+    for (i = 4; i < 8; i++) {
+        gchar command[8];
+
+        g_snprintf (command, sizeof (command), "ATE%u\r\n", i);
+        assert_next_record (rotated_reader, MM_SERIAL_CAPTURE_DIRECTION_WRITE, command);
+    }
+    assert_no_more_records (rotated_reader);
+
+    reader = mm_serial_capture_reader_new (fixture->path, &error);
+    g_assert_no_error (error);
+    assert_next_record (reader, MM_SERIAL_CAPTURE_DIRECTION_WRITE, "ATE8\r\n");
+    assert_next_record (reader, MM_SERIAL_CAPTURE_DIRECTION_WRITE, "ATE9\r\n");
+    assert_no_more_records (reader);
+}
+
+static void
+test_invalid (Fixture       *fixture,
+              gconstpointer  data)
+{
+    g_autoptr(MMSerialCapture)        capture = NULL;
+    g_autoptr(MMSerialCaptureReader)  reader = NULL;
+    g_autofree gchar                 *contents = NULL;
+    gsize                             len;
+    GError                           *error = NULL;
+
+    /* Not a capture */
+    g_file_set_contents (fixture->path, "AT+CSQ\r\n", -1, &error);
+    g_assert_no_error (error);
+    reader = mm_serial_capture_reader_new (fixture->path, &error);
+    g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_INVALID_ARGS);
+    g_assert_null (reader);
+    g_clear_error (&error);
+    g_unlink (fixture->path);
+
+    /* Truncated record, e.g. if the daemon was killed while writing it */
+    capture = mm_serial_capture_new (fixture->path, 0, &error);
+    g_assert_no_error (error);
+    mm_serial_capture_append (capture, MM_SERIAL_CAPTURE_DIRECTION_WRITE, (const guint8 *) "ATI\r", 4);
+    mm_serial_capture_append (capture, MM_SERIAL_CAPTURE_DIRECTION_READ,  (const guint8 *) "\r\nOK\r\n", 6);
+    g_clear_pointer (&capture, mm_serial_capture_free);
+
+    g_file_get_contents (fixture->path, &contents, &len, &error);
+    g_assert_no_error (error);
+    g_file_set_contents (fixture->path, contents, len - 2, &error);
+    g_assert_no_error (error);
+
+    reader = mm_serial_capture_reader_new (fixture->path, &error);
+    g_assert_no_error (error);
+    assert_next_record (reader, MM_SERIAL_CAPTURE_DIRECTION_WRITE, "ATI\r");
+    g_assert (!mm_serial_capture_reader_next (reader, NULL, NULL, NULL, NULL, &error));
+    g_assert_error (error, MM_CORE_ERROR, MM_CORE_ERROR_FAILED);
+    g_clear_error (&error);
+}
+
+static void
+test_port_setup (Fixture       *fixture,
+                 gconstpointer  data)
+{
+    g_autoptr(MMSerialCapture) capture = NULL;
+    GError                    *error = NULL;
+
+    /* Disabled */
+    capture = mm_serial_capture_new_for_port ("ttyUSB0", &error);
+    g_assert_no_error (error);
+    g_assert_null (capture);
+
+    /* Only for the given ports */
+    mm_serial_capture_setup (fixture->dir, "ttyUSB2, ttyUSB0", 0);
+    capture = mm_serial_capture_new_for_port ("ttyUSB1", &error);
+    g_assert_no_error (error);
+    g_assert_null (capture);
+    capture = mm_serial_capture_new_for_port ("ttyUSB0", &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (capture);
+    g_assert (g_file_test (fixture->path, G_FILE_TEST_IS_REGULAR));
+    g_clear_pointer (&capture, mm_serial_capture_free);
+
+    /* For all ports */
+    mm_serial_capture_setup (fixture->dir, NULL, 0);
+    capture = mm_serial_capture_new_for_port ("ttyUSB0", &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (capture);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add ("/MM/serial-capture/round-trip", Fixture, NULL, fixture_setup, test_round_trip, fixture_teardown);
+    g_test_add ("/MM/serial-capture/rotation",   Fixture, NULL, fixture_setup, test_rotation,   fixture_teardown);
+    g_test_add ("/MM/serial-capture/invalid",    Fixture, NULL, fixture_setup, test_invalid,    fixture_teardown);
+    g_test_add ("/MM/serial-capture/port-setup", Fixture, NULL, fixture_setup, test_port_setup, fixture_teardown);
+
+    return g_test_run ();
+}
@@ -0,0 +1,270 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <ModemManager.h>
+#define _LIBMM_INSIDE_MM
+#include <libmm-glib.h>
+
+#include "mm-sms-index.h"
+#include "mm-sms-part.h"
+#include "mm-log-test.h"
+
+#define ITEM_A GINT_TO_POINTER (1)
+#define ITEM_B GINT_TO_POINTER (2)
+
+/*****************************************************************************/
+
+static void
+test_parts (void)
+{
+    g_autoptr(MMSmsIndex) index = NULL;
+
+    index = mm_sms_index_new (1000, NULL, NULL);
+
+    mm_sms_index_add (index, ITEM_A, FALSE, 0, NULL);
+    mm_sms_index_add (index, ITEM_B, FALSE, 0, NULL);
+    g_assert_cmpuint (mm_sms_index_get_count (index), ==, 2);
+
+    mm_sms_index_add_part (index, ITEM_A, MM_SMS_STORAGE_SM, 3);
+    mm_sms_index_add_part (index, ITEM_B, MM_SMS_STORAGE_ME, 3);
+    g_assert (mm_sms_index_has_part (index, MM_SMS_STORAGE_SM, 3));
+    g_assert (mm_sms_index_has_part (index, MM_SMS_STORAGE_ME, 3));
+    g_assert (!mm_sms_index_has_part (index, MM_SMS_STORAGE_MT, 3));
+    g_assert (!mm_sms_index_has_part (index, MM_SMS_STORAGE_SM, 4));
+
+    /* Parts not stored are never indexed */
+    mm_sms_index_add_part (index, ITEM_A, MM_SMS_STORAGE_UNKNOWN, 5);
+    mm_sms_index_add_part (index, ITEM_A, MM_SMS_STORAGE_SM, SMS_PART_INVALID_INDEX);
+    g_assert (!mm_sms_index_has_part (index, MM_SMS_STORAGE_UNKNOWN, 5));
+    g_assert (!mm_sms_index_has_part (index, MM_SMS_STORAGE_SM, SMS_PART_INVALID_INDEX));
+
+    mm_sms_index_remove (index, ITEM_A);
+    g_assert_cmpuint (mm_sms_index_get_count (index), ==, 1);
+    g_assert (!mm_sms_index_has_part (index, MM_SMS_STORAGE_SM, 3));
+    g_assert (mm_sms_index_has_part (index, MM_SMS_STORAGE_ME, 3));
+
+    /* Removing twice is harmless */
+    mm_sms_index_remove (index, ITEM_A);
+    g_assert_cmpuint (mm_sms_index_get_count (index), ==, 1);
+}
+
+static void
+test_set_parts_partial_delete (void)
+{
+    g_autoptr(MMSmsIndex)  index = NULL;
+    MMSmsPart             *parts[3];
+    GList                 *list = NULL;
+    guint                  i;
+
+    index = mm_sms_index_new (1000, NULL, NULL);
+    mm_sms_index_add (index, ITEM_A, TRUE, 10, "+34600000000");
+
+    for (i = 0; i < G_N_ELEMENTS (parts); i++) {
+        parts[i] = mm_sms_part_new (i + 1, MM_SMS_PDU_TYPE_DELIVER);
+        list = g_list_append (list, parts[i]);
+    }
+
+    mm_sms_index_set_parts (index, ITEM_A, MM_SMS_STORAGE_SM, list);
+    for (i = 0; i < G_N_ELEMENTS (parts); i++)
+        g_assert (mm_sms_index_has_part (index, MM_SMS_STORAGE_SM, i + 1));
+
+    /* The first two parts got deleted before the delete operation failed */
+    mm_sms_part_set_index (parts[0], SMS_PART_INVALID_INDEX);
+    mm_sms_part_set_index (parts[1], SMS_PART_INVALID_INDEX);
+    mm_sms_index_set_parts (index, ITEM_A, MM_SMS_STORAGE_SM, list);
+    g_assert (!mm_sms_index_has_part (index, MM_SMS_STORAGE_SM, 1));
+    g_assert (!mm_sms_index_has_part (index, MM_SMS_STORAGE_SM, 2));
+    g_assert (mm_sms_index_has_part (index, MM_SMS_STORAGE_SM, 3));
+
+    /* So a new message stored at a freed index is taken */
+    mm_sms_index_add (index, ITEM_B, FALSE, 0, NULL);
+    mm_sms_index_add_part (index, ITEM_B, MM_SMS_STORAGE_SM, 1);
+    g_assert (mm_sms_index_has_part (index, MM_SMS_STORAGE_SM, 1));
+
+    /* And it stays indexed when the first item goes away */
+    mm_sms_index_remove (index, ITEM_A);
+    g_assert (mm_sms_index_has_part (index, MM_SMS_STORAGE_SM, 1));
+    g_assert (!mm_sms_index_has_part (index, MM_SMS_STORAGE_SM, 3));
+
+    g_list_free_full (list, (GDestroyNotify) mm_sms_part_free);
+}
+
+static void
+test_multipart (void)
+{
+    g_autoptr(MMSmsIndex) index = NULL;
+
+    index = mm_sms_index_new (1000, NULL, NULL);
+
+    mm_sms_index_add (index, ITEM_A, TRUE, 10, "+34600000000");
+    mm_sms_index_add (index, ITEM_B, FALSE, 10, "+34600000000");
+
+    g_assert (mm_sms_index_lookup_multipart (index, 10, "+34600000000") == ITEM_A);
+    g_assert_null (mm_sms_index_lookup_multipart (index, 10, "+34600000001"));
+    g_assert_null (mm_sms_index_lookup_multipart (index, 11, "+34600000000"));
+    g_assert_null (mm_sms_index_lookup_multipart (index, 10, NULL));
+
+    mm_sms_index_remove (index, ITEM_A);
+    g_assert_null (mm_sms_index_lookup_multipart (index, 10, "+34600000000"));
+}
+
+/*****************************************************************************/
+
+#define EXPIRATION_MS 200
+
+typedef struct {
+    MMSmsIndex *index;
+    GMainLoop  *loop;
+    gpointer    expired;
+    gint64      expired_time;
+    gboolean    rearm;
+} ExpiryContext;
+
+static void
+expired_cb (gpointer       item,
+            ExpiryContext *ctx)
+{
+    g_assert_null (ctx->expired);
+    ctx->expired = item;
+    ctx->expired_time = g_get_monotonic_time ();
+    /* Already gone from the index */
+    g_assert_null (mm_sms_index_lookup_multipart (ctx->index, 10, "+34600000000"));
+    g_assert (!mm_sms_index_has_part (ctx->index, MM_SMS_STORAGE_SM, 1));
+}
+
+static gboolean
+before_expiration_cb (ExpiryContext *ctx)
+{
+    g_assert_null (ctx->expired);
+    /* Setting the flag again must not restart the timeout */
+    if (ctx->rearm)
+        mm_sms_index_set_expires (ctx->index, ITEM_A, TRUE);
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean
+quit_cb (ExpiryContext *ctx)
+{
+    g_main_loop_quit (ctx->loop);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+expiry_context_run (ExpiryContext *ctx,
+                    guint          ms)
+{
+    g_timeout_add (ms, (GSourceFunc) quit_cb, ctx);
+    g_main_loop_run (ctx->loop);
+}
+
+static void
+expiry_context_init (ExpiryContext *ctx)
+{
+    memset (ctx, 0, sizeof (ExpiryContext));
+    ctx->loop = g_main_loop_new (NULL, FALSE);
+    ctx->index = mm_sms_index_new (EXPIRATION_MS, (MMSmsIndexExpiredFunc) expired_cb, ctx);
+    mm_sms_index_add (ctx->index, ITEM_A, TRUE, 10, "+34600000000");
+    mm_sms_index_add_part (ctx->index, ITEM_A, MM_SMS_STORAGE_SM, 1);
+}
+
+static void
+expiry_context_clear (ExpiryContext *ctx)
+{
+    mm_sms_index_free (ctx->index);
+    g_main_loop_unref (ctx->loop);
+}
+
+static void
+test_expiration (void)
+{
+    ExpiryContext ctx;
+    gint64        start;
+
+    expiry_context_init (&ctx);
+
+    start = g_get_monotonic_time ();
+    mm_sms_index_set_expires (ctx.index, ITEM_A, TRUE);
+    g_timeout_add (EXPIRATION_MS / 2, (GSourceFunc) before_expiration_cb, &ctx);
+    expiry_context_run (&ctx, EXPIRATION_MS * 3);
+
+    g_assert (ctx.expired == ITEM_A);
+    g_assert_cmpint (ctx.expired_time - start, >=, EXPIRATION_MS * 1000);
+    g_assert_cmpuint (mm_sms_index_get_count (ctx.index), ==, 0);
+
+    expiry_context_clear (&ctx);
+}
+
+static void
+test_expiration_not_restarted (void)
+{
+    ExpiryContext ctx;
+    gint64        start;
+
+    expiry_context_init (&ctx);
+    ctx.rearm = TRUE;
+
+    start = g_get_monotonic_time ();
+    mm_sms_index_set_expires (ctx.index, ITEM_A, TRUE);
+    g_timeout_add (EXPIRATION_MS * 3 / 4, (GSourceFunc) before_expiration_cb, &ctx);
+    expiry_context_run (&ctx, EXPIRATION_MS * 3);
+
+    /* A restarted timeout would have fired at 1.75 times the expiration */
+    g_assert (ctx.expired == ITEM_A);
+    g_assert_cmpint (ctx.expired_time - start, <, EXPIRATION_MS * 1000 * 7 / 4);
+
+    expiry_context_clear (&ctx);
+}
+
+static void
+test_expiration_cancelled (void)
+{
+    ExpiryContext ctx;
+
+    expiry_context_init (&ctx);
+    mm_sms_index_add (ctx.index, ITEM_B, TRUE, 11, "+34600000000");
+
+    /* Completed, e.g. the last part arrived */
+    mm_sms_index_set_expires (ctx.index, ITEM_A, TRUE);
+    mm_sms_index_set_expires (ctx.index, ITEM_A, FALSE);
+    /* Deleted */
+    mm_sms_index_set_expires (ctx.index, ITEM_B, TRUE);
+    mm_sms_index_remove (ctx.index, ITEM_B);
+
+    expiry_context_run (&ctx, EXPIRATION_MS * 2);
+
+    g_assert_null (ctx.expired);
+    g_assert_cmpuint (mm_sms_index_get_count (ctx.index), ==, 1);
+    g_assert (mm_sms_index_has_part (ctx.index, MM_SMS_STORAGE_SM, 1));
+
+    expiry_context_clear (&ctx);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/sms-index/parts",                    test_parts);
+    g_test_add_func ("/MM/sms-index/set-parts-partial-delete", test_set_parts_partial_delete);
+    g_test_add_func ("/MM/sms-index/multipart",                test_multipart);
+    g_test_add_func ("/MM/sms-index/expiration",               test_expiration);
+    g_test_add_func ("/MM/sms-index/expiration-not-restarted", test_expiration_not_restarted);
+    g_test_add_func ("/MM/sms-index/expiration-cancelled",     test_expiration_cancelled);
+
+    return g_test_run ();
+}
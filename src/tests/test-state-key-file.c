@@ -0,0 +1,376 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <ModemManager.h>
+#include <libmm-glib.h>
+
+#include "mm-state-key-file.h"
+#include "mm-modem-info-cache.h"
+#include "mm-send-delay-store.h"
+#include "mm-port-probe-cache.h"
+#include "mm-log-test.h"
+
+/*****************************************************************************/
+
+typedef struct {
+    gchar *dir;
+} Fixture;
+
+static void
+fixture_setup (Fixture       *fixture,
+               gconstpointer  data)
+{
+    GError *error = NULL;
+
+    fixture->dir = g_dir_make_tmp ("mm-test-state-key-file-XXXXXX", &error);
+    g_assert_no_error (error);
+    mm_state_key_file_set_dir (fixture->dir);
+}
+
+static void
+fixture_teardown (Fixture       *fixture,
+                  gconstpointer  data)
+{
+    GDir        *dir;
+    const gchar *name;
+
+    mm_state_key_file_set_dir (NULL);
+
+    dir = g_dir_open (fixture->dir, 0, NULL);
+    g_assert_nonnull (dir);
+    while ((name = g_dir_read_name (dir)) != NULL) {
+        g_autofree gchar *path = NULL;
+
+        path = g_build_filename (fixture->dir, name, NULL);
+        g_unlink (path);
+    }
+    g_dir_close (dir);
+    g_rmdir (fixture->dir);
+    g_free (fixture->dir);
+}
+
+/* Drop all the state loaded in memory, as if the daemon was restarted */
+static void
+fixture_reload (Fixture *fixture)
+{
+    mm_state_key_file_set_dir (NULL);
+    mm_state_key_file_set_dir (fixture->dir);
+}
+
+/*****************************************************************************/
+
+#define TEST_UID "/sys/devices/pci0000:00/0000:00:14.0/usb1/1-2"
+
+static void
+assert_cached_uint32 (const gchar *uid,
+                      const gchar *key,
+                      guint32      expected)
+{
+    g_autoptr(GVariant) value = NULL;
+
+    value = mm_modem_info_cache_lookup (uid, key, G_VARIANT_TYPE_UINT32, NULL);
+    g_assert_nonnull (value);
+    g_assert_cmpuint (g_variant_get_uint32 (value), ==, expected);
+}
+
+static void
+test_modem_info_cache (Fixture       *fixture,
+                       gconstpointer  data)
+{
+    g_autofree gchar *path = NULL;
+
+    /* Unknown device: nothing cached, and nothing stored until validated */
+    g_assert (!mm_modem_info_cache_lookup (TEST_UID, "modes", G_VARIANT_TYPE_UINT32, NULL));
+    mm_modem_info_cache_store (TEST_UID, "modes", g_variant_new_uint32 (7), NULL);
+    g_assert (!mm_modem_info_cache_lookup (TEST_UID, "modes", G_VARIANT_TYPE_UINT32, NULL));
+
+    /* First validation of an identity is a miss */
+    g_assert (!mm_modem_info_cache_validate (TEST_UID, "123456789012345", "FW1.0", NULL));
+    mm_modem_info_cache_store (TEST_UID, "modes", g_variant_new_uint32 (7), NULL);
+    mm_modem_info_cache_store (TEST_UID, "ip-families", g_variant_new_uint32 (3), NULL);
+    assert_cached_uint32 (TEST_UID, "modes", 7);
+
+    /* Saved in the state directory, and loaded back */
+    path = g_build_filename (fixture->dir, "modem-info-cache", NULL);
+    g_assert (g_file_test (path, G_FILE_TEST_IS_REGULAR));
+    fixture_reload (fixture);
+    g_assert (mm_modem_info_cache_validate (TEST_UID, "123456789012345", "FW1.0", NULL));
+    assert_cached_uint32 (TEST_UID, "modes", 7);
+    assert_cached_uint32 (TEST_UID, "ip-families", 3);
+
+    /* Values of a different type are not returned */
+    g_assert (!mm_modem_info_cache_lookup (TEST_UID, "modes", G_VARIANT_TYPE_STRING, NULL));
+
+    /* Updated values */
+    mm_modem_info_cache_store (TEST_UID, "modes", g_variant_new_uint32 (15), NULL);
+    fixture_reload (fixture);
+    g_assert (mm_modem_info_cache_validate (TEST_UID, "123456789012345", "FW1.0", NULL));
+    assert_cached_uint32 (TEST_UID, "modes", 15);
+
+    /* Firmware upgrade: everything cached for the device is dropped */
+    g_assert (!mm_modem_info_cache_validate (TEST_UID, "123456789012345", "FW2.0", NULL));
+    g_assert (!mm_modem_info_cache_lookup (TEST_UID, "modes", G_VARIANT_TYPE_UINT32, NULL));
+    g_assert (!mm_modem_info_cache_lookup (TEST_UID, "ip-families", G_VARIANT_TYPE_UINT32, NULL));
+    fixture_reload (fixture);
+    g_assert (!mm_modem_info_cache_validate (TEST_UID, "123456789012345", "FW1.0", NULL));
+
+    /* A different device in the same location */
+    mm_modem_info_cache_store (TEST_UID, "modes", g_variant_new_uint32 (7), NULL);
+    g_assert (!mm_modem_info_cache_validate (TEST_UID, "543210987654321", "FW1.0", NULL));
+    g_assert (!mm_modem_info_cache_lookup (TEST_UID, "modes", G_VARIANT_TYPE_UINT32, NULL));
+}
+
+static void
+test_modem_info_cache_values (Fixture       *fixture,
+                              gconstpointer  data)
+{
+    static const guint32  bands[] = { 31, 32, 33 };
+    g_autoptr(GVariant)   supported_bands = NULL;
+    g_autoptr(GVariant)   value = NULL;
+
+    g_assert (!mm_modem_info_cache_validate (TEST_UID, "123456789012345", "FW1.0", NULL));
+
+    /* Strings are stored as given, even with characters meaningful in
+     * key files */
+    mm_modem_info_cache_store (TEST_UID, "manufacturer", g_variant_new_string ("Vendor; Inc. #1"), NULL);
+    mm_modem_info_cache_store (TEST_UID, "model", g_variant_new_string (" \"Model\"\n=2 "), NULL);
+
+    /* Non-floating values are not consumed */
+    supported_bands = g_variant_ref_sink (g_variant_new_fixed_array (G_VARIANT_TYPE_UINT32,
+                                                                     bands, G_N_ELEMENTS (bands),
+                                                                     sizeof (guint32)));
+    mm_modem_info_cache_store (TEST_UID, "supported-bands", supported_bands, NULL);
+    g_assert (g_variant_is_of_type (supported_bands, G_VARIANT_TYPE ("au")));
+    mm_modem_info_cache_store (TEST_UID, "supported-capabilities", g_variant_new_array (G_VARIANT_TYPE_UINT32, NULL, 0), NULL);
+
+    fixture_reload (fixture);
+    g_assert (mm_modem_info_cache_validate (TEST_UID, "123456789012345", "FW1.0", NULL));
+
+    value = mm_modem_info_cache_lookup (TEST_UID, "manufacturer", G_VARIANT_TYPE_STRING, NULL);
+    g_assert_nonnull (value);
+    g_assert_cmpstr (g_variant_get_string (value, NULL), ==, "Vendor; Inc. #1");
+    g_clear_pointer (&value, g_variant_unref);
+
+    value = mm_modem_info_cache_lookup (TEST_UID, "model", G_VARIANT_TYPE_STRING, NULL);
+    g_assert_nonnull (value);
+    g_assert_cmpstr (g_variant_get_string (value, NULL), ==, " \"Model\"\n=2 ");
+    g_clear_pointer (&value, g_variant_unref);
+
+    value = mm_modem_info_cache_lookup (TEST_UID, "supported-bands", G_VARIANT_TYPE ("au"), NULL);
+    g_assert_nonnull (value);
+    g_assert (g_variant_equal (value, supported_bands));
+    g_clear_pointer (&value, g_variant_unref);
+
+    value = mm_modem_info_cache_lookup (TEST_UID, "supported-capabilities", G_VARIANT_TYPE ("au"), NULL);
+    g_assert_nonnull (value);
+    g_assert_cmpuint (g_variant_n_children (value), ==, 0);
+}
+
+static void
+test_send_delay_store (Fixture       *fixture,
+                       gconstpointer  data)
+{
+    gboolean paced = FALSE;
+
+    g_assert (!mm_send_delay_store_lookup (0x1234, 0x5678, &paced, NULL));
+
+    mm_send_delay_store_update (0x1234, 0x5678, TRUE, NULL);
+    mm_send_delay_store_update (0x1234, 0x5679, FALSE, NULL);
+    fixture_reload (fixture);
+
+    g_assert (mm_send_delay_store_lookup (0x1234, 0x5678, &paced, NULL));
+    g_assert (paced);
+    g_assert (mm_send_delay_store_lookup (0x1234, 0x5679, &paced, NULL));
+    g_assert (!paced);
+    g_assert (!mm_send_delay_store_lookup (0x1234, 0x567a, &paced, NULL));
+}
+
+static void
+write_send_delay_store (Fixture     *fixture,
+                        const gchar *contents)
+{
+    g_autofree gchar *path = NULL;
+    GError           *error = NULL;
+
+    path = g_build_filename (fixture->dir, "send-delay", NULL);
+    g_assert (g_file_set_contents (path, contents, -1, &error));
+    g_assert_no_error (error);
+    fixture_reload (fixture);
+}
+
+static void
+test_send_delay_store_expired (Fixture       *fixture,
+                               gconstpointer  data)
+{
+    g_autofree gchar *contents = NULL;
+    gboolean          paced = FALSE;
+    gint64            now;
+
+    now = g_get_real_time () / G_USEC_PER_SEC;
+
+    /* Recently learned */
+    contents = g_strdup_printf ("[1234:5678]\npaced=true\nverified=%" G_GINT64_FORMAT "\n", now - 60);
+    write_send_delay_store (fixture, contents);
+    g_assert (mm_send_delay_store_lookup (0x1234, 0x5678, &paced, NULL));
+    g_assert (paced);
+    g_clear_pointer (&contents, g_free);
+
+    /* Learned too long ago, so needs to be learned again */
+    contents = g_strdup_printf ("[1234:5678]\npaced=true\nverified=%" G_GINT64_FORMAT "\n", now - 30 * 24 * 60 * 60);
+    write_send_delay_store (fixture, contents);
+    g_assert (!mm_send_delay_store_lookup (0x1234, 0x5678, &paced, NULL));
+    g_clear_pointer (&contents, g_free);
+
+    /* Or never verified */
+    write_send_delay_store (fixture, "[1234:5678]\npaced=true\n");
+    g_assert (!mm_send_delay_store_lookup (0x1234, 0x5678, &paced, NULL));
+
+    /* Not requiring pacing never expires */
+    write_send_delay_store (fixture, "[1234:5678]\npaced=false\n");
+    g_assert (mm_send_delay_store_lookup (0x1234, 0x5678, &paced, NULL));
+    g_assert (!paced);
+
+    /* Learning it again refreshes the entry */
+    write_send_delay_store (fixture, "[1234:5678]\npaced=true\nverified=1\n");
+    mm_send_delay_store_update (0x1234, 0x5678, TRUE, NULL);
+    fixture_reload (fixture);
+    g_assert (mm_send_delay_store_lookup (0x1234, 0x5678, &paced, NULL));
+    g_assert (paced);
+}
+
+#define TEST_PORT_KEY       "1234:5678:02:option:tty"
+#define TEST_OTHER_PORT_KEY "1234:5678:03:option:tty"
+
+static void
+test_port_probe_cache (Fixture       *fixture,
+                       gconstpointer  data)
+{
+    MMPortProbeCacheEntry entry = { 0 };
+
+    /* Miss */
+    g_assert (!mm_port_probe_cache_lookup (TEST_PORT_KEY, &entry, NULL));
+
+    entry.flags = 0x7f;
+    entry.is_at = TRUE;
+    entry.vendor = g_strdup ("Vendor");
+    entry.product = g_strdup ("Product");
+    entry.is_icera = TRUE;
+    mm_port_probe_cache_update (TEST_PORT_KEY, &entry, NULL);
+    mm_port_probe_cache_entry_clear (&entry);
+
+    entry.flags = 0x02;
+    entry.is_qcdm = TRUE;
+    mm_port_probe_cache_update (TEST_OTHER_PORT_KEY, &entry, NULL);
+    mm_port_probe_cache_entry_clear (&entry);
+
+    /* Hit, also after reloading */
+    fixture_reload (fixture);
+    g_assert (mm_port_probe_cache_lookup (TEST_PORT_KEY, &entry, NULL));
+    g_assert_cmpuint (entry.flags, ==, 0x7f);
+    g_assert (entry.is_at);
+    g_assert (!entry.is_qcdm);
+    g_assert (!entry.is_qmi);
+    g_assert (!entry.is_mbim);
+    g_assert_cmpstr (entry.vendor, ==, "Vendor");
+    g_assert_cmpstr (entry.product, ==, "Product");
+    g_assert (entry.is_icera);
+    g_assert (!entry.is_xmm);
+    mm_port_probe_cache_entry_clear (&entry);
+
+    g_assert (mm_port_probe_cache_lookup (TEST_OTHER_PORT_KEY, &entry, NULL));
+    g_assert_cmpuint (entry.flags, ==, 0x02);
+    g_assert (!entry.is_at);
+    g_assert (entry.is_qcdm);
+    g_assert_null (entry.vendor);
+    mm_port_probe_cache_entry_clear (&entry);
+
+    /* Rewritten entries keep no stale values */
+    entry.flags = 0x01;
+    entry.is_at = TRUE;
+    mm_port_probe_cache_update (TEST_PORT_KEY, &entry, NULL);
+    mm_port_probe_cache_entry_clear (&entry);
+    fixture_reload (fixture);
+    g_assert (mm_port_probe_cache_lookup (TEST_PORT_KEY, &entry, NULL));
+    g_assert_cmpuint (entry.flags, ==, 0x01);
+    g_assert (entry.is_at);
+    g_assert_null (entry.vendor);
+    g_assert_null (entry.product);
+    g_assert (!entry.is_icera);
+    mm_port_probe_cache_entry_clear (&entry);
+
+    /* Stale entries are dropped for good, and only those */
+    mm_port_probe_cache_invalidate (TEST_PORT_KEY, NULL);
+    g_assert (!mm_port_probe_cache_lookup (TEST_PORT_KEY, &entry, NULL));
+    fixture_reload (fixture);
+    g_assert (!mm_port_probe_cache_lookup (TEST_PORT_KEY, &entry, NULL));
+    g_assert (mm_port_probe_cache_lookup (TEST_OTHER_PORT_KEY, &entry, NULL));
+    g_assert (entry.is_qcdm);
+    mm_port_probe_cache_entry_clear (&entry);
+
+    /* Invalidating unknown entries is harmless */
+    mm_port_probe_cache_invalidate (TEST_PORT_KEY, NULL);
+    g_assert (mm_port_probe_cache_lookup (TEST_OTHER_PORT_KEY, &entry, NULL));
+    mm_port_probe_cache_entry_clear (&entry);
+}
+
+static void
+test_memory_only (Fixture       *fixture,
+                  gconstpointer  data)
+{
+    GDir     *dir;
+    gboolean  paced = FALSE;
+
+    /* Without a state directory, e.g. in test sessions */
+    mm_state_key_file_set_dir (NULL);
+    mm_send_delay_store_update (0x1234, 0x5678, TRUE, NULL);
+    g_assert (!mm_modem_info_cache_validate (TEST_UID, "123456789012345", "FW1.0", NULL));
+    mm_modem_info_cache_store (TEST_UID, "modes", g_variant_new_uint32 (7), NULL);
+
+    /* Still available while running */
+    g_assert (mm_send_delay_store_lookup (0x1234, 0x5678, &paced, NULL));
+    g_assert (paced);
+    assert_cached_uint32 (TEST_UID, "modes", 7);
+
+    /* But nothing saved */
+    dir = g_dir_open (fixture->dir, 0, NULL);
+    g_assert_nonnull (dir);
+    g_assert_null (g_dir_read_name (dir));
+    g_dir_close (dir);
+
+    /* Nor left over once a state directory is set */
+    mm_state_key_file_set_dir (fixture->dir);
+    g_assert (!mm_send_delay_store_lookup (0x1234, 0x5678, &paced, NULL));
+    g_assert (!mm_modem_info_cache_lookup (TEST_UID, "modes", G_VARIANT_TYPE_UINT32, NULL));
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add ("/MM/state-key-file/modem-info-cache", Fixture, NULL, fixture_setup, test_modem_info_cache, fixture_teardown);
+    g_test_add ("/MM/state-key-file/modem-info-cache-values", Fixture, NULL, fixture_setup, test_modem_info_cache_values, fixture_teardown);
+    g_test_add ("/MM/state-key-file/send-delay-store", Fixture, NULL, fixture_setup, test_send_delay_store, fixture_teardown);
+    g_test_add ("/MM/state-key-file/send-delay-store-expired", Fixture, NULL, fixture_setup, test_send_delay_store_expired, fixture_teardown);
+    g_test_add ("/MM/state-key-file/port-probe-cache", Fixture, NULL, fixture_setup, test_port_probe_cache, fixture_teardown);
+    g_test_add ("/MM/state-key-file/memory-only",      Fixture, NULL, fixture_setup, test_memory_only,      fixture_teardown);
+
+    return g_test_run ();
+}
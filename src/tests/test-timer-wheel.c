@@ -0,0 +1,177 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include <config.h>
+#include <glib.h>
+
+#include "mm-timer-wheel.h"
+#include "mm-log-test.h"
+
+/*****************************************************************************/
+
+typedef struct {
+    GMainLoop *loop;
+    gint64     start;
+    GArray    *fired;
+    guint      pending;
+} TestContext;
+
+typedef struct {
+    TestContext *ctx;
+    guint        timeout_ms;
+} TestTimer;
+
+static void
+timer_fired (TestTimer *timer)
+{
+    gint64 elapsed;
+
+    /* Never before the requested timeout */
+    elapsed = g_get_monotonic_time () - timer->ctx->start;
+    g_assert_cmpint (elapsed, >=, (gint64) timer->timeout_ms * G_TIME_SPAN_MILLISECOND);
+
+    g_array_append_val (timer->ctx->fired, timer->timeout_ms);
+
+    g_assert_cmpuint (timer->ctx->pending, >, 0);
+    if (--timer->ctx->pending == 0)
+        g_main_loop_quit (timer->ctx->loop);
+}
+
+static void
+test_order (void)
+{
+    /* Some of them more than a full turn of the wheel away */
+    static const guint timeouts[] = { 250, 5, 0, 40, 2500, 41, 1, 3100, 250 };
+    TestTimer   timers[G_N_ELEMENTS (timeouts)];
+    TestContext ctx;
+    guint       i;
+
+    ctx.loop = g_main_loop_new (NULL, FALSE);
+    ctx.fired = g_array_new (FALSE, FALSE, sizeof (guint));
+    ctx.pending = G_N_ELEMENTS (timeouts);
+    ctx.start = g_get_monotonic_time ();
+
+    for (i = 0; i < G_N_ELEMENTS (timeouts); i++) {
+        timers[i].ctx = &ctx;
+        timers[i].timeout_ms = timeouts[i];
+        g_assert_cmpuint (mm_timer_wheel_add (timeouts[i], (MMTimerWheelFunc) timer_fired, &timers[i]), !=, 0);
+    }
+
+    g_main_loop_run (ctx.loop);
+
+    g_assert_cmpuint (ctx.fired->len, ==, G_N_ELEMENTS (timeouts));
+    for (i = 1; i < ctx.fired->len; i++)
+        g_assert_cmpuint (g_array_index (ctx.fired, guint, i - 1), <=, g_array_index (ctx.fired, guint, i));
+
+    g_array_unref (ctx.fired);
+    g_main_loop_unref (ctx.loop);
+}
+
+/*****************************************************************************/
+
+static void
+timer_not_expected (gpointer user_data)
+{
+    g_assert_not_reached ();
+}
+
+static void
+test_remove (void)
+{
+    TestTimer   timer;
+    TestContext ctx;
+    guint       removed[3];
+    guint       i;
+
+    ctx.loop = g_main_loop_new (NULL, FALSE);
+    ctx.fired = g_array_new (FALSE, FALSE, sizeof (guint));
+    ctx.pending = 1;
+    ctx.start = g_get_monotonic_time ();
+
+    removed[0] = mm_timer_wheel_add (10, timer_not_expected, NULL);
+    removed[1] = mm_timer_wheel_add (0, timer_not_expected, NULL);
+    removed[2] = mm_timer_wheel_add (4000, timer_not_expected, NULL);
+
+    timer.ctx = &ctx;
+    timer.timeout_ms = 30;
+    mm_timer_wheel_add (timer.timeout_ms, (MMTimerWheelFunc) timer_fired, &timer);
+
+    for (i = 0; i < G_N_ELEMENTS (removed); i++)
+        mm_timer_wheel_remove (removed[i]);
+
+    g_main_loop_run (ctx.loop);
+
+    g_assert_cmpuint (ctx.fired->len, ==, 1);
+
+    g_array_unref (ctx.fired);
+    g_main_loop_unref (ctx.loop);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+    GMainLoop *loop;
+    guint      n_fired;
+    guint      other_id;
+} ReentrantContext;
+
+static void
+reentrant_last_fired (ReentrantContext *ctx)
+{
+    ctx->n_fired++;
+    g_main_loop_quit (ctx->loop);
+}
+
+static void
+reentrant_first_fired (ReentrantContext *ctx)
+{
+    ctx->n_fired++;
+
+    /* Timer expired in the same dispatch, but not run yet */
+    mm_timer_wheel_remove (ctx->other_id);
+
+    /* New timer scheduled from within a callback */
+    mm_timer_wheel_add (0, (MMTimerWheelFunc) reentrant_last_fired, ctx);
+}
+
+static void
+test_reentrant (void)
+{
+    ReentrantContext ctx = { 0 };
+
+    ctx.loop = g_main_loop_new (NULL, FALSE);
+
+    mm_timer_wheel_add (1, (MMTimerWheelFunc) reentrant_first_fired, &ctx);
+    ctx.other_id = mm_timer_wheel_add (1, timer_not_expected, NULL);
+
+    /* Make sure both expire in the same dispatch */
+    g_usleep (5 * G_TIME_SPAN_MILLISECOND);
+
+    g_main_loop_run (ctx.loop);
+    g_assert_cmpuint (ctx.n_fired, ==, 2);
+
+    g_main_loop_unref (ctx.loop);
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/MM/timer-wheel/order",     test_order);
+    g_test_add_func ("/MM/timer-wheel/remove",    test_remove);
+    g_test_add_func ("/MM/timer-wheel/reentrant", test_reentrant);
+
+    return g_test_run ();
+}
@@ -18,10 +18,13 @@
 #include <string.h>
 #include <stdio.h>
 #include <locale.h>
+#include <glib/gstdio.h>
+#include <utime.h>
 
 #define _LIBMM_INSIDE_MM
 #include <libmm-glib.h>
 
+#include "mm-kernel-device-generic.h"
 #include "mm-kernel-device-generic-rules.h"
 #include "mm-log-test.h"
 
@@ -43,6 +46,347 @@ test_load_cleanup_core (void)
 
 /************************************************************/
 
+static const gchar *compile_rules =
+    "ACTION!=\"add|change|move|bind\", GOTO=\"mm_test_end\"\n"
+    "KERNEL==\"ttyUSB*\", DEVPATH==\"/devices/pci0000:00/usb1\", ENV{ID_MM_TEST}=\"1\"\n"
+    "ATTRS{idVendor}==\"1199\", ATTRS{bInterfaceNumber}==\"?*\", ENV{ID_MM_TEST_IFACE}=\"$attr{bInterfaceNumber}\"\n"
+    "ENV{ID_MM_TEST}!=\"1\", ATTRS{serial}==\"abc\", GOTO=\"mm_test_end\"\n"
+    "LABEL=\"mm_test_end\"\n";
+
+static void
+test_compile (void)
+{
+    g_autofree gchar  *rules_dir = NULL;
+    g_autofree gchar  *rules_file = NULL;
+    GArray            *rules;
+    GError            *error = NULL;
+    MMUdevRule        *rule;
+    MMUdevRuleMatch   *match;
+
+    rules_dir = g_dir_make_tmp ("mm-test-udev-rules-XXXXXX", &error);
+    g_assert_no_error (error);
+    rules_file = g_build_filename (rules_dir, "77-mm-test.rules", NULL);
+    g_file_set_contents (rules_file, compile_rules, -1, &error);
+    g_assert_no_error (error);
+
+    rules = mm_kernel_device_generic_rules_load (rules_dir, &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (rules->len, ==, 5);
+
+    /* GOTO targets resolved */
+    rule = &g_array_index (rules, MMUdevRule, 0);
+    match = &g_array_index (rule->conditions, MMUdevRuleMatch, 0);
+    g_assert_cmpint (match->compiled_parameter, ==, MM_UDEV_RULE_MATCH_PARAMETER_ACTION);
+    g_assert (match->value_add);
+    g_assert_cmpint (rule->result.type, ==, MM_UDEV_RULE_RESULT_TYPE_GOTO_INDEX);
+    g_assert_cmpuint (rule->result.content.index, ==, 4);
+
+    /* Patterns compiled only when first needed, with the implicit DEVPATH
+     * prefix match */
+    rule = &g_array_index (rules, MMUdevRule, 1);
+    match = &g_array_index (rule->conditions, MMUdevRuleMatch, 0);
+    g_assert_cmpint (match->compiled_parameter, ==, MM_UDEV_RULE_MATCH_PARAMETER_KERNEL);
+    g_assert (!match->patterns_compiled);
+    g_assert (!match->regex);
+    mm_kernel_device_generic_rules_match_compile_patterns (match);
+    g_assert (match->patterns_compiled);
+    g_assert_cmpstr (g_regex_get_pattern (match->regex), ==, "ttyUSB*");
+    g_assert (!match->prefix_regex);
+    match = &g_array_index (rule->conditions, MMUdevRuleMatch, 1);
+    g_assert_cmpint (match->compiled_parameter, ==, MM_UDEV_RULE_MATCH_PARAMETER_DEVPATH);
+    g_assert (!match->regex);
+    g_assert (!match->prefix_regex);
+    mm_kernel_device_generic_rules_match_compile_patterns (match);
+    g_assert_cmpstr (g_regex_get_pattern (match->regex), ==, "/devices/pci0000:00/usb1");
+    g_assert_cmpstr (g_regex_get_pattern (match->prefix_regex), ==, "/devices/pci0000:00/usb1/*");
+    g_assert_cmpint (rule->result.type, ==, MM_UDEV_RULE_RESULT_TYPE_PROPERTY);
+    g_assert (rule->result.content.property.name_quark == g_quark_from_static_string ("ID_MM_TEST"));
+    g_assert_cmpint (rule->result.content.property.value_attribute, ==, MM_UDEV_RULE_ATTRIBUTE_OTHER);
+
+    /* Known attributes parsed */
+    rule = &g_array_index (rules, MMUdevRule, 2);
+    match = &g_array_index (rule->conditions, MMUdevRuleMatch, 0);
+    g_assert_cmpint (match->compiled_parameter, ==, MM_UDEV_RULE_MATCH_PARAMETER_ATTRS);
+    g_assert_cmpint (match->attribute, ==, MM_UDEV_RULE_ATTRIBUTE_VENDOR);
+    g_assert (match->value_uint_valid);
+    g_assert_cmpuint (match->value_uint, ==, 0x1199);
+    match = &g_array_index (rule->conditions, MMUdevRuleMatch, 1);
+    g_assert_cmpint (match->attribute, ==, MM_UDEV_RULE_ATTRIBUTE_INTERFACE_NUMBER);
+    g_assert (match->value_any);
+    g_assert_cmpint (rule->result.content.property.value_attribute, ==, MM_UDEV_RULE_ATTRIBUTE_INTERFACE_NUMBER);
+
+    /* Property and attribute names interned */
+    rule = &g_array_index (rules, MMUdevRule, 3);
+    match = &g_array_index (rule->conditions, MMUdevRuleMatch, 0);
+    g_assert_cmpint (match->compiled_parameter, ==, MM_UDEV_RULE_MATCH_PARAMETER_ENV);
+    g_assert (match->name == g_intern_static_string ("ID_MM_TEST"));
+    g_assert (match->name_quark == g_quark_from_static_string ("ID_MM_TEST"));
+    match = &g_array_index (rule->conditions, MMUdevRuleMatch, 1);
+    g_assert_cmpint (match->attribute, ==, MM_UDEV_RULE_ATTRIBUTE_OTHER);
+    g_assert (match->name == g_intern_static_string ("serial"));
+
+    g_array_unref (rules);
+    g_unlink (rules_file);
+    g_rmdir (rules_dir);
+}
+
+/************************************************************/
+
+static void
+assert_rules_equal (GArray *a,
+                    GArray *b)
+{
+    guint i;
+
+    g_assert_cmpuint (a->len, ==, b->len);
+    for (i = 0; i < a->len; i++) {
+        MMUdevRule *rule_a;
+        MMUdevRule *rule_b;
+
+        rule_a = &g_array_index (a, MMUdevRule, i);
+        rule_b = &g_array_index (b, MMUdevRule, i);
+
+        g_assert_cmpuint (rule_a->conditions ? rule_a->conditions->len : 0, ==,
+                          rule_b->conditions ? rule_b->conditions->len : 0);
+        if (rule_a->conditions) {
+            guint j;
+
+            for (j = 0; j < rule_a->conditions->len; j++) {
+                MMUdevRuleMatch *match_a;
+                MMUdevRuleMatch *match_b;
+
+                match_a = &g_array_index (rule_a->conditions, MMUdevRuleMatch, j);
+                match_b = &g_array_index (rule_b->conditions, MMUdevRuleMatch, j);
+                g_assert_cmpint (match_a->type, ==, match_b->type);
+                g_assert_cmpstr (match_a->parameter, ==, match_b->parameter);
+                g_assert_cmpstr (match_a->value, ==, match_b->value);
+                g_assert_cmpint (match_a->compiled_parameter, ==, match_b->compiled_parameter);
+                /* No pattern compiled when loading, from files or from cache */
+                g_assert (!match_a->patterns_compiled && !match_a->regex && !match_a->prefix_regex);
+                g_assert (!match_b->patterns_compiled && !match_b->regex && !match_b->prefix_regex);
+            }
+        }
+
+        g_assert_cmpint (rule_a->result.type, ==, rule_b->result.type);
+        switch (rule_a->result.type) {
+        case MM_UDEV_RULE_RESULT_TYPE_PROPERTY:
+            g_assert_cmpstr (rule_a->result.content.property.name, ==, rule_b->result.content.property.name);
+            g_assert_cmpstr (rule_a->result.content.property.value, ==, rule_b->result.content.property.value);
+            break;
+        case MM_UDEV_RULE_RESULT_TYPE_LABEL:
+            g_assert_cmpstr (rule_a->result.content.tag, ==, rule_b->result.content.tag);
+            break;
+        case MM_UDEV_RULE_RESULT_TYPE_GOTO_INDEX:
+            g_assert_cmpuint (rule_a->result.content.index, ==, rule_b->result.content.index);
+            break;
+        case MM_UDEV_RULE_RESULT_TYPE_GOTO_TAG:
+        case MM_UDEV_RULE_RESULT_TYPE_UNKNOWN:
+        default:
+            g_assert_not_reached ();
+        }
+    }
+}
+
+static void
+test_cache (void)
+{
+    g_autofree gchar *rules_dir = NULL;
+    g_autofree gchar *rules_file = NULL;
+    g_autofree gchar *cache_dir = NULL;
+    g_autofree gchar *cache_file = NULL;
+    g_autofree gchar *modified_rules = NULL;
+    GArray           *rules;
+    GArray           *cached_rules;
+    GError           *error = NULL;
+    GStatBuf          st;
+    struct utimbuf    times;
+    MMUdevRule       *rule;
+
+    rules_dir = g_dir_make_tmp ("mm-test-udev-rules-XXXXXX", &error);
+    g_assert_no_error (error);
+    rules_file = g_build_filename (rules_dir, "77-mm-test.rules", NULL);
+    g_file_set_contents (rules_file, compile_rules, -1, &error);
+    g_assert_no_error (error);
+    cache_dir = g_dir_make_tmp ("mm-test-udev-rules-cache-XXXXXX", &error);
+    g_assert_no_error (error);
+    cache_file = g_build_filename (cache_dir, "udev-rules-cache", NULL);
+
+    /* Cache built when not available */
+    rules = mm_kernel_device_generic_rules_load (rules_dir, &error);
+    g_assert_no_error (error);
+    cached_rules = mm_kernel_device_generic_rules_load_cached (rules_dir, cache_file, &error);
+    g_assert_no_error (error);
+    g_assert (g_file_test (cache_file, G_FILE_TEST_EXISTS));
+    assert_rules_equal (rules, cached_rules);
+    g_array_unref (cached_rules);
+
+    /* Cache used when available */
+    cached_rules = mm_kernel_device_generic_rules_load_cached (rules_dir, cache_file, &error);
+    g_assert_no_error (error);
+    assert_rules_equal (rules, cached_rules);
+    g_array_unref (cached_rules);
+
+    /* Contents changed without changing size nor modification time: the
+     * contents of the cache are used */
+    g_assert_cmpint (g_stat (rules_file, &st), ==, 0);
+    modified_rules = g_strdup (compile_rules);
+    *(strstr (modified_rules, "=\"1\"") + 2) = '2';
+    g_file_set_contents (rules_file, modified_rules, -1, &error);
+    g_assert_no_error (error);
+    times.actime = st.st_atime;
+    times.modtime = st.st_mtime;
+    g_assert_cmpint (g_utime (rules_file, &times), ==, 0);
+    cached_rules = mm_kernel_device_generic_rules_load_cached (rules_dir, cache_file, &error);
+    g_assert_no_error (error);
+    assert_rules_equal (rules, cached_rules);
+    g_array_unref (cached_rules);
+
+    /* Size changed: cache rebuilt */
+    g_clear_pointer (&modified_rules, g_free);
+    modified_rules = g_strdup_printf ("%sENV{ID_MM_TEST_LAST}=\"1\"\n", compile_rules);
+    g_file_set_contents (rules_file, modified_rules, -1, &error);
+    g_assert_no_error (error);
+    cached_rules = mm_kernel_device_generic_rules_load_cached (rules_dir, cache_file, &error);
+    g_assert_no_error (error);
+    g_assert_cmpuint (cached_rules->len, ==, rules->len + 1);
+    rule = &g_array_index (cached_rules, MMUdevRule, rules->len);
+    g_assert_cmpstr (rule->result.content.property.name, ==, "ID_MM_TEST_LAST");
+    g_array_unref (cached_rules);
+    g_array_unref (rules);
+
+    /* Invalid cache contents: rules loaded from the files */
+    rules = mm_kernel_device_generic_rules_load (rules_dir, &error);
+    g_assert_no_error (error);
+    g_file_set_contents (cache_file, "invalid cache contents", -1, &error);
+    g_assert_no_error (error);
+    cached_rules = mm_kernel_device_generic_rules_load_cached (rules_dir, cache_file, &error);
+    g_assert_no_error (error);
+    assert_rules_equal (rules, cached_rules);
+    g_array_unref (cached_rules);
+    g_array_unref (rules);
+
+    g_unlink (cache_file);
+    g_rmdir (cache_dir);
+    g_unlink (rules_file);
+    g_rmdir (rules_dir);
+}
+
+/************************************************************/
+
+#define BENCHMARK_N_PORTS 1000
+
+static void
+copy_rule_files (const gchar *source_dir,
+                 const gchar *target_dir)
+{
+    GDir        *dir;
+    const gchar *name;
+
+    dir = g_dir_open (source_dir, 0, NULL);
+    if (!dir)
+        return;
+
+    while ((name = g_dir_read_name (dir)) != NULL) {
+        g_autofree gchar *source = NULL;
+        g_autofree gchar *target = NULL;
+        g_autofree gchar *contents = NULL;
+        gsize             contents_len;
+
+        if (!g_str_has_prefix (name, "77-mm-") && !g_str_has_prefix (name, "80-mm-"))
+            continue;
+        if (!g_str_has_suffix (name, ".rules"))
+            continue;
+
+        source = g_build_filename (source_dir, name, NULL);
+        target = g_build_filename (target_dir, name, NULL);
+        if (g_file_get_contents (source, &contents, &contents_len, NULL))
+            g_file_set_contents (target, contents, contents_len, NULL);
+    }
+    g_dir_close (dir);
+}
+
+static void
+remove_dir (const gchar *path)
+{
+    GDir        *dir;
+    const gchar *name;
+
+    dir = g_dir_open (path, 0, NULL);
+    if (dir) {
+        while ((name = g_dir_read_name (dir)) != NULL) {
+            g_autofree gchar *file = NULL;
+
+            file = g_build_filename (path, name, NULL);
+            g_unlink (file);
+        }
+        g_dir_close (dir);
+    }
+    g_rmdir (path);
+}
+
+static void
+test_benchmark_shipped (void)
+{
+    g_autofree gchar                   *rules_dir = NULL;
+    g_autoptr(MMKernelEventProperties)  props = NULL;
+    GArray                             *rules;
+    GError                             *error = NULL;
+    GDir                               *plugins_dir;
+    const gchar                        *name;
+    GTimer                             *timer;
+    gdouble                             elapsed;
+    guint                               i;
+
+    if (!g_test_perf ())
+        return;
+
+    /* All the rules shipped, both the core and the plugin ones */
+    rules_dir = g_dir_make_tmp ("mm-test-udev-rules-XXXXXX", &error);
+    g_assert_no_error (error);
+    copy_rule_files (TESTUDEVRULESDIR, rules_dir);
+    plugins_dir = g_dir_open (TESTPLUGINSDIR, 0, &error);
+    g_assert_no_error (error);
+    while ((name = g_dir_read_name (plugins_dir)) != NULL) {
+        g_autofree gchar *plugin_dir = NULL;
+
+        plugin_dir = g_build_filename (TESTPLUGINSDIR, name, NULL);
+        copy_rule_files (plugin_dir, rules_dir);
+    }
+    g_dir_close (plugins_dir);
+
+    timer = g_timer_new ();
+    rules = mm_kernel_device_generic_rules_load (rules_dir, &error);
+    elapsed = g_timer_elapsed (timer, NULL);
+    g_assert_no_error (error);
+    g_test_message ("%u rules loaded in %.3f ms", rules->len, elapsed * 1000.0);
+
+    /* Whether the port exists or not in this system, all rules are walked */
+    props = mm_kernel_event_properties_new ();
+    mm_kernel_event_properties_set_action (props, "add");
+    mm_kernel_event_properties_set_subsystem (props, "tty");
+    mm_kernel_event_properties_set_name (props, "ttyS0");
+
+    g_timer_start (timer);
+    for (i = 0; i < BENCHMARK_N_PORTS; i++) {
+        MMKernelDevice *device;
+
+        device = mm_kernel_device_generic_new_with_rules (props, rules, NULL);
+        if (device)
+            g_object_unref (device);
+    }
+    elapsed = g_timer_elapsed (timer, NULL);
+    g_timer_destroy (timer);
+
+    g_test_minimized_result (elapsed / BENCHMARK_N_PORTS,
+                             "%u rules: %.3f us per port",
+                             rules->len, (elapsed * G_USEC_PER_SEC) / BENCHMARK_N_PORTS);
+
+    g_array_unref (rules);
+    remove_dir (rules_dir);
+}
+
+/************************************************************/
+
 int main (int argc, char **argv)
 {
     setlocale (LC_ALL, "");
@@ -50,6 +394,9 @@ int main (int argc, char **argv)
     g_test_init (&argc, &argv, NULL);
 
     g_test_add_func ("/MM/test-udev-rules/load-cleanup-core", test_load_cleanup_core);
+    g_test_add_func ("/MM/test-udev-rules/compile",           test_compile);
+    g_test_add_func ("/MM/test-udev-rules/cache",             test_cache);
+    g_test_add_func ("/MM/test-udev-rules/benchmark/shipped", test_benchmark_shipped);
 
     return g_test_run ();
 }
@@ -0,0 +1,392 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details:
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <locale.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <glib.h>
+
+#include <ModemManager.h>
+#include <mm-errors-types.h>
+#include <mm-log-test.h>
+#include <mm-port-serial-at.h>
+#include <mm-serial-capture.h>
+
+#include "test-port-context.h"
+
+#define PROGRAM_NAME    "mmserialreplay"
+#define PROGRAM_VERSION PACKAGE_VERSION
+
+/* Context */
+static gchar    *file_str;
+static gint      iterations = 1;
+static gint      timeout_ms = 3000;
+static gchar   **unsolicited_strv;
+static gboolean  no_echo_removal_flag;
+static gboolean  verbose_flag;
+static gboolean  version_flag;
+
+static GOptionEntry main_entries[] = {
+    { "file", 'f', 0, G_OPTION_ARG_FILENAME, &file_str,
+      "Specify path of the serial capture file",
+      "[PATH]"
+    },
+    { "iterations", 'n', 0, G_OPTION_ARG_INT, &iterations,
+      "Replay the capture the given number of times (default=1)",
+      "[N]"
+    },
+    { "timeout", 't', 0, G_OPTION_ARG_INT, &timeout_ms,
+      "Timeout of each command, in milliseconds (default=3000)",
+      "[MS]"
+    },
+    { "unsolicited", 'u', 0, G_OPTION_ARG_STRING_ARRAY, &unsolicited_strv,
+      "Register an unsolicited message handler with the given regex (may be given multiple times)",
+      "[REGEX]"
+    },
+    { "no-echo-removal", 0, 0, G_OPTION_ARG_NONE, &no_echo_removal_flag,
+      "Avoid logic to remove echo",
+      NULL
+    },
+    { "verbose", 'v', 0, G_OPTION_ARG_NONE, &verbose_flag,
+      "Print every command, response and unsolicited message",
+      NULL
+    },
+    { "version", 'V', 0, G_OPTION_ARG_NONE, &version_flag,
+      "Print version",
+      NULL
+    },
+    { NULL }
+};
+
+static void
+print_version_and_exit (void)
+{
+    g_print ("\n"
+             PROGRAM_NAME " " PROGRAM_VERSION "\n"
+             "License GPLv2+: GNU GPL version 2 or later <http://gnu.org/licenses/gpl-2.0.html>\n"
+             "This is free software: you are free to change and redistribute it.\n"
+             "There is NO WARRANTY, to the extent permitted by law.\n"
+             "\n");
+    exit (EXIT_SUCCESS);
+}
+
+/*****************************************************************************/
+
+/* The capture is replayed through a real MMPortSerialAt, connected to the
+ * fake AT responder of the plugin tests. The responder waits for each
+ * captured command and answers with the data read after it, in the same
+ * chunks as originally read, so that the port goes through the same echo
+ * removal, response parsing and unsolicited message handling as it did when
+ * the capture was taken. Consecutive writes are sent as a single command,
+ * and commands are sent one after the other, each once the previous one is
+ * finished. */
+
+typedef struct {
+    GPtrArray       *commands;
+    GPtrArray       *regexes;
+    TestPortContext *port_context;
+    MMPortSerialAt  *port;
+    gboolean         print;
+    guint            next_command;
+    gint64           command_start;
+    gint64           first_timestamp;
+    gboolean         done;
+
+    /* Statistics */
+    guint64          n_reads;
+    guint64          n_writes;
+    guint64          bytes_read;
+    guint64          bytes_written;
+    guint64          n_responses;
+    guint64          n_errors;
+    guint64          n_timeouts;
+    guint64          n_unsolicited;
+    gint64           replay_time;
+    gint64           response_time;
+    gint64           max_response_time;
+} ReplayContext;
+
+static void
+replay_print (ReplayContext *ctx,
+              const gchar   *prefix,
+              const gchar   *str)
+{
+    g_autofree gchar *escaped = NULL;
+    gint64            elapsed;
+
+    if (!ctx->print)
+        return;
+
+    elapsed = g_get_monotonic_time () - ctx->first_timestamp;
+    escaped = g_strescape (str, NULL);
+    g_print ("[%4" G_GINT64_FORMAT ".%06" G_GINT64_FORMAT "] %s '%s'\n",
+             elapsed / G_USEC_PER_SEC, elapsed % G_USEC_PER_SEC,
+             prefix, escaped);
+}
+
+static void
+replay_unsolicited (MMPortSerialAt *port,
+                    GMatchInfo     *match_info,
+                    ReplayContext  *ctx)
+{
+    g_autofree gchar *match = NULL;
+
+    ctx->n_unsolicited++;
+    match = g_match_info_fetch (match_info, 0);
+    replay_print (ctx, "<-- (unsolicited)", match);
+}
+
+static void replay_next_command (ReplayContext *ctx);
+
+static void
+replay_command_ready (MMPortSerialAt *port,
+                      GAsyncResult   *res,
+                      ReplayContext  *ctx)
+{
+    g_autoptr(GError)  error = NULL;
+    const gchar       *response;
+    gint64             response_time;
+
+    response = mm_port_serial_at_command_finish (port, res, &error);
+
+    response_time = g_get_monotonic_time () - ctx->command_start;
+    ctx->response_time += response_time;
+    ctx->max_response_time = MAX (ctx->max_response_time, response_time);
+
+    if (g_error_matches (error, MM_SERIAL_ERROR, MM_SERIAL_ERROR_RESPONSE_TIMEOUT)) {
+        ctx->n_timeouts++;
+        replay_print (ctx, "<-- (timeout)", error->message);
+    } else if (error) {
+        ctx->n_errors++;
+        replay_print (ctx, "<-- (error)", error->message);
+    } else {
+        ctx->n_responses++;
+        replay_print (ctx, "<--", response);
+    }
+
+    replay_next_command (ctx);
+}
+
+static void
+replay_next_command (ReplayContext *ctx)
+{
+    const gchar *command;
+
+    if (ctx->next_command == ctx->commands->len) {
+        ctx->done = TRUE;
+        return;
+    }
+
+    command = g_ptr_array_index (ctx->commands, ctx->next_command++);
+    replay_print (ctx, "-->", command);
+    ctx->command_start = g_get_monotonic_time ();
+    mm_port_serial_at_command (ctx->port, command, timeout_ms, TRUE, FALSE, NULL,
+                               (GAsyncReadyCallback) replay_command_ready, ctx);
+}
+
+/* Loads the capture as the script of the responder, and the list of commands
+ * to send */
+static gboolean
+replay_load (ReplayContext          *ctx,
+             MMSerialCaptureReader  *reader,
+             GError                **error)
+{
+    gint64                    timestamp;
+    MMSerialCaptureDirection  direction;
+    const guint8             *data;
+    gsize                     len;
+    GByteArray               *command;
+    GError                   *inner_error = NULL;
+
+    mm_serial_capture_reader_rewind (reader);
+    command = g_byte_array_new ();
+
+    while (mm_serial_capture_reader_next (reader, &timestamp, &direction, &data, &len, &inner_error)) {
+        if (direction == MM_SERIAL_CAPTURE_DIRECTION_WRITE) {
+            ctx->n_writes++;
+            ctx->bytes_written += len;
+            g_byte_array_append (command, data, len);
+            continue;
+        }
+
+        if (command->len > 0) {
+            test_port_context_add_script_step (ctx->port_context, command->data, command->len);
+            g_ptr_array_add (ctx->commands, g_strndup ((const gchar *) command->data, command->len));
+            g_byte_array_set_size (command, 0);
+        }
+
+        ctx->n_reads++;
+        ctx->bytes_read += len;
+        test_port_context_add_script_response (ctx->port_context, data, len);
+    }
+
+    /* Trailing commands were never answered */
+    if (command->len > 0) {
+        test_port_context_add_script_step (ctx->port_context, command->data, command->len);
+        g_ptr_array_add (ctx->commands, g_strndup ((const gchar *) command->data, command->len));
+    }
+    g_byte_array_unref (command);
+
+    if (inner_error) {
+        g_propagate_error (error, inner_error);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static gboolean
+replay (ReplayContext          *ctx,
+        MMSerialCaptureReader  *reader,
+        GError                **error)
+{
+    g_autofree gchar *port_name = NULL;
+    guint             i;
+    gboolean          success = FALSE;
+
+    /* Add process ID so that multiple runs in the same system don't clash */
+    port_name = g_strdup_printf ("abstract:mmserialreplay-%ld", (glong) getpid ());
+    ctx->port_context = test_port_context_new (port_name);
+    ctx->commands = g_ptr_array_new_with_free_func (g_free);
+    ctx->next_command = 0;
+    ctx->done = FALSE;
+
+    if (!replay_load (ctx, reader, error))
+        goto out;
+
+    ctx->port = mm_port_serial_at_new (port_name, MM_PORT_SUBSYS_UNIX);
+    g_object_set (ctx->port,
+                  MM_PORT_SERIAL_SEND_DELAY,               (guint64) 0,
+                  MM_PORT_SERIAL_SEND_DELAY_ADAPTIVE,      FALSE,
+                  MM_PORT_SERIAL_AT_REMOVE_ECHO,           !no_echo_removal_flag,
+                  MM_PORT_SERIAL_AT_INIT_SEQUENCE_ENABLED, FALSE,
+                  NULL);
+    for (i = 0; i < ctx->regexes->len; i++)
+        mm_port_serial_at_add_unsolicited_msg_handler (ctx->port,
+                                                       g_ptr_array_index (ctx->regexes, i),
+                                                       (MMPortSerialAtUnsolicitedMsgFn) replay_unsolicited,
+                                                       ctx,
+                                                       NULL);
+
+    ctx->first_timestamp = g_get_monotonic_time ();
+    test_port_context_start (ctx->port_context);
+    if (!mm_port_serial_open (MM_PORT_SERIAL (ctx->port), error)) {
+        test_port_context_stop (ctx->port_context);
+        goto out;
+    }
+
+    replay_next_command (ctx);
+    while (!ctx->done)
+        g_main_context_iteration (NULL, TRUE);
+    /* Data sent after the last response, if any, is already available */
+    while (g_main_context_iteration (NULL, FALSE));
+
+    ctx->replay_time += g_get_monotonic_time () - ctx->first_timestamp;
+
+    mm_port_serial_close (MM_PORT_SERIAL (ctx->port));
+    test_port_context_stop (ctx->port_context);
+    success = TRUE;
+
+out:
+    g_clear_object (&ctx->port);
+    g_clear_pointer (&ctx->port_context, test_port_context_free);
+    g_clear_pointer (&ctx->commands, g_ptr_array_unref);
+    return success;
+}
+
+/*****************************************************************************/
+
+int main (int argc, char **argv)
+{
+    g_autoptr(GOptionContext)        context = NULL;
+    g_autoptr(MMSerialCaptureReader) reader = NULL;
+    g_autoptr(GError)                error = NULL;
+    ReplayContext                    ctx = { 0 };
+    gint                             i;
+
+    setlocale (LC_ALL, "");
+
+    /* Setup option context, process it and destroy it */
+    context = g_option_context_new ("- ModemManager serial capture replay");
+    g_option_context_add_main_entries (context, main_entries, NULL);
+    if (!g_option_context_parse (context, &argc, &argv, &error)) {
+        g_printerr ("error: %s\n", error->message);
+        exit (EXIT_FAILURE);
+    }
+
+    if (version_flag)
+        print_version_and_exit ();
+
+    if (!file_str) {
+        g_printerr ("error: no capture file specified\n");
+        exit (EXIT_FAILURE);
+    }
+
+    if (iterations < 1) {
+        g_printerr ("error: invalid number of iterations: %d\n", iterations);
+        exit (EXIT_FAILURE);
+    }
+
+    reader = mm_serial_capture_reader_new (file_str, &error);
+    if (!reader) {
+        g_printerr ("error: %s\n", error->message);
+        exit (EXIT_FAILURE);
+    }
+
+    ctx.regexes = g_ptr_array_new_with_free_func ((GDestroyNotify) g_regex_unref);
+    for (i = 0; unsolicited_strv && unsolicited_strv[i]; i++) {
+        GRegex *regex;
+
+        regex = g_regex_new (unsolicited_strv[i], G_REGEX_RAW | G_REGEX_OPTIMIZE, 0, &error);
+        if (!regex) {
+            g_printerr ("error: invalid unsolicited message regex '%s': %s\n", unsolicited_strv[i], error->message);
+            exit (EXIT_FAILURE);
+        }
+        g_ptr_array_add (ctx.regexes, regex);
+    }
+
+    for (i = 0; i < iterations; i++) {
+        /* Only the first run is printed */
+        ctx.print = (verbose_flag && i == 0);
+        if (!replay (&ctx, reader, &error)) {
+            g_printerr ("error: %s\n", error->message);
+            exit (EXIT_FAILURE);
+        }
+    }
+
+    g_print ("records:        %" G_GUINT64_FORMAT " written (%" G_GUINT64_FORMAT " bytes), "
+             "%" G_GUINT64_FORMAT " read (%" G_GUINT64_FORMAT " bytes)\n",
+             ctx.n_writes / iterations, ctx.bytes_written / iterations,
+             ctx.n_reads / iterations, ctx.bytes_read / iterations);
+    g_print ("responses:      %" G_GUINT64_FORMAT " successful, %" G_GUINT64_FORMAT " errors, "
+             "%" G_GUINT64_FORMAT " timed out\n",
+             ctx.n_responses / iterations, ctx.n_errors / iterations, ctx.n_timeouts / iterations);
+    g_print ("unsolicited:    %" G_GUINT64_FORMAT " messages handled\n",
+             ctx.n_unsolicited / iterations);
+    if (ctx.n_responses + ctx.n_errors + ctx.n_timeouts > 0)
+        g_print ("response time:  %" G_GINT64_FORMAT " us average, %" G_GINT64_FORMAT " us max\n",
+                 ctx.response_time / (gint64) (ctx.n_responses + ctx.n_errors + ctx.n_timeouts),
+                 ctx.max_response_time);
+    g_print ("replay time:    %" G_GINT64_FORMAT " us in %d iterations", ctx.replay_time, iterations);
+    if (ctx.replay_time > 0)
+        g_print (", %.0f bytes/s", (gdouble) ctx.bytes_read * G_USEC_PER_SEC / ctx.replay_time);
+    g_print ("\n");
+
+    g_ptr_array_unref (ctx.regexes);
+
+    return EXIT_SUCCESS;
+}
@@ -126,7 +126,7 @@ input_callback (GIOChannel   *channel,
 
     switch (status) {
     case G_IO_STATUS_NORMAL:
-        mm_port_serial_at_command (port, line, 60, FALSE, FALSE, NULL,
+        mm_port_serial_at_command (port, line, 60000, FALSE, FALSE, NULL,
                                    (GAsyncReadyCallback) at_command_ready, NULL);
         g_free (line);
         return TRUE;